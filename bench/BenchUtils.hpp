@@ -0,0 +1,72 @@
+#pragma once
+
+#include <polyfem/State.hpp>
+
+#include <memory>
+#include <string>
+
+namespace polyfem::bench
+{
+	/// material parameters used by the benchmarks
+	inline json benchmark_material(const std::string &type)
+	{
+		json material = {{"type", type}, {"E", 20000}, {"nu", 0.3}, {"rho", 1000}};
+		if (type == "MooneyRivlin")
+			material = {{"type", type}, {"c1", 1e5}, {"c2", 1e3}, {"k", 1e5}};
+		else if (type == "MooneyRivlin3Param")
+			material = {{"type", type}, {"c1", 1e5}, {"c2", 1e3}, {"c3", 1e3}, {"d1", 1e5}};
+		else if (type == "UnconstrainedOgden")
+			material = {{"type", type}, {"alphas", {2}}, {"mus", {1e5}}, {"Ds", {1e-5}}};
+		return material;
+	}
+
+	/// @brief builds the bases of a benchmark problem, the 3D bar of the contact tests
+	/// @param[in] material material parameters
+	/// @param[in] discr_order discretization order
+	/// @param[in] n_refs number of uniform refinements of the mesh
+	/// @param[in] extra_args arguments merged in the input
+	/// @return state ready to assemble
+	inline std::shared_ptr<State> benchmark_state(const json &material, const int discr_order = 1, const int n_refs = 1, const json &extra_args = json::object())
+	{
+		const std::string path = POLYFEM_DATA_DIR;
+
+		json in_args = R"(
+		{
+			"geometry": [{
+				"transformation": {
+					"scale": [0.1, 1, 1]
+				},
+				"surface_selection": 1
+			}],
+			"boundary_conditions": {
+				"dirichlet_boundary": [{
+					"id": 1,
+					"value": [0, 0, 0]
+				}],
+				"rhs": [0, 0, 10]
+			},
+			"output": {
+				"log": {
+					"level": "warning"
+				}
+			}
+		})"_json;
+		in_args["geometry"][0]["mesh"] = path + "/contact/meshes/3D/simple/bar/bar-6.msh";
+		in_args["geometry"][0]["n_refs"] = n_refs;
+		in_args["space"]["discr_order"] = discr_order;
+		in_args["materials"] = material;
+		in_args.merge_patch(extra_args);
+
+		auto state = std::make_shared<State>();
+		state->init(in_args, true);
+
+		state->load_mesh();
+		state->stats.compute_mesh_stats(*state->mesh);
+
+		state->build_basis();
+		state->assemble_rhs();
+		state->assemble_mass_mat();
+
+		return state;
+	}
+} // namespace polyfem::bench
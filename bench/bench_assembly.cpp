@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+#include "BenchUtils.hpp"
+
+#include <polyfem/assembler/AssemblyValsCache.hpp>
+#include <polyfem/utils/MatrixCache.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace polyfem;
+using namespace polyfem::assembler;
+using namespace polyfem::bench;
+using namespace polyfem::utils;
+
+TEST_CASE("linear assembly", "[!benchmark][assembly]")
+{
+	const auto state = benchmark_state(benchmark_material("LinearElasticity"));
+
+	BENCHMARK("LinearAssembler::assemble")
+	{
+		StiffnessMatrix stiffness;
+		state->assembler->assemble(
+			state->mesh->is_volume(), state->n_bases, state->bases, state->geom_bases(),
+			state->ass_vals_cache, 0, stiffness);
+		return stiffness.nonZeros();
+	};
+
+	BENCHMARK("mass matrix")
+	{
+		StiffnessMatrix mass;
+		state->mass_matrix_assembler->assemble(
+			state->mesh->is_volume(), state->n_bases, state->bases, state->geom_bases(),
+			state->mass_ass_vals_cache, 0, mass, true);
+		return mass.nonZeros();
+	};
+}
+
+TEST_CASE("nonlinear assembly", "[!benchmark][assembly]")
+{
+	const std::string material = GENERATE(
+		"LinearElasticity", "HookeLinearElasticity", "SaintVenant", "NeoHookean",
+		"MooneyRivlin", "MooneyRivlin3Param", "UnconstrainedOgden", "FixedCorotational", "AMIPS");
+	const auto state = benchmark_state(benchmark_material(material));
+
+	const int ndof = state->n_bases * state->mesh->dimension();
+	const Eigen::MatrixXd disp = Eigen::MatrixXd::Random(ndof, 1) * 1e-3;
+
+	SparseMatrixCache mat_cache;
+	StiffnessMatrix hessian;
+	// the first assembly builds the sparsity pattern reused by the next ones
+	state->assembler->assemble_hessian(
+		state->mesh->is_volume(), state->n_bases, false, state->bases, state->geom_bases(),
+		state->ass_vals_cache, 0, 0, disp, disp, mat_cache, hessian);
+
+	BENCHMARK("assemble_energy " + material)
+	{
+		return state->assembler->assemble_energy(
+			state->mesh->is_volume(), state->bases, state->geom_bases(),
+			state->ass_vals_cache, 0, 0, disp, disp);
+	};
+
+	BENCHMARK("assemble_gradient " + material)
+	{
+		Eigen::MatrixXd grad;
+		state->assembler->assemble_gradient(
+			state->mesh->is_volume(), state->n_bases, state->bases, state->geom_bases(),
+			state->ass_vals_cache, 0, 0, disp, disp, grad);
+		return grad.size();
+	};
+
+	BENCHMARK("assemble_hessian " + material)
+	{
+		state->assembler->assemble_hessian(
+			state->mesh->is_volume(), state->n_bases, false, state->bases, state->geom_bases(),
+			state->ass_vals_cache, 0, 0, disp, disp, mat_cache, hessian);
+		return hessian.nonZeros();
+	};
+
+	BENCHMARK("assemble_hessian projected " + material)
+	{
+		state->assembler->assemble_hessian(
+			state->mesh->is_volume(), state->n_bases, true, state->bases, state->geom_bases(),
+			state->ass_vals_cache, 0, 0, disp, disp, mat_cache, hessian);
+		return hessian.nonZeros();
+	};
+}
+
+TEST_CASE("sparse matrix cache", "[!benchmark][assembly]")
+{
+	const auto state = benchmark_state(benchmark_material("NeoHookean"));
+
+	const int ndof = state->n_bases * state->mesh->dimension();
+	const Eigen::MatrixXd disp = Eigen::MatrixXd::Zero(ndof, 1);
+
+	StiffnessMatrix hessian;
+	{
+		SparseMatrixCache mat_cache;
+		state->assembler->assemble_hessian(
+			state->mesh->is_volume(), state->n_bases, false, state->bases, state->geom_bases(),
+			state->ass_vals_cache, 0, 0, disp, disp, mat_cache, hessian);
+	}
+
+	// adds the entries of the hessian column by column, each column playing the role of an element
+	const auto fill = [&](SparseMatrixCache &cache) {
+		cache.set_zero();
+		for (int k = 0; k < hessian.outerSize(); ++k)
+		{
+			for (StiffnessMatrix::InnerIterator it(hessian, k); it; ++it)
+				cache.add_value(k, it.row(), it.col(), it.value());
+		}
+	};
+
+	BENCHMARK_ADVANCED("SparseMatrixCache::get_matrix first assembly")
+	(Catch::Benchmark::Chronometer meter)
+	{
+		std::vector<SparseMatrixCache> caches(meter.runs(), SparseMatrixCache(ndof));
+		for (auto &cache : caches)
+			fill(cache);
+
+		meter.measure([&](int i) { return caches[i].get_matrix().nonZeros(); });
+	};
+
+	SparseMatrixCache mapped(ndof);
+	fill(mapped);
+	mapped.get_matrix();
+
+	BENCHMARK("SparseMatrixCache::get_matrix with pattern")
+	{
+		fill(mapped);
+		return mapped.get_matrix().nonZeros();
+	};
+}
+
+TEST_CASE("assembly values cache", "[!benchmark][assembly]")
+{
+	const auto state = benchmark_state(benchmark_material("NeoHookean"));
+
+	BENCHMARK("AssemblyValsCache::init")
+	{
+		AssemblyValsCache cache;
+		cache.init(state->mesh->is_volume(), state->bases, state->geom_bases());
+	};
+}
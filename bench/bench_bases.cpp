@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+#include "BenchUtils.hpp"
+
+#include <polyfem/basis/LagrangeBasis3d.hpp>
+#include <polyfem/assembler/ElementAssemblyValues.hpp>
+#include <polyfem/quadrature/Quadrature.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <map>
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace polyfem;
+using namespace polyfem::assembler;
+using namespace polyfem::basis;
+using namespace polyfem::bench;
+using namespace polyfem::mesh;
+
+TEST_CASE("lagrange bases 3d", "[!benchmark][bases]")
+{
+	const int order = GENERATE(1, 2, 3, 4);
+	const auto state = benchmark_state(benchmark_material("NeoHookean"), order, /*n_refs=*/0);
+	const Mesh3D &mesh = dynamic_cast<const Mesh3D &>(*state->mesh);
+
+	BENCHMARK(fmt::format("LagrangeBasis3d::build_bases P{}", order))
+	{
+		std::vector<ElementBases> bases;
+		std::vector<LocalBoundary> local_boundary;
+		std::map<int, InterfaceData> poly_face_to_data;
+		std::shared_ptr<MeshNodes> mesh_nodes;
+		return LagrangeBasis3d::build_bases(
+			mesh, state->assembler->name(), -1, -1, order, false, false, false,
+			bases, local_boundary, poly_face_to_data, mesh_nodes);
+	};
+
+	std::vector<quadrature::Quadrature> quadratures(state->bases.size());
+	for (size_t e = 0; e < quadratures.size(); ++e)
+		state->bases[e].compute_quadrature(quadratures[e]);
+
+	BENCHMARK(fmt::format("evaluate bases and gradients P{}", order))
+	{
+		std::vector<AssemblyValues> values;
+		for (size_t e = 0; e < state->bases.size(); ++e)
+		{
+			state->bases[e].evaluate_bases(quadratures[e].points, values);
+			state->bases[e].evaluate_grads(quadratures[e].points, values);
+		}
+		return values.size();
+	};
+
+	BENCHMARK(fmt::format("ElementAssemblyValues::compute P{}", order))
+	{
+		ElementAssemblyValues vals;
+		for (size_t e = 0; e < state->bases.size(); ++e)
+			vals.compute(e, mesh.is_volume(), state->bases[e], state->geom_bases()[e]);
+		return vals.basis_values.size();
+	};
+}
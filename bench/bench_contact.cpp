@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+#include "BenchUtils.hpp"
+
+#include <polyfem/solver/forms/ContactForm.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace polyfem;
+using namespace polyfem::bench;
+using namespace polyfem::solver;
+
+TEST_CASE("contact form", "[!benchmark][contact]")
+{
+	const double skin = GENERATE(0.0, 1e-2);
+	const auto state = benchmark_state(benchmark_material("NeoHookean"));
+
+	// with dhat of the order of the edge length every surface primitive is close to its neighbours
+	const double dhat = state->stats.average_edge_length;
+	ContactForm form(
+		state->collision_mesh, dhat, state->avg_mass,
+		/*use_convergent_formulation=*/false, /*use_adaptive_barrier_stiffness=*/false,
+		/*is_time_dependent=*/false, /*enable_shape_derivatives=*/false,
+		ipc::BroadPhaseMethod::HASH_GRID, /*ccd_tolerance=*/1e-6, /*ccd_max_iterations=*/1e6);
+	form.set_barrier_stiffness(1e5);
+	form.set_broad_phase_skin(skin);
+
+	const int ndof = state->n_bases * state->mesh->dimension();
+	const Eigen::VectorXd x0 = Eigen::VectorXd::Zero(ndof);
+	const Eigen::VectorXd x1 = Eigen::VectorXd::Random(ndof) * dhat / 10;
+
+	form.init(x0);
+	form.update_quantities(0, x0);
+
+	const std::string suffix = fmt::format(" (skin {})", skin);
+
+	BENCHMARK("ContactForm::update_quantities" + suffix)
+	{
+		// alternate between two solutions, the collision set of the last one is cached
+		form.update_quantities(0, x1);
+		form.update_quantities(0, x0);
+	};
+
+	BENCHMARK("ContactForm::value" + suffix)
+	{
+		return form.value(x0);
+	};
+
+	BENCHMARK("ContactForm::first_derivative" + suffix)
+	{
+		Eigen::VectorXd grad;
+		form.first_derivative(x0, grad);
+		return grad.size();
+	};
+
+	BENCHMARK("ContactForm::second_derivative" + suffix)
+	{
+		StiffnessMatrix hessian;
+		form.second_derivative(x0, hessian);
+		return hessian.nonZeros();
+	};
+
+	BENCHMARK("ContactForm::max_step_size" + suffix)
+	{
+		return form.max_step_size(x0, x1);
+	};
+}
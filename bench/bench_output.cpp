@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////////////
+#include "BenchUtils.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <filesystem>
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace polyfem;
+using namespace polyfem::bench;
+
+TEST_CASE("export data", "[!benchmark][output]")
+{
+	const bool use_hdf5 = GENERATE(false, true);
+	const std::string output_dir = (std::filesystem::temp_directory_path() / "polyfem_bench").string();
+
+	json args;
+	args["output"]["directory"] = output_dir;
+	args["output"]["paraview"]["file_name"] = "bench.vtu";
+	args["output"]["paraview"]["options"]["use_hdf5"] = use_hdf5;
+	args["output"]["paraview"]["options"]["material"] = true;
+	args["output"]["paraview"]["options"]["body_ids"] = true;
+	const auto state = benchmark_state(benchmark_material("NeoHookean"), 2, 1, args);
+
+	const Eigen::MatrixXd sol = Eigen::MatrixXd::Random(state->n_bases * state->mesh->dimension(), 1) * 1e-3;
+	const Eigen::MatrixXd pressure;
+
+	BENCHMARK(fmt::format("OutGeometryData::export_data ({})", use_hdf5 ? "hdf5" : "vtu"))
+	{
+		state->export_data(sol, pressure);
+	};
+
+	std::filesystem::remove_all(output_dir);
+}
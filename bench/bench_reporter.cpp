@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+#include <polyfem/utils/getRSS.h>
+#include <polyfem/utils/par_for.hpp>
+
+#include <catch2/reporters/catch_reporter_event_listener.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+#include <catch2/catch_test_case_info.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	/// Collects the benchmark results and saves them as JSON when the run ends.
+	/// The output path is read from POLYFEM_BENCH_OUTPUT (polyfem_bench.json by default).
+	class JSONBenchmarkListener : public Catch::EventListenerBase
+	{
+	public:
+		using Catch::EventListenerBase::EventListenerBase;
+
+		void testCaseStarting(const Catch::TestCaseInfo &info) override
+		{
+			test_case_ = info.name;
+		}
+
+		void benchmarkStarting(const Catch::BenchmarkInfo &info) override
+		{
+			rss_before_ = getCurrentRSS();
+		}
+
+		void benchmarkEnded(const Catch::BenchmarkStats<> &stats) override
+		{
+			using seconds = std::chrono::duration<double>;
+
+			results_.push_back({
+				{"test_case", test_case_},
+				{"name", stats.info.name},
+				{"mean", std::chrono::duration_cast<seconds>(stats.mean.point).count()},
+				{"mean_lower_bound", std::chrono::duration_cast<seconds>(stats.mean.lower_bound).count()},
+				{"mean_upper_bound", std::chrono::duration_cast<seconds>(stats.mean.upper_bound).count()},
+				{"std_dev", std::chrono::duration_cast<seconds>(stats.standardDeviation.point).count()},
+				{"samples", stats.info.samples},
+				{"iterations", stats.info.iterations},
+				{"rss_before", rss_before_},
+				{"rss_after", getCurrentRSS()},
+			});
+		}
+
+		void testRunEnded(const Catch::TestRunStats &) override
+		{
+			const char *env_path = std::getenv("POLYFEM_BENCH_OUTPUT");
+			const std::string path = env_path == nullptr ? "polyfem_bench.json" : env_path;
+
+			nlohmann::json j;
+			j["benchmarks"] = results_;
+			j["num_threads"] = polyfem::utils::NThread::get().num_threads();
+			j["peak_rss"] = getPeakRSS();
+
+			std::ofstream out(path);
+			if (!out.is_open())
+			{
+				std::cerr << "Unable to save the benchmark results to " << path << std::endl;
+				return;
+			}
+			out << j.dump(4) << std::endl;
+		}
+
+	private:
+		std::string test_case_;
+		size_t rss_before_ = 0;
+		nlohmann::json results_ = nlohmann::json::array();
+	};
+} // namespace
+
+CATCH_REGISTER_LISTENER(JSONBenchmarkListener)
@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////////
+#include "BenchUtils.hpp"
+
+#include <polyfem/solver/forms/ContactForm.hpp>
+#include <polyfem/utils/MatrixCache.hpp>
+#include <polyfem/utils/Profiler.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace polyfem;
+using namespace polyfem::bench;
+using namespace polyfem::solver;
+using namespace polyfem::utils;
+
+namespace
+{
+	/// runs of every phase at every thread count
+	constexpr int SCALING_REPEATS = 3;
+
+	/// 1, 2, 4, ... threads up to POLYFEM_BENCH_MAX_THREADS (the hardware concurrency by default), which is always included
+	std::vector<int> thread_counts()
+	{
+		const char *env_max = std::getenv("POLYFEM_BENCH_MAX_THREADS");
+		const int max_threads = env_max == nullptr ? std::max(1u, std::thread::hardware_concurrency()) : std::max(1, std::atoi(env_max));
+
+		std::vector<int> counts;
+		for (int n = 1; n < max_threads; n *= 2)
+			counts.push_back(n);
+		counts.push_back(max_threads);
+		return counts;
+	}
+
+	/// first zone of the merged call tree with the given name, depth first, null if it was not recorded
+	const nlohmann::json *find_zone(const nlohmann::json &zones, const std::string &name)
+	{
+		for (const nlohmann::json &zone : zones)
+		{
+			if (zone["name"] == name)
+				return &zone;
+			if (const nlohmann::json *child = find_zone(zone["children"], name))
+				return child;
+		}
+		return nullptr;
+	}
+
+	/// A phase of the simulation: setup is not timed, run is timed in a profiler zone named after the phase
+	struct Phase
+	{
+		std::string name;
+		std::function<std::function<void()>()> setup;
+		/// zone whose time is reported when run also prepares its input, the phase zone if empty
+		std::string zone = "";
+	};
+} // namespace
+
+TEST_CASE("thread scaling", "[!benchmark][scaling]")
+{
+	const std::string output_dir = (std::filesystem::temp_directory_path() / "polyfem_bench_scaling").string();
+
+	std::vector<Phase> phases;
+
+	phases.push_back({"assembly", []() -> std::function<void()> {
+						  const auto state = benchmark_state(benchmark_material("NeoHookean"), 1, 2);
+						  const int ndof = state->n_bases * state->mesh->dimension();
+						  const Eigen::MatrixXd disp = Eigen::MatrixXd::Random(ndof, 1) * 1e-3;
+						  auto mat_cache = std::make_shared<SparseMatrixCache>();
+						  return [state, disp, mat_cache]() {
+							  StiffnessMatrix hessian;
+							  state->assembler->assemble_hessian(
+								  state->mesh->is_volume(), state->n_bases, true, state->bases, state->geom_bases(),
+								  state->ass_vals_cache, 0, 0, disp, disp, *mat_cache, hessian);
+						  };
+					  }});
+
+	phases.push_back({"contact hessian", []() -> std::function<void()> {
+						  const auto state = benchmark_state(benchmark_material("NeoHookean"), 1, 2);
+						  const double dhat = state->stats.average_edge_length;
+						  auto form = std::make_shared<ContactForm>(
+							  state->collision_mesh, dhat, state->avg_mass,
+							  /*use_convergent_formulation=*/false, /*use_adaptive_barrier_stiffness=*/false,
+							  /*is_time_dependent=*/false, /*enable_shape_derivatives=*/false,
+							  ipc::BroadPhaseMethod::HASH_GRID, /*ccd_tolerance=*/1e-6, /*ccd_max_iterations=*/1e6);
+						  form->set_barrier_stiffness(1e5);
+						  const Eigen::VectorXd x = Eigen::VectorXd::Zero(state->n_bases * state->mesh->dimension());
+						  form->init(x);
+						  form->update_quantities(0, x);
+						  return [state, form, x]() {
+							  StiffnessMatrix hessian;
+							  form->second_derivative(x, hessian);
+						  };
+					  }});
+
+	phases.push_back({"nonlinear solve", []() -> std::function<void()> {
+						  const auto state = benchmark_state(benchmark_material("NeoHookean"), 1, 2);
+						  return [state]() {
+							  Eigen::MatrixXd sol, pressure;
+							  state->solve_problem(sol, pressure);
+						  };
+					  }});
+
+	phases.push_back({"output export", [output_dir]() -> std::function<void()> {
+						  json args;
+						  args["output"]["directory"] = output_dir;
+						  args["output"]["paraview"]["file_name"] = "scaling.vtu";
+						  const auto state = benchmark_state(benchmark_material("NeoHookean"), 2, 1, args);
+						  const Eigen::MatrixXd sol = Eigen::MatrixXd::Random(state->n_bases * state->mesh->dimension(), 1) * 1e-3;
+						  return [state, sol]() { state->export_data(sol, Eigen::MatrixXd()); };
+					  }});
+
+	phases.push_back({"remeshing", []() -> std::function<void()> {
+						  json args;
+						  args["time"] = {{"tend", 1}, {"dt", 0.1}};
+						  args["space"]["remesh"]["enabled"] = true;
+						  return [args]() {
+							  // remeshing replaces the mesh, every run starts again from the original one
+							  const auto state = benchmark_state(benchmark_material("NeoHookean"), 1, 1, args);
+							  Eigen::MatrixXd sol, pressure;
+							  state->init_solve(sol, pressure);
+							  // a deformed bar, so that the remeshing has some energy to reduce
+							  sol += Eigen::MatrixXd::Random(sol.rows(), 1) * 1e-2;
+							  state->init_nonlinear_tensor_solve(sol, 0.1);
+
+							  POLYFEM_PROFILE_ZONE("remesh");
+							  state->remesh(0.1, 0.1, sol);
+						  };
+					  },
+					  "remesh"});
+
+	const std::vector<int> counts = thread_counts();
+
+	nlohmann::json results;
+	results["thread_counts"] = counts;
+	results["repeats"] = SCALING_REPEATS;
+
+	Profiler &profiler = Profiler::instance();
+	const bool was_enabled = profiler.enabled();
+
+	for (const Phase &phase : phases)
+	{
+		const std::function<void()> run = phase.setup();
+
+		nlohmann::json runs = nlohmann::json::array();
+		double serial_time = 0;
+		for (const int n_threads : counts)
+		{
+			State().set_max_threads(n_threads);
+
+			// a first run outside of the zones warms the caches and the thread pool
+			run();
+
+			profiler.clear();
+			profiler.set_enabled(true);
+			for (int i = 0; i < SCALING_REPEATS; ++i)
+			{
+				POLYFEM_PROFILE_ZONE(phase.name);
+				run();
+			}
+			profiler.set_enabled(was_enabled);
+
+			const nlohmann::json zones = profiler.to_json()["zones"];
+			const nlohmann::json *zone = find_zone(zones, phase.zone.empty() ? phase.name : phase.zone);
+			REQUIRE(zone != nullptr);
+
+			const double time = (*zone)["time"].get<double>() / SCALING_REPEATS;
+			if (n_threads == 1)
+				serial_time = time;
+
+			runs.push_back({
+				{"threads", n_threads},
+				{"time", time},
+				{"speedup", serial_time / time},
+				{"efficiency", serial_time / (time * n_threads)},
+				// inner zones, summed over the threads, to see which part stops scaling
+				{"zones", zones},
+			});
+		}
+
+		results["phases"][phase.name] = runs;
+	}
+
+	profiler.clear();
+	State().set_max_threads();
+	std::filesystem::remove_all(output_dir);
+
+	const char *env_path = std::getenv("POLYFEM_BENCH_SCALING_OUTPUT");
+	const std::string path = env_path == nullptr ? "polyfem_scaling.json" : env_path;
+	std::ofstream out(path);
+	REQUIRE(out.is_open());
+	out << results.dump(4) << std::endl;
+}
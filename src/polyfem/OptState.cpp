@@ -5,6 +5,7 @@
 #include <polyfem/utils/par_for.hpp>
 #include <polyfem/utils/GeogramUtils.hpp>
 
+#include <polyfem/State.hpp>
 #include <polyfem/solver/AdjointNLProblem.hpp>
 #include <polyfem/solver/forms/adjoint_forms/VariableToSimulation.hpp>
 
@@ -182,8 +183,53 @@ namespace polyfem
 		return nl_problem->value(x);
 	}
 
+	void OptState::solve_coarse(Eigen::VectorXd &x)
+	{
+		const json &mf_args = args["solver"]["advanced"]["multi_fidelity"];
+
+		// the coarse problem must not overwrite the outputs of the optimization
+		json coarse_args = args;
+		coarse_args["output"]["solution"] = "";
+		coarse_args["solver"]["advanced"]["multi_fidelity"]["enabled"] = false;
+		coarse_args["solver"]["advanced"]["derivative_check"]["enabled"] = false;
+
+		// same meshes, so the shape and per-element variables map to the coarse states unchanged
+		const json state_patch = {{"space", {{"discr_order", mf_args["discr_order"]}}}};
+		const solver::CacheLevel level = states.empty() ? solver::CacheLevel::Derivatives : states[0]->optimization_enabled;
+
+		adjoint_logger().info("Creating the coarse states...");
+		std::unique_ptr<solver::AdjointNLProblem> coarse_problem = solver::AdjointOptUtils::create_problem(coarse_args, level, utils::get_n_threads(), state_patch);
+
+		// the tolerance is relative to the initial gradient
+		coarse_problem->solution_changed(x);
+		Eigen::VectorXd grad;
+		coarse_problem->gradient(x, grad);
+		coarse_problem->set_gradient_norm_stop(mf_args["relative_gradient_norm"].get<double>() * grad.norm());
+
+		auto nl_solver = solver::AdjointOptUtils::make_nl_solver(
+			args["solver"]["nonlinear"],
+			args["solver"]["linear"],
+			args["solver"]["advanced"]["characteristic_length"]);
+		nl_solver->stop_criteria().iterations = mf_args["max_iterations"];
+
+		adjoint_logger().info("Optimizing the coarse states...");
+		try
+		{
+			nl_solver->minimize(*coarse_problem, x);
+		}
+		catch (const std::exception &e)
+		{
+			// the fine states continue from the last coarse iterate
+			adjoint_logger().warn("Coarse optimization stopped: {}", e.what());
+		}
+		adjoint_logger().info("Switching to the fine states");
+	}
+
 	void OptState::solve(Eigen::VectorXd &x)
 	{
+		if (args["solver"]["advanced"]["multi_fidelity"]["enabled"])
+			solve_coarse(x);
+
 		auto nl_solver = solver::AdjointOptUtils::make_nl_solver(
 			args["solver"]["nonlinear"],
 			args["solver"]["linear"],
@@ -79,6 +79,10 @@ namespace polyfem
 			return "";
 		}
 
+		/// @brief runs the first iterations on states with a lower discretization order, until the gradient norm drops
+		/// @param[in,out] x variables, from the initial guess to the coarse optimum
+		void solve_coarse(Eigen::VectorXd &x);
+
 		/// initializing the logger meant for internal usage
 		void init_logger(const std::vector<spdlog::sink_ptr> &sinks, const spdlog::level::level_enum log_level);
 
@@ -5,6 +5,8 @@
 #include <polyfem/io/Evaluator.hpp>
 #include <polyfem/io/Evaluator.hpp>
 
+#include <polyfem/assembler/AssemblerUtils.hpp>
+#include <polyfem/assembler/HourglassStabilization.hpp>
 #include <polyfem/assembler/Mass.hpp>
 #include <polyfem/assembler/MultiModel.hpp>
 
@@ -17,10 +19,17 @@
 #include <polyfem/mesh/MeshUtils.hpp>
 #include <polyfem/mesh/collision_proxy/CollisionProxy.hpp>
 
+#include <polyfem/problem/ProblemWithSolution.hpp>
+
+#include <polyfem/solver/forms/ContactForm.hpp>
+#include <polyfem/time_integrator/ExplicitTimeIntegrator.hpp>
+
 #include <polyfem/basis/LagrangeBasis2d.hpp>
 #include <polyfem/basis/LagrangeBasis3d.hpp>
+#include <polyfem/basis/NodeOrdering.hpp>
 
 #include <polyfem/refinement/APriori.hpp>
+#include <polyfem/refinement/APosteriori.hpp>
 
 #include <polyfem/basis/SplineBasis2d.hpp>
 #include <polyfem/basis/SplineBasis3d.hpp>
@@ -40,6 +49,7 @@
 #include <polyfem/quadrature/TriQuadrature.hpp>
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/Timer.hpp>
 
 #include <polysolve/linear/FEMSolver.hpp>
@@ -223,6 +233,137 @@ namespace polyfem
 
 			return true;
 		}
+
+		/// Keeps the boundary primitives whose boundary id is one of surface_ids
+		std::vector<LocalBoundary> select_boundary_primitives(
+			const Mesh &mesh,
+			const std::vector<LocalBoundary> &total_local_boundary,
+			const std::vector<int> &surface_ids)
+		{
+			std::vector<LocalBoundary> selected;
+			for (const LocalBoundary &lb : total_local_boundary)
+			{
+				LocalBoundary selected_lb(lb.element_id(), lb.type());
+				for (int i = 0; i < lb.size(); ++i)
+				{
+					const int primitive = lb.global_primitive_id(i);
+					if (std::find(surface_ids.begin(), surface_ids.end(), mesh.get_boundary_id(primitive)) != surface_ids.end())
+						selected_lb.add_boundary_primitive(primitive, lb[i]);
+				}
+				if (!selected_lb.empty())
+					selected.push_back(selected_lb);
+			}
+			return selected;
+		}
+
+		/// Same elements, with the same bases, nodes and weights
+		bool same_bases(const std::vector<basis::ElementBases> &a, const std::vector<basis::ElementBases> &b)
+		{
+			if (a.size() != b.size())
+				return false;
+
+			for (size_t e = 0; e < a.size(); ++e)
+			{
+				if (a[e].bases.size() != b[e].bases.size() || a[e].has_parameterization != b[e].has_parameterization)
+					return false;
+
+				for (size_t j = 0; j < a[e].bases.size(); ++j)
+				{
+					const auto &ga = a[e].bases[j].global();
+					const auto &gb = b[e].bases[j].global();
+					if (ga.size() != gb.size())
+						return false;
+					for (size_t k = 0; k < ga.size(); ++k)
+					{
+						if (ga[k].index != gb[k].index || ga[k].val != gb[k].val || ga[k].node != gb[k].node)
+							return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		/// Replaces the default quadratures of the Lagrange elements by the ones adapted to the form and to the
+		/// degree of their geometric mapping, see AssemblerUtils::adaptive_quadrature_order
+		void set_adaptive_quadrature(
+			const Mesh &mesh,
+			const std::string &assembler,
+			const bool is_linear,
+			const Eigen::VectorXi &disc_orders,
+			const bool set_stiffness,
+			const bool set_mass,
+			std::vector<basis::ElementBases> &bases)
+		{
+			const int dim = mesh.dimension();
+			int n_changed = 0;
+			for (int e = 0; e < bases.size(); ++e)
+			{
+				if (mesh.is_polytope(e) || !(mesh.is_simplex(e) || mesh.is_cube(e)))
+					continue;
+
+				const bool is_simplex = mesh.is_simplex(e);
+				const AssemblerUtils::BasisType b_type = is_simplex ? AssemblerUtils::BasisType::SIMPLEX_LAGRANGE : AssemblerUtils::BasisType::CUBE_LAGRANGE;
+				const int discr_order = disc_orders(e);
+				const int geom_degree = mesh.orders().size() > 0 ? mesh.orders()(e) : 1;
+
+				const auto make_quadrature = [dim, is_simplex](const int order) {
+					return [dim, is_simplex, order](quadrature::Quadrature &quad) {
+						if (dim == 2 && is_simplex)
+							quadrature::TriQuadrature().get_quadrature(order, quad);
+						else if (dim == 2)
+							quadrature::QuadQuadrature().get_quadrature(order, quad);
+						else if (is_simplex)
+							quadrature::TetQuadrature().get_quadrature(order, quad);
+						else
+							quadrature::HexQuadrature().get_quadrature(order, quad);
+					};
+				};
+
+				bool changed = false;
+				if (set_stiffness)
+				{
+					const int order = AssemblerUtils::adaptive_quadrature_order(assembler, is_linear, discr_order, b_type, dim, geom_degree);
+					if (order != AssemblerUtils::quadrature_order(assembler, discr_order, b_type, dim))
+					{
+						bases[e].set_quadrature(make_quadrature(order));
+						changed = true;
+					}
+				}
+				if (set_mass)
+				{
+					const int order = AssemblerUtils::adaptive_quadrature_order("Mass", true, discr_order, b_type, dim, geom_degree);
+					if (order != AssemblerUtils::quadrature_order("Mass", discr_order, b_type, dim))
+					{
+						bases[e].set_mass_quadrature(make_quadrature(order));
+						changed = true;
+					}
+				}
+
+				// the element no longer shares the quadrature of its reference element
+				if (changed)
+				{
+					bases[e].reference_key = -1;
+					++n_changed;
+				}
+			}
+
+			logger().debug("Adaptive quadrature changed the quadrature of {}/{} elements", n_changed, bases.size());
+		}
+
+		/// Shares the assembly values caches of the source of the state, if they have the same discretization
+		bool share_assembly_caches(State &state)
+		{
+			const std::shared_ptr<const State> source = state.assembly_caches_source.lock();
+			if (!source || !state.has_same_discretization(*source))
+				return false;
+
+			state.ass_vals_cache = source->ass_vals_cache;
+			state.mass_ass_vals_cache = source->mass_ass_vals_cache;
+			state.pressure_ass_vals_cache = source->pressure_ass_vals_cache;
+			logger().debug("Sharing the assembly values caches of a State with the same discretization");
+			return true;
+		}
 	} // namespace
 
 	std::vector<int> State::primitive_to_node() const
@@ -551,7 +692,7 @@ namespace polyfem
 		if (has_periodic_bc())
 			return false;
 
-		if (optimization_enabled == solver::CacheLevel::Derivatives)
+		if (solver::caches_derivatives(optimization_enabled))
 			return false;
 
 		if (mesh->orders().size() <= 0)
@@ -575,6 +716,22 @@ namespace polyfem
 		return args["space"]["advanced"]["isoparametric"];
 	}
 
+	bool State::has_same_discretization(const State &other) const
+	{
+		if (!mesh || !other.mesh || mesh->is_volume() != other.mesh->is_volume() || iso_parametric() != other.iso_parametric())
+			return false;
+
+		// the quadrature depends on the assembler and the space settings
+		if (n_bases != other.n_bases || n_pressure_bases != other.n_pressure_bases
+			|| assembler->name() != other.assembler->name()
+			|| args["space"] != other.args["space"]
+			|| args["solver"]["advanced"]["assembly_values_cache"] != other.args["solver"]["advanced"]["assembly_values_cache"]
+			|| args["solver"]["advanced"]["assembly_values_lru_size"] != other.args["solver"]["advanced"]["assembly_values_lru_size"])
+			return false;
+
+		return same_bases(bases, other.bases) && same_bases(geom_bases(), other.geom_bases()) && same_bases(pressure_bases, other.pressure_bases);
+	}
+
 	void State::build_basis()
 	{
 		if (!mesh)
@@ -718,6 +875,9 @@ namespace polyfem
 			logger().info("min p: {} max p: {}", disc_orders.minCoeff(), disc_orders.maxCoeff());
 		}
 
+		if (a_posteriori_disc_orders.size() == disc_orders.size())
+			disc_orders = disc_orders.cwiseMax(a_posteriori_disc_orders);
+
 		int quadrature_order = args["space"]["advanced"]["quadrature_order"].get<int>();
 		const int mass_quadrature_order = args["space"]["advanced"]["mass_quadrature_order"].get<int>();
 		if (mixed_assembler != nullptr)
@@ -731,7 +891,7 @@ namespace polyfem
 		}
 
 		// shape optimization needs continuous geometric basis
-		// const bool use_continuous_gbasis = optimization_enabled == solver::CacheLevel::Derivatives;
+		// const bool use_continuous_gbasis = solver::caches_derivatives(optimization_enabled);
 		const bool use_continuous_gbasis = true;
 
 		if (mesh->is_volume())
@@ -798,6 +958,29 @@ namespace polyfem
 			}
 		}
 
+		if (args["space"]["advanced"]["quadrature_policy"] == "adaptive" && args["space"]["basis_type"] != "Spline")
+		{
+			set_adaptive_quadrature(
+				*mesh, assembler->name(), assembler->is_linear(), disc_orders,
+				quadrature_order <= 0, mass_quadrature_order <= 0, bases);
+		}
+
+		reduced_integration_elements.clear();
+		if (args["space"]["advanced"]["reduced_integration"]["enabled"] && args["space"]["basis_type"] != "Spline"
+			&& mixed_assembler == nullptr && quadrature_order <= 0)
+		{
+			if (assembler->parameters().count("mu") == 0)
+				log_and_throw_error("Reduced integration needs a material with a shear modulus, {} has none.", assembler->name());
+
+			for (int e = 0; e < bases.size(); ++e)
+			{
+				if (HourglassStabilization::is_reduced_element(*mesh, e, disc_orders(e)))
+					reduced_integration_elements.push_back(e);
+			}
+			HourglassStabilization::set_reduced_quadrature(mesh->is_volume(), reduced_integration_elements, bases);
+			logger().info("One point integration of {}/{} elements", reduced_integration_elements.size(), bases.size());
+		}
+
 		if (mixed_assembler != nullptr)
 		{
 			assert(bases.size() == pressure_bases.size());
@@ -813,12 +996,32 @@ namespace polyfem
 
 		build_polygonal_basis();
 
+		const basis::NodeOrdering node_ordering = basis::node_ordering_from_string(args["space"]["advanced"]["node_ordering"]);
+		if (node_ordering != basis::NodeOrdering::None)
+		{
+			if (args["space"]["basis_type"] == "Spline" || has_polys || !mesh->is_conforming())
+				logger().warn("Node ordering {} disabled, it works only for Lagrange bases on conforming meshes without polytopes!", args["space"]["advanced"]["node_ordering"].get<std::string>());
+			else if (!mesh_nodes || mesh_nodes->n_nodes() != n_bases)
+				logger().warn("Node ordering {} disabled, the bases are not numbered by the mesh nodes!", args["space"]["advanced"]["node_ordering"].get<std::string>());
+			else
+			{
+				igl::Timer timer2;
+				logger().debug("Reordering nodes...");
+				timer2.start();
+				const Eigen::VectorXi old_to_new = basis::compute_node_ordering(node_ordering, n_bases, bases);
+				basis::renumber_nodes(old_to_new, bases);
+				mesh_nodes->renumber_nodes(old_to_new);
+				timer2.stop();
+				logger().debug("Done (took {}s)", timer2.getElapsedTime());
+			}
+		}
+
 		if (n_geom_bases == 0)
 			n_geom_bases = n_bases;
 
 		auto &gbases = geom_bases();
 
-		if (optimization_enabled == solver::CacheLevel::Derivatives)
+		if (solver::caches_derivatives(optimization_enabled))
 		{
 			std::map<std::array<int, 2>, double> pairs;
 			for (int e = 0; e < gbases.size(); e++)
@@ -1090,7 +1293,23 @@ namespace polyfem
 
 		ass_vals_cache.clear();
 		mass_ass_vals_cache.clear();
-		if (n_bases <= args["solver"]["advanced"]["cache_size"])
+
+		const std::string cache_strategy = args["solver"]["advanced"]["assembly_values_cache"];
+		AssemblyValsCache::Strategy strategy = AssemblyValsCache::Strategy::Full;
+		if (cache_strategy == "compact")
+			strategy = AssemblyValsCache::Strategy::Compact;
+		else if (cache_strategy == "reference")
+			strategy = AssemblyValsCache::Strategy::Reference;
+		else if (cache_strategy == "on_the_fly")
+			strategy = AssemblyValsCache::Strategy::OnTheFly;
+		const int lru_size = args["solver"]["advanced"]["assembly_values_lru_size"];
+		for (AssemblyValsCache *cache : {&ass_vals_cache, &mass_ass_vals_cache, &pressure_ass_vals_cache})
+			cache->set_strategy(strategy, lru_size);
+
+		// the memory estimate mode stops after the bases, the caches are only estimated
+		// the on-the-fly cache only keeps a bounded number of elements, so it does not depend on the size of the mesh
+		if ((n_bases <= args["solver"]["advanced"]["cache_size"] || strategy == AssemblyValsCache::Strategy::OnTheFly)
+			&& !args["output"]["advanced"]["memory_estimate"] && !share_assembly_caches(*this))
 		{
 			timer.start();
 			logger().info("Building cache...");
@@ -1102,6 +1321,9 @@ namespace polyfem
 			logger().info(" took {}s", timer.getElapsedTime());
 		}
 
+		out_geom.init_element_sampling(*mesh, disc_orders, geom_bases(), args["output"]["paraview"]["adaptive_sampling"]);
+		if (probe_writer_)
+			probe_writer_->invalidate();
 		out_geom.build_grid(*mesh, args["output"]["advanced"]["sol_on_grid"]);
 
 		if ((!problem->is_time_dependent() || args["time"]["quasistatic"]) && boundary_nodes.empty())
@@ -1111,6 +1333,149 @@ namespace polyfem
 			else
 				log_and_throw_error("Static problem need to have some Dirichlet nodes!");
 		}
+
+		record_memory_usage();
+	}
+
+	bool State::p_refine_a_posteriori(const Eigen::MatrixXd &sol)
+	{
+		if (mixed_assembler != nullptr || mesh->has_poly() || !mesh->is_simplicial())
+		{
+			logger().warn("A posteriori p-refinement is only supported for simplicial meshes without mixed formulation, skipping it");
+			return false;
+		}
+
+		const json &p_args = args["space"]["advanced"]["a_posteriori"];
+		const int actual_dim = problem->is_scalar() ? 1 : mesh->dimension();
+
+		Eigen::VectorXd indicator;
+		refinement::APosteriori::zz_error_indicator(
+			mesh->is_volume(), actual_dim, n_bases - obstacle.n_vertices(), bases, geom_bases(),
+			sol.topRows((n_bases - obstacle.n_vertices()) * actual_dim), indicator);
+		logger().info("A posteriori error indicator: {:g}", indicator.norm());
+
+		a_posteriori_disc_orders = disc_orders;
+		const int n_refined = refinement::APosteriori::p_refine(
+			indicator, p_args["fraction"], args["space"]["advanced"]["discr_order_max"], a_posteriori_disc_orders);
+
+		return n_refined > 0;
+	}
+
+	void State::update_geometry()
+	{
+		if (!mesh || n_bases <= 0)
+		{
+			build_basis();
+			return;
+		}
+
+		const bool iso = iso_parametric();
+		std::vector<basis::ElementBases> &gbases = iso ? bases : geom_bases_;
+
+		// the nodes are an interpolation of the vertices only for linear geometric mappings
+		bool supported = !mesh->has_poly() && mesh->is_conforming() && args["space"]["basis_type"] != "Spline"
+						 && !has_periodic_bc() && mixed_assembler == nullptr && !collision_mesh_topology.loaded_from_file
+						 && (iso || basis_nodes_to_gbasis_nodes.size() > 0);
+		for (int e = 0; e < gbases.size() && supported; ++e)
+			for (const auto &gbs : gbases[e].bases)
+				supported = supported && gbs.order() == 1;
+
+		if (!supported)
+		{
+			logger().debug("Geometry-only update not supported, rebuilding the bases");
+			build_basis();
+			return;
+		}
+
+		igl::Timer timer;
+		timer.start();
+		logger().debug("Updating geometry...");
+
+		const int dim = mesh->dimension();
+		const int n_fe_bases = n_bases - obstacle.n_vertices();
+		const std::vector<int> node_to_vertex = node_to_primitive();
+
+		utils::maybe_parallel_for(gbases.size(), [&](int start, int end, int thread_id) {
+			for (int e = start; e < end; ++e)
+				for (auto &gbs : gbases[e].bases)
+					for (auto &g : gbs.global())
+						g.node = mesh->point(node_to_vertex[g.index]);
+		});
+
+		Eigen::MatrixXd node_positions(n_fe_bases, dim);
+		if (iso)
+		{
+			for (int i = 0; i < n_fe_bases; ++i)
+				node_positions.row(i) = mesh->point(node_to_vertex[i]);
+		}
+		else
+		{
+			Eigen::VectorXd gnodes(n_geom_bases * dim);
+			for (int i = 0; i < n_geom_bases; ++i)
+				gnodes.segment(i * dim, dim) = mesh->point(node_to_vertex[i]).transpose();
+
+			const Eigen::VectorXd nodes = basis_nodes_to_gbasis_nodes.transpose() * gnodes;
+			for (int i = 0; i < n_fe_bases; ++i)
+				node_positions.row(i) = nodes.segment(i * dim, dim).transpose();
+
+			utils::maybe_parallel_for(bases.size(), [&](int start, int end, int thread_id) {
+				for (int e = start; e < end; ++e)
+					for (auto &bs : bases[e].bases)
+						for (auto &g : bs.global())
+							g.node = node_positions.row(g.index);
+			});
+		}
+
+		for (int n = 0; n < dirichlet_nodes.size(); ++n)
+			dirichlet_nodes_position[n] = node_positions.row(dirichlet_nodes[n]);
+		for (int n = 0; n < neumann_nodes.size(); ++n)
+			neumann_nodes_position[n] = node_positions.row(neumann_nodes[n]);
+
+		{
+			Eigen::MatrixXd vertices(n_bases, dim);
+			vertices.topRows(n_fe_bases) = node_positions;
+			if (obstacle.n_vertices() > 0)
+				vertices.bottomRows(obstacle.n_vertices()) = obstacle.v();
+			if (collision_mesh_topology.displacement_map.size() > 0)
+				vertices = collision_mesh_topology.displacement_map * vertices;
+
+			if (vertices.rows() == collision_mesh_topology.is_on_surface.size())
+				build_collision_mesh(collision_mesh_topology, vertices, collision_mesh);
+			else
+				build_collision_mesh();
+		}
+
+		rhs.resize(0, 0);
+
+		if (args["space"]["advanced"]["count_flipped_els"])
+			stats.count_flipped_elements(*mesh, gbases);
+		stats.compute_mesh_size(*mesh, gbases, 10, args["output"]["advanced"]["curved_mesh_size"]);
+
+		if (is_contact_enabled())
+		{
+			min_boundary_edge_length = std::numeric_limits<double>::max();
+			for (const auto &edge : collision_mesh.edges().rowwise())
+			{
+				const VectorNd v0 = collision_mesh.rest_positions().row(edge(0));
+				const VectorNd v1 = collision_mesh.rest_positions().row(edge(1));
+				min_boundary_edge_length = std::min(min_boundary_edge_length, (v1 - v0).norm());
+			}
+		}
+
+		// same strategy as in build_basis
+		const bool has_cache = ass_vals_cache.strategy() == AssemblyValsCache::Strategy::OnTheFly || n_bases <= args["solver"]["advanced"]["cache_size"];
+		ass_vals_cache.clear();
+		mass_ass_vals_cache.clear();
+		if (has_cache && !args["output"]["advanced"]["memory_estimate"] && !share_assembly_caches(*this))
+		{
+			ass_vals_cache.init(mesh->is_volume(), bases, gbases);
+			mass_ass_vals_cache.init(mesh->is_volume(), bases, gbases, true);
+		}
+
+		out_geom.build_grid(*mesh, args["output"]["advanced"]["sol_on_grid"]);
+
+		timer.stop();
+		logger().debug("Done (took {}s)", timer.getElapsedTime());
 	}
 
 	void State::build_polygonal_basis()
@@ -1414,7 +1779,7 @@ namespace polyfem
 		build_collision_mesh(
 			*mesh, n_bases, bases, geom_bases(), total_local_boundary, obstacle,
 			args, [this](const std::string &p) { return resolve_input_path(p); },
-			in_node_to_node, collision_mesh);
+			in_node_to_node, collision_mesh, &collision_mesh_topology);
 	}
 
 	void State::build_collision_mesh(
@@ -1427,19 +1792,34 @@ namespace polyfem
 		const json &args,
 		const std::function<std::string(const std::string &)> &resolve_input_path,
 		const Eigen::VectorXi &in_node_to_node,
-		ipc::CollisionMesh &collision_mesh)
+		ipc::CollisionMesh &collision_mesh,
+		CollisionMeshTopology *topology)
 	{
 		Eigen::MatrixXd collision_vertices;
 		Eigen::VectorXi collision_codim_vids;
 		Eigen::MatrixXi collision_edges, collision_triangles;
 		std::vector<Eigen::Triplet<double>> displacement_map_entries;
 
+		// Only the boundary primitives with a selected surface id can be in contact
+		std::vector<int> contact_surface_ids;
+		if (args.contains("/contact/surface_selection"_json_pointer))
+			contact_surface_ids = args.at("/contact/surface_selection"_json_pointer).get<std::vector<int>>();
+		std::vector<LocalBoundary> selected_local_boundary;
+		if (!contact_surface_ids.empty())
+		{
+			selected_local_boundary = select_boundary_primitives(mesh, total_local_boundary, contact_surface_ids);
+			logger().debug("Contact restricted to the surfaces {}", contact_surface_ids);
+		}
+		const std::vector<LocalBoundary> &contact_local_boundary = contact_surface_ids.empty() ? total_local_boundary : selected_local_boundary;
+
 		if (args.contains("/contact/collision_mesh"_json_pointer)
 			&& args.at("/contact/collision_mesh/enabled"_json_pointer).get<bool>())
 		{
 			const json collision_mesh_args = args.at("/contact/collision_mesh"_json_pointer);
 			if (collision_mesh_args.contains("linear_map"))
 			{
+				if (!contact_surface_ids.empty())
+					logger().warn("Contact surface selection is ignored for a collision mesh loaded from a file");
 				assert(displacement_map_entries.empty());
 				assert(collision_mesh_args.contains("mesh"));
 				const std::string root_path = utils::json_value<std::string>(args, "root_path", "");
@@ -1459,11 +1839,28 @@ namespace polyfem
 					collision_mesh_args["max_edge_length"].get<double>());
 				igl::Timer timer;
 				timer.start();
-				build_collision_proxy(
-					bases, geom_bases, total_local_boundary, n_bases, mesh.dimension(),
-					collision_mesh_args["max_edge_length"], collision_vertices,
-					collision_triangles, displacement_map_entries,
-					collision_mesh_args["tessellation_type"]);
+				const double max_edge_length = collision_mesh_args["max_edge_length"];
+				const mesh::CollisionProxyTessellation tessellation = collision_mesh_args["tessellation_type"];
+				const int num_fe_nodes = n_bases - obstacle.n_vertices();
+
+				// the proxy is only rebuilt if the cache was saved for a different mesh or discretization
+				const std::string cache_path = collision_mesh_args.contains("cache") ? resolve_input_path(collision_mesh_args["cache"].get<std::string>()) : "";
+				const std::string hash = cache_path.empty() ? "" : mesh::collision_proxy_hash(bases, geom_bases, contact_local_boundary, max_edge_length, tessellation);
+				if (!cache_path.empty()
+					&& mesh::load_cached_collision_proxy(cache_path, hash, num_fe_nodes, collision_vertices, collision_triangles, displacement_map_entries))
+				{
+					logger().debug("Loaded collision proxy from {}", cache_path);
+				}
+				else
+				{
+					build_collision_proxy(
+						bases, geom_bases, contact_local_boundary, n_bases, mesh.dimension(),
+						max_edge_length, collision_vertices,
+						collision_triangles, displacement_map_entries,
+						tessellation);
+					if (!cache_path.empty())
+						mesh::save_collision_proxy(cache_path, hash, num_fe_nodes, collision_vertices, collision_triangles, displacement_map_entries);
+				}
 				if (collision_triangles.size())
 					igl::edges(collision_triangles, collision_edges);
 				timer.stop();
@@ -1477,7 +1874,7 @@ namespace polyfem
 		else
 		{
 			io::OutGeometryData::extract_boundary_mesh(
-				mesh, n_bases - obstacle.n_vertices(), bases, total_local_boundary,
+				mesh, n_bases - obstacle.n_vertices(), bases, contact_local_boundary,
 				collision_vertices, collision_edges, collision_triangles, displacement_map_entries);
 		}
 
@@ -1505,24 +1902,43 @@ namespace polyfem
 			}
 		}
 
-		std::vector<bool> is_on_surface = ipc::CollisionMesh::construct_is_on_surface(
+		CollisionMeshTopology local_topology;
+		CollisionMeshTopology &cur_topology = topology ? *topology : local_topology;
+
+		cur_topology.is_on_surface = ipc::CollisionMesh::construct_is_on_surface(
 			collision_vertices.rows(), collision_edges);
 		for (const int vid : collision_codim_vids)
 		{
-			is_on_surface[vid] = true;
+			cur_topology.is_on_surface[vid] = true;
 		}
 
-		Eigen::SparseMatrix<double> displacement_map;
+		cur_topology.displacement_map.resize(0, 0);
 		if (!displacement_map_entries.empty())
 		{
-			displacement_map.resize(collision_vertices.rows(), n_bases);
-			displacement_map.setFromTriplets(displacement_map_entries.begin(), displacement_map_entries.end());
+			cur_topology.displacement_map.resize(collision_vertices.rows(), n_bases);
+			cur_topology.displacement_map.setFromTriplets(displacement_map_entries.begin(), displacement_map_entries.end());
 		}
 
+		cur_topology.edges = collision_edges;
+		cur_topology.faces = collision_triangles;
+		cur_topology.num_fe_collision_vertices = num_fe_collision_vertices;
+		cur_topology.loaded_from_file = args.contains("/contact/collision_mesh"_json_pointer)
+										&& args.at("/contact/collision_mesh/enabled"_json_pointer).get<bool>()
+										&& args.at("/contact/collision_mesh"_json_pointer).contains("linear_map");
+
+		build_collision_mesh(cur_topology, collision_vertices, collision_mesh);
+	}
+
+	void State::build_collision_mesh(
+		const CollisionMeshTopology &topology,
+		const Eigen::MatrixXd &vertices,
+		ipc::CollisionMesh &collision_mesh)
+	{
 		collision_mesh = ipc::CollisionMesh(
-			is_on_surface, collision_vertices, collision_edges, collision_triangles,
-			displacement_map);
+			topology.is_on_surface, vertices, topology.edges, topology.faces,
+			topology.displacement_map);
 
+		const int num_fe_collision_vertices = topology.num_fe_collision_vertices;
 		collision_mesh.can_collide = [&collision_mesh, num_fe_collision_vertices](size_t vi, size_t vj) {
 			// obstacles do not collide with other obstacles
 			return collision_mesh.to_full_vertex_id(vi) < num_fe_collision_vertices
@@ -1618,12 +2034,33 @@ namespace polyfem
 		stats.num_dofs = mass.rows();
 		stats.mat_size = (long long)mass.rows() * (long long)mass.cols();
 		logger().info("sparsity: {}/{}", stats.nn_zero, stats.mat_size);
+
+		record_memory_usage();
+	}
+
+	void State::assemble_hourglass_stiffness()
+	{
+		hourglass_stiffness.resize(0, 0);
+		if (reduced_integration_elements.empty())
+			return;
+
+		POLYFEM_SCOPED_TIMER("assemble hourglass stiffness");
+		const std::map<std::string, Assembler::ParamFunc> params = assembler->parameters();
+		const auto mu = params.find("mu");
+		if (mu == params.end())
+			log_and_throw_error("Reduced integration needs a material with a shear modulus, {} has none.", assembler->name());
+
+		HourglassStabilization::assemble(
+			mesh->is_volume(), n_bases, bases, geom_bases(), reduced_integration_elements,
+			mu->second, args["space"]["advanced"]["reduced_integration"]["hourglass_coefficient"],
+			hourglass_stiffness);
 	}
 
 	std::shared_ptr<RhsAssembler> State::build_rhs_assembler(
 		const int n_bases_,
 		const std::vector<basis::ElementBases> &bases_,
-		const assembler::AssemblyValsCache &ass_vals_cache_) const
+		const assembler::AssemblyValsCache &ass_vals_cache_,
+		const assembler::Problem *rhs_problem) const
 	{
 		json rhs_solver_params = args["solver"]["linear"];
 		if (!rhs_solver_params.contains("Pardiso"))
@@ -1636,9 +2073,9 @@ namespace polyfem
 			*assembler, *mesh, obstacle,
 			dirichlet_nodes, neumann_nodes,
 			dirichlet_nodes_position, neumann_nodes_position,
-			n_bases_, size, bases_, geom_bases(), ass_vals_cache_, *problem,
+			n_bases_, size, bases_, geom_bases(), ass_vals_cache_, rhs_problem ? *rhs_problem : *problem,
 			args["space"]["advanced"]["bc_method"],
-			rhs_solver_params);
+			rhs_solver_params, args["space"]["advanced"]["initial_projection"]);
 	}
 
 	std::shared_ptr<PressureAssembler> State::build_pressure_assembler(
@@ -1671,19 +2108,10 @@ namespace polyfem
 
 		igl::Timer timer;
 
-		json p_params = {};
-		p_params["formulation"] = assembler->name();
-		p_params["root_path"] = root_path();
-		{
-			RowVectorNd min, max, delta;
-			mesh->bounding_box(min, max);
-			delta = (max - min) / 2. + min;
-			if (mesh->is_volume())
-				p_params["bbox_center"] = {delta(0), delta(1), delta(2)};
-			else
-				p_params["bbox_center"] = {delta(0), delta(1)};
-		}
-		problem->set_parameters(p_params);
+		problem->set_parameters(problem_parameters());
+		// the parameters may change the exact solution
+		if (const auto *p = dynamic_cast<const problem::ProblemWithSolution *>(problem.get()))
+			p->clear_table();
 
 		rhs.resize(0, 0);
 
@@ -1728,6 +2156,23 @@ namespace polyfem
 		logger().info(" took {}s", timings.assigning_rhs_time);
 	}
 
+	json State::problem_parameters() const
+	{
+		json p_params = {};
+		p_params["formulation"] = assembler->name();
+		p_params["root_path"] = root_path();
+
+		RowVectorNd min, max, delta;
+		mesh->bounding_box(min, max);
+		delta = (max - min) / 2. + min;
+		if (mesh->is_volume())
+			p_params["bbox_center"] = {delta(0), delta(1), delta(2)};
+		else
+			p_params["bbox_center"] = {delta(0), delta(1)};
+
+		return p_params;
+	}
+
 	void State::solve_problem(Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure)
 	{
 		if (!mesh)
@@ -1776,10 +2221,16 @@ namespace polyfem
 				solve_transient_navier_stokes_split(time_steps, dt, sol, pressure);
 			else if (is_homogenization())
 				solve_homogenization(time_steps, t0, dt, sol);
+			else if (time_integrator::ExplicitTimeIntegrator::is_explicit(args["time"]["integrator"]) && !problem->is_scalar() && mixed_assembler == nullptr)
+				solve_transient_tensor_explicit(time_steps, t0, dt, sol);
 			else if (is_problem_linear())
 				solve_transient_linear(time_steps, t0, dt, sol, pressure);
 			else if (!assembler->is_linear() && problem->is_scalar())
 				throw std::runtime_error("Nonlinear scalar problems are not supported yet!");
+			else if (args["time"]["parareal"]["enabled"])
+				solve_transient_tensor_parareal(time_steps, t0, dt, sol);
+			else if (args["time"]["adaptive"]["enabled"])
+				solve_transient_tensor_adaptive(t0, t0 + time_steps * dt, dt, sol);
 			else
 				solve_transient_tensor_nonlinear(time_steps, t0, dt, sol);
 		}
@@ -1811,9 +2262,22 @@ namespace polyfem
 			}
 		}
 
+		wait_for_async_export();
+
 		timer.stop();
 		timings.solving_time = timer.getElapsedTime();
 		logger().info(" took {}s", timings.solving_time);
+
+		if (solve_data.contact_form != nullptr)
+		{
+			const auto &ccd_timings = solve_data.contact_form->ccd_timings();
+			timings.ccd_broad_phase_time = ccd_timings.broad_phase;
+			timings.ccd_narrow_phase_time = ccd_timings.narrow_phase;
+			timings.ccd_time = ccd_timings.ccd;
+			timings.ccd_broad_phase_method = json(solve_data.contact_form->broad_phase_method()).get<std::string>();
+			timings.ccd_broad_phase_selections = solve_data.contact_form->broad_phase_selections();
+			logger().debug("CCD broad phase {}s ({}), narrow phase {}s, ccd {}s", timings.ccd_broad_phase_time, timings.ccd_broad_phase_method, timings.ccd_narrow_phase_time, timings.ccd_time);
+		}
 	}
 
 } // namespace polyfem
@@ -31,12 +31,17 @@
 #include <polyfem/assembler/PeriodicBoundary.hpp>
 
 #include <polyfem/io/OutData.hpp>
+#include <polyfem/io/SolutionFrameBuffer.hpp>
+#include <polyfem/io/ProbeWriter.hpp>
+
+#include <polyfem/StateObserver.hpp>
 
 #include <polysolve/linear/Solver.hpp>
 
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -75,6 +80,11 @@ namespace polyfem
 	};
 
 	/// main class that contains the polyfem solver and all its state
+	///
+	/// Independent States can be initialized and solved concurrently from different threads. The loggers
+	/// (including the ipc and wmtk ones), the thread limit of set_max_threads and the geogram initialization
+	/// are process-wide: the last State setting them wins. A single State is not thread-safe, and remeshing
+	/// keeps process-wide counters and timings which are only meaningful for one State at a time.
 	class State
 	{
 	public:
@@ -86,7 +96,7 @@ namespace polyfem
 		/// Constructor
 		State();
 
-		/// @param[in] max_threads max number of threads
+		/// @param[in] max_threads max number of threads, shared by all the States of the process
 		void set_max_threads(const int max_threads = std::numeric_limits<int>::max());
 
 		/// initialize the polyfem solver with a json settings
@@ -109,11 +119,13 @@ namespace polyfem
 		/// @param[in] log_level 0 all message, 6 no message. 2 is info, 1 is debug
 		/// @param[in] file_log_level 0 all message, 6 no message. 2 is info, 1 is debug
 		/// @param[in] is_quit quiets the log
+		/// @param[in] async formats and writes the messages on a separate thread, dropping the oldest ones if it falls behind
 		void init_logger(
 			const std::string &log_file,
 			const spdlog::level::level_enum log_level,
 			const spdlog::level::level_enum file_log_level,
-			const bool is_quiet);
+			const bool is_quiet,
+			const bool async = false);
 
 		/// initializing the logger writes to an output stream
 		/// @param[in] os output stream
@@ -136,7 +148,7 @@ namespace polyfem
 
 	private:
 		/// initializing the logger meant for internal usage
-		void init_logger(const std::vector<spdlog::sink_ptr> &sinks, const spdlog::level::level_enum log_level);
+		void init_logger(const std::vector<spdlog::sink_ptr> &sinks, const spdlog::level::level_enum log_level, const bool async = false);
 
 		/// logger sink to stdout
 		spdlog::sink_ptr console_sink_ = nullptr;
@@ -188,6 +200,8 @@ namespace polyfem
 
 		/// vector of discretization orders, used when not all elements have the same degree, one per element
 		Eigen::VectorXi disc_orders;
+		/// lower bound of the discretization orders set by a posteriori p-refinement, one per element (empty if unused)
+		Eigen::VectorXi a_posteriori_disc_orders;
 
 		/// Mapping from input nodes to FE nodes
 		std::shared_ptr<polyfem::mesh::MeshNodes> mesh_nodes, geom_mesh_nodes, pressure_mesh_nodes;
@@ -198,13 +212,40 @@ namespace polyfem
 		/// used to store assembly values for pressure for small problems
 		assembler::AssemblyValsCache pressure_ass_vals_cache;
 
+		/// State whose assembly values caches are shared (copy-on-write) by build_basis and update_geometry instead
+		/// of computed, as long as both States have the same discretization (see has_same_discretization)
+		std::weak_ptr<const State> assembly_caches_source;
+
+		/// check if the bases of the two States are identical (nodes, weights and quadrature), so they can share their assembly values caches
+		/// @param[in] other other State
+		/// @return if the discretizations are the same
+		bool has_same_discretization(const State &other) const;
+
 		/// Mass matrix, it is computed only for time dependent problems
 		StiffnessMatrix mass;
 		/// average system mass, used for contact with IPC
 		double avg_mass;
 
+		/// elements integrated with one point, see assembler::HourglassStabilization
+		std::vector<int> reduced_integration_elements;
+		/// hourglass stiffness of the reduced_integration_elements, empty without reduced integration
+		StiffnessMatrix hourglass_stiffness;
+
 		/// System right-hand side.
 		Eigen::MatrixXd rhs;
+		/// coarse solution interpolated on the current bases, initial guess of static solves (empty if unused)
+		Eigen::MatrixXd prolongated_solution;
+
+		/// solution on another mesh the initial solution is projected from, see set_warm_start
+		struct WarmStart
+		{
+			std::unique_ptr<mesh::Mesh> mesh;
+			std::vector<basis::ElementBases> bases;
+			std::vector<basis::ElementBases> geom_bases;
+			Eigen::MatrixXd sol;
+		};
+		/// warm start of the initial solution (null if unused)
+		std::shared_ptr<const WarmStart> warm_start;
 
 		/// use average pressure for stokes problem to fix the additional dofs, true by default
 		/// if false, it will fix one pressure node to zero
@@ -230,20 +271,32 @@ namespace polyfem
 		/// dirichlet_nodes, neumann_nodes, local_boundary, total_local_boundary
 		/// local_neumann_boundary, polys, poly_edge_to_data, rhs
 		void build_basis();
+		/// updates the geometric quantities after the vertices of the mesh moved (e.g., set_mesh_vertex)
+		/// keeps the topology, the numbering of the nodes and the boundary conditions, recomputes the node positions,
+		/// the collision mesh vertices and the assembly values; calls build_basis if the nodes are not linear in the vertices
+		void update_geometry();
 		/// compute rhs, step 3 of solve
 		/// build rhs vector based on defined basis and given rhs of the problem
 		/// modifies rhs (and maybe more?)
 		void assemble_rhs();
+		/// parameters of the problem depending on the discretization (formulation, root path and center of the mesh)
+		json problem_parameters() const;
 		/// assemble mass, step 4 of solve
 		/// build mass matrix based on defined basis
 		/// modifies mass (and maybe more?)
 		void assemble_mass_mat();
 
+		/// assemble the hourglass stiffness of the reduced_integration_elements with the current materials
+		/// modifies hourglass_stiffness
+		void assemble_hourglass_stiffness();
+
 		/// build a RhsAssembler for the problem
+		/// @param[in] rhs_problem problem giving the loads and boundary values, the problem of the state if null
 		std::shared_ptr<assembler::RhsAssembler> build_rhs_assembler(
 			const int n_bases,
 			const std::vector<basis::ElementBases> &bases,
-			const assembler::AssemblyValsCache &ass_vals_cache) const;
+			const assembler::AssemblyValsCache &ass_vals_cache,
+			const assembler::Problem *rhs_problem = nullptr) const;
 		/// build a RhsAssembler for the problem
 		std::shared_ptr<assembler::RhsAssembler> build_rhs_assembler() const
 		{
@@ -317,9 +370,48 @@ namespace polyfem
 			solve_export_to_file = false;
 			solution_frames.clear();
 			solve_problem(sol, pressure);
+
+			const int n_p_refinements = args["space"]["advanced"]["a_posteriori"]["iterations"];
+			for (int i = 0; i < n_p_refinements && !problem->is_time_dependent(); ++i)
+			{
+				if (!p_refine_a_posteriori(sol))
+					break;
+
+				build_basis();
+				assemble_rhs();
+				assemble_mass_mat();
+
+				solution_frames.clear();
+				solve_problem(sol, pressure);
+			}
 			solve_export_to_file = true;
 		}
 
+		/// solves the static problem on the loaded mesh and on its uniform refinements, refining the
+		/// mesh in place; each level starts from the previous solution interpolated on its bases and
+		/// the errors and timings of all levels are saved in one JSON
+		/// @param[out] sol solution on the finest level
+		/// @param[out] pressure pressure on the finest level
+		void convergence_study(Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure);
+		/// solves the static linear problem for every entry of /load_cases, which only change the loads and
+		/// boundary values of /boundary_conditions; the stiffness is assembled and factorized once, the
+		/// right-hand sides are assembled in parallel and every case is exported with its name appended to
+		/// the output files
+		/// @param[out] sols solutions of the load cases, one per column
+		void solve_load_cases(Eigen::MatrixXd &sols);
+		/// computes the vibration modes K x = lambda M x closest to /modal_analysis/shift, with the Dirichlet
+		/// dofs fixed, by shift-invert Lanczos on a single factorization of K - shift M; every mode is exported
+		/// with _mode<i> appended to the output files and the eigenvalues are saved in the output JSON
+		/// @param[out] eigenvalues eigenvalues, by increasing distance to the shift
+		/// @param[out] modes M-orthonormal modes, one per column
+		void modal_analysis(Eigen::VectorXd &eigenvalues, Eigen::MatrixXd &modes);
+
+		/// raises disc_orders where the recovery-based error indicator of sol is largest,
+		/// the next build_basis uses the raised orders
+		/// @param[in] sol solution
+		/// @return if any element order was raised
+		bool p_refine_a_posteriori(const Eigen::MatrixXd &sol);
+
 		/// timedependent stuff cached
 		solver::SolveData solve_data;
 		/// initialize solver
@@ -352,6 +444,27 @@ namespace polyfem
 		/// @param[in] dt timestep size
 		/// @param[out] sol solution
 		void solve_transient_tensor_nonlinear(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol);
+		/// solves transient tensor nonlinear problem with an explicit integrator and a lumped mass,
+		/// each time step is split in substeps below the critical time step
+		/// @param[in] time_steps number of time steps
+		/// @param[in] t0 initial times
+		/// @param[in] dt timestep size
+		/// @param[out] sol solution
+		void solve_transient_tensor_explicit(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol);
+		/// solves transient tensor nonlinear problem with adaptive time steps, see /time/adaptive,
+		/// every accepted step is saved at its own time
+		/// @param[in] t0 initial times
+		/// @param[in] tend final time
+		/// @param[in] dt initial timestep size
+		/// @param[out] sol solution
+		void solve_transient_tensor_adaptive(const double t0, const double tend, const double dt, Eigen::MatrixXd &sol);
+		/// solves transient tensor nonlinear problem in parallel over time slices with parareal, see /time/parareal,
+		/// the fine propagator of every slice runs on its own copy of the state
+		/// @param[in] time_steps number of time steps
+		/// @param[in] t0 initial times
+		/// @param[in] dt timestep size
+		/// @param[out] sol solution
+		void solve_transient_tensor_parareal(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol);
 		/// initialize the nonlinear solver
 		/// @param[out] sol solution
 		/// @param[in] t (optional) initial time
@@ -362,6 +475,12 @@ namespace polyfem
 		/// @brief Load or compute the initial solution.
 		/// @param[out] solution Output solution variable.
 		void initial_solution(Eigen::MatrixXd &solution) const;
+		/// @brief Warm starts the initial solution from the solution of another state, e.g. a coarse solve of the
+		/// same problem. It is evaluated at the points located in the mesh of the source and projected on the bases
+		/// of this state, unless the initial solution is loaded from a file.
+		/// @param[in] source state of the solution, with a simplicial mesh and an affine geometric mapping
+		/// @param[in] source_sol solution of the source, without pressure
+		void set_warm_start(const State &source, const Eigen::MatrixXd &source_sol);
 		/// @brief Load or compute the initial velocity.
 		/// @param[out] solution Output velocity variable.
 		void initial_velocity(Eigen::MatrixXd &velocity) const;
@@ -380,6 +499,10 @@ namespace polyfem
 		/// @param[out] sol solution
 		/// @param[in] t (optional) time step id
 		void solve_tensor_nonlinear(Eigen::MatrixXd &sol, const int t = 0, const bool init_lagging = true);
+		/// replaces the previous solution by the predictor of /time/predictor, as initial guess of the next time step;
+		/// the step is shortened to stay free of collisions and inversions
+		/// @param[in,out] sol previous solution, then initial guess
+		void predict_time_step(Eigen::MatrixXd &sol) const;
 
 		/// factory to create the nl solver depending on input
 		/// @return nonlinear solver (eg newton or LBFGS)
@@ -399,12 +522,14 @@ namespace polyfem
 		/// @param compute_spectrum If true, compute the spectrum.
 		/// @param[out] sol solution
 		/// @param[out] pressure pressure
+		/// @param prefactorized If true, the solver already holds the factorization of A (only when caching derivatives)
 		void solve_linear(
 			const std::unique_ptr<polysolve::linear::Solver> &solver,
 			StiffnessMatrix &A,
 			Eigen::VectorXd &b,
 			const bool compute_spectrum,
-			Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure);
+			Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure,
+			const bool prefactorized = false);
 
 		/// @brief Returns whether the system is linear. Collisions and pressure add nonlinearity to the problem.
 		bool is_problem_linear() const { return assembler->is_linear() && !is_contact_enabled() && !is_pressure_enabled(); }
@@ -484,16 +609,26 @@ namespace polyfem
 		/// @param[in] skip_boundary_sideset skip_boundary_sideset = false it uses the lambda boundary_marker to assign the sideset
 		void load_mesh(GEO::Mesh &meshin, const std::function<int(const RowVectorNd &)> &boundary_marker, bool non_conforming = false, bool skip_boundary_sideset = false);
 
-		/// loads the mesh from V and F,
+		/// loads the mesh from V and F, they can be views of buffers owned by the caller
 		/// @param[in] V is #vertices x dim
 		/// @param[in] F is #elements x size (size = 3 for triangle mesh, size=4 for a quad mesh if dim is 2)
 		/// @param[in] non_conforming creates a conforming/non conforming mesh
-		void load_mesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, bool non_conforming = false)
+		void load_mesh(const ConstMatrixXdView &V, const ConstMatrixXiView &F, bool non_conforming = false)
 		{
 			mesh = mesh::Mesh::create(V, F, non_conforming);
 			load_mesh(non_conforming);
 		}
 
+		/// loads the mesh from interleaved buffers owned by the caller, without copying them first
+		/// @param[in] V n_vertices x dim coordinates, one vertex after the other
+		/// @param[in] n_vertices number of vertices
+		/// @param[in] dim dimension of the vertices
+		/// @param[in] F n_elements x size vertex ids, one element after the other
+		/// @param[in] n_elements number of elements
+		/// @param[in] size number of vertices per element
+		/// @param[in] non_conforming creates a conforming/non conforming mesh
+		void load_mesh(const double *V, const int n_vertices, const int dim, const int *F, const int n_elements, const int size, bool non_conforming = false);
+
 		/// set the boundary sideset from a lambda that takes the face/edge barycenter
 		/// @param[in] boundary_marker function from face/edge barycenter that returns the sideset id
 		void set_boundary_side_set(const std::function<int(const RowVectorNd &)> &boundary_marker)
@@ -535,6 +670,20 @@ namespace polyfem
 		/// @brief IPC collision mesh
 		ipc::CollisionMesh collision_mesh;
 
+		/// @brief inputs of the collision mesh except the vertices, reused when only the vertices move
+		struct CollisionMeshTopology
+		{
+			std::vector<bool> is_on_surface;
+			Eigen::MatrixXi edges;
+			Eigen::MatrixXi faces;
+			/// if not empty, the vertices are displacement_map * [FE nodes; obstacle vertices]
+			Eigen::SparseMatrix<double> displacement_map;
+			int num_fe_collision_vertices = 0;
+			/// the vertices are loaded from a file and are not an interpolation of the FE nodes
+			bool loaded_from_file = false;
+		};
+		CollisionMeshTopology collision_mesh_topology;
+
 		/// @brief IPC collision mesh under periodic BC
 		ipc::CollisionMesh periodic_collision_mesh;
 		/// index mapping from periodic 2x2 collision mesh to FE periodic mesh
@@ -551,6 +700,13 @@ namespace polyfem
 			const json &args,
 			const std::function<std::string(const std::string &)> &resolve_input_path,
 			const Eigen::VectorXi &in_node_to_node,
+			ipc::CollisionMesh &collision_mesh,
+			CollisionMeshTopology *topology = nullptr);
+
+		/// @brief builds the collision mesh from its topology and vertices
+		static void build_collision_mesh(
+			const CollisionMeshTopology &topology,
+			const Eigen::MatrixXd &vertices,
 			ipc::CollisionMesh &collision_mesh);
 
 		/// @brief extracts the boundary mesh for collision, called in build_basis
@@ -595,6 +751,8 @@ namespace polyfem
 		bool solve_export_to_file = true;
 		/// saves the frames in a vector instead of VTU
 		std::vector<io::SolutionFrame> solution_frames;
+		/// if set, the time steps not exported to files go to this bounded buffer instead of solution_frames
+		std::shared_ptr<io::SolutionFrameBuffer> solution_frame_buffer;
 		/// visualization stuff
 		io::OutGeometryData out_geom;
 		/// runtime statistics
@@ -618,6 +776,8 @@ namespace polyfem
 		/// @param[in] sol solution
 		/// @param[in] pressure pressure
 		void save_timestep(const double time, const int t, const double t0, const double dt, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure);
+		/// times of the steps saved by an adaptive transient solve, indexed by time index; empty for fixed time steps
+		std::vector<double> time_sequence;
 
 		/// saves a subsolve when save_solve_sequence_debug is true
 		/// @param[in] i sub solve index
@@ -626,6 +786,11 @@ namespace polyfem
 		/// @param[in] pressure pressure
 		void save_subsolve(const int i, const int t, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure);
 
+		/// evaluates the fields of a frame of solution_frame_buffer, for frames stored as dofs only
+		/// @param[in] i frame index in the buffer, oldest first
+		/// @param[out] frame evaluated fields
+		void evaluate_frame(const int i, io::SolutionFrame &frame);
+
 		/// saves the output statistic to a stream
 		/// @param[in] sol solution
 		/// @param[out] out stream to write output
@@ -638,6 +803,18 @@ namespace polyfem
 		/// @brief computes all errors
 		void compute_errors(const Eigen::MatrixXd &sol);
 
+		/// records the current memory of the bases, assembly caches, matrices, collision set,
+		/// saved solution frames and adjoint cache in stats.memory
+		void record_memory_usage();
+
+		/// @brief estimates the memory of the assembly caches, matrices and factorization from the bases,
+		/// without building them; contact and time-dependent storage are not included
+		/// @return estimated MB of every subsystem, and their total
+		json estimate_memory() const;
+
+		/// logs the memory estimate and saves it to the output JSON
+		void save_memory_estimate() const;
+
 		/// @brief Save a JSON sim file for restarting the simulation at time t
 		/// @param t current time to restart at
 		void save_restart_json(const double t0, const double dt, const int t) const;
@@ -667,6 +844,7 @@ namespace polyfem
 		solver::DiffCache diff_cached;
 
 		std::unique_ptr<polysolve::linear::Solver> lin_solver_cached; // matrix factorization of last linear solve
+		size_t lin_solver_cached_hash = 0;                             // hash of the system factorized in lin_solver_cached
 
 		int ndof() const
 		{
@@ -679,10 +857,14 @@ namespace polyfem
 
 		// Aux functions for setting up adjoint equations
 		void compute_force_jacobian(const Eigen::MatrixXd &sol, const Eigen::MatrixXd &disp_grad, StiffnessMatrix &hessian);
+		/// recomputes the Jacobian and collision sets of a time step evicted by the checkpointing of diff_cached
+		void recompute_transient_adjoint_quantities(const int step, StiffnessMatrix &gradu_h, ipc::Collisions &collision_set, ipc::FrictionCollisions &friction_collision_set);
 		void compute_force_jacobian_prev(const int force_step, const int sol_step, StiffnessMatrix &hessian_prev) const;
 		// Solves the adjoint PDE for derivatives and caches
 		void solve_adjoint_cached(const Eigen::MatrixXd &rhs);
 		Eigen::MatrixXd solve_adjoint(const Eigen::MatrixXd &rhs) const;
+		/// solves the adjoint PDE for several right-hand sides, factorizing every system once
+		std::vector<Eigen::MatrixXd> solve_adjoint(const std::vector<Eigen::MatrixXd> &rhs) const;
 		// Returns cached adjoint solve
 		Eigen::MatrixXd get_adjoint_mat(int type) const
 		{
@@ -701,10 +883,14 @@ namespace polyfem
 		}
 		Eigen::MatrixXd solve_static_adjoint(const Eigen::MatrixXd &adjoint_rhs) const;
 		Eigen::MatrixXd solve_transient_adjoint(const Eigen::MatrixXd &adjoint_rhs) const;
+		std::vector<Eigen::MatrixXd> solve_transient_adjoint(const std::vector<Eigen::MatrixXd> &adjoint_rhs) const;
 		// Change geometric node positions
 		void set_mesh_vertex(int v_id, const Eigen::VectorXd &vertex);
 		void get_vertices(Eigen::MatrixXd &vertices) const;
 		void get_elements(Eigen::MatrixXi &elements) const;
+		// Write into buffers owned by the caller, already of the right size
+		void get_vertices(MatrixXdView vertices) const;
+		void get_elements(MatrixXiView elements) const;
 
 		// Get geometric node indices for surface/volume
 		void compute_surface_node_ids(const int surface_selection, std::vector<int> &node_ids) const;
@@ -713,6 +899,8 @@ namespace polyfem
 
 		// to replace the initial condition in json during initial condition optimization
 		Eigen::MatrixXd initial_sol_update, initial_vel_update;
+		// initial guess of the next static nonlinear solve, set by the optimization from the previous solutions
+		Eigen::MatrixXd warm_start_sol;
 		// mapping from positions of FE basis nodes to positions of geometry nodes
 		StiffnessMatrix basis_nodes_to_gbasis_nodes;
 
@@ -726,7 +914,49 @@ namespace polyfem
 		void solve_homogenization_step(Eigen::MatrixXd &sol, const int t = 0, bool adaptive_initial_weight = false); // sol is the extended solution, i.e. [periodic fluctuation, macro strain]
 		void init_homogenization_solve(const double t);
 		void solve_homogenization(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol);
+		/// Effective stiffness of the cell wrt the flattened macro displacement gradient, from one factorization
+		/// shared by all unit macro strains; it is the tangent at zero fluctuation, exact for linear cells
+		void compute_homogenized_stiffness(const double t, Eigen::MatrixXd &stiffness);
 		bool is_homogenization() const { return args["boundary_conditions"]["periodic_boundary"]["linear_displacement_offset"].size() > 0; }
+
+		//---------------------------------------------------
+		//-----------------observers-------------------------
+		//---------------------------------------------------
+	public:
+		/// registers an observer notified after every time step, nonlinear iteration and remesh
+		void add_observer(const std::shared_ptr<StateObserver> &observer);
+		/// unregisters an observer, after its pending element fields are delivered
+		void remove_observer(const std::shared_ptr<StateObserver> &observer);
+
+	private:
+		/// fills the velocity and collisions of event and notifies the observers
+		void notify_observers(StateEvent &event);
+
+		std::vector<std::shared_ptr<StateObserver>> observers_;
+
+		//---------------------------------------------------
+		//-----------------asynchronous output---------------
+		//---------------------------------------------------
+	public:
+		/// blocks until the time step exported and the observer fields evaluated in the background are done, rethrows their errors
+		void wait_for_async_export();
+
+	private:
+		/// @brief check if a time step can be exported while the next one is solved
+		/// @param[in] opts export options
+		/// @return true if the export only reads data that does not change during the solve
+		bool can_export_async(const io::OutGeometryData::ExportOptions &opts) const;
+
+		/// writer of the time steps if they are streamed in a single hdf5 file, created at the first exported step
+		std::unique_ptr<io::TransientHDF5Writer> transient_writer_;
+		/// writer of the solution at the probes, created at the first time step if there are probes
+		std::unique_ptr<io::ProbeWriter> probe_writer_;
+
+		/// export of the last time step running in the background
+		/// declared last so that it is joined before the data it reads is destroyed
+		std::future<void> async_export_;
+		/// element fields of the last time step evaluated in the background for the observers
+		std::future<void> async_observer_fields_;
 	};
 
 } // namespace polyfem
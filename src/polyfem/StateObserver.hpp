@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ipc
+{
+	class Collisions;
+}
+
+namespace polyfem
+{
+	class State;
+
+	/// Solver event passed to the observers of a State. The data is referenced, not copied,
+	/// and is only valid during the notification.
+	struct StateEvent
+	{
+		enum class Type
+		{
+			TIME_STEP,        ///< after a time step (or the static solve) is saved
+			NEWTON_ITERATION, ///< after an iteration of the nonlinear solver
+			REMESH            ///< after the mesh is adapted, the solution is on the new mesh
+		};
+
+		StateEvent(const Type type, const int step, const double t, const Eigen::Ref<const Eigen::MatrixXd> &solution)
+			: type(type), step(step), t(t), solution(solution)
+		{
+		}
+
+		Type type;
+		int step;           ///< time step index
+		int iteration = -1; ///< nonlinear iteration, only for NEWTON_ITERATION
+		double t;           ///< time
+
+		Eigen::Ref<const Eigen::MatrixXd> solution;    ///< full solution
+		const Eigen::VectorXd *velocity = nullptr;     ///< velocity of the time integrator, null for static problems
+		const ipc::Collisions *collisions = nullptr;   ///< active collisions, null without contact
+	};
+
+	/// Receives the results of a State in memory while it solves, registered with State::add_observer.
+	class StateObserver
+	{
+	public:
+		virtual ~StateObserver() = default;
+
+		/// called on the solver thread after every event
+		virtual void on_event(const State &state, const StateEvent &event) = 0;
+
+		/// names of the scalar fields of the formulation (e.g., von_mises) evaluated at the element centers after every time step
+		virtual std::vector<std::string> element_fields() const { return {}; }
+		/// if true the element fields are evaluated on a worker thread and on_element_fields is called from it
+		virtual bool async_element_fields() const { return false; }
+		/// @param[in] step time step index
+		/// @param[in] t time
+		/// @param[in] fields #elements values of every requested field, NaN on polygonal elements
+		virtual void on_element_fields(const int step, const double t, const std::vector<std::pair<std::string, Eigen::VectorXd>> &fields) {}
+	};
+} // namespace polyfem
@@ -20,6 +20,8 @@ namespace polyfem::assembler
 		if (params.contains("canonical_transformation"))
 		{
 			canonical_transformation_.reserve(params["canonical_transformation"].size());
+			canonical_metric_.reserve(params["canonical_transformation"].size());
+			canonical_det_.reserve(params["canonical_transformation"].size());
 			for (int i = 0; i < params["canonical_transformation"].size(); ++i)
 			{
 				Eigen::MatrixXd transform_matrix(size(), size());
@@ -27,6 +29,115 @@ namespace polyfem::assembler
 					for (int k = 0; k < size(); ++k)
 						transform_matrix(j, k) = params["canonical_transformation"][i][j][k];
 				canonical_transformation_.push_back(transform_matrix);
+				canonical_metric_.push_back(transform_matrix * transform_matrix.transpose());
+				canonical_det_.push_back(transform_matrix.determinant());
+			}
+		}
+	}
+
+	Eigen::VectorXd AMIPSEnergy::assemble_gradient(const NonLinearAssemblerData &data) const
+	{
+		return assemble_gradient_from_stress(data);
+	}
+
+	Eigen::MatrixXd AMIPSEnergy::assemble_hessian(const NonLinearAssemblerData &data) const
+	{
+		return assemble_hessian_from_stress_grad(data);
+	}
+
+	bool AMIPSEnergy::assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const
+	{
+		hessian = assemble_hessian_from_stress_grad(data, true);
+		return true;
+	}
+
+	void AMIPSEnergy::batch_amips_terms(const BatchAssemblerData &data, Eigen::ArrayXXd &C, Eigen::ArrayXd &s, Eigen::ArrayXd &a, Eigen::ArrayXXd &FC, Eigen::ArrayXXd &FmT) const
+	{
+		const int dim = data.dim;
+		const int n_pts = data.size();
+		const Eigen::ArrayXXd &F = data.def_grad;
+
+		// T Tᵀ and det(T) of the element of every point
+		C.resize(n_pts, dim * dim);
+		Eigen::ArrayXd det_T(n_pts);
+		for (int p = 0; p < n_pts; ++p)
+		{
+			const int el_id = data.el_ids(p);
+			assert(el_id < canonical_metric_.size());
+			for (int m = 0; m < dim; ++m)
+				for (int n = 0; n < dim; ++n)
+					C(p, m * dim + n) = canonical_metric_[el_id](m, n);
+			det_T(p) = canonical_det_[el_id];
+		}
+
+		Eigen::ArrayXd J;
+		batch_determinant_inverse_transpose(dim, F, J, FmT);
+
+		FC.setZero(n_pts, dim * dim);
+		for (int i = 0; i < dim; ++i)
+			for (int n = 0; n < dim; ++n)
+				for (int m = 0; m < dim; ++m)
+					FC.col(i * dim + n) += F.col(i * dim + m) * C.col(m * dim + n);
+
+		s = (F * FC).rowwise().sum();
+		a = 1 / (J * det_T).pow(2. / dim);
+	}
+
+	// ψ = tr(GᵀG) / det(G)^(2/dim) with G = F T
+	void AMIPSEnergy::compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const
+	{
+		Eigen::ArrayXd s, a;
+		Eigen::ArrayXXd C, FC, FmT;
+		batch_amips_terms(data, C, s, a, FC, FmT);
+
+		psi = a * s;
+	}
+
+	// P = 2a F T Tᵀ - 2/dim a s F⁻ᵀ
+	void AMIPSEnergy::compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const
+	{
+		const int dim = data.dim;
+
+		Eigen::ArrayXd s, a;
+		Eigen::ArrayXXd C, FC, FmT;
+		batch_amips_terms(data, C, s, a, FC, FmT);
+
+		stress.resize(FC.rows(), FC.cols());
+		for (int k = 0; k < FC.cols(); ++k)
+			stress.col(k) = 2 * a * FC.col(k) - 2. / dim * a * s * FmT.col(k);
+	}
+
+	// ∂P(i, j)/∂F(k, l) = 2a δᵢₖ C(j, l) - 4/dim a (FC(i, j) F⁻ᵀ(k, l) + F⁻ᵀ(i, j) FC(k, l))
+	//                     + 4/dim² a s F⁻ᵀ(i, j) F⁻ᵀ(k, l) + 2/dim a s F⁻ᵀ(i, l) F⁻ᵀ(k, j)
+	void AMIPSEnergy::compute_stress_grad_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress_grad) const
+	{
+		const int dim = data.dim;
+		const int dim2 = dim * dim;
+		const int n_pts = data.size();
+
+		Eigen::ArrayXd s, a;
+		Eigen::ArrayXXd C, FC, FmT;
+		batch_amips_terms(data, C, s, a, FC, FmT);
+
+		const Eigen::ArrayXd as = a * s;
+
+		stress_grad.resize(n_pts, dim2 * dim2);
+		for (int i = 0; i < dim; ++i)
+		{
+			for (int j = 0; j < dim; ++j)
+			{
+				for (int k = 0; k < dim; ++k)
+				{
+					for (int l = 0; l < dim; ++l)
+					{
+						auto col = stress_grad.col((i * dim + j) * dim2 + k * dim + l);
+						col = -4. / dim * a * (FC.col(i * dim + j) * FmT.col(k * dim + l) + FmT.col(i * dim + j) * FC.col(k * dim + l))
+							  + 4. / (dim * dim) * as * FmT.col(i * dim + j) * FmT.col(k * dim + l)
+							  + 2. / dim * as * FmT.col(i * dim + l) * FmT.col(k * dim + j);
+						if (i == k)
+							col += 2 * a * C.col(j * dim + l);
+					}
+				}
 			}
 		}
 	}
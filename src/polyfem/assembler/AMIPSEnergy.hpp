@@ -20,6 +20,20 @@ namespace polyfem::assembler
 	public:
 		AMIPSEnergy();
 
+		using GenericElastic<AMIPSEnergy>::assemble_gradient;
+		using GenericElastic<AMIPSEnergy>::assemble_hessian;
+
+		// closed-form gradient and hessian of the element, contracting the batched stress and its derivative
+		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
+		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
+		bool assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const override;
+
+		// batched energy density, stress and stress derivative, vectorized across the points of several elements
+		bool has_batch_kernels() const override { return true; }
+		void compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const override;
+		void compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const override;
+		void compute_stress_grad_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress_grad) const override;
+
 		// sets material params
 		void add_multimaterial(const int index, const json &params, const Units &units) override;
 
@@ -53,6 +67,13 @@ namespace polyfem::assembler
 		}
 
 	private:
+		/// @brief Quantities shared by the batched kernels, with G = F T the deformation gradient composed with the
+		/// canonical transformation T of the element: C = T Tᵀ, s = tr(GᵀG), a = det(G)^(-2/dim), FC = F C and FmT = F⁻ᵀ
+		void batch_amips_terms(const BatchAssemblerData &data, Eigen::ArrayXXd &C, Eigen::ArrayXd &s, Eigen::ArrayXd &a, Eigen::ArrayXXd &FC, Eigen::ArrayXXd &FmT) const;
+
 		std::vector<Eigen::MatrixXd> canonical_transformation_;
+		/// T Tᵀ and det(T) of every canonical transformation, used by the batched kernels
+		std::vector<Eigen::MatrixXd> canonical_metric_;
+		std::vector<double> canonical_det_;
 	};
 } // namespace polyfem::assembler
\ No newline at end of file
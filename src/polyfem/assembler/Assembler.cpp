@@ -1,10 +1,19 @@
 #include "Assembler.hpp"
 
+#include <polyfem/assembler/AssemblerUtils.hpp>
+#include <polyfem/assembler/SumFactorization.hpp>
+
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/par_for.hpp>
+#include <polyfem/utils/Profiler.hpp>
 
 #include <igl/Timer.h>
 
+#include <atomic>
+#include <map>
+#include <memory>
+
 #include <ipc/utils/eigen_ext.hpp>
 
 namespace polyfem::assembler
@@ -21,6 +30,8 @@ namespace polyfem::assembler
 			std::unique_ptr<MatrixCache> cache = nullptr;
 			ElementAssemblyValues vals;
 			QuadratureVector da;
+			/// per-element temporaries, kept to reuse their allocation
+			Eigen::VectorXd local_displacement;
 
 			LocalThreadMatStorage() = delete;
 
@@ -70,11 +81,16 @@ namespace polyfem::assembler
 		{
 		public:
 			Eigen::MatrixXd vec;
+			/// energy, when it is assembled together with the gradient
+			double val;
 			ElementAssemblyValues vals;
 			QuadratureVector da;
+			/// per-element temporaries, kept to reuse their allocation
+			Eigen::VectorXd local_v, local_hv;
 
 			LocalThreadVecStorage(const int size)
 			{
+				val = 0;
 				vec.resize(size, 1);
 				vec.setZero();
 			}
@@ -92,6 +108,178 @@ namespace polyfem::assembler
 				val = 0;
 			}
 		};
+
+		/// number of elements evaluated together by the batched kernels
+		constexpr int ELEMENT_BATCH_SIZE = 32;
+
+		class LocalThreadBatchStorage
+		{
+		public:
+			std::vector<ElementAssemblyValues> vals;
+			Eigen::MatrixXd local_pts, global_pts;
+			Eigen::VectorXi el_ids;
+			Eigen::ArrayXXd def_grad, stress;
+			Eigen::ArrayXd psi, da;
+
+			double val;
+			Eigen::MatrixXd vec;
+
+			/// sum-factorization of the elements of the batch, nullptr if their bases are not Q hexahedra
+			std::vector<const SumFactorization *> sum_factorization;
+			/// per-element temporaries of the sum-factorized elements
+			Eigen::MatrixXd local_u, local_grad, flux, local_r;
+
+			LocalThreadBatchStorage(const int size)
+				: vals(ELEMENT_BATCH_SIZE), sum_factorization(ELEMENT_BATCH_SIZE, nullptr)
+			{
+				val = 0;
+				vec.setZero(size, 1);
+			}
+
+			/// sum-factorization of Q2 and Q3 hexahedra, built once per reference key
+			const SumFactorization *find_sum_factorization(const int dim, const ElementBases &basis, const ElementAssemblyValues &vals)
+			{
+				const int order = basis.reference_key - ElementBases::lagrange_reference_key(3, false, 0);
+				if (dim != 3 || !vals.has_parameterization || order < 2 || order > 3)
+					return nullptr;
+
+				auto it = sum_factorizations_.find(basis.reference_key);
+				if (it == sum_factorizations_.end())
+				{
+					auto sf = std::make_shared<SumFactorization>();
+					if (!sf->init(order, vals.quadrature))
+						sf = nullptr;
+					it = sum_factorizations_.emplace(basis.reference_key, sf).first;
+				}
+
+				const SumFactorization *sf = it->second.get();
+				if (sf == nullptr || size_t(sf->n_bases()) != vals.basis_values.size() || sf->n_quadrature_points() != vals.quadrature.size())
+					return nullptr;
+				return sf;
+			}
+
+			/// computes the values of the elements [start, end) and gathers their
+			/// quadrature points and deformation gradients in structure-of-arrays layout
+			void fill(
+				const int dim,
+				const int start,
+				const int end,
+				const bool is_volume,
+				const std::vector<ElementBases> &bases,
+				const std::vector<ElementBases> &gbases,
+				const AssemblyValsCache &cache,
+				const Eigen::MatrixXd &displacement)
+			{
+				assert(end - start <= vals.size());
+				assert(displacement.cols() == 1);
+
+				int n_pts = 0;
+				for (int e = start; e < end; ++e)
+				{
+					cache.compute(e, is_volume, bases[e], gbases[e], vals[e - start]);
+					n_pts += vals[e - start].det.size();
+				}
+
+				local_pts.resize(n_pts, dim);
+				global_pts.resize(n_pts, dim);
+				el_ids.resize(n_pts);
+				da.resize(n_pts);
+				def_grad.setZero(n_pts, dim * dim);
+
+				int offset = 0;
+				for (int e = start; e < end; ++e)
+				{
+					const ElementAssemblyValues &ev = vals[e - start];
+					const int n_loc_pts = ev.det.size();
+
+					local_pts.middleRows(offset, n_loc_pts) = ev.quadrature.points;
+					global_pts.middleRows(offset, n_loc_pts) = ev.val;
+					el_ids.segment(offset, n_loc_pts).setConstant(ev.element_id);
+					da.segment(offset, n_loc_pts) = ev.det.array() * ev.quadrature.weights.array();
+
+					// F = Id + ∑ uᵢ ⊗ ∇φᵢ
+					auto F = def_grad.middleRows(offset, n_loc_pts);
+					for (int d = 0; d < dim; ++d)
+						F.col(d * dim + d).setOnes();
+
+					const SumFactorization *sf = find_sum_factorization(dim, bases[e], ev);
+					sum_factorization[e - start] = sf;
+					if (sf != nullptr)
+					{
+						// reference gradients dimension by dimension, then ∇u = ∇̂u J⁻¹
+						local_u.resize(ev.basis_values.size(), dim);
+						for (int j = 0; j < ev.basis_values.size(); ++j)
+						{
+							for (int d = 0; d < dim; ++d)
+							{
+								double u = 0;
+								for (const auto &g : ev.basis_values[j].global)
+									u += g.val * displacement(g.index * dim + d);
+								local_u(j, d) = u;
+							}
+						}
+						sf->gradient(local_u, local_grad);
+
+						Eigen::Matrix3d ref_grad_u;
+						for (int k = 0; k < n_loc_pts; ++k)
+						{
+							for (int d = 0; d < dim; ++d)
+								for (int a = 0; a < dim; ++a)
+									ref_grad_u(d, a) = local_grad(k, 3 * d + a);
+
+							const Eigen::Matrix3d grad_u = ref_grad_u * ev.jac_it[k];
+							for (int d = 0; d < dim; ++d)
+								for (int c = 0; c < dim; ++c)
+									F(k, d * dim + c) += grad_u(d, c);
+						}
+
+						offset += n_loc_pts;
+						continue;
+					}
+
+					for (const AssemblyValues &bv : ev.basis_values)
+					{
+						for (int d = 0; d < dim; ++d)
+						{
+							double u = 0;
+							for (const auto &g : bv.global)
+								u += g.val * displacement(g.index * dim + d);
+
+							for (int c = 0; c < dim; ++c)
+								F.col(d * dim + c) += u * bv.grad_t_m.col(c).array();
+						}
+					}
+
+					offset += n_loc_pts;
+				}
+			}
+
+		private:
+			std::map<int, std::shared_ptr<const SumFactorization>> sum_factorizations_;
+		};
+
+		/// F = Id + ∑ uᵢ ⊗ ∇φᵢ at the quadrature points of one element, column d * dim + c stores F(d, c)
+		void element_def_grad(const int dim, const NonLinearAssemblerData &data, Eigen::ArrayXXd &def_grad)
+		{
+			assert(data.x.cols() == 1);
+
+			def_grad.setZero(data.da.size(), dim * dim);
+			for (int d = 0; d < dim; ++d)
+				def_grad.col(d * dim + d).setOnes();
+
+			for (const AssemblyValues &bv : data.vals.basis_values)
+			{
+				for (int d = 0; d < dim; ++d)
+				{
+					double u = 0;
+					for (const auto &g : bv.global)
+						u += g.val * data.x(g.index * dim + d);
+
+					for (int c = 0; c < dim; ++c)
+						def_grad.col(d * dim + c) += u * bv.grad_t_m.col(c).array();
+				}
+			}
+		}
 	} // namespace
 
 	void Assembler::set_materials(const std::vector<int> &body_ids, const json &body_params, const Units &units)
@@ -150,6 +338,26 @@ namespace polyfem::assembler
 		}
 	}
 
+	void Assembler::assemble_hessian_vector_product(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		const Eigen::MatrixXd &v,
+		Eigen::MatrixXd &hv) const
+	{
+		SparseMatrixCache mat_cache;
+		StiffnessMatrix hessian;
+		assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, t, dt, displacement, displacement_prev, mat_cache, hessian);
+		hv = hessian * v;
+	}
+
 	LinearAssembler::LinearAssembler()
 	{
 	}
@@ -165,6 +373,7 @@ namespace polyfem::assembler
 		const bool is_mass) const
 	{
 		assert(size() > 0);
+		POLYFEM_PROFILE_COUNTER("linear elements", bases.size());
 
 		const long int max_triplets_size = long(1e7);
 		const long int buffer_size = std::min(long(max_triplets_size), long(n_basis) * size());
@@ -189,6 +398,8 @@ namespace polyfem::assembler
 			// all local basis functions on a given element
 			maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
 				LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
+				Eigen::MatrixXd local_block;
+				Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1> stiffness_val;
 
 				for (int e = start; e < end; ++e)
 				{
@@ -206,6 +417,13 @@ namespace polyfem::assembler
 					local_storage.da = vals.det.array() * quadrature.weights.array();
 					const int n_loc_bases = int(vals.basis_values.size());
 
+					const bool element_kernel = has_element_kernel(vals);
+					if (element_kernel)
+					{
+						assemble_element(vals, t, local_storage.da, local_block);
+						assert(local_block.rows() == n_loc_bases * size() && local_block.cols() == n_loc_bases * size());
+					}
+
 					for (int i = 0; i < n_loc_bases; ++i)
 					{
 						// const AssemblyValues &values_i = vals.basis_values[i];
@@ -220,8 +438,11 @@ namespace polyfem::assembler
 							const auto &global_j = vals.basis_values[j].global;
 
 							// compute local entry in stiffness matrix
-							const auto stiffness_val = assemble(LinearAssemblerData(vals, t, i, j, local_storage.da));
-							assert(stiffness_val.size() == size() * size());
+							if (!element_kernel)
+							{
+								stiffness_val = assemble(LinearAssemblerData(vals, t, i, j, local_storage.da));
+								assert(stiffness_val.size() == size() * size());
+							}
 
 							// igl::Timer t1; t1.start();
 							// loop over dimensions of the problem
@@ -229,7 +450,7 @@ namespace polyfem::assembler
 							{
 								for (int m = 0; m < size(); ++m)
 								{
-									const double local_value = stiffness_val(n * size() + m);
+									const double local_value = element_kernel ? local_block(i * size() + m, j * size() + n) : stiffness_val(n * size() + m);
 
 									// loop over the global nodes corresponding to local element (useful for non-conforming cases)
 									for (size_t ii = 0; ii < global_i.size(); ++ii)
@@ -243,16 +464,16 @@ namespace polyfem::assembler
 											const auto wj = global_j[jj].val;
 
 											// add local value to the global matrix (weighted by corresponding nodes)
-											local_storage.cache->add_value(e, gi, gj, local_value * wi * wj);
-											if (j < i)
-											{
+											// the matrix is symmetric, only its upper triangle is scattered and it is mirrored at the end
+											if (gi <= gj)
+												local_storage.cache->add_value(e, gi, gj, local_value * wi * wj);
+											if (j < i && gj <= gi)
 												local_storage.cache->add_value(e, gj, gi, local_value * wj * wi);
-											}
 
 											if (local_storage.cache->entries_size() >= max_triplets_size)
 											{
 												local_storage.cache->prune();
-												logger().trace("cleaning memory. Current storage: {}. mat nnz: {}", local_storage.cache->capacity(), local_storage.cache->non_zeros());
+												POLYFEM_LOG_TRACE("cleaning memory. Current storage: {}. mat nnz: {}", local_storage.cache->capacity(), local_storage.cache->non_zeros());
 											}
 										}
 									}
@@ -270,7 +491,7 @@ namespace polyfem::assembler
 			});
 
 			timer.stop();
-			logger().trace("done separate assembly {}s...", timer.getElapsedTime());
+			POLYFEM_LOG_TRACE("done separate assembly {}s...", timer.getElapsedTime());
 
 			// Assemble the stiffness matrix by concatenating the tuples in each local storage
 
@@ -287,7 +508,7 @@ namespace polyfem::assembler
 				storages[i]->cache->prune();
 			});
 			timer.stop();
-			logger().trace("done pruning triplets {}s...", timer.getElapsedTime());
+			POLYFEM_LOG_TRACE("done pruning triplets {}s...", timer.getElapsedTime());
 
 			// Prepares for parallel concatenation
 			std::vector<long int> offsets(storage.size());
@@ -314,7 +535,7 @@ namespace polyfem::assembler
 				stiffness.makeCompressed();
 				timer.stop();
 
-				logger().trace("Serial assembly time: {}s...", timer.getElapsedTime());
+				POLYFEM_LOG_TRACE("Serial assembly time: {}s...", timer.getElapsedTime());
 			}
 			else if (triplet_count >= triplets.max_size())
 			{
@@ -329,7 +550,7 @@ namespace polyfem::assembler
 				stiffness.makeCompressed();
 				timer.stop();
 
-				logger().trace("Serial assembly time: {}s...", timer.getElapsedTime());
+				POLYFEM_LOG_TRACE("Serial assembly time: {}s...", timer.getElapsedTime());
 			}
 			else
 			{
@@ -337,8 +558,8 @@ namespace polyfem::assembler
 				triplets.resize(triplet_count);
 				timer.stop();
 
-				logger().trace("done allocate triplets {}s...", timer.getElapsedTime());
-				logger().trace("Triplets Count: {}", triplet_count);
+				POLYFEM_LOG_TRACE("done allocate triplets {}s...", timer.getElapsedTime());
+				POLYFEM_LOG_TRACE("Triplets Count: {}", triplet_count);
 
 				timer.start();
 				// Parallel copy into triplets
@@ -364,15 +585,17 @@ namespace polyfem::assembler
 				});
 
 				timer.stop();
-				logger().trace("done concatenate triplets {}s...", timer.getElapsedTime());
+				POLYFEM_LOG_TRACE("done concatenate triplets {}s...", timer.getElapsedTime());
 
 				timer.start();
 				// Sort and assemble
 				stiffness.setFromTriplets(triplets.begin(), triplets.end());
 				timer.stop();
 
-				logger().trace("done setFromTriplets assembly {}s...", timer.getElapsedTime());
+				POLYFEM_LOG_TRACE("done setFromTriplets assembly {}s...", timer.getElapsedTime());
 			}
+
+			stiffness = stiffness.selfadjointView<Eigen::Upper>();
 		}
 		catch (std::bad_alloc &ba)
 		{
@@ -383,6 +606,38 @@ namespace polyfem::assembler
 		// stiffness.setFromTriplets(entries.begin(), entries.end());
 	}
 
+	bool LinearAssembler::is_affine_p1_simplex(const ElementAssemblyValues &vals)
+	{
+		if (!vals.has_parameterization || vals.basis_values.empty())
+			return false;
+
+		// only the P1 simplices have dim + 1 bases, they are affine if the Jacobian of the geometric mapping is constant
+		const int dim = vals.basis_values[0].grad_t_m.cols();
+		if (int(vals.basis_values.size()) != dim + 1)
+			return false;
+
+		return (vals.det.array() - vals.det(0)).abs().maxCoeff() <= 1e-12 * std::abs(vals.det(0));
+	}
+
+	Eigen::MatrixXd LinearAssembler::p1_gradients(const ElementAssemblyValues &vals)
+	{
+		assert(is_affine_p1_simplex(vals));
+		const int dim = vals.basis_values[0].grad_t_m.cols();
+		Eigen::MatrixXd grads(vals.basis_values.size(), dim);
+		for (int i = 0; i < grads.rows(); ++i)
+			grads.row(i) = vals.basis_values[i].grad_t_m.row(0);
+		return grads;
+	}
+
+	Eigen::MatrixXd LinearAssembler::weighted_mass(const ElementAssemblyValues &vals, const Eigen::VectorXd &weights)
+	{
+		assert(weights.size() == vals.quadrature.weights.size());
+		Eigen::MatrixXd phi(weights.size(), vals.basis_values.size());
+		for (int i = 0; i < phi.cols(); ++i)
+			phi.col(i) = vals.basis_values[i].val;
+		return phi.transpose() * weights.asDiagonal() * phi;
+	}
+
 	MixedAssembler::MixedAssembler()
 	{
 	}
@@ -418,6 +673,9 @@ namespace polyfem::assembler
 		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
 			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
 			ElementAssemblyValues psi_vals, phi_vals;
+			const bool element_kernel = has_element_kernel();
+			Eigen::MatrixXd local_block;
+			Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> stiffness_val;
 
 			for (int e = start; e < end; ++e)
 			{
@@ -433,6 +691,12 @@ namespace polyfem::assembler
 				const int n_phi_loc_bases = int(phi_vals.basis_values.size());
 				const int n_psi_loc_bases = int(psi_vals.basis_values.size());
 
+				if (element_kernel)
+				{
+					assemble_element(psi_vals, phi_vals, t, local_storage.da, local_block);
+					assert(local_block.rows() == n_phi_loc_bases * rows() && local_block.cols() == n_psi_loc_bases * cols());
+				}
+
 				for (int i = 0; i < n_psi_loc_bases; ++i)
 				{
 					const auto &global_i = psi_vals.basis_values[i].global;
@@ -441,15 +705,18 @@ namespace polyfem::assembler
 					{
 						const auto &global_j = phi_vals.basis_values[j].global;
 
-						const auto stiffness_val = assemble(MixedAssemblerData(psi_vals, phi_vals, t, i, j, local_storage.da));
-						assert(stiffness_val.size() == rows() * cols());
+						if (!element_kernel)
+						{
+							stiffness_val = assemble(MixedAssemblerData(psi_vals, phi_vals, t, i, j, local_storage.da));
+							assert(stiffness_val.size() == rows() * cols());
+						}
 
 						// igl::Timer t1; t1.start();
 						for (int n = 0; n < rows(); ++n)
 						{
 							for (int m = 0; m < cols(); ++m)
 							{
-								const double local_value = stiffness_val(n * cols() + m);
+								const double local_value = element_kernel ? local_block(j * rows() + n, i * cols() + m) : stiffness_val(n * cols() + m);
 
 								for (size_t ii = 0; ii < global_i.size(); ++ii)
 								{
@@ -478,7 +745,7 @@ namespace polyfem::assembler
 		});
 
 		timer.stop();
-		logger().trace("done separate assembly {}s...", timer.getElapsedTime());
+		POLYFEM_LOG_TRACE("done separate assembly {}s...", timer.getElapsedTime());
 
 		timer.start();
 		// Serially merge local storages
@@ -486,7 +753,7 @@ namespace polyfem::assembler
 			stiffness += local_storage.cache->get_matrix(false); // will also prune
 		stiffness.makeCompressed();
 		timer.stop();
-		logger().trace("done merge assembly {}s...", timer.getElapsedTime());
+		POLYFEM_LOG_TRACE("done merge assembly {}s...", timer.getElapsedTime());
 
 		// stiffness.resize(n_basis*size(), n_basis*size());
 		// stiffness.setFromTriplets(entries.begin(), entries.end());
@@ -502,6 +769,11 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &displacement,
 		const Eigen::MatrixXd &displacement_prev) const
 	{
+		POLYFEM_PROFILE_COUNTER("energy elements", bases.size());
+
+		if (has_batch_kernels())
+			return assemble_energy_batched(is_volume, bases, gbases, cache, t, dt, displacement);
+
 		auto storage = create_thread_storage(LocalThreadScalarStorage());
 		const int n_bases = int(bases.size());
 
@@ -521,7 +793,7 @@ namespace polyfem::assembler
 				const double val = compute_energy(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da));
 				local_storage.val += val;
 			}
-		});
+		}, element_affinity_);
 
 		double res = 0;
 		// Serially merge local storages
@@ -583,63 +855,401 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &displacement_prev,
 		Eigen::MatrixXd &rhs) const
 	{
+		POLYFEM_PROFILE_COUNTER("gradient elements", bases.size());
+
+		if (has_batch_kernels())
+		{
+			assemble_gradient_batched(is_volume, n_basis, bases, gbases, cache, t, dt, displacement, rhs);
+			return;
+		}
+
 		rhs.resize(n_basis * size(), 1);
 		rhs.setZero();
 
-		auto storage = create_thread_storage(LocalThreadVecStorage(rhs.size()));
-
 		const int n_bases = int(bases.size());
+		const bool use_coloring = get_n_threads() > 1 && long(get_n_threads()) * rhs.size() > AssemblerUtils::COLORING_MIN_SCRATCH;
+
+		auto storage = create_thread_storage(LocalThreadVecStorage(use_coloring ? 0 : rhs.size()));
+
+		const auto assemble_element = [&](const int e, LocalThreadVecStorage &local_storage, Eigen::MatrixXd &vec) {
+			ElementAssemblyValues &vals = local_storage.vals;
+			cache.compute(e, is_volume, bases[e], gbases[e], vals);
+
+			const Quadrature &quadrature = vals.quadrature;
+
+			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+			local_storage.da = vals.det.array() * quadrature.weights.array();
+			const int n_loc_bases = int(vals.basis_values.size());
+
+			const auto val = assemble_gradient(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da));
+			assert(val.size() == n_loc_bases * size());
+
+			for (int j = 0; j < n_loc_bases; ++j)
+			{
+				const auto &global_j = vals.basis_values[j].global;
+
+				for (int m = 0; m < size(); ++m)
+				{
+					const double local_value = val(j * size() + m);
+
+					for (size_t jj = 0; jj < global_j.size(); ++jj)
+						vec(global_j[jj].index * size() + m) += local_value * global_j[jj].val;
+				}
+			}
+		};
+
+		if (use_coloring)
+		{
+			// the elements of a color do not share dofs, they scatter directly in rhs
+			for (const std::vector<int> &color : AssemblerUtils::color_elements(bases, n_basis))
+			{
+				maybe_parallel_for(int(color.size()), [&](int start, int end, int thread_id) {
+					LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+					for (int i = start; i < end; ++i)
+						assemble_element(color[i], local_storage, rhs);
+				});
+			}
+			return;
+		}
 
 		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
 			LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
 
 			for (int e = start; e < end; ++e)
+				assemble_element(e, local_storage, local_storage.vec);
+		}, element_affinity_);
+
+		// Serially merge local storages
+		for (const LocalThreadVecStorage &local_storage : storage)
+			rhs += local_storage.vec;
+	}
+
+	double NLAssembler::assemble_energy_gradient(
+		const bool is_volume,
+		const int n_basis,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		Eigen::MatrixXd &rhs) const
+	{
+		POLYFEM_PROFILE_COUNTER("energy and gradient elements", bases.size());
+
+		if (has_batch_kernels())
+		{
+			double energy;
+			assemble_gradient_batched(is_volume, n_basis, bases, gbases, cache, t, dt, displacement, rhs, &energy);
+			return energy;
+		}
+
+		rhs.resize(n_basis * size(), 1);
+		rhs.setZero();
+
+		const int n_bases = int(bases.size());
+		const bool use_coloring = get_n_threads() > 1 && long(get_n_threads()) * rhs.size() > AssemblerUtils::COLORING_MIN_SCRATCH;
+
+		auto storage = create_thread_storage(LocalThreadVecStorage(use_coloring ? 0 : rhs.size()));
+
+		const auto assemble_element = [&](const int e, LocalThreadVecStorage &local_storage, Eigen::MatrixXd &vec) {
+			// the element values are computed once for both the energy and the gradient
+			ElementAssemblyValues &vals = local_storage.vals;
+			cache.compute(e, is_volume, bases[e], gbases[e], vals);
+
+			const Quadrature &quadrature = vals.quadrature;
+
+			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+			local_storage.da = vals.det.array() * quadrature.weights.array();
+			const int n_loc_bases = int(vals.basis_values.size());
+
+			const NonLinearAssemblerData data(vals, t, dt, displacement, displacement_prev, local_storage.da);
+			local_storage.val += compute_energy(data);
+
+			const auto val = assemble_gradient(data);
+			assert(val.size() == n_loc_bases * size());
+
+			for (int j = 0; j < n_loc_bases; ++j)
 			{
-				// igl::Timer timer; timer.start();
+				const auto &global_j = vals.basis_values[j].global;
 
-				ElementAssemblyValues &vals = local_storage.vals;
-				// vals.compute(e, is_volume, bases[e], gbases[e]);
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+				for (int m = 0; m < size(); ++m)
+				{
+					const double local_value = val(j * size() + m);
 
-				const Quadrature &quadrature = vals.quadrature;
+					for (size_t jj = 0; jj < global_j.size(); ++jj)
+						vec(global_j[jj].index * size() + m) += local_value * global_j[jj].val;
+				}
+			}
+		};
 
-				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = vals.det.array() * quadrature.weights.array();
-				const int n_loc_bases = int(vals.basis_values.size());
+		if (use_coloring)
+		{
+			// the elements of a color do not share dofs, they scatter directly in rhs
+			for (const std::vector<int> &color : AssemblerUtils::color_elements(bases, n_basis))
+			{
+				maybe_parallel_for(int(color.size()), [&](int start, int end, int thread_id) {
+					LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+					for (int i = start; i < end; ++i)
+						assemble_element(color[i], local_storage, rhs);
+				});
+			}
+		}
+		else
+		{
+			maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+				LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
 
-				const auto val = assemble_gradient(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da));
-				assert(val.size() == n_loc_bases * size());
+				for (int e = start; e < end; ++e)
+					assemble_element(e, local_storage, local_storage.vec);
+			}, element_affinity_);
+		}
 
-				for (int j = 0; j < n_loc_bases; ++j)
+		double energy = 0;
+		// Serially merge local storages
+		for (const LocalThreadVecStorage &local_storage : storage)
+		{
+			if (!use_coloring)
+				rhs += local_storage.vec;
+			energy += local_storage.val;
+		}
+		return energy;
+	}
+
+	double NLAssembler::assemble_energy_batched(
+		const bool is_volume,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		const double dt,
+		const Eigen::MatrixXd &displacement) const
+	{
+		const int n_elements = int(bases.size());
+		const int n_batches = (n_elements + ELEMENT_BATCH_SIZE - 1) / ELEMENT_BATCH_SIZE;
+
+		auto storage = create_thread_storage(LocalThreadBatchStorage(0));
+
+		maybe_parallel_for(n_batches, [&](int start, int end, int thread_id) {
+			LocalThreadBatchStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+			for (int b = start; b < end; ++b)
+			{
+				const int e_start = b * ELEMENT_BATCH_SIZE;
+				const int e_end = std::min(e_start + ELEMENT_BATCH_SIZE, n_elements);
+				local_storage.fill(size(), e_start, e_end, is_volume, bases, gbases, cache, displacement);
+
+				compute_energy_density_batch(
+					BatchAssemblerData(size(), t, dt, local_storage.local_pts, local_storage.global_pts, local_storage.el_ids, local_storage.def_grad),
+					local_storage.psi);
+				assert(local_storage.psi.size() == local_storage.da.size());
+
+				local_storage.val += (local_storage.psi * local_storage.da).sum();
+			}
+		}, batch_affinity_);
+
+		double res = 0;
+		// Serially merge local storages
+		for (const LocalThreadBatchStorage &local_storage : storage)
+			res += local_storage.val;
+		return res;
+	}
+
+	void NLAssembler::assemble_gradient_batched(
+		const bool is_volume,
+		const int n_basis,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		Eigen::MatrixXd &rhs,
+		double *energy) const
+	{
+		rhs.resize(n_basis * size(), 1);
+		rhs.setZero();
+
+		const int dim = size();
+		const int n_elements = int(bases.size());
+		const int n_batches = (n_elements + ELEMENT_BATCH_SIZE - 1) / ELEMENT_BATCH_SIZE;
+
+		auto storage = create_thread_storage(LocalThreadBatchStorage(rhs.size()));
+
+		maybe_parallel_for(n_batches, [&](int start, int end, int thread_id) {
+			LocalThreadBatchStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+			for (int b = start; b < end; ++b)
+			{
+				const int e_start = b * ELEMENT_BATCH_SIZE;
+				const int e_end = std::min(e_start + ELEMENT_BATCH_SIZE, n_elements);
+				local_storage.fill(dim, e_start, e_end, is_volume, bases, gbases, cache, displacement);
+
+				const BatchAssemblerData data(dim, t, dt, local_storage.local_pts, local_storage.global_pts, local_storage.el_ids, local_storage.def_grad);
+				if (energy)
 				{
-					const auto &global_j = vals.basis_values[j].global;
+					compute_energy_density_batch(data, local_storage.psi);
+					assert(local_storage.psi.size() == local_storage.da.size());
+					local_storage.val += (local_storage.psi * local_storage.da).sum();
+				}
 
-					// igl::Timer t1; t1.start();
-					for (int m = 0; m < size(); ++m)
+				compute_stress_batch(data, local_storage.stress);
+				assert(local_storage.stress.rows() == local_storage.da.size());
+				assert(local_storage.stress.cols() == dim * dim);
+
+				// weight the stress by the quadrature weights once for the whole batch
+				for (int k = 0; k < local_storage.stress.cols(); ++k)
+					local_storage.stress.col(k) *= local_storage.da;
+
+				int offset = 0;
+				for (int e = e_start; e < e_end; ++e)
+				{
+					const ElementAssemblyValues &vals = local_storage.vals[e - e_start];
+					const int n_loc_pts = vals.det.size();
+					const auto P = local_storage.stress.middleRows(offset, n_loc_pts);
+
+					if (const SumFactorization *sf = local_storage.sum_factorization[e - e_start])
 					{
-						const double local_value = val(j * size() + m);
+						// ∫ P : (eₘ ⊗ ∇φⱼ) = ∑_q ∇̂φⱼ · (J⁻ᵀ Pᵀ)ₘ
+						Eigen::MatrixXd &flux = local_storage.flux;
+						flux.resize(n_loc_pts, 3 * dim);
+						Eigen::Matrix3d Pk;
+						for (int k = 0; k < n_loc_pts; ++k)
+						{
+							for (int m = 0; m < dim; ++m)
+								for (int c = 0; c < dim; ++c)
+									Pk(m, c) = P(k, m * dim + c);
+
+							const Eigen::Matrix3d flux_k = vals.jac_it[k] * Pk.transpose();
+							for (int m = 0; m < dim; ++m)
+								for (int a = 0; a < dim; ++a)
+									flux(k, 3 * m + a) = flux_k(a, m);
+						}
+						sf->integrate_gradient(flux, local_storage.local_r);
 
-						for (size_t jj = 0; jj < global_j.size(); ++jj)
+						for (int j = 0; j < vals.basis_values.size(); ++j)
 						{
-							const auto gj = global_j[jj].index * size() + m;
-							const auto wj = global_j[jj].val;
+							for (int m = 0; m < dim; ++m)
+							{
+								for (const auto &g : vals.basis_values[j].global)
+									local_storage.vec(g.index * dim + m) += local_storage.local_r(j, m) * g.val;
+							}
+						}
 
-							local_storage.vec(gj) += local_value * wj;
+						offset += n_loc_pts;
+						continue;
+					}
+
+					for (const AssemblyValues &bv : vals.basis_values)
+					{
+						// ∫ P : (eₘ ⊗ ∇φⱼ)
+						for (int m = 0; m < dim; ++m)
+						{
+							double local_value = 0;
+							for (int c = 0; c < dim; ++c)
+								local_value += (P.col(m * dim + c) * bv.grad_t_m.col(c).array()).sum();
+
+							for (const auto &g : bv.global)
+								local_storage.vec(g.index * dim + m) += local_value * g.val;
 						}
 					}
 
-					// t1.stop();
-					// if (!vals.has_parameterization) { std::cout << "-- t1: " << t1.getElapsedTime() << std::endl; }
+					offset += n_loc_pts;
 				}
-
-				// timer.stop();
-				// if (!vals.has_parameterization) { std::cout << "-- Timer: " << timer.getElapsedTime() << std::endl; }
 			}
-		});
+		}, batch_affinity_);
 
 		// Serially merge local storages
-		for (const LocalThreadVecStorage &local_storage : storage)
+		if (energy)
+			*energy = 0;
+		for (const LocalThreadBatchStorage &local_storage : storage)
+		{
 			rhs += local_storage.vec;
+			if (energy)
+				*energy += local_storage.val;
+		}
+	}
+
+	Eigen::VectorXd NLAssembler::assemble_gradient_from_stress(const NonLinearAssemblerData &data) const
+	{
+		const int dim = size();
+		const int n_loc_bases = int(data.vals.basis_values.size());
+
+		Eigen::ArrayXXd def_grad, stress;
+		element_def_grad(dim, data, def_grad);
+		const Eigen::VectorXi el_ids = Eigen::VectorXi::Constant(def_grad.rows(), data.vals.element_id);
+		compute_stress_batch(BatchAssemblerData(dim, data.t, data.dt, data.vals.quadrature.points, data.vals.val, el_ids, def_grad), stress);
+		assert(stress.rows() == data.da.size() && stress.cols() == dim * dim);
+
+		for (int k = 0; k < stress.cols(); ++k)
+			stress.col(k) *= data.da.array();
+
+		// ∫ P : (eₘ ⊗ ∇φⱼ)
+		Eigen::VectorXd gradient(n_loc_bases * dim);
+		for (int j = 0; j < n_loc_bases; ++j)
+		{
+			const Eigen::MatrixXd &grad = data.vals.basis_values[j].grad_t_m;
+			for (int m = 0; m < dim; ++m)
+			{
+				double local_value = 0;
+				for (int c = 0; c < dim; ++c)
+					local_value += (stress.col(m * dim + c) * grad.col(c).array()).sum();
+				gradient(j * dim + m) = local_value;
+			}
+		}
+
+		return gradient;
+	}
+
+	Eigen::MatrixXd NLAssembler::assemble_element_hessian(const NonLinearAssemblerData &data, const bool project_to_psd) const
+	{
+		Eigen::MatrixXd hessian;
+		if (project_to_psd && assemble_projected_hessian(data, hessian))
+			return hessian;
+
+		// fallback, dense eigendecomposition of the element hessian
+		hessian = assemble_hessian(data);
+		if (project_to_psd)
+			hessian = ipc::project_to_psd(hessian);
+		return hessian;
+	}
+
+	Eigen::MatrixXd NLAssembler::assemble_hessian_from_stress_grad(const NonLinearAssemblerData &data, const bool project_to_psd) const
+	{
+		const int dim = size();
+		const int dim2 = dim * dim;
+		const int n_loc_bases = int(data.vals.basis_values.size());
+
+		Eigen::ArrayXXd def_grad, stress_grad;
+		element_def_grad(dim, data, def_grad);
+		const Eigen::VectorXi el_ids = Eigen::VectorXi::Constant(def_grad.rows(), data.vals.element_id);
+		compute_stress_grad_batch(BatchAssemblerData(dim, data.t, data.dt, data.vals.quadrature.points, data.vals.val, el_ids, def_grad), stress_grad);
+		assert(stress_grad.rows() == data.da.size() && stress_grad.cols() == dim2 * dim2);
+
+		Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(n_loc_bases * dim, n_loc_bases * dim);
+		// B(d * dim + c, j * dim + d) = ∂F(d, c)/∂uⱼ,d = ∇φⱼ,c
+		Eigen::MatrixXd B = Eigen::MatrixXd::Zero(dim2, n_loc_bases * dim);
+		Eigen::MatrixXd A(dim2, dim2);
+
+		for (int p = 0; p < data.da.size(); ++p)
+		{
+			for (int j = 0; j < n_loc_bases; ++j)
+				for (int d = 0; d < dim; ++d)
+					for (int c = 0; c < dim; ++c)
+						B(d * dim + c, j * dim + d) = data.vals.basis_values[j].grad_t_m(p, c);
+
+			for (int r = 0; r < dim2; ++r)
+				for (int c = 0; c < dim2; ++c)
+					A(r, c) = stress_grad(p, r * dim2 + c);
+			// Bᵀ A B is PSD if A is
+			if (project_to_psd)
+				A = ipc::project_to_psd(A);
+
+			hessian.noalias() += data.da(p) * B.transpose() * A * B;
+		}
+
+		return hessian;
 	}
 
 	void NLAssembler::assemble_hessian(
@@ -656,6 +1266,8 @@ namespace polyfem::assembler
 		MatrixCache &mat_cache,
 		StiffnessMatrix &hess) const
 	{
+		POLYFEM_PROFILE_COUNTER("hessian elements", bases.size());
+
 		const int max_triplets_size = int(1e7);
 		const int buffer_size = std::min(long(max_triplets_size), long(n_basis) * size());
 		// std::cout<<"buffer_size "<<buffer_size<<std::endl;
@@ -666,12 +1278,24 @@ namespace polyfem::assembler
 		mat_cache.init(n_basis * size());
 		mat_cache.set_zero();
 
+		// Once the sparsity pattern is frozen (after the first assembly), scatter the local
+		// matrices directly in the thread-local value buffers instead of going through add_value
+		SparseMatrixCache *sparse_mat_cache = dynamic_cast<SparseMatrixCache *>(&mat_cache);
+		const bool use_pattern = sparse_mat_cache != nullptr && sparse_mat_cache->has_pattern();
+		// a symmetric cache only holds the upper triangle, the entries below the diagonal are not scattered
+		const bool upper_only = mat_cache.is_symmetric();
+
 		auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, mat_cache));
 
 		const int n_bases = int(bases.size());
 		igl::Timer timer;
 		timer.start();
 
+		const bool reuse_hessians = hessian_reuse_tolerance_ > 0;
+		if (reuse_hessians && int(reused_hessians_.size()) != n_bases)
+			reused_hessians_.assign(n_bases, ReusedHessianBlock());
+		std::atomic<int> n_reused = 0;
+
 		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
 			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
 
@@ -686,12 +1310,46 @@ namespace polyfem::assembler
 				local_storage.da = vals.det.array() * quadrature.weights.array();
 				const int n_loc_bases = int(vals.basis_values.size());
 
-				auto stiffness_val = assemble_hessian(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da));
-				assert(stiffness_val.rows() == n_loc_bases * size());
-				assert(stiffness_val.cols() == n_loc_bases * size());
+				Eigen::VectorXd &local_displacement = local_storage.local_displacement;
+				bool is_reused = false;
+				if (reuse_hessians)
+				{
+					local_displacement.setZero(n_loc_bases * size());
+					for (int i = 0; i < n_loc_bases; ++i)
+					{
+						for (const auto &g : vals.basis_values[i].global)
+							local_displacement.segment(i * size(), size()) += g.val * displacement.block(g.index * size(), 0, size(), 1);
+					}
+
+					const ReusedHessianBlock &block = reused_hessians_[e];
+					is_reused = block.hessian.size() > 0 && block.t == t && block.project_to_psd == project_to_psd
+								&& block.displacement.size() == local_displacement.size()
+								&& (local_displacement - block.displacement).lpNorm<Eigen::Infinity>() <= hessian_reuse_tolerance_;
+				}
+
+				Eigen::MatrixXd computed_val;
+				if (!is_reused)
+				{
+					computed_val = assemble_element_hessian(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da), project_to_psd);
+					assert(computed_val.rows() == n_loc_bases * size());
+					assert(computed_val.cols() == n_loc_bases * size());
 
-				if (project_to_psd)
-					stiffness_val = ipc::project_to_psd(stiffness_val);
+					if (reuse_hessians)
+						reused_hessians_[e] = {local_displacement, computed_val, t, project_to_psd};
+				}
+				else
+					++n_reused;
+				const Eigen::MatrixXd &stiffness_val = is_reused ? reused_hessians_[e].hessian : computed_val;
+
+				const std::vector<StorageIndex> *slots = nullptr;
+				double *values = nullptr;
+				int slot = 0;
+				if (use_pattern)
+				{
+					SparseMatrixCache &local_cache = static_cast<SparseMatrixCache &>(*local_storage.cache);
+					slots = &local_cache.element_slots(e);
+					values = local_cache.values_data();
+				}
 
 				// bool has_nan = false;
 				// for(int k = 0; k < stiffness_val.size(); ++k)
@@ -734,6 +1392,16 @@ namespace polyfem::assembler
 										const auto gj = global_j[jj].index * size() + n;
 										const auto wj = global_j[jj].val;
 
+										if (upper_only && gi > gj)
+											continue;
+
+										if (slots)
+										{
+											assert(slot < slots->size());
+											values[(*slots)[slot++]] += local_value * wi * wj;
+											continue;
+										}
+
 										local_storage.cache->add_value(e, gi, gj, local_value * wi * wj);
 										// if (j < i) {
 										// 	local_storage.entries.emplace_back(gj, gi, local_value * wj * wi);
@@ -751,23 +1419,106 @@ namespace polyfem::assembler
 					}
 				}
 			}
-		});
+		}, element_affinity_);
 
 		timer.stop();
-		logger().trace("done separate assembly {}s...", timer.getElapsedTime());
+		POLYFEM_LOG_TRACE("done separate assembly {}s...", timer.getElapsedTime());
+		if (reuse_hessians)
+			POLYFEM_LOG_TRACE("reused {}/{} element hessians", int(n_reused), n_bases);
 
 		timer.start();
 
-		// Serially merge local storages
-		for (LocalThreadMatStorage &local_storage : storage)
+		if (use_pattern)
+		{
+			// Reduce all thread-local value buffers in a single parallel pass
+			std::vector<const SparseMatrixCache *> local_caches;
+			for (const LocalThreadMatStorage &local_storage : storage)
+				local_caches.push_back(static_cast<const SparseMatrixCache *>(local_storage.cache.get()));
+			sparse_mat_cache->accumulate(local_caches);
+		}
+		else
 		{
-			local_storage.cache->prune();
-			mat_cache += *local_storage.cache;
+			// Serially merge local storages
+			for (LocalThreadMatStorage &local_storage : storage)
+			{
+				local_storage.cache->prune();
+				mat_cache += *local_storage.cache;
+			}
 		}
 		hess = mat_cache.get_matrix();
 
 		timer.stop();
-		logger().trace("done merge assembly {}s...", timer.getElapsedTime());
+		POLYFEM_LOG_TRACE("done merge assembly {}s...", timer.getElapsedTime());
+	}
+
+	void NLAssembler::assemble_hessian_vector_product(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		const Eigen::MatrixXd &v,
+		Eigen::MatrixXd &hv) const
+	{
+		assert(v.size() == n_basis * size());
+
+		hv.resize(n_basis * size(), 1);
+		hv.setZero();
+
+		auto storage = create_thread_storage(LocalThreadVecStorage(hv.size()));
+
+		const int n_bases = int(bases.size());
+
+		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			Eigen::VectorXd &local_v = local_storage.local_v;
+			Eigen::VectorXd &local_hv = local_storage.local_hv;
+
+			for (int e = start; e < end; ++e)
+			{
+				ElementAssemblyValues &vals = local_storage.vals;
+				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+
+				const Quadrature &quadrature = vals.quadrature;
+
+				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+				local_storage.da = vals.det.array() * quadrature.weights.array();
+				const int n_loc_bases = int(vals.basis_values.size());
+
+				// gather v on the local dofs, the hessian is never assembled globally
+				local_v.setZero(n_loc_bases * size());
+				for (int j = 0; j < n_loc_bases; ++j)
+				{
+					const auto &global_j = vals.basis_values[j].global;
+					for (int n = 0; n < size(); ++n)
+						for (size_t jj = 0; jj < global_j.size(); ++jj)
+							local_v(j * size() + n) += global_j[jj].val * v(global_j[jj].index * size() + n);
+				}
+
+				const Eigen::MatrixXd stiffness_val = assemble_element_hessian(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da), project_to_psd);
+				assert(stiffness_val.rows() == n_loc_bases * size());
+				assert(stiffness_val.cols() == n_loc_bases * size());
+
+				local_hv.noalias() = stiffness_val * local_v;
+
+				for (int i = 0; i < n_loc_bases; ++i)
+				{
+					const auto &global_i = vals.basis_values[i].global;
+					for (int m = 0; m < size(); ++m)
+						for (size_t ii = 0; ii < global_i.size(); ++ii)
+							local_storage.vec(global_i[ii].index * size() + m) += global_i[ii].val * local_hv(i * size() + m);
+				}
+			}
+		}, element_affinity_);
+
+		// Serially merge local storages
+		for (const LocalThreadVecStorage &local_storage : storage)
+			hv += local_storage.vec;
 	}
 
 } // namespace polyfem::assembler
@@ -6,6 +6,7 @@
 #include <polyfem/assembler/AssemblyValsCache.hpp>
 
 #include <polyfem/utils/MatrixCache.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/ElasticityUtils.hpp>
 #include <polyfem/utils/AutodiffTypes.hpp>
 #include <polyfem/utils/Logger.hpp>
@@ -47,6 +48,12 @@ namespace polyfem::assembler
 		virtual int cols() const = 0;
 
 		virtual Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> assemble(const MixedAssemblerData &data) const = 0;
+
+		// element kernel, filling the local matrix of every (psi, phi) pair with dense products over the
+		// quadrature points, entry (j * rows() + n, i * cols() + m) is value n * cols() + m of assemble for (i, j)
+		// models providing it must return true in has_element_kernel
+		virtual bool has_element_kernel() const { return false; }
+		virtual void assemble_element(const ElementAssemblyValues &psi_vals, const ElementAssemblyValues &phi_vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const { log_and_throw_error("Element kernel not implemented by {}!", name()); }
 	};
 
 	/// abstract class
@@ -109,6 +116,24 @@ namespace polyfem::assembler
 			const Eigen::MatrixXd &displacement_prev,
 			Eigen::MatrixXd &rhs) const { log_and_throw_error("Assemble grad not implemented by {}!", name()); }
 
+		// assemble energy and its gradient (rhs) at the same displacement, returns the energy
+		// by default calls assemble_gradient and assemble_energy, non-linear assemblers visit every element once
+		virtual double assemble_energy_gradient(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			Eigen::MatrixXd &rhs) const
+		{
+			assemble_gradient(is_volume, n_basis, bases, gbases, cache, t, dt, displacement, displacement_prev, rhs);
+			return assemble_energy(is_volume, bases, gbases, cache, t, dt, displacement, displacement_prev);
+		}
+
 		// assemble hessian of energy (grad)
 		virtual void assemble_hessian(
 			const bool is_volume,
@@ -124,6 +149,21 @@ namespace polyfem::assembler
 			utils::MatrixCache &mat_cache,
 			StiffnessMatrix &grad) const { log_and_throw_error("Assemble hessian not implemented by {}!", name()); }
 
+		// product of the hessian of energy with v, by default assembles the hessian and multiplies it
+		virtual void assemble_hessian_vector_product(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			const Eigen::MatrixXd &v,
+			Eigen::MatrixXd &hv) const;
+
 		// plotting (eg von mises), assembler is the name of the formulation
 		virtual void compute_scalar_value(
 			const OutputData &data,
@@ -232,6 +272,20 @@ namespace polyfem::assembler
 		/// local assembly function that defines the bilinear form (LHS)
 		/// computes and returns a single local stiffness value
 		virtual Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1> assemble(const LinearAssemblerData &data) const = 0;
+
+		/// element kernel computing the whole local matrix at once instead of one pair of bases at a time,
+		/// used on the elements for which has_element_kernel returns true
+		/// local is (n_loc_bases·size)², entry (i·size + m, j·size + n) is entry n·size + m of assemble for the bases i and j
+		virtual bool has_element_kernel(const ElementAssemblyValues &vals) const { return false; }
+		virtual void assemble_element(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const { log_and_throw_error("Element kernel not implemented by {}!", name()); }
+
+	protected:
+		/// is the element an affine P1 simplex, its basis gradients are constant
+		static bool is_affine_p1_simplex(const ElementAssemblyValues &vals);
+		/// constant gradients of the bases of an affine P1 simplex, one per row
+		static Eigen::MatrixXd p1_gradients(const ElementAssemblyValues &vals);
+		/// scalar mass matrix of the element ∫ c φᵢ φⱼ, with the weights c·da at the quadrature points
+		static Eigen::MatrixXd weighted_mass(const ElementAssemblyValues &vals, const Eigen::VectorXd &weights);
 	};
 
 	// non-linear assembler (eg neohookean elasticity)
@@ -275,6 +329,19 @@ namespace polyfem::assembler
 			const Eigen::MatrixXd &displacement_prev,
 			Eigen::MatrixXd &rhs) const override;
 
+		// assemble energy and gradient in a single pass over the elements
+		double assemble_energy_gradient(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			Eigen::MatrixXd &rhs) const override;
+
 		// assemble hessian of energy (grad)
 		void assemble_hessian(
 			const bool is_volume,
@@ -290,13 +357,96 @@ namespace polyfem::assembler
 			utils::MatrixCache &mat_cache,
 			StiffnessMatrix &grad) const override;
 
+		// matrix-free product of the hessian of energy with v, element by element
+		void assemble_hessian_vector_product(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			const Eigen::MatrixXd &v,
+			Eigen::MatrixXd &hv) const override;
+
 		virtual bool is_linear() const override { return false; }
 
+		// reuse the local hessian of the elements whose displacement changed less than tol (max norm)
+		// since it was computed, which makes newton inexact; 0 disables the reuse
+		void set_hessian_reuse_tolerance(const double tol)
+		{
+			hessian_reuse_tolerance_ = tol;
+			reused_hessians_.clear();
+		}
+
 	protected:
 		// energy, gradient, and hessian used in newton method
 		virtual double compute_energy(const NonLinearAssemblerData &data) const = 0;
 		virtual Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const = 0;
 		virtual Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const = 0;
+		// element hessian made PSD by projecting the tangent ∂²Ψ/∂F² at every quadrature point, which is much
+		// smaller than the element hessian; returns false if the model does not provide it
+		virtual bool assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const { return false; }
+
+		// batched kernels, evaluating the quadrature points of several elements at once in
+		// structure-of-arrays layout so that the arithmetic vectorizes across points
+		// models providing them must return true in has_batch_kernels
+		virtual bool has_batch_kernels() const { return false; }
+		// energy density at every point of the batch
+		virtual void compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const { log_and_throw_error("Batched energy not implemented by {}!", name()); }
+		// first Piola-Kirchhoff stress at every point of the batch, same layout as data.def_grad
+		virtual void compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const { log_and_throw_error("Batched stress not implemented by {}!", name()); }
+		// derivative of the stress wrt F at every point of the batch, column (i * dim + j) * dim² + k * dim + l stores ∂P(i, j)/∂F(k, l)
+		virtual void compute_stress_grad_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress_grad) const { log_and_throw_error("Batched stress derivative not implemented by {}!", name()); }
+
+		// element gradient and hessian of models with closed-form batched kernels, contracting the stress
+		// and its derivative at the quadrature points with the basis gradients
+		Eigen::VectorXd assemble_gradient_from_stress(const NonLinearAssemblerData &data) const;
+		Eigen::MatrixXd assemble_hessian_from_stress_grad(const NonLinearAssemblerData &data, const bool project_to_psd = false) const;
+
+	private:
+		// local hessian of an element and the element displacement it was computed at
+		struct ReusedHessianBlock
+		{
+			Eigen::VectorXd displacement;
+			Eigen::MatrixXd hessian;
+			double t;
+			bool project_to_psd;
+		};
+
+		double hessian_reuse_tolerance_ = 0;
+		mutable std::vector<ReusedHessianBlock> reused_hessians_;
+
+		// the element (and batch) loops are repeated at every evaluation, each thread keeps its elements
+		mutable utils::ParallelForAffinity element_affinity_;
+		mutable utils::ParallelForAffinity batch_affinity_;
+
+		// element hessian, projected at the quadrature points if the model supports it, otherwise as a whole
+		Eigen::MatrixXd assemble_element_hessian(const NonLinearAssemblerData &data, const bool project_to_psd) const;
+
+		double assemble_energy_batched(
+			const bool is_volume,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement) const;
+
+		void assemble_gradient_batched(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			Eigen::MatrixXd &rhs,
+			double *energy = nullptr) const;
 	};
 
 	class ElasticityAssembler : virtual public Assembler
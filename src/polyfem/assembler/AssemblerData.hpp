@@ -26,6 +26,38 @@ namespace polyfem::assembler
 		const QuadratureVector &da;
 	};
 
+	/// structure-of-arrays data for a batch of quadrature points, possibly spanning several elements
+	class BatchAssemblerData
+	{
+	public:
+		BatchAssemblerData(
+			const int dim,
+			const double t,
+			const double dt,
+			const Eigen::MatrixXd &local_pts,
+			const Eigen::MatrixXd &global_pts,
+			const Eigen::VectorXi &el_ids,
+			const Eigen::ArrayXXd &def_grad)
+			: dim(dim), t(t), dt(dt), local_pts(local_pts), global_pts(global_pts), el_ids(el_ids), def_grad(def_grad)
+		{
+		}
+
+		/// number of points in the batch
+		int size() const { return def_grad.rows(); }
+
+		const int dim;
+		const double t;
+		const double dt;
+		/// quadrature points in the reference element, one per row
+		const Eigen::MatrixXd &local_pts;
+		/// quadrature points mapped through the geometric mapping, one per row
+		const Eigen::MatrixXd &global_pts;
+		/// element id of every point
+		const Eigen::VectorXi &el_ids;
+		/// deformation gradient of every point, column i * dim + j stores F(i, j)
+		const Eigen::ArrayXXd &def_grad;
+	};
+
 	class LinearAssemblerData
 	{
 	public:
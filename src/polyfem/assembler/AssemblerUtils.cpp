@@ -220,5 +220,56 @@ namespace polyfem
 			}
 		}
 
+		int AssemblerUtils::adaptive_quadrature_order(const std::string &assembler, const bool is_linear, const int basis_degree, const BasisType &b_type, const int dim, const int geom_degree)
+		{
+			int order = quadrature_order(assembler, basis_degree, b_type, dim);
+
+			// the energy density of a nonlinear form is not a polynomial, integrate it at least as the product of two basis functions
+			if (!is_linear && basis_degree > 1)
+				order = std::max(order, quadrature_order("Mass", basis_degree, b_type, dim));
+
+			// the Jacobian of a curved element has degree geom_degree - 1, the mass integrand contains its determinant
+			// and the stiffness integrand is rational, approximated by two more factors of the Jacobian
+			if (geom_degree > 1)
+				order += (assembler == "Mass" ? dim : 2) * (geom_degree - 1);
+
+			return order;
+		}
+
+		std::vector<std::vector<int>> AssemblerUtils::color_elements(const std::vector<ElementBases> &bases, const int n_basis, const std::vector<int> &elements)
+		{
+			std::vector<std::vector<int>> colors;
+			std::vector<std::vector<int>> basis_colors(n_basis);
+			std::vector<int> forbidden; // forbidden[c] == i if color c is used by a neighbor of the i-th element
+
+			const int n_elements = elements.empty() ? bases.size() : elements.size();
+			for (int i = 0; i < n_elements; ++i)
+			{
+				const int e = elements.empty() ? i : elements[i];
+
+				for (const Basis &b : bases[e].bases)
+					for (const Local2Global &g : b.global())
+						for (const int c : basis_colors[g.index])
+							forbidden[c] = i;
+
+				int color = 0;
+				while (color < forbidden.size() && forbidden[color] == i)
+					++color;
+				if (color == colors.size())
+				{
+					colors.emplace_back();
+					forbidden.push_back(-1);
+				}
+				colors[color].push_back(i);
+
+				for (const Basis &b : bases[e].bases)
+					for (const Local2Global &g : b.global())
+						if (basis_colors[g.index].empty() || basis_colors[g.index].back() != color)
+							basis_colors[g.index].push_back(color);
+			}
+
+			return colors;
+		}
+
 	} // namespace assembler
 } // namespace polyfem
@@ -36,5 +36,22 @@ namespace polyfem::assembler
 		
 		/// utility for retrieving the needed quadrature order to precisely integrate the given form on the given element basis
 		static int quadrature_order(const std::string &assembler, const int basis_degree, const BasisType &b_type, const int dim);
+
+		/// @brief quadrature order adapted to the form and the element: quadrature_order, exact for linear forms on affine
+		/// elements, raised for nonlinear forms and for curved elements
+		/// @param is_linear whether the form is linear in the basis functions
+		/// @param geom_degree degree of the geometric mapping of the element, above 1 for curved elements
+		static int adaptive_quadrature_order(const std::string &assembler, const bool is_linear, const int basis_degree, const BasisType &b_type, const int dim, const int geom_degree);
+
+		/// thread-local global vectors cost n_threads * ndofs doubles, past this many the elements are colored instead
+		static constexpr long COLORING_MIN_SCRATCH = long(1e7);
+
+		/// @brief greedy coloring of elements such that no two elements of the same color share a basis,
+		/// the elements of one color can scatter in a global vector concurrently
+		/// @param bases bases of the elements
+		/// @param n_basis number of global bases
+		/// @param elements ids of the elements to color, all of them if empty
+		/// @return for every color, the positions in elements of its elements (their ids if elements is empty)
+		static std::vector<std::vector<int>> color_elements(const std::vector<basis::ElementBases> &bases, const int n_basis, const std::vector<int> &elements = {});
 	};
 } // namespace polyfem::assembler
@@ -1,6 +1,11 @@
 #include "AssemblyValsCache.hpp"
 
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <atomic>
+#include <map>
 
 namespace polyfem
 {
@@ -8,43 +13,504 @@ namespace polyfem
 
 	namespace assembler
 	{
+		namespace
+		{
+			/// maximum number of distinct reference elements, the values of the other elements are stored in the arena
+			constexpr int max_references = 64;
+			/// maximum number of shards of the on-the-fly cache, each with its own lock
+			constexpr int max_lru_shards = 16;
+
+			typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> JacobianMatrix;
+
+			size_t compact_size(const int n_quadrature_points, const int n_bases, const int dim)
+			{
+				// points, weights, mapped points, determinants, Jacobians, then values and gradients of every basis
+				return size_t(n_quadrature_points) * (2 * dim + 2 + dim * dim + n_bases * (1 + dim));
+			}
+
+			template <typename Derived>
+			bool same_matrix(const Eigen::MatrixBase<Derived> &a, const Eigen::MatrixBase<Derived> &b)
+			{
+				return a.rows() == b.rows() && a.cols() == b.cols() && a == b;
+			}
+
+			bool same_values(const std::vector<AssemblyValues> &a, const std::vector<AssemblyValues> &b)
+			{
+				if (a.size() != b.size())
+					return false;
+				for (size_t j = 0; j < a.size(); ++j)
+				{
+					if (!same_matrix(a[j].val, b[j].val) || !same_matrix(a[j].grad, b[j].grad))
+						return false;
+				}
+				return true;
+			}
+
+			bool has_constant_jacobian(const ElementAssemblyValues &vals)
+			{
+				for (int k = 1; k < vals.quadrature.size(); ++k)
+				{
+					if (vals.jac_it[k] != vals.jac_it[0] || vals.det(k) != vals.det(0))
+						return false;
+				}
+				return true;
+			}
+
+			size_t values_memory_usage(const std::vector<AssemblyValues> &values)
+			{
+				size_t bytes = utils::memory_usage(values);
+				for (const AssemblyValues &v : values)
+					bytes += utils::memory_usage(v.global) + utils::memory_usage(v.val) + utils::memory_usage(v.grad) + utils::memory_usage(v.grad_t_m);
+				return bytes;
+			}
+		} // namespace
+
+		void AssemblyValsCache::set_strategy(const Strategy strategy, const int lru_size)
+		{
+			strategy_ = strategy;
+			lru_size_ = lru_size;
+		}
+
+		AssemblyValsCache::AssemblyValsCache(const AssemblyValsCache &other)
+		{
+			*this = other;
+		}
+
+		AssemblyValsCache &AssemblyValsCache::operator=(const AssemblyValsCache &other)
+		{
+			if (this == &other)
+				return *this;
+
+			strategy_ = other.strategy_;
+			lru_size_ = other.lru_size_;
+			dim_ = other.dim_;
+			is_mass_ = other.is_mass_;
+			values_ = other.values_;
+
+			// the recently used values are not shared, only the number of shards is kept
+			lru_.clear();
+			for (size_t i = 0; i < other.lru_.size(); ++i)
+				lru_.push_back(std::make_unique<LRUShard>());
+
+			return *this;
+		}
+
+		void AssemblyValsCache::clear()
+		{
+			values_.reset();
+			lru_.clear();
+		}
+
 		void AssemblyValsCache::init(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, const bool is_mass)
 		{
 			is_mass_ = is_mass;
+			dim_ = is_volume ? 3 : 2;
 			const int n_bases = bases.size();
-			cache.resize(n_bases);
+			clear();
+
+			if (strategy_ == Strategy::OnTheFly)
+			{
+				const int n_shards = std::min(lru_size_, max_lru_shards);
+				for (int i = 0; i < n_shards; ++i)
+					lru_.push_back(std::make_unique<LRUShard>());
+				return;
+			}
 
-			// loop over elements
+			// new values, the previous ones may still be used by the copies of the cache
+			const std::shared_ptr<Values> values = std::make_shared<Values>();
+			std::vector<ElementAssemblyValues> &cache = values->cache;
+			std::vector<CompactElement> &elements = values->elements;
+			std::vector<double> &arena = values->arena;
+			std::vector<ReferenceValues> &references = values->references;
+
+			// basis values shared by the elements with the same reference key
+			std::vector<int> keyed(n_bases, -1);
+			if (strategy_ == Strategy::Full || strategy_ == Strategy::Reference)
+			{
+				references.reserve(max_references);
+				tabulate_references(bases, gbases, *values, keyed);
+			}
+
+			if (strategy_ == Strategy::Full)
+			{
+				cache.resize(n_bases);
+
+				// loop over elements
+				utils::maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+					for (int e = start; e < end; ++e)
+					{
+						if (keyed[e] >= 0)
+						{
+							const ReferenceValues &ref = references[keyed[e]];
+							cache[e].compute(e, is_volume, ref.quadrature, ref.basis_values, ref.gbasis_values, bases[e], gbases[e]);
+						}
+						else
+							compute_values(e, is_volume, bases[e], gbases[e], cache[e]);
+					}
+				});
+				values_ = values;
+				return;
+			}
+
+			elements.resize(n_bases);
+			const int jac_size = dim_ * dim_ + 1;
+
+			std::atomic<int> n_references(int(references.size()));
+			std::mutex references_mutex;
+
+			// finds the reference element of an affine element, references never reallocates so it can be read without lock
+			const auto find_reference = [&](const ElementAssemblyValues &vals, const ElementBases &basis, const ElementBases &gbasis) {
+				if (!has_constant_jacobian(vals))
+					return -1;
+
+				std::vector<AssemblyValues> gbasis_values;
+				if (&basis != &gbasis)
+				{
+					gbasis.evaluate_bases(vals.quadrature.points, gbasis_values);
+					gbasis.evaluate_grads(vals.quadrature.points, gbasis_values);
+				}
+
+				const auto matches = [&](const ReferenceValues &ref) {
+					return same_matrix(ref.quadrature.points, vals.quadrature.points) && same_matrix(ref.quadrature.weights, vals.quadrature.weights)
+						   && same_values(ref.basis_values, vals.basis_values) && same_values(ref.gbasis_values, gbasis_values);
+				};
+
+				int n = n_references.load(std::memory_order_acquire);
+				for (int r = 0; r < n; ++r)
+				{
+					if (matches(references[r]))
+						return r;
+				}
+
+				std::lock_guard<std::mutex> lock(references_mutex);
+				for (int r = n; r < n_references.load(std::memory_order_relaxed); ++r)
+				{
+					if (matches(references[r]))
+						return r;
+				}
+
+				n = n_references.load(std::memory_order_relaxed);
+				if (n >= max_references)
+					return -1;
+
+				ReferenceValues &ref = references.emplace_back();
+				ref.quadrature = vals.quadrature;
+				ref.basis_values = vals.basis_values;
+				for (AssemblyValues &v : ref.basis_values)
+				{
+					v.global.clear();
+					v.grad_t_m.resize(0, 0);
+				}
+				ref.gbasis_values = std::move(gbasis_values);
+				n_references.store(n + 1, std::memory_order_release);
+				return n;
+			};
+
+			auto storage = utils::create_thread_storage(ElementAssemblyValues());
+
+			// reference element and quadrature of every element
 			utils::maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+				ElementAssemblyValues &vals = utils::get_local_thread_storage(storage, thread_id);
 				for (int e = start; e < end; ++e)
 				{
-					if (is_mass_)
+					CompactElement &el = elements[e];
+					el.has_parameterization = gbases[e].has_parameterization;
+
+					if (keyed[e] >= 0)
+					{
+						const ReferenceValues &ref = references[keyed[e]];
+						vals.compute(e, is_volume, ref.quadrature, ref.basis_values, ref.gbasis_values, bases[e], gbases[e]);
+						el.reference = keyed[e];
+						el.n_jacobians = has_constant_jacobian(vals) ? 1 : vals.quadrature.size();
+					}
+					else if (strategy_ == Strategy::Reference && gbases[e].has_parameterization && gbases[e].bases.size() == size_t(dim_ + 1))
 					{
-						auto &quadrature = cache[e].quadrature;
-						bases[e].compute_mass_quadrature(quadrature);
-						cache[e].compute(e, is_volume, quadrature.points, bases[e], gbases[e]);
+						compute_values(e, is_volume, bases[e], gbases[e], vals);
+						el.reference = find_reference(vals, bases[e], gbases[e]);
 					}
+
+					if (el.reference >= 0)
+						el.n_quadrature_points = references[el.reference].quadrature.size();
 					else
-						cache[e].compute(e, is_volume, bases[e], gbases[e]);
+					{
+						if (is_mass_)
+							bases[e].compute_mass_quadrature(vals.quadrature);
+						else
+							bases[e].compute_quadrature(vals.quadrature);
+						el.n_quadrature_points = vals.quadrature.size();
+					}
 				}
 			});
+
+			size_t size = 0;
+			for (int e = 0; e < n_bases; ++e)
+			{
+				elements[e].offset = size;
+				size += elements[e].reference >= 0 ? size_t(elements[e].n_jacobians) * jac_size : compact_size(elements[e].n_quadrature_points, bases[e].bases.size(), dim_);
+			}
+			arena.resize(size);
+
+			utils::maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+				ElementAssemblyValues &vals = utils::get_local_thread_storage(storage, thread_id);
+				for (int e = start; e < end; ++e)
+				{
+					const CompactElement &el = elements[e];
+					double *data = arena.data() + el.offset;
+					if (el.reference >= 0)
+					{
+						// the geometric mapping from the shared tables, the Jacobian is constant for affine elements
+						const ReferenceValues &ref = references[el.reference];
+						vals.compute(e, is_volume, ref.quadrature, ref.basis_values, ref.gbasis_values, bases[e], gbases[e]);
+						for (int k = 0; k < el.n_jacobians; ++k)
+						{
+							Eigen::Map<JacobianMatrix>(data, dim_, dim_) = vals.jac_it[k];
+							data[dim_ * dim_] = vals.det(k);
+							data += jac_size;
+						}
+						continue;
+					}
+
+					compute_values(e, is_volume, bases[e], gbases[e], vals);
+					const int n_points = el.n_quadrature_points;
+					assert(vals.quadrature.size() == n_points);
+
+					Eigen::Map<Eigen::MatrixXd>(data, n_points, dim_) = vals.quadrature.points;
+					data += n_points * dim_;
+					Eigen::Map<Eigen::VectorXd>(data, n_points) = vals.quadrature.weights;
+					data += n_points;
+					Eigen::Map<Eigen::MatrixXd>(data, n_points, dim_) = vals.val;
+					data += n_points * dim_;
+					Eigen::Map<Eigen::VectorXd>(data, n_points) = vals.det;
+					data += n_points;
+					for (int k = 0; k < n_points; ++k)
+					{
+						Eigen::Map<JacobianMatrix>(data, dim_, dim_) = vals.jac_it[k];
+						data += dim_ * dim_;
+					}
+					for (const AssemblyValues &v : vals.basis_values)
+					{
+						Eigen::Map<Eigen::VectorXd>(data, n_points) = v.val;
+						data += n_points;
+						Eigen::Map<Eigen::MatrixXd>(data, n_points, dim_) = v.grad;
+						data += n_points * dim_;
+					}
+				}
+			});
+
+			values_ = values;
+			logger().debug("Assembly values cache: {} reference elements, {:.2f}MB", references.size(), memory_usage() / double(1 << 20));
 		}
 
-		void AssemblyValsCache::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
+		void AssemblyValsCache::tabulate_references(const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, Values &values, std::vector<int> &keyed) const
 		{
-			if (cache.empty())
+			// the quadrature of the Lagrange bases only depends on their type and order, so it is part of the key
+			std::map<std::pair<int, int>, int> key_to_reference;
+			for (size_t e = 0; e < bases.size(); ++e)
 			{
+				const ElementBases &basis = bases[e];
+				const ElementBases &gbasis = gbases[e];
+				const bool iso_parametric = &basis == &gbasis;
+				if (!gbasis.has_parameterization || basis.reference_key < 0 || (!iso_parametric && gbasis.reference_key < 0))
+					continue;
+
+				const std::pair<int, int> key(basis.reference_key, iso_parametric ? -1 : gbasis.reference_key);
+				const auto it = key_to_reference.find(key);
+				if (it != key_to_reference.end())
+				{
+					keyed[e] = it->second;
+					continue;
+				}
+
+				if (values.references.size() >= max_references)
+					continue;
+
+				ReferenceValues &ref = values.references.emplace_back();
 				if (is_mass_)
+					basis.compute_mass_quadrature(ref.quadrature);
+				else
+					basis.compute_quadrature(ref.quadrature);
+				basis.evaluate_bases(ref.quadrature.points, ref.basis_values);
+				basis.evaluate_grads(ref.quadrature.points, ref.basis_values);
+				if (!iso_parametric)
+				{
+					gbasis.evaluate_bases(ref.quadrature.points, ref.gbasis_values);
+					gbasis.evaluate_grads(ref.quadrature.points, ref.gbasis_values);
+				}
+
+				keyed[e] = key_to_reference[key] = int(values.references.size()) - 1;
+			}
+		}
+
+		void AssemblyValsCache::compute_values(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
+		{
+			if (is_mass_)
+			{
+				auto &quadrature = vals.quadrature;
+				basis.compute_mass_quadrature(quadrature);
+				vals.compute(el_index, is_volume, quadrature.points, basis, gbasis);
+			}
+			else
+				vals.compute(el_index, is_volume, basis, gbasis);
+		}
+
+		void AssemblyValsCache::load_compact(const int el_index, const ElementBases &basis, ElementAssemblyValues &vals) const
+		{
+			const CompactElement &el = values_->elements[el_index];
+			const int n_points = el.n_quadrature_points;
+			const double *data = values_->arena.data() + el.offset;
+
+			vals.element_id = el_index;
+			vals.has_parameterization = el.has_parameterization;
+
+			vals.quadrature.points = Eigen::Map<const Eigen::MatrixXd>(data, n_points, dim_);
+			data += n_points * dim_;
+			vals.quadrature.weights = Eigen::Map<const Eigen::VectorXd>(data, n_points);
+			data += n_points;
+			vals.val = Eigen::Map<const Eigen::MatrixXd>(data, n_points, dim_);
+			data += n_points * dim_;
+			vals.det = Eigen::Map<const Eigen::VectorXd>(data, n_points);
+			data += n_points;
+			vals.jac_it.resize(n_points);
+			for (int k = 0; k < n_points; ++k)
+			{
+				vals.jac_it[k] = Eigen::Map<const JacobianMatrix>(data, dim_, dim_);
+				data += dim_ * dim_;
+			}
+
+			vals.basis_values.resize(basis.bases.size());
+			for (int j = 0; j < basis.bases.size(); ++j)
+			{
+				AssemblyValues &v = vals.basis_values[j];
+				v.global = basis.bases[j].global();
+				v.val = Eigen::Map<const Eigen::VectorXd>(data, n_points);
+				data += n_points;
+				v.grad = Eigen::Map<const Eigen::MatrixXd>(data, n_points, dim_);
+				data += n_points * dim_;
+
+				if (!el.has_parameterization)
+				{
+					v.grad_t_m = v.grad;
+					continue;
+				}
+				v.grad_t_m.resize(n_points, dim_);
+				for (int k = 0; k < n_points; ++k)
+					v.grad_t_m.row(k) = v.grad.row(k) * vals.jac_it[k];
+			}
+		}
+
+		void AssemblyValsCache::load_reference(const int el_index, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
+		{
+			const CompactElement &el = values_->elements[el_index];
+			const ReferenceValues &ref = values_->references[el.reference];
+			const int n_points = el.n_quadrature_points;
+			const int jac_size = dim_ * dim_ + 1;
+			const double *data = values_->arena.data() + el.offset;
+
+			vals.element_id = el_index;
+			vals.has_parameterization = true;
+			vals.quadrature = ref.quadrature;
+			vals.det.resize(n_points);
+			vals.jac_it.resize(n_points);
+			for (int k = 0; k < n_points; ++k)
+			{
+				const double *jac = data + (el.n_jacobians == 1 ? 0 : k) * jac_size;
+				vals.jac_it[k] = Eigen::Map<const JacobianMatrix>(jac, dim_, dim_);
+				vals.det(k) = jac[dim_ * dim_];
+			}
+
+			vals.basis_values.resize(ref.basis_values.size());
+			for (int j = 0; j < ref.basis_values.size(); ++j)
+			{
+				AssemblyValues &v = vals.basis_values[j];
+				v.global = basis.bases[j].global();
+				v.val = ref.basis_values[j].val;
+				v.grad = ref.basis_values[j].grad;
+				v.grad_t_m.resize(n_points, dim_);
+				for (int k = 0; k < n_points; ++k)
+					v.grad_t_m.row(k) = v.grad.row(k) * vals.jac_it[k];
+			}
+
+			// same accumulation as ElementAssemblyValues::compute
+			const std::vector<AssemblyValues> &gbasis_values = ref.gbasis_values.empty() ? ref.basis_values : ref.gbasis_values;
+			vals.val.setZero(n_points, dim_);
+			for (int j = 0; j < gbasis.bases.size(); ++j)
+			{
+				const Basis &b = gbasis.bases[j];
+				for (std::size_t ii = 0; ii < b.global().size(); ++ii)
+				{
+					for (long k = 0; k < n_points; ++k)
+						vals.val.row(k) += gbasis_values[j].val(k) * b.global()[ii].node * b.global()[ii].val;
+				}
+			}
+		}
+
+		void AssemblyValsCache::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
+		{
+			if (strategy_ == Strategy::OnTheFly && !lru_.empty())
+			{
+				LRUShard &shard = *lru_[el_index % lru_.size()];
+				const size_t capacity = (lru_size_ + lru_.size() - 1) / lru_.size();
+				{
+					std::lock_guard<std::mutex> lock(shard.mutex);
+					const auto it = shard.index.find(el_index);
+					if (it != shard.index.end())
+					{
+						shard.values.splice(shard.values.begin(), shard.values, it->second);
+						vals = it->second->second;
+						return;
+					}
+				}
+
+				compute_values(el_index, is_volume, basis, gbasis, vals);
+
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				if (shard.index.count(el_index))
+					return;
+				shard.values.emplace_front(el_index, vals);
+				shard.index[el_index] = shard.values.begin();
+				if (shard.values.size() > capacity)
 				{
-					auto &quadrature = vals.quadrature;
-					basis.compute_mass_quadrature(quadrature);
-					vals.compute(el_index, is_volume, quadrature.points, basis, gbasis);
+					shard.index.erase(shard.values.back().first);
+					shard.values.pop_back();
 				}
+			}
+			else if (values_ && strategy_ == Strategy::Full && !values_->cache.empty())
+				vals = values_->cache[el_index];
+			else if (values_ && !values_->elements.empty())
+			{
+				if (values_->elements[el_index].reference >= 0)
+					load_reference(el_index, basis, gbasis, vals);
 				else
-					vals.compute(el_index, is_volume, basis, gbasis);
+					load_compact(el_index, basis, vals);
 			}
 			else
-				vals = cache[el_index];
+				compute_values(el_index, is_volume, basis, gbasis, vals);
+		}
+
+		size_t AssemblyValsCache::memory_usage() const
+		{
+			size_t bytes = 0;
+			if (values_)
+			{
+				bytes += utils::memory_usage(values_->cache);
+				for (const ElementAssemblyValues &vals : values_->cache)
+					bytes += vals.memory_usage();
+
+				bytes += utils::memory_usage(values_->elements) + utils::memory_usage(values_->arena) + utils::memory_usage(values_->references);
+				for (const ReferenceValues &ref : values_->references)
+				{
+					bytes += utils::memory_usage(ref.quadrature.points) + utils::memory_usage(ref.quadrature.weights)
+							 + values_memory_usage(ref.basis_values) + values_memory_usage(ref.gbasis_values);
+				}
+			}
+
+			for (const auto &shard : lru_)
+			{
+				std::lock_guard<std::mutex> lock(shard->mutex);
+				for (const auto &[e, vals] : shard->values)
+					bytes += sizeof(vals) + vals.memory_usage();
+			}
+			return bytes;
 		}
 	} // namespace assembler
 
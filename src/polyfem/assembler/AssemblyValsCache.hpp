@@ -2,14 +2,39 @@
 
 #include <polyfem/assembler/ElementAssemblyValues.hpp>
 
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 namespace polyfem
 {
 	namespace assembler
 	{
-		/// Caches basis evaluation and geometric mapping at every element
+		/// Caches basis evaluation and geometric mapping at every element.
+		/// Copies share the cached values, which are never modified once computed: init replaces them, so the
+		/// copies diverge at the next init of either of them (e.g., after a shape update).
 		class AssemblyValsCache
 		{
 		public:
+			AssemblyValsCache() = default;
+			AssemblyValsCache(const AssemblyValsCache &other);
+			AssemblyValsCache &operator=(const AssemblyValsCache &other);
+			/// how the values of the elements are stored
+			enum class Strategy
+			{
+				Full,      ///< one ElementAssemblyValues per element
+				Compact,   ///< values of all elements in a single arena, the mapped gradients are recomputed
+				Reference, ///< shares the basis values of identical reference elements, only the Jacobians of the elements are stored
+				OnTheFly   ///< recomputes the values, keeping the most recently used elements
+			};
+
+			/// @brief selects the storage of the values, used by the next init
+			/// @param[in] strategy storage strategy
+			/// @param[in] lru_size number of elements kept by the on-the-fly strategy
+			void set_strategy(const Strategy strategy, const int lru_size = 0);
+			inline Strategy strategy() const { return strategy_; }
+
 			/// computes the basis evaluation and geometric mapping
 			/// for each of the given ElementBases in bases
 			/// initializes cache member
@@ -19,16 +44,73 @@ namespace polyfem
 			/// if it doesn't exist, computes and caches it (modifies cache member in the latter case)
 			void compute(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis, ElementAssemblyValues &vals) const;
 
-			void clear()
-			{
-				cache.clear();
-			}
+			void clear();
 
 			inline bool is_mass() const { return is_mass_; }
 
+			/// bytes allocated by the cache, including the values shared with other copies
+			size_t memory_usage() const;
+
+			/// @brief true if the two caches share their values
+			bool shares_values_with(const AssemblyValsCache &other) const { return values_ != nullptr && values_ == other.values_; }
+
 		private:
-			std::vector<ElementAssemblyValues> cache; ///< vector of basis values and geometric mapping with one entry per element
-			bool is_mass_;
+			/// values evaluated on a reference element, shared by the elements using the same bases and quadrature
+			struct ReferenceValues
+			{
+				quadrature::Quadrature quadrature;
+				std::vector<AssemblyValues> basis_values;
+				std::vector<AssemblyValues> gbasis_values; ///< empty for iso-parametric elements
+			};
+
+			/// location of the values of an element in the arena
+			struct CompactElement
+			{
+				size_t offset;
+				int n_quadrature_points;
+				int reference = -1; ///< index in references_, -1 if the values are in the arena
+				int n_jacobians = 1; ///< Jacobians stored for a reference element, 1 if it is affine
+				bool has_parameterization;
+			};
+
+			/// most recently used values of a subset of the elements
+			struct LRUShard
+			{
+				std::mutex mutex;
+				std::list<std::pair<int, ElementAssemblyValues>> values;
+				std::unordered_map<int, std::list<std::pair<int, ElementAssemblyValues>>::iterator> index;
+			};
+
+			/// values computed by init
+			struct Values
+			{
+				std::vector<ElementAssemblyValues> cache; ///< vector of basis values and geometric mapping with one entry per element
+				std::vector<CompactElement> elements;     ///< compact and reference strategies
+				std::vector<double> arena;                ///< points, weights, mapped points, determinants, Jacobians, basis values and gradients
+				std::vector<ReferenceValues> references;
+			};
+
+			/// tabulates the bases once for every reference key (see ElementBases::reference_key) in values.references
+			/// @param[out] keyed per element index in values.references, -1 if the element has no reference key
+			void tabulate_references(const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases, Values &values, std::vector<int> &keyed) const;
+
+			/// computes the values of an element without the cache
+			void compute_values(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis, ElementAssemblyValues &vals) const;
+
+			/// rebuilds the values of an element from the arena, or from its reference element and Jacobian
+			void load_compact(const int el_index, const basis::ElementBases &basis, ElementAssemblyValues &vals) const;
+			void load_reference(const int el_index, const basis::ElementBases &basis, const basis::ElementBases &gbasis, ElementAssemblyValues &vals) const;
+
+			Strategy strategy_ = Strategy::Full;
+			int lru_size_ = 0;
+			int dim_ = 0;
+
+			bool is_mass_ = false;
+
+			/// shared with the copies of the cache, null if the values are not cached
+			std::shared_ptr<const Values> values_;
+
+			mutable std::vector<std::unique_ptr<LRUShard>> lru_; ///< on-the-fly strategy
 		};
 	} // namespace assembler
 } // namespace polyfem
@@ -1,5 +1,10 @@
 #include "ElementAssemblyValues.hpp"
 
+#include <polyfem/utils/MemoryUsage.hpp>
+
+#include <algorithm>
+#include <array>
+
 namespace polyfem
 {
 	using namespace basis;
@@ -60,86 +65,128 @@ namespace polyfem
 			return true;
 		}
 
-		void ElementAssemblyValues::finalize3d(const ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values)
+		template <int DIM>
+		void ElementAssemblyValues::finalize_mapping(const ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values)
 		{
 			// if(det.size() != val.rows())
 			// 	logger().trace("Reallocating memory");
-			det.resize(val.rows(), 1);
+			const long n_pts = val.rows();
+			det.resize(n_pts, 1);
+			jac_it.resize(n_pts);
 
 			for (std::size_t j = 0; j < basis_values.size(); ++j)
 				basis_values[j].finalize();
 
-			Eigen::Matrix3d tmp;
-			jac_it.resize(val.rows());
+			assert(gbasis.has_parameterization);
 
-			// loop over points
-			for (long k = 0; k < val.rows(); ++k)
+			// geometric nodes, weighted by the local to global mapping
+			Eigen::Matrix<double, Eigen::Dynamic, DIM> nodes = Eigen::Matrix<double, Eigen::Dynamic, DIM>::Zero(gbasis_values.size(), DIM);
+			for (int j = 0; j < gbasis_values.size(); ++j)
 			{
-				tmp.setZero();
-				for (int j = 0; j < gbasis_values.size(); ++j)
-				{
-					const Basis &b = gbasis.bases[j];
-					assert(gbasis.has_parameterization);
-					assert(gbasis_values[j].grad.rows() == val.rows());
-					assert(gbasis_values[j].grad.cols() == 3);
-
-					for (std::size_t ii = 0; ii < b.global().size(); ++ii)
-					{
-						tmp.row(0) += gbasis_values[j].grad(k, 0) * b.global()[ii].node * b.global()[ii].val;
-						tmp.row(1) += gbasis_values[j].grad(k, 1) * b.global()[ii].node * b.global()[ii].val;
-						tmp.row(2) += gbasis_values[j].grad(k, 2) * b.global()[ii].node * b.global()[ii].val;
-					}
-				}
+				assert(gbasis_values[j].grad.rows() == n_pts);
+				assert(gbasis_values[j].grad.cols() == DIM);
+				for (const auto &g : gbasis.bases[j].global())
+					nodes.row(j) += g.val * g.node;
+			}
 
-				det(k) = tmp.determinant();
-				// assert(det(k)>0);
-				// std::cout<<det(k)<<std::endl;
+			// the gradients of P1 simplices are constant, so is the Jacobian of their geometric mapping
+			if (gbasis.reference_key == ElementBases::lagrange_reference_key(DIM, true, 1))
+			{
+				Eigen::Matrix<double, DIM, DIM> jac = Eigen::Matrix<double, DIM, DIM>::Zero();
+				for (int j = 0; j < gbasis_values.size(); ++j)
+					jac += gbasis_values[j].grad.row(0).transpose() * nodes.row(j);
 
-				jac_it[k] = tmp.inverse().transpose();
+				const Eigen::Matrix<double, DIM, DIM> it = jac.inverse().transpose();
+				det.setConstant(jac.determinant());
+				std::fill(jac_it.begin(), jac_it.end(), it);
 				for (std::size_t j = 0; j < basis_values.size(); ++j)
-					basis_values[j].grad_t_m.row(k) = basis_values[j].grad.row(k) * jac_it[k];
+					basis_values[j].grad_t_m.noalias() = basis_values[j].grad * it;
+				return;
 			}
-		}
 
-		void ElementAssemblyValues::finalize2d(const ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values)
-		{
-			det.resize(val.rows(), 1);
+			// J(r, c) at all the points at once
+			std::array<Eigen::ArrayXd, DIM * DIM> jac;
+			Eigen::MatrixXd grads(n_pts, gbasis_values.size());
+			for (int r = 0; r < DIM; ++r)
+			{
+				for (int j = 0; j < gbasis_values.size(); ++j)
+					grads.col(j) = gbasis_values[j].grad.col(r);
+				const Eigen::Matrix<double, Eigen::Dynamic, DIM> jac_r = grads * nodes;
+				for (int c = 0; c < DIM; ++c)
+					jac[r * DIM + c] = jac_r.col(c).array();
+			}
+			const auto J = [&jac](const int r, const int c) -> const Eigen::ArrayXd & { return jac[r * DIM + c]; };
 
-			for (std::size_t j = 0; j < basis_values.size(); ++j)
-				basis_values[j].finalize();
+			// J^{-T} = cofactor(J) / det(J)
+			std::array<Eigen::ArrayXd, DIM * DIM> it;
+			if constexpr (DIM == 2)
+			{
+				it[0] = J(1, 1);
+				it[1] = -J(1, 0);
+				it[2] = -J(0, 1);
+				it[3] = J(0, 0);
+				det = (J(0, 0) * J(1, 1) - J(0, 1) * J(1, 0)).matrix();
+			}
+			else
+			{
+				it[0] = J(1, 1) * J(2, 2) - J(1, 2) * J(2, 1);
+				it[1] = J(1, 2) * J(2, 0) - J(1, 0) * J(2, 2);
+				it[2] = J(1, 0) * J(2, 1) - J(1, 1) * J(2, 0);
+				it[3] = J(0, 2) * J(2, 1) - J(0, 1) * J(2, 2);
+				it[4] = J(0, 0) * J(2, 2) - J(0, 2) * J(2, 0);
+				it[5] = J(0, 1) * J(2, 0) - J(0, 0) * J(2, 1);
+				it[6] = J(0, 1) * J(1, 2) - J(0, 2) * J(1, 1);
+				it[7] = J(0, 2) * J(1, 0) - J(0, 0) * J(1, 2);
+				it[8] = J(0, 0) * J(1, 1) - J(0, 1) * J(1, 0);
+				det = (J(0, 0) * it[0] + J(0, 1) * it[1] + J(0, 2) * it[2]).matrix();
+			}
+			// assert(det(k)>0);
+			const Eigen::ArrayXd inv_det = det.array().inverse();
+			for (Eigen::ArrayXd &entry : it)
+				entry *= inv_det;
 
-			Eigen::Matrix2d tmp;
-			jac_it.resize(val.rows());
+			for (long k = 0; k < n_pts; ++k)
+			{
+				jac_it[k].resize(DIM, DIM);
+				for (int r = 0; r < DIM; ++r)
+					for (int c = 0; c < DIM; ++c)
+						jac_it[k](r, c) = it[r * DIM + c](k);
+			}
 
-			// loop over points
-			for (long k = 0; k < val.rows(); ++k)
+			for (std::size_t j = 0; j < basis_values.size(); ++j)
 			{
-				tmp.setZero();
-				for (int j = 0; j < gbasis_values.size(); ++j)
+				const Eigen::MatrixXd &grad = basis_values[j].grad;
+				Eigen::MatrixXd &grad_t_m = basis_values[j].grad_t_m;
+				for (int c = 0; c < DIM; ++c)
 				{
-					const Basis &b = gbasis.bases[j];
-					assert(gbasis.has_parameterization);
-					assert(gbasis_values[j].grad.rows() == val.rows());
-					assert(gbasis_values[j].grad.cols() == 2);
-
-					for (std::size_t ii = 0; ii < b.global().size(); ++ii)
-					{
-						// add given geometric basis function + node's contribution to the Jacobian
-						tmp.row(0) += gbasis_values[j].grad(k, 0) * b.global()[ii].node * b.global()[ii].val;
-						tmp.row(1) += gbasis_values[j].grad(k, 1) * b.global()[ii].node * b.global()[ii].val;
-					}
+					grad_t_m.col(c) = grad.col(0).array() * it[c];
+					for (int r = 1; r < DIM; ++r)
+						grad_t_m.col(c).array() += grad.col(r).array() * it[r * DIM + c];
 				}
+			}
+		}
 
-				// save Jacobian's determinant
-				det(k) = tmp.determinant();
-				// assert(det(k)>0);
-				// std::cout<<det(k)<<std::endl;
+		void ElementAssemblyValues::finalize3d(const ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values)
+		{
+			finalize_mapping<3>(gbasis, gbasis_values);
+		}
 
-				// save Jacobian's inverse transpose
-				jac_it[k] = tmp.inverse().transpose();
-				for (std::size_t j = 0; j < basis_values.size(); ++j)
-					basis_values[j].grad_t_m.row(k) = basis_values[j].grad.row(k) * jac_it[k];
+		void ElementAssemblyValues::finalize2d(const ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values)
+		{
+			finalize_mapping<2>(gbasis, gbasis_values);
+		}
+
+		size_t ElementAssemblyValues::memory_usage() const
+		{
+			size_t bytes = utils::memory_usage(jac_it) + utils::memory_usage(quadrature.points) + utils::memory_usage(quadrature.weights)
+						   + utils::memory_usage(val) + utils::memory_usage(det);
+			for (const std::vector<AssemblyValues> *values : {&basis_values, &g_basis_values_cache_})
+			{
+				bytes += utils::memory_usage(*values);
+				for (const AssemblyValues &v : *values)
+					bytes += utils::memory_usage(v.global) + utils::memory_usage(v.val) + utils::memory_usage(v.grad) + utils::memory_usage(v.grad_t_m);
 			}
+			return bytes;
 		}
 
 		void ElementAssemblyValues::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis)
@@ -219,6 +266,46 @@ namespace polyfem
 				finalize2d(gbasis, gbasis_values);
 		}
 
+		void ElementAssemblyValues::compute(const int el_index, const bool is_volume, const Quadrature &ref_quadrature,
+											const std::vector<AssemblyValues> &ref_basis_values, const std::vector<AssemblyValues> &ref_gbasis_values,
+											const ElementBases &basis, const ElementBases &gbasis)
+		{
+			assert(gbasis.has_parameterization);
+			assert(ref_basis_values.size() == basis.bases.size());
+
+			element_id = el_index;
+			has_parameterization = true;
+			quadrature = ref_quadrature;
+
+			basis_values.resize(ref_basis_values.size());
+			for (std::size_t j = 0; j < basis_values.size(); ++j)
+			{
+				AssemblyValues &ass_val = basis_values[j];
+				ass_val.global = basis.bases[j].global();
+				ass_val.val = ref_basis_values[j].val;
+				ass_val.grad = ref_basis_values[j].grad;
+			}
+
+			const auto &gbasis_values = ref_gbasis_values.empty() ? ref_basis_values : ref_gbasis_values;
+			assert(gbasis_values.size() == gbasis.bases.size());
+			val.setZero(quadrature.points.rows(), quadrature.points.cols());
+
+			for (std::size_t j = 0; j < gbasis_values.size(); ++j)
+			{
+				const Basis &b = gbasis.bases[j];
+				for (std::size_t ii = 0; ii < b.global().size(); ++ii)
+				{
+					for (long k = 0; k < val.rows(); ++k)
+						val.row(k) += gbasis_values[j].val(k) * b.global()[ii].node * b.global()[ii].val;
+				}
+			}
+
+			if (is_volume)
+				finalize3d(gbasis, gbasis_values);
+			else
+				finalize2d(gbasis, gbasis_values);
+		}
+
 		bool ElementAssemblyValues::is_geom_mapping_positive(const bool is_volume, const ElementBases &gbasis) const
 		{
 			if (!gbasis.has_parameterization)
@@ -40,10 +40,21 @@ namespace polyfem
 
 			/// computes quadrature points for given element then calls above (overloaded) compute function
 			void compute(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis);
+
+			/// computes the per element values from bases tabulated on the reference element, only the geometric mapping is evaluated
+			/// @param[in] ref_quadrature quadrature of the tabulated values
+			/// @param[in] ref_basis_values values and gradients of the bases at the quadrature points
+			/// @param[in] ref_gbasis_values values and gradients of the geometric bases, empty for iso-parametric elements
+			void compute(const int el_index, const bool is_volume, const quadrature::Quadrature &ref_quadrature,
+						 const std::vector<AssemblyValues> &ref_basis_values, const std::vector<AssemblyValues> &ref_gbasis_values,
+						 const basis::ElementBases &basis, const basis::ElementBases &gbasis);
 			
 			/// check if the element is flipped
 			bool is_geom_mapping_positive(const bool is_volume, const basis::ElementBases &gbasis) const;
 
+			/// bytes allocated by the values
+			size_t memory_usage() const;
+
 		private:
 			std::vector<AssemblyValues> g_basis_values_cache_;
 
@@ -55,6 +66,9 @@ namespace polyfem
 			/// compute Jacobians
 			void finalize2d(const basis::ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values);
 			void finalize3d(const basis::ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values);
+			/// Jacobians of the geometric mapping of all the quadrature points at once, computed once for affine simplices
+			template <int DIM>
+			void finalize_mapping(const basis::ElementBases &gbasis, const std::vector<AssemblyValues> &gbasis_values);
 
 			bool is_geom_mapping_positive(const Eigen::MatrixXd &dx, const Eigen::MatrixXd &dy, const Eigen::MatrixXd &dz) const;
 			bool is_geom_mapping_positive(const Eigen::MatrixXd &dx, const Eigen::MatrixXd &dy) const;
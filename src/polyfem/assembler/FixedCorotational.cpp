@@ -3,6 +3,8 @@
 #include <polyfem/autogen/auto_elasticity_rhs.hpp>
 #include <polyfem/utils/svd.hpp>
 
+#include <ipc/utils/eigen_ext.hpp>
+
 namespace polyfem::assembler
 {
 	namespace
@@ -86,69 +88,12 @@ namespace polyfem::assembler
 	Eigen::VectorXd
 	FixedCorotational::assemble_gradient(const NonLinearAssemblerData &data) const
 	{
-		Eigen::Matrix<double, Eigen::Dynamic, 1> gradient;
+		const int n_bases = data.vals.basis_values.size();
+		Eigen::VectorXd gradient(n_bases * size());
 
-		if (size() == 2)
-		{
-			switch (data.vals.basis_values.size())
-			{
-			case 3:
-			{
-				gradient.resize(6);
-				compute_energy_aux_gradient_fast<3, 2>(data, gradient);
-				break;
-			}
-			case 6:
-			{
-				gradient.resize(12);
-				compute_energy_aux_gradient_fast<6, 2>(data, gradient);
-				break;
-			}
-			case 10:
-			{
-				gradient.resize(20);
-				compute_energy_aux_gradient_fast<10, 2>(data, gradient);
-				break;
-			}
-			default:
-			{
-				gradient.resize(data.vals.basis_values.size() * 2);
-				compute_energy_aux_gradient_fast<Eigen::Dynamic, 2>(data, gradient);
-				break;
-			}
-			}
-		}
-		else // if (size() == 3)
-		{
-			assert(size() == 3);
-			switch (data.vals.basis_values.size())
-			{
-			case 4:
-			{
-				gradient.resize(12);
-				compute_energy_aux_gradient_fast<4, 3>(data, gradient);
-				break;
-			}
-			case 10:
-			{
-				gradient.resize(30);
-				compute_energy_aux_gradient_fast<10, 3>(data, gradient);
-				break;
-			}
-			case 20:
-			{
-				gradient.resize(60);
-				compute_energy_aux_gradient_fast<20, 3>(data, gradient);
-				break;
-			}
-			default:
-			{
-				gradient.resize(data.vals.basis_values.size() * 3);
-				compute_energy_aux_gradient_fast<Eigen::Dynamic, 3>(data, gradient);
-				break;
-			}
-			}
-		}
+		dispatch_element_kernel(size(), n_bases, [&](auto n_basis, auto dim) {
+			compute_energy_aux_gradient_fast<decltype(n_basis)::value, decltype(dim)::value>(data, gradient);
+		});
 
 		return gradient;
 	}
@@ -156,81 +101,28 @@ namespace polyfem::assembler
 	Eigen::MatrixXd
 	FixedCorotational::assemble_hessian(const NonLinearAssemblerData &data) const
 	{
-		Eigen::MatrixXd hessian;
+		const int n_bases = data.vals.basis_values.size();
+		Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(n_bases * size(), n_bases * size());
 
-		if (size() == 2)
-		{
-			switch (data.vals.basis_values.size())
-			{
-			case 3:
-			{
-				hessian.resize(6, 6);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<3, 2>(data, hessian);
-				break;
-			}
-			case 6:
-			{
-				hessian.resize(12, 12);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<6, 2>(data, hessian);
-				break;
-			}
-			case 10:
-			{
-				hessian.resize(20, 20);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<10, 2>(data, hessian);
-				break;
-			}
-			default:
-			{
-				hessian.resize(data.vals.basis_values.size() * 2, data.vals.basis_values.size() * 2);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<Eigen::Dynamic, 2>(data, hessian);
-				break;
-			}
-			}
-		}
-		else // if (size() == 3)
-		{
-			assert(size() == 3);
-			switch (data.vals.basis_values.size())
-			{
-			case 4:
-			{
-				hessian.resize(12, 12);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<4, 3>(data, hessian);
-				break;
-			}
-			case 10:
-			{
-				hessian.resize(30, 30);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<10, 3>(data, hessian);
-				break;
-			}
-			case 20:
-			{
-				hessian.resize(60, 60);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<20, 3>(data, hessian);
-				break;
-			}
-			default:
-			{
-				hessian.resize(data.vals.basis_values.size() * 3, data.vals.basis_values.size() * 3);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<Eigen::Dynamic, 3>(data, hessian);
-				break;
-			}
-			}
-		}
+		dispatch_element_kernel(size(), n_bases, [&](auto n_basis, auto dim) {
+			compute_energy_hessian_aux_fast<decltype(n_basis)::value, decltype(dim)::value>(data, false, hessian);
+		});
 
 		return hessian;
 	}
 
+	bool FixedCorotational::assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const
+	{
+		const int n_bases = data.vals.basis_values.size();
+		hessian = Eigen::MatrixXd::Zero(n_bases * size(), n_bases * size());
+
+		dispatch_element_kernel(size(), n_bases, [&](auto n_basis, auto dim) {
+			compute_energy_hessian_aux_fast<decltype(n_basis)::value, decltype(dim)::value>(data, true, hessian);
+		});
+
+		return true;
+	}
+
 	void FixedCorotational::assign_stress_tensor(const OutputData &data,
 													const int all_size,
 													const ElasticityTensorType &type,
@@ -290,6 +182,46 @@ namespace polyfem::assembler
 			return compute_energy_aux<3>(data);
 	}
 
+	// Ψ = μ ∑(σᵢ - 1)² + ½λ (∏σᵢ - 1)²
+	void FixedCorotational::compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const
+	{
+		Eigen::ArrayXd lambda, mu;
+		params_.lambda_mu(data.local_pts, data.global_pts, data.t, data.el_ids, lambda, mu);
+
+		Eigen::ArrayXXd U, sigmas, V;
+		batch_svd(data.dim, data.def_grad, U, sigmas, V);
+
+		const Eigen::ArrayXd J = sigmas.rowwise().prod();
+		psi = mu * (sigmas - 1).square().rowwise().sum() + lambda / 2 * (J - 1).square();
+	}
+
+	// P = U diag(∂Ψ/∂σ) Vᵀ
+	void FixedCorotational::compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const
+	{
+		const int dim = data.dim;
+
+		Eigen::ArrayXd lambda, mu;
+		params_.lambda_mu(data.local_pts, data.global_pts, data.t, data.el_ids, lambda, mu);
+
+		Eigen::ArrayXXd U, sigmas, V;
+		batch_svd(dim, data.def_grad, U, sigmas, V);
+
+		const Eigen::ArrayXd J = sigmas.rowwise().prod();
+		stress.setZero(data.size(), dim * dim);
+		for (int a = 0; a < dim; ++a)
+		{
+			Eigen::ArrayXd prod_others = Eigen::ArrayXd::Ones(data.size());
+			for (int b = 0; b < dim; ++b)
+				if (b != a)
+					prod_others *= sigmas.col(b);
+
+			const Eigen::ArrayXd dpsi = 2 * mu * (sigmas.col(a) - 1) + lambda * (J - 1) * prod_others;
+			for (int i = 0; i < dim; ++i)
+				for (int j = 0; j < dim; ++j)
+					stress.col(i * dim + j) += dpsi * U.col(i * dim + a) * V.col(j * dim + a);
+		}
+	}
+
 	template <int dim>
 	double FixedCorotational::compute_energy_aux(const NonLinearAssemblerData &data) const
 	{
@@ -378,7 +310,7 @@ namespace polyfem::assembler
 	}
 
 	template <int n_basis, int dim>
-	void FixedCorotational::compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, Eigen::MatrixXd &H) const
+	void FixedCorotational::compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, const bool project_to_psd, Eigen::MatrixXd &H) const
 	{
 		assert(data.x.cols() == 1);
 
@@ -418,7 +350,7 @@ namespace polyfem::assembler
 			double lambda, mu;
 			params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda, mu);
 
-			Eigen::Matrix<double, dim * dim, dim * dim> hessian_temp = compute_stiffness_from_def_grad(def_grad, lambda, mu);
+			Eigen::Matrix<double, dim * dim, dim * dim> hessian_temp = compute_stiffness_from_def_grad(def_grad, lambda, mu, project_to_psd);
 
 			Eigen::Matrix<double, dim * dim, N> delF_delU_tensor(jac_it.size(), grad.size());
 
@@ -704,12 +636,14 @@ namespace polyfem::assembler
 	}
 
 	template <int dim>
-	Eigen::Matrix<double, dim*dim, dim*dim> FixedCorotational::compute_stiffness_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu)
+	Eigen::Matrix<double, dim*dim, dim*dim> FixedCorotational::compute_stiffness_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu, const bool project_to_psd)
 	{
 		utils::AutoFlipSVD<Eigen::Matrix<double, dim, dim>> svd(F, Eigen::ComputeFullU | Eigen::ComputeFullV);
 		const Eigen::Vector<double, dim> sigmas = svd.singularValues();
 		Eigen::Matrix<double, dim, 1> dE_div_dsigma = compute_stress_from_singular_values(sigmas, lambda, mu);
 		Eigen::Matrix<double, dim, dim> d2E_div_dsigma2 = compute_stiffness_from_singular_values(sigmas, lambda, mu);
+		if (project_to_psd)
+			d2E_div_dsigma2 = ipc::project_to_psd(d2E_div_dsigma2);
 
 		constexpr int Cdim2 = dim * (dim - 1) / 2;
 		Eigen::Matrix<double, Cdim2, 1> BLeftCoef;
@@ -734,6 +668,13 @@ namespace polyfem::assembler
 			double sum_sigma = sigmas[cI] + sigmas[cI_post];
 			rightCoef /= 2.0 * std::max(sum_sigma, 1.0e-12);
 
+			// the eigenvalues of B are 2 * leftCoef and 2 * rightCoef
+			if (project_to_psd)
+			{
+				rightCoef = std::max(rightCoef, 0.0);
+				BLeftCoef[cI] = std::max(BLeftCoef[cI], 0.0);
+			}
+
 			const double& leftCoef = BLeftCoef[cI];
 			B[cI](0, 0) = B[cI](1, 1) = leftCoef + rightCoef;
 			B[cI](0, 1) = B[cI](1, 0) = leftCoef - rightCoef;
@@ -21,6 +21,12 @@ namespace polyfem::assembler
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
+		bool assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const override;
+
+		// batched energy density and stress, using the batched SVD across the points of several elements
+		bool has_batch_kernels() const override { return true; }
+		void compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const override;
+		void compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const override;
 
 		void compute_stress_grad_multiply_mat(const OptAssemblerData &data,
 											  const Eigen::MatrixXd &mat,
@@ -63,7 +69,7 @@ namespace polyfem::assembler
 		template <int dim>
 		double compute_energy_aux(const NonLinearAssemblerData &data) const;
 		template <int n_basis, int dim>
-		void compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, Eigen::MatrixXd &H) const;
+		void compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, const bool project_to_psd, Eigen::MatrixXd &H) const;
 		template <int n_basis, int dim>
 		void compute_energy_aux_gradient_fast(const NonLinearAssemblerData &data, Eigen::VectorXd &G_flattened) const;
 	
@@ -78,7 +84,8 @@ namespace polyfem::assembler
 		static double compute_energy_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu);
 		template <int dim>
 		static Eigen::Matrix<double, dim, dim> compute_stress_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu);
+		/// @brief hessian of the energy wrt F, if project_to_psd its eigen-system is clamped analytically in the singular value basis
 		template <int dim>
-		static Eigen::Matrix<double, dim*dim, dim*dim> compute_stiffness_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu);
+		static Eigen::Matrix<double, dim*dim, dim*dim> compute_stiffness_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu, const bool project_to_psd = false);
 	};
 } // namespace polyfem::assembler
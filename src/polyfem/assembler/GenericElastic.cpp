@@ -8,6 +8,8 @@
 
 #include <polyfem/utils/Logger.hpp>
 
+#include <ipc/utils/eigen_ext.hpp>
+
 namespace polyfem::assembler
 {
 	template <typename Derived>
@@ -92,38 +94,116 @@ namespace polyfem::assembler
 	template <typename Derived>
 	Eigen::VectorXd GenericElastic<Derived>::assemble_gradient(const NonLinearAssemblerData &data) const
 	{
+		return size() == 2 ? assemble_gradient_aux<2>(data) : assemble_gradient_aux<3>(data);
+	}
+
+	template <typename Derived>
+	template <int dim>
+	Eigen::VectorXd GenericElastic<Derived>::assemble_gradient_aux(const NonLinearAssemblerData &data) const
+	{
+		// the energy is differentiated wrt F only, the gradient wrt the element dofs follows from the chain rule
+		typedef AutodiffScalarGradFixed<dim * dim> Diff;
+
 		const int n_bases = data.vals.basis_values.size();
-		return polyfem::gradient_from_energy(
-			size(), n_bases, data,
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 6, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 8, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 12, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 18, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 24, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 30, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 60, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 81, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, BIG_N, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::VectorXd>>(data); });
+
+		Eigen::VectorXd local_disp;
+		get_local_disp(data, dim, local_disp);
+		const auto U = local_disp.reshaped<Eigen::RowMajor>(n_bases, dim);
+
+		Eigen::MatrixXd grad = Eigen::MatrixXd::Zero(n_bases, dim);
+		Eigen::MatrixXd G(n_bases, dim);
+		Eigen::MatrixXd P(dim, dim);
+
+		Eigen::Matrix<Diff, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> def_grad(dim, dim);
+
+		const int n_pts = data.da.size();
+		for (long p = 0; p < n_pts; ++p)
+		{
+			basis_grads_at_quad(data, p, dim, G);
+			const Eigen::MatrixXd F = Eigen::MatrixXd::Identity(dim, dim) + U.transpose() * G;
+
+			for (int d = 0; d < dim; ++d)
+				for (int c = 0; c < dim; ++c)
+					def_grad(d, c) = Diff(d * dim + c, F(d, c));
+
+			const Diff val = derived().elastic_energy(data.vals.val.row(p), data.t, data.vals.element_id, def_grad);
+
+			for (int d = 0; d < dim; ++d)
+				for (int c = 0; c < dim; ++c)
+					P(d, c) = val.getGradient()(d * dim + c);
+
+			// ∂W/∂u_id = Σ_c P_dc ∇φ_i,c
+			grad.noalias() += data.da(p) * G * P.transpose();
+		}
+
+		return grad.reshaped<Eigen::RowMajor>();
 	}
 
 	template <typename Derived>
 	Eigen::MatrixXd GenericElastic<Derived>::assemble_hessian(const NonLinearAssemblerData &data) const
 	{
+		return size() == 2 ? assemble_hessian_aux<2>(data, false) : assemble_hessian_aux<3>(data, false);
+	}
+
+	template <typename Derived>
+	bool GenericElastic<Derived>::assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const
+	{
+		hessian = size() == 2 ? assemble_hessian_aux<2>(data, true) : assemble_hessian_aux<3>(data, true);
+		return true;
+	}
+
+	template <typename Derived>
+	template <int dim>
+	Eigen::MatrixXd GenericElastic<Derived>::assemble_hessian_aux(const NonLinearAssemblerData &data, const bool project_to_psd) const
+	{
+		// the energy is differentiated wrt F only, the Hessian wrt the element dofs is Bᵀ (∂²W/∂F²) B
+		typedef AutodiffScalarHessianFixed<dim * dim> Diff;
+
 		const int n_bases = data.vals.basis_values.size();
-		return polyfem::hessian_from_energy(
-			size(), n_bases, data,
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(data); });
+
+		Eigen::VectorXd local_disp;
+		get_local_disp(data, dim, local_disp);
+		const auto U = local_disp.reshaped<Eigen::RowMajor>(n_bases, dim);
+
+		Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(n_bases * dim, n_bases * dim);
+		Eigen::MatrixXd G(n_bases, dim);
+		// B_(dc),(id) = ∂F_dc/∂u_id = ∇φ_i,c
+		Eigen::MatrixXd B = Eigen::MatrixXd::Zero(dim * dim, n_bases * dim);
+
+		Eigen::Matrix<Diff, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> def_grad(dim, dim);
+
+		const int n_pts = data.da.size();
+		for (long p = 0; p < n_pts; ++p)
+		{
+			basis_grads_at_quad(data, p, dim, G);
+			const Eigen::MatrixXd F = Eigen::MatrixXd::Identity(dim, dim) + U.transpose() * G;
+
+			for (int d = 0; d < dim; ++d)
+				for (int c = 0; c < dim; ++c)
+					def_grad(d, c) = Diff(d * dim + c, F(d, c));
+
+			const Diff val = derived().elastic_energy(data.vals.val.row(p), data.t, data.vals.element_id, def_grad);
+
+			for (int i = 0; i < n_bases; ++i)
+				for (int d = 0; d < dim; ++d)
+					for (int c = 0; c < dim; ++c)
+						B(d * dim + c, i * dim + d) = G(i, c);
+
+			if (project_to_psd)
+				hessian.noalias() += data.da(p) * B.transpose() * ipc::project_to_psd(val.getHessian()) * B;
+			else
+				hessian.noalias() += data.da(p) * B.transpose() * val.getHessian() * B;
+		}
+
+		return hessian;
+	}
+
+	template <typename Derived>
+	void GenericElastic<Derived>::basis_grads_at_quad(const NonLinearAssemblerData &data, const int p, const int dim, Eigen::MatrixXd &G) const
+	{
+		// same mapping as compute_disp_grad_at_quad
+		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
+			G.row(i) = data.vals.basis_values[i].grad.row(p) * data.vals.jac_it[p];
 	}
 
 	template <typename Derived>
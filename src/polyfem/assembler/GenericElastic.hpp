@@ -23,6 +23,7 @@ namespace polyfem::assembler
 		// energy, gradient, and hessian used in newton method
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
+		bool assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const override;
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 
 		void assign_stress_tensor(const OutputData &data,
@@ -54,7 +55,18 @@ namespace polyfem::assembler
 		virtual void add_multimaterial(const int index, const json &params, const Units &units) override = 0;
 
 	private:
-		// utility function that computes energy, the template is used for double, DScalar1, and DScalar2 in energy, gradient and hessian
+		/// @brief gradient of the element, the energy is differentiated wrt the dim² entries of F with fixed-size autodiff
+		template <int dim>
+		Eigen::VectorXd assemble_gradient_aux(const NonLinearAssemblerData &data) const;
+		/// @brief hessian of the element, the F-level hessian is projected to PSD at every quadrature point if project_to_psd
+		template <int dim>
+		Eigen::MatrixXd assemble_hessian_aux(const NonLinearAssemblerData &data, const bool project_to_psd) const;
+
+		/// @brief gradients of the element bases wrt the physical coordinates at the quadrature point p
+		/// @param[out] G #bases x dim
+		void basis_grads_at_quad(const NonLinearAssemblerData &data, const int p, const int dim, Eigen::MatrixXd &G) const;
+
+		// utility function that computes energy, the gradient and hessian differentiate the energy wrt F and apply the chain rule
 		template <typename T>
 		T compute_energy_aux(const NonLinearAssemblerData &data) const
 		{
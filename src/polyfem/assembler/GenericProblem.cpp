@@ -5,6 +5,8 @@
 #include <polyfem/utils/StringUtils.hpp>
 #include <polyfem/io/MatrixIO.hpp>
 
+#include <algorithm>
+
 namespace polyfem
 {
 	using namespace utils;
@@ -182,14 +184,11 @@ namespace polyfem
 				return;
 			}
 
-			const bool planar = pts.cols() == 2;
-			for (int i = 0; i < pts.rows(); ++i)
+			Eigen::VectorXd tmp;
+			for (int j = 0; j < pts.cols(); ++j)
 			{
-				for (int j = 0; j < pts.cols(); ++j)
-				{
-					double x = pts(i, 0), y = pts(i, 1), z = planar ? 0 : pts(i, 2);
-					val(i, j) = rhs_[j](x, y, z, t);
-				}
+				rhs_[j](pts, t, tmp);
+				val.col(j) = tmp;
 			}
 		}
 
@@ -285,6 +284,75 @@ namespace polyfem
 			}
 		}
 
+		bool GenericTensorProblem::is_rhs_time_independent() const
+		{
+			return std::none_of(rhs_.begin(), rhs_.end(), [](const utils::ExpressionValue &v) { return v.depends_on_time(); });
+		}
+
+		std::vector<std::pair<int, int>> GenericTensorProblem::neumann_time_parts() const
+		{
+			std::vector<std::pair<int, int>> parts;
+			for (int b = 0; b < forces_.size(); ++b)
+			{
+				if (forces_[b].interpolation.size() <= 1)
+					parts.emplace_back(b, -1);
+				else
+				{
+					for (int d = 0; d < forces_[b].interpolation.size(); ++d)
+						parts.emplace_back(b, d);
+				}
+			}
+			return parts;
+		}
+
+		int GenericTensorProblem::n_neumann_time_parts() const
+		{
+			// the normal aligned loads follow the deformed normals
+			if (!normal_aligned_neumann_boundary_ids_.empty())
+				return -1;
+
+			for (const TensorBCValue &force : forces_)
+			{
+				for (const utils::ExpressionValue &v : force.value)
+				{
+					if (v.depends_on_time())
+						return -1;
+				}
+			}
+
+			return neumann_time_parts().size();
+		}
+
+		void GenericTensorProblem::neumann_bc_part(const int k, const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const
+		{
+			const auto [b, dim] = neumann_time_parts()[k];
+			val = Eigen::MatrixXd::Zero(pts.rows(), mesh.dimension());
+
+			for (long i = 0; i < pts.rows(); ++i)
+			{
+				// as in neumann_bc, the first boundary with the id applies
+				const int id = mesh.get_boundary_id(global_ids(i));
+				if (std::find(neumann_boundary_ids_.begin(), neumann_boundary_ids_.end(), id) - neumann_boundary_ids_.begin() != b)
+					continue;
+
+				const double x = pts(i, 0), y = pts(i, 1), z = pts.cols() == 2 ? 0 : pts(i, 2);
+				for (int d = 0; d < val.cols(); ++d)
+				{
+					if (dim < 0 || d == dim)
+						val(i, d) = forces_[b].value[d](x, y, z, 0);
+				}
+			}
+		}
+
+		double GenericTensorProblem::neumann_time_factor(const int k, const double t) const
+		{
+			const auto [b, dim] = neumann_time_parts()[k];
+			const std::vector<std::shared_ptr<utils::Interpolation>> &interpolation = forces_[b].interpolation;
+			if (interpolation.empty())
+				return 1;
+			return interpolation[std::max(dim, 0)]->eval(t);
+		}
+
 		void GenericTensorProblem::pressure_bc(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &normals, const double t, Eigen::MatrixXd &val) const
 		{
 			val = Eigen::MatrixXd::Zero(pts.rows(), 1);
@@ -314,16 +382,13 @@ namespace polyfem
 		void GenericTensorProblem::exact(const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
 		{
 			assert(has_exact_sol());
-			const bool planar = pts.cols() == 2;
 			val.resize(pts.rows(), pts.cols());
 
-			for (int i = 0; i < pts.rows(); ++i)
+			Eigen::VectorXd tmp;
+			for (int j = 0; j < pts.cols(); ++j)
 			{
-				for (int j = 0; j < pts.cols(); ++j)
-				{
-					double x = pts(i, 0), y = pts(i, 1), z = planar ? 0 : pts(i, 2);
-					val(i, j) = exact_[j](x, y, z, t);
-				}
+				exact_[j](pts, t, tmp);
+				val.col(j) = tmp;
 			}
 		}
 
@@ -1315,12 +1380,9 @@ namespace polyfem
 				val.setZero();
 				return;
 			}
-			const bool planar = pts.cols() == 2;
-			for (int i = 0; i < pts.rows(); ++i)
-			{
-				double x = pts(i, 0), y = pts(i, 1), z = planar ? 0 : pts(i, 2);
-				val(i) = rhs_(x, y, z, t);
-			}
+			Eigen::VectorXd tmp;
+			rhs_(pts, t, tmp);
+			val.col(0) = tmp;
 		}
 
 		void GenericScalarProblem::dirichlet_bc(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
@@ -1369,6 +1431,37 @@ namespace polyfem
 			}
 		}
 
+		int GenericScalarProblem::n_neumann_time_parts() const
+		{
+			for (const ScalarBCValue &neumann : neumann_)
+			{
+				if (neumann.value.depends_on_time())
+					return -1;
+			}
+			return neumann_.size();
+		}
+
+		void GenericScalarProblem::neumann_bc_part(const int k, const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const
+		{
+			val = Eigen::MatrixXd::Zero(pts.rows(), 1);
+
+			for (long i = 0; i < pts.rows(); ++i)
+			{
+				// as in neumann_bc, the first boundary with the id applies
+				const int id = mesh.get_boundary_id(global_ids(i));
+				if (std::find(neumann_boundary_ids_.begin(), neumann_boundary_ids_.end(), id) - neumann_boundary_ids_.begin() != k)
+					continue;
+
+				const double x = pts(i, 0), y = pts(i, 1), z = pts.cols() == 2 ? 0 : pts(i, 2);
+				val(i) = neumann_[k].value(x, y, z, 0);
+			}
+		}
+
+		double GenericScalarProblem::neumann_time_factor(const int k, const double t) const
+		{
+			return neumann_[k].interpolation->eval(t);
+		}
+
 		void GenericScalarProblem::initial_solution(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const
 		{
 			val.resize(pts.rows(), 1);
@@ -1404,14 +1497,9 @@ namespace polyfem
 		void GenericScalarProblem::exact(const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
 		{
 			assert(has_exact_sol());
-			const bool planar = pts.cols() == 2;
-			val.resize(pts.rows(), 1);
-
-			for (int i = 0; i < pts.rows(); ++i)
-			{
-				double x = pts(i, 0), y = pts(i, 1), z = pts.cols() == 2 ? 0 : pts(i, 2);
-				val(i) = exact_(x, y, z, t);
-			}
+			Eigen::VectorXd tmp;
+			exact_(pts, t, tmp);
+			val = tmp;
 		}
 
 		void GenericScalarProblem::exact_grad(const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
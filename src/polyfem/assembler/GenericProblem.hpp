@@ -74,6 +74,11 @@ namespace polyfem
 			bool is_constant_in_time() const override { return !is_time_dept_; }
 			bool might_have_no_dirichlet() override { return !is_all_; }
 
+			bool is_rhs_time_independent() const override;
+			int n_neumann_time_parts() const override;
+			void neumann_bc_part(const int k, const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const override;
+			double neumann_time_factor(const int k, const double t) const override;
+
 			void initial_solution(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const override;
 			void initial_velocity(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const override;
 			void initial_acceleration(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const override;
@@ -125,6 +130,9 @@ namespace polyfem
 			void clear() override;
 
 		private:
+			/// (Neumann boundary, component) of every time part, all the components (-1) share the factor of a single interpolation
+			std::vector<std::pair<int, int>> neumann_time_parts() const;
+
 			bool all_dimensions_dirichlet_ = true;
 			bool has_exact_ = false;
 			bool has_exact_grad_ = false;
@@ -180,6 +188,11 @@ namespace polyfem
 			bool is_constant_in_time() const override { return !is_time_dept_; }
 			bool might_have_no_dirichlet() override { return !is_all_; }
 
+			bool is_rhs_time_independent() const override { return !rhs_.depends_on_time(); }
+			int n_neumann_time_parts() const override;
+			void neumann_bc_part(const int k, const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const override;
+			double neumann_time_factor(const int k, const double t) const override;
+
 			void set_parameters(const json &params) override;
 
 			void exact(const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override;
@@ -29,6 +29,20 @@ namespace polyfem::assembler
 		return Eigen::Matrix<double, 1, 1>::Constant(res);
 	}
 
+	void Helmholtz::assemble_element(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const
+	{
+		const Eigen::MatrixXd grads = p1_gradients(vals);
+
+		Eigen::VectorXd k2_da(da.size());
+		for (int q = 0; q < da.size(); ++q)
+		{
+			const double k = k_(vals.val.row(q), t, vals.element_id);
+			k2_da(q) = k * k * da(q);
+		}
+
+		local = da.sum() * grads * grads.transpose() - weighted_mass(vals, k2_da);
+	}
+
 	VectorNd Helmholtz::compute_rhs(const AutodiffHessianPt &pt) const
 	{
 		Eigen::Matrix<double, 1, 1> result;
@@ -17,6 +17,10 @@ namespace polyfem::assembler
 
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>
 		assemble(const LinearAssemblerData &data) const override;
+
+		/// closed form of the stiffness of the affine P1 simplices, the k² mass term is integrated at once
+		bool has_element_kernel(const ElementAssemblyValues &vals) const override { return is_affine_p1_simplex(vals); }
+		void assemble_element(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const override;
 		VectorNd compute_rhs(const AutodiffHessianPt &pt) const override;
 
 		Eigen::Matrix<AutodiffScalarGrad, Eigen::Dynamic, 1, 0, 3, 1> kernel(const int dim, const AutodiffGradPt &rvect, const AutodiffScalarGrad &r) const override;
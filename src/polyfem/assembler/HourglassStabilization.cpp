@@ -0,0 +1,120 @@
+#include "HourglassStabilization.hpp"
+
+#include <polyfem/assembler/ElementAssemblyValues.hpp>
+#include <polyfem/autogen/auto_q_bases.hpp>
+#include <polyfem/quadrature/HexQuadrature.hpp>
+#include <polyfem/quadrature/QuadQuadrature.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <cmath>
+
+namespace polyfem::assembler
+{
+	bool HourglassStabilization::is_reduced_element(const mesh::Mesh &mesh, const int e, const int discr_order)
+	{
+		return discr_order == 1
+			   && mesh.is_cube(e) && !mesh.is_polytope(e)
+			   && (mesh.orders().size() == 0 || mesh.orders()(e) <= 1);
+	}
+
+	void HourglassStabilization::set_reduced_quadrature(const bool is_volume, const std::vector<int> &elements, std::vector<basis::ElementBases> &bases)
+	{
+		for (const int e : elements)
+		{
+			bases[e].set_quadrature([is_volume](quadrature::Quadrature &quad) {
+				if (is_volume)
+					quadrature::HexQuadrature().get_quadrature(1, quad);
+				else
+					quadrature::QuadQuadrature().get_quadrature(1, quad);
+				assert(quad.weights.size() == 1);
+			});
+			// the element no longer shares the quadrature of its reference element
+			bases[e].reference_key = -1;
+		}
+	}
+
+	void HourglassStabilization::assemble(
+		const bool is_volume,
+		const int n_bases,
+		const std::vector<basis::ElementBases> &bases,
+		const std::vector<basis::ElementBases> &gbases,
+		const std::vector<int> &elements,
+		const Assembler::ParamFunc &mu,
+		const double coefficient,
+		StiffnessMatrix &stiffness)
+	{
+		const int dim = is_volume ? 3 : 2;
+		const int n_nodes = 1 << dim;
+
+		Eigen::MatrixXd nodes;
+		if (is_volume)
+			autogen::q_nodes_3d(1, nodes);
+		else
+			autogen::q_nodes_2d(1, nodes);
+		assert(nodes.rows() == n_nodes);
+
+		// hourglass base vectors, the bilinear (and trilinear) monomials of the reference coordinates at the nodes
+		const Eigen::MatrixXd s = 2 * nodes.array() - 1;
+		Eigen::MatrixXd h(n_nodes, is_volume ? 4 : 1);
+		h.col(0) = s.col(0).cwiseProduct(s.col(1));
+		if (is_volume)
+		{
+			h.col(1) = s.col(1).cwiseProduct(s.col(2));
+			h.col(2) = s.col(0).cwiseProduct(s.col(2));
+			h.col(3) = h.col(0).cwiseProduct(s.col(2));
+		}
+
+		const RowVectorNd center = RowVectorNd::Constant(dim, 0.5);
+
+		auto storage = utils::create_thread_storage(std::vector<Eigen::Triplet<double>>());
+		utils::maybe_parallel_for(elements.size(), [&](int start, int end, int thread_id) {
+			std::vector<Eigen::Triplet<double>> &triplets = utils::get_local_thread_storage(storage, thread_id);
+			ElementAssemblyValues vals;
+			Eigen::MatrixXd x;
+			Eigen::MatrixXd grads(n_nodes, dim);
+
+			for (int k = start; k < end; ++k)
+			{
+				const int e = elements[k];
+				const basis::ElementBases &b = bases[e];
+				assert(b.bases.size() == n_nodes);
+
+				vals.compute(e, is_volume, center, b, gbases[e]);
+				gbases[e].eval_geom_mapping(nodes, x);
+				for (int a = 0; a < n_nodes; ++a)
+					grads.row(a) = vals.basis_values[a].grad_t_m.row(0);
+
+				// γ = h - B (xᵀ h), the linear displacements have no component along γ
+				const Eigen::MatrixXd gamma = h - grads * (x.transpose() * h);
+
+				// the energy of an hourglass mode of unit amplitude is κ μ V |B|², |h|² = 2^dim normalizes γ
+				const double mu_e = mu(center, vals.val.row(0), 0, e);
+				const double scale = coefficient * 2 * mu_e * vals.det(0) * grads.squaredNorm() / (n_nodes * n_nodes);
+				const Eigen::MatrixXd local = scale * gamma * gamma.transpose();
+
+				for (int a = 0; a < n_nodes; ++a)
+				{
+					for (int c = 0; c < n_nodes; ++c)
+					{
+						for (const basis::Local2Global &ga : b.bases[a].global())
+						{
+							for (const basis::Local2Global &gc : b.bases[c].global())
+							{
+								const double value = ga.val * gc.val * local(a, c);
+								for (int d = 0; d < dim; ++d)
+									triplets.emplace_back(ga.index * dim + d, gc.index * dim + d, value);
+							}
+						}
+					}
+				}
+			}
+		});
+
+		std::vector<Eigen::Triplet<double>> triplets;
+		for (const auto &local_triplets : storage)
+			triplets.insert(triplets.end(), local_triplets.begin(), local_triplets.end());
+
+		stiffness.resize(n_bases * dim, n_bases * dim);
+		stiffness.setFromTriplets(triplets.begin(), triplets.end());
+	}
+} // namespace polyfem::assembler
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <polyfem/assembler/Assembler.hpp>
+#include <polyfem/basis/ElementBases.hpp>
+#include <polyfem/mesh/Mesh.hpp>
+#include <polyfem/utils/Types.hpp>
+
+#include <vector>
+
+namespace polyfem::assembler
+{
+	/// @brief One point (reduced) integration of the Q1 elements with Flanagan–Belytschko hourglass control.
+	///
+	/// The one point quadrature of a Q1 quad or hex does not see its hourglass modes (the bilinear and trilinear
+	/// displacements with zero strain at the center), they are stabilized by a stiffness on the displacement
+	/// components along the hourglass vectors γ = h - B (xᵀ h), orthogonal to the linear displacements.
+	/// The stiffness is scaled by the shear modulus only, so it does not lock for nearly incompressible materials.
+	class HourglassStabilization
+	{
+	public:
+		HourglassStabilization() = delete;
+
+		/// @brief Can the element be integrated with one point: a Q1 quad or hex with an affine or trilinear geometric mapping
+		/// @param mesh mesh
+		/// @param e element id
+		/// @param discr_order discretization order of the element
+		static bool is_reduced_element(const mesh::Mesh &mesh, const int e, const int discr_order);
+
+		/// @brief Sets the one point quadrature of the stiffness of the reduced elements, the mass keeps its quadrature
+		/// @param[in] elements ids of the reduced elements
+		/// @param[in, out] bases bases of the elements
+		static void set_reduced_quadrature(const bool is_volume, const std::vector<int> &elements, std::vector<basis::ElementBases> &bases);
+
+		/// @brief Assembles the hourglass stiffness of the reduced elements
+		/// @param[in] is_volume True if the mesh is volumetric
+		/// @param[in] n_bases number of bases
+		/// @param[in] bases bases of the elements
+		/// @param[in] gbases geometric bases of the elements
+		/// @param[in] elements ids of the reduced elements
+		/// @param[in] mu shear modulus of the material
+		/// @param[in] coefficient hourglass coefficient κ, a few percent of the shear stiffness
+		/// @param[out] stiffness (n_bases·dim)² hourglass stiffness
+		static void assemble(
+			const bool is_volume,
+			const int n_bases,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const std::vector<int> &elements,
+			const Assembler::ParamFunc &mu,
+			const double coefficient,
+			StiffnessMatrix &stiffness);
+	};
+} // namespace polyfem::assembler
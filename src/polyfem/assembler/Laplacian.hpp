@@ -21,6 +21,10 @@ namespace polyfem
 			/// ie integral of grad(phi_i) dot grad(phi_j)
 			Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1> assemble(const LinearAssemblerData &data) const override;
 
+			/// closed form of the local matrix of the affine P1 simplices, |T| ∇φᵢ·∇φⱼ
+			bool has_element_kernel(const ElementAssemblyValues &vals) const override { return is_affine_p1_simplex(vals); }
+			void assemble_element(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const override;
+
 			/// uses autodiff to compute the rhs for a fabricated solution
 			/// in this case it just return pt.getHessian().trace()
 			/// pt is the evaluation of the solution at a point
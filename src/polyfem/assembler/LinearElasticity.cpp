@@ -62,6 +62,34 @@ namespace polyfem
 			return res;
 		}
 
+		void LinearElasticity::assemble_element(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const
+		{
+			// the gradients are constant, only the Lamé parameters are integrated
+			const Eigen::MatrixXd grads = p1_gradients(vals);
+			double int_lambda = 0, int_mu = 0;
+			for (int q = 0; q < da.size(); ++q)
+			{
+				double lambda, mu;
+				params_.lambda_mu(vals.quadrature.points.row(q), vals.val.row(q), t, vals.element_id, lambda, mu);
+				int_lambda += lambda * da(q);
+				int_mu += mu * da(q);
+			}
+
+			// block (i, j) is λ ∇φᵢ ∇φⱼᵀ + μ ∇φⱼ ∇φᵢᵀ + μ (∇φᵢ·∇φⱼ) Id
+			const int n_loc_bases = grads.rows();
+			const Eigen::MatrixXd dots = grads * grads.transpose();
+			local.resize(n_loc_bases * size(), n_loc_bases * size());
+			for (int i = 0; i < n_loc_bases; ++i)
+			{
+				for (int j = 0; j < n_loc_bases; ++j)
+				{
+					auto block = local.block(i * size(), j * size(), size(), size());
+					block = int_lambda * grads.row(i).transpose() * grads.row(j) + int_mu * grads.row(j).transpose() * grads.row(i);
+					block.diagonal().array() += int_mu * dots(i, j);
+				}
+			}
+		}
+
 		double LinearElasticity::compute_energy(const NonLinearAssemblerData &data) const
 		{
 			return compute_energy_aux<double>(data);
@@ -69,37 +97,18 @@ namespace polyfem
 
 		Eigen::VectorXd LinearElasticity::assemble_gradient(const NonLinearAssemblerData &data) const
 		{
-			const int n_bases = data.vals.basis_values.size();
-			return polyfem::gradient_from_energy(
-				size(), n_bases, data,
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 6, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 8, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 12, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 18, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 24, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 30, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 60, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 81, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, BIG_N, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::VectorXd>>(data); });
+			return assemble_gradient_from_stress(data);
 		}
 
 		Eigen::MatrixXd LinearElasticity::assemble_hessian(const NonLinearAssemblerData &data) const
 		{
-			const int n_bases = data.vals.basis_values.size();
-			return polyfem::hessian_from_energy(
-				size(), n_bases, data,
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(data); });
+			return assemble_hessian_from_stress_grad(data);
+		}
+
+		bool LinearElasticity::assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const
+		{
+			hessian = assemble_hessian_from_stress_grad(data, true);
+			return true;
 		}
 
 		// Compute \int mu eps : eps + lambda/2 tr(eps)^2 = \int mu tr(eps^2) + lambda/2 tr(eps)^2
@@ -133,6 +142,80 @@ namespace polyfem
 			return energy;
 		}
 
+		void LinearElasticity::compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const
+		{
+			const int dim = data.dim;
+			const Eigen::ArrayXXd &F = data.def_grad;
+
+			Eigen::ArrayXd lambda, mu;
+			params_.lambda_mu(data.local_pts, data.global_pts, data.t, data.el_ids, lambda, mu);
+
+			// ε = ½(∇u + ∇uᵀ) with ∇u = F - Id
+			Eigen::ArrayXd trace_strain = Eigen::ArrayXd::Zero(F.rows());
+			Eigen::ArrayXd strain_dot_strain = Eigen::ArrayXd::Zero(F.rows());
+			for (int i = 0; i < dim; ++i)
+			{
+				trace_strain += F.col(i * dim + i) - 1;
+				for (int j = 0; j < dim; ++j)
+				{
+					const double delta_ij = i == j ? 1 : 0;
+					const Eigen::ArrayXd strain_ij = (F.col(i * dim + j) + F.col(j * dim + i)) / 2 - delta_ij;
+					strain_dot_strain += strain_ij.square();
+				}
+			}
+
+			psi = mu * strain_dot_strain + lambda / 2 * trace_strain.square();
+		}
+
+		// σ = 2μ ε + λ tr(ε) Id
+		void LinearElasticity::compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const
+		{
+			const int dim = data.dim;
+			const Eigen::ArrayXXd &F = data.def_grad;
+
+			Eigen::ArrayXd lambda, mu;
+			params_.lambda_mu(data.local_pts, data.global_pts, data.t, data.el_ids, lambda, mu);
+
+			Eigen::ArrayXd trace_strain = Eigen::ArrayXd::Zero(F.rows());
+			for (int i = 0; i < dim; ++i)
+				trace_strain += F.col(i * dim + i) - 1;
+
+			stress.resize(F.rows(), F.cols());
+			for (int i = 0; i < dim; ++i)
+			{
+				for (int j = 0; j < dim; ++j)
+				{
+					const double delta_ij = i == j ? 1 : 0;
+					stress.col(i * dim + j) = mu * (F.col(i * dim + j) + F.col(j * dim + i) - 2 * delta_ij);
+					if (i == j)
+						stress.col(i * dim + j) += lambda * trace_strain;
+				}
+			}
+		}
+
+		// ∂σ(i, j)/∂F(k, l) = μ (δᵢₖ δⱼₗ + δᵢₗ δⱼₖ) + λ δᵢⱼ δₖₗ
+		void LinearElasticity::compute_stress_grad_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress_grad) const
+		{
+			const int dim = data.dim;
+			const int dim2 = dim * dim;
+
+			Eigen::ArrayXd lambda, mu;
+			params_.lambda_mu(data.local_pts, data.global_pts, data.t, data.el_ids, lambda, mu);
+
+			stress_grad.setZero(data.size(), dim2 * dim2);
+			for (int i = 0; i < dim; ++i)
+			{
+				for (int j = 0; j < dim; ++j)
+				{
+					stress_grad.col((i * dim + j) * dim2 + i * dim + j) += mu;
+					stress_grad.col((i * dim + j) * dim2 + j * dim + i) += mu;
+				}
+
+				for (int k = 0; k < dim; ++k)
+					stress_grad.col((i * dim + i) * dim2 + k * dim + k) += lambda;
+			}
+		}
+
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1>
 		LinearElasticity::compute_rhs(const AutodiffHessianPt &pt) const
 		{
@@ -22,13 +22,24 @@ namespace polyfem::assembler
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>
 		assemble(const LinearAssemblerData &data) const override;
 
+		/// closed form of the local matrix of the affine P1 simplices, the Lamé parameters are averaged on the element
+		bool has_element_kernel(const ElementAssemblyValues &vals) const override { return is_affine_p1_simplex(vals); }
+		void assemble_element(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const override;
+
 		// compute elastic energy
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		// neccessary for mixing linear model with non-linear collision response
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
+		bool assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const override;
 		// compute gradient of elastic energy, as assembler
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 
+		// batched energy density, stress and stress derivative, vectorized across the points of several elements
+		bool has_batch_kernels() const override { return true; }
+		void compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const override;
+		void compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const override;
+		void compute_stress_grad_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress_grad) const override;
+
 		// kernel of the pde, used in kernel problem
 		Eigen::Matrix<AutodiffScalarGrad, Eigen::Dynamic, 1, 0, 3, 1> kernel(const int dim, const AutodiffGradPt &r, const AutodiffScalarGrad &) const override;
 
@@ -22,6 +22,22 @@ namespace polyfem::assembler
 		return res;
 	}
 
+	void Mass::assemble_element(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const
+	{
+		Eigen::VectorXd rho_da(da.size());
+		for (int q = 0; q < da.size(); ++q)
+			rho_da(q) = density_(vals.quadrature.points.row(q), vals.val.row(q), t, vals.element_id) * da(q);
+
+		const Eigen::MatrixXd scalar = weighted_mass(vals, rho_da);
+
+		const int n_loc_bases = scalar.rows();
+		local.setZero(n_loc_bases * size(), n_loc_bases * size());
+		for (int i = 0; i < n_loc_bases; ++i)
+			for (int j = 0; j < n_loc_bases; ++j)
+				for (int d = 0; d < size(); ++d)
+					local(i * size() + d, j * size() + d) = scalar(i, j);
+	}
+
 	Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> Mass::compute_rhs(const AutodiffHessianPt &pt) const
 	{
 		assert(false);
@@ -17,6 +17,10 @@ namespace polyfem::assembler
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>
 		assemble(const LinearAssemblerData &data) const override;
 
+		/// local matrix of the affine P1 simplices at once, ρ|T|/((d+1)(d+2)) (1 + δᵢⱼ) for a constant density
+		bool has_element_kernel(const ElementAssemblyValues &vals) const override { return is_affine_p1_simplex(vals); }
+		void assemble_element(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const override;
+
 		/// uses autodiff to compute the rhs for a fabricated solution
 		/// in this case it just return pt.getHessian().trace()
 		/// pt is the evaluation of the solution at a point
@@ -164,6 +164,83 @@ namespace polyfem
 			mass.makeCompressed();
 		}
 
+		void MassMatrixAssembler::assemble_lumped(
+			const bool is_volume,
+			const int size,
+			const int n_basis,
+			const Density &density,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			const Lumping lumping,
+			Eigen::VectorXd &lumped) const
+		{
+			struct LocalThreadVecStorage
+			{
+				Eigen::VectorXd lumped;
+				ElementAssemblyValues vals;
+				Eigen::MatrixXd local_mass;
+			};
+
+			LocalThreadVecStorage initial;
+			initial.lumped.setZero(n_basis);
+			auto storage = create_thread_storage(initial);
+
+			maybe_parallel_for(int(bases.size()), [&](int start, int end, int thread_id) {
+				LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+				for (int e = start; e < end; ++e)
+				{
+					ElementAssemblyValues &vals = local_storage.vals;
+					bases[e].compute_mass_quadrature(vals.quadrature);
+					vals.compute(e, is_volume, vals.quadrature.points, bases[e], gbases[e]);
+
+					const int n_loc_bases = int(vals.basis_values.size());
+					Eigen::VectorXd rho_da(vals.quadrature.weights.size());
+					for (int q = 0; q < rho_da.size(); ++q)
+						rho_da(q) = density(vals.quadrature.points.row(q), vals.val.row(q), 0, vals.element_id) * vals.det(q) * vals.quadrature.weights(q);
+
+					Eigen::MatrixXd &local_mass = local_storage.local_mass;
+					local_mass.resize(n_loc_bases, n_loc_bases);
+					for (int i = 0; i < n_loc_bases; ++i)
+						for (int j = 0; j <= i; ++j)
+							local_mass(i, j) = local_mass(j, i) = (vals.basis_values[i].val.array() * vals.basis_values[j].val.array() * rho_da.array()).sum();
+
+					// total weight of the global nodes of each local basis
+					Eigen::VectorXd global_weights(n_loc_bases);
+					for (int i = 0; i < n_loc_bases; ++i)
+					{
+						global_weights(i) = 0;
+						for (const auto &g : vals.basis_values[i].global)
+							global_weights(i) += g.val;
+					}
+
+					Eigen::VectorXd local_lumped;
+					if (lumping == Lumping::RowSum)
+					{
+						local_lumped = local_mass * global_weights;
+					}
+					else
+					{
+						const double element_mass = global_weights.dot(local_mass * global_weights);
+						local_lumped = local_mass.diagonal() * (element_mass / global_weights.dot(local_mass.diagonal()));
+					}
+
+					for (int i = 0; i < n_loc_bases; ++i)
+						for (const auto &g : vals.basis_values[i].global)
+							local_storage.lumped(g.index) += g.val * local_lumped(i);
+				}
+			});
+
+			Eigen::VectorXd scalar_lumped = Eigen::VectorXd::Zero(n_basis);
+			for (const LocalThreadVecStorage &local_storage : storage)
+				scalar_lumped += local_storage.lumped;
+
+			// the mass matrix is the same for every component
+			lumped.resize(n_basis * size);
+			for (int i = 0; i < n_basis; ++i)
+				lumped.segment(i * size, size).setConstant(scalar_lumped(i));
+		}
+
 		namespace
 		{
 			// TODO: use existing PolyFEM code instead of hard coding these gmappings
@@ -195,118 +272,157 @@ namespace polyfem
 			const AssemblyValsCache &cache,
 			StiffnessMatrix &mass) const
 		{
-			const int buffer_size = std::min(long(1e8), long(std::max(n_from_basis, n_to_basis)) * size);
-			// logger().debug("buffer_size {}", buffer_size);
-
 			mass.resize(n_to_basis * size, n_from_basis * size);
 			mass.setZero();
 
-			// auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, mass.rows()));
-
-			Quadrature quadrature;
-			if (is_volume)
-				TetQuadrature().get_quadrature(2, quadrature);
-			else
-				TriQuadrature().get_quadrature(2, quadrature);
+			// vertices of the affine simplices, the vertex nodes come first
+			const auto simplex_vertices = [&](const ElementBases &gbs) -> Eigen::MatrixXd {
+				return gbs.nodes().topRows(size + 1);
+			};
+			const auto element_order = [](const ElementBases &bs) {
+				int order = 0;
+				for (const Basis &b : bs.bases)
+					order = std::max(order, b.order());
+				return order;
+			};
 
 			// Use a AABB tree to find all intersecting elements then loop over only those pairs
+			std::vector<Eigen::MatrixXd> from_nodes(from_bases.size());
 			std::vector<std::array<Eigen::Vector3d, 2>> boxes(from_bases.size());
-			for (int i = 0; i < from_bases.size(); i++)
-			{
-				const Eigen::MatrixXd from_nodes = from_bases[i].nodes();
-				boxes[i][0].setZero();
-				boxes[i][0].head(size) = from_nodes.colwise().minCoeff();
-				boxes[i][1].setZero();
-				boxes[i][1].head(size) = from_nodes.colwise().maxCoeff();
-			}
+			maybe_parallel_for(int(from_bases.size()), [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; i++)
+				{
+					from_nodes[i] = simplex_vertices(from_gbases[i]);
+					boxes[i][0].setZero();
+					boxes[i][0].head(size) = from_nodes[i].colwise().minCoeff();
+					boxes[i][1].setZero();
+					boxes[i][1].head(size) = from_nodes[i].colwise().maxCoeff();
+				}
+			});
 
 			SimpleBVH::BVH bvh;
 			bvh.init(boxes);
 
-			// maybe_parallel_for(n_to_basis, [&](int start, int end, int thread_id) {
-			// LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			auto storage = create_thread_storage(std::vector<Eigen::Triplet<double>>());
 
-			std::vector<Eigen::Triplet<double>> triplets;
-
-			for (const ElementBases &to_element : to_bases)
-			{
-				const Eigen::MatrixXd to_nodes = to_element.nodes();
+			maybe_parallel_for(int(to_bases.size()), [&](int start, int end, int thread_id) {
+				std::vector<Eigen::Triplet<double>> &triplets = get_local_thread_storage(storage, thread_id);
 
 				std::vector<unsigned int> candidates;
-				{
-					Eigen::Vector3d bbox_min = Eigen::Vector3d::Zero();
-					bbox_min.head(size) = to_nodes.colwise().minCoeff();
-					Eigen::Vector3d bbox_max = Eigen::Vector3d::Zero();
-					bbox_max.head(size) = to_nodes.colwise().maxCoeff();
-					bvh.intersect_box(bbox_min, bbox_max, candidates);
-				}
+				std::vector<AssemblyValues> from_phi, to_phi;
+				std::vector<Quadrature> quadratures; // by order
+				Eigen::MatrixXd points, from_uv, to_uv, local_mass;
+				Eigen::VectorXd weights;
 
-				// for (const ElementBases &from_element : from_bases)
-				for (const unsigned int from_element_i : candidates)
+				for (int to_element_i = start; to_element_i < end; ++to_element_i)
 				{
-					const ElementBases &from_element = from_bases[from_element_i];
-					const Eigen::MatrixXd from_nodes = from_element.nodes();
+					const ElementBases &to_element = to_bases[to_element_i];
+					const Eigen::MatrixXd to_nodes = simplex_vertices(to_gbases[to_element_i]);
+					const int to_order = element_order(to_element);
 
-					// Compute the overlap between the two elements as a list of simplices.
-					const std::vector<Eigen::MatrixXd> overlap =
-						is_volume
-							? TetrahedronClipping::clip(to_nodes, from_nodes)
-							: TriangleClipping::clip(to_nodes, from_nodes);
+					{
+						Eigen::Vector3d bbox_min = Eigen::Vector3d::Zero();
+						bbox_min.head(size) = to_nodes.colwise().minCoeff();
+						Eigen::Vector3d bbox_max = Eigen::Vector3d::Zero();
+						bbox_max.head(size) = to_nodes.colwise().maxCoeff();
+						candidates.clear();
+						bvh.intersect_box(bbox_min, bbox_max, candidates);
+					}
 
-					for (const Eigen::MatrixXd &simplex : overlap)
+					for (const unsigned int from_element_i : candidates)
 					{
-						const double volume = abs(is_volume ? tetrahedron_volume(simplex) : triangle_area(simplex));
-						if (abs(volume) == 0.0)
+						const ElementBases &from_element = from_bases[from_element_i];
+
+						// Compute the overlap between the two elements as a list of simplices.
+						const std::vector<Eigen::MatrixXd> overlap =
+							is_volume
+								? TetrahedronClipping::clip(to_nodes, from_nodes[from_element_i])
+								: TriangleClipping::clip(to_nodes, from_nodes[from_element_i]);
+						if (overlap.empty())
 							continue;
-						assert(volume > 0);
 
-						for (int qi = 0; qi < quadrature.size(); qi++)
+						// exact for the product of the bases
+						const int order = to_order + element_order(from_element);
+						if (quadratures.size() <= order)
+							quadratures.resize(order + 1);
+						Quadrature &quadrature = quadratures[order];
+						if (quadrature.weights.size() == 0)
+						{
+							if (is_volume)
+								TetQuadrature().get_quadrature(order, quadrature);
+							else
+								TriQuadrature().get_quadrature(order, quadrature);
+						}
+
+						// quadrature points of all the simplices of the overlap
+						const int n_qp = quadrature.size();
+						points.resize(overlap.size() * n_qp, size);
+						weights.resize(overlap.size() * n_qp);
+						for (int s = 0; s < overlap.size(); ++s)
 						{
-							// NOTE: the 2/6 is neccesary here because the mass matrix assembly use the
-							//       determinant of the Jacobian (i.e., area of the parallelogram/volume of the hexahedron)
-							const double w = (is_volume ? 6 : 2) * volume * quadrature.weights[qi];
-							const VectorNd q = quadrature.points.row(qi);
+							const Eigen::MatrixXd &simplex = overlap[s];
+							const double volume = abs(is_volume ? tetrahedron_volume(simplex) : triangle_area(simplex));
 
-							const VectorNd p = is_volume ? P1_3D_gmapping(simplex, q) : P1_2D_gmapping(simplex, q);
+							for (int qi = 0; qi < n_qp; qi++)
+							{
+								// NOTE: the 2/6 is neccesary here because the mass matrix assembly use the
+								//       determinant of the Jacobian (i.e., area of the parallelogram/volume of the hexahedron)
+								weights(s * n_qp + qi) = (is_volume ? 6 : 2) * volume * quadrature.weights[qi];
+								const VectorNd q = quadrature.points.row(qi);
+								points.row(s * n_qp + qi) = is_volume ? P1_3D_gmapping(simplex, q) : P1_2D_gmapping(simplex, q);
+							}
+						}
+						if (weights.sum() == 0.0)
+							continue;
 
-							// NOTE: Row vector because evaluate_bases expects a rows of a matrix.
-							const RowVectorNd from_bc = barycentric_coordinates(p, from_nodes).tail(size).transpose();
-							const RowVectorNd to_bc = barycentric_coordinates(p, to_nodes).tail(size).transpose();
+						from_uv.resize(points.rows(), size);
+						to_uv.resize(points.rows(), size);
+						for (int q = 0; q < points.rows(); ++q)
+						{
+							from_uv.row(q) = barycentric_coordinates(points.row(q).transpose(), from_nodes[from_element_i]).tail(size).transpose();
+							to_uv.row(q) = barycentric_coordinates(points.row(q).transpose(), to_nodes).tail(size).transpose();
+						}
 
-							std::vector<AssemblyValues> from_phi, to_phi;
-							from_element.evaluate_bases(from_bc, from_phi);
-							to_element.evaluate_bases(to_bc, to_phi);
+						from_element.evaluate_bases(from_uv, from_phi);
+						to_element.evaluate_bases(to_uv, to_phi);
 
 #ifndef NDEBUG
-							Eigen::MatrixXd debug;
-							from_element.eval_geom_mapping(from_bc, debug);
-							assert((debug.transpose() - p).norm() < 1e-12);
-							to_element.eval_geom_mapping(to_bc, debug);
-							assert((debug.transpose() - p).norm() < 1e-12);
+						Eigen::MatrixXd debug;
+						from_element.eval_geom_mapping(from_uv, debug);
+						assert((debug - points).norm() < 1e-10);
+						to_element.eval_geom_mapping(to_uv, debug);
+						assert((debug - points).norm() < 1e-10);
 #endif
 
-							for (int n = 0; n < size; ++n)
+						local_mass.resize(to_phi.size(), from_phi.size());
+						for (int to_local_i = 0; to_local_i < to_phi.size(); ++to_local_i)
+							for (int from_local_i = 0; from_local_i < from_phi.size(); ++from_local_i)
+								local_mass(to_local_i, from_local_i) = (weights.array() * to_phi[to_local_i].val.array() * from_phi[from_local_i].val.array()).sum();
+
+						for (int to_local_i = 0; to_local_i < to_phi.size(); ++to_local_i)
+						{
+							for (const auto &to_global : to_element.bases[to_local_i].global())
 							{
-								// local matrix is diagonal
-								const int m = n;
+								for (int from_local_i = 0; from_local_i < from_phi.size(); ++from_local_i)
 								{
-									for (int to_local_i = 0; to_local_i < to_phi.size(); ++to_local_i)
+									for (const auto &from_global : from_element.bases[from_local_i].global())
 									{
-										const int to_global_i = to_element.bases[to_local_i].global()[0].index * size + m;
-										for (int from_local_i = 0; from_local_i < from_phi.size(); ++from_local_i)
-										{
-											const auto from_global_i = from_element.bases[from_local_i].global()[0].index * size + n;
-											triplets.emplace_back(
-												to_global_i, from_global_i,
-												w * from_phi[from_local_i].val(0) * to_phi[to_local_i].val(0));
-										}
+										const double value = to_global.val * from_global.val * local_mass(to_local_i, from_local_i);
+										// local matrix is diagonal
+										for (int n = 0; n < size; ++n)
+											triplets.emplace_back(to_global.index * size + n, from_global.index * size + n, value);
 									}
 								}
 							}
 						}
 					}
 				}
-			}
+			});
+
+			// Serially merge local storages
+			std::vector<Eigen::Triplet<double>> triplets;
+			for (const std::vector<Eigen::Triplet<double>> &local_triplets : storage)
+				triplets.insert(triplets.end(), local_triplets.begin(), local_triplets.end());
 
 			mass.setFromTriplets(triplets.begin(), triplets.end());
 			mass.makeCompressed();
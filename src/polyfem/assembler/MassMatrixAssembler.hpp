@@ -16,6 +16,13 @@ namespace polyfem::assembler
 	class MassMatrixAssembler
 	{
 	public:
+		/// diagonal approximation of the mass matrix
+		enum class Lumping
+		{
+			RowSum, ///< sum of the entries of each row
+			HRZ     ///< diagonal of each element scaled to preserve its mass (Hinton-Rock-Zienkiewicz), always positive
+		};
+
 		/// @brief Assembles the mass matrix.
 		/// @param[in]  is_volume True if the mesh is volumetric.
 		/// @param[in]  size      Size of the problem (e.g., 1 for Laplace).
@@ -35,6 +42,25 @@ namespace polyfem::assembler
 			const AssemblyValsCache &cache,
 			StiffnessMatrix &mass) const;
 
+		/// @brief Assembles the diagonal of a lumped mass matrix, element by element.
+		/// @param[in]  is_volume True if the mesh is volumetric.
+		/// @param[in]  size      Size of the problem (e.g., 1 for Laplace).
+		/// @param[in]  n_basis   Number of basis functions (bases and geometric bases).
+		/// @param[in]  density   Class that can evaluate per point density.
+		/// @param[in]  bases     Finite element bases.
+		/// @param[in]  gbases    Geometric bases.
+		/// @param[in]  lumping   Lumping scheme.
+		/// @param[out] lumped    Output diagonal of the lumped mass matrix.
+		void assemble_lumped(
+			const bool is_volume,
+			const int size,
+			const int n_basis,
+			const Density &density,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const Lumping lumping,
+			Eigen::VectorXd &lumped) const;
+
 		/// @brief Assembles the cross mass matrix between to function spaces.
 		/// @param[in]  is_volume    True if the mesh is volumetric.
 		/// @param[in]  size         Size of the problem (e.g., 1 for Laplace).
@@ -2,6 +2,9 @@
 
 #include <polyfem/utils/JSONUtils.hpp>
 
+#include <algorithm>
+#include <limits>
+
 namespace polyfem::assembler
 {
 	namespace
@@ -18,6 +21,26 @@ namespace polyfem::assembler
 		{
 			return E / (2.0 * (1.0 + nu));
 		}
+
+		/// grows the resolved constants to size, new materials are marked as varying
+		void resize_constants(Eigen::ArrayXd &constants, const int size)
+		{
+			const int old_size = constants.size();
+			if (size <= old_size)
+				return;
+
+			constants.conservativeResize(size);
+			constants.tail(size - old_size).setConstant(std::numeric_limits<double>::quiet_NaN());
+		}
+
+		/// value of a parameter which is the same everywhere and at all times, NaN otherwise
+		double constant_value(const utils::ExpressionValue &param, const int index)
+		{
+			if (!param.is_constant())
+				return std::numeric_limits<double>::quiet_NaN();
+
+			return param(0, 0, 0, 0, index);
+		}
 	} // namespace
 
 	GenericMatParam::GenericMatParam(const std::string &param_name)
@@ -32,10 +55,13 @@ namespace polyfem::assembler
 			param_.emplace_back();
 		}
 
+		resize_constants(constant_, param_.size());
+
 		if (params.count(param_name_))
 		{
 			param_[index].init(params[param_name_]);
 			param_[index].set_unit_type(unit_type);
+			constant_(index) = constant_value(param_[index], index);
 		}
 	}
 
@@ -52,9 +78,11 @@ namespace polyfem::assembler
 	{
 		assert(param_.size() == 1 || index < param_.size());
 
-		const auto &tmp_param = param_.size() == 1 ? param_[0] : param_[index];
+		const int material = param_.size() == 1 ? 0 : index;
+		if (material < constant_.size() && !std::isnan(constant_(material)))
+			return constant_(material);
 
-		return tmp_param(x, y, z, t, index);
+		return param_[material](x, y, z, t, index);
 	}
 
 	GenericMatParams::GenericMatParams(const std::string &param_name)
@@ -83,6 +111,9 @@ namespace polyfem::assembler
 
 			params_.at(i).param_[index].init(params_array[i]);
 			params_.at(i).param_[index].set_unit_type(unit_type);
+
+			resize_constants(params_.at(i).constant_, params_.at(i).param_.size());
+			params_.at(i).constant_(index) = constant_value(params_.at(i).param_[index], index);
 		}
 	}
 
@@ -308,6 +339,8 @@ namespace polyfem::assembler
 
 		mu_or_nu_.emplace_back();
 		mu_or_nu_.back().init(1.0);
+		resize_constants(constant_lambda_or_E_, 1);
+		resize_constants(constant_mu_or_nu_, 1);
 		size_ = -1;
 		is_lambda_mu_ = true;
 	}
@@ -318,11 +351,15 @@ namespace polyfem::assembler
 		assert(mu_or_nu_.size() == 1 || el_id < mu_or_nu_.size());
 		assert(size_ == 2 || size_ == 3);
 
-		const auto &tmp1 = lambda_or_E_.size() == 1 ? lambda_or_E_[0] : lambda_or_E_[el_id];
-		const auto &tmp2 = mu_or_nu_.size() == 1 ? mu_or_nu_[0] : mu_or_nu_[el_id];
+		const int material = lambda_or_E_.size() == 1 ? 0 : el_id;
 
-		double llambda = tmp1(x, y, z, t, el_id);
-		double mmu = tmp2(x, y, z, t, el_id);
+		double llambda = constant_lambda_or_E_(material);
+		double mmu = constant_mu_or_nu_(material);
+		if (std::isnan(llambda) || std::isnan(mmu))
+		{
+			llambda = lambda_or_E_[material](x, y, z, t, el_id);
+			mmu = mu_or_nu_[material](x, y, z, t, el_id);
+		}
 
 		if (!is_lambda_mu_)
 		{
@@ -347,6 +384,17 @@ namespace polyfem::assembler
 		assert(!std::isinf(mu));
 	}
 
+	void LameParameters::lambda_mu(const Eigen::MatrixXd &param, const Eigen::MatrixXd &p, double t, const Eigen::VectorXi &el_ids, Eigen::ArrayXd &lambda, Eigen::ArrayXd &mu) const
+	{
+		assert(param.rows() == p.rows());
+		assert(param.rows() == el_ids.size());
+
+		lambda.resize(p.rows());
+		mu.resize(p.rows());
+		for (int i = 0; i < p.rows(); ++i)
+			lambda_mu(param.row(i), p.row(i), t, el_ids(i), lambda(i), mu(i));
+	}
+
 	void LameParameters::add_multimaterial(const int index, const json &params, const bool is_volume, const std::string &stress_unit)
 	{
 		const int size = is_volume ? 3 : 2;
@@ -358,6 +406,8 @@ namespace polyfem::assembler
 			lambda_or_E_.emplace_back();
 			mu_or_nu_.emplace_back();
 		}
+		resize_constants(constant_lambda_or_E_, lambda_or_E_.size());
+		resize_constants(constant_mu_or_nu_, mu_or_nu_.size());
 
 		if (params.count("young"))
 		{
@@ -376,6 +426,11 @@ namespace polyfem::assembler
 			mu_or_nu_[index].set_unit_type(stress_unit);
 			is_lambda_mu_ = true;
 		}
+		else
+			return;
+
+		constant_lambda_or_E_(index) = constant_value(lambda_or_E_[index], index);
+		constant_mu_or_nu_(index) = constant_value(mu_or_nu_[index], index);
 	}
 
 	void LameParameters::set_e_nu(const int index, const json &E, const json &nu, const std::string &stress_unit)
@@ -394,19 +449,25 @@ namespace polyfem::assembler
 	{
 		rho_.emplace_back();
 		rho_.back().init(1.0);
+		resize_constants(constant_rho_, 1);
 	}
 
 	double Density::operator()(double px, double py, double pz, double x, double y, double z, double t, int el_id) const
 	{
 		assert(rho_.size() == 1 || el_id < rho_.size());
 
-		const auto &tmp = rho_.size() == 1 ? rho_[0] : rho_[el_id];
-		const double res = tmp(x, y, z, t, el_id);
+		const int material = rho_.size() == 1 ? 0 : el_id;
+		const double res = std::isnan(constant_rho_(material)) ? rho_[material](x, y, z, t, el_id) : constant_rho_(material);
 		assert(!std::isnan(res));
 		assert(!std::isinf(res));
 		return res;
 	}
 
+	bool Density::depends_on_time() const
+	{
+		return std::any_of(rho_.begin(), rho_.end(), [](const utils::ExpressionValue &rho) { return rho.depends_on_time(); });
+	}
+
 	void Density::add_multimaterial(const int index, const json &params, const std::string &density_unit)
 	{
 		for (int i = rho_.size(); i <= index; ++i)
@@ -424,6 +485,8 @@ namespace polyfem::assembler
 		}
 
 		rho_[index].set_unit_type(density_unit);
+		resize_constants(constant_rho_, rho_.size());
+		constant_rho_(index) = constant_value(rho_[index], index);
 	}
 
 	// template instantiation
@@ -19,6 +19,8 @@ namespace polyfem::assembler
 	private:
 		const std::string param_name_;
 		std::vector<utils::ExpressionValue> param_;
+		/// value of every constant material resolved at set time, NaN if it varies
+		Eigen::ArrayXd constant_;
 
 		friend class GenericMatParams;
 	};
@@ -82,6 +84,8 @@ namespace polyfem::assembler
 				t,
 				el_id, lambda, mu);
 		}
+		/// evaluates the parameters at a batch of points (one per row of param and p)
+		void lambda_mu(const Eigen::MatrixXd &param, const Eigen::MatrixXd &p, double t, const Eigen::VectorXi &el_ids, Eigen::ArrayXd &lambda, Eigen::ArrayXd &mu) const;
 
 		Eigen::MatrixXd lambda_mat_, mu_mat_;
 
@@ -90,6 +94,8 @@ namespace polyfem::assembler
 
 		int size_;
 		std::vector<utils::ExpressionValue> lambda_or_E_, mu_or_nu_;
+		/// parameters of every constant material resolved at set time, NaN if they vary
+		Eigen::ArrayXd constant_lambda_or_E_, constant_mu_or_nu_;
 		bool is_lambda_mu_;
 	};
 
@@ -111,10 +117,15 @@ namespace polyfem::assembler
 						   t, el_id);
 		}
 
+		/// true if the density of some material might change in time
+		bool depends_on_time() const;
+
 	private:
 		void set_rho(const json &rho);
 
 		std::vector<utils::ExpressionValue> rho_;
+		/// density of every constant material resolved at set time, NaN if it varies
+		Eigen::ArrayXd constant_rho_;
 	};
 
 	class NoDensity : public Density
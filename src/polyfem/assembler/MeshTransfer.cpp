@@ -0,0 +1,54 @@
+#include "MeshTransfer.hpp"
+
+#include <polyfem/assembler/AssemblyValsCache.hpp>
+#include <polyfem/assembler/MassMatrixAssembler.hpp>
+#include <polyfem/assembler/MatParams.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+namespace polyfem::assembler
+{
+	MeshTransfer::MeshTransfer(
+		const bool is_volume,
+		const int size,
+		const int n_from_basis,
+		const std::vector<basis::ElementBases> &from_bases,
+		const std::vector<basis::ElementBases> &from_gbases,
+		const int n_to_basis,
+		const std::vector<basis::ElementBases> &to_bases,
+		const std::vector<basis::ElementBases> &to_gbases)
+	{
+		MassMatrixAssembler assembler;
+		NoDensity no_density; // Density of one (i.e., no scaling of mass matrix)
+		AssemblyValsCache cache;
+
+		assembler.assemble(is_volume, size, n_to_basis, no_density, to_bases, to_gbases, cache, mass_);
+		assembler.assemble_cross(
+			is_volume, size,
+			n_from_basis, from_bases, from_gbases,
+			n_to_basis, to_bases, to_gbases,
+			cache, cross_mass_);
+		assert(cross_mass_.rows() == mass_.rows());
+
+#ifdef POLYSOLVE_WITH_MKL
+		solver_ = polysolve::linear::Solver::create("Eigen::PardisoLDLT", "");
+#elif defined(POLYSOLVE_WITH_CHOLMOD)
+		solver_ = polysolve::linear::Solver::create("Eigen::CholmodSimplicialLDLT", "");
+#else
+		solver_ = polysolve::linear::Solver::create("Eigen::SimplicialLDLT", "");
+#endif
+		solver_->analyze_pattern(mass_, 0);
+		solver_->factorize(mass_);
+	}
+
+	void MeshTransfer::transfer(const Eigen::MatrixXd &from, Eigen::MatrixXd &to) const
+	{
+		assert(from.rows() == cross_mass_.cols());
+
+		const Eigen::MatrixXd rhs = cross_mass_ * from;
+		to.resize(rhs.rows(), rhs.cols());
+		for (int i = 0; i < to.cols(); ++i)
+			solver_->solve(rhs.col(i), to.col(i));
+
+		logger().trace("residual error in the mesh transfer: {}", (mass_ * to - rhs).norm());
+	}
+} // namespace polyfem::assembler
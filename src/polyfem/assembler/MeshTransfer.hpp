@@ -0,0 +1,58 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+#include <polyfem/utils/Types.hpp>
+
+#include <polysolve/linear/Solver.hpp>
+
+#include <Eigen/Dense>
+
+#include <memory>
+#include <vector>
+
+namespace polyfem::assembler
+{
+	/// @brief Conservative L2 transfer of fields between the spaces of two unrelated simplicial meshes.
+	///
+	/// The target field x solves M x = A y, where M is the mass matrix of the target space and A the cross mass matrix
+	/// integrated on the supermesh of the element intersections (see MassMatrixAssembler::assemble_cross). The constants
+	/// are in the target space, so the integral of every component is preserved on the overlap of the meshes.
+	/// The operator is assembled and factorized once, every transfer between the same spaces is a back-substitution.
+	class MeshTransfer
+	{
+	public:
+		/// @brief Assembles and factorizes the transfer operator
+		/// @param[in] is_volume True if the meshes are volumetric
+		/// @param[in] size number of components of the fields
+		/// @param[in] n_from_basis number of bases of the source space
+		/// @param[in] from_bases bases of the source space
+		/// @param[in] from_gbases geometric bases of the source space, affine
+		/// @param[in] n_to_basis number of bases of the target space
+		/// @param[in] to_bases bases of the target space
+		/// @param[in] to_gbases geometric bases of the target space, affine
+		MeshTransfer(
+			const bool is_volume,
+			const int size,
+			const int n_from_basis,
+			const std::vector<basis::ElementBases> &from_bases,
+			const std::vector<basis::ElementBases> &from_gbases,
+			const int n_to_basis,
+			const std::vector<basis::ElementBases> &to_bases,
+			const std::vector<basis::ElementBases> &to_gbases);
+
+		/// @brief transfers fields of the source space to the target space
+		/// @param[in] from fields of the source space, one per column, n_from_basis * size rows
+		/// @param[out] to fields of the target space, one per column, n_to_basis * size rows
+		void transfer(const Eigen::MatrixXd &from, Eigen::MatrixXd &to) const;
+
+		/// mass matrix M of the target space
+		const StiffnessMatrix &mass() const { return mass_; }
+		/// cross mass matrix A between the target (rows) and the source (columns) spaces
+		const StiffnessMatrix &cross_mass() const { return cross_mass_; }
+
+	private:
+		StiffnessMatrix mass_;
+		StiffnessMatrix cross_mass_;
+		std::unique_ptr<polysolve::linear::Solver> solver_;
+	};
+} // namespace polyfem::assembler
@@ -2,6 +2,8 @@
 
 #include <polyfem/autogen/auto_mooney_rivlin_gradient_hessian.hpp>
 
+#include <ipc/utils/eigen_ext.hpp>
+
 namespace polyfem::assembler
 {
 
@@ -13,69 +15,12 @@ namespace polyfem::assembler
 	Eigen::VectorXd
 	MooneyRivlin3ParamSymbolic::assemble_gradient(const NonLinearAssemblerData &data) const
 	{
-		Eigen::Matrix<double, Eigen::Dynamic, 1> gradient;
+		const int n_bases = data.vals.basis_values.size();
+		Eigen::VectorXd gradient(n_bases * size());
 
-		if (size() == 2)
-		{
-			switch (data.vals.basis_values.size())
-			{
-			case 3:
-			{
-				gradient.resize(6);
-				compute_energy_aux_gradient_fast<3, 2>(data, gradient);
-				break;
-			}
-			case 6:
-			{
-				gradient.resize(12);
-				compute_energy_aux_gradient_fast<6, 2>(data, gradient);
-				break;
-			}
-			case 10:
-			{
-				gradient.resize(20);
-				compute_energy_aux_gradient_fast<10, 2>(data, gradient);
-				break;
-			}
-			default:
-			{
-				gradient.resize(data.vals.basis_values.size() * 2);
-				compute_energy_aux_gradient_fast<Eigen::Dynamic, 2>(data, gradient);
-				break;
-			}
-			}
-		}
-		else // if (size() == 3)
-		{
-			assert(size() == 3);
-			switch (data.vals.basis_values.size())
-			{
-			case 4:
-			{
-				gradient.resize(12);
-				compute_energy_aux_gradient_fast<4, 3>(data, gradient);
-				break;
-			}
-			case 10:
-			{
-				gradient.resize(30);
-				compute_energy_aux_gradient_fast<10, 3>(data, gradient);
-				break;
-			}
-			case 20:
-			{
-				gradient.resize(60);
-				compute_energy_aux_gradient_fast<20, 3>(data, gradient);
-				break;
-			}
-			default:
-			{
-				gradient.resize(data.vals.basis_values.size() * 3);
-				compute_energy_aux_gradient_fast<Eigen::Dynamic, 3>(data, gradient);
-				break;
-			}
-			}
-		}
+		dispatch_element_kernel(size(), n_bases, [&](auto n_basis, auto dim) {
+			compute_energy_aux_gradient_fast<decltype(n_basis)::value, decltype(dim)::value>(data, gradient);
+		});
 
 		return gradient;
 	}
@@ -83,81 +28,28 @@ namespace polyfem::assembler
 	Eigen::MatrixXd
 	MooneyRivlin3ParamSymbolic::assemble_hessian(const NonLinearAssemblerData &data) const
 	{
-		Eigen::MatrixXd hessian;
+		const int n_bases = data.vals.basis_values.size();
+		Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(n_bases * size(), n_bases * size());
 
-		if (size() == 2)
-		{
-			switch (data.vals.basis_values.size())
-			{
-			case 3:
-			{
-				hessian.resize(6, 6);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<3, 2>(data, hessian);
-				break;
-			}
-			case 6:
-			{
-				hessian.resize(12, 12);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<6, 2>(data, hessian);
-				break;
-			}
-			case 10:
-			{
-				hessian.resize(20, 20);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<10, 2>(data, hessian);
-				break;
-			}
-			default:
-			{
-				hessian.resize(data.vals.basis_values.size() * 2, data.vals.basis_values.size() * 2);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<Eigen::Dynamic, 2>(data, hessian);
-				break;
-			}
-			}
-		}
-		else // if (size() == 3)
-		{
-			assert(size() == 3);
-			switch (data.vals.basis_values.size())
-			{
-			case 4:
-			{
-				hessian.resize(12, 12);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<4, 3>(data, hessian);
-				break;
-			}
-			case 10:
-			{
-				hessian.resize(30, 30);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<10, 3>(data, hessian);
-				break;
-			}
-			case 20:
-			{
-				hessian.resize(60, 60);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<20, 3>(data, hessian);
-				break;
-			}
-			default:
-			{
-				hessian.resize(data.vals.basis_values.size() * 3, data.vals.basis_values.size() * 3);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<Eigen::Dynamic, 3>(data, hessian);
-				break;
-			}
-			}
-		}
+		dispatch_element_kernel(size(), n_bases, [&](auto n_basis, auto dim) {
+			compute_energy_hessian_aux_fast<decltype(n_basis)::value, decltype(dim)::value>(data, false, hessian);
+		});
 
 		return hessian;
 	}
 
+	bool MooneyRivlin3ParamSymbolic::assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const
+	{
+		const int n_bases = data.vals.basis_values.size();
+		hessian = Eigen::MatrixXd::Zero(n_bases * size(), n_bases * size());
+
+		dispatch_element_kernel(size(), n_bases, [&](auto n_basis, auto dim) {
+			compute_energy_hessian_aux_fast<decltype(n_basis)::value, decltype(dim)::value>(data, true, hessian);
+		});
+
+		return true;
+	}
+
 	void MooneyRivlin3ParamSymbolic::assign_stress_tensor(const OutputData &data,
 														  const int all_size,
 														  const ElasticityTensorType &type,
@@ -464,7 +356,7 @@ namespace polyfem::assembler
 	}
 
 	template <int n_basis, int dim>
-	void MooneyRivlin3ParamSymbolic::compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, Eigen::MatrixXd &H) const
+	void MooneyRivlin3ParamSymbolic::compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, const bool project_to_psd, Eigen::MatrixXd &H) const
 	{
 		assert(data.x.cols() == 1);
 
@@ -509,6 +401,9 @@ namespace polyfem::assembler
 
 			Eigen::Matrix<double, dim * dim, dim * dim> hessian_temp;
 			autogen::generate_hessian_templated<dim>(c1, c2, c3, d1, def_grad, hessian_temp);
+			// projecting the dim^2 x dim^2 tangent is cheaper than projecting the element hessian
+			if (project_to_psd)
+				hessian_temp = ipc::project_to_psd(hessian_temp);
 
 			// Check by FD
 			/*
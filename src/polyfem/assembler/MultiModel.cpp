@@ -1,5 +1,9 @@
 #include "MultiModel.hpp"
 
+#include <polyfem/utils/Logger.hpp>
+
+#include <array>
+
 // #include <polyfem/basis/Basis.hpp>
 // #include <polyfem/autogen/auto_elasticity_rhs.hpp>
 
@@ -47,98 +51,180 @@ namespace polyfem::assembler
 		return res;
 	}
 
-	Eigen::VectorXd
-	MultiModel::assemble_gradient(const NonLinearAssemblerData &data) const
+	void MultiModel::init_multimodels(const std::vector<std::string> &mats)
 	{
-		const int el_id = data.vals.element_id;
-		const std::string model = multi_material_models_[el_id];
-
-		if (model == "SaintVenant")
-			return saint_venant_.assemble_gradient(data);
-		else if (model == "NeoHookean")
-			return neo_hookean_.assemble_gradient(data);
-		else if (model == "LinearElasticity")
-			return linear_elasticity_.assemble_gradient(data);
-		else if (model == "HookeLinearElasticity")
-			return hooke_.assemble_gradient(data);
-		else if (model == "MooneyRivlin")
-			return mooney_rivlin_elasticity_.assemble_gradient(data);
-		else if (model == "MooneyRivlin3Param")
-			return mooney_rivlin_3_param_elasticity_.assemble_gradient(data);
-		else if (model == "UnconstrainedOgden")
-			return unconstrained_ogden_elasticity_.assemble_gradient(data);
-		else if (model == "IncompressibleOgden")
-			return incompressible_ogden_elasticity_.assemble_gradient(data);
-		else if (model == "FixedCorotational")
-			return fixed_corotational_.assemble_gradient(data);
-		else
+		element_models_.resize(mats.size());
+		std::array<bool, int(Model::FIXED_COROTATIONAL) + 1> used;
+		used.fill(false);
+
+		for (int e = 0; e < mats.size(); ++e)
+		{
+			const std::string &model = mats[e];
+
+			if (model == "SaintVenant")
+				element_models_[e] = Model::SAINT_VENANT;
+			else if (model == "NeoHookean")
+				element_models_[e] = Model::NEO_HOOKEAN;
+			else if (model == "LinearElasticity")
+				element_models_[e] = Model::LINEAR_ELASTICITY;
+			else if (model == "HookeLinearElasticity")
+				element_models_[e] = Model::HOOKE;
+			else if (model == "MooneyRivlin")
+				element_models_[e] = Model::MOONEY_RIVLIN;
+			else if (model == "MooneyRivlin3Param")
+				element_models_[e] = Model::MOONEY_RIVLIN_3_PARAM;
+			else if (model == "UnconstrainedOgden")
+				element_models_[e] = Model::UNCONSTRAINED_OGDEN;
+			else if (model == "IncompressibleOgden")
+				element_models_[e] = Model::INCOMPRESSIBLE_OGDEN;
+			else if (model == "FixedCorotational")
+				element_models_[e] = Model::FIXED_COROTATIONAL;
+			else
+				log_and_throw_error("Unknown material model {} in MultiModels!", model);
+
+			used[int(element_models_[e])] = true;
+		}
+
+		// models with closed-form batched kernels, see dispatch_batch_model
+		has_batch_kernels_ = !element_models_.empty();
+		for (const Model m : {Model::HOOKE, Model::MOONEY_RIVLIN, Model::MOONEY_RIVLIN_3_PARAM, Model::UNCONSTRAINED_OGDEN, Model::INCOMPRESSIBLE_OGDEN})
 		{
-			assert(false);
-			return Eigen::VectorXd(0, 0);
+			if (used[int(m)])
+				has_batch_kernels_ = false;
 		}
 	}
 
-	Eigen::MatrixXd
-	MultiModel::assemble_hessian(const NonLinearAssemblerData &data) const
+	template <typename Fn>
+	decltype(auto) MultiModel::dispatch_model(const Model model, Fn &&f) const
 	{
-		const int el_id = data.vals.element_id;
-		const std::string model = multi_material_models_[el_id];
-
-		if (model == "SaintVenant")
-			return saint_venant_.assemble_hessian(data);
-		else if (model == "NeoHookean")
-			return neo_hookean_.assemble_hessian(data);
-		else if (model == "LinearElasticity")
-			return linear_elasticity_.assemble_hessian(data);
-		else if (model == "HookeLinearElasticity")
-			return hooke_.assemble_hessian(data);
-		else if (model == "MooneyRivlin")
-			return mooney_rivlin_elasticity_.assemble_hessian(data);
-		else if (model == "MooneyRivlin3Param")
-			return mooney_rivlin_3_param_elasticity_.assemble_hessian(data);
-		else if (model == "UnconstrainedOgden")
-			return unconstrained_ogden_elasticity_.assemble_hessian(data);
-		else if (model == "IncompressibleOgden")
-			return incompressible_ogden_elasticity_.assemble_hessian(data);
-		else if (model == "FixedCorotational")
-			return fixed_corotational_.assemble_hessian(data);
-		else
+		switch (model)
 		{
-			assert(false);
-			return Eigen::MatrixXd(0, 0);
+		case Model::SAINT_VENANT:
+			return f(saint_venant_);
+		case Model::NEO_HOOKEAN:
+			return f(neo_hookean_);
+		case Model::LINEAR_ELASTICITY:
+			return f(linear_elasticity_);
+		case Model::HOOKE:
+			return f(hooke_);
+		case Model::MOONEY_RIVLIN:
+			return f(mooney_rivlin_elasticity_);
+		case Model::MOONEY_RIVLIN_3_PARAM:
+			return f(mooney_rivlin_3_param_elasticity_);
+		case Model::UNCONSTRAINED_OGDEN:
+			return f(unconstrained_ogden_elasticity_);
+		case Model::INCOMPRESSIBLE_OGDEN:
+			return f(incompressible_ogden_elasticity_);
+		case Model::FIXED_COROTATIONAL:
+		default:
+			assert(model == Model::FIXED_COROTATIONAL);
+			return f(fixed_corotational_);
 		}
 	}
 
-	double MultiModel::compute_energy(const NonLinearAssemblerData &data) const
+	template <typename Fn>
+	void MultiModel::dispatch_batch_model(const Model model, Fn &&f) const
 	{
-		const int el_id = data.vals.element_id;
-		const std::string model = multi_material_models_[el_id];
-
-		if (model == "SaintVenant")
-			return saint_venant_.compute_energy(data);
-		else if (model == "NeoHookean")
-			return neo_hookean_.compute_energy(data);
-		else if (model == "LinearElasticity")
-			return linear_elasticity_.compute_energy(data);
-		else if (model == "HookeLinearElasticity")
-			return hooke_.compute_energy(data);
-		else if (model == "MooneyRivlin")
-			return mooney_rivlin_elasticity_.compute_energy(data);
-		else if (model == "MooneyRivlin3Param")
-			return mooney_rivlin_3_param_elasticity_.compute_energy(data);
-		else if (model == "UnconstrainedOgden")
-			return unconstrained_ogden_elasticity_.compute_energy(data);
-		else if (model == "IncompressibleOgden")
-			return incompressible_ogden_elasticity_.compute_energy(data);
-		else if (model == "FixedCorotational")
-			return fixed_corotational_.compute_energy(data);
-		else
+		switch (model)
 		{
-			assert(false);
-			return 0;
+		case Model::SAINT_VENANT:
+			f(saint_venant_);
+			break;
+		case Model::NEO_HOOKEAN:
+			f(neo_hookean_);
+			break;
+		case Model::LINEAR_ELASTICITY:
+			f(linear_elasticity_);
+			break;
+		case Model::FIXED_COROTATIONAL:
+			f(fixed_corotational_);
+			break;
+		default:
+			log_and_throw_error("Batched kernels not implemented by the material of MultiModels!");
 		}
 	}
 
+	template <typename Fn>
+	decltype(auto) MultiModel::dispatch(const int el_id, Fn &&f) const
+	{
+		assert(el_id < element_models_.size());
+		return dispatch_model(element_models_[el_id], std::forward<Fn>(f));
+	}
+
+	template <typename Out, typename Fn>
+	void MultiModel::dispatch_batch(const BatchAssemblerData &data, Out &out, Fn &&f) const
+	{
+		const int n_pts = data.size();
+		assert(n_pts > 0);
+
+		const Model first = element_models_[data.el_ids(0)];
+		bool uniform = true;
+		for (int k = 1; k < n_pts && uniform; ++k)
+			uniform = element_models_[data.el_ids(k)] == first;
+
+		if (uniform)
+		{
+			dispatch_batch_model(first, [&](const auto &model) { f(model, data, out); });
+			return;
+		}
+
+		std::array<std::vector<int>, int(Model::FIXED_COROTATIONAL) + 1> groups;
+		for (int k = 0; k < n_pts; ++k)
+			groups[int(element_models_[data.el_ids(k)])].push_back(k);
+
+		Out sub;
+		for (int m = 0; m < groups.size(); ++m)
+		{
+			const std::vector<int> &rows = groups[m];
+			if (rows.empty())
+				continue;
+
+			const Eigen::MatrixXd local_pts = data.local_pts(rows, Eigen::all);
+			const Eigen::MatrixXd global_pts = data.global_pts(rows, Eigen::all);
+			const Eigen::VectorXi el_ids = data.el_ids(rows);
+			const Eigen::ArrayXXd def_grad = data.def_grad(rows, Eigen::all);
+			const BatchAssemblerData sub_data(data.dim, data.t, data.dt, local_pts, global_pts, el_ids, def_grad);
+
+			dispatch_batch_model(Model(m), [&](const auto &model) { f(model, sub_data, sub); });
+			assert(sub.rows() == rows.size());
+
+			if (out.rows() != n_pts || out.cols() != sub.cols())
+				out.resize(n_pts, sub.cols());
+			out(rows, Eigen::all) = sub;
+		}
+	}
+
+	Eigen::VectorXd
+	MultiModel::assemble_gradient(const NonLinearAssemblerData &data) const
+	{
+		return dispatch(data.vals.element_id, [&](const auto &model) { return model.assemble_gradient(data); });
+	}
+
+	Eigen::MatrixXd
+	MultiModel::assemble_hessian(const NonLinearAssemblerData &data) const
+	{
+		return dispatch(data.vals.element_id, [&](const auto &model) { return model.assemble_hessian(data); });
+	}
+
+	double MultiModel::compute_energy(const NonLinearAssemblerData &data) const
+	{
+		return dispatch(data.vals.element_id, [&](const auto &model) { return model.compute_energy(data); });
+	}
+
+	void MultiModel::compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const
+	{
+		dispatch_batch(data, psi, [](const auto &model, const BatchAssemblerData &sub_data, Eigen::ArrayXd &sub_psi) {
+			model.compute_energy_density_batch(sub_data, sub_psi);
+		});
+	}
+
+	void MultiModel::compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const
+	{
+		dispatch_batch(data, stress, [](const auto &model, const BatchAssemblerData &sub_data, Eigen::ArrayXXd &sub_stress) {
+			model.compute_stress_batch(sub_data, sub_stress);
+		});
+	}
+
 	void MultiModel::assign_stress_tensor(
 		const OutputData &data,
 		const int all_size,
@@ -146,30 +232,7 @@ namespace polyfem::assembler
 		Eigen::MatrixXd &all,
 		const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const
 	{
-		const std::string model = multi_material_models_[data.el_id];
-
-		if (model == "SaintVenant")
-			saint_venant_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "NeoHookean")
-			neo_hookean_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "LinearElasticity")
-			linear_elasticity_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "HookeLinearElasticity")
-			return hooke_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "MooneyRivlin")
-			return mooney_rivlin_elasticity_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "MooneyRivlin3Param")
-			return mooney_rivlin_3_param_elasticity_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "UnconstrainedOgden")
-			return unconstrained_ogden_elasticity_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "IncompressibleOgden")
-			return incompressible_ogden_elasticity_.assign_stress_tensor(data, all_size, type, all, fun);
-		else if (model == "FixedCorotational")
-			return fixed_corotational_.assign_stress_tensor(data, all_size, type, all, fun);
-		else
-		{
-			assert(false);
-		}
+		dispatch(data.el_id, [&](const auto &model) { model.assign_stress_tensor(data, all_size, type, all, fun); });
 	}
 
 	std::map<std::string, Assembler::ParamFunc> MultiModel::parameters() const
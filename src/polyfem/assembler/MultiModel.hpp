@@ -26,6 +26,12 @@ namespace polyfem::assembler
 		// compute gradient of elastic energy, as assembler
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 
+		// batched energy density and stress, available if every material used has them. The points of a
+		// batch are grouped by material and each group is evaluated with the kernel of its model
+		bool has_batch_kernels() const override { return has_batch_kernels_; }
+		void compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const override;
+		void compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const override;
+
 		// uses autodiff to compute the rhs for a fabbricated solution
 		// uses autogenerated code to compute div(sigma)
 		// pt is the evaluation of the solution at a point
@@ -35,8 +41,8 @@ namespace polyfem::assembler
 		// inialize material parameter
 		void add_multimaterial(const int index, const json &params, const Units &units) override;
 
-		// initialized multi models
-		inline void init_multimodels(const std::vector<std::string> &mats) { multi_material_models_ = mats; }
+		// initialized multi models, mats is the name of the model of every element
+		void init_multimodels(const std::vector<std::string> &mats);
 
 		std::string name() const override { return "MultiModels"; }
 		std::map<std::string, ParamFunc> parameters() const override;
@@ -49,7 +55,36 @@ namespace polyfem::assembler
 								  const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const override;
 
 	private:
-		std::vector<std::string> multi_material_models_;
+		enum class Model
+		{
+			SAINT_VENANT,
+			NEO_HOOKEAN,
+			LINEAR_ELASTICITY,
+			HOOKE,
+			MOONEY_RIVLIN,
+			MOONEY_RIVLIN_3_PARAM,
+			UNCONSTRAINED_OGDEN,
+			INCOMPRESSIBLE_OGDEN,
+			FIXED_COROTATIONAL
+		};
+
+		// calls f with the assembler of model, a switch on the concrete members instead of a string comparison
+		template <typename Fn>
+		decltype(auto) dispatch_model(const Model model, Fn &&f) const;
+		// same for the models with batched kernels
+		template <typename Fn>
+		void dispatch_batch_model(const Model model, Fn &&f) const;
+		// calls f with the assembler of the model of element el_id, resolved once in init_multimodels
+		template <typename Fn>
+		decltype(auto) dispatch(const int el_id, Fn &&f) const;
+
+		// evaluates the batch with the kernels of the models of its points, gathering the points of
+		// every model in a sub-batch if the batch mixes several models
+		template <typename Out, typename Fn>
+		void dispatch_batch(const BatchAssemblerData &data, Out &out, Fn &&f) const;
+
+		std::vector<Model> element_models_;
+		bool has_batch_kernels_ = false;
 
 		SaintVenantElasticity saint_venant_;
 		NeoHookeanElasticity neo_hookean_;
@@ -2,6 +2,8 @@
 
 #include <polyfem/autogen/auto_elasticity_rhs.hpp>
 
+#include <ipc/utils/eigen_ext.hpp>
+
 namespace polyfem::assembler
 {
 	namespace
@@ -46,69 +48,12 @@ namespace polyfem::assembler
 	Eigen::VectorXd
 	NeoHookeanElasticity::assemble_gradient(const NonLinearAssemblerData &data) const
 	{
-		Eigen::Matrix<double, Eigen::Dynamic, 1> gradient;
+		const int n_bases = data.vals.basis_values.size();
+		Eigen::VectorXd gradient(n_bases * size());
 
-		if (size() == 2)
-		{
-			switch (data.vals.basis_values.size())
-			{
-			case 3:
-			{
-				gradient.resize(6);
-				compute_energy_aux_gradient_fast<3, 2>(data, gradient);
-				break;
-			}
-			case 6:
-			{
-				gradient.resize(12);
-				compute_energy_aux_gradient_fast<6, 2>(data, gradient);
-				break;
-			}
-			case 10:
-			{
-				gradient.resize(20);
-				compute_energy_aux_gradient_fast<10, 2>(data, gradient);
-				break;
-			}
-			default:
-			{
-				gradient.resize(data.vals.basis_values.size() * 2);
-				compute_energy_aux_gradient_fast<Eigen::Dynamic, 2>(data, gradient);
-				break;
-			}
-			}
-		}
-		else // if (size() == 3)
-		{
-			assert(size() == 3);
-			switch (data.vals.basis_values.size())
-			{
-			case 4:
-			{
-				gradient.resize(12);
-				compute_energy_aux_gradient_fast<4, 3>(data, gradient);
-				break;
-			}
-			case 10:
-			{
-				gradient.resize(30);
-				compute_energy_aux_gradient_fast<10, 3>(data, gradient);
-				break;
-			}
-			case 20:
-			{
-				gradient.resize(60);
-				compute_energy_aux_gradient_fast<20, 3>(data, gradient);
-				break;
-			}
-			default:
-			{
-				gradient.resize(data.vals.basis_values.size() * 3);
-				compute_energy_aux_gradient_fast<Eigen::Dynamic, 3>(data, gradient);
-				break;
-			}
-			}
-		}
+		dispatch_element_kernel(size(), n_bases, [&](auto n_basis, auto dim) {
+			compute_energy_aux_gradient_fast<decltype(n_basis)::value, decltype(dim)::value>(data, gradient);
+		});
 
 		return gradient;
 	}
@@ -173,81 +118,28 @@ namespace polyfem::assembler
 	Eigen::MatrixXd
 	NeoHookeanElasticity::assemble_hessian(const NonLinearAssemblerData &data) const
 	{
-		Eigen::MatrixXd hessian;
+		const int n_bases = data.vals.basis_values.size();
+		Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(n_bases * size(), n_bases * size());
 
-		if (size() == 2)
-		{
-			switch (data.vals.basis_values.size())
-			{
-			case 3:
-			{
-				hessian.resize(6, 6);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<3, 2>(data, hessian);
-				break;
-			}
-			case 6:
-			{
-				hessian.resize(12, 12);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<6, 2>(data, hessian);
-				break;
-			}
-			case 10:
-			{
-				hessian.resize(20, 20);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<10, 2>(data, hessian);
-				break;
-			}
-			default:
-			{
-				hessian.resize(data.vals.basis_values.size() * 2, data.vals.basis_values.size() * 2);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<Eigen::Dynamic, 2>(data, hessian);
-				break;
-			}
-			}
-		}
-		else // if (size() == 3)
-		{
-			assert(size() == 3);
-			switch (data.vals.basis_values.size())
-			{
-			case 4:
-			{
-				hessian.resize(12, 12);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<4, 3>(data, hessian);
-				break;
-			}
-			case 10:
-			{
-				hessian.resize(30, 30);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<10, 3>(data, hessian);
-				break;
-			}
-			case 20:
-			{
-				hessian.resize(60, 60);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<20, 3>(data, hessian);
-				break;
-			}
-			default:
-			{
-				hessian.resize(data.vals.basis_values.size() * 3, data.vals.basis_values.size() * 3);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<Eigen::Dynamic, 3>(data, hessian);
-				break;
-			}
-			}
-		}
+		dispatch_element_kernel(size(), n_bases, [&](auto n_basis, auto dim) {
+			compute_energy_hessian_aux_fast<decltype(n_basis)::value, decltype(dim)::value>(data, false, hessian);
+		});
 
 		return hessian;
 	}
 
+	bool NeoHookeanElasticity::assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const
+	{
+		const int n_bases = data.vals.basis_values.size();
+		hessian = Eigen::MatrixXd::Zero(n_bases * size(), n_bases * size());
+
+		dispatch_element_kernel(size(), n_bases, [&](auto n_basis, auto dim) {
+			compute_energy_hessian_aux_fast<decltype(n_basis)::value, decltype(dim)::value>(data, true, hessian);
+		});
+
+		return true;
+	}
+
 	void NeoHookeanElasticity::assign_stress_tensor(const OutputData &data,
 													const int all_size,
 													const ElasticityTensorType &type,
@@ -302,6 +194,44 @@ namespace polyfem::assembler
 		return compute_energy_aux<double>(data);
 	}
 
+	void NeoHookeanElasticity::compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const
+	{
+		const int dim = data.dim;
+		const Eigen::ArrayXXd &F = data.def_grad;
+
+		Eigen::ArrayXd lambda, mu;
+		params_.lambda_mu(data.local_pts, data.global_pts, data.t, data.el_ids, lambda, mu);
+
+		Eigen::ArrayXd J;
+		Eigen::ArrayXXd FmT;
+		batch_determinant_inverse_transpose(dim, F, J, FmT);
+
+		const Eigen::ArrayXd log_det_j = J.log();
+		const Eigen::ArrayXd trace_FtF = F.square().rowwise().sum();
+
+		psi = mu / 2 * (trace_FtF - dim - 2 * log_det_j) + lambda / 2 * log_det_j.square();
+	}
+
+	// P = μ (F - F⁻ᵀ) + λ ln(J) F⁻ᵀ
+	void NeoHookeanElasticity::compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const
+	{
+		const int dim = data.dim;
+		const Eigen::ArrayXXd &F = data.def_grad;
+
+		Eigen::ArrayXd lambda, mu;
+		params_.lambda_mu(data.local_pts, data.global_pts, data.t, data.el_ids, lambda, mu);
+
+		Eigen::ArrayXd J;
+		Eigen::ArrayXXd FmT;
+		batch_determinant_inverse_transpose(dim, F, J, FmT);
+
+		const Eigen::ArrayXd log_det_j = J.log();
+
+		stress.resize(F.rows(), F.cols());
+		for (int k = 0; k < F.cols(); ++k)
+			stress.col(k) = mu * (F.col(k) - FmT.col(k)) + lambda * log_det_j * FmT.col(k);
+	}
+
 	// Compute ∫ ½μ (tr(FᵀF) - 3 - 2ln(J)) + ½λ ln²(J) du
 	template <typename T>
 	T NeoHookeanElasticity::compute_energy_aux(const NonLinearAssemblerData &data) const
@@ -459,7 +389,7 @@ namespace polyfem::assembler
 	}
 
 	template <int n_basis, int dim>
-	void NeoHookeanElasticity::compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, Eigen::MatrixXd &H) const
+	void NeoHookeanElasticity::compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, const bool project_to_psd, Eigen::MatrixXd &H) const
 	{
 		assert(data.x.cols() == 1);
 
@@ -546,6 +476,9 @@ namespace polyfem::assembler
 			Eigen::Matrix<double, dim * dim, 1> g_j = Eigen::Map<const Eigen::Matrix<double, dim * dim, 1>>(delJ_delF.data(), delJ_delF.size());
 
 			Eigen::Matrix<double, dim * dim, dim * dim> hessian_temp = (mu * id) + (((mu + lambda * (1 - log_det_j)) / (J * J)) * (g_j * g_j.transpose())) + (((lambda * log_det_j - mu) / (J)) * del2J_delF2);
+			// projecting the dim^2 x dim^2 tangent is cheaper than projecting the element hessian
+			if (project_to_psd)
+				hessian_temp = ipc::project_to_psd(hessian_temp);
 
 			Eigen::Matrix<double, dim * dim, N> delF_delU_tensor(jac_it.size(), grad.size());
 
@@ -21,6 +21,12 @@ namespace polyfem::assembler
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
+		bool assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const override;
+
+		// batched energy density and stress, vectorized across the points of several elements
+		bool has_batch_kernels() const override { return true; }
+		void compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const override;
+		void compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const override;
 
 		// rhs for fabbricated solution, compute with automatic sympy code
 		VectorNd compute_rhs(const AutodiffHessianPt &pt) const override;
@@ -77,7 +83,7 @@ namespace polyfem::assembler
 		template <typename T>
 		T compute_energy_aux(const NonLinearAssemblerData &data) const;
 		template <int n_basis, int dim>
-		void compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, Eigen::MatrixXd &H) const;
+		void compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, const bool project_to_psd, Eigen::MatrixXd &H) const;
 		template <int n_basis, int dim>
 		void compute_energy_aux_gradient_fast(const NonLinearAssemblerData &data, Eigen::VectorXd &G_flattened) const;
 	};
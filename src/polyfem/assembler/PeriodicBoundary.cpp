@@ -4,6 +4,8 @@
 #include <polyfem/mesh/LocalBoundary.hpp>
 #include <polyfem/utils/Logger.hpp>
 
+#include <algorithm>
+
 namespace
 {
 	Eigen::MatrixXd extract_vertices(const std::shared_ptr<polyfem::mesh::MeshNodes> &mesh_nodes)
@@ -185,6 +187,19 @@ namespace polyfem::utils
 		return boundary_nodes_reduced;
     }
 
+    Eigen::VectorXi PeriodicBoundary::full_to_periodic_index(const int ndofs) const
+    {
+		const int independent_dof = full_to_periodic_map_.maxCoeff() + 1;
+		const int n_mapped = std::min<int>(ndofs, full_to_periodic_map_.size());
+
+		Eigen::VectorXi index(ndofs);
+		index.head(n_mapped) = full_to_periodic_map_.head(n_mapped);
+		for (int i = n_mapped; i < ndofs; ++i)
+			index(i) = i + independent_dof - full_to_periodic_map_.size();
+
+		return index;
+    }
+
     Eigen::MatrixXd PeriodicBoundary::periodic_to_full(const int ndofs, const Eigen::MatrixXd &x_periodic) const
 	{
 		const int independent_dof = full_to_periodic_map_.maxCoeff() + 1;
@@ -36,6 +36,8 @@ namespace polyfem::utils
         int full_to_periodic(StiffnessMatrix &A) const;
 		Eigen::MatrixXd full_to_periodic(const Eigen::MatrixXd &b, bool accumulate) const;
 		std::vector<int> full_to_periodic(const std::vector<int> &boundary_nodes) const;
+		/// periodic index of each of the first ndofs dofs, the dofs past the periodic ones (e.g., pressure) are shifted after them
+		Eigen::VectorXi full_to_periodic_index(const int ndofs) const;
 
         inline int n_periodic_dof() const { return full_to_periodic_map_.maxCoeff() + 1; }
         inline bool is_periodic_dof(const int idx) const { return periodic_mask_[idx]; }
@@ -12,6 +12,8 @@
 
 #include <igl/boundary_loop.h>
 
+#include <array>
+
 namespace polyfem
 {
 	using namespace polysolve;
@@ -57,7 +59,27 @@ namespace polyfem
 			class LocalThreadMatStorage
 			{
 			public:
-				std::vector<Eigen::Triplet<double>> entries;
+				std::unique_ptr<MatrixCache> cache = nullptr;
+
+				LocalThreadMatStorage() = delete;
+
+				LocalThreadMatStorage(const MatrixCache &c)
+				{
+					cache = c.copy();
+					cache->init(c);
+				}
+
+				LocalThreadMatStorage(const LocalThreadMatStorage &other)
+					: cache(other.cache->copy())
+				{
+				}
+
+				LocalThreadMatStorage &operator=(const LocalThreadMatStorage &other)
+				{
+					assert(other.cache != nullptr);
+					cache = other.cache->copy();
+					return *this;
+				}
 			};
 
 			Eigen::Matrix3d wedge_product(const Eigen::Vector3d &a, const Eigen::Vector3d &b)
@@ -87,115 +109,208 @@ namespace polyfem
 			}
 		} // namespace
 
-		double PressureAssembler::compute_volume(
-			const Eigen::MatrixXd &displacement,
-			const std::vector<mesh::LocalBoundary> &local_boundary,
-			const int resolution,
-			const double t,
-			const bool multiply_pressure) const
+		std::shared_ptr<PressureAssembler::SurfaceQuadrature> PressureAssembler::surface_quadrature(const std::vector<mesh::LocalBoundary> &local_boundary, const int resolution) const
 		{
-			double res = 0;
+			std::vector<int> boundary_primitives;
+			std::vector<std::pair<int, int>> primitives; // (local boundary, primitive)
+			for (int l = 0; l < local_boundary.size(); ++l)
+			{
+				const LocalBoundary &lb = local_boundary[l];
+				boundary_primitives.push_back(lb.element_id());
+				for (int i = 0; i < lb.size(); ++i)
+				{
+					boundary_primitives.push_back(lb.global_primitive_id(i));
+					primitives.emplace_back(l, i);
+				}
+				boundary_primitives.push_back(-1);
+			}
 
-			auto storage = utils::create_thread_storage(LocalThreadScalarStorage());
+			std::lock_guard<std::mutex> lock(surface_quadrature_mutex_);
 
-			utils::maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
-				LocalThreadScalarStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			for (const std::shared_ptr<SurfaceQuadrature> &surface : surface_quadratures_)
+			{
+				if (surface->resolution == resolution && surface->boundary_primitives == boundary_primitives)
+					return surface;
+			}
 
-				Eigen::MatrixXd pressure_vals, g_3;
-				ElementAssemblyValues vals;
-				Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
-				Eigen::VectorXd weights;
-				Eigen::VectorXi global_primitive_ids;
-				for (int lb_id = start; lb_id < end; ++lb_id)
+			auto surface = std::make_shared<SurfaceQuadrature>();
+			surface->boundary_primitives = std::move(boundary_primitives);
+			surface->resolution = resolution;
+
+			std::vector<SurfaceQuadrature::Face> all_faces(primitives.size());
+			std::vector<bool> has_samples(primitives.size());
+			utils::maybe_parallel_for(int(primitives.size()), [&](int start, int end, int thread_id) {
+				for (int p = start; p < end; ++p)
 				{
-					const auto &lb = local_boundary[lb_id];
+					const LocalBoundary &lb = local_boundary[primitives[p].first];
+					const int i = primitives[p].second;
 					const int e = lb.element_id();
-					const basis::ElementBases &gbs = gbases_[e];
-					const basis::ElementBases &bs = bases_[e];
 
-					for (int i = 0; i < lb.size(); ++i)
+					SurfaceQuadrature::Face &face = all_faces[p];
+					face.element_id = e;
+					face.global_primitive_id = lb.global_primitive_id(i);
+					face.boundary_id = mesh_.get_boundary_id(face.global_primitive_id);
+
+					has_samples[p] = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, face.uv, face.points, face.normals, face.weights);
+					if (!has_samples[p])
+						continue;
+
+					if (mesh_.is_volume())
 					{
-						const int primitive_global_id = lb.global_primitive_id(i);
-						const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
+						face.weights /= 2 * mesh_.tri_area(face.global_primitive_id);
+
+						const Eigen::MatrixXd endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
+						face.tangents.resize(3, 2);
+						face.tangents.col(0) = (endpoints.row(0) - endpoints.row(1)).transpose();
+						face.tangents.col(1) = (endpoints.row(0) - endpoints.row(2)).transpose();
+						if (lb[i] == 0)
+							face.tangents.col(0) *= -1;
+					}
+					else
+					{
+						face.weights /= mesh_.edge_length(face.global_primitive_id);
 
-						bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-						if (mesh_.is_volume())
-							weights /= 2 * mesh_.tri_area(primitive_global_id);
-						else
-							weights /= mesh_.edge_length(primitive_global_id);
-						g_3.setZero(normals.rows(), normals.cols());
+						const Eigen::Matrix2d endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(lb[i]);
+						face.tangents = (endpoints.row(0) - endpoints.row(1)).transpose();
+					}
+
+					face.vals.compute(e, mesh_.is_volume(), face.points, bases_[e], gbases_[e]);
+					face.nodes = bases_[e].local_nodes_for_primitive(face.global_primitive_id, mesh_);
+				}
+			});
 
-						if (!has_samples)
-							continue;
+			for (int p = 0; p < all_faces.size(); ++p)
+			{
+				if (has_samples[p])
+					surface->faces.push_back(std::move(all_faces[p]));
+			}
 
-						global_primitive_ids.setConstant(weights.size(), primitive_global_id);
+			surface_quadratures_.push_back(surface);
+			return surface;
+		}
 
-						vals.compute(e, mesh_.is_volume(), points, bs, gbs);
+		template <int DIM>
+		void PressureAssembler::deformed_frames(
+			const SurfaceQuadrature::Face &face,
+			const Eigen::MatrixXd &displacement,
+			Eigen::MatrixXd &normals,
+			std::vector<Eigen::Matrix<double, DIM, DIM>> &frames) const
+		{
+			assert(size_ == DIM);
+			const ElementAssemblyValues &vals = face.vals;
 
-						for (int n = 0; n < vals.jac_it.size(); ++n)
+			normals = face.normals;
+			frames.resize(vals.jac_it.size());
+
+			Eigen::Matrix<double, DIM, DIM> trafo;
+			for (int n = 0; n < vals.jac_it.size(); ++n)
+			{
+				trafo = vals.jac_it[n].inverse();
+
+				if (displacement.size() > 0)
+				{
+					for (const auto &b : vals.basis_values)
+					{
+						for (const auto &g : b.global)
 						{
-							trafo = vals.jac_it[n].inverse();
+							for (int d = 0; d < DIM; ++d)
+								trafo.row(d) += displacement(g.index * DIM + d) * b.grad.row(n);
+						}
+					}
+				}
 
-							if (displacement.size() > 0)
-							{
-								assert(size_ == 2 || size_ == 3);
-								deform_mat.resize(size_, size_);
-								deform_mat.setZero();
-								for (const auto &b : vals.basis_values)
-								{
-									for (const auto &g : b.global)
-									{
-										for (int d = 0; d < size_; ++d)
-										{
-											deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
-										}
-									}
-								}
+				normals.row(n) = normals.row(n) * trafo.inverse();
+				normals.row(n).normalize();
 
-								trafo += deform_mat;
-							}
+				Eigen::Matrix<double, DIM, DIM> &frame = frames[n];
+				frame.template leftCols<DIM - 1>() = trafo * face.tangents;
+				if constexpr (DIM == 3)
+					frame.col(2) = frame.col(0).cross(frame.col(1));
+				else
+					frame.col(1) << -frame(1, 0), frame(0, 0);
+			}
+		}
 
-							normals.row(n) = normals.row(n) * trafo.inverse();
-							normals.row(n).normalize();
+		void PressureAssembler::deformed_normals(
+			const SurfaceQuadrature::Face &face,
+			const Eigen::MatrixXd &displacement,
+			Eigen::MatrixXd &normals,
+			Eigen::MatrixXd &g_3) const
+		{
+			g_3.resize(face.weights.size(), size_);
+			if (size_ == 2)
+			{
+				std::vector<Eigen::Matrix2d> frames;
+				deformed_frames<2>(face, displacement, normals, frames);
+				for (int n = 0; n < frames.size(); ++n)
+					g_3.row(n) = frames[n].col(1).transpose();
+			}
+			else
+			{
+				assert(size_ == 3);
+				std::vector<Eigen::Matrix3d> frames;
+				deformed_frames<3>(face, displacement, normals, frames);
+				for (int n = 0; n < frames.size(); ++n)
+					g_3.row(n) = frames[n].col(2).transpose();
+			}
+		}
 
-							if (mesh_.is_volume())
-							{
-								Eigen::Vector3d g1, g2, g3;
-								auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
-								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
-								g2 = trafo * (endpoints.row(0) - endpoints.row(2)).transpose();
-								if (lb[i] == 0)
-									g1 *= -1;
-								g3 = g1.cross(g2);
-								g_3.row(n) = g3.transpose();
-							}
-							else
-							{
-								Eigen::Vector2d g1, g3;
-								auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(lb[i]);
-								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
-								g3(0) = -g1(1);
-								g3(1) = g1(0);
-								g_3.row(n) = g3.transpose();
-							}
-						}
+		void PressureAssembler::face_pressure(
+			const SurfaceQuadrature::Face &face,
+			const Eigen::MatrixXd &normals,
+			const double t,
+			const bool multiply_pressure,
+			Eigen::MatrixXd &pressure_vals) const
+		{
+			if (multiply_pressure)
+			{
+				const Eigen::VectorXi global_primitive_ids = Eigen::VectorXi::Constant(face.weights.size(), face.global_primitive_id);
+				problem_.pressure_bc(mesh_, global_primitive_ids, face.uv, face.vals.val, normals, t, pressure_vals);
+			}
+			else
+				pressure_vals = Eigen::MatrixXd::Ones(face.weights.size(), 1);
+		}
 
-						if (multiply_pressure)
-							problem_.pressure_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, pressure_vals);
-						else
-							pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
+		double PressureAssembler::compute_volume(
+			const Eigen::MatrixXd &displacement,
+			const std::vector<mesh::LocalBoundary> &local_boundary,
+			const int resolution,
+			const double t,
+			const bool multiply_pressure) const
+		{
+			const std::shared_ptr<const SurfaceQuadrature> surface = surface_quadrature(local_boundary, resolution);
 
-						Eigen::MatrixXd u, grad_u;
-						if (displacement.size() > 0)
-							io::Evaluator::interpolate_at_local_vals(mesh_, problem_.is_scalar(), bases_, gbases_, e, points, displacement, u, grad_u);
-						else
-							u.setZero(weights.size(), size_);
-						u += vals.val;
+			double res = 0;
+
+			auto storage = utils::create_thread_storage(LocalThreadScalarStorage());
 
-						for (long p = 0; p < weights.size(); ++p)
-							for (int d = 0; d < size_; ++d)
-								local_storage.val += pressure_vals(p) * g_3(p, d) * u(p, d) * weights(p);
+			utils::maybe_parallel_for(surface->faces.size(), [&](int start, int end, int thread_id) {
+				LocalThreadScalarStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+
+				Eigen::MatrixXd pressure_vals, normals, g_3, u;
+				for (int f = start; f < end; ++f)
+				{
+					const SurfaceQuadrature::Face &face = surface->faces[f];
+					const ElementAssemblyValues &vals = face.vals;
+
+					deformed_normals(face, displacement, normals, g_3);
+					face_pressure(face, normals, t, multiply_pressure, pressure_vals);
+
+					// deformed position of the quadrature points
+					u = vals.val;
+					if (displacement.size() > 0)
+					{
+						for (const auto &b : vals.basis_values)
+						{
+							for (const auto &g : b.global)
+							{
+								for (int d = 0; d < size_; ++d)
+									u.col(d) += (g.val * displacement(g.index * size_ + d)) * b.val;
+							}
+						}
 					}
+
+					local_storage.val += (pressure_vals.col(0).array() * (g_3.array() * u.array()).rowwise().sum() * face.weights.array()).sum();
 				}
 			});
 
@@ -214,115 +329,40 @@ namespace polyfem
 			const int resolution,
 			Eigen::VectorXd &grad,
 			const double t,
-			const bool multiply_pressure) const
+			const bool multiply_pressure,
+			const std::optional<int> &boundary_id) const
 		{
+			const std::shared_ptr<const SurfaceQuadrature> surface = surface_quadrature(local_boundary, resolution);
+			const std::vector<bool> is_dirichlet = dirichlet_mask(dirichlet_nodes);
+
 			grad.setZero(n_basis_ * size_);
 
 			auto storage = utils::create_thread_storage(LocalThreadVecStorage(grad.size()));
 
-			utils::maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
+			utils::maybe_parallel_for(surface->faces.size(), [&](int start, int end, int thread_id) {
 				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
-				Eigen::MatrixXd pressure_vals, g_3;
-				ElementAssemblyValues vals;
-				Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
-				Eigen::VectorXd weights;
-				Eigen::VectorXi global_primitive_ids;
-				for (int lb_id = start; lb_id < end; ++lb_id)
+				Eigen::MatrixXd pressure_vals, normals, g_3;
+				for (int f = start; f < end; ++f)
 				{
-					const auto &lb = local_boundary[lb_id];
-					const int e = lb.element_id();
-					const basis::ElementBases &gbs = gbases_[e];
-					const basis::ElementBases &bs = bases_[e];
-
-					for (int i = 0; i < lb.size(); ++i)
-					{
-						const int primitive_global_id = lb.global_primitive_id(i);
-						const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
-
-						bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-						if (mesh_.is_volume())
-							weights /= 2 * mesh_.tri_area(primitive_global_id);
-						else
-							weights /= mesh_.edge_length(primitive_global_id);
-						g_3.setZero(normals.rows(), normals.cols());
+					const SurfaceQuadrature::Face &face = surface->faces[f];
+					if (boundary_id.has_value() && face.boundary_id != *boundary_id)
+						continue;
 
-						if (!has_samples)
-							continue;
-
-						global_primitive_ids.setConstant(weights.size(), primitive_global_id);
-
-						vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-						for (int n = 0; n < vals.jac_it.size(); ++n)
-						{
-							trafo = vals.jac_it[n].inverse();
-
-							if (displacement.size() > 0)
-							{
-								assert(size_ == 2 || size_ == 3);
-								deform_mat.resize(size_, size_);
-								deform_mat.setZero();
-								for (const auto &b : vals.basis_values)
-								{
-									for (const auto &g : b.global)
-									{
-										for (int d = 0; d < size_; ++d)
-										{
-											deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
-										}
-									}
-								}
-
-								trafo += deform_mat;
-							}
+					deformed_normals(face, displacement, normals, g_3);
+					face_pressure(face, normals, t, multiply_pressure, pressure_vals);
 
-							normals.row(n) = normals.row(n) * trafo.inverse();
-							normals.row(n).normalize();
-
-							if (mesh_.is_volume())
-							{
-								Eigen::Vector3d g1, g2, g3;
-								auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
-								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
-								g2 = trafo * (endpoints.row(0) - endpoints.row(2)).transpose();
-								if (lb[i] == 0)
-									g1 *= -1;
-								g3 = g1.cross(g2);
-								g_3.row(n) = g3.transpose();
-							}
-							else
-							{
-								Eigen::Vector2d g1, g3;
-								auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(lb[i]);
-								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
-								g3(0) = -g1(1);
-								g3(1) = g1(0);
-								g_3.row(n) = g3.transpose();
-							}
-						}
-
-						if (multiply_pressure)
-							problem_.pressure_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, pressure_vals);
-						else
-							pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
-
-						for (long n = 0; n < nodes.size(); ++n)
+					for (long n = 0; n < face.nodes.size(); ++n)
+					{
+						const AssemblyValues &v = face.vals.basis_values[face.nodes(n)];
+						for (int d = 0; d < size_; ++d)
 						{
-							const AssemblyValues &v = vals.basis_values[nodes(n)];
-							for (int d = 0; d < size_; ++d)
+							const double value = (pressure_vals.col(0).array() * g_3.col(d).array() * v.val.array() * face.weights.array()).sum();
+							for (size_t g = 0; g < v.global.size(); ++g)
 							{
-								for (size_t g = 0; g < v.global.size(); ++g)
-								{
-									const int g_index = v.global[g].index * size_ + d;
-									const bool is_dof_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), g_index) != dirichlet_nodes.end();
-									if (is_dof_dirichlet)
-										continue;
-
-									for (long p = 0; p < weights.size(); ++p)
-									{
-										local_storage.vec(g_index) += pressure_vals(p) * g_3(p, d) * v.val(p) * weights(p);
-									}
-								}
+								const int g_index = v.global[g].index * size_ + d;
+								if (!is_dirichlet[g_index])
+									local_storage.vec(g_index) += value;
 							}
 						}
 					}
@@ -342,127 +382,11 @@ namespace polyfem
 			const double t,
 			const bool multiply_pressure) const
 		{
-			grad.setZero(n_basis_ * size_);
-
-			auto storage = utils::create_thread_storage(LocalThreadVecStorage(grad.size()));
-
-			utils::maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
-				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
-
-				Eigen::MatrixXd pressure_vals, g_3;
-				ElementAssemblyValues vals;
-				Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
-				Eigen::VectorXd weights;
-				Eigen::VectorXi global_primitive_ids;
-				for (int lb_id = start; lb_id < end; ++lb_id)
-				{
-					const auto &lb = local_boundary[lb_id];
-					const int e = lb.element_id();
-					const basis::ElementBases &gbs = gbases_[e];
-					const basis::ElementBases &bs = bases_[e];
-
-					for (int i = 0; i < lb.size(); ++i)
-					{
-						const int primitive_global_id = lb.global_primitive_id(i);
-						const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
-						const int curr_boundary_id = mesh_.get_boundary_id(primitive_global_id);
-
-						if (curr_boundary_id != boundary_id)
-							continue;
-
-						bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-						if (mesh_.is_volume())
-							weights /= 2 * mesh_.tri_area(primitive_global_id);
-						else
-							weights /= mesh_.edge_length(primitive_global_id);
-						g_3.setZero(normals.rows(), normals.cols());
-
-						if (!has_samples)
-							continue;
-
-						global_primitive_ids.setConstant(weights.size(), primitive_global_id);
-
-						vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-						for (int n = 0; n < vals.jac_it.size(); ++n)
-						{
-							trafo = vals.jac_it[n].inverse();
-
-							if (displacement.size() > 0)
-							{
-								assert(size_ == 2 || size_ == 3);
-								deform_mat.resize(size_, size_);
-								deform_mat.setZero();
-								for (const auto &b : vals.basis_values)
-								{
-									for (const auto &g : b.global)
-									{
-										for (int d = 0; d < size_; ++d)
-										{
-											deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
-										}
-									}
-								}
-
-								trafo += deform_mat;
-							}
-
-							normals.row(n) = normals.row(n) * trafo.inverse();
-							normals.row(n).normalize();
-
-							if (mesh_.is_volume())
-							{
-								Eigen::Vector3d g1, g2, g3;
-								auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
-								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
-								g2 = trafo * (endpoints.row(0) - endpoints.row(2)).transpose();
-								if (lb[i] == 0)
-									g1 *= -1;
-								g3 = g1.cross(g2);
-								g_3.row(n) = g3.transpose();
-							}
-							else
-							{
-								Eigen::Vector2d g1, g3;
-								auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(lb[i]);
-								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
-								g3(0) = -g1(1);
-								g3(1) = g1(0);
-								g_3.row(n) = g3.transpose();
-							}
-						}
-
-						if (multiply_pressure)
-							problem_.pressure_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, pressure_vals);
-						else
-							pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
-
-						for (long n = 0; n < nodes.size(); ++n)
-						{
-							const AssemblyValues &v = vals.basis_values[nodes(n)];
-							for (int d = 0; d < size_; ++d)
-							{
-								for (size_t g = 0; g < v.global.size(); ++g)
-								{
-									const int g_index = v.global[g].index * size_ + d;
-									const bool is_dof_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), g_index) != dirichlet_nodes.end();
-									if (is_dof_dirichlet)
-										continue;
-
-									for (long p = 0; p < weights.size(); ++p)
-									{
-										local_storage.vec(g_index) += pressure_vals(p) * g_3(p, d) * v.val(p) * weights(p);
-									}
-								}
-							}
-						}
-					}
-				}
-			});
-			for (const LocalThreadVecStorage &local_storage : storage)
-				grad += local_storage.vec;
+			compute_grad_volume(displacement, local_boundary, dirichlet_nodes, resolution, grad, t, multiply_pressure, boundary_id);
 		}
 
-		void PressureAssembler::compute_hess_volume_3d(
+		template <int DIM>
+		void PressureAssembler::compute_hess_volume(
 			const Eigen::MatrixXd &displacement,
 			const std::vector<mesh::LocalBoundary> &local_boundary,
 			const std::vector<int> &dirichlet_nodes,
@@ -471,167 +395,107 @@ namespace polyfem
 			const double t,
 			const bool multiply_pressure) const
 		{
-			hess.resize(n_basis_ * size_, n_basis_ * size_);
+			typedef Eigen::Matrix<double, DIM, DIM> MatrixD;
 
-			auto storage = create_thread_storage(LocalThreadMatStorage());
+			const std::shared_ptr<SurfaceQuadrature> surface = surface_quadrature(local_boundary, resolution);
+			const std::vector<bool> is_dirichlet = dirichlet_mask(dirichlet_nodes);
 
-			utils::maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
+			// the faces scatter in the pattern of the first assembly, not thread safe for a surface
+			SparseMatrixCache &mat_cache = surface->hessian_cache;
+			mat_cache.init(n_basis_ * size_);
+			mat_cache.set_zero();
+			const bool use_pattern = mat_cache.has_pattern();
+
+			auto storage = create_thread_storage(LocalThreadMatStorage(mat_cache));
+
+			utils::maybe_parallel_for(surface->faces.size(), [&](int start, int end, int thread_id) {
 				LocalThreadMatStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
-				Eigen::MatrixXd pressure_vals, g_1, g_2, g_3, local_hessian;
-				ElementAssemblyValues vals;
-				Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
-				Eigen::VectorXd weights;
-				Eigen::VectorXi global_primitive_ids;
-				for (int lb_id = start; lb_id < end; ++lb_id)
+				Eigen::MatrixXd pressure_vals, normals, local_hessian;
+				std::vector<MatrixD> frames, g_3_grad;
+				for (int f = start; f < end; ++f)
 				{
-					const auto &lb = local_boundary[lb_id];
-					const int e = lb.element_id();
-					const basis::ElementBases &gbs = gbases_[e];
-					const basis::ElementBases &bs = bases_[e];
-
-					for (int i = 0; i < lb.size(); ++i)
+					const SurfaceQuadrature::Face &face = surface->faces[f];
+					const ElementAssemblyValues &vals = face.vals;
+					const int n_nodes = face.nodes.size();
+
+					deformed_frames<DIM>(face, displacement, normals, frames);
+					face_pressure(face, normals, t, multiply_pressure, pressure_vals);
+
+					// DIM x DIM blocks (i, j) = phi_i d g_3 / d u_j, the derivative of the deformed normal
+					// is the same for all test functions
+					local_hessian.setZero(n_nodes * DIM, n_nodes * DIM);
+					g_3_grad.resize(n_nodes);
+					for (long p = 0; p < face.weights.size(); ++p)
 					{
-						const int primitive_global_id = lb.global_primitive_id(i);
-						const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
+						const double scale = pressure_vals(p) * face.weights(p);
 
-						bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-						std::vector<Eigen::VectorXd> param_chain_rule;
-						if (mesh_.is_volume())
+						if constexpr (DIM == 3)
 						{
-							weights /= 2 * mesh_.tri_area(primitive_global_id);
-							g_1.setZero(normals.rows(), normals.cols());
-							g_2.setZero(normals.rows(), normals.cols());
-							g_3.setZero(normals.rows(), normals.cols());
-
-							auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
-							param_chain_rule = {(endpoints.row(0) - endpoints.row(1)).transpose(), (endpoints.row(0) - endpoints.row(2)).transpose()};
-							if (lb[i] == 0)
-								param_chain_rule[0] *= -1;
-						}
-						else
-							assert(false);
-
-						if (!has_samples)
-							continue;
-
-						global_primitive_ids.setConstant(weights.size(), primitive_global_id);
-
-						vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-						for (int n = 0; n < vals.jac_it.size(); ++n)
-						{
-							trafo = vals.jac_it[n].inverse();
-
-							if (displacement.size() > 0)
-							{
-								assert(size_ == 3);
-								deform_mat.resize(size_, size_);
-								deform_mat.setZero();
-								for (const auto &b : vals.basis_values)
-								{
-									for (const auto &g : b.global)
-									{
-										for (int d = 0; d < size_; ++d)
-										{
-											deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
-										}
-									}
-								}
-
-								trafo += deform_mat;
-							}
-
-							normals.row(n) = normals.row(n) * trafo.inverse();
-							normals.row(n).normalize();
+							Eigen::Vector3d g_up_1, g_up_2;
+							g_dual(frames[p].col(0), frames[p].col(1), g_up_1, g_up_2);
+							const Eigen::Vector3d g_3 = frames[p].col(2);
+							const std::array<Eigen::Matrix3d, 2> g_3_wedge_g_up = {{wedge_product(g_3, g_up_1), wedge_product(g_3, g_up_2)}};
 
-							if (mesh_.is_volume())
+							for (int j = 0; j < n_nodes; ++j)
 							{
-								Eigen::Vector3d g1, g2, g3;
-								auto endpoints = utils::BoundarySampler::tet_local_node_coordinates_from_face(lb[i]);
-								g1 = trafo * (endpoints.row(0) - endpoints.row(1)).transpose();
-								g2 = trafo * (endpoints.row(0) - endpoints.row(2)).transpose();
-								if (lb[i] == 0)
-									g1 *= -1;
-								g3 = g1.cross(g2);
-
-								g_1.row(n) = g1.transpose();
-								g_2.row(n) = g2.transpose();
-								g_3.row(n) = g3.transpose();
+								const Eigen::RowVector2d s = vals.basis_values[face.nodes(j)].grad.row(p) * face.tangents;
+								g_3_grad[j] = scale * (s(0) * g_3_wedge_g_up[0] + s(1) * g_3_wedge_g_up[1]);
 							}
-							else
-								assert(false);
 						}
-
-						if (multiply_pressure)
-							problem_.pressure_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, pressure_vals);
 						else
-							pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
-
-						local_hessian.setZero(vals.basis_values.size() * size_, vals.basis_values.size() * size_);
-
-						for (long p = 0; p < weights.size(); ++p)
 						{
-							Eigen::Vector3d g_up_1, g_up_2;
-							g_dual(g_1.row(p).transpose(), g_2.row(p).transpose(), g_up_1, g_up_2);
-							std::vector<Eigen::MatrixXd> g_3_wedge_g_up = {wedge_product(g_3.row(p), g_up_1), wedge_product(g_3.row(p), g_up_2)};
+							// rotation by pi/2 of the derivative of the tangent
+							MatrixD rotation;
+							rotation << 0, -1, 1, 0;
 
-							for (long ni = 0; ni < nodes.size(); ++ni)
+							for (int j = 0; j < n_nodes; ++j)
 							{
-								const AssemblyValues &vi = vals.basis_values[nodes(ni)];
-								for (int di = 0; di < size_; ++di)
-								{
-									const int gi_index = vi.global[0].index * size_ + di;
-									const bool is_dof_i_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), gi_index) != dirichlet_nodes.end();
-									if (is_dof_i_dirichlet)
-										continue;
-
-									Eigen::MatrixXd grad_phi_i;
-									grad_phi_i.setZero(3, 3);
-									grad_phi_i.row(di) = vi.grad.row(p);
-
-									for (long nj = 0; nj < nodes.size(); ++nj)
-									{
-										const AssemblyValues &vj = vals.basis_values[nodes(nj)];
-										for (int dj = 0; dj < size_; ++dj)
-										{
-											const int gj_index = vj.global[0].index * size_ + dj;
-											const bool is_dof_j_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), gj_index) != dirichlet_nodes.end();
-											if (is_dof_j_dirichlet)
-												continue;
-
-											Eigen::MatrixXd grad_phi_j;
-											grad_phi_j.setZero(3, 3);
-											grad_phi_j.row(dj) = vj.grad.row(p);
-
-											double value = 0;
-											for (int alpha = 0; alpha < size_ - 1; ++alpha)
-											{
-												auto a = vj.val(p) * g_3_wedge_g_up[alpha].row(di) * (grad_phi_i * param_chain_rule[alpha]);
-												auto b = (g_3_wedge_g_up[alpha] * (grad_phi_j * param_chain_rule[alpha])).row(di) * vi.val(p);
-												value += pressure_vals(p) * (a(0) + b(0)) * weights(p);
-											}
-											local_hessian(nodes(ni) * size_ + di, nodes(nj) * size_ + dj) += value;
-										}
-									}
-								}
+								const double s = vals.basis_values[face.nodes(j)].grad.row(p).dot(face.tangents.col(0));
+								g_3_grad[j] = (scale * s) * rotation;
 							}
 						}
 
-						for (long ni = 0; ni < nodes.size(); ++ni)
+						for (int i = 0; i < n_nodes; ++i)
+						{
+							const double phi_i = vals.basis_values[face.nodes(i)].val(p);
+							for (int j = 0; j < n_nodes; ++j)
+								local_hessian.template block<DIM, DIM>(i * DIM, j * DIM) += phi_i * g_3_grad[j];
+						}
+					}
+
+					const std::vector<StorageIndex> *slots = nullptr;
+					double *values = nullptr;
+					int slot = 0;
+					if (use_pattern)
+					{
+						SparseMatrixCache &local_cache = static_cast<SparseMatrixCache &>(*local_storage.cache);
+						slots = &local_cache.element_slots(f);
+						values = local_cache.values_data();
+					}
+
+					for (int i = 0; i < n_nodes; ++i)
+					{
+						const int gi_node = vals.basis_values[face.nodes(i)].global[0].index * DIM;
+						for (int di = 0; di < DIM; ++di)
 						{
-							const AssemblyValues &vi = vals.basis_values[nodes(ni)];
-							for (int di = 0; di < size_; ++di)
+							const int gi_index = gi_node + di;
+							for (int j = 0; j < n_nodes; ++j)
 							{
-								const int gi_index = vi.global[0].index * size_ + di;
-								for (long nj = 0; nj < nodes.size(); ++nj)
+								const int gj_node = vals.basis_values[face.nodes(j)].global[0].index * DIM;
+								for (int dj = 0; dj < DIM; ++dj)
 								{
-									const AssemblyValues &vj = vals.basis_values[nodes(nj)];
-									for (int dj = 0; dj < size_; ++dj)
-									{
-										const int gj_index = vj.global[0].index * size_ + dj;
+									const int gj_index = gj_node + dj;
+									// the Dirichlet entries are zero, they stay in the pattern
+									const double value = (is_dirichlet[gi_index] || is_dirichlet[gj_index]) ? 0 : local_hessian(i * DIM + di, j * DIM + dj);
 
-										local_storage.entries.push_back(Eigen::Triplet<double>(gi_index, gj_index, local_hessian(nodes(ni) * size_ + di, nodes(nj) * size_ + dj)));
+									if (slots)
+									{
+										assert(slot < slots->size());
+										values[(*slots)[slot++]] += value;
 									}
+									else
+										local_storage.cache->add_value(f, gi_index, gj_index, value);
 								}
 							}
 						}
@@ -639,17 +503,25 @@ namespace polyfem
 				}
 			});
 
-			std::vector<Eigen::Triplet<double>> all_entries;
-			// Serially merge local storages
-			for (LocalThreadMatStorage &local_storage : storage)
+			if (use_pattern)
 			{
-				all_entries.insert(all_entries.end(), local_storage.entries.begin(), local_storage.entries.end());
+				std::vector<const SparseMatrixCache *> local_caches;
+				for (const LocalThreadMatStorage &local_storage : storage)
+					local_caches.push_back(static_cast<const SparseMatrixCache *>(local_storage.cache.get()));
+				mat_cache.accumulate(local_caches);
 			}
-
-			hess.setFromTriplets(all_entries.begin(), all_entries.end());
+			else
+			{
+				for (LocalThreadMatStorage &local_storage : storage)
+				{
+					local_storage.cache->prune();
+					mat_cache += *local_storage.cache;
+				}
+			}
+			hess = mat_cache.get_matrix();
 		}
 
-		void PressureAssembler::compute_hess_volume_2d(
+		void PressureAssembler::compute_hess_volume(
 			const Eigen::MatrixXd &displacement,
 			const std::vector<mesh::LocalBoundary> &local_boundary,
 			const std::vector<int> &dirichlet_nodes,
@@ -658,164 +530,21 @@ namespace polyfem
 			const double t,
 			const bool multiply_pressure) const
 		{
-			hess.resize(n_basis_ * size_, n_basis_ * size_);
-
-			auto storage = create_thread_storage(LocalThreadMatStorage());
-
-			utils::maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
-				LocalThreadMatStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
-
-				Eigen::MatrixXd pressure_vals, g_3_grad, local_hessian;
-				ElementAssemblyValues vals;
-				Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
-				Eigen::VectorXd weights;
-				Eigen::VectorXi global_primitive_ids;
-				for (int lb_id = start; lb_id < end; ++lb_id)
-				{
-					const auto &lb = local_boundary[lb_id];
-					const int e = lb.element_id();
-					const basis::ElementBases &gbs = gbases_[e];
-					const basis::ElementBases &bs = bases_[e];
-
-					for (int i = 0; i < lb.size(); ++i)
-					{
-						const int primitive_global_id = lb.global_primitive_id(i);
-						const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
-
-						bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-						std::vector<Eigen::VectorXd> param_chain_rule;
-
-						if (!has_samples)
-							continue;
-
-						if (mesh_.is_volume())
-							assert(false);
-						else
-							weights /= mesh_.edge_length(primitive_global_id);
-
-						global_primitive_ids.setConstant(weights.size(), primitive_global_id);
-
-						vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-						g_3_grad.setZero(normals.rows(), size_ * vals.basis_values.size() * size_);
-
-						for (int n = 0; n < vals.jac_it.size(); ++n)
-						{
-							trafo = vals.jac_it[n].inverse();
-
-							if (displacement.size() > 0)
-							{
-								assert(size_ == 2);
-								deform_mat.resize(size_, size_);
-								deform_mat.setZero();
-								for (const auto &b : vals.basis_values)
-								{
-									for (const auto &g : b.global)
-									{
-										for (int d = 0; d < size_; ++d)
-										{
-											deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
-										}
-									}
-								}
-
-								trafo += deform_mat;
-							}
-
-							normals.row(n) = normals.row(n) * trafo.inverse();
-							normals.row(n).normalize();
-
-							if (mesh_.is_volume())
-								assert(false);
-							else
-							{
-								Eigen::MatrixXd g_3_grad_local(size_, vals.basis_values.size() * size_);
-								g_3_grad_local.setZero();
-								auto endpoints = utils::BoundarySampler::tri_local_node_coordinates_from_edge(lb[i]);
-								Eigen::VectorXd reference_normal = (endpoints.row(0) - endpoints.row(1)).transpose();
-								int b_count = 0;
-								for (const auto &b : vals.basis_values)
-								{
-									for (const auto &g : b.global)
-										for (int d = 0; d < size_; ++d)
-											for (int k = 0; k < size_; ++k)
-												g_3_grad_local(1 - d, b_count * size_ + d) += b.grad(n, k) * reference_normal(k);
-									++b_count;
-								}
-								g_3_grad_local.row(0) *= -1;
-
-								for (int k = 0; k < size_; ++k)
-									for (int l = 0; l < vals.basis_values.size() * size_; ++l)
-										g_3_grad(n, k * (vals.basis_values.size() * size_) + l) = g_3_grad_local(k, l);
-							}
-						}
-
-						if (multiply_pressure)
-							problem_.pressure_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, pressure_vals);
-						else
-							pressure_vals = Eigen::MatrixXd::Ones(weights.size(), 1);
-
-						local_hessian.setZero(vals.basis_values.size() * size_, vals.basis_values.size() * size_);
-
-						for (long p = 0; p < weights.size(); ++p)
-						{
-							for (long ni = 0; ni < nodes.size(); ++ni)
-							{
-								const AssemblyValues &vi = vals.basis_values[nodes(ni)];
-								for (int di = 0; di < size_; ++di)
-								{
-									const int gi_index = vi.global[0].index * size_ + di;
-									const bool is_dof_i_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), gi_index) != dirichlet_nodes.end();
-									if (is_dof_i_dirichlet)
-										continue;
-
-									for (long nj = 0; nj < nodes.size(); ++nj)
-									{
-										const AssemblyValues &vj = vals.basis_values[nodes(nj)];
-										for (int dj = 0; dj < size_; ++dj)
-										{
-											const int gj_index = vj.global[0].index * size_ + dj;
-											const bool is_dof_j_dirichlet = std::find(dirichlet_nodes.begin(), dirichlet_nodes.end(), gj_index) != dirichlet_nodes.end();
-											if (is_dof_j_dirichlet)
-												continue;
-
-											double value = pressure_vals(p) * g_3_grad(p, (di * vals.basis_values.size() * size_) + nodes(nj) * size_ + dj) * vi.val(p) * weights(p);
-											local_hessian(nodes(ni) * size_ + di, nodes(nj) * size_ + dj) += value;
-										}
-									}
-								}
-							}
-						}
-
-						for (long ni = 0; ni < nodes.size(); ++ni)
-						{
-							const AssemblyValues &vi = vals.basis_values[nodes(ni)];
-							for (int di = 0; di < size_; ++di)
-							{
-								const int gi_index = vi.global[0].index * size_ + di;
-								for (long nj = 0; nj < nodes.size(); ++nj)
-								{
-									const AssemblyValues &vj = vals.basis_values[nodes(nj)];
-									for (int dj = 0; dj < size_; ++dj)
-									{
-										const int gj_index = vj.global[0].index * size_ + dj;
-
-										local_storage.entries.push_back(Eigen::Triplet<double>(gi_index, gj_index, local_hessian(nodes(ni) * size_ + di, nodes(nj) * size_ + dj)));
-									}
-								}
-							}
-						}
-					}
-				}
-			});
+			if (size_ == 2)
+				compute_hess_volume<2>(displacement, local_boundary, dirichlet_nodes, resolution, hess, t, multiply_pressure);
+			else if (size_ == 3)
+				compute_hess_volume<3>(displacement, local_boundary, dirichlet_nodes, resolution, hess, t, multiply_pressure);
+		}
 
-			std::vector<Eigen::Triplet<double>> all_entries;
-			// Serially merge local storages
-			for (LocalThreadMatStorage &local_storage : storage)
+		std::vector<bool> PressureAssembler::dirichlet_mask(const std::vector<int> &dirichlet_nodes) const
+		{
+			std::vector<bool> is_dirichlet(n_basis_ * size_, false);
+			for (const int i : dirichlet_nodes)
 			{
-				all_entries.insert(all_entries.end(), local_storage.entries.begin(), local_storage.entries.end());
+				if (i < is_dirichlet.size())
+					is_dirichlet[i] = true;
 			}
-
-			hess.setFromTriplets(all_entries.begin(), all_entries.end());
+			return is_dirichlet;
 		}
 
 		bool PressureAssembler::is_closed_or_boundary_fixed(
@@ -984,7 +713,51 @@ namespace polyfem
 				log_and_throw_error("Cannot project caivity pressure to PSD!");
 			}
 
+			Eigen::MatrixXd U;
+			Eigen::VectorXd coeffs;
+			compute_cavity_energy_hess(displacement, local_pressure_cavity, dirichlet_nodes, resolution, t, project_to_psd, hess, U, coeffs);
+
+			// add the low-rank part only on the support of the volume gradients instead of densifying the full outer product
+			std::vector<Eigen::Triplet<double>> entries;
+			for (int k = 0; k < U.cols(); ++k)
+			{
+				std::vector<int> support;
+				for (int i = 0; i < U.rows(); ++i)
+					if (U(i, k) != 0)
+						support.push_back(i);
+
+				entries.reserve(entries.size() + support.size() * support.size());
+				for (const int i : support)
+					for (const int j : support)
+						entries.emplace_back(i, j, coeffs(k) * U(i, k) * U(j, k));
+			}
+
+			StiffnessMatrix low_rank(hess.rows(), hess.cols());
+			low_rank.setFromTriplets(entries.begin(), entries.end());
+			hess += low_rank;
+		}
+
+		void PressureAssembler::compute_cavity_energy_hess(
+			const Eigen::MatrixXd &displacement,
+			const std::unordered_map<int, std::vector<mesh::LocalBoundary>> &local_pressure_cavity,
+			const std::vector<int> &dirichlet_nodes,
+			const int resolution,
+			const double t,
+			const bool project_to_psd,
+			StiffnessMatrix &hess,
+			Eigen::MatrixXd &U,
+			Eigen::VectorXd &coeffs) const
+		{
+			if (project_to_psd && (local_pressure_cavity.size() > 0))
+			{
+				log_and_throw_error("Cannot project caivity pressure to PSD!");
+			}
+
 			hess.resize(displacement.size(), displacement.size());
+			U.resize(displacement.size(), local_pressure_cavity.size());
+			coeffs.resize(local_pressure_cavity.size());
+
+			int k = 0;
 			for (const auto &v : local_pressure_cavity)
 			{
 				double start_pressure = problem_.pressure_cavity_bc(v.first, t);
@@ -994,10 +767,7 @@ namespace polyfem
 				StiffnessMatrix h;
 
 				compute_grad_volume(displacement, v.second, dirichlet_nodes, resolution, g, t, false);
-				if (size_ == 2)
-					compute_hess_volume_2d(displacement, v.second, dirichlet_nodes, resolution, h, t, false);
-				else if (size_ == 3)
-					compute_hess_volume_3d(displacement, v.second, dirichlet_nodes, resolution, h, t, false);
+				compute_hess_volume(displacement, v.second, dirichlet_nodes, resolution, h, t, false);
 
 				double p = -cavity_thermodynamics_->pressure(
 					-start_pressure, -start_volume, -curr_volume);
@@ -1005,7 +775,9 @@ namespace polyfem
 					-start_pressure, -start_volume, -curr_volume);
 
 				hess += p * h;
-				hess += dp_dv * (g * g.transpose()).sparseView();
+				U.col(k) = g;
+				coeffs(k) = dp_dv;
+				++k;
 			}
 		}
 
@@ -1038,10 +810,7 @@ namespace polyfem
 			const bool project_to_psd,
 			StiffnessMatrix &hess) const
 		{
-			if (size_ == 2)
-				compute_hess_volume_2d(displacement, local_pressure_boundary, dirichlet_nodes, resolution, hess, t, true);
-			else if (size_ == 3)
-				compute_hess_volume_3d(displacement, local_pressure_boundary, dirichlet_nodes, resolution, hess, t, true);
+			compute_hess_volume(displacement, local_pressure_boundary, dirichlet_nodes, resolution, hess, t, true);
 		}
 
 		void PressureAssembler::compute_force_jacobian(
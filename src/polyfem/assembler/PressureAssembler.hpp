@@ -6,6 +6,11 @@
 #include <polyfem/assembler/Problem.hpp>
 #include <polyfem/assembler/MatParams.hpp>
 #include <polyfem/mesh/LocalBoundary.hpp>
+#include <polyfem/utils/MatrixCache.hpp>
+
+#include <memory>
+#include <mutex>
+#include <optional>
 
 namespace polyfem
 {
@@ -126,6 +131,18 @@ namespace polyfem
 				const double t,
 				const bool project_to_psd,
 				StiffnessMatrix &hess) const;
+			/// cavity Hessian split into a sparse part and a low-rank part, hess + U diag(coeffs) Uᵀ,
+			/// with one column of U (the volume gradient) per cavity; the low-rank part is dense over the cavity boundary
+			void compute_cavity_energy_hess(
+				const Eigen::MatrixXd &displacement,
+				const std::unordered_map<int, std::vector<mesh::LocalBoundary>> &local_pressure_cavity,
+				const std::vector<int> &dirichlet_nodes,
+				const int resolution,
+				const double t,
+				const bool project_to_psd,
+				StiffnessMatrix &hess,
+				Eigen::MatrixXd &U,
+				Eigen::VectorXd &coeffs) const;
 
 			void compute_force_jacobian(
 				const Eigen::MatrixXd &displacement,
@@ -158,14 +175,16 @@ namespace polyfem
 				const int resolution,
 				const double t = 0,
 				const bool multiply_pressure = false) const;
+			// gradient of the volume, only of the faces with boundary_id if set
 			void compute_grad_volume(const Eigen::MatrixXd &displacement,
 									 const std::vector<mesh::LocalBoundary> &local_boundary,
 									 const std::vector<int> &dirichlet_nodes,
 									 const int resolution,
 									 Eigen::VectorXd &grad,
 									 const double t = 0,
-									 const bool multiply_pressure = false) const;
-			void compute_hess_volume_3d(
+									 const bool multiply_pressure = false,
+									 const std::optional<int> &boundary_id = std::nullopt) const;
+			void compute_hess_volume(
 				const Eigen::MatrixXd &displacement,
 				const std::vector<mesh::LocalBoundary> &local_boundary,
 				const std::vector<int> &dirichlet_nodes,
@@ -173,14 +192,67 @@ namespace polyfem
 				StiffnessMatrix &hess,
 				const double t = 0,
 				const bool multiply_pressure = false) const;
-			void compute_hess_volume_2d(
+			template <int DIM>
+			void compute_hess_volume(
 				const Eigen::MatrixXd &displacement,
 				const std::vector<mesh::LocalBoundary> &local_boundary,
 				const std::vector<int> &dirichlet_nodes,
 				const int resolution,
 				StiffnessMatrix &hess,
-				const double t = 0,
-				const bool multiply_pressure = false) const;
+				const double t,
+				const bool multiply_pressure) const;
+
+			// quadrature points and assembly values of a pressure surface, they depend only on the boundary and the resolution
+			struct SurfaceQuadrature
+			{
+				// one boundary face (edge in 2d) with quadrature points
+				struct Face
+				{
+					int element_id;
+					int global_primitive_id;
+					int boundary_id;
+					Eigen::MatrixXd uv;
+					Eigen::MatrixXd points;
+					Eigen::MatrixXd normals;  ///< in the reference element
+					Eigen::VectorXd weights;  ///< divided by the measure of the primitive
+					Eigen::MatrixXd tangents; ///< reference tangents of the face, one per column
+					Eigen::VectorXi nodes;    ///< local bases of the face
+					ElementAssemblyValues vals;
+				};
+
+				// key of the cache
+				std::vector<int> boundary_primitives; ///< element and primitives of every local boundary
+				int resolution = -1;
+
+				std::vector<Face> faces;
+				utils::SparseMatrixCache hessian_cache; ///< pattern of the Hessian, frozen by the first assembly, faces are its elements
+			};
+			// quadrature of a surface at resolution, built on first use, one per surface (pressure boundary, cavities) and resolution
+			std::shared_ptr<SurfaceQuadrature> surface_quadrature(const std::vector<mesh::LocalBoundary> &local_boundary, const int resolution) const;
+
+			// deformed normals and covariant basis at the quadrature points of a face, the last column of a frame is the
+			// normal scaled by the area (g_3), the others are the deformed tangents
+			template <int DIM>
+			void deformed_frames(
+				const SurfaceQuadrature::Face &face,
+				const Eigen::MatrixXd &displacement,
+				Eigen::MatrixXd &normals,
+				std::vector<Eigen::Matrix<double, DIM, DIM>> &frames) const;
+			// deformed normals and g_3 at the quadrature points of a face, one per row
+			void deformed_normals(
+				const SurfaceQuadrature::Face &face,
+				const Eigen::MatrixXd &displacement,
+				Eigen::MatrixXd &normals,
+				Eigen::MatrixXd &g_3) const;
+			// pressure at the quadrature points of a face, one if not multiply_pressure
+			void face_pressure(
+				const SurfaceQuadrature::Face &face,
+				const Eigen::MatrixXd &normals,
+				const double t,
+				const bool multiply_pressure,
+				Eigen::MatrixXd &pressure_vals) const;
+
+			std::vector<bool> dirichlet_mask(const std::vector<int> &dirichlet_nodes) const;
 
 			bool is_closed_or_boundary_fixed(
 				const std::vector<mesh::LocalBoundary> &local_boundary,
@@ -202,6 +274,9 @@ namespace polyfem
 			const std::vector<int> primitive_to_nodes_;
 			const std::vector<int> node_to_primitives_;
 			std::set<int> relevant_pressure_nodes_;
+
+			mutable std::vector<std::shared_ptr<SurfaceQuadrature>> surface_quadratures_;
+			mutable std::mutex surface_quadrature_mutex_;
 		};
 	} // namespace assembler
 } // namespace polyfem
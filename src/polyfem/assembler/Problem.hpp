@@ -50,6 +50,17 @@ namespace polyfem
 			virtual bool is_time_dependent() const { return false; }
 			virtual bool is_constant_in_time() const { return true; }
 
+			/// true if the body force rhs does not depend on the time
+			virtual bool is_rhs_time_independent() const { return is_constant_in_time(); }
+			/// @brief number of time-independent parts of the Neumann loads, they are split as
+			/// neumann_bc(t) = sum_k neumann_time_factor(k, t) * neumann_bc_part(k)
+			/// @return -1 if the loads cannot be split (e.g., expressions of t or loads along the deformed normals)
+			virtual int n_neumann_time_parts() const { return -1; }
+			/// time-independent part k of the Neumann loads, the arguments are the ones of neumann_bc
+			virtual void neumann_bc_part(const int k, const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const {}
+			/// time-only factor of the part k of the Neumann loads
+			virtual double neumann_time_factor(const int k, const double t) const { return 1; }
+
 			virtual void initial_solution(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const {}
 			virtual void initial_velocity(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const {}
 			virtual void initial_acceleration(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const {}
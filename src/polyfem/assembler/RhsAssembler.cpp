@@ -1,9 +1,11 @@
 #include "RhsAssembler.hpp"
 
+#include <polyfem/assembler/AssemblerUtils.hpp>
 #include <polyfem/assembler/Mass.hpp>
 #include <polyfem/utils/BoundarySampler.hpp>
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/par_for.hpp>
 #include <ipc/utils/eigen_ext.hpp>
 #include <polysolve/linear/Solver.hpp>
 
@@ -23,12 +25,97 @@ namespace polyfem
 			public:
 				double val;
 				ElementAssemblyValues vals;
+				Eigen::VectorXd da;
+				/// per-primitive temporaries, kept to reuse their allocation
+				Eigen::MatrixXd forces, normals;
+				Eigen::VectorXi global_primitive_ids;
 
 				LocalThreadScalarStorage()
 				{
 					val = 0;
 				}
 			};
+
+			class LocalThreadVecStorage
+			{
+			public:
+				Eigen::MatrixXd vec;
+				ElementAssemblyValues vals;
+				/// per-element temporaries, kept to reuse their allocation
+				Eigen::MatrixXd rhs_fun, normals;
+				Eigen::VectorXi global_primitive_ids;
+
+				LocalThreadVecStorage(const int rows, const int cols)
+				{
+					vec.setZero(rows, cols);
+				}
+			};
+
+			/// @brief calls assemble(i, local_storage, vec) for every i in [0, n) in parallel, every call adds its contribution to vec
+			/// The contributions are summed in thread-local vectors, or directly in rhs by colors of items sharing no basis
+			/// when the thread-local vectors would take too much memory
+			/// @param colors returns the colors of the items, only called if they are needed
+			template <typename Colors, typename Assemble>
+			void parallel_scatter(const int n, const Colors &colors, const Assemble &assemble, Eigen::MatrixXd &rhs)
+			{
+				const bool use_coloring = get_n_threads() > 1 && long(get_n_threads()) * rhs.size() > AssemblerUtils::COLORING_MIN_SCRATCH;
+				auto storage = create_thread_storage(LocalThreadVecStorage(use_coloring ? 0 : rhs.rows(), use_coloring ? 0 : rhs.cols()));
+
+				if (use_coloring)
+				{
+					for (const std::vector<int> &color : colors())
+					{
+						maybe_parallel_for(int(color.size()), [&](int start, int end, int thread_id) {
+							LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+							for (int i = start; i < end; ++i)
+								assemble(color[i], local_storage, rhs);
+						});
+					}
+					return;
+				}
+
+				maybe_parallel_for(n, [&](int start, int end, int thread_id) {
+					LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+					for (int i = start; i < end; ++i)
+						assemble(i, local_storage, local_storage.vec);
+				});
+
+				// Serially merge local storages
+				for (const LocalThreadVecStorage &local_storage : storage)
+					rhs += local_storage.vec;
+			}
+
+			/// maps the reference normals at the quadrature points of vals to the normals of the boundary displaced by displacement (if not empty)
+			void displace_normals(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const int size, Eigen::MatrixXd &normals)
+			{
+				Eigen::MatrixXd trafo, deform_mat;
+				for (int n = 0; n < vals.jac_it.size(); ++n)
+				{
+					trafo = vals.jac_it[n].inverse();
+
+					if (displacement.size() > 0)
+					{
+						assert(size == 2 || size == 3);
+						deform_mat.resize(size, size);
+						deform_mat.setZero();
+						for (const auto &b : vals.basis_values)
+						{
+							for (const auto &g : b.global)
+							{
+								for (int d = 0; d < size; ++d)
+								{
+									deform_mat.row(d) += displacement(g.index * size + d) * b.grad.row(n);
+								}
+							}
+						}
+
+						trafo += deform_mat;
+					}
+
+					normals.row(n) = normals.row(n) * trafo.inverse();
+					normals.row(n).normalize();
+				}
+			}
 		} // namespace
 
 		RhsAssembler::RhsAssembler(const Assembler &assembler, const Mesh &mesh, const Obstacle &obstacle,
@@ -38,7 +125,8 @@ namespace polyfem
 								   const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases, const AssemblyValsCache &ass_vals_cache,
 								   const Problem &problem,
 								   const std::string bc_method,
-								   const json &solver_params)
+								   const json &solver_params,
+								   const std::string initial_projection)
 			: assembler_(assembler),
 			  mesh_(mesh),
 			  obstacle_(obstacle),
@@ -50,6 +138,7 @@ namespace polyfem
 			  problem_(problem),
 			  bc_method_(bc_method),
 			  solver_params_(solver_params),
+			  initial_projection_(initial_projection),
 			  dirichlet_nodes_(dirichlet_nodes),
 			  dirichlet_nodes_position_(dirichlet_nodes_position),
 			  neumann_nodes_(neumann_nodes),
@@ -62,53 +151,51 @@ namespace polyfem
 		{
 			// set size of rhs to the number of basis functions * the dimension of the problem
 			rhs = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
-			if (!problem_.is_rhs_zero())
-			{
-				Eigen::MatrixXd rhs_fun;
+			if (problem_.is_rhs_zero())
+				return;
 
-				const int n_elements = int(bases_.size());
-				ElementAssemblyValues vals;
-				for (int e = 0; e < n_elements; ++e)
-				{
-					// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
+			const auto assemble_element = [&](const int e, LocalThreadVecStorage &local_storage, Eigen::MatrixXd &vec) {
+				ElementAssemblyValues &vals = local_storage.vals;
+				Eigen::MatrixXd &rhs_fun = local_storage.rhs_fun;
 
-					// compute geometric mapping
-					// evaluate and store basis functions/their gradients at quadrature points
-					ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
+				// compute geometric mapping
+				// evaluate and store basis functions/their gradients at quadrature points
+				ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
 
-					const Quadrature &quadrature = vals.quadrature;
+				const Quadrature &quadrature = vals.quadrature;
 
-					// compute rhs values in physical space
-					problem_.rhs(assembler_, vals.val, t, rhs_fun);
+				// compute rhs values in physical space
+				problem_.rhs(assembler_, vals.val, t, rhs_fun);
 
-					for (int d = 0; d < size_; ++d)
+				for (int d = 0; d < size_; ++d)
+				{
+					for (int q = 0; q < quadrature.weights.size(); ++q)
 					{
-						// rhs_fun.col(d) = rhs_fun.col(d).array() * vals.det.array() * quadrature.weights.array();
-						for (int q = 0; q < quadrature.weights.size(); ++q)
-						{
-							// const double rho = problem_.is_time_dependent() ? density(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id) : 1;
-							const double rho = density(vals.quadrature.points.row(q), vals.val.row(q), t, vals.element_id);
-							// prepare for integration by weighing rhs by determinant and quadrature weights
-							rhs_fun(q, d) *= vals.det(q) * quadrature.weights(q) * rho;
-						}
+						const double rho = density(vals.quadrature.points.row(q), vals.val.row(q), t, vals.element_id);
+						// prepare for integration by weighing rhs by determinant and quadrature weights
+						rhs_fun(q, d) *= vals.det(q) * quadrature.weights(q) * rho;
 					}
+				}
 
-					const int n_loc_bases_ = int(vals.basis_values.size());
-					for (int i = 0; i < n_loc_bases_; ++i)
-					{
-						const AssemblyValues &v = vals.basis_values[i];
+				const int n_loc_bases_ = int(vals.basis_values.size());
+				for (int i = 0; i < n_loc_bases_; ++i)
+				{
+					const AssemblyValues &v = vals.basis_values[i];
 
-						for (int d = 0; d < size_; ++d)
-						{
-							// integrate rhs function times the given local basis
-							const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
-							for (std::size_t ii = 0; ii < v.global.size(); ++ii)
-								// add local contribution to the global rhs vector (with some weight for non-conforming bases)
-								rhs(v.global[ii].index * size_ + d) += rhs_value * v.global[ii].val;
-						}
+					for (int d = 0; d < size_; ++d)
+					{
+						// integrate rhs function times the given local basis
+						const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
+						for (std::size_t ii = 0; ii < v.global.size(); ++ii)
+							// add local contribution to the global rhs vector (with some weight for non-conforming bases)
+							vec(v.global[ii].index * size_ + d) += rhs_value * v.global[ii].val;
 					}
 				}
-			}
+			};
+
+			parallel_scatter(
+				int(bases_.size()), [&]() { return AssemblerUtils::color_elements(bases_, n_basis_); },
+				assemble_element, rhs);
 		}
 
 		void RhsAssembler::initial_solution(Eigen::MatrixXd &sol) const
@@ -135,58 +222,109 @@ namespace polyfem
 					sol);
 		}
 
+		void RhsAssembler::initial_field(const std::function<void(const Eigen::MatrixXd &, Eigen::MatrixXd &)> &fun, Eigen::MatrixXd &sol) const
+		{
+			time_bc([&](const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) {
+				fun(pts, val);
+			},
+					sol);
+		}
+
 		void RhsAssembler::time_bc(const std::function<void(const Mesh &, const Eigen::MatrixXi &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &fun, Eigen::MatrixXd &sol) const
 		{
 			sol = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
-			Eigen::MatrixXd loc_sol;
 
 			const int n_elements = int(bases_.size());
-			ElementAssemblyValues vals;
-			Eigen::MatrixXi ids;
+			const auto colors = [&]() { return AssemblerUtils::color_elements(bases_, n_basis_); };
 
 			if (bc_method_ == "sample")
 			{
+				// element, local basis and local-to-global of the sample of every node
+				std::vector<std::array<int, 3>> samples(n_basis_, {{-1, -1, -1}});
 				for (int e = 0; e < n_elements; ++e)
 				{
 					const basis::ElementBases &bs = bases_[e];
-					// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-					ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
-					ids.resize(1, 1);
-					ids.setConstant(e);
-
 					for (long i = 0; i < bs.bases.size(); ++i)
 					{
-						const auto &b = bs.bases[i];
-						const auto &glob = b.global();
+						const auto &glob = bs.bases[i].global();
 						// assert(glob.size() == 1);
 						for (size_t ii = 0; ii < glob.size(); ++ii)
+							samples[glob[ii].index] = {{e, int(i), int(ii)}};
+					}
+				}
+
+				maybe_parallel_for(n_basis_, [&](int start, int end, int thread_id) {
+					Eigen::MatrixXd loc_sol;
+					for (int n = start; n < end; ++n)
+					{
+						const auto &[e, i, ii] = samples[n];
+						if (e < 0)
+							continue;
+
+						const auto &glob = bases_[e].bases[i].global()[ii];
+						fun(mesh_, Eigen::MatrixXi::Constant(1, 1, e), glob.node, loc_sol);
+
+						for (int d = 0; d < size_; ++d)
 						{
-							fun(mesh_, ids, glob[ii].node, loc_sol);
+							sol(glob.index * size_ + d) = loc_sol(d) * glob.val;
+						}
+					}
+				});
+			}
+			else if (initial_projection_ == "local")
+			{
+				// the local projections are summed weighted by the element volume, the last n_basis_ rows sum the weights
+				Eigen::MatrixXd acc = Eigen::MatrixXd::Zero(n_basis_ * (size_ + 1), 1);
+
+				const auto project_element = [&](const int e, LocalThreadVecStorage &local_storage, Eigen::MatrixXd &vec) {
+					ElementAssemblyValues &vals = local_storage.vals;
+					Eigen::MatrixXd &loc_sol = local_storage.rhs_fun;
+					ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
+
+					fun(mesh_, Eigen::MatrixXi::Constant(vals.val.rows(), 1, e), vals.val, loc_sol);
+					const Eigen::VectorXd da = vals.det.array() * vals.quadrature.weights.array();
+
+					const int n_loc_bases = int(vals.basis_values.size());
+					Eigen::MatrixXd phi(da.size(), n_loc_bases);
+					for (int i = 0; i < n_loc_bases; ++i)
+						phi.col(i) = vals.basis_values[i].val;
+
+					const Eigen::MatrixXd local_mass = phi.transpose() * da.asDiagonal() * phi;
+					const Eigen::MatrixXd coeffs = local_mass.ldlt().solve(phi.transpose() * da.asDiagonal() * loc_sol);
+					const double volume = da.sum();
 
+					for (int i = 0; i < n_loc_bases; ++i)
+					{
+						for (const auto &g : vals.basis_values[i].global)
+						{
 							for (int d = 0; d < size_; ++d)
-							{
-								sol(glob[ii].index * size_ + d) = loc_sol(d) * glob[ii].val;
-							}
+								vec(g.index * size_ + d) += volume * coeffs(i, d);
+							vec(n_basis_ * size_ + g.index) += volume;
 						}
 					}
+				};
+				parallel_scatter(n_elements, colors, project_element, acc);
+
+				for (int i = 0; i < n_basis_; ++i)
+				{
+					const double weight = acc(n_basis_ * size_ + i);
+					if (weight > 0)
+						sol.middleRows(i * size_, size_) = acc.middleRows(i * size_, size_) / weight;
 				}
 			}
 			else
 			{
+				Eigen::MatrixXd b = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
 
-				for (int e = 0; e < n_elements; ++e)
-				{
-					// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
+				const auto assemble_element = [&](const int e, LocalThreadVecStorage &local_storage, Eigen::MatrixXd &vec) {
+					ElementAssemblyValues &vals = local_storage.vals;
+					Eigen::MatrixXd &loc_sol = local_storage.rhs_fun;
 					ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
-					ids.resize(vals.val.rows(), 1);
-					ids.setConstant(e);
 
-					const Quadrature &quadrature = vals.quadrature;
-					// problem_.initial_solution(vals.val, loc_sol);
-					fun(mesh_, ids, vals.val, loc_sol);
+					fun(mesh_, Eigen::MatrixXi::Constant(vals.val.rows(), 1, e), vals.val, loc_sol);
 
 					for (int d = 0; d < size_; ++d)
-						loc_sol.col(d) = loc_sol.col(d).array() * vals.det.array() * quadrature.weights.array();
+						loc_sol.col(d) = loc_sol.col(d).array() * vals.det.array() * vals.quadrature.weights.array();
 
 					const int n_loc_bases_ = int(vals.basis_values.size());
 					for (int i = 0; i < n_loc_bases_; ++i)
@@ -197,47 +335,49 @@ namespace polyfem
 						{
 							const double sol_value = (loc_sol.col(d).array() * v.val.array()).sum();
 							for (std::size_t ii = 0; ii < v.global.size(); ++ii)
-								sol(v.global[ii].index * size_ + d) += sol_value * v.global[ii].val;
+								vec(v.global[ii].index * size_ + d) += sol_value * v.global[ii].val;
 						}
 					}
-				}
-
-				Eigen::MatrixXd b = sol;
-				sol.setZero();
+				};
+				parallel_scatter(n_elements, colors, assemble_element, b);
 
 				const double mmin = b.minCoeff();
 				const double mmax = b.maxCoeff();
 
 				if (fabs(mmin) > 1e-8 || fabs(mmax) > 1e-8)
 				{
-					assembler::Mass mass_mat_assembler;
-					mass_mat_assembler.set_size(assembler_.size());
-					mass_mat_assembler.add_multimaterial(0, json({}), Units());
-					StiffnessMatrix mass;
-					const int n_fe_basis = n_basis_ - obstacle_.n_vertices();
-					mass_mat_assembler.assemble(size_ == 3, n_fe_basis, bases_, gbases_, ass_vals_cache_, 0, mass, true);
-					assert(mass.rows() == n_basis_ * size_ - obstacle_.ndof() && mass.cols() == n_basis_ * size_ - obstacle_.ndof());
-
-					auto solver = linear::Solver::create(solver_params_, logger());
-					logger().info("Solve RHS using {} linear solver", solver->name());
-					solver->analyze_pattern(mass, mass.rows());
-					solver->factorize(mass);
+					const int n_fe_dofs = n_basis_ * size_ - obstacle_.ndof();
+
+					std::lock_guard<std::mutex> lock(initial_mass_mutex_);
+					if (!initial_mass_solver_)
+					{
+						assembler::Mass mass_mat_assembler;
+						mass_mat_assembler.set_size(assembler_.size());
+						mass_mat_assembler.add_multimaterial(0, json({}), Units());
+						StiffnessMatrix mass;
+						const int n_fe_basis = n_basis_ - obstacle_.n_vertices();
+						mass_mat_assembler.assemble(size_ == 3, n_fe_basis, bases_, gbases_, ass_vals_cache_, 0, mass, true);
+						assert(mass.rows() == n_fe_dofs && mass.cols() == n_fe_dofs);
+
+						initial_mass_solver_ = linear::Solver::create(solver_params_, logger());
+						logger().info("Solve RHS using {} linear solver", initial_mass_solver_->name());
+						initial_mass_solver_->analyze_pattern(mass, mass.rows());
+						initial_mass_solver_->factorize(mass);
+					}
 
 					for (long i = 0; i < b.cols(); ++i)
 					{
-						solver->solve(b.block(0, i, mass.rows(), 1), sol.block(0, i, mass.rows(), 1));
+						initial_mass_solver_->solve(b.block(0, i, n_fe_dofs, 1), sol.block(0, i, n_fe_dofs, 1));
 					}
-					logger().trace("mass matrix error {}", (mass * sol - b).norm());
 				}
 			}
 		}
 
-		void RhsAssembler::lsq_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
-								  const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const
+		void RhsAssembler::build_lsq_bc_cache(const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, std::vector<int> &&boundary_primitives) const
 		{
 			const int n_el = int(bases_.size());
 
-			Eigen::MatrixXd uv, samples, gtmp, rhs_fun;
+			Eigen::MatrixXd uv, samples;
 			Eigen::VectorXi global_primitive_ids;
 
 			const int actual_dim = problem_.is_scalar() ? 1 : mesh_.dimension();
@@ -256,15 +396,40 @@ namespace polyfem
 			}
 			assert(skipped_count <= 1);
 
+			lsq_bc_cache_ = std::make_unique<LSQBCCache>();
+			LSQBCCache &cache = *lsq_bc_cache_;
+			cache.boundary_primitives = std::move(boundary_primitives);
+			cache.boundary_nodes = bounday_nodes;
+			cache.resolution = resolution;
+
+			// samples and basis values do not depend on the dimension
+			std::vector<int> sampled_elements;
+			std::vector<std::vector<AssemblyValues>> basis_values;
+			for (const auto &lb : local_boundary)
+			{
+				const int e = lb.element_id();
+				bool has_samples = utils::BoundarySampler::sample_boundary(lb, resolution, mesh_, false, uv, samples, global_primitive_ids);
+
+				if (!has_samples)
+					continue;
+
+				LSQBCCache::Samples &s = cache.samples.emplace_back();
+				s.global_primitive_ids = global_primitive_ids;
+				s.uv = uv;
+				gbases_[e].eval_geom_mapping(samples, s.mapped);
+
+				sampled_elements.push_back(e);
+				bases_[e].evaluate_bases(samples, basis_values.emplace_back());
+			}
+
+			cache.dims.resize(size_);
 			for (int d = 0; d < size_; ++d)
 			{
-				int index = 0;
-				std::vector<int> indices;
-				indices.reserve(n_el * 10);
-				std::vector<int> tags;
-				tags.reserve(n_el * 10);
+				LSQBCCache::Dimension &dim = cache.dims[d];
 
-				long total_size = 0;
+				int index = 0;
+				dim.indices.reserve(n_el * 10);
+				dim.tags.reserve(n_el * 10);
 
 				Eigen::VectorXi global_index_to_col(n_basis_);
 				global_index_to_col.setConstant(-1);
@@ -290,8 +455,6 @@ namespace polyfem
 						if (!problem_.all_dimensions_dirichlet() && !problem_.is_dimension_dirichet(tag, d))
 							continue;
 
-						total_size++;
-
 						for (int j = 0; j < n_local_bases; ++j)
 						{
 							const basis::Basis &b = bs.bases[j];
@@ -308,9 +471,9 @@ namespace polyfem
 									if (global_index_to_col(b.global()[ii].index) == -1)
 									{
 										global_index_to_col(b.global()[ii].index) = index++;
-										indices.push_back(b.global()[ii].index);
-										tags.push_back(tag);
-										assert(indices.size() == size_t(index));
+										dim.indices.push_back(b.global()[ii].index);
+										dim.tags.push_back(tag);
+										assert(dim.indices.size() == size_t(index));
 									}
 								}
 							}
@@ -318,104 +481,110 @@ namespace polyfem
 					}
 				}
 
-				Eigen::MatrixXd global_rhs = Eigen::MatrixXd::Zero(total_size, 1);
-
-				const long buffer_size = total_size * long(indices.size());
-				std::vector<Eigen::Triplet<double>> entries, entries_t;
-
-				index = 0;
+				std::vector<Eigen::Triplet<double>> entries;
 
 				int global_counter = 0;
-				Eigen::MatrixXd mapped;
-
-				for (const auto &lb : local_boundary)
+				for (int i = 0; i < cache.samples.size(); ++i)
 				{
-					const int e = lb.element_id();
-					bool has_samples = utils::BoundarySampler::sample_boundary(lb, resolution, mesh_, false, uv, samples, global_primitive_ids);
-
-					if (!has_samples)
-						continue;
-
-					const basis::ElementBases &bs = bases_[e];
-					const basis::ElementBases &gbs = gbases_[e];
+					const LSQBCCache::Samples &sample = cache.samples[i];
+					const basis::ElementBases &bs = bases_[sampled_elements[i]];
 					const int n_local_bases = int(bs.bases.size());
 
-					gbs.eval_geom_mapping(samples, mapped);
-
-					bs.evaluate_bases(samples, tmp_val);
-					df(global_primitive_ids, uv, mapped, rhs_fun);
-
-					for (int s = 0; s < samples.rows(); ++s)
+					for (int s = 0; s < sample.global_primitive_ids.size(); ++s)
 					{
-						const int tag = mesh_.get_boundary_id(global_primitive_ids(s));
+						const int tag = mesh_.get_boundary_id(sample.global_primitive_ids(s));
 						if (!problem_.all_dimensions_dirichlet() && !problem_.is_dimension_dirichet(tag, d))
 							continue;
 
 						for (int j = 0; j < n_local_bases; ++j)
 						{
 							const basis::Basis &b = bs.bases[j];
-							const double tmp = tmp_val[j].val(s);
+							const double tmp = basis_values[i][j].val(s);
 
 							for (std::size_t ii = 0; ii < b.global().size(); ++ii)
 							{
 								auto item = global_index_to_col(b.global()[ii].index);
 								if (item != -1)
-								{
-									entries.push_back(Eigen::Triplet<double>(global_counter, item, tmp * b.global()[ii].val));
-									entries_t.push_back(Eigen::Triplet<double>(item, global_counter, tmp * b.global()[ii].val));
-								}
+									entries.emplace_back(item, global_counter, tmp * b.global()[ii].val);
 							}
 						}
 
-						global_rhs(global_counter) = rhs_fun(s, d);
+						dim.rows.emplace_back(i, s);
 						global_counter++;
 					}
 				}
 
-				assert(global_counter == total_size);
+				if (global_counter == 0)
+					continue;
 
-				if (total_size > 0)
-				{
-					const double mmin = global_rhs.minCoeff();
-					const double mmax = global_rhs.maxCoeff();
+				dim.mat_t.resize(int(dim.indices.size()), global_counter);
+				dim.mat_t.setFromTriplets(entries.begin(), entries.end());
 
-					if (fabs(mmin) < 1e-8 && fabs(mmax) < 1e-8)
-					{
-						for (size_t i = 0; i < indices.size(); ++i)
-						{
-							const int tag = tags[i];
-							if (problem_.all_dimensions_dirichlet() || problem_.is_dimension_dirichet(tag, d))
-								rhs(indices[i] * size_ + d) = 0;
-						}
-					}
-					else
-					{
-						StiffnessMatrix mat(int(total_size), int(indices.size()));
-						mat.setFromTriplets(entries.begin(), entries.end());
+				const StiffnessMatrix A = dim.mat_t * dim.mat_t.transpose();
+				dim.solver = linear::Solver::create(solver_params_, logger());
+				logger().info("Solve RHS using {} linear solver", dim.solver->name());
+				dim.solver->analyze_pattern(A, A.rows());
+				dim.solver->factorize(A);
+			}
+		}
+
+		void RhsAssembler::lsq_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
+								  const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const
+		{
+			std::lock_guard<std::mutex> lock(lsq_bc_mutex_);
 
-						StiffnessMatrix mat_t(int(indices.size()), int(total_size));
-						mat_t.setFromTriplets(entries_t.begin(), entries_t.end());
+			// the projection only depends on the boundary, only the values of the bc change in time
+			std::vector<int> boundary_primitives;
+			for (const auto &lb : local_boundary)
+			{
+				boundary_primitives.push_back(lb.element_id());
+				for (int i = 0; i < lb.size(); ++i)
+					boundary_primitives.push_back(lb.global_primitive_id(i));
+				boundary_primitives.push_back(-1);
+			}
 
-						StiffnessMatrix A = mat_t * mat;
-						Eigen::VectorXd b = mat_t * global_rhs;
+			if (lsq_bc_cache_ == nullptr
+				|| lsq_bc_cache_->resolution != resolution
+				|| lsq_bc_cache_->boundary_nodes != bounday_nodes
+				|| lsq_bc_cache_->boundary_primitives != boundary_primitives)
+				build_lsq_bc_cache(local_boundary, bounday_nodes, resolution, std::move(boundary_primitives));
 
-						Eigen::VectorXd coeffs(b.rows(), 1);
-						auto solver = linear::Solver::create(solver_params_, logger());
-						logger().info("Solve RHS using {} linear solver", solver->name());
-						solver->analyze_pattern(A, A.rows());
-						solver->factorize(A);
-						coeffs.setZero();
-						solver->solve(b, coeffs);
+			const LSQBCCache &cache = *lsq_bc_cache_;
 
-						logger().trace("RHS solve error {}", (A * coeffs - b).norm());
+			std::vector<Eigen::MatrixXd> rhs_fun(cache.samples.size());
+			for (int i = 0; i < cache.samples.size(); ++i)
+			{
+				const LSQBCCache::Samples &sample = cache.samples[i];
+				df(sample.global_primitive_ids, sample.uv, sample.mapped, rhs_fun[i]);
+			}
 
-						for (long i = 0; i < coeffs.rows(); ++i)
-						{
-							const int tag = tags[i];
-							if (problem_.all_dimensions_dirichlet() || problem_.is_dimension_dirichet(tag, d))
-								rhs(indices[i] * size_ + d) = coeffs(i);
-						}
-					}
+			for (int d = 0; d < size_; ++d)
+			{
+				const LSQBCCache::Dimension &dim = cache.dims[d];
+				if (dim.rows.empty())
+					continue;
+
+				Eigen::VectorXd global_rhs(dim.rows.size());
+				for (int r = 0; r < dim.rows.size(); ++r)
+					global_rhs(r) = rhs_fun[dim.rows[r].first](dim.rows[r].second, d);
+
+				const double mmin = global_rhs.minCoeff();
+				const double mmax = global_rhs.maxCoeff();
+
+				Eigen::VectorXd coeffs = Eigen::VectorXd::Zero(dim.indices.size());
+				if (fabs(mmin) >= 1e-8 || fabs(mmax) >= 1e-8)
+				{
+					const Eigen::VectorXd b = dim.mat_t * global_rhs;
+					dim.solver->solve(b, coeffs);
+
+					logger().trace("RHS solve error {}", (dim.mat_t * (dim.mat_t.transpose() * coeffs) - b).norm());
+				}
+
+				for (long i = 0; i < coeffs.rows(); ++i)
+				{
+					const int tag = dim.tags[i];
+					if (problem_.all_dimensions_dirichlet() || problem_.is_dimension_dirichet(tag, d))
+						rhs(dim.indices[i] * size_ + d) = coeffs(i);
 				}
 			}
 		}
@@ -572,6 +741,70 @@ namespace polyfem
 			}
 		}
 
+		std::shared_ptr<const RhsAssembler::NeumannQuadratureCache> RhsAssembler::neumann_quadrature(const std::vector<LocalBoundary> &local_neumann_boundary, const int resolution) const
+		{
+			std::vector<int> boundary_primitives;
+			std::vector<std::pair<int, int>> primitives; // (local boundary, primitive)
+			for (int l = 0; l < local_neumann_boundary.size(); ++l)
+			{
+				const LocalBoundary &lb = local_neumann_boundary[l];
+				boundary_primitives.push_back(lb.element_id());
+				for (int i = 0; i < lb.size(); ++i)
+				{
+					boundary_primitives.push_back(lb.global_primitive_id(i));
+					primitives.emplace_back(l, i);
+				}
+				boundary_primitives.push_back(-1);
+			}
+
+			std::lock_guard<std::mutex> lock(neumann_quadrature_mutex_);
+
+			if (neumann_quadrature_cache_ != nullptr
+				&& neumann_quadrature_cache_->resolution == resolution
+				&& neumann_quadrature_cache_->boundary_primitives == boundary_primitives)
+				return neumann_quadrature_cache_;
+
+			auto cache = std::make_shared<NeumannQuadratureCache>();
+			cache->boundary_primitives = std::move(boundary_primitives);
+			cache->resolution = resolution;
+
+			std::vector<NeumannQuadratureCache::Primitive> all_primitives(primitives.size());
+			std::vector<bool> has_samples(primitives.size());
+			maybe_parallel_for(int(primitives.size()), [&](int start, int end, int thread_id) {
+				for (int p = start; p < end; ++p)
+				{
+					const LocalBoundary &lb = local_neumann_boundary[primitives[p].first];
+					const int i = primitives[p].second;
+					const int e = lb.element_id();
+
+					NeumannQuadratureCache::Primitive &primitive = all_primitives[p];
+					primitive.element_id = e;
+					primitive.global_primitive_id = lb.global_primitive_id(i);
+
+					has_samples[p] = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, primitive.uv, primitive.points, primitive.normals, primitive.weights);
+					if (!has_samples[p])
+						continue;
+
+					primitive.vals.compute(e, mesh_.is_volume(), primitive.points, bases_[e], gbases_[e]);
+					primitive.local_nodes = bases_[e].local_nodes_for_primitive(primitive.global_primitive_id, mesh_);
+				}
+			});
+
+			std::vector<int> elements;
+			for (int p = 0; p < all_primitives.size(); ++p)
+			{
+				if (!has_samples[p])
+					continue;
+				elements.push_back(all_primitives[p].element_id);
+				cache->primitives.push_back(std::move(all_primitives[p]));
+			}
+			// the primitives of an element share its bases, they get different colors
+			cache->colors = AssemblerUtils::color_elements(bases_, n_basis_, elements);
+
+			neumann_quadrature_cache_ = cache;
+			return neumann_quadrature_cache_;
+		}
+
 		void RhsAssembler::set_bc(
 			const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
 			const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &nf,
@@ -610,87 +843,58 @@ namespace polyfem
 			}
 
 			// Neumann
-			Eigen::MatrixXd uv, samples, gtmp, rhs_fun, deform_mat, trafo;
-			Eigen::VectorXi global_primitive_ids;
-			Eigen::MatrixXd points, normals;
-			Eigen::VectorXd weights;
+			integrate_neumann(nf, bounday_nodes, resolution, local_neumann_boundary, displacement, rhs);
+		}
 
-			ElementAssemblyValues vals;
+		void RhsAssembler::integrate_neumann(
+			const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &nf,
+			const std::vector<int> &bounday_nodes, const int resolution, const std::vector<LocalBoundary> &local_neumann_boundary,
+			const Eigen::MatrixXd &displacement, Eigen::MatrixXd &rhs) const
+		{
+			const std::shared_ptr<const NeumannQuadratureCache> neumann = neumann_quadrature(local_neumann_boundary, resolution);
 
-			for (const auto &lb : local_neumann_boundary)
+			std::vector<bool> is_dirichlet(rhs.rows(), false);
+			for (const int b : bounday_nodes)
 			{
-				const int e = lb.element_id();
-				const basis::ElementBases &gbs = gbases_[e];
-				const basis::ElementBases &bs = bases_[e];
-
-				for (int i = 0; i < lb.size(); ++i)
-				{
-					const int primitive_global_id = lb.global_primitive_id(i);
-
-					bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-					global_primitive_ids.setConstant(weights.size(), primitive_global_id);
-
-					vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-
-					for (int n = 0; n < vals.jac_it.size(); ++n)
-					{
-						trafo = vals.jac_it[n].inverse();
-
-						if (displacement.size() > 0)
-						{
-							assert(size_ == 2 || size_ == 3);
-							deform_mat.resize(size_, size_);
-							deform_mat.setZero();
-							for (const auto &b : vals.basis_values)
-							{
-								for (const auto &g : b.global)
-								{
-									for (int d = 0; d < size_; ++d)
-									{
-										deform_mat.row(d) += displacement(g.index * size_ + d) * b.grad.row(n);
-									}
-								}
-							}
+				if (b < is_dirichlet.size())
+					is_dirichlet[b] = true;
+			}
 
-							trafo += deform_mat;
-						}
+			const auto assemble_primitive = [&](const int p, LocalThreadVecStorage &local_storage, Eigen::MatrixXd &vec) {
+				const NeumannQuadratureCache::Primitive &primitive = neumann->primitives[p];
+				const ElementAssemblyValues &vals = primitive.vals;
+				Eigen::MatrixXd &rhs_fun = local_storage.rhs_fun;
+				Eigen::MatrixXd &normals = local_storage.normals;
 
-						normals.row(n) = normals.row(n) * trafo.inverse();
-						normals.row(n).normalize();
-					}
+				normals = primitive.normals;
+				displace_normals(vals, displacement, size_, normals);
 
-					// problem_.neumann_bc(mesh_, global_primitive_ids, vals.val, t, rhs_fun);
-					nf(global_primitive_ids, uv, vals.val, normals, rhs_fun);
+				local_storage.global_primitive_ids.setConstant(primitive.weights.size(), primitive.global_primitive_id);
+				nf(local_storage.global_primitive_ids, primitive.uv, vals.val, normals, rhs_fun);
 
-					// UIState::ui_state().debug_data().add_points(vals.val, Eigen::RowVector3d(0,1,0));
+				for (int d = 0; d < size_; ++d)
+					rhs_fun.col(d) = rhs_fun.col(d).array() * primitive.weights.array();
 
+				for (long n = 0; n < primitive.local_nodes.size(); ++n)
+				{
+					const AssemblyValues &v = vals.basis_values[primitive.local_nodes(n)];
 					for (int d = 0; d < size_; ++d)
-						rhs_fun.col(d) = rhs_fun.col(d).array() * weights.array();
-
-					const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
-
-					for (long n = 0; n < nodes.size(); ++n)
 					{
-						// const auto &b = bs.bases[nodes(n)];
-						const AssemblyValues &v = vals.basis_values[nodes(n)];
-						for (int d = 0; d < size_; ++d)
-						{
-							const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
-
-							for (size_t g = 0; g < v.global.size(); ++g)
-							{
-								const int g_index = v.global[g].index * size_ + d;
-								const bool is_neumann = std::find(bounday_nodes.begin(), bounday_nodes.end(), g_index) == bounday_nodes.end();
+						const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
 
-								if (is_neumann)
-								{
-									rhs(g_index) += rhs_value * v.global[g].val;
-								}
-							}
+						for (size_t g = 0; g < v.global.size(); ++g)
+						{
+							const int g_index = v.global[g].index * size_ + d;
+							if (!is_dirichlet[g_index])
+								vec(g_index) += rhs_value * v.global[g].val;
 						}
 					}
 				}
-			}
+			};
+
+			parallel_scatter(
+				int(neumann->primitives.size()), [&]() -> const std::vector<std::vector<int>> & { return neumann->colors; },
+				assemble_primitive, rhs);
 
 			// TODO add nodal neumann
 		}
@@ -709,6 +913,16 @@ namespace polyfem
 			obstacle_.update_displacement(t, rhs);
 		}
 
+		void RhsAssembler::assemble_neumann_part(const int k, const int resolution, const std::vector<LocalBoundary> &local_neumann_boundary, Eigen::MatrixXd &rhs) const
+		{
+			assert(k >= 0 && k < problem_.n_neumann_time_parts());
+			integrate_neumann(
+				[&](const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &normals, Eigen::MatrixXd &val) {
+					problem_.neumann_bc_part(k, mesh_, global_ids, uv, pts, val);
+				},
+				std::vector<int>(), resolution, local_neumann_boundary, Eigen::MatrixXd(), rhs);
+		}
+
 		void RhsAssembler::compute_energy_grad(const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const Density &density, const int resolution, const std::vector<LocalBoundary> &local_neumann_boundary, const Eigen::MatrixXd &final_rhs, const double t, Eigen::MatrixXd &rhs) const
 		{
 			if (problem_.is_constant_in_time())
@@ -760,7 +974,8 @@ namespace polyfem
 						ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
 
 						const Quadrature &quadrature = vals.quadrature;
-						const Eigen::VectorXd da = vals.det.array() * quadrature.weights.array();
+						Eigen::VectorXd &da = local_storage.da;
+						da = vals.det.array() * quadrature.weights.array();
 
 						problem_.rhs(assembler_, vals.val, t, forces);
 						assert(forces.rows() == da.size());
@@ -801,66 +1016,29 @@ namespace polyfem
 					res += local_storage.val;
 			}
 
-			VectorNd local_displacement(size_);
-			Eigen::MatrixXd forces;
-
-			ElementAssemblyValues vals;
 			// Neumann
-			Eigen::MatrixXd points, uv, normals, deform_mat, trafo;
-			Eigen::VectorXd weights;
-			Eigen::VectorXi global_primitive_ids;
-			for (const auto &lb : local_neumann_boundary)
-			{
-				const int e = lb.element_id();
-				const basis::ElementBases &gbs = gbases_[e];
-				const basis::ElementBases &bs = bases_[e];
-
-				for (int i = 0; i < lb.size(); ++i)
-				{
-					const int primitive_global_id = lb.global_primitive_id(i);
-
-					bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
-					global_primitive_ids.setConstant(weights.size(), primitive_global_id);
-
-					if (!has_samples)
-						continue;
-
-					const basis::ElementBases &gbs = gbases_[e];
-					const basis::ElementBases &bs = bases_[e];
+			const std::shared_ptr<const NeumannQuadratureCache> neumann = neumann_quadrature(local_neumann_boundary, resolution);
+			auto storage = create_thread_storage(LocalThreadScalarStorage());
 
-					vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-
-					for (int n = 0; n < vals.jac_it.size(); ++n)
-					{
-						trafo = vals.jac_it[n].inverse();
+			maybe_parallel_for(int(neumann->primitives.size()), [&](int start, int end, int thread_id) {
+				LocalThreadScalarStorage &local_storage = get_local_thread_storage(storage, thread_id);
+				VectorNd local_displacement(size_);
+				Eigen::MatrixXd &forces = local_storage.forces;
+				Eigen::MatrixXd &normals = local_storage.normals;
 
-						if (displacement_prev.size() > 0)
-						{
-							assert(size_ == 2 || size_ == 3);
-							deform_mat.resize(size_, size_);
-							deform_mat.setZero();
-							for (const auto &b : vals.basis_values)
-							{
-								for (const auto &g : b.global)
-								{
-									for (int d = 0; d < size_; ++d)
-									{
-										deform_mat.row(d) += displacement_prev(g.index * size_ + d) * b.grad.row(n);
-									}
-								}
-							}
-
-							trafo += deform_mat;
-						}
+				for (int p = start; p < end; ++p)
+				{
+					const NeumannQuadratureCache::Primitive &primitive = neumann->primitives[p];
+					const ElementAssemblyValues &vals = primitive.vals;
+					const Eigen::VectorXd &weights = primitive.weights;
 
-						normals.row(n) = normals.row(n) * trafo.inverse();
-						normals.row(n).normalize();
-					}
-					problem_.neumann_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, forces);
+					normals = primitive.normals;
+					displace_normals(vals, displacement_prev, size_, normals);
 
-					// UIState::ui_state().debug_data().add_points(vals.val, Eigen::RowVector3d(1,0,0));
+					local_storage.global_primitive_ids.setConstant(weights.size(), primitive.global_primitive_id);
+					problem_.neumann_bc(mesh_, local_storage.global_primitive_ids, primitive.uv, vals.val, normals, t, forces);
 
-					for (long p = 0; p < weights.size(); ++p)
+					for (long q = 0; q < weights.size(); ++q)
 					{
 						local_displacement.setZero();
 
@@ -868,7 +1046,7 @@ namespace polyfem
 						{
 							const auto &vv = vals.basis_values[i];
 							assert(vv.val.size() == weights.size());
-							const double b_val = vv.val(p);
+							const double b_val = vv.val(q);
 
 							for (int d = 0; d < size_; ++d)
 							{
@@ -880,10 +1058,14 @@ namespace polyfem
 						}
 
 						for (int d = 0; d < size_; ++d)
-							res -= forces(p, d) * local_displacement(d) * weights(p);
+							local_storage.val -= forces(q, d) * local_displacement(d) * weights(q);
 					}
 				}
-			}
+			});
+
+			// Serially merge local storages
+			for (const LocalThreadScalarStorage &local_storage : storage)
+				res += local_storage.val;
 
 			return res;
 		}
@@ -7,6 +7,11 @@
 #include <polyfem/assembler/MatParams.hpp>
 #include <polyfem/mesh/LocalBoundary.hpp>
 
+#include <polysolve/linear/Solver.hpp>
+
+#include <memory>
+#include <mutex>
+
 namespace polyfem
 {
 	namespace assembler
@@ -33,7 +38,8 @@ namespace polyfem
 				const AssemblyValsCache &ass_vals_cache,
 				const Problem &problem,
 				const std::string bc_method,
-				const json &solver_params);
+				const json &solver_params,
+				const std::string initial_projection = "global");
 
 			// computes the rhs of a problem by \int \phi rho rhs
 			void assemble(const Density &density, Eigen::MatrixXd &rhs, const double t = 1) const;
@@ -44,6 +50,9 @@ namespace polyfem
 			void initial_velocity(Eigen::MatrixXd &sol) const;
 			// computes the initial acceleration for time dependent, calls time_bc
 			void initial_acceleration(Eigen::MatrixXd &sol) const;
+			// projects a field given at physical points on the bases as the initial conditions, calls time_bc
+			// fun(pts, val) evaluates the field at the points, it is called in parallel
+			void initial_field(const std::function<void(const Eigen::MatrixXd &, Eigen::MatrixXd &)> &fun, Eigen::MatrixXd &sol) const;
 
 			// sets boundary conditions to rhs, the boundary conditions are projected (Dirichlet) integrated (Neumann) at resolution
 			// local boundary stores the mapping from elemment to nodes for Dirichlet nodes
@@ -58,6 +67,10 @@ namespace polyfem
 				const Eigen::MatrixXd &displacement = Eigen::MatrixXd(),
 				const double t = 1) const;
 
+			// adds the integral of the k-th time independent part of the Neumann bc (Problem::neumann_bc_part) to rhs,
+			// the Neumann load at t is the sum of the parts scaled by Problem::neumann_time_factor
+			void assemble_neumann_part(const int k, const int resolution, const std::vector<mesh::LocalBoundary> &local_neumann_boundary, Eigen::MatrixXd &rhs) const;
+
 			// compute body energy
 			double compute_energy(
 				const Eigen::MatrixXd &displacement,
@@ -92,6 +105,10 @@ namespace polyfem
 			void lsq_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
 						const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const;
 
+			// builds the samples and the factorized least-squares projection of lsq_bc
+			// the boundary primitives are the key of the cache
+			void build_lsq_bc_cache(const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, std::vector<int> &&boundary_primitives) const;
+
 			// integrate bc
 			void integrate_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
 							  const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const;
@@ -109,9 +126,20 @@ namespace polyfem
 				const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, const std::vector<mesh::LocalBoundary> &local_neumann_boundary,
 				const Eigen::MatrixXd &displacement, const double t, Eigen::MatrixXd &rhs) const;
 
+			// integrates the Neumann bc nf on the cached quadrature and adds it to rhs, except on the Dirichlet nodes
+			void integrate_neumann(
+				const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &nf,
+				const std::vector<int> &bounday_nodes, const int resolution, const std::vector<mesh::LocalBoundary> &local_neumann_boundary,
+				const Eigen::MatrixXd &displacement, Eigen::MatrixXd &rhs) const;
+
+			// quadrature of the Neumann boundary at resolution, built on first use and when the boundary or the resolution change
+			struct NeumannQuadratureCache;
+			std::shared_ptr<const NeumannQuadratureCache> neumann_quadrature(const std::vector<mesh::LocalBoundary> &local_neumann_boundary, const int resolution) const;
+
 			// sets the time (initial) boundary condition
 			// the lambda depeneds if soltuion, velocity, or acceleration
-			// they are projected on the FEM bases, it inverts a linear system
+			// they are sampled at the nodes, or projected on the FEM bases: globally with the cached factorization of
+			// the mass matrix, or locally per element and averaged at the nodes shared by several elements
 			void time_bc(const std::function<void(const mesh::Mesh &, const Eigen::MatrixXi &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &fun, Eigen::MatrixXd &sol) const;
 
 			const Assembler &assembler_;
@@ -125,10 +153,73 @@ namespace polyfem
 			const Problem &problem_;
 			const std::string bc_method_;
 			const json solver_params_;
+			const std::string initial_projection_; ///< "global" or "local" L2 projection of the initial conditions
 			const std::vector<int> &dirichlet_nodes_;
 			const std::vector<RowVectorNd> &dirichlet_nodes_position_;
 			const std::vector<int> &neumann_nodes_;
 			const std::vector<RowVectorNd> &neumann_nodes_position_;
+
+			// least-squares projection of the Dirichlet bc, it depends only on the boundary and the resolution
+			struct LSQBCCache
+			{
+				// samples of a local boundary with samples
+				struct Samples
+				{
+					Eigen::VectorXi global_primitive_ids;
+					Eigen::MatrixXd uv;
+					Eigen::MatrixXd mapped;
+				};
+
+				struct Dimension
+				{
+					std::vector<std::pair<int, int>> rows; ///< (samples, sample) of every row of the least-squares system
+					std::vector<int> indices;             ///< node of every column
+					std::vector<int> tags;                ///< boundary id of every column
+					StiffnessMatrix mat_t;                ///< transposed sampled basis values
+					std::unique_ptr<polysolve::linear::Solver> solver; ///< factorization of mat_t * mat_t^T
+				};
+
+				// key of the cache
+				std::vector<int> boundary_primitives; ///< element and primitives of every local boundary
+				std::vector<int> boundary_nodes;
+				int resolution = -1;
+
+				std::vector<Samples> samples;
+				std::vector<Dimension> dims;
+			};
+			mutable std::unique_ptr<LSQBCCache> lsq_bc_cache_;
+			mutable std::mutex lsq_bc_mutex_;
+
+			// factorization of the mass matrix of the global projection of the initial conditions, shared by the solution, velocity and acceleration
+			mutable std::unique_ptr<polysolve::linear::Solver> initial_mass_solver_;
+			mutable std::mutex initial_mass_mutex_;
+
+			// quadrature points and assembly values of the Neumann boundary, they depend only on the boundary and the resolution
+			struct NeumannQuadratureCache
+			{
+				// one boundary primitive with quadrature points
+				struct Primitive
+				{
+					int element_id;
+					int global_primitive_id;
+					Eigen::MatrixXd uv;
+					Eigen::MatrixXd points;
+					Eigen::MatrixXd normals; ///< in the reference element
+					Eigen::VectorXd weights;
+					Eigen::VectorXi local_nodes; ///< local bases of the primitive
+					ElementAssemblyValues vals;
+				};
+
+				// key of the cache
+				std::vector<int> boundary_primitives; ///< element and primitives of every local boundary
+				int resolution = -1;
+
+				std::vector<Primitive> primitives;
+				std::vector<std::vector<int>> colors; ///< primitives of every color, they share no basis
+			};
+			// shared, a rebuild does not invalidate the cache used by another thread
+			mutable std::shared_ptr<const NeumannQuadratureCache> neumann_quadrature_cache_;
+			mutable std::mutex neumann_quadrature_mutex_;
 		};
 	} // namespace assembler
 } // namespace polyfem
@@ -88,43 +88,19 @@ namespace polyfem::assembler
 	Eigen::VectorXd
 	SaintVenantElasticity::assemble_gradient(const NonLinearAssemblerData &data) const
 	{
-		// igl::Timer time; time.start();
-
-		const int n_bases = data.vals.basis_values.size();
-
-		return polyfem::gradient_from_energy(
-			size(), n_bases, data,
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 6, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 8, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 12, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 18, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 24, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 30, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 60, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 81, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, BIG_N, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::VectorXd>>(data); });
+		return assemble_gradient_from_stress(data);
 	}
 
 	Eigen::MatrixXd
 	SaintVenantElasticity::assemble_hessian(const NonLinearAssemblerData &data) const
 	{
-		// igl::Timer time; time.start();
-
-		const int n_bases = data.vals.basis_values.size();
-		return polyfem::hessian_from_energy(
-			size(), n_bases, data,
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(data); });
+		return assemble_hessian_from_stress_grad(data);
+	}
+
+	bool SaintVenantElasticity::assemble_projected_hessian(const NonLinearAssemblerData &data, Eigen::MatrixXd &hessian) const
+	{
+		hessian = assemble_hessian_from_stress_grad(data, true);
+		return true;
 	}
 
 	void SaintVenantElasticity::assign_stress_tensor(
@@ -257,6 +233,123 @@ namespace polyfem::assembler
 		return energy * 0.5;
 	}
 
+	namespace
+	{
+		/// second Piola-Kirchhoff stress S = C:E, with E = ½(FᵀF - Id), of a batch of deformation gradients
+		void batch_green_strain_and_stress(const int dim, const ElasticityTensor &C, const Eigen::ArrayXXd &F, Eigen::ArrayXXd &E, Eigen::ArrayXXd &S)
+		{
+			E.resize(F.rows(), F.cols());
+			for (int i = 0; i < dim; ++i)
+			{
+				for (int j = 0; j < dim; ++j)
+				{
+					E.col(i * dim + j).setConstant(i == j ? -0.5 : 0);
+					for (int k = 0; k < dim; ++k)
+						E.col(i * dim + j) += 0.5 * F.col(k * dim + i) * F.col(k * dim + j);
+				}
+			}
+
+			// Voigt notation with engineering shear strains
+			std::vector<std::pair<int, int>> voigt;
+			if (dim == 2)
+				voigt = {{0, 0}, {1, 1}, {0, 1}};
+			else
+				voigt = {{0, 0}, {1, 1}, {2, 2}, {1, 2}, {0, 2}, {0, 1}};
+
+			S.setZero(F.rows(), F.cols());
+			for (int a = 0; a < voigt.size(); ++a)
+			{
+				Eigen::ArrayXd s = Eigen::ArrayXd::Zero(F.rows());
+				for (int b = 0; b < voigt.size(); ++b)
+				{
+					const auto [k, l] = voigt[b];
+					s += C(a, b) * (k == l ? 1. : 2.) * E.col(k * dim + l);
+				}
+
+				const auto [i, j] = voigt[a];
+				S.col(i * dim + j) = s;
+				S.col(j * dim + i) = s;
+			}
+		}
+
+		/// C(i * dim + j, k * dim + l), the full stiffness tensor of the Voigt matrix
+		Eigen::MatrixXd full_stiffness(const int dim, const ElasticityTensor &C)
+		{
+			const auto voigt_index = [dim](const int i, const int j) { return i == j ? i : (dim == 2 ? 2 : 6 - i - j); };
+
+			Eigen::MatrixXd res(dim * dim, dim * dim);
+			for (int i = 0; i < dim; ++i)
+				for (int j = 0; j < dim; ++j)
+					for (int k = 0; k < dim; ++k)
+						for (int l = 0; l < dim; ++l)
+							res(i * dim + j, k * dim + l) = C(voigt_index(i, j), voigt_index(k, l));
+			return res;
+		}
+	} // namespace
+
+	void SaintVenantElasticity::compute_energy_density_batch(const BatchAssemblerData &data, Eigen::ArrayXd &psi) const
+	{
+		Eigen::ArrayXXd E, S;
+		batch_green_strain_and_stress(data.dim, elasticity_tensor_, data.def_grad, E, S);
+
+		psi = 0.5 * (S * E).rowwise().sum();
+	}
+
+	// P = F S
+	void SaintVenantElasticity::compute_stress_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress) const
+	{
+		const int dim = data.dim;
+		const Eigen::ArrayXXd &F = data.def_grad;
+
+		Eigen::ArrayXXd E, S;
+		batch_green_strain_and_stress(dim, elasticity_tensor_, F, E, S);
+
+		stress.setZero(F.rows(), F.cols());
+		for (int i = 0; i < dim; ++i)
+			for (int j = 0; j < dim; ++j)
+				for (int k = 0; k < dim; ++k)
+					stress.col(i * dim + j) += F.col(i * dim + k) * S.col(k * dim + j);
+	}
+
+	// ∂P(i, j)/∂F(k, l) = δᵢₖ S(l, j) + ∑ₘₙ F(i, m) C(m, j, l, n) F(k, n)
+	void SaintVenantElasticity::compute_stress_grad_batch(const BatchAssemblerData &data, Eigen::ArrayXXd &stress_grad) const
+	{
+		const int dim = data.dim;
+		const int dim2 = dim * dim;
+		const Eigen::ArrayXXd &F = data.def_grad;
+
+		Eigen::ArrayXXd E, S;
+		batch_green_strain_and_stress(dim, elasticity_tensor_, F, E, S);
+		const Eigen::MatrixXd C = full_stiffness(dim, elasticity_tensor_);
+
+		// CF((m * dim + j) * dim² + k * dim + l) = ∑ₙ C(m, j, l, n) F(k, n)
+		Eigen::ArrayXXd CF = Eigen::ArrayXXd::Zero(F.rows(), dim2 * dim2);
+		for (int mj = 0; mj < dim2; ++mj)
+			for (int k = 0; k < dim; ++k)
+				for (int l = 0; l < dim; ++l)
+					for (int n = 0; n < dim; ++n)
+						CF.col(mj * dim2 + k * dim + l) += C(mj, l * dim + n) * F.col(k * dim + n);
+
+		stress_grad.setZero(F.rows(), dim2 * dim2);
+		for (int i = 0; i < dim; ++i)
+		{
+			for (int j = 0; j < dim; ++j)
+			{
+				for (int k = 0; k < dim; ++k)
+				{
+					for (int l = 0; l < dim; ++l)
+					{
+						auto col = stress_grad.col((i * dim + j) * dim2 + k * dim + l);
+						if (i == k)
+							col += S.col(l * dim + j);
+						for (int m = 0; m < dim; ++m)
+							col += F.col(i * dim + m) * CF.col((m * dim + j) * dim2 + k * dim + l);
+					}
+				}
+			}
+		}
+	}
+
 	std::map<std::string, Assembler::ParamFunc> SaintVenantElasticity::parameters() const
 	{
 		std::map<std::string, ParamFunc> res;
@@ -84,4 +84,28 @@ namespace polyfem::assembler
 
 		return res;
 	}
+
+	void StokesMixed::assemble_element(const ElementAssemblyValues &psi_vals, const ElementAssemblyValues &phi_vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const
+	{
+		// all the pairs at once: -(diag(da) psi)^T gradphi, one product per velocity component
+		const int n_pts = da.size();
+		const int n_psi = int(psi_vals.basis_values.size());
+		const int n_phi = int(phi_vals.basis_values.size());
+
+		Eigen::MatrixXd weighted_psi(n_pts, n_psi);
+		for (int i = 0; i < n_psi; ++i)
+			weighted_psi.col(i) = psi_vals.basis_values[i].val.array() * da.array();
+
+		Eigen::MatrixXd grad_phi(n_pts, n_phi);
+		local.resize(n_phi * rows(), n_psi);
+		for (int d = 0; d < rows(); ++d)
+		{
+			for (int j = 0; j < n_phi; ++j)
+				grad_phi.col(j) = phi_vals.basis_values[j].grad_t_m.col(d);
+
+			const Eigen::MatrixXd block = -grad_phi.transpose() * weighted_psi;
+			for (int j = 0; j < n_phi; ++j)
+				local.row(j * rows() + d) = block.row(j);
+		}
+	}
 } // namespace polyfem::assembler
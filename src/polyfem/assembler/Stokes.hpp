@@ -44,6 +44,9 @@ namespace polyfem::assembler
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1>
 		assemble(const MixedAssemblerData &data) const override;
 
+		bool has_element_kernel() const override { return true; }
+		void assemble_element(const ElementAssemblyValues &psi_vals, const ElementAssemblyValues &phi_vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const override;
+
 		inline int rows() const override { return size(); }
 		inline int cols() const override { return 1; }
 	};
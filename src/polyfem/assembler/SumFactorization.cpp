@@ -0,0 +1,146 @@
+#include "SumFactorization.hpp"
+
+#include <polyfem/autogen/auto_q_bases.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace polyfem::assembler
+{
+	namespace
+	{
+		/// applies A to the first index of the tensor x (first index fastest) and moves it last
+		void contract(const Eigen::MatrixXd &A, const Eigen::VectorXd &x, Eigen::VectorXd &y)
+		{
+			const long n = A.cols();
+			const long r = x.size() / n;
+			assert(r * n == x.size());
+
+			y.resize(A.rows() * r);
+			Eigen::Map<Eigen::MatrixXd>(y.data(), r, A.rows()).noalias() = Eigen::Map<const Eigen::MatrixXd>(x.data(), n, r).transpose() * A.transpose();
+		}
+	} // namespace
+
+	bool SumFactorization::init(const int order, const quadrature::Quadrature &quadrature)
+	{
+		assert(order >= 1);
+		assert(quadrature.points.cols() == 3);
+		const int n1 = order + 1;
+
+		// the nodes of the Q bases are equispaced
+		Eigen::MatrixXd nodes;
+		autogen::q_nodes_3d(order, nodes);
+		assert(nodes.rows() == n1 * n1 * n1);
+		basis_lex_.resize(nodes.rows());
+		for (int j = 0; j < nodes.rows(); ++j)
+		{
+			basis_lex_(j) = 0;
+			for (int a = 2; a >= 0; --a)
+				basis_lex_(j) = basis_lex_(j) * n1 + int(std::round(nodes(j, a) * order));
+		}
+
+		// 1D points of the quadrature
+		std::vector<double> pts(quadrature.points.data(), quadrature.points.data() + quadrature.points.rows());
+		std::sort(pts.begin(), pts.end());
+		pts.erase(std::unique(pts.begin(), pts.end(), [](double a, double b) { return std::abs(a - b) < 1e-12; }), pts.end());
+		const int nq = pts.size();
+		if (long(nq) * nq * nq != quadrature.points.rows())
+			return false;
+
+		point_lex_.resize(quadrature.points.rows());
+		std::vector<bool> used(quadrature.points.rows(), false);
+		for (int q = 0; q < quadrature.points.rows(); ++q)
+		{
+			int index = 0;
+			for (int a = 2; a >= 0; --a)
+			{
+				const auto it = std::lower_bound(pts.begin(), pts.end(), quadrature.points(q, a) - 1e-12);
+				if (it == pts.end() || std::abs(*it - quadrature.points(q, a)) >= 1e-12)
+					return false;
+				index = index * nq + int(it - pts.begin());
+			}
+			if (used[index])
+				return false;
+			used[index] = true;
+			point_lex_(q) = index;
+		}
+
+		// 1D Lagrange polynomials on the nodes i / order
+		B_.resize(nq, n1);
+		D_.resize(nq, n1);
+		for (int q = 0; q < nq; ++q)
+		{
+			const double x = pts[q];
+			for (int i = 0; i < n1; ++i)
+			{
+				double val = 1, der = 0;
+				for (int k = 0; k < n1; ++k)
+				{
+					if (k == i)
+						continue;
+					const double scale = order / double(i - k);
+					der = der * (x - double(k) / order) * scale + val * scale;
+					val *= (x - double(k) / order) * scale;
+				}
+				B_(q, i) = val;
+				D_(q, i) = der;
+			}
+		}
+
+		return true;
+	}
+
+	void SumFactorization::gradient(const Eigen::MatrixXd &u, Eigen::MatrixXd &grad) const
+	{
+		assert(u.rows() == n_bases());
+		grad.resize(n_quadrature_points(), 3 * u.cols());
+
+		Eigen::VectorXd x(n_bases()), t0, t1, t2;
+		for (int c = 0; c < u.cols(); ++c)
+		{
+			for (int j = 0; j < n_bases(); ++j)
+				x(basis_lex_(j)) = u(j, c);
+
+			for (int a = 0; a < 3; ++a)
+			{
+				contract(a == 0 ? D_ : B_, x, t0);
+				contract(a == 1 ? D_ : B_, t0, t1);
+				contract(a == 2 ? D_ : B_, t1, t2);
+
+				for (int q = 0; q < n_quadrature_points(); ++q)
+					grad(q, 3 * c + a) = t2(point_lex_(q));
+			}
+		}
+	}
+
+	void SumFactorization::integrate_gradient(const Eigen::MatrixXd &flux, Eigen::MatrixXd &r) const
+	{
+		assert(flux.rows() == n_quadrature_points());
+		assert(flux.cols() % 3 == 0);
+		const int k = flux.cols() / 3;
+		r.resize(n_bases(), k);
+
+		const Eigen::MatrixXd Bt = B_.transpose();
+		const Eigen::MatrixXd Dt = D_.transpose();
+
+		Eigen::VectorXd x(n_quadrature_points()), t0, t1, t2, sum;
+		for (int c = 0; c < k; ++c)
+		{
+			sum.setZero(n_bases());
+			for (int a = 0; a < 3; ++a)
+			{
+				for (int q = 0; q < n_quadrature_points(); ++q)
+					x(point_lex_(q)) = flux(q, 3 * c + a);
+
+				contract(a == 0 ? Dt : Bt, x, t0);
+				contract(a == 1 ? Dt : Bt, t0, t1);
+				contract(a == 2 ? Dt : Bt, t1, t2);
+				sum += t2;
+			}
+
+			for (int j = 0; j < n_bases(); ++j)
+				r(j, c) = sum(basis_lex_(j));
+		}
+	}
+} // namespace polyfem::assembler
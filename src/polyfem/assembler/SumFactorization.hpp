@@ -0,0 +1,43 @@
+#pragma once
+
+#include <polyfem/quadrature/Quadrature.hpp>
+
+#include <Eigen/Dense>
+
+namespace polyfem::assembler
+{
+	/// Sum-factorization of the Q Lagrange bases of a hexahedron at tensor-product quadrature points.
+	/// The bases are products φᵢⱼₖ(x, y, z) = lᵢ(x) lⱼ(y) lₖ(z) of 1D Lagrange polynomials, so their gradients
+	/// at the n³ quadrature points are obtained by applying the 1D tables one direction at a time,
+	/// in O(p⁴) instead of O(p⁶) per element.
+	class SumFactorization
+	{
+	public:
+		/// @brief builds the 1D tables
+		/// @param[in] order order of the Q bases
+		/// @param[in] quadrature quadrature on the reference hexahedron
+		/// @return false if the quadrature points are not a tensor-product grid
+		bool init(const int order, const quadrature::Quadrature &quadrature);
+
+		/// number of local bases
+		int n_bases() const { return basis_lex_.size(); }
+		/// number of quadrature points
+		int n_quadrature_points() const { return point_lex_.size(); }
+
+		/// @brief reference gradients of a local field at the quadrature points
+		/// @param[in] u n_bases x k local coefficients
+		/// @param[out] grad n_quadrature_points x 3k, column 3c + a is the derivative along a of component c
+		void gradient(const Eigen::MatrixXd &u, Eigen::MatrixXd &grad) const;
+
+		/// @brief transpose of gradient, r(j, c) = ∑_q ∑_a ∂ₐφⱼ(q) flux(q, 3c + a)
+		/// @param[in] flux n_quadrature_points x 3k values at the quadrature points
+		/// @param[out] r n_bases x k local coefficients
+		void integrate_gradient(const Eigen::MatrixXd &flux, Eigen::MatrixXd &r) const;
+
+	private:
+		Eigen::MatrixXd B_;         ///< 1D bases at the 1D quadrature points
+		Eigen::MatrixXd D_;         ///< 1D bases derivatives at the 1D quadrature points
+		Eigen::VectorXi basis_lex_; ///< lexicographic (x fastest) index of every local basis
+		Eigen::VectorXi point_lex_; ///< lexicographic (x fastest) index of every quadrature point
+	};
+} // namespace polyfem::assembler
@@ -1,7 +1,30 @@
 #include "ViscousDamping.hpp"
 
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
 namespace polyfem::assembler
 {
+	namespace
+	{
+		// Id + local_dispᵀ ∇φ at the quadrature points, one row-major F per row
+		void def_grads_at_quad(const ElementAssemblyValues &vals, const Eigen::MatrixXd &local_disp, Eigen::MatrixXd &def_grads)
+		{
+			const int dim = local_disp.cols();
+			const int n_pts = vals.det.size();
+
+			def_grads.resize(n_pts, dim * dim);
+			Eigen::MatrixXd grad(local_disp.rows(), dim);
+			for (int p = 0; p < n_pts; ++p)
+			{
+				for (size_t i = 0; i < vals.basis_values.size(); ++i)
+					grad.row(i) = vals.basis_values[i].grad.row(p);
+
+				const Eigen::MatrixXd F = local_disp.transpose() * grad * vals.jac_it[p] + Eigen::MatrixXd::Identity(dim, dim);
+				def_grads.row(p) = F.reshaped<Eigen::RowMajor>().transpose();
+			}
+		}
+	} // namespace
+
 	void ViscousDamping::compute_stress_aux(const Eigen::MatrixXd &F, const Eigen::MatrixXd &dFdt, Eigen::MatrixXd &dRdF, Eigen::MatrixXd &dRdFdot) const
 	{
 		const int size = F.rows();
@@ -69,13 +92,45 @@ namespace polyfem::assembler
 			damping_params_[1] = params["phi"];
 	}
 
-	// E := 0.5(F^T F - I), Compute \int F * (2\psi dE/dt + \phi Tr(dE/dt) I) : gradv du
-	Eigen::VectorXd
-	ViscousDampingPrev::assemble_gradient(const NonLinearAssemblerData &data) const
+	void ViscousDamping::update_prev_def_grads(
+		const bool is_volume,
+		const std::vector<basis::ElementBases> &bases,
+		const std::vector<basis::ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const Eigen::VectorXd &x_prev) const
 	{
-		if (data.x_prev.size() != data.x.size())
-			return Eigen::VectorXd::Zero(data.vals.basis_values.size() * size());
-		Eigen::MatrixXd local_disp;
+		prev_x_ = x_prev;
+		prev_def_grads_.resize(bases.size());
+
+		utils::maybe_parallel_for(bases.size(), [&](int start, int end, int thread_id) {
+			ElementAssemblyValues vals;
+			Eigen::MatrixXd local_prev_disp;
+			for (int e = start; e < end; ++e)
+			{
+				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+
+				local_prev_disp.setZero(vals.basis_values.size(), size());
+				for (size_t i = 0; i < vals.basis_values.size(); ++i)
+				{
+					for (const auto &g : vals.basis_values[i].global)
+					{
+						for (int d = 0; d < size(); ++d)
+							local_prev_disp(i, d) += g.val * x_prev(g.index * size() + d);
+					}
+				}
+
+				def_grads_at_quad(vals, local_prev_disp, prev_def_grads_[e]);
+			}
+		});
+	}
+
+	void ViscousDamping::local_disp_and_prev_def_grads(const NonLinearAssemblerData &data, Eigen::MatrixXd &local_disp, Eigen::MatrixXd &prev_def_grads) const
+	{
+		const int e = data.vals.element_id;
+		bool stored = prev_x_.size() == data.x_prev.size()
+					  && e < prev_def_grads_.size()
+					  && prev_def_grads_[e].rows() == data.da.size();
+
 		local_disp.setZero(data.vals.basis_values.size(), size());
 		Eigen::MatrixXd local_prev_disp = local_disp;
 		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
@@ -85,12 +140,30 @@ namespace polyfem::assembler
 			{
 				for (int d = 0; d < size(); ++d)
 				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					local_prev_disp(i, d) += bs.global[ii].val * data.x_prev(bs.global[ii].index * size() + d);
+					const int index = bs.global[ii].index * size() + d;
+					local_disp(i, d) += bs.global[ii].val * data.x(index);
+					local_prev_disp(i, d) += bs.global[ii].val * data.x_prev(index);
+					// the stored gradients are used only if the element dofs of x_prev did not change
+					stored = stored && prev_x_(index) == data.x_prev(index);
 				}
 			}
 		}
 
+		if (stored)
+			prev_def_grads = prev_def_grads_[e];
+		else
+			def_grads_at_quad(data.vals, local_prev_disp, prev_def_grads);
+	}
+
+	// E := 0.5(F^T F - I), Compute \int F * (2\psi dE/dt + \phi Tr(dE/dt) I) : gradv du
+	Eigen::VectorXd
+	ViscousDampingPrev::assemble_gradient(const NonLinearAssemblerData &data) const
+	{
+		if (data.x_prev.size() != data.x.size())
+			return Eigen::VectorXd::Zero(data.vals.basis_values.size() * size());
+		Eigen::MatrixXd local_disp, prev_def_grads;
+		local_disp_and_prev_def_grads(data, local_disp, prev_def_grads);
+
 		Eigen::MatrixXd G;
 		G.setZero(data.vals.basis_values.size(), size());
 
@@ -112,7 +185,7 @@ namespace polyfem::assembler
 			Eigen::MatrixXd jac_it = data.vals.jac_it[p];
 
 			def_grad = local_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-			prev_def_grad = local_prev_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
+			prev_def_grad = prev_def_grads.row(p).reshaped<Eigen::RowMajor>(size(), size());
 
 			Eigen::MatrixXd delF_delU = grad * jac_it;
 
@@ -135,21 +208,8 @@ namespace polyfem::assembler
 	{
 		if (data.x_prev.size() != data.x.size())
 			return Eigen::VectorXd::Zero(data.vals.basis_values.size() * size());
-		Eigen::MatrixXd local_disp;
-		local_disp.setZero(data.vals.basis_values.size(), size());
-		Eigen::MatrixXd local_prev_disp = local_disp;
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					local_prev_disp(i, d) += bs.global[ii].val * data.x_prev(bs.global[ii].index * size() + d);
-				}
-			}
-		}
+		Eigen::MatrixXd local_disp, prev_def_grads;
+		local_disp_and_prev_def_grads(data, local_disp, prev_def_grads);
 
 		Eigen::MatrixXd G;
 		G.setZero(data.vals.basis_values.size(), size());
@@ -172,7 +232,7 @@ namespace polyfem::assembler
 			Eigen::MatrixXd jac_it = data.vals.jac_it[p];
 
 			def_grad = local_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-			prev_def_grad = local_prev_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
+			prev_def_grad = prev_def_grads.row(p).reshaped<Eigen::RowMajor>(size(), size());
 
 			Eigen::MatrixXd delF_delU = grad * jac_it;
 			auto dFdt = (def_grad - prev_def_grad) / data.dt;
@@ -199,21 +259,8 @@ namespace polyfem::assembler
 		hessian.setZero(data.vals.basis_values.size() * size(), data.vals.basis_values.size() * size());
 		if (data.x_prev.size() != data.x.size())
 			return hessian;
-		Eigen::MatrixXd local_disp;
-		local_disp.setZero(data.vals.basis_values.size(), size());
-		Eigen::MatrixXd local_prev_disp = local_disp;
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					local_prev_disp(i, d) += bs.global[ii].val * data.x_prev(bs.global[ii].index * size() + d);
-				}
-			}
-		}
+		Eigen::MatrixXd local_disp, prev_def_grads;
+		local_disp_and_prev_def_grads(data, local_disp, prev_def_grads);
 
 		const int n_pts = data.da.size();
 
@@ -232,7 +279,7 @@ namespace polyfem::assembler
 			Eigen::MatrixXd jac_it = data.vals.jac_it[p];
 
 			def_grad = local_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-			prev_def_grad = local_prev_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
+			prev_def_grad = prev_def_grads.row(p).reshaped<Eigen::RowMajor>(size(), size());
 
 			Eigen::MatrixXd dFdt = (def_grad - prev_def_grad) / data.dt;
 			compute_stress_grad_aux(def_grad, dFdt, d2RdF2, d2RdFdFdot, d2RdFdot2);
@@ -274,21 +321,8 @@ namespace polyfem::assembler
 		stress_grad_Ut.setZero(data.vals.basis_values.size() * size(), data.vals.basis_values.size() * size());
 		if (data.x_prev.size() != data.x.size())
 			return stress_grad_Ut;
-		Eigen::MatrixXd local_disp;
-		local_disp.setZero(data.vals.basis_values.size(), size());
-		Eigen::MatrixXd local_prev_disp = local_disp;
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					local_prev_disp(i, d) += bs.global[ii].val * data.x_prev(bs.global[ii].index * size() + d);
-				}
-			}
-		}
+		Eigen::MatrixXd local_disp, prev_def_grads;
+		local_disp_and_prev_def_grads(data, local_disp, prev_def_grads);
 
 		const int n_pts = data.da.size();
 
@@ -308,7 +342,7 @@ namespace polyfem::assembler
 			Eigen::MatrixXd jac_it = data.vals.jac_it[p];
 
 			def_grad = local_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-			prev_def_grad = local_prev_disp.transpose() * grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
+			prev_def_grad = prev_def_grads.row(p).reshaped<Eigen::RowMajor>(size(), size());
 
 			Eigen::MatrixXd d2RdF2, d2RdFdFdot, d2RdFdot2;
 			Eigen::MatrixXd dFdt = (def_grad - prev_def_grad) / data.dt;
@@ -346,23 +380,10 @@ namespace polyfem::assembler
 	// E := 0.5(F^T F - I), Compute Energy = \int \psi \| \frac{\partial E}{\partial t} \|^2 + 0.5 \phi (Tr(\frac{\partial E}{\partial t}))^2 du
 	double ViscousDamping::compute_energy(const NonLinearAssemblerData &data) const
 	{
-		Eigen::MatrixXd local_disp;
-		local_disp.setZero(data.vals.basis_values.size(), size());
 		if (data.x_prev.size() != data.x.size())
 			return 0;
-		Eigen::MatrixXd local_prev_disp = local_disp;
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					local_prev_disp(i, d) += bs.global[ii].val * data.x_prev(bs.global[ii].index * size() + d);
-				}
-			}
-		}
+		Eigen::MatrixXd local_disp, prev_def_grads;
+		local_disp_and_prev_def_grads(data, local_disp, prev_def_grads);
 
 		double energy = 0;
 		const int n_pts = data.da.size();
@@ -382,7 +403,6 @@ namespace polyfem::assembler
 					for (int c = 0; c < size(); ++c)
 					{
 						def_grad(d, c) += bs.grad(p, c) * local_disp(i, d);
-						prev_def_grad(d, c) += bs.grad(p, c) * local_prev_disp(i, d);
 					}
 				}
 			}
@@ -392,7 +412,7 @@ namespace polyfem::assembler
 				jac_it(k) = data.vals.jac_it[p](k);
 
 			def_grad = def_grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
-			prev_def_grad = prev_def_grad * jac_it + Eigen::MatrixXd::Identity(size(), size());
+			prev_def_grad = prev_def_grads.row(p).reshaped<Eigen::RowMajor>(size(), size());
 
 			Eigen::MatrixXd dFdt = (def_grad - prev_def_grad) / data.dt;
 			Eigen::MatrixXd dEdt = 0.5 * (dFdt.transpose() * def_grad + def_grad.transpose() * dFdt);
@@ -54,6 +54,14 @@ namespace polyfem
 
 			const DampingParameters &damping_params() const { return damping_params_; }
 
+			/// @brief Stores the deformation gradient at x_prev at the quadrature points of every element, so
+			/// that the assembly only evaluates the current one. Called when the time step advances.
+			void update_prev_def_grads(const bool is_volume,
+									   const std::vector<basis::ElementBases> &bases,
+									   const std::vector<basis::ElementBases> &gbases,
+									   const AssemblyValsCache &cache,
+									   const Eigen::VectorXd &x_prev) const;
+
 		protected:
 			// material parameters controlling shear and bulk damping
 			// double psi_ = 0, phi_ = 0;
@@ -61,6 +69,17 @@ namespace polyfem
 
 			void compute_stress_aux(const Eigen::MatrixXd &F, const Eigen::MatrixXd &dFdt, Eigen::MatrixXd &dRdF, Eigen::MatrixXd &dRdFdot) const;
 			void compute_stress_grad_aux(const Eigen::MatrixXd &F, const Eigen::MatrixXd &dFdt, Eigen::MatrixXd &d2RdF2, Eigen::MatrixXd &d2RdFdFdot, Eigen::MatrixXd &d2RdFdot2) const;
+
+			/// @brief Local displacement of the element at data.x and deformation gradients at data.x_prev
+			/// @param[out] local_disp #bases x dim
+			/// @param[out] prev_def_grads #quadrature points x dim², row-major F per row, from update_prev_def_grads if it was called with data.x_prev
+			void local_disp_and_prev_def_grads(const NonLinearAssemblerData &data, Eigen::MatrixXd &local_disp, Eigen::MatrixXd &prev_def_grads) const;
+
+		private:
+			/// x_prev the stored deformation gradients were computed at
+			mutable Eigen::VectorXd prev_x_;
+			/// deformation gradients at prev_x_ of every element, #quadrature points x dim²
+			mutable std::vector<Eigen::MatrixXd> prev_def_grads_;
 		};
 
 		class ViscousDampingPrev : public ViscousDamping
@@ -31,7 +31,8 @@ namespace polyfem
 				auto y = uv.col(1).array();
 
 				val.resize(uv.rows(), uv.cols());
-				Eigen::ArrayXd result_0(uv.rows());
+				static thread_local Eigen::ArrayXd result_0;
+				result_0.resize(uv.rows());
 				switch (local_index)
 				{
 				case 0:
@@ -91,7 +92,8 @@ namespace polyfem
 				auto y = uv.col(1).array();
 
 				val.resize(uv.rows(), uv.cols());
-				Eigen::ArrayXd result_0(uv.rows());
+				static thread_local Eigen::ArrayXd result_0;
+				result_0.resize(uv.rows());
 				switch (local_index)
 				{
 				case 0:
@@ -192,7 +194,8 @@ namespace polyfem
 				auto y = uv.col(1).array();
 
 				val.resize(uv.rows(), uv.cols());
-				Eigen::ArrayXd result_0(uv.rows());
+				static thread_local Eigen::ArrayXd result_0;
+				result_0.resize(uv.rows());
 				switch (local_index)
 				{
 				case 0:
@@ -354,7 +357,8 @@ namespace polyfem
 				auto y = uv.col(1).array();
 
 				val.resize(uv.rows(), uv.cols());
-				Eigen::ArrayXd result_0(uv.rows());
+				static thread_local Eigen::ArrayXd result_0;
+				result_0.resize(uv.rows());
 				switch (local_index)
 				{
 				case 0:
@@ -606,7 +610,8 @@ namespace polyfem
 				auto y = uv.col(1).array();
 
 				val.resize(uv.rows(), uv.cols());
-				Eigen::ArrayXd result_0(uv.rows());
+				static thread_local Eigen::ArrayXd result_0;
+				result_0.resize(uv.rows());
 				switch (local_index)
 				{
 				case 0:
@@ -932,7 +937,8 @@ namespace polyfem
 				auto z = uv.col(2).array();
 
 				val.resize(uv.rows(), uv.cols());
-				Eigen::ArrayXd result_0(uv.rows());
+				static thread_local Eigen::ArrayXd result_0;
+				result_0.resize(uv.rows());
 				switch (local_index)
 				{
 				case 0:
@@ -1003,7 +1009,8 @@ namespace polyfem
 				auto z = uv.col(2).array();
 
 				val.resize(uv.rows(), uv.cols());
-				Eigen::ArrayXd result_0(uv.rows());
+				static thread_local Eigen::ArrayXd result_0;
+				result_0.resize(uv.rows());
 				switch (local_index)
 				{
 				case 0:
@@ -1155,7 +1162,8 @@ namespace polyfem
 				auto z = uv.col(2).array();
 
 				val.resize(uv.rows(), uv.cols());
-				Eigen::ArrayXd result_0(uv.rows());
+				static thread_local Eigen::ArrayXd result_0;
+				result_0.resize(uv.rows());
 				switch (local_index)
 				{
 				case 0:
@@ -1468,7 +1476,8 @@ namespace polyfem
 				auto z = uv.col(2).array();
 
 				val.resize(uv.rows(), uv.cols());
-				Eigen::ArrayXd result_0(uv.rows());
+				static thread_local Eigen::ArrayXd result_0;
+				result_0.resize(uv.rows());
 				switch (local_index)
 				{
 				case 0:
@@ -2086,7 +2095,8 @@ namespace polyfem
 				auto z = uv.col(2).array();
 
 				val.resize(uv.rows(), uv.cols());
-				Eigen::ArrayXd result_0(uv.rows());
+				static thread_local Eigen::ArrayXd result_0;
+				result_0.resize(uv.rows());
 				switch (local_index)
 				{
 				case 0:
@@ -10,7 +10,8 @@ auto x=uv.col(0).array();
 auto y=uv.col(1).array();
 
 val.resize(uv.rows(), uv.cols());
- Eigen::ArrayXd result_0(uv.rows());
+ static thread_local Eigen::ArrayXd result_0;
+ result_0.resize(uv.rows());
 switch(local_index){
 	case 0: {{result_0.setZero();val.col(0) = result_0; }{result_0.setZero();val.col(1) = result_0; }} break;
 	default: assert(false);
@@ -22,7 +23,8 @@ auto x=uv.col(0).array();
 auto y=uv.col(1).array();
 
 val.resize(uv.rows(), uv.cols());
- Eigen::ArrayXd result_0(uv.rows());
+ static thread_local Eigen::ArrayXd result_0;
+ result_0.resize(uv.rows());
 switch(local_index){
 	case 0: {{result_0 = 1.0*(y - 1);val.col(0) = result_0; }{result_0 = 1.0*(x - 1);val.col(1) = result_0; }} break;
 	case 1: {{result_0 = 1.0*(1 - y);val.col(0) = result_0; }{result_0 = -1.0*x;val.col(1) = result_0; }} break;
@@ -37,7 +39,8 @@ auto x=uv.col(0).array();
 auto y=uv.col(1).array();
 
 val.resize(uv.rows(), uv.cols());
- Eigen::ArrayXd result_0(uv.rows());
+ static thread_local Eigen::ArrayXd result_0;
+ result_0.resize(uv.rows());
 switch(local_index){
 	case 0: {{result_0 = (4.0*x - 3.0)*(y - 1)*(2.0*y - 1.0);val.col(0) = result_0; }{result_0 = (x - 1)*(2.0*x - 1.0)*(4.0*y - 3.0);val.col(1) = result_0; }} break;
 	case 1: {{result_0 = (4.0*x - 1.0)*(y - 1)*(2.0*y - 1.0);val.col(0) = result_0; }{result_0 = x*(2.0*x - 1.0)*(4.0*y - 3.0);val.col(1) = result_0; }} break;
@@ -57,7 +60,8 @@ auto x=uv.col(0).array();
 auto y=uv.col(1).array();
 
 val.resize(uv.rows(), uv.cols());
- Eigen::ArrayXd result_0(uv.rows());
+ static thread_local Eigen::ArrayXd result_0;
+ result_0.resize(uv.rows());
 switch(local_index){
 	case 0: {{const auto helper_0 = x - 1;
 const auto helper_1 = 1.5*x - 1.0;
@@ -164,7 +168,8 @@ auto x=uv.col(0).array();
 auto y=uv.col(1).array();
 
 val.resize(uv.rows(), uv.cols());
- Eigen::ArrayXd result_0(uv.rows());
+ static thread_local Eigen::ArrayXd result_0;
+ result_0.resize(uv.rows());
 switch(local_index){
 	case 0: {{result_0 = -(y - 1)*(4.0*x + 2.0*y - 3.0);val.col(0) = result_0; }{result_0 = -(x - 1)*(2.0*x + 4.0*y - 3.0);val.col(1) = result_0; }} break;
 	case 1: {{result_0 = (y - 1)*(-4.0*x + 2*y + 1);val.col(0) = result_0; }{result_0 = -x*(2.0*x - 4.0*y + 1.0);val.col(1) = result_0; }} break;
@@ -8,7 +8,8 @@ auto y=uv.col(1).array();
 auto z=uv.col(2).array();
 
 val.resize(uv.rows(), uv.cols());
- Eigen::ArrayXd result_0(uv.rows());
+ static thread_local Eigen::ArrayXd result_0;
+ result_0.resize(uv.rows());
 switch(local_index){
 	case 0: {{result_0 = (y - 1)*(z - 1)*(4.0*x + 2*y + 2*z - 3.0);val.col(0) = result_0; }{result_0 = (x - 1)*(z - 1)*(2.0*x + 4.0*y + 2.0*z - 3.0);val.col(1) = result_0; }{result_0 = (x - 1)*(y - 1)*(2.0*x + 2.0*y + 4.0*z - 3.0);val.col(2) = result_0; }} break;
 	case 1: {{result_0 = -(y - 1)*(z - 1)*(-4.0*x + 2.0*y + 2.0*z + 1.0);val.col(0) = result_0; }{result_0 = x*(z - 1)*(2.0*x - 4.0*y - 2.0*z + 1.0);val.col(1) = result_0; }{result_0 = x*(y - 1)*(2.0*x - 2.0*y - 4.0*z + 1.0);val.col(2) = result_0; }} break;
@@ -8,7 +8,8 @@ auto y=uv.col(1).array();
 auto z=uv.col(2).array();
 
 val.resize(uv.rows(), uv.cols());
- Eigen::ArrayXd result_0(uv.rows());
+ static thread_local Eigen::ArrayXd result_0;
+ result_0.resize(uv.rows());
 switch(local_index){
 	case 0: {{result_0.setZero();val.col(0) = result_0; }{result_0.setZero();val.col(1) = result_0; }{result_0.setZero();val.col(2) = result_0; }} break;
 	default: assert(false);
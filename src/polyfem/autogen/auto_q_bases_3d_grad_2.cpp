@@ -8,7 +8,8 @@ auto y=uv.col(1).array();
 auto z=uv.col(2).array();
 
 val.resize(uv.rows(), uv.cols());
- Eigen::ArrayXd result_0(uv.rows());
+ static thread_local Eigen::ArrayXd result_0;
+ result_0.resize(uv.rows());
 switch(local_index){
 	case 0: {{result_0 = (4.0*x - 3.0)*(y - 1)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);val.col(0) = result_0; }{result_0 = (x - 1)*(2.0*x - 1.0)*(4.0*y - 3.0)*(z - 1)*(2.0*z - 1.0);val.col(1) = result_0; }{result_0 = (x - 1)*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(4.0*z - 3.0);val.col(2) = result_0; }} break;
 	case 1: {{result_0 = (4.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(z - 1)*(2.0*z - 1.0);val.col(0) = result_0; }{result_0 = x*(2.0*x - 1.0)*(4.0*y - 3.0)*(z - 1)*(2.0*z - 1.0);val.col(1) = result_0; }{result_0 = x*(2.0*x - 1.0)*(y - 1)*(2.0*y - 1.0)*(4.0*z - 3.0);val.col(2) = result_0; }} break;
@@ -8,7 +8,8 @@ auto y=uv.col(1).array();
 auto z=uv.col(2).array();
 
 val.resize(uv.rows(), uv.cols());
- Eigen::ArrayXd result_0(uv.rows());
+ static thread_local Eigen::ArrayXd result_0;
+ result_0.resize(uv.rows());
 switch(local_index){
 	case 0: {{const auto helper_0 = x - 1;
 const auto helper_1 = 1.5*x - 1.0;
@@ -0,0 +1,227 @@
+#include "p_all_bases.hpp"
+#include "auto_p_bases.hpp"
+
+#include <cassert>
+
+namespace polyfem
+{
+	namespace autogen
+	{
+		// P1 and P2 share the barycentric coordinates between the bases, higher orders
+		// fall back to the per basis functions
+
+		int p_n_bases_2d(const int p)
+		{
+			return (p + 1) * (p + 2) / 2;
+		}
+
+		int p_n_bases_3d(const int p)
+		{
+			return (p + 1) * (p + 2) * (p + 3) / 6;
+		}
+
+		void p_basis_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)
+		{
+			assert(uv.cols() == 2);
+
+			const int n_bases = p_n_bases_2d(p);
+			val.resize(uv.rows(), n_bases);
+
+			const auto x = uv.col(0).array();
+			const auto y = uv.col(1).array();
+
+			if (p == 1)
+			{
+				val.col(0).array() = 1 - x - y;
+				val.col(1).array() = x;
+				val.col(2).array() = y;
+			}
+			else if (p == 2)
+			{
+				const Eigen::ArrayXd l = 1 - x - y;
+				val.col(0).array() = l * (2 * l - 1);
+				val.col(1).array() = x * (2 * x - 1);
+				val.col(2).array() = y * (2 * y - 1);
+				val.col(3).array() = 4 * x * l;
+				val.col(4).array() = 4 * x * y;
+				val.col(5).array() = 4 * y * l;
+			}
+			else
+			{
+				Eigen::MatrixXd tmp;
+				for (int j = 0; j < n_bases; ++j)
+				{
+					p_basis_value_2d(p, j, uv, tmp);
+					val.col(j) = tmp;
+				}
+			}
+		}
+
+		void p_grad_basis_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)
+		{
+			assert(uv.cols() == 2);
+
+			const int n_bases = p_n_bases_2d(p);
+			val.resize(uv.rows(), 2 * n_bases);
+
+			const auto x = uv.col(0).array();
+			const auto y = uv.col(1).array();
+
+			if (p == 1)
+			{
+				val.col(0).setConstant(-1);
+				val.col(1).setConstant(-1);
+				val.col(2).setOnes();
+				val.col(3).setZero();
+				val.col(4).setZero();
+				val.col(5).setOnes();
+			}
+			else if (p == 2)
+			{
+				const Eigen::ArrayXd l = 1 - x - y;
+				val.col(0).array() = 4 * x + 4 * y - 3;
+				val.col(1) = val.col(0);
+
+				val.col(2).array() = 4 * x - 1;
+				val.col(3).setZero();
+
+				val.col(4).setZero();
+				val.col(5).array() = 4 * y - 1;
+
+				val.col(6).array() = 4 * (l - x);
+				val.col(7).array() = -4 * x;
+
+				val.col(8).array() = 4 * y;
+				val.col(9).array() = 4 * x;
+
+				val.col(10).array() = -4 * y;
+				val.col(11).array() = 4 * (l - y);
+			}
+			else
+			{
+				Eigen::MatrixXd tmp;
+				for (int j = 0; j < n_bases; ++j)
+				{
+					p_grad_basis_value_2d(p, j, uv, tmp);
+					val.middleCols<2>(2 * j) = tmp;
+				}
+			}
+		}
+
+		void p_basis_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)
+		{
+			assert(uv.cols() == 3);
+
+			const int n_bases = p_n_bases_3d(p);
+			val.resize(uv.rows(), n_bases);
+
+			const auto x = uv.col(0).array();
+			const auto y = uv.col(1).array();
+			const auto z = uv.col(2).array();
+
+			if (p == 1)
+			{
+				val.col(0).array() = 1 - x - y - z;
+				val.col(1).array() = x;
+				val.col(2).array() = y;
+				val.col(3).array() = z;
+			}
+			else if (p == 2)
+			{
+				const Eigen::ArrayXd l = 1 - x - y - z;
+				val.col(0).array() = l * (2 * l - 1);
+				val.col(1).array() = x * (2 * x - 1);
+				val.col(2).array() = y * (2 * y - 1);
+				val.col(3).array() = z * (2 * z - 1);
+				val.col(4).array() = 4 * x * l;
+				val.col(5).array() = 4 * x * y;
+				val.col(6).array() = 4 * y * l;
+				val.col(7).array() = 4 * z * l;
+				val.col(8).array() = 4 * x * z;
+				val.col(9).array() = 4 * y * z;
+			}
+			else
+			{
+				Eigen::MatrixXd tmp;
+				for (int j = 0; j < n_bases; ++j)
+				{
+					p_basis_value_3d(p, j, uv, tmp);
+					val.col(j) = tmp;
+				}
+			}
+		}
+
+		void p_grad_basis_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)
+		{
+			assert(uv.cols() == 3);
+
+			const int n_bases = p_n_bases_3d(p);
+			val.resize(uv.rows(), 3 * n_bases);
+
+			const auto x = uv.col(0).array();
+			const auto y = uv.col(1).array();
+			const auto z = uv.col(2).array();
+
+			if (p == 1)
+			{
+				val.setZero();
+				val.leftCols<3>().setConstant(-1);
+				val.col(3).setOnes();
+				val.col(7).setOnes();
+				val.col(11).setOnes();
+			}
+			else if (p == 2)
+			{
+				const Eigen::ArrayXd l = 1 - x - y - z;
+				val.col(0).array() = 4 * x + 4 * y + 4 * z - 3;
+				val.col(1) = val.col(0);
+				val.col(2) = val.col(0);
+
+				val.col(3).array() = 4 * x - 1;
+				val.col(4).setZero();
+				val.col(5).setZero();
+
+				val.col(6).setZero();
+				val.col(7).array() = 4 * y - 1;
+				val.col(8).setZero();
+
+				val.col(9).setZero();
+				val.col(10).setZero();
+				val.col(11).array() = 4 * z - 1;
+
+				val.col(12).array() = 4 * (l - x);
+				val.col(13).array() = -4 * x;
+				val.col(14).array() = -4 * x;
+
+				val.col(15).array() = 4 * y;
+				val.col(16).array() = 4 * x;
+				val.col(17).setZero();
+
+				val.col(18).array() = -4 * y;
+				val.col(19).array() = 4 * (l - y);
+				val.col(20).array() = -4 * y;
+
+				val.col(21).array() = -4 * z;
+				val.col(22).array() = -4 * z;
+				val.col(23).array() = 4 * (l - z);
+
+				val.col(24).array() = 4 * z;
+				val.col(25).setZero();
+				val.col(26).array() = 4 * x;
+
+				val.col(27).setZero();
+				val.col(28).array() = 4 * z;
+				val.col(29).array() = 4 * y;
+			}
+			else
+			{
+				Eigen::MatrixXd tmp;
+				for (int j = 0; j < n_bases; ++j)
+				{
+					p_grad_basis_value_3d(p, j, uv, tmp);
+					val.middleCols<3>(3 * j) = tmp;
+				}
+			}
+		}
+	} // namespace autogen
+} // namespace polyfem
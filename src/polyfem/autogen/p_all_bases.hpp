@@ -0,0 +1,23 @@
+#pragma once
+#include <Eigen/Dense>
+
+namespace polyfem
+{
+	namespace autogen
+	{
+		/// number of Lagrange bases of order p on the reference triangle
+		int p_n_bases_2d(const int p);
+		/// number of Lagrange bases of order p on the reference tetrahedron
+		int p_n_bases_3d(const int p);
+
+		/// evaluate all the P bases of order p at once, val is (n_pts x n_bases)
+		void p_basis_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+		/// evaluate all the P bases gradients of order p at once, val is (n_pts x 2 n_bases), basis j is in columns 2j, 2j+1
+		void p_grad_basis_values_2d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
+		/// evaluate all the P bases of order p at once, val is (n_pts x n_bases)
+		void p_basis_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+		/// evaluate all the P bases gradients of order p at once, val is (n_pts x 3 n_bases), basis j is in columns 3j, 3j+1, 3j+2
+		void p_grad_basis_values_3d(const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+	} // namespace autogen
+} // namespace polyfem
@@ -547,7 +547,7 @@ if __name__ == "__main__":
 
             base = base + "switch(local_index){\n"
             dbase = dbase + \
-                "val.resize(uv.rows(), uv.cols());\n Eigen::ArrayXd result_0(uv.rows());\n" + \
+                "val.resize(uv.rows(), uv.cols());\n static thread_local Eigen::ArrayXd result_0;\n result_0.resize(uv.rows());\n" + \
                 "switch(local_index){\n"
 
             for i in range(0, fe.nbf()):
@@ -21,5 +21,19 @@ namespace polyfem
 
 			local_index_ = local_index;
 		}
+
+		void Basis::set_basis(const Fun &fun)
+		{
+			auto functions = functions_ ? std::make_shared<Functions>(*functions_) : std::make_shared<Functions>();
+			functions->basis = fun;
+			functions_ = functions;
+		}
+
+		void Basis::set_grad(const Fun &fun)
+		{
+			auto functions = functions_ ? std::make_shared<Functions>(*functions_) : std::make_shared<Functions>();
+			functions->grad = fun;
+			functions_ = functions;
+		}
 	} // namespace basis
 } // namespace polyfem
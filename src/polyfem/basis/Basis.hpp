@@ -6,6 +6,7 @@
 #include <Eigen/Dense>
 #include <functional>
 
+#include <memory>
 #include <vector>
 
 namespace polyfem
@@ -46,6 +47,13 @@ namespace polyfem
 		public:
 			typedef std::function<void(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)> Fun;
 
+			/// value and gradient of a basis, shared by the bases with the same function on the reference element
+			struct Functions
+			{
+				Fun basis;
+				Fun grad;
+			};
+
 			Basis();
 
 			///
@@ -71,8 +79,8 @@ namespace polyfem
 			///
 			void eval_basis(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) const
 			{
-				assert(basis_);
-				basis_(uv, val);
+				assert(is_defined());
+				functions_->basis(uv, val);
 			}
 
 			///
@@ -96,8 +104,8 @@ namespace polyfem
 			///
 			void eval_grad(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) const
 			{
-				assert(grad_);
-				grad_(uv, val);
+				assert(functions_ && functions_->grad);
+				functions_->grad(uv, val);
 			}
 
 			// list of local to global mappings
@@ -105,10 +113,12 @@ namespace polyfem
 			inline std::vector<Local2Global> &global() { return global_; }
 
 			// setting the basis lambda and its gradient
-			inline void set_basis(const Fun &fun) { basis_ = fun; }
-			inline void set_grad(const Fun &fun) { grad_ = fun; }
+			void set_basis(const Fun &fun);
+			void set_grad(const Fun &fun);
+			/// shares the basis and gradient with other bases (e.g., the same local basis of all the Lagrange elements of a given order)
+			inline void set_functions(const std::shared_ptr<const Functions> &functions) { functions_ = functions; }
 
-			inline bool is_defined() const { return (basis_ ? true : false); }
+			inline bool is_defined() const { return functions_ && functions_->basis; }
 			inline int order() const { return order_; }
 
 			// output
@@ -126,8 +136,7 @@ namespace polyfem
 			int local_index_;                  ///< local index inside the element (for debugging purposes)
 			int order_;
 
-			Fun basis_; ///< basis and gadient
-			Fun grad_;
+			std::shared_ptr<const Functions> functions_; ///< basis and gadient
 		};
 	} // namespace basis
 } // namespace polyfem
@@ -38,6 +38,22 @@ namespace polyfem
 			// or directly in the object domain (harmonic bases)
 			bool has_parameterization = true;
 
+			/// elements with the same non-negative key have the same basis values on the reference element
+			/// (e.g., Lagrange bases of the same type and order), -1 if the values depend on the element
+			int reference_key = -1;
+
+			/// reference key of the Lagrange bases of the given dimension, element type, and order (-2 for serendipity)
+			static int lagrange_reference_key(const int dim, const bool is_simplex, const int order)
+			{
+				return (2 * (dim - 2) + (is_simplex ? 0 : 1)) * 32 + order + 2;
+			}
+
+			/// reference key of the quadratic spline bases of the given dimension, pattern encodes which neighbors are absent (see SplineBasis2d/3d)
+			static int spline_reference_key(const int dim, const int pattern)
+			{
+				return 4 * 32 + (dim - 2) * 64 + pattern;
+			}
+
 			/// @brief Map the sample positions in the parametric domain to the object domain (if the element has no parameterization, e.g. harmonic bases, then the parametric domain = object domain,
 			/// and the mapping is identity)
 			///
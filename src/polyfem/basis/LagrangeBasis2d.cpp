@@ -4,6 +4,7 @@
 #include <polyfem/quadrature/TriQuadrature.hpp>
 #include <polyfem/quadrature/QuadQuadrature.hpp>
 #include <polyfem/autogen/auto_p_bases.hpp>
+#include <polyfem/autogen/p_all_bases.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
 
 #include <polyfem/assembler/AssemblerUtils.hpp>
@@ -12,6 +13,8 @@
 
 #include <cassert>
 #include <array>
+#include <map>
+#include <memory>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -606,6 +609,43 @@ namespace
 			if (mesh.leader_edge_of_edge(i) >= 0)
 				edge_orders[i] = std::min(edge_orders[mesh.leader_edge_of_edge(i)], edge_orders[i]);
 	}
+	typedef std::map<std::pair<bool, int>, std::vector<std::shared_ptr<const Basis::Functions>>> LagrangeFunctions;
+
+	/// value and gradient of the local bases of the Lagrange elements of every type and order (-2 for serendipity) in the mesh,
+	/// shared by the elements instead of two closures per basis
+	LagrangeFunctions lagrange_functions(const Mesh2D &mesh, const Eigen::VectorXi &discr_orders, const bool serendipity)
+	{
+		LagrangeFunctions res;
+		for (int e = 0; e < mesh.n_faces(); ++e)
+		{
+			const bool is_simplex = mesh.is_simplex(e);
+			if (!is_simplex && !mesh.is_cube(e))
+				continue;
+
+			const int order = (!is_simplex && serendipity) ? -2 : discr_orders(e);
+			auto &functions = res[{is_simplex, order}];
+			if (!functions.empty())
+				continue;
+
+			const int n_bases = is_simplex ? autogen::p_n_bases_2d(order) : (order == -2 ? 8 : (order + 1) * (order + 1));
+			for (int j = 0; j < n_bases; ++j)
+			{
+				auto f = std::make_shared<Basis::Functions>();
+				if (is_simplex)
+				{
+					f->basis = [order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_basis_value_2d(order, j, uv, val); };
+					f->grad = [order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_2d(order, j, uv, val); };
+				}
+				else
+				{
+					f->basis = [order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_2d(order, j, uv, val); };
+					f->grad = [order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_2d(order, j, uv, val); };
+				}
+				functions.push_back(f);
+			}
+		}
+		return res;
+	}
 } // anonymous namespace
 
 Eigen::VectorXi LagrangeBasis2d::tri_edge_local_nodes(const int p, const Mesh2D &mesh, Navigation::Index index)
@@ -731,12 +771,15 @@ int LagrangeBasis2d::build_bases(
 	std::vector<int> interface_elements;
 	interface_elements.reserve(mesh.n_faces());
 
+	const LagrangeFunctions shared_functions = lagrange_functions(mesh, discr_orders, serendipity);
+
 	for (int e = 0; e < mesh.n_faces(); ++e)
 	{
 		ElementBases &b = bases[e];
 		const int discr_order = discr_orders(e);
 		const int n_el_bases = element_nodes_id[e].size();
 		b.bases.resize(n_el_bases);
+		b.reference_key = -1;
 
 		bool skip_interface_element = false;
 
@@ -791,11 +834,10 @@ int LagrangeBasis2d::build_bases(
 				// if(!skip_interface_element)
 				b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
 
-				const int dtmp = serendipity ? -2 : discr_order;
-
-				b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_2d(dtmp, j, uv, val); });
-				b.bases[j].set_grad([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_2d(dtmp, j, uv, val); });
+				b.bases[j].set_functions(shared_functions.at({false, serendipity ? -2 : discr_order})[j]);
 			}
+
+			b.reference_key = ElementBases::lagrange_reference_key(2, false, serendipity ? -2 : discr_order);
 		}
 		else if (mesh.is_simplex(e))
 		{
@@ -882,10 +924,30 @@ int LagrangeBasis2d::build_bases(
 				else
 				{
 					// pick out basis functions using autogenerated code
-					b.bases[j].set_basis([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_basis_value_2d(discr_order, j, uv, val); });
-					b.bases[j].set_grad([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_2d(discr_order, j, uv, val); });
+					b.bases[j].set_functions(shared_functions.at({true, discr_order})[j]);
 				}
 			}
+
+			if (!rational)
+			{
+				// evaluate all the bases at once
+				b.set_bases_func([discr_order](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) {
+					Eigen::MatrixXd val;
+					autogen::p_basis_values_2d(discr_order, uv, val);
+					basis_values.resize(val.cols());
+					for (int j = 0; j < val.cols(); ++j)
+						basis_values[j].val = val.col(j);
+				});
+				b.set_grads_func([discr_order](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) {
+					Eigen::MatrixXd grad;
+					autogen::p_grad_basis_values_2d(discr_order, uv, grad);
+					basis_values.resize(grad.cols() / 2);
+					for (int j = 0; j < int(basis_values.size()); ++j)
+						basis_values[j].grad = grad.middleCols<2>(2 * j);
+				});
+
+				b.reference_key = ElementBases::lagrange_reference_key(2, true, discr_order);
+			}
 		}
 		else
 		{
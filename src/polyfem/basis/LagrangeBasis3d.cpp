@@ -9,12 +9,15 @@
 #include <polyfem/assembler/AssemblerUtils.hpp>
 
 #include <polyfem/autogen/auto_p_bases.hpp>
+#include <polyfem/autogen/p_all_bases.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
 
 #include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <cassert>
 #include <array>
+#include <map>
+#include <memory>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -562,63 +565,77 @@ namespace
 			face_virtual_nodes.resize(ncmesh.n_faces());
 		}
 
+		// node ids are assigned lazily in element order, this keeps the numbering of the dofs stable
 		for (int c = 0; c < mesh.n_cells(); ++c)
 		{
 			const int discr_order = discr_orders(c);
 
 			if (mesh.is_cube(c))
-			{
 				hex_local_to_global(serendipity, discr_order, mesh, c, discr_orders, element_nodes_id[c], nodes);
-
-				auto v = hex_vertices_local_to_global(mesh, c);
-				Eigen::Matrix<int, 6, 4> fv;
-				fv.row(0) << v[0], v[3], v[4], v[7];
-				fv.row(1) << v[1], v[2], v[5], v[6];
-				fv.row(2) << v[0], v[1], v[5], v[4];
-				fv.row(3) << v[3], v[2], v[6], v[7];
-				fv.row(4) << v[0], v[1], v[2], v[3];
-				fv.row(5) << v[4], v[5], v[6], v[7];
-
-				LocalBoundary lb(c, BoundaryType::QUAD);
-				for (int i = 0; i < fv.rows(); ++i)
-				{
-					const int f = find_quad_face(mesh, c, fv(i, 0), fv(i, 1), fv(i, 2), fv(i, 3)).face;
-
-					if (mesh.is_boundary_face(f) || mesh.get_boundary_id(f) > 0)
-					{
-						lb.add_boundary_primitive(f, i);
-					}
-				}
-
-				if (!lb.empty())
-					local_boundary.emplace_back(lb);
-			}
 			else if (mesh.is_simplex(c))
 			{
 				// element_nodes_id[c] = polyfem::LagrangeBasis3d::tet_local_to_global(discr_order, mesh, c, discr_orders, nodes);
 				tet_local_to_global(is_geom_bases, discr_order, mesh, c, discr_orders, edge_orders, face_orders, element_nodes_id[c], nodes, edge_virtual_nodes, face_virtual_nodes);
+			}
+		}
 
-				auto v = tet_vertices_local_to_global(mesh, c);
-				Eigen::Matrix<int, 4, 3> fv;
-				fv.row(0) << v[0], v[1], v[2];
-				fv.row(1) << v[0], v[1], v[3];
-				fv.row(2) << v[1], v[2], v[3];
-				fv.row(3) << v[2], v[0], v[3];
-
-				LocalBoundary lb(c, BoundaryType::TRI);
-				for (long i = 0; i < fv.rows(); ++i)
+		// boundary facets (global id, local id) of every element
+		std::vector<std::vector<std::pair<int, int>>> boundary_facets(mesh.n_cells());
+		polyfem::utils::maybe_parallel_for(mesh.n_cells(), [&](int start, int end, int thread_id) {
+			for (int c = start; c < end; ++c)
+			{
+				if (mesh.is_cube(c))
 				{
-					const int f = mesh.get_index_from_element_face(c, fv(i, 0), fv(i, 1), fv(i, 2)).face;
-
-					if (mesh.is_boundary_face(f))
+					auto v = hex_vertices_local_to_global(mesh, c);
+					Eigen::Matrix<int, 6, 4> fv;
+					fv.row(0) << v[0], v[3], v[4], v[7];
+					fv.row(1) << v[1], v[2], v[5], v[6];
+					fv.row(2) << v[0], v[1], v[5], v[4];
+					fv.row(3) << v[3], v[2], v[6], v[7];
+					fv.row(4) << v[0], v[1], v[2], v[3];
+					fv.row(5) << v[4], v[5], v[6], v[7];
+
+					for (int i = 0; i < fv.rows(); ++i)
 					{
-						lb.add_boundary_primitive(f, i);
+						const int f = find_quad_face(mesh, c, fv(i, 0), fv(i, 1), fv(i, 2), fv(i, 3)).face;
+
+						if (mesh.is_boundary_face(f) || mesh.get_boundary_id(f) > 0)
+						{
+							boundary_facets[c].emplace_back(f, i);
+						}
 					}
 				}
+				else if (mesh.is_simplex(c))
+				{
+					auto v = tet_vertices_local_to_global(mesh, c);
+					Eigen::Matrix<int, 4, 3> fv;
+					fv.row(0) << v[0], v[1], v[2];
+					fv.row(1) << v[0], v[1], v[3];
+					fv.row(2) << v[1], v[2], v[3];
+					fv.row(3) << v[2], v[0], v[3];
+
+					for (long i = 0; i < fv.rows(); ++i)
+					{
+						const int f = mesh.get_index_from_element_face(c, fv(i, 0), fv(i, 1), fv(i, 2)).face;
 
-				if (!lb.empty())
-					local_boundary.emplace_back(lb);
+						if (mesh.is_boundary_face(f))
+						{
+							boundary_facets[c].emplace_back(f, i);
+						}
+					}
+				}
 			}
+		});
+
+		for (int c = 0; c < mesh.n_cells(); ++c)
+		{
+			if (boundary_facets[c].empty())
+				continue;
+
+			LocalBoundary lb(c, mesh.is_cube(c) ? BoundaryType::QUAD : BoundaryType::TRI);
+			for (const auto &[f, i] : boundary_facets[c])
+				lb.add_boundary_primitive(f, i);
+			local_boundary.emplace_back(lb);
 		}
 
 		if (!has_polys)
@@ -874,6 +891,43 @@ namespace
 			}
 		}
 	}
+	typedef std::map<std::pair<bool, int>, std::vector<std::shared_ptr<const Basis::Functions>>> LagrangeFunctions;
+
+	/// value and gradient of the local bases of the Lagrange elements of every type and order (-2 for serendipity) in the mesh,
+	/// shared by the elements instead of two closures per basis
+	LagrangeFunctions lagrange_functions(const Mesh3D &mesh, const Eigen::VectorXi &discr_orders, const bool serendipity)
+	{
+		LagrangeFunctions res;
+		for (int e = 0; e < mesh.n_cells(); ++e)
+		{
+			const bool is_simplex = mesh.is_simplex(e);
+			if (!is_simplex && !mesh.is_cube(e))
+				continue;
+
+			const int order = (!is_simplex && serendipity) ? -2 : discr_orders(e);
+			auto &functions = res[{is_simplex, order}];
+			if (!functions.empty())
+				continue;
+
+			const int n_bases = is_simplex ? autogen::p_n_bases_3d(order) : (order == -2 ? 20 : (order + 1) * (order + 1) * (order + 1));
+			for (int j = 0; j < n_bases; ++j)
+			{
+				auto f = std::make_shared<Basis::Functions>();
+				if (is_simplex)
+				{
+					f->basis = [order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_basis_value_3d(order, j, uv, val); };
+					f->grad = [order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_3d(order, j, uv, val); };
+				}
+				else
+				{
+					f->basis = [order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_3d(order, j, uv, val); };
+					f->grad = [order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_3d(order, j, uv, val); };
+				}
+				functions.push_back(f);
+			}
+		}
+		return res;
+	}
 } // anonymous namespace
 
 Eigen::VectorXi LagrangeBasis3d::tet_face_local_nodes(const int p, const Mesh3D &mesh, Navigation3D::Index index)
@@ -1439,120 +1493,148 @@ int LagrangeBasis3d::build_bases(
 	// std::cout<<"switch_element_time " << Navigation3D::switch_element_time <<std::endl;
 
 	bases.resize(mesh.n_cells());
-	std::vector<int> interface_elements;
-	interface_elements.reserve(mesh.n_faces());
-
-	for (int e = 0; e < mesh.n_cells(); ++e)
-	{
-		ElementBases &b = bases[e];
-		const int discr_order = discr_orders(e);
-		const int n_el_bases = (int)element_nodes_id[e].size();
-		b.bases.resize(n_el_bases);
 
-		bool skip_interface_element = false;
+	const LagrangeFunctions shared_functions = lagrange_functions(mesh, discr_orders, serendipity);
 
-		for (int j = 0; j < n_el_bases; ++j)
+	// every element only writes its own bases, the lambdas do not capture the nodes
+	std::vector<char> is_interface_element(mesh.n_cells(), false);
+	polyfem::utils::maybe_parallel_for(mesh.n_cells(), [&](int start, int end, int thread_id) {
+		for (int e = start; e < end; ++e)
 		{
-			const int global_index = element_nodes_id[e][j];
-			if (global_index < 0)
-			{
-				skip_interface_element = true;
-				break;
-			}
-		}
+			ElementBases &b = bases[e];
+			const int discr_order = discr_orders(e);
+			const int n_el_bases = (int)element_nodes_id[e].size();
+			b.bases.resize(n_el_bases);
+			b.reference_key = -1;
 
-		if (skip_interface_element)
-		{
-			interface_elements.push_back(e);
-		}
+			bool skip_interface_element = false;
 
-		if (mesh.is_cube(e))
-		{
-			const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
-			const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
-			b.set_quadrature([real_order](Quadrature &quad) {
-				HexQuadrature hex_quadrature;
-				hex_quadrature.get_quadrature(real_order, quad);
-			});
-			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-				HexQuadrature hex_quadrature;
-				hex_quadrature.get_quadrature(real_mass_order, quad);
-			});
-
-			b.set_local_node_from_primitive_func([serendipity, discr_order, e](const int primitive_id, const Mesh &mesh) {
-				const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
-				Navigation3D::Index index;
-
-				for (int lf = 0; lf < 6; ++lf)
+			for (int j = 0; j < n_el_bases; ++j)
+			{
+				const int global_index = element_nodes_id[e][j];
+				if (global_index < 0)
 				{
-					index = mesh3d.get_index_from_element(e, lf, 0);
-					if (index.face == primitive_id)
-						break;
+					skip_interface_element = true;
+					break;
 				}
-				assert(index.face == primitive_id);
-				return hex_face_local_nodes(serendipity, discr_order, mesh3d, index);
-			});
+			}
 
-			for (int j = 0; j < n_el_bases; ++j)
+			if (skip_interface_element)
 			{
-				const int global_index = element_nodes_id[e][j];
+				is_interface_element[e] = true;
+			}
 
-				b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
+			if (mesh.is_cube(e))
+			{
+				const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
+				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
+				b.set_quadrature([real_order](Quadrature &quad) {
+					HexQuadrature hex_quadrature;
+					hex_quadrature.get_quadrature(real_order, quad);
+				});
+				b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
+					HexQuadrature hex_quadrature;
+					hex_quadrature.get_quadrature(real_mass_order, quad);
+				});
 
-				const int dtmp = serendipity ? -2 : discr_order;
+				b.set_local_node_from_primitive_func([serendipity, discr_order, e](const int primitive_id, const Mesh &mesh) {
+					const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
+					Navigation3D::Index index;
 
-				b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_3d(dtmp, j, uv, val); });
-				b.bases[j].set_grad([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_3d(dtmp, j, uv, val); });
-			}
-		}
-		else if (mesh.is_simplex(e))
-		{
-			const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
-			const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
-
-			b.set_quadrature([real_order](Quadrature &quad) {
-				TetQuadrature tet_quadrature;
-				tet_quadrature.get_quadrature(real_order, quad);
-			});
-			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-				TetQuadrature tet_quadrature;
-				tet_quadrature.get_quadrature(real_mass_order, quad);
-			});
-
-			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
-				const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
-				Navigation3D::Index index;
-
-				for (int lf = 0; lf < mesh3d.n_cell_faces(e); ++lf)
+					for (int lf = 0; lf < 6; ++lf)
+					{
+						index = mesh3d.get_index_from_element(e, lf, 0);
+						if (index.face == primitive_id)
+							break;
+					}
+					assert(index.face == primitive_id);
+					return hex_face_local_nodes(serendipity, discr_order, mesh3d, index);
+				});
+
+				for (int j = 0; j < n_el_bases; ++j)
 				{
-					index = mesh3d.get_index_from_element(e, lf, 0);
-					if (index.face == primitive_id)
-						break;
-				}
-				assert(index.face == primitive_id);
-				return tet_face_local_nodes(discr_order, mesh3d, index);
-			});
+					const int global_index = element_nodes_id[e][j];
 
-			const bool rational = is_geom_bases && mesh.is_rational() && !mesh.cell_weights(e).empty();
-			assert(!rational);
+					b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
 
-			for (int j = 0; j < n_el_bases; ++j)
+					b.bases[j].set_functions(shared_functions.at({false, serendipity ? -2 : discr_order})[j]);
+				}
+
+				b.reference_key = ElementBases::lagrange_reference_key(3, false, serendipity ? -2 : discr_order);
+			}
+			else if (mesh.is_simplex(e))
 			{
-				const int global_index = element_nodes_id[e][j];
-				if (!skip_interface_element)
+				const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
+				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
+
+				b.set_quadrature([real_order](Quadrature &quad) {
+					TetQuadrature tet_quadrature;
+					tet_quadrature.get_quadrature(real_order, quad);
+				});
+				b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
+					TetQuadrature tet_quadrature;
+					tet_quadrature.get_quadrature(real_mass_order, quad);
+				});
+
+				b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
+					const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
+					Navigation3D::Index index;
+
+					for (int lf = 0; lf < mesh3d.n_cell_faces(e); ++lf)
+					{
+						index = mesh3d.get_index_from_element(e, lf, 0);
+						if (index.face == primitive_id)
+							break;
+					}
+					assert(index.face == primitive_id);
+					return tet_face_local_nodes(discr_order, mesh3d, index);
+				});
+
+				const bool rational = is_geom_bases && mesh.is_rational() && !mesh.cell_weights(e).empty();
+				assert(!rational);
+
+				for (int j = 0; j < n_el_bases; ++j)
 				{
-					b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
+					const int global_index = element_nodes_id[e][j];
+					if (!skip_interface_element)
+					{
+						b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
+					}
+
+					b.bases[j].set_functions(shared_functions.at({true, discr_order})[j]);
 				}
 
-				b.bases[j].set_basis([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_basis_value_3d(discr_order, j, uv, val); });
-				b.bases[j].set_grad([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_3d(discr_order, j, uv, val); });
+				// evaluate all the bases at once
+				b.set_bases_func([discr_order](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) {
+					Eigen::MatrixXd val;
+					autogen::p_basis_values_3d(discr_order, uv, val);
+					basis_values.resize(val.cols());
+					for (int j = 0; j < val.cols(); ++j)
+						basis_values[j].val = val.col(j);
+				});
+				b.set_grads_func([discr_order](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) {
+					Eigen::MatrixXd grad;
+					autogen::p_grad_basis_values_3d(discr_order, uv, grad);
+					basis_values.resize(grad.cols() / 3);
+					for (int j = 0; j < int(basis_values.size()); ++j)
+						basis_values[j].grad = grad.middleCols<3>(3 * j);
+				});
+
+				b.reference_key = ElementBases::lagrange_reference_key(3, true, discr_order);
+			}
+			else
+			{
+				// Polyhedra bases are built later on
+				// assert(false);
 			}
 		}
-		else
-		{
-			// Polyhedra bases are built later on
-			// assert(false);
-		}
+	});
+
+	std::vector<int> interface_elements;
+	for (int e = 0; e < mesh.n_cells(); ++e)
+	{
+		if (is_interface_element[e])
+			interface_elements.push_back(e);
 	}
 
 	if (!is_geom_bases)
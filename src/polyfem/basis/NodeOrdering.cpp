@@ -0,0 +1,226 @@
+#include "NodeOrdering.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		namespace
+		{
+			/// nodes sharing an element with every node, sorted
+			std::vector<std::vector<int>> node_adjacency(const int n_nodes, const std::vector<ElementBases> &bases)
+			{
+				std::vector<std::vector<int>> adjacency(n_nodes);
+				std::vector<int> nodes;
+				for (const ElementBases &b : bases)
+				{
+					nodes.clear();
+					for (const Basis &basis : b.bases)
+						for (const Local2Global &l2g : basis.global())
+							nodes.push_back(l2g.index);
+					std::sort(nodes.begin(), nodes.end());
+					nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+					for (const int i : nodes)
+						for (const int j : nodes)
+							if (i != j)
+								adjacency[i].push_back(j);
+				}
+
+				for (std::vector<int> &row : adjacency)
+				{
+					std::sort(row.begin(), row.end());
+					row.erase(std::unique(row.begin(), row.end()), row.end());
+				}
+				return adjacency;
+			}
+
+			/// breadth first search from root, returns the visited nodes by level
+			/// neighbours are visited by increasing degree
+			void cuthill_mckee_bfs(const std::vector<std::vector<int>> &adjacency, const int root, std::vector<int> &level, std::vector<int> &order)
+			{
+				const size_t start = order.size();
+				order.push_back(root);
+				level[root] = 0;
+
+				std::vector<int> next;
+				for (size_t k = start; k < order.size(); ++k)
+				{
+					const int i = order[k];
+					next.clear();
+					for (const int j : adjacency[i])
+					{
+						if (level[j] < 0)
+						{
+							level[j] = level[i] + 1;
+							next.push_back(j);
+						}
+					}
+					std::stable_sort(next.begin(), next.end(), [&](const int a, const int b) { return adjacency[a].size() < adjacency[b].size(); });
+					order.insert(order.end(), next.begin(), next.end());
+				}
+			}
+
+			/// reverse Cuthill-McKee, every connected component starts from a pseudo-peripheral node
+			std::vector<int> reverse_cuthill_mckee(const std::vector<std::vector<int>> &adjacency)
+			{
+				const int n_nodes = adjacency.size();
+				std::vector<int> order;
+				order.reserve(n_nodes);
+				std::vector<int> level(n_nodes, -1);
+				std::vector<int> component_level(n_nodes, -1);
+				std::vector<int> component;
+
+				for (int seed = 0; seed < n_nodes; ++seed)
+				{
+					if (level[seed] >= 0)
+						continue;
+
+					// George-Liu: move the root to the farthest node of minimum degree until the depth stops growing
+					int root = seed;
+					int depth = -1;
+					for (int it = 0; it < 8; ++it)
+					{
+						component.clear();
+						cuthill_mckee_bfs(adjacency, root, component_level, component);
+
+						const int new_depth = component_level[component.back()];
+						int candidate = component.back();
+						for (const int i : component)
+						{
+							if (component_level[i] == new_depth && adjacency[i].size() < adjacency[candidate].size())
+								candidate = i;
+						}
+						for (const int i : component)
+							component_level[i] = -1;
+
+						if (new_depth <= depth)
+							break;
+						depth = new_depth;
+						root = candidate;
+					}
+
+					cuthill_mckee_bfs(adjacency, root, level, order);
+				}
+
+				assert(order.size() == n_nodes);
+				std::reverse(order.begin(), order.end());
+				return order;
+			}
+
+			/// interleaves the bits of the first 21 bits of the coordinates
+			uint64_t morton_code(const std::array<uint32_t, 3> &coords, const int dim)
+			{
+				uint64_t code = 0;
+				for (int bit = 20; bit >= 0; --bit)
+				{
+					for (int d = 0; d < dim; ++d)
+						code = (code << 1) | ((coords[d] >> bit) & 1u);
+				}
+				return code;
+			}
+
+			std::vector<int> morton_order(const int n_nodes, const std::vector<ElementBases> &bases)
+			{
+				int dim = 0;
+				std::vector<RowVectorNd> positions(n_nodes);
+				for (const ElementBases &b : bases)
+				{
+					for (const Basis &basis : b.bases)
+					{
+						for (const Local2Global &l2g : basis.global())
+						{
+							positions[l2g.index] = l2g.node;
+							dim = l2g.node.size();
+						}
+					}
+				}
+
+				RowVectorNd bbox_min = RowVectorNd::Constant(dim, std::numeric_limits<double>::max());
+				RowVectorNd bbox_max = RowVectorNd::Constant(dim, std::numeric_limits<double>::lowest());
+				for (const RowVectorNd &p : positions)
+				{
+					if (p.size() != dim)
+						continue;
+					bbox_min = bbox_min.cwiseMin(p);
+					bbox_max = bbox_max.cwiseMax(p);
+				}
+				const double scale = ((1 << 21) - 1) / std::max((bbox_max - bbox_min).maxCoeff(), 1e-16);
+
+				std::vector<uint64_t> codes(n_nodes, 0);
+				for (int i = 0; i < n_nodes; ++i)
+				{
+					if (positions[i].size() != dim)
+						continue;
+					std::array<uint32_t, 3> coords = {{0, 0, 0}};
+					for (int d = 0; d < dim; ++d)
+						coords[d] = uint32_t((positions[i](d) - bbox_min(d)) * scale);
+					codes[i] = morton_code(coords, dim);
+				}
+
+				std::vector<int> order(n_nodes);
+				std::iota(order.begin(), order.end(), 0);
+				std::stable_sort(order.begin(), order.end(), [&](const int a, const int b) { return codes[a] < codes[b]; });
+				return order;
+			}
+		} // namespace
+
+		NodeOrdering node_ordering_from_string(const std::string &name)
+		{
+			if (name == "none")
+				return NodeOrdering::None;
+			else if (name == "rcm")
+				return NodeOrdering::RCM;
+			else if (name == "morton")
+				return NodeOrdering::Morton;
+
+			log_and_throw_error("Unknown node ordering {}", name);
+		}
+
+		Eigen::VectorXi compute_node_ordering(const NodeOrdering ordering, const int n_nodes, const std::vector<ElementBases> &bases)
+		{
+			std::vector<int> order;
+			switch (ordering)
+			{
+			case NodeOrdering::RCM:
+				order = reverse_cuthill_mckee(node_adjacency(n_nodes, bases));
+				break;
+			case NodeOrdering::Morton:
+				order = morton_order(n_nodes, bases);
+				break;
+			case NodeOrdering::None:
+			default:
+				order.resize(n_nodes);
+				std::iota(order.begin(), order.end(), 0);
+				break;
+			}
+
+			Eigen::VectorXi old_to_new(n_nodes);
+			for (int i = 0; i < n_nodes; ++i)
+				old_to_new[order[i]] = i;
+			return old_to_new;
+		}
+
+		void renumber_nodes(const Eigen::VectorXi &old_to_new, std::vector<ElementBases> &bases)
+		{
+			for (ElementBases &b : bases)
+			{
+				for (Basis &basis : b.bases)
+				{
+					for (Local2Global &l2g : basis.global())
+					{
+						assert(l2g.index >= 0 && l2g.index < old_to_new.size());
+						l2g.index = old_to_new[l2g.index];
+					}
+				}
+			}
+		}
+	} // namespace basis
+} // namespace polyfem
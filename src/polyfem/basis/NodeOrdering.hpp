@@ -0,0 +1,37 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+
+#include <Eigen/Dense>
+
+#include <string>
+#include <vector>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		/// renumbering of the nodes of the bases
+		enum class NodeOrdering
+		{
+			None,  ///< order in which the nodes are created
+			RCM,   ///< reverse Cuthill-McKee, reduces the bandwidth and fill-in of the matrices
+			Morton ///< Z-order curve of the node positions, improves the locality of the assembly
+		};
+
+		/// @brief parses "none", "rcm" or "morton"
+		NodeOrdering node_ordering_from_string(const std::string &name);
+
+		/// @brief computes a new numbering of the nodes of the bases
+		/// @param[in] ordering type of ordering
+		/// @param[in] n_nodes number of nodes referenced by the bases
+		/// @param[in] bases bases of every element
+		/// @return new id of every node
+		Eigen::VectorXi compute_node_ordering(const NodeOrdering ordering, const int n_nodes, const std::vector<ElementBases> &bases);
+
+		/// @brief renumbers the nodes of the bases
+		/// @param[in] old_to_new new id of every node
+		/// @param[in,out] bases bases of every element
+		void renumber_nodes(const Eigen::VectorXi &old_to_new, std::vector<ElementBases> &bases);
+	} // namespace basis
+} // namespace polyfem
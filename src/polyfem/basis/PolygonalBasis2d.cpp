@@ -8,6 +8,7 @@
 #include "function/RBFWithQuadratic.hpp"
 #include "function/RBFWithQuadraticLagrange.hpp"
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/assembler/AssemblerUtils.hpp>
 
 #include <polyfem/autogen/auto_q_bases.hpp>
@@ -357,127 +358,140 @@ namespace polyfem
 
 			const int dim = assembler.is_tensor() ? 2 : 1;
 
+			if (integral_constraints < 0 || integral_constraints > 2)
+			{
+				throw std::runtime_error(fmt::format("Unsupported constraint order: {:d}", integral_constraints));
+			}
+
 			// Step 1: Compute integral constraints
 			Eigen::MatrixXd basis_integrals;
 			compute_integral_constraints(assembler, mesh, n_bases, bases, gbases, basis_integrals);
 
 			// Step 2: Compute the rest =)
-			PolygonQuadrature poly_quadr;
+			std::vector<int> polytopes;
 			for (int e = 0; e < mesh.n_elements(); ++e)
 			{
-				if (!mesh.is_polytope(e))
+				if (mesh.is_polytope(e))
+					polytopes.push_back(e);
+			}
+
+			// polygons are surrounded by non-polytope elements, each fit only writes its own bases
+			std::vector<Eigen::MatrixXd> polytope_boundaries(polytopes.size());
+			utils::maybe_parallel_for(int(polytopes.size()), [&](int start, int end, int thread_id) {
+				PolygonQuadrature poly_quadr;
+				for (int p = start; p < end; ++p)
 				{
-					continue;
-				}
-				// No boundary polytope
-				// assert(element_type[e] != ElementType::BOUNDARY_POLYTOPE);
+					const int e = polytopes[p];
+					// No boundary polytope
+					// assert(element_type[e] != ElementType::BOUNDARY_POLYTOPE);
 
-				// Kernel distance to polygon boundary
-				const double eps = compute_epsilon(mesh, e);
+					// Kernel distance to polygon boundary
+					const double eps = compute_epsilon(mesh, e);
 
-				std::vector<int> local_to_global; // map local basis id (the ones that are nonzero on the polygon boundary) to global basis id
-				Eigen::MatrixXd collocation_points, kernel_centers;
-				Eigen::MatrixXd rhs; // 1 row per collocation point, 1 column per basis that is nonzero on the polygon boundary
+					std::vector<int> local_to_global; // map local basis id (the ones that are nonzero on the polygon boundary) to global basis id
+					Eigen::MatrixXd collocation_points, kernel_centers;
+					Eigen::MatrixXd rhs; // 1 row per collocation point, 1 column per basis that is nonzero on the polygon boundary
 
-				sample_polygon(e, n_samples_per_edge, mesh, poly_edge_to_data, bases, gbases, eps, local_to_global, collocation_points, kernel_centers, rhs);
+					sample_polygon(e, n_samples_per_edge, mesh, poly_edge_to_data, bases, gbases, eps, local_to_global, collocation_points, kernel_centers, rhs);
 
-				// igl::opengl::glfw::Viewer viewer;
-				// viewer.data().add_points(kernel_centers, Eigen::Vector3d(0,1,1).transpose());
+					// igl::opengl::glfw::Viewer viewer;
+					// viewer.data().add_points(kernel_centers, Eigen::Vector3d(0,1,1).transpose());
 
-				// Eigen::MatrixXd asd(collocation_points.rows(), 3);
-				// asd.col(0)=collocation_points.col(0);
-				// asd.col(1)=collocation_points.col(1);
-				// asd.col(2)=rhs.col(0);
-				// viewer.data().add_points(asd, Eigen::Vector3d(1,0,1).transpose());
+					// Eigen::MatrixXd asd(collocation_points.rows(), 3);
+					// asd.col(0)=collocation_points.col(0);
+					// asd.col(1)=collocation_points.col(1);
+					// asd.col(2)=rhs.col(0);
+					// viewer.data().add_points(asd, Eigen::Vector3d(1,0,1).transpose());
 
-				// for(int asd = 0; asd < collocation_points.rows(); ++asd) {
-				//     viewer.data().add_label(collocation_points.row(asd), std::to_string(asd));
-				// }
+					// for(int asd = 0; asd < collocation_points.rows(); ++asd) {
+					//     viewer.data().add_label(collocation_points.row(asd), std::to_string(asd));
+					// }
 
-				// viewer.launch();
+					// viewer.launch();
 
-				// igl::opengl::glfw::Viewer & viewer = UIState::ui_state().viewer;
-				// viewer.data().clear();
-				// viewer.data().set_mesh(triangulated_vertices, triangulated_faces);
-				// viewer.data().add_points(kernel_centers, Eigen::Vector3d(0,1,1).transpose());
-				// add_spheres(viewer, kernel_centers, 0.01);
+					// igl::opengl::glfw::Viewer & viewer = UIState::ui_state().viewer;
+					// viewer.data().clear();
+					// viewer.data().set_mesh(triangulated_vertices, triangulated_faces);
+					// viewer.data().add_points(kernel_centers, Eigen::Vector3d(0,1,1).transpose());
+					// add_spheres(viewer, kernel_centers, 0.01);
 
-				ElementBases &b = bases[e];
-				b.has_parameterization = false;
+					ElementBases &b = bases[e];
+					b.has_parameterization = false;
 
-				// Compute quadrature points for the polygon
-				Quadrature tmp_quadrature;
-				poly_quadr.get_quadrature(collocation_points, quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler.name(), 2, AssemblerUtils::BasisType::POLY, 2), tmp_quadrature);
+					// Compute quadrature points for the polygon
+					Quadrature tmp_quadrature;
+					poly_quadr.get_quadrature(collocation_points, quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler.name(), 2, AssemblerUtils::BasisType::POLY, 2), tmp_quadrature);
 
-				Quadrature tmp_mass_quadrature;
-				poly_quadr.get_quadrature(collocation_points, mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 2, AssemblerUtils::BasisType::POLY, 2), tmp_mass_quadrature);
+					Quadrature tmp_mass_quadrature;
+					poly_quadr.get_quadrature(collocation_points, mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", 2, AssemblerUtils::BasisType::POLY, 2), tmp_mass_quadrature);
 
-				b.set_quadrature([tmp_quadrature](Quadrature &quad) { quad = tmp_quadrature; });
-				b.set_mass_quadrature([tmp_mass_quadrature](Quadrature &quad) { quad = tmp_mass_quadrature; });
+					b.set_quadrature([tmp_quadrature](Quadrature &quad) { quad = tmp_quadrature; });
+					b.set_mass_quadrature([tmp_mass_quadrature](Quadrature &quad) { quad = tmp_mass_quadrature; });
 
-				// Compute the weights of the harmonic kernels
-				Eigen::MatrixXd local_basis_integrals(rhs.cols(), basis_integrals.cols());
-				for (long k = 0; k < rhs.cols(); ++k)
-				{
-					local_basis_integrals.row(k) = -basis_integrals.row(local_to_global[k]);
-				}
-				auto set_rbf = [&b](auto rbf) {
-					b.set_bases_func([rbf](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
-						Eigen::MatrixXd tmp;
-						rbf->bases_values(uv, tmp);
-						val.resize(tmp.cols());
-						assert(tmp.rows() == uv.rows());
-
-						for (size_t i = 0; i < tmp.cols(); ++i)
-						{
-							val[i].val = tmp.col(i);
-						}
-					});
-					b.set_grads_func([rbf](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
-						Eigen::MatrixXd tmpx, tmpy;
+					// Compute the weights of the harmonic kernels
+					Eigen::MatrixXd local_basis_integrals(rhs.cols(), basis_integrals.cols());
+					for (long k = 0; k < rhs.cols(); ++k)
+					{
+						local_basis_integrals.row(k) = -basis_integrals.row(local_to_global[k]);
+					}
+					auto set_rbf = [&b](auto rbf) {
+						b.set_bases_func([rbf](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
+							Eigen::MatrixXd tmp;
+							rbf->bases_values(uv, tmp);
+							val.resize(tmp.cols());
+							assert(tmp.rows() == uv.rows());
+
+							for (size_t i = 0; i < tmp.cols(); ++i)
+							{
+								val[i].val = tmp.col(i);
+							}
+						});
+						b.set_grads_func([rbf](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
+							Eigen::MatrixXd tmpx, tmpy;
 
-						rbf->bases_grads(0, uv, tmpx);
-						rbf->bases_grads(1, uv, tmpy);
+							rbf->bases_grads(0, uv, tmpx);
+							rbf->bases_grads(1, uv, tmpy);
 
-						val.resize(tmpx.cols());
-						assert(tmpx.cols() == tmpy.cols());
-						assert(tmpx.rows() == uv.rows());
-						for (size_t i = 0; i < tmpx.cols(); ++i)
-						{
-							val[i].grad.resize(uv.rows(), uv.cols());
-							val[i].grad.col(0) = tmpx.col(i);
-							val[i].grad.col(1) = tmpy.col(i);
-						}
-					});
-				};
-				if (integral_constraints == 0)
-				{
-					set_rbf(std::make_shared<RBFWithLinear>(kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs, false));
-				}
-				else if (integral_constraints == 1)
-				{
-					set_rbf(std::make_shared<RBFWithLinear>(kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs));
-				}
-				else if (integral_constraints == 2)
-				{
-					set_rbf(std::make_shared<RBFWithQuadraticLagrange>(assembler, kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs));
-				}
-				else
-				{
-					throw std::runtime_error(fmt::format("Unsupported constraint order: {:d}", integral_constraints));
-				}
+							val.resize(tmpx.cols());
+							assert(tmpx.cols() == tmpy.cols());
+							assert(tmpx.rows() == uv.rows());
+							for (size_t i = 0; i < tmpx.cols(); ++i)
+							{
+								val[i].grad.resize(uv.rows(), uv.cols());
+								val[i].grad.col(0) = tmpx.col(i);
+								val[i].grad.col(1) = tmpy.col(i);
+							}
+						});
+					};
+					if (integral_constraints == 0)
+					{
+						set_rbf(std::make_shared<RBFWithLinear>(kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs, false));
+					}
+					else if (integral_constraints == 1)
+					{
+						set_rbf(std::make_shared<RBFWithLinear>(kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs));
+					}
+					else
+					{
+						assert(integral_constraints == 2);
+						set_rbf(std::make_shared<RBFWithQuadraticLagrange>(assembler, kernel_centers, collocation_points, local_basis_integrals, tmp_quadrature, rhs));
+					}
 
-				// Set the bases which are nonzero inside the polygon
-				const int n_poly_bases = int(local_to_global.size());
-				b.bases.resize(n_poly_bases);
-				for (int i = 0; i < n_poly_bases; ++i)
-				{
-					b.bases[i].init(-2, local_to_global[i], i, Eigen::MatrixXd::Constant(1, 2, std::nan("")));
+					// Set the bases which are nonzero inside the polygon
+					const int n_poly_bases = int(local_to_global.size());
+					b.bases.resize(n_poly_bases);
+					for (int i = 0; i < n_poly_bases; ++i)
+					{
+						b.bases[i].init(-2, local_to_global[i], i, Eigen::MatrixXd::Constant(1, 2, std::nan("")));
+					}
+
+					// Polygon boundary after geometric mapping from neighboring elements
+					polytope_boundaries[p] = collocation_points;
 				}
+			});
 
-				// Polygon boundary after geometric mapping from neighboring elements
-				mapped_boundary[e] = collocation_points;
-			}
+			for (size_t p = 0; p < polytopes.size(); ++p)
+				mapped_boundary[polytopes[p]] = std::move(polytope_boundaries[p]);
 
 			return 0;
 		}
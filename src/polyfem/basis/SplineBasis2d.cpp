@@ -22,6 +22,7 @@
 #include <vector>
 #include <array>
 #include <map>
+#include <memory>
 
 // TODO carefull with simplices
 
@@ -321,7 +322,34 @@ namespace polyfem
 				}
 			}
 
-			void basis_for_regular_quad(const SpaceMatrix &space, const NodeMatrix &loc_nodes, const std::array<std::array<double, 4>, 3> &h_knots, const std::array<std::array<double, 4>, 3> &v_knots, ElementBases &b)
+			/// shared spline bases of an element, indexed by local basis
+			typedef std::vector<std::shared_ptr<const Basis::Functions>> SplineFunctions;
+
+			/// 1 if the neighbor before is absent (clamped knots) plus 2 if the neighbor after is absent
+			int knots_pattern(const std::array<std::array<double, 4>, 3> &knots)
+			{
+				return (knots[0][0] == 0 ? 1 : 0) + (knots[2][3] == 1 ? 2 : 0);
+			}
+
+			SplineFunctions build_spline_functions(const std::array<std::array<double, 4>, 3> &h_knots, const std::array<std::array<double, 4>, 3> &v_knots)
+			{
+				SplineFunctions functions(9);
+				for (int y = 0; y < 3; ++y)
+				{
+					for (int x = 0; x < 3; ++x)
+					{
+						const QuadraticBSpline2d spline(h_knots[x], v_knots[y]);
+
+						auto f = std::make_shared<Basis::Functions>();
+						f->basis = [spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.interpolate(uv, val); };
+						f->grad = [spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.derivative(uv, val); };
+						functions[y * 3 + x] = f;
+					}
+				}
+				return functions;
+			}
+
+			void basis_for_regular_quad(const SpaceMatrix &space, const NodeMatrix &loc_nodes, const SplineFunctions &functions, ElementBases &b)
 			{
 				for (int y = 0; y < 3; ++y)
 				{
@@ -336,15 +364,13 @@ namespace polyfem
 							const int local_index = y * 3 + x;
 							b.bases[local_index].init(2, global_index, local_index, node);
 
-							const QuadraticBSpline2d spline(h_knots[x], v_knots[y]);
-							b.bases[local_index].set_basis([spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.interpolate(uv, val); });
-							b.bases[local_index].set_grad([spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.derivative(uv, val); });
+							b.bases[local_index].set_functions(functions[local_index]);
 						}
 					}
 				}
 			}
 
-			void basis_for_irregulard_quad(const int el_id, const Mesh2D &mesh, MeshNodes &mesh_nodes, const SpaceMatrix &space, const NodeMatrix &loc_nodes, const std::array<std::array<double, 4>, 3> &h_knots, const std::array<std::array<double, 4>, 3> &v_knots, ElementBases &b)
+			void basis_for_irregulard_quad(const int el_id, const Mesh2D &mesh, MeshNodes &mesh_nodes, const SpaceMatrix &space, const NodeMatrix &loc_nodes, const SplineFunctions &functions, ElementBases &b)
 			{
 				for (int y = 0; y < 3; ++y)
 				{
@@ -416,9 +442,7 @@ namespace polyfem
 								base.global()[3 + n].node = mesh_nodes.node_position(other_indices[n]);
 							}
 
-							const QuadraticBSpline2d spline(h_knots[x], v_knots[y]);
-							b.bases[local_index].set_basis([spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.interpolate(uv, val); });
-							b.bases[local_index].set_grad([spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.derivative(uv, val); });
+							b.bases[local_index].set_functions(functions[local_index]);
 						}
 					}
 				}
@@ -692,6 +716,9 @@ namespace polyfem
 
 			// QuadQuadrature quad_quadrature;
 
+			// the bases of an element only depend on which of its neighbors are absent
+			std::map<int, SplineFunctions> spline_functions;
+
 			for (int e = 0; e < n_els; ++e)
 			{
 				if (!mesh.is_spline_compatible(e))
@@ -760,8 +787,14 @@ namespace polyfem
 
 				// print_local_space(space);
 
-				basis_for_regular_quad(space, loc_nodes, h_knots, v_knots, b);
-				basis_for_irregulard_quad(e, mesh, mesh_nodes, space, loc_nodes, h_knots, v_knots, b);
+				const int pattern = knots_pattern(h_knots) + 4 * knots_pattern(v_knots);
+				auto functions = spline_functions.find(pattern);
+				if (functions == spline_functions.end())
+					functions = spline_functions.emplace(pattern, build_spline_functions(h_knots, v_knots)).first;
+				b.reference_key = ElementBases::spline_reference_key(2, pattern);
+
+				basis_for_regular_quad(space, loc_nodes, functions->second, b);
+				basis_for_irregulard_quad(e, mesh, mesh_nodes, space, loc_nodes, functions->second, b);
 			}
 
 			std::set<int> edge_id;
@@ -21,6 +21,7 @@
 #include <vector>
 #include <array>
 #include <map>
+#include <memory>
 #include <numeric>
 
 // TODO carefull with simplices
@@ -572,7 +573,37 @@ namespace polyfem
 				}
 			}
 
-			void basis_for_regular_hex(MeshNodes &mesh_nodes, const SpaceMatrix &space, const std::array<std::array<double, 4>, 3> &h_knots, const std::array<std::array<double, 4>, 3> &v_knots, const std::array<std::array<double, 4>, 3> &w_knots, ElementBases &b)
+			/// shared spline bases of an element, indexed by local basis
+			typedef std::vector<std::shared_ptr<const Basis::Functions>> SplineFunctions;
+
+			/// 1 if the neighbor before is absent (clamped knots) plus 2 if the neighbor after is absent
+			int knots_pattern(const std::array<std::array<double, 4>, 3> &knots)
+			{
+				return (knots[0][0] == 0 ? 1 : 0) + (knots[2][3] == 1 ? 2 : 0);
+			}
+
+			SplineFunctions build_spline_functions(const std::array<std::array<double, 4>, 3> &h_knots, const std::array<std::array<double, 4>, 3> &v_knots, const std::array<std::array<double, 4>, 3> &w_knots)
+			{
+				SplineFunctions functions(27);
+				for (int z = 0; z < 3; ++z)
+				{
+					for (int y = 0; y < 3; ++y)
+					{
+						for (int x = 0; x < 3; ++x)
+						{
+							const QuadraticBSpline3d spline(h_knots[x], v_knots[y], w_knots[z]);
+
+							auto f = std::make_shared<Basis::Functions>();
+							f->basis = [spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.interpolate(uv, val); };
+							f->grad = [spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.derivative(uv, val); };
+							functions[9 * z + 3 * y + x] = f;
+						}
+					}
+				}
+				return functions;
+			}
+
+			void basis_for_regular_hex(MeshNodes &mesh_nodes, const SpaceMatrix &space, const SplineFunctions &functions, ElementBases &b)
 			{
 				for (int z = 0; z < 3; ++z)
 				{
@@ -589,17 +620,14 @@ namespace polyfem
 
 								b.bases[local_index].init(2, global_index, local_index, node);
 
-								const QuadraticBSpline3d spline(h_knots[x], v_knots[y], w_knots[z]);
-
-								b.bases[local_index].set_basis([spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.interpolate(uv, val); });
-								b.bases[local_index].set_grad([spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.derivative(uv, val); });
+								b.bases[local_index].set_functions(functions[local_index]);
 							}
 						}
 					}
 				}
 			}
 
-			void basis_for_irregulard_hex(const int el_index, const Mesh3D &mesh, MeshNodes &mesh_nodes, const SpaceMatrix &space, const std::array<std::array<double, 4>, 3> &h_knots, const std::array<std::array<double, 4>, 3> &v_knots, const std::array<std::array<double, 4>, 3> &w_knots, ElementBases &b, std::map<int, InterfaceData> &poly_face_to_data)
+			void basis_for_irregulard_hex(const int el_index, const Mesh3D &mesh, MeshNodes &mesh_nodes, const SpaceMatrix &space, const SplineFunctions &functions, ElementBases &b, std::map<int, InterfaceData> &poly_face_to_data)
 			{
 				for (int z = 0; z < 3; ++z)
 				{
@@ -735,10 +763,7 @@ namespace polyfem
 									base.global()[3 + n].node = mesh_nodes.node_position(other_indices[n]);
 								}
 
-								const QuadraticBSpline3d spline(h_knots[x], v_knots[y], w_knots[z]);
-
-								b.bases[local_index].set_basis([spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.interpolate(uv, val); });
-								b.bases[local_index].set_grad([spline](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { spline.derivative(uv, val); });
+								b.bases[local_index].set_functions(functions[local_index]);
 							}
 						}
 					}
@@ -1044,6 +1069,9 @@ namespace polyfem
 			std::array<std::array<double, 4>, 3> v_knots;
 			std::array<std::array<double, 4>, 3> w_knots;
 
+			// the bases of an element only depend on which of its neighbors are absent
+			std::map<int, SplineFunctions> spline_functions;
+
 			for (int e = 0; e < n_els; ++e)
 			{
 				if (!mesh.is_spline_compatible(e))
@@ -1108,8 +1136,14 @@ namespace polyfem
 				setup_knots_vectors(mesh_nodes, space, h_knots, v_knots, w_knots);
 				// print_local_space(space);
 
-				basis_for_regular_hex(mesh_nodes, space, h_knots, v_knots, w_knots, b);
-				basis_for_irregulard_hex(e, mesh, mesh_nodes, space, h_knots, v_knots, w_knots, b, poly_face_to_data);
+				const int pattern = knots_pattern(h_knots) + 4 * knots_pattern(v_knots) + 16 * knots_pattern(w_knots);
+				auto functions = spline_functions.find(pattern);
+				if (functions == spline_functions.end())
+					functions = spline_functions.emplace(pattern, build_spline_functions(h_knots, v_knots, w_knots)).first;
+				b.reference_key = ElementBases::spline_reference_key(3, pattern);
+
+				basis_for_regular_hex(mesh_nodes, space, functions->second, b);
+				basis_for_irregulard_hex(e, mesh, mesh_nodes, space, functions->second, b, poly_face_to_data);
 			}
 
 			int n_bases = mesh_nodes.n_nodes();
@@ -14,10 +14,15 @@
 #include <polyfem/autogen/auto_q_bases.hpp>
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <igl/AABB.h>
 #include <igl/per_face_normals.h>
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 namespace polyfem::io
 {
 	using namespace mesh;
@@ -51,6 +56,192 @@ namespace polyfem::io
 				logger().error("Invalid tensor dimensions.");
 			}
 		}
+
+		/// Points at which the output is sampled in element i, returns false if the element is skipped
+		bool element_output_points(
+			const mesh::Mesh &mesh,
+			const int i,
+			const Eigen::VectorXi &disc_orders,
+			const std::map<int, Eigen::MatrixXd> &polys,
+			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+			const utils::RefElementSampler &sampler,
+			const bool use_sampler,
+			const bool boundary_only,
+			Eigen::MatrixXd &local_pts)
+		{
+			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
+				return false;
+
+			if (use_sampler)
+			{
+				if (mesh.is_simplex(i))
+					local_pts = sampler.simplex_points(i);
+				else if (mesh.is_cube(i))
+					local_pts = sampler.cube_points();
+				else
+				{
+					Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
+					if (mesh.is_volume())
+						sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, local_pts, vis_faces_poly, vis_edges_poly);
+					else
+						sampler.sample_polygon(polys.at(i), local_pts, vis_faces_poly, vis_edges_poly);
+				}
+			}
+			else
+			{
+				if (mesh.is_volume())
+				{
+					if (mesh.is_simplex(i))
+						autogen::p_nodes_3d(disc_orders(i), local_pts);
+					else if (mesh.is_cube(i))
+						autogen::q_nodes_3d(disc_orders(i), local_pts);
+					else
+						return false;
+				}
+				else
+				{
+					if (mesh.is_simplex(i))
+						autogen::p_nodes_2d(disc_orders(i), local_pts);
+					else if (mesh.is_cube(i))
+						autogen::q_nodes_2d(disc_orders(i), local_pts);
+					else
+						return false;
+				}
+			}
+
+			return true;
+		}
+
+		/// Offsets of the elements in the output, -1 for skipped elements, returns the first non-skipped element or -1
+		int element_output_offsets(
+			const mesh::Mesh &mesh,
+			const int n_elements,
+			const Eigen::VectorXi &disc_orders,
+			const std::map<int, Eigen::MatrixXd> &polys,
+			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+			const utils::RefElementSampler &sampler,
+			const bool use_sampler,
+			const bool boundary_only,
+			std::vector<int> &offsets)
+		{
+			offsets.assign(n_elements, -1);
+			int first = -1;
+			int index = 0;
+			Eigen::MatrixXd local_pts;
+			for (int i = 0; i < n_elements; ++i)
+			{
+				if (!element_output_points(mesh, i, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, local_pts))
+					continue;
+				if (first < 0)
+					first = i;
+				offsets[i] = index;
+				index += local_pts.rows();
+			}
+
+			return first;
+		}
+
+		/// Values of the bases of bs at pts shared by all elements with the same reference key,
+		/// nullptr if the values depend on the element. The cache is kept across calls (i.e., output steps).
+		std::shared_ptr<const std::vector<AssemblyValues>> cached_reference_bases(const ElementBases &bs, const Eigen::MatrixXd &pts)
+		{
+			if (bs.reference_key < 0)
+				return nullptr;
+
+			struct Entry
+			{
+				Eigen::MatrixXd pts;
+				std::shared_ptr<const std::vector<AssemblyValues>> values;
+			};
+			static std::mutex mutex;
+			static std::unordered_map<int, std::vector<Entry>> cache;
+			static int n_entries = 0;
+			// Bound the memory if the sampling points keep changing
+			constexpr int max_entries = 64;
+
+			std::lock_guard<std::mutex> lock(mutex);
+			std::vector<Entry> &entries = cache[bs.reference_key];
+			for (const Entry &entry : entries)
+			{
+				if (entry.pts.rows() == pts.rows() && entry.pts.cols() == pts.cols() && entry.pts == pts)
+					return entry.values;
+			}
+
+			if (n_entries >= max_entries)
+			{
+				for (auto &it : cache)
+					it.second.clear();
+				n_entries = 0;
+			}
+
+			auto values = std::make_shared<std::vector<AssemblyValues>>();
+			bs.evaluate_bases(pts, *values);
+			entries.push_back({pts, values});
+			++n_entries;
+
+			return values;
+		}
+
+		/// Evaluates compute(i, local_pts, values) on all elements in parallel and stacks the per-element
+		/// values in result, in element order, with cols columns per field
+		template <typename ComputeFun>
+		void evaluate_per_element(
+			const mesh::Mesh &mesh,
+			const int n_elements,
+			const Eigen::VectorXi &disc_orders,
+			const std::map<int, Eigen::MatrixXd> &polys,
+			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+			const utils::RefElementSampler &sampler,
+			const int n_points,
+			const int cols,
+			const bool use_sampler,
+			const bool boundary_only,
+			ComputeFun compute,
+			std::vector<assembler::Assembler::NamedMatrix> &result)
+		{
+			std::vector<int> offsets;
+			const int first = element_output_offsets(mesh, n_elements, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, offsets);
+
+			if (first < 0)
+				return;
+
+			// The first element gives the names of the fields
+			{
+				Eigen::MatrixXd local_pts;
+				element_output_points(mesh, first, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, local_pts);
+				std::vector<assembler::Assembler::NamedMatrix> tmp;
+				compute(first, local_pts, tmp);
+
+				result.resize(tmp.size());
+				for (int k = 0; k < tmp.size(); ++k)
+				{
+					result[k].first = tmp[k].first;
+					result[k].second.resize(n_points, cols);
+				}
+			}
+
+			// Each element writes its own rows
+			utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+				Eigen::MatrixXd local_pts;
+				std::vector<assembler::Assembler::NamedMatrix> tmp;
+
+				for (int i = start; i < end; ++i)
+				{
+					if (offsets[i] < 0)
+						continue;
+
+					element_output_points(mesh, i, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, local_pts);
+					compute(i, local_pts, tmp);
+
+					assert(tmp.size() == result.size());
+					for (int k = 0; k < tmp.size(); ++k)
+					{
+						assert(local_pts.rows() == tmp[k].second.rows());
+						result[k].second.block(offsets[i], 0, tmp[k].second.rows(), tmp[k].second.cols()) = tmp[k].second;
+					}
+				}
+			});
+		}
 	} // namespace
 
 	void Evaluator::get_sidesets(
@@ -597,41 +788,57 @@ namespace polyfem::io
 		Eigen::MatrixXd areas(n_bases, 1);
 		areas.setZero();
 
-		std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
-		Eigen::MatrixXd local_val;
-
-		ElementAssemblyValues vals;
-		for (int i = 0; i < int(bases.size()); ++i)
-		{
-			const ElementBases &bs = bases[i];
-			const ElementBases &gbs = gbases[i];
-			Eigen::MatrixXd local_pts;
+		// The per-element values are computed in parallel, then averaged at the nodes in element order
+		std::vector<double> element_areas(bases.size(), 0);
+		std::vector<std::vector<std::pair<std::string, Eigen::MatrixXd>>> element_values(bases.size());
+		std::vector<char> supported(bases.size(), false);
+		utils::maybe_parallel_for(int(bases.size()), [&](int start, int end, int thread_id) {
+			ElementAssemblyValues vals;
 
-			if (mesh.is_simplex(i))
-			{
-				if (mesh.dimension() == 3)
-					autogen::p_nodes_3d(disc_orders(i), local_pts);
-				else
-					autogen::p_nodes_2d(disc_orders(i), local_pts);
-			}
-			else if (mesh.is_cube(i))
+			for (int i = start; i < end; ++i)
 			{
-				if (mesh.dimension() == 3)
-					autogen::q_nodes_3d(disc_orders(i), local_pts);
+				const ElementBases &bs = bases[i];
+				const ElementBases &gbs = gbases[i];
+				Eigen::MatrixXd local_pts;
+
+				if (mesh.is_simplex(i))
+				{
+					if (mesh.dimension() == 3)
+						autogen::p_nodes_3d(disc_orders(i), local_pts);
+					else
+						autogen::p_nodes_2d(disc_orders(i), local_pts);
+				}
+				else if (mesh.is_cube(i))
+				{
+					if (mesh.dimension() == 3)
+						autogen::q_nodes_3d(disc_orders(i), local_pts);
+					else
+						autogen::q_nodes_2d(disc_orders(i), local_pts);
+				}
 				else
-					autogen::q_nodes_2d(disc_orders(i), local_pts);
-			}
-			else
-			{
-				// not supported for polys
-				continue;
+				{
+					// not supported for polys
+					continue;
+				}
+
+				vals.compute(i, actual_dim == 3, bases[i], gbases[i]);
+				const quadrature::Quadrature &quadrature = vals.quadrature;
+				element_areas[i] = (vals.det.array() * quadrature.weights.array()).sum();
+
+				assembler.compute_scalar_value(OutputData(t, i, bs, gbs, local_pts, fun), element_values[i]);
+				supported[i] = true;
 			}
+		});
 
-			vals.compute(i, actual_dim == 3, bases[i], gbases[i]);
-			const quadrature::Quadrature &quadrature = vals.quadrature;
-			const double area = (vals.det.array() * quadrature.weights.array()).sum();
+		std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
+		for (int i = 0; i < int(bases.size()); ++i)
+		{
+			if (!supported[i])
+				continue;
 
-			assembler.compute_scalar_value(OutputData(t, i, bs, gbs, local_pts, fun), tmp_s);
+			const ElementBases &bs = bases[i];
+			const double area = element_areas[i];
+			tmp_s = std::move(element_values[i]);
 
 			// assembler.compute_tensor_value(i, bs, gbs, local_pts, fun, local_val);
 			// MatrixXd avg_tensor(n_points * actual_dim*actual_dim, 1);
@@ -658,7 +865,7 @@ namespace polyfem::io
 
 			for (int k = 0; k < tmp_s.size(); ++k)
 			{
-				local_val = tmp_s[k].second;
+				const Eigen::MatrixXd &local_val = tmp_s[k].second;
 
 				for (size_t j = 0; j < bs.bases.size(); ++j)
 				{
@@ -719,41 +926,58 @@ namespace polyfem::io
 		// std::array<int, 8> get_ordered_vertices_from_hex(const int element_index) const;
 		// std::array<int, 4> get_ordered_vertices_from_tet(const int element_index) const;
 
-		std::vector<AssemblyValues> tmp;
-		std::vector<bool> marked(mesh3d.n_vertices(), false);
-		for (int i = 0; i < int(basis.size()); ++i)
-		{
-			const ElementBases &bs = basis[i];
-			Eigen::MatrixXd local_pts;
-			std::vector<int> vertices;
+		// Values at the element corners are evaluated in parallel, then gathered at the vertices
+		std::vector<Eigen::MatrixXd> local_results(basis.size());
+		std::vector<std::vector<int>> local_vertices(basis.size());
+		utils::maybe_parallel_for(int(basis.size()), [&](int start, int end, int thread_id) {
+			std::vector<AssemblyValues> tmp;
 
-			if (mesh.is_simplex(i))
-			{
-				local_pts = sampler.simplex_corners();
-				auto vtx = mesh3d.get_ordered_vertices_from_tet(i);
-				vertices.assign(vtx.begin(), vtx.end());
-			}
-			else if (mesh.is_cube(i))
+			for (int i = start; i < end; ++i)
 			{
-				local_pts = sampler.cube_corners();
-				auto vtx = mesh3d.get_ordered_vertices_from_hex(i);
-				vertices.assign(vtx.begin(), vtx.end());
-			}
-			// TODO poly?
-			assert((int)vertices.size() == (int)local_pts.rows());
+				const ElementBases &bs = basis[i];
+				Eigen::MatrixXd local_pts;
+				std::vector<int> &vertices = local_vertices[i];
 
-			Eigen::MatrixXd local_res = Eigen::MatrixXd::Zero(local_pts.rows(), actual_dim);
-			bs.evaluate_bases(local_pts, tmp);
-			for (size_t j = 0; j < bs.bases.size(); ++j)
-			{
-				const Basis &b = bs.bases[j];
+				if (mesh.is_simplex(i))
+				{
+					local_pts = sampler.simplex_corners();
+					auto vtx = mesh3d.get_ordered_vertices_from_tet(i);
+					vertices.assign(vtx.begin(), vtx.end());
+				}
+				else if (mesh.is_cube(i))
+				{
+					local_pts = sampler.cube_corners();
+					auto vtx = mesh3d.get_ordered_vertices_from_hex(i);
+					vertices.assign(vtx.begin(), vtx.end());
+				}
+				// TODO poly?
+				assert((int)vertices.size() == (int)local_pts.rows());
 
-				for (int d = 0; d < actual_dim; ++d)
+				const auto cached = cached_reference_bases(bs, local_pts);
+				if (!cached)
+					bs.evaluate_bases(local_pts, tmp);
+				const std::vector<AssemblyValues> &vals = cached ? *cached : tmp;
+
+				Eigen::MatrixXd &local_res = local_results[i];
+				local_res.setZero(local_pts.rows(), actual_dim);
+				for (size_t j = 0; j < bs.bases.size(); ++j)
 				{
-					for (size_t ii = 0; ii < b.global().size(); ++ii)
-						local_res.col(d) += b.global()[ii].val * tmp[j].val * fun(b.global()[ii].index * actual_dim + d);
+					const Basis &b = bs.bases[j];
+
+					for (int d = 0; d < actual_dim; ++d)
+					{
+						for (size_t ii = 0; ii < b.global().size(); ++ii)
+							local_res.col(d) += b.global()[ii].val * vals[j].val * fun(b.global()[ii].index * actual_dim + d);
+					}
 				}
 			}
+		});
+
+		std::vector<bool> marked(mesh3d.n_vertices(), false);
+		for (int i = 0; i < int(basis.size()); ++i)
+		{
+			const std::vector<int> &vertices = local_vertices[i];
+			const Eigen::MatrixXd &local_res = local_results[i];
 
 			for (size_t lv = 0; lv < vertices.size(); ++lv)
 			{
@@ -802,70 +1026,71 @@ namespace polyfem::io
 		const int actual_dim = mesh.dimension();
 		assert(!is_problem_scalar);
 
-		Eigen::MatrixXd local_val, local_stress, local_mises;
+		// Elements are evaluated in parallel, then stacked in element order
+		std::vector<Eigen::MatrixXd> local_stresses(mesh.n_elements()), local_mises(mesh.n_elements());
+		utils::maybe_parallel_for(mesh.n_elements(), [&](int start, int end, int thread_id) {
+			std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s, tmp_t;
 
-		int num_quadr_pts = 0;
-		result.resize(disc_orders.sum(), actual_dim == 2 ? 3 : 6);
-		result.setZero();
-		von_mises.resize(disc_orders.sum(), 1);
-		von_mises.setZero();
-		for (int e = 0; e < mesh.n_elements(); ++e)
-		{
-			// Compute quadrature points for element
-			quadrature::Quadrature quadr;
-			if (mesh.is_simplex(e))
+			for (int e = start; e < end; ++e)
 			{
-				if (mesh.is_volume())
-				{
-					quadrature::TetQuadrature f;
-					f.get_quadrature(disc_orders(e), quadr);
-				}
-				else
+				// Compute quadrature points for element
+				quadrature::Quadrature quadr;
+				if (mesh.is_simplex(e))
 				{
-					quadrature::TriQuadrature f;
-					f.get_quadrature(disc_orders(e), quadr);
+					if (mesh.is_volume())
+					{
+						quadrature::TetQuadrature f;
+						f.get_quadrature(disc_orders(e), quadr);
+					}
+					else
+					{
+						quadrature::TriQuadrature f;
+						f.get_quadrature(disc_orders(e), quadr);
+					}
 				}
-			}
-			else if (mesh.is_cube(e))
-			{
-				if (mesh.is_volume())
+				else if (mesh.is_cube(e))
 				{
-					quadrature::HexQuadrature f;
-					f.get_quadrature(disc_orders(e), quadr);
+					if (mesh.is_volume())
+					{
+						quadrature::HexQuadrature f;
+						f.get_quadrature(disc_orders(e), quadr);
+					}
+					else
+					{
+						quadrature::QuadQuadrature f;
+						f.get_quadrature(disc_orders(e), quadr);
+					}
 				}
 				else
 				{
-					quadrature::QuadQuadrature f;
-					f.get_quadrature(disc_orders(e), quadr);
+					continue;
 				}
+
+				assembler.compute_scalar_value(OutputData(t, e, bases[e], gbases[e], quadr.points, fun), tmp_s);
+				assembler.compute_tensor_value(OutputData(t, e, bases[e], gbases[e], quadr.points, fun), tmp_t);
+
+				local_mises[e] = tmp_s[0].second;
+				flattened_tensor_coeffs(tmp_t[0].second, local_stresses[e]);
 			}
-			else
-			{
-				continue;
-			}
+		});
 
-			std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s, tmp_t;
+		int num_quadr_pts = 0;
+		for (const auto &local_stress : local_stresses)
+			num_quadr_pts += local_stress.rows();
 
-			assembler.compute_scalar_value(OutputData(t, e, bases[e], gbases[e], quadr.points, fun), tmp_s);
-			assembler.compute_tensor_value(OutputData(t, e, bases[e], gbases[e], quadr.points, fun), tmp_t);
+		result.resize(num_quadr_pts, actual_dim == 2 ? 3 : 6);
+		von_mises.resize(num_quadr_pts, 1);
 
-			local_mises = tmp_s[0].second;
-			local_val = tmp_t[0].second;
+		num_quadr_pts = 0;
+		for (int e = 0; e < mesh.n_elements(); ++e)
+		{
+			if (local_stresses[e].size() == 0)
+				continue;
 
-			if (num_quadr_pts + local_val.rows() >= result.rows())
-			{
-				result.conservativeResize(
-					std::max(num_quadr_pts + local_val.rows() + 1, 2 * result.rows()),
-					result.cols());
-				von_mises.conservativeResize(result.rows(), von_mises.cols());
-			}
-			flattened_tensor_coeffs(local_val, local_stress);
-			result.block(num_quadr_pts, 0, local_stress.rows(), local_stress.cols()) = local_stress;
-			von_mises.block(num_quadr_pts, 0, local_mises.rows(), local_mises.cols()) = local_mises;
-			num_quadr_pts += local_val.rows();
+			result.block(num_quadr_pts, 0, local_stresses[e].rows(), local_stresses[e].cols()) = local_stresses[e];
+			von_mises.block(num_quadr_pts, 0, local_mises[e].rows(), local_mises[e].cols()) = local_mises[e];
+			num_quadr_pts += local_stresses[e].rows();
 		}
-		result.conservativeResize(num_quadr_pts, result.cols());
-		von_mises.conservativeResize(num_quadr_pts, von_mises.cols());
 	}
 
 	void Evaluator::interpolate_function(
@@ -910,74 +1135,44 @@ namespace polyfem::io
 			return;
 		}
 
-		std::vector<AssemblyValues> tmp;
-
 		result.resize(n_points, actual_dim);
 
-		int index = 0;
-
-		Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
+		std::vector<int> offsets;
+		if (element_output_offsets(mesh, int(basis.size()), disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, offsets) < 0)
+			return;
 
-		for (int i = 0; i < int(basis.size()); ++i)
-		{
-			const ElementBases &bs = basis[i];
+		utils::maybe_parallel_for(int(basis.size()), [&](int start, int end, int thread_id) {
+			std::vector<AssemblyValues> tmp;
 			Eigen::MatrixXd local_pts;
 
-			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
-				continue;
-
-			if (use_sampler)
-			{
-				if (mesh.is_simplex(i))
-					local_pts = sampler.simplex_points();
-				else if (mesh.is_cube(i))
-					local_pts = sampler.cube_points();
-				else
-				{
-					if (mesh.is_volume())
-						sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, local_pts, vis_faces_poly, vis_edges_poly);
-					else
-						sampler.sample_polygon(polys.at(i), local_pts, vis_faces_poly, vis_edges_poly);
-				}
-			}
-			else
+			for (int i = start; i < end; ++i)
 			{
-				if (mesh.is_volume())
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_3d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_3d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-				else
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_2d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_2d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-			}
+				if (offsets[i] < 0)
+					continue;
 
-			Eigen::MatrixXd local_res = Eigen::MatrixXd::Zero(local_pts.rows(), actual_dim);
-			bs.evaluate_bases(local_pts, tmp);
-			for (size_t j = 0; j < bs.bases.size(); ++j)
-			{
-				const Basis &b = bs.bases[j];
+				const ElementBases &bs = basis[i];
+				element_output_points(mesh, i, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, local_pts);
 
-				for (int d = 0; d < actual_dim; ++d)
+				const auto cached = cached_reference_bases(bs, local_pts);
+				if (!cached)
+					bs.evaluate_bases(local_pts, tmp);
+				const std::vector<AssemblyValues> &vals = cached ? *cached : tmp;
+
+				Eigen::MatrixXd local_res = Eigen::MatrixXd::Zero(local_pts.rows(), actual_dim);
+				for (size_t j = 0; j < bs.bases.size(); ++j)
 				{
-					for (size_t ii = 0; ii < b.global().size(); ++ii)
-						local_res.col(d) += b.global()[ii].val * tmp[j].val * fun(b.global()[ii].index * actual_dim + d);
+					const Basis &b = bs.bases[j];
+
+					for (int d = 0; d < actual_dim; ++d)
+					{
+						for (size_t ii = 0; ii < b.global().size(); ++ii)
+							local_res.col(d) += b.global()[ii].val * vals[j].val * fun(b.global()[ii].index * actual_dim + d);
+					}
 				}
-			}
 
-			result.block(index, 0, local_res.rows(), actual_dim) = local_res;
-			index += local_res.rows();
-		}
+				result.block(offsets[i], 0, local_res.rows(), actual_dim) = local_res;
+			}
+		});
 	}
 
 	void Evaluator::interpolate_at_local_vals(
@@ -1119,7 +1314,7 @@ namespace polyfem::io
 			if (use_sampler)
 			{
 				if (mesh.is_simplex(i))
-					local_pts = sampler.simplex_points();
+					local_pts = sampler.simplex_points(i);
 				else if (mesh.is_cube(i))
 					local_pts = sampler.cube_points();
 				else
@@ -1189,75 +1384,12 @@ namespace polyfem::io
 
 		assert(!is_problem_scalar);
 
-		int index = 0;
-
-		Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
-		std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
-
-		for (int i = 0; i < int(bases.size()); ++i)
-		{
-			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
-				continue;
-
-			const ElementBases &bs = bases[i];
-			const ElementBases &gbs = gbases[i];
-			Eigen::MatrixXd local_pts;
-
-			if (use_sampler)
-			{
-				if (mesh.is_simplex(i))
-					local_pts = sampler.simplex_points();
-				else if (mesh.is_cube(i))
-					local_pts = sampler.cube_points();
-				else
-				{
-					if (mesh.is_volume())
-						sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, local_pts, vis_faces_poly, vis_edges_poly);
-					else
-						sampler.sample_polygon(polys.at(i), local_pts, vis_faces_poly, vis_edges_poly);
-				}
-			}
-			else
-			{
-				if (mesh.is_volume())
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_3d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_3d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-				else
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_2d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_2d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-			}
-
-			assembler.compute_scalar_value(OutputData(t, i, bs, gbs, local_pts, fun), tmp_s);
-
-			if (result.empty())
-			{
-				result.resize(tmp_s.size());
-				for (int k = 0; k < tmp_s.size(); ++k)
-				{
-					result[k].first = tmp_s[k].first;
-					result[k].second.resize(n_points, 1);
-				}
-			}
-
-			for (int k = 0; k < tmp_s.size(); ++k)
-			{
-				assert(local_pts.rows() == tmp_s[k].second.rows());
-				result[k].second.block(index, 0, tmp_s[k].second.rows(), 1) = tmp_s[k].second;
-			}
-			index += local_pts.rows();
-		}
+		evaluate_per_element(
+			mesh, int(bases.size()), disc_orders, polys, polys_3d, sampler, n_points, 1, use_sampler, boundary_only,
+			[&](const int i, const Eigen::MatrixXd &local_pts, std::vector<assembler::Assembler::NamedMatrix> &tmp) {
+				assembler.compute_scalar_value(OutputData(t, i, bases[i], gbases[i], local_pts, fun), tmp);
+			},
+			result);
 	}
 
 	void Evaluator::compute_tensor_value(
@@ -1288,75 +1420,12 @@ namespace polyfem::io
 		const int actual_dim = mesh.dimension();
 		assert(!is_problem_scalar);
 
-		int index = 0;
-
-		Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
-		std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_t;
-
-		for (int i = 0; i < int(bases.size()); ++i)
-		{
-			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
-				continue;
-
-			const ElementBases &bs = bases[i];
-			const ElementBases &gbs = gbases[i];
-			Eigen::MatrixXd local_pts;
-
-			if (use_sampler)
-			{
-				if (mesh.is_simplex(i))
-					local_pts = sampler.simplex_points();
-				else if (mesh.is_cube(i))
-					local_pts = sampler.cube_points();
-				else
-				{
-					if (mesh.is_volume())
-						sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, local_pts, vis_faces_poly, vis_edges_poly);
-					else
-						sampler.sample_polygon(polys.at(i), local_pts, vis_faces_poly, vis_edges_poly);
-				}
-			}
-			else
-			{
-				if (mesh.is_volume())
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_3d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_3d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-				else
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_2d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_2d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-			}
-
-			assembler.compute_tensor_value(OutputData(t, i, bs, gbs, local_pts, fun), tmp_t);
-
-			if (result.empty())
-			{
-				result.resize(tmp_t.size());
-				for (int k = 0; k < tmp_t.size(); ++k)
-				{
-					result[k].first = tmp_t[k].first;
-					result[k].second.resize(n_points, actual_dim * actual_dim);
-				}
-			}
-
-			for (int k = 0; k < tmp_t.size(); ++k)
-			{
-				assert(local_pts.rows() == tmp_t[k].second.rows());
-				result[k].second.block(index, 0, tmp_t[k].second.rows(), tmp_t[k].second.cols()) = tmp_t[k].second;
-			}
-			index += local_pts.rows();
-		}
+		evaluate_per_element(
+			mesh, int(bases.size()), disc_orders, polys, polys_3d, sampler, n_points, actual_dim * actual_dim, use_sampler, boundary_only,
+			[&](const int i, const Eigen::MatrixXd &local_pts, std::vector<assembler::Assembler::NamedMatrix> &tmp) {
+				assembler.compute_tensor_value(OutputData(t, i, bases[i], gbases[i], local_pts, fun), tmp);
+			},
+			result);
 	}
 
 	Eigen::MatrixXd Evaluator::get_bases_position(
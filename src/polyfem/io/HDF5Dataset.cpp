@@ -0,0 +1,221 @@
+#include "HDF5Dataset.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <hdf5.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace polyfem::io
+{
+	namespace
+	{
+		/// rows read at once when the dataset is not mapped, bounds the extra memory of the conversion to column major
+		constexpr long READ_BLOCK_SIZE = 1 << 16;
+
+		template <typename T>
+		hid_t native_type();
+
+		template <>
+		hid_t native_type<double>() { return H5T_NATIVE_DOUBLE; }
+
+		template <>
+		hid_t native_type<int>() { return H5T_NATIVE_INT; }
+	} // namespace
+
+	HDF5Dataset::HDF5Dataset(const std::string &path, const std::string &key)
+		: path_(path), key_(key)
+	{
+	}
+
+	HDF5Dataset::~HDF5Dataset()
+	{
+		close();
+	}
+
+	void HDF5Dataset::open() const
+	{
+		if (opened_)
+			return;
+		opened_ = true;
+
+		if (!std::filesystem::exists(path_))
+			return;
+
+		// missing datasets are expected, hdf5 should not print its error stack for them
+		H5E_BEGIN_TRY
+		{
+			file_ = H5Fopen(path_.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+			if (file_ >= 0 && H5Lexists(file_, key_.c_str(), H5P_DEFAULT) > 0)
+				dataset_ = H5Dopen2(file_, key_.c_str(), H5P_DEFAULT);
+		}
+		H5E_END_TRY;
+
+		if (dataset_ < 0)
+			return;
+
+		const hid_t space = H5Dget_space(dataset_);
+		rank_ = H5Sget_simple_extent_ndims(space);
+		hsize_t dims[2] = {0, 0};
+		if (rank_ == 1 || rank_ == 2)
+			H5Sget_simple_extent_dims(space, dims, nullptr);
+		H5Sclose(space);
+
+		if (rank_ != 1 && rank_ != 2)
+		{
+			logger().error("Dataset {} of {} has {} dimensions, only matrices are supported", key_, path_, rank_);
+			H5Dclose(dataset_);
+			dataset_ = -1;
+			return;
+		}
+
+		rows_ = dims[0];
+		cols_ = rank_ == 2 ? dims[1] : 1;
+
+		// contiguous uncompressed doubles are stored as they are in memory, at a fixed position of the file
+		const hid_t dcpl = H5Dget_create_plist(dataset_);
+		const hid_t type = H5Dget_type(dataset_);
+		const haddr_t offset = H5Dget_offset(dataset_);
+		if (H5Pget_layout(dcpl) == H5D_CONTIGUOUS && H5Pget_nfilters(dcpl) == 0
+			&& H5Tequal(type, H5T_NATIVE_DOUBLE) > 0 && offset != HADDR_UNDEF)
+			mappable_offset_ = offset;
+		H5Tclose(type);
+		H5Pclose(dcpl);
+	}
+
+	void HDF5Dataset::close()
+	{
+#ifndef _WIN32
+		if (mapping_ != nullptr)
+			munmap(mapping_, mapping_size_);
+#endif
+		mapping_ = nullptr;
+		mapped_data_ = nullptr;
+
+		if (dataset_ >= 0)
+			H5Dclose(dataset_);
+		if (file_ >= 0)
+			H5Fclose(file_);
+		dataset_ = -1;
+		file_ = -1;
+	}
+
+	bool HDF5Dataset::exists() const
+	{
+		open();
+		return dataset_ >= 0;
+	}
+
+	long HDF5Dataset::rows() const
+	{
+		open();
+		return rows_;
+	}
+
+	long HDF5Dataset::cols() const
+	{
+		open();
+		return cols_;
+	}
+
+	const double *HDF5Dataset::mapped_data() const
+	{
+		open();
+		if (mapped_data_ != nullptr || mappable_offset_ < 0 || rows_ * cols_ == 0)
+			return mapped_data_;
+
+#ifndef _WIN32
+		const int fd = ::open(path_.c_str(), O_RDONLY);
+		if (fd < 0)
+			return nullptr;
+
+		// the mapping has to start on a page boundary
+		const int64_t page_size = sysconf(_SC_PAGE_SIZE);
+		const int64_t start = (mappable_offset_ / page_size) * page_size;
+		mapping_size_ = mappable_offset_ - start + rows_ * cols_ * sizeof(double);
+
+		void *mapping = mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd, start);
+		::close(fd);
+		if (mapping == MAP_FAILED)
+		{
+			logger().debug("Unable to map dataset {} of {}, it will be read", key_, path_);
+			mappable_offset_ = -1;
+			return nullptr;
+		}
+
+		mapping_ = mapping;
+		mapped_data_ = reinterpret_cast<const double *>(static_cast<const char *>(mapping) + (mappable_offset_ - start));
+#endif
+
+		return mapped_data_;
+	}
+
+	bool HDF5Dataset::read_rows_raw(const long start, const long count, const int64_t mem_type, void *data) const
+	{
+		const hsize_t file_start[2] = {hsize_t(start), 0};
+		const hsize_t file_count[2] = {hsize_t(count), hsize_t(cols_)};
+
+		const hid_t file_space = H5Dget_space(dataset_);
+		H5Sselect_hyperslab(file_space, H5S_SELECT_SET, file_start, nullptr, file_count, nullptr);
+		const hid_t mem_space = H5Screate_simple(rank_, file_count, nullptr);
+
+		const herr_t status = H5Dread(dataset_, mem_type, mem_space, file_space, H5P_DEFAULT, data);
+
+		H5Sclose(mem_space);
+		H5Sclose(file_space);
+
+		return status >= 0;
+	}
+
+	template <typename T>
+	bool HDF5Dataset::read_rows(const long start, const long count, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat) const
+	{
+		if (!exists() || start < 0 || count < 0 || start + count > rows_)
+			return false;
+
+		mat.resize(count, cols_);
+		if (count == 0 || cols_ == 0)
+			return true;
+
+		if (const double *data = mapped_data())
+		{
+			mat = Eigen::Map<const RowMatrixXd>(data + start * cols_, count, cols_).template cast<T>();
+			return true;
+		}
+
+		// read by blocks of rows, only one block is stored twice
+		Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> block;
+		for (long r = 0; r < count; r += READ_BLOCK_SIZE)
+		{
+			const long n = std::min(READ_BLOCK_SIZE, count - r);
+			block.resize(n, cols_);
+			if (!read_rows_raw(start + r, n, native_type<T>(), block.data()))
+			{
+				logger().error("Unable to read dataset {} of {}", key_, path_);
+				return false;
+			}
+			mat.middleRows(r, n) = block;
+		}
+
+		return true;
+	}
+
+	template <typename T>
+	bool HDF5Dataset::read(Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat) const
+	{
+		return read_rows(0, rows(), mat);
+	}
+
+	template bool HDF5Dataset::read<int>(Eigen::MatrixXi &) const;
+	template bool HDF5Dataset::read<double>(Eigen::MatrixXd &) const;
+	template bool HDF5Dataset::read_rows<int>(const long, const long, Eigen::MatrixXi &) const;
+	template bool HDF5Dataset::read_rows<double>(const long, const long, Eigen::MatrixXd &) const;
+} // namespace polyfem::io
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <cstdint>
+#include <string>
+
+namespace polyfem::io
+{
+	/// Handle to a dataset of a hdf5 file, only opened on first use and read on demand, possibly in parts.
+	/// Uncompressed contiguous datasets of doubles are memory mapped instead of read: their pages are
+	/// only loaded when accessed and are shared with the page cache.
+	/// The datasets are row major, as written by h5pp, one dimensional datasets are column vectors.
+	class HDF5Dataset
+	{
+	public:
+		typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXd;
+
+		/// @param[in] path path of the hdf5 file
+		/// @param[in] key name of the dataset
+		HDF5Dataset(const std::string &path, const std::string &key);
+		~HDF5Dataset();
+
+		HDF5Dataset(const HDF5Dataset &) = delete;
+		HDF5Dataset &operator=(const HDF5Dataset &) = delete;
+
+		/// @return if the file and the dataset exist
+		bool exists() const;
+
+		/// number of rows of the dataset
+		long rows() const;
+		/// number of columns of the dataset
+		long cols() const;
+
+		/// @brief reads the whole dataset, converted to T
+		/// @param[out] mat values of the dataset
+		/// @return if the dataset could be read
+		template <typename T>
+		bool read(Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat) const;
+
+		/// @brief reads some consecutive rows of the dataset, converted to T
+		/// @param[in] start first row
+		/// @param[in] count number of rows
+		/// @param[out] mat count x cols() values
+		/// @return if the rows could be read
+		template <typename T>
+		bool read_rows(const long start, const long count, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat) const;
+
+		/// @brief maps the dataset in memory, without reading it
+		/// @return rows() x cols() row major values, nullptr if the dataset is not contiguous, is compressed or does not store doubles
+		const double *mapped_data() const;
+
+	private:
+		/// opens the file and the dataset and reads their layout, only once
+		void open() const;
+		/// releases the mapping, the dataset and the file
+		void close();
+
+		/// reads rows [start, start + count) into the row major buffer data of hdf5 memory type mem_type
+		bool read_rows_raw(const long start, const long count, const int64_t mem_type, void *data) const;
+
+		std::string path_;
+		std::string key_;
+
+		mutable bool opened_ = false;
+		mutable int64_t file_ = -1;
+		mutable int64_t dataset_ = -1;
+		mutable int rank_ = 0;
+		mutable long rows_ = 0;
+		mutable long cols_ = 0;
+
+		/// position of the data in the file if it can be mapped, -1 otherwise
+		mutable int64_t mappable_offset_ = -1;
+		mutable void *mapping_ = nullptr;
+		mutable size_t mapping_size_ = 0;
+		mutable const double *mapped_data_ = nullptr;
+	};
+} // namespace polyfem::io
@@ -1,9 +1,12 @@
 #include "MatrixIO.hpp"
 
+#include <polyfem/io/HDF5Dataset.hpp>
 #include <polyfem/utils/Logger.hpp>
 
 #include <igl/list_to_matrix.h>
 
+#include <unsupported/Eigen/SparseExtra>
+
 #include <iostream>
 #include <h5pp/h5pp.h>
 
@@ -11,9 +14,68 @@
 #include <iomanip> // setprecision
 #include <vector>
 #include <filesystem>
+#include <algorithm>
 
 namespace polyfem::io
 {
+	namespace
+	{
+		std::string lower_extension(const std::string &path)
+		{
+			std::string extension = std::filesystem::path(path).extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(),
+						   [](unsigned char c) { return std::tolower(c); });
+			return extension;
+		}
+
+		bool is_binary_path(const std::string &path)
+		{
+			return lower_extension(path) == ".bin";
+		}
+
+		typedef Eigen::Matrix<int64_t, Eigen::Dynamic, 1> IndexVector;
+
+		constexpr char sparse_magic[8] = {'P', 'F', 'S', 'P', 'A', 'R', 'S', 'E'};
+
+		/// reads n indices stored with index_size bytes into dst
+		bool read_indices(std::ifstream &in, const int64_t index_size, const int64_t n, StorageIndex *dst)
+		{
+			if (index_size == sizeof(StorageIndex))
+			{
+				in.read((char *)dst, n * sizeof(StorageIndex));
+			}
+			else if (index_size == sizeof(int32_t))
+			{
+				std::vector<int32_t> tmp(n);
+				in.read((char *)tmp.data(), n * sizeof(int32_t));
+				std::copy(tmp.begin(), tmp.end(), dst);
+			}
+			else if (index_size == sizeof(int64_t))
+			{
+				std::vector<int64_t> tmp(n);
+				in.read((char *)tmp.data(), n * sizeof(int64_t));
+				std::copy(tmp.begin(), tmp.end(), dst);
+			}
+			else
+				return false;
+			return in.good();
+		}
+
+		/// reads the compressed arrays directly in the storage of mat
+		template <typename SparseMat>
+		bool read_compressed(std::ifstream &in, const int64_t index_size, const int64_t rows, const int64_t cols, const int64_t nnz, SparseMat &mat)
+		{
+			mat.resize(rows, cols);
+			mat.resizeNonZeros(nnz);
+			if (!read_indices(in, index_size, mat.outerSize() + 1, mat.outerIndexPtr()))
+				return false;
+			if (!read_indices(in, index_size, nnz, mat.innerIndexPtr()))
+				return false;
+			in.read((char *)mat.valuePtr(), nnz * sizeof(double));
+			return in.good();
+		}
+	} // namespace
+
 	template <typename T>
 	bool read_matrix(const std::string &path, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat)
 	{
@@ -63,6 +125,9 @@ namespace polyfem::io
 	template <typename Mat>
 	bool write_matrix(const std::string &path, const std::string &key, const Mat &mat, const bool replace)
 	{
+		if (is_binary_path(path))
+			return write_matrix_binary(path, key, mat, replace);
+
 		h5pp::File hdf5_file(path, replace ? h5pp::FileAccess::REPLACE : h5pp::FileAccess::READWRITE);
 		hdf5_file.writeDataset(mat, key);
 
@@ -72,11 +137,12 @@ namespace polyfem::io
 	template <typename Mat>
 	bool read_matrix(const std::string &path, const std::string &key, Mat &mat)
 	{
-		h5pp::File hdf5_file(path, h5pp::FileAccess::READONLY);
-		if (!hdf5_file.linkExists(key))
-			return false;
-		mat = hdf5_file.readDataset<Mat>(key);
-		return true;
+		if (is_binary_path(path))
+			return read_matrix_binary(path, key, mat);
+
+		// mapped or read by blocks, without a full row major copy
+		const HDF5Dataset dataset(path, key);
+		return dataset.exists() && dataset.read(mat);
 	}
 
 	template <typename T>
@@ -189,6 +255,92 @@ namespace polyfem::io
 		return true;
 	}
 
+	template <typename Mat>
+	bool write_matrix_binary(const std::string &path, const std::string &key, const Mat &mat, const bool replace)
+	{
+		typedef typename Mat::Index Index;
+		typedef typename Mat::Scalar Scalar;
+		std::ofstream out(path, std::ios::out | std::ios::binary | (replace ? std::ios::trunc : std::ios::app));
+
+		if (!out.good())
+		{
+			logger().error("Failed to write to file: {}", path);
+			out.close();
+
+			return false;
+		}
+
+		// record: key size, key, scalar size, rows, cols, column-major data
+		const Index key_size = key.size(), scalar_size = sizeof(Scalar), rows = mat.rows(), cols = mat.cols();
+		out.write((const char *)(&key_size), sizeof(Index));
+		out.write(key.data(), key_size);
+		out.write((const char *)(&scalar_size), sizeof(Index));
+		out.write((const char *)(&rows), sizeof(Index));
+		out.write((const char *)(&cols), sizeof(Index));
+		if constexpr (Mat::IsRowMajor)
+		{
+			const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> tmp = mat;
+			out.write((const char *)tmp.data(), rows * cols * sizeof(Scalar));
+		}
+		else
+			out.write((const char *)mat.data(), rows * cols * sizeof(Scalar));
+		out.close();
+
+		return true;
+	}
+
+	template <typename Mat>
+	bool read_matrix_binary(const std::string &path, const std::string &key, Mat &mat)
+	{
+		typedef typename Mat::Index Index;
+		typedef typename Mat::Scalar Scalar;
+
+		std::ifstream in(path, std::ios::in | std::ios::binary);
+		if (!in.good())
+			return false;
+
+		// the last record of the key wins, as a dataset overwritten in hdf5
+		std::streampos data_pos = -1;
+		Index data_rows = 0, data_cols = 0;
+
+		Index key_size;
+		std::string record_key;
+		while (in.read((char *)(&key_size), sizeof(Index)))
+		{
+			Index scalar_size, rows, cols;
+			record_key.resize(key_size);
+			in.read(record_key.data(), key_size);
+			in.read((char *)(&scalar_size), sizeof(Index));
+			in.read((char *)(&rows), sizeof(Index));
+			in.read((char *)(&cols), sizeof(Index));
+			if (!in.good())
+				break;
+
+			if (record_key == key)
+			{
+				if (scalar_size != sizeof(Scalar))
+				{
+					logger().error("Matrix {} in {} has scalars of {} bytes, expected {}", key, path, scalar_size, sizeof(Scalar));
+					return false;
+				}
+				data_pos = in.tellg();
+				data_rows = rows;
+				data_cols = cols;
+			}
+			in.seekg(rows * cols * scalar_size, std::ios::cur);
+		}
+
+		if (data_pos < 0)
+			return false;
+
+		in.clear();
+		in.seekg(data_pos);
+		mat.resize(data_rows, data_cols);
+		in.read((char *)mat.data(), data_rows * data_cols * sizeof(Scalar));
+
+		return in.good();
+	}
+
 	bool write_sparse_matrix_csv(const std::string &path, const Eigen::SparseMatrix<double> &mat)
 	{
 		std::ofstream csv(path, std::ios::out);
@@ -219,6 +371,185 @@ namespace polyfem::io
 		return true;
 	}
 
+	bool write_sparse_matrix(const std::string &path, const StiffnessMatrix &mat, const int compression)
+	{
+		const std::string extension = lower_extension(path);
+		if (extension == ".bin")
+			return write_sparse_matrix_binary(path, mat);
+		else if (extension == ".hdf5" || extension == ".h5")
+			return write_sparse_matrix(path, "matrix", mat, true, compression);
+		else if (extension == ".csv")
+			return write_sparse_matrix_csv(path, mat);
+		else
+			return Eigen::saveMarket(mat, path);
+	}
+
+	bool read_sparse_matrix(const std::string &path, StiffnessMatrix &mat)
+	{
+		const std::string extension = lower_extension(path);
+		if (extension == ".bin")
+			return read_sparse_matrix_binary(path, mat);
+		else if (extension == ".hdf5" || extension == ".h5")
+			return read_sparse_matrix(path, "matrix", mat);
+		else if (extension == ".csv")
+		{
+			logger().error("Reading sparse matrices from csv files is not supported: {}", path);
+			return false;
+		}
+		else
+			return Eigen::loadMarket(mat, path);
+	}
+
+	bool write_sparse_matrix(const std::string &path, const std::string &key, const StiffnessMatrix &mat, const bool replace, const int compression)
+	{
+		StiffnessMatrix compressed;
+		if (!mat.isCompressed())
+		{
+			compressed = mat;
+			compressed.makeCompressed();
+		}
+		const StiffnessMatrix &m = mat.isCompressed() ? mat : compressed;
+
+		IndexVector shape(4);
+		shape << m.rows(), m.cols(), m.nonZeros(), StiffnessMatrix::IsRowMajor;
+		const IndexVector outer = Eigen::Map<const Eigen::Matrix<StorageIndex, Eigen::Dynamic, 1>>(m.outerIndexPtr(), m.outerSize() + 1).cast<int64_t>();
+		const IndexVector inner = Eigen::Map<const Eigen::Matrix<StorageIndex, Eigen::Dynamic, 1>>(m.innerIndexPtr(), m.nonZeros()).cast<int64_t>();
+		const Eigen::VectorXd values = Eigen::Map<const Eigen::VectorXd>(m.valuePtr(), m.nonZeros());
+
+		if (is_binary_path(path))
+		{
+			return write_matrix_binary(path, key + "/shape", shape, replace)
+				   && write_matrix_binary(path, key + "/outer", outer, false)
+				   && write_matrix_binary(path, key + "/inner", inner, false)
+				   && write_matrix_binary(path, key + "/values", values, false);
+		}
+
+		h5pp::File hdf5_file(path, replace ? h5pp::FileAccess::REPLACE : h5pp::FileAccess::READWRITE);
+		hdf5_file.setCompressionLevel(compression);
+		// only chunked datasets can be compressed
+		const auto layout = compression > 0 ? H5D_CHUNKED : H5D_CONTIGUOUS;
+		hdf5_file.writeDataset(shape, key + "/shape");
+		hdf5_file.writeDataset(outer, key + "/outer", layout);
+		hdf5_file.writeDataset(inner, key + "/inner", layout);
+		hdf5_file.writeDataset(values, key + "/values", layout);
+
+		return true;
+	}
+
+	bool read_sparse_matrix(const std::string &path, const std::string &key, StiffnessMatrix &mat)
+	{
+		IndexVector shape, outer, inner;
+		Eigen::VectorXd values;
+		if (!read_matrix(path, key + "/shape", shape) || shape.size() != 4
+			|| !read_matrix(path, key + "/outer", outer)
+			|| !read_matrix(path, key + "/inner", inner)
+			|| !read_matrix(path, key + "/values", values))
+			return false;
+
+		const int64_t rows = shape[0], cols = shape[1], nnz = shape[2];
+		const bool row_major = shape[3] != 0;
+		if (outer.size() != (row_major ? rows : cols) + 1 || inner.size() != nnz || values.size() != nnz)
+		{
+			logger().error("Inconsistent sparse matrix {} in {}", key, path);
+			return false;
+		}
+
+		const auto fill = [&](auto &m) {
+			m.resize(rows, cols);
+			m.resizeNonZeros(nnz);
+			std::copy(outer.data(), outer.data() + outer.size(), m.outerIndexPtr());
+			std::copy(inner.data(), inner.data() + nnz, m.innerIndexPtr());
+			std::copy(values.data(), values.data() + nnz, m.valuePtr());
+		};
+
+		if (row_major == bool(StiffnessMatrix::IsRowMajor))
+			fill(mat);
+		else
+		{
+			Eigen::SparseMatrix<double, Eigen::RowMajor, StorageIndex> tmp;
+			fill(tmp);
+			mat = tmp;
+		}
+
+		return true;
+	}
+
+	bool write_sparse_matrix_binary(const std::string &path, const StiffnessMatrix &mat)
+	{
+		std::ofstream out(path, std::ios::out | std::ios::binary);
+
+		if (!out.good())
+		{
+			logger().error("Failed to write to file: {}", path);
+			out.close();
+
+			return false;
+		}
+
+		StiffnessMatrix compressed;
+		if (!mat.isCompressed())
+		{
+			compressed = mat;
+			compressed.makeCompressed();
+		}
+		const StiffnessMatrix &m = mat.isCompressed() ? mat : compressed;
+
+		const int64_t header[6] = {sizeof(double), sizeof(StorageIndex), StiffnessMatrix::IsRowMajor, m.rows(), m.cols(), m.nonZeros()};
+		out.write(sparse_magic, sizeof(sparse_magic));
+		out.write((const char *)header, sizeof(header));
+		out.write((const char *)m.outerIndexPtr(), (m.outerSize() + 1) * sizeof(StorageIndex));
+		out.write((const char *)m.innerIndexPtr(), m.nonZeros() * sizeof(StorageIndex));
+		out.write((const char *)m.valuePtr(), m.nonZeros() * sizeof(double));
+		out.close();
+
+		return true;
+	}
+
+	bool read_sparse_matrix_binary(const std::string &path, StiffnessMatrix &mat)
+	{
+		std::ifstream in(path, std::ios::in | std::ios::binary);
+		if (!in.good())
+		{
+			logger().error("Failed to open file: {}", path);
+			in.close();
+
+			return false;
+		}
+
+		char magic[sizeof(sparse_magic)];
+		int64_t header[6];
+		in.read(magic, sizeof(magic));
+		in.read((char *)header, sizeof(header));
+		if (!in.good() || !std::equal(magic, magic + sizeof(magic), sparse_magic))
+		{
+			logger().error("{} is not a binary sparse matrix", path);
+			return false;
+		}
+
+		const int64_t scalar_size = header[0], index_size = header[1], rows = header[3], cols = header[4], nnz = header[5];
+		const bool row_major = header[2] != 0;
+		if (scalar_size != sizeof(double))
+		{
+			logger().error("Sparse matrix in {} has scalars of {} bytes, expected {}", path, scalar_size, sizeof(double));
+			return false;
+		}
+
+		bool success;
+		if (row_major == bool(StiffnessMatrix::IsRowMajor))
+			success = read_compressed(in, index_size, rows, cols, nnz, mat);
+		else
+		{
+			Eigen::SparseMatrix<double, Eigen::RowMajor, StorageIndex> tmp;
+			success = read_compressed(in, index_size, rows, cols, nnz, tmp);
+			if (success)
+				mat = tmp;
+		}
+
+		if (!success)
+			logger().error("Failed to read the sparse matrix in {}", path);
+		return success;
+	}
+
 	template <typename T>
 	bool import_matrix(
 		const std::string &path, const json &import, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat)
@@ -256,6 +587,7 @@ namespace polyfem::io
 	template bool write_matrix<Eigen::VectorXf>(const std::string &, const Eigen::VectorXf &);
 
 	template bool write_matrix<Eigen::MatrixXd>(const std::string &, const std::string &, const Eigen::MatrixXd &, const bool);
+	template bool write_matrix<Eigen::MatrixXi>(const std::string &, const std::string &, const Eigen::MatrixXi &, const bool);
 	template bool write_matrix<Eigen::MatrixXf>(const std::string &, const std::string &, const Eigen::MatrixXf &, const bool);
 	template bool write_matrix<Eigen::VectorXd>(const std::string &, const std::string &, const Eigen::VectorXd &, const bool);
 	template bool write_matrix<Eigen::VectorXf>(const std::string &, const std::string &, const Eigen::VectorXf &, const bool);
@@ -276,6 +608,13 @@ namespace polyfem::io
 	template bool write_matrix_binary<Eigen::VectorXd>(const std::string &, const Eigen::VectorXd &);
 	template bool write_matrix_binary<Eigen::VectorXf>(const std::string &, const Eigen::VectorXf &);
 
+	template bool write_matrix_binary<Eigen::MatrixXd>(const std::string &, const std::string &, const Eigen::MatrixXd &, const bool);
+	template bool write_matrix_binary<Eigen::MatrixXi>(const std::string &, const std::string &, const Eigen::MatrixXi &, const bool);
+	template bool write_matrix_binary<Eigen::VectorXd>(const std::string &, const std::string &, const Eigen::VectorXd &, const bool);
+
+	template bool read_matrix_binary<Eigen::MatrixXi>(const std::string &, const std::string &, Eigen::MatrixXi &);
+	template bool read_matrix_binary<Eigen::MatrixXd>(const std::string &, const std::string &, Eigen::MatrixXd &);
+
 	template bool import_matrix<int>(const std::string &path, const json &import, Eigen::MatrixXi &mat);
 	template bool import_matrix<double>(const std::string &path, const json &import, Eigen::MatrixXd &mat);
 
@@ -16,11 +16,12 @@ namespace polyfem::io
 	template <typename Mat>
 	bool write_matrix(const std::string &path, const Mat &mat);
 
-	/// Writes a matrix to a hdf5 file using key as name.
+	/// Writes a matrix to a hdf5 file (or a binary file if the extension is .bin) using key as name.
 	template <typename Mat>
 	bool write_matrix(const std::string &path, const std::string &key, const Mat &mat, const bool replace = true);
 
-	/// Reads a matrix to a hdf5 file using key as name.
+	/// Reads a matrix to a hdf5 file (or a binary file if the extension is .bin) using key as name.
+	/// See HDF5Dataset to read only parts of a hdf5 dataset.
 	template <typename Mat>
 	bool read_matrix(const std::string &path, const std::string &key, Mat &mat);
 
@@ -36,8 +37,38 @@ namespace polyfem::io
 	template <typename Mat>
 	bool write_matrix_binary(const std::string &path, const Mat &mat);
 
+	/// Writes a matrix to a binary file using key as name, the records of several keys are appended unless replace.
+	template <typename Mat>
+	bool write_matrix_binary(const std::string &path, const std::string &key, const Mat &mat, const bool replace = true);
+
+	/// Reads a matrix from a binary file written by write_matrix_binary using key as name.
+	template <typename Mat>
+	bool read_matrix_binary(const std::string &path, const std::string &key, Mat &mat);
+
 	bool write_sparse_matrix_csv(const std::string &path, const Eigen::SparseMatrix<double> &mat);
 
+	/// Writes a sparse matrix to a file. Determines the file format based on the path's extension:
+	/// .bin (raw compressed arrays, see write_sparse_matrix_binary), .hdf5/.h5, .csv or .mtx (Matrix Market).
+	/// @param[in] compression compression level of the hdf5 datasets (0-9), ignored by the other formats
+	bool write_sparse_matrix(const std::string &path, const StiffnessMatrix &mat, const int compression = 0);
+
+	/// Reads a sparse matrix written by write_sparse_matrix (.csv excluded).
+	bool read_sparse_matrix(const std::string &path, StiffnessMatrix &mat);
+
+	/// Writes a sparse matrix to a hdf5 file (or a binary file if the extension is .bin) using key as group name.
+	/// The group contains the datasets shape (rows, cols, nnz, row major), outer, inner and values.
+	bool write_sparse_matrix(const std::string &path, const std::string &key, const StiffnessMatrix &mat, const bool replace = true, const int compression = 0);
+
+	/// Reads a sparse matrix from a hdf5 file (or a binary file if the extension is .bin) using key as group name.
+	bool read_sparse_matrix(const std::string &path, const std::string &key, StiffnessMatrix &mat);
+
+	/// Writes the compressed arrays of a sparse matrix without conversion (CSC for StiffnessMatrix) after a header:
+	/// 8 bytes magic, then as int64 the scalar size, the index size, the row major flag, rows, cols and nnz.
+	bool write_sparse_matrix_binary(const std::string &path, const StiffnessMatrix &mat);
+
+	/// Reads a sparse matrix written by write_sparse_matrix_binary, CSR files and other index sizes are converted.
+	bool read_sparse_matrix_binary(const std::string &path, StiffnessMatrix &mat);
+
 	template <typename T>
 	bool import_matrix(const std::string &path, const json &import, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat);
 } // namespace polyfem::io
@@ -2,6 +2,7 @@
 
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/StringUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <mshio/mshio.h>
 
@@ -76,22 +77,32 @@ namespace polyfem::io
 		if (n_vertices != max_tag)
 			logger().warn("MSH file contains more node tags than nodes, condensing nodes which will break input node ordering.");
 
-		int index = 0;
-		for (const auto &n : nodes.entity_blocks)
+		// start of every node block in the condensed numbering
+		std::vector<int> node_block_start(nodes.entity_blocks.size() + 1, 0);
+		for (int b = 0; b < nodes.entity_blocks.size(); ++b)
+			node_block_start[b + 1] = node_block_start[b] + nodes.entity_blocks[b].num_nodes_in_block;
+
+		for (int b = 0; b < nodes.entity_blocks.size(); ++b)
 		{
-			for (int i = 0; i < n.num_nodes_in_block * 3; i += 3)
-			{
-				const int node_id = n_vertices != max_tag ? (index++) : (n.tags[i / 3] - 1);
+			const auto &n = nodes.entity_blocks[b];
+			utils::maybe_parallel_for(n.num_nodes_in_block, [&](int start, int end, int thread_id) {
+				for (int k = start; k < end; ++k)
+				{
+					const int i = 3 * k;
+					const int node_id = n_vertices != max_tag ? (node_block_start[b] + k) : (n.tags[k] - 1);
 
-				if (dim == 2)
-					vertices.row(node_id) << n.data[i], n.data[i + 1];
-				if (dim == 3)
-					vertices.row(node_id) << n.data[i], n.data[i + 1], n.data[i + 2];
+					if (dim == 2)
+						vertices.row(node_id) << n.data[i], n.data[i + 1];
+					if (dim == 3)
+						vertices.row(node_id) << n.data[i], n.data[i + 1], n.data[i + 2];
 
-				assert(n.tags[i / 3] < tag_to_index.size());
-				tag_to_index[n.tags[i / 3]] = node_id;
-			}
+					assert(n.tags[k] < tag_to_index.size());
+					tag_to_index[n.tags[k]] = node_id;
+				}
+			});
 		}
+		// the node coordinates are no longer needed, release them before filling the cells
+		std::vector<mshio::NodeBlock>().swap(spec.nodes.entity_blocks);
 
 		int cells_cols = -1;
 		int num_els = 0;
@@ -147,31 +158,39 @@ namespace polyfem::io
 			if (type == 2 || type == 9 || type == 21 || type == 23 || type == 25 || type == 3 || type == 10 || type == 4 || type == 11 || type == 29 || type == 30 || type == 31 || type == 5 || type == 12)
 			{
 				const size_t n_nodes = mshio::nodes_per_element(type);
-				for (int i = 0; i < e.data.size(); i += (n_nodes + 1))
-				{
-					int index = 0;
-					for (int j = i + 1; j <= i + cells_cols; ++j)
-					{
-						const int v_index = tag_to_index[e.data[j]];
-						assert(v_index < n_vertices);
-						cells(cell_index, index++) = v_index;
-					}
+				const auto &it = entity_tag_to_physical_tag.find(e.entity_tag);
+				const int body_id = it != entity_tag_to_physical_tag.end() ? it->second : 0;
+				const int block_start = cell_index;
 
-					for (int j = i + 1; j < i + 1 + n_nodes; ++j)
+				utils::maybe_parallel_for(e.data.size() / (n_nodes + 1), [&](int start, int end, int thread_id) {
+					for (int k = start; k < end; ++k)
 					{
-						const int v_index = tag_to_index[e.data[j]];
-						assert(v_index < n_vertices);
-						elements[cell_index].push_back(v_index);
+						const size_t i = k * (n_nodes + 1);
+						const int c = block_start + k;
+
+						for (int j = 0; j < cells_cols; ++j)
+						{
+							const int v_index = tag_to_index[e.data[i + 1 + j]];
+							assert(v_index < n_vertices);
+							cells(c, j) = v_index;
+						}
+
+						elements[c].resize(n_nodes);
+						for (int j = 0; j < n_nodes; ++j)
+						{
+							const int v_index = tag_to_index[e.data[i + 1 + j]];
+							assert(v_index < n_vertices);
+							elements[c][j] = v_index;
+						}
+
+						body_ids[c] = body_id;
 					}
+				});
 
-					const auto &it = entity_tag_to_physical_tag.find(e.entity_tag);
-					body_ids[cell_index] =
-						it != entity_tag_to_physical_tag.end() ? it->second : 0;
-
-					++cell_index;
-				}
+				cell_index += e.data.size() / (n_nodes + 1);
 			}
 		}
+		std::vector<mshio::ElementBlock>().swap(spec.elements.entity_blocks);
 
 		node_data.resize(spec.node_data.size());
 		int i = 0;
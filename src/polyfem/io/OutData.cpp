@@ -36,6 +36,7 @@
 #include <polyfem/utils/par_for.hpp>
 #include <polyfem/utils/BoundarySampler.hpp>
 #include <polyfem/utils/Timer.hpp>
+#include <polyfem/utils/Profiler.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/getRSS.h>
 
@@ -45,7 +46,6 @@
 #include <paraviewo/VTMWriter.hpp>
 #include <paraviewo/PVDWriter.hpp>
 
-#include <SimpleBVH/BVH.hpp>
 
 #include <igl/write_triangle_mesh.h>
 #include <igl/edges.h>
@@ -54,7 +54,10 @@
 
 #include <ipc/ipc.hpp>
 
+#include <algorithm>
+#include <array>
 #include <filesystem>
+#include <fstream>
 
 namespace polyfem::io
 {
@@ -141,6 +144,52 @@ namespace polyfem::io
 				}
 			}
 		}
+
+		/// normals of the boundary samples of vals, before and after applying the displacement solution
+		/// @param[in] reference_normal normal of the facet in the reference element
+		void boundary_sample_normals(
+			const assembler::ElementAssemblyValues &vals,
+			const Eigen::MatrixXd &reference_normal,
+			const Eigen::MatrixXd &solution,
+			const int problem_dim,
+			Eigen::MatrixXd &normals,
+			Eigen::MatrixXd &displaced_normals)
+		{
+			Eigen::MatrixXd trafo, deform_mat;
+
+			normals.resize(vals.jac_it.size(), reference_normal.cols());
+			displaced_normals.resize(vals.jac_it.size(), reference_normal.cols());
+
+			for (int n = 0; n < vals.jac_it.size(); ++n)
+			{
+				trafo = vals.jac_it[n].inverse();
+
+				if (problem_dim == 2 || problem_dim == 3)
+				{
+
+					if (solution.size() > 0)
+					{
+						deform_mat.resize(problem_dim, problem_dim);
+						deform_mat.setZero();
+						for (const auto &b : vals.basis_values)
+							for (const auto &g : b.global)
+								for (int d = 0; d < problem_dim; ++d)
+									deform_mat.row(d) += solution(g.index * problem_dim + d) * b.grad.row(n);
+
+						trafo += deform_mat;
+					}
+				}
+
+				normals.row(n) = reference_normal * vals.jac_it[n];
+				normals.row(n).normalize();
+
+				displaced_normals.row(n) = reference_normal * trafo.inverse();
+				displaced_normals.row(n).normalize();
+			}
+		}
+
+		/// distance from the geometric mapping to its affine interpolation, relative to the element size, above which a simplex is sampled as curved
+		constexpr double CURVED_SIMPLEX_TOLERANCE = 1e-3;
 	} // namespace
 
 	void OutGeometryData::extract_boundary_mesh(
@@ -395,26 +444,18 @@ namespace polyfem::io
 		}
 	}
 
-	void OutGeometryData::build_vis_boundary_mesh(
+	void OutGeometryData::build_vis_boundary_cache(
 		const mesh::Mesh &mesh,
 		const std::vector<basis::ElementBases> &bases,
 		const std::vector<basis::ElementBases> &gbases,
-		const std::vector<mesh::LocalBoundary> &total_local_boundary,
-		const Eigen::MatrixXd &solution,
-		const int problem_dim,
-		Eigen::MatrixXd &boundary_vis_vertices,
-		Eigen::MatrixXd &boundary_vis_local_vertices,
-		Eigen::MatrixXi &boundary_vis_elements,
-		Eigen::MatrixXi &boundary_vis_elements_ids,
-		Eigen::MatrixXi &boundary_vis_primitive_ids,
-		Eigen::MatrixXd &boundary_vis_normals,
-		Eigen::MatrixXd &displaced_boundary_vis_normals) const
+		const std::vector<mesh::LocalBoundary> &total_local_boundary) const
 	{
 		using namespace polyfem::mesh;
 
-		std::vector<Eigen::MatrixXd> lv, vertices, allnormals, displaced_allnormals;
-		std::vector<int> el_ids, global_primitive_ids;
-		Eigen::MatrixXd uv, local_pts, tmp_n, normals, displaced_normals, trafo, deform_mat;
+		VisBoundaryCache &cache = vis_boundary_cache;
+		cache = VisBoundaryCache();
+
+		Eigen::MatrixXd uv, local_pts, tmp_n, mapped, normals, displaced_normals;
 		assembler::ElementAssemblyValues vals;
 		const auto &sampler = ref_element_sampler;
 		const int n_samples = sampler.num_samples();
@@ -463,12 +504,11 @@ namespace polyfem::io
 					assert(false);
 				}
 
-				vertices.emplace_back();
-				lv.emplace_back(local_pts);
-				el_ids.push_back(lb.element_id());
-				global_primitive_ids.push_back(lb.global_primitive_id(k));
-				gbs.eval_geom_mapping(local_pts, vertices.back());
-				vals.compute(lb.element_id(), mesh.is_volume(), local_pts, bs, gbs);
+				cache.element_ids.push_back(lb.element_id());
+				cache.primitive_ids.push_back(lb.global_primitive_id(k));
+				cache.local_points.push_back(local_pts);
+				cache.reference_normal.push_back(tmp_n);
+				cache.offsets.push_back(size);
 				const int tris_start = tris.size();
 
 				if (mesh.is_volume())
@@ -520,59 +560,17 @@ namespace polyfem::io
 					{
 						assert(false);
 					}
-				}
-				else
-				{
-					for (int i = 0; i < vertices.back().rows() - 1; ++i)
-						edges.emplace_back(i + size, i + size + 1);
-				}
-
-				normals.resize(vals.jac_it.size(), tmp_n.cols());
-				displaced_normals.resize(vals.jac_it.size(), tmp_n.cols());
-
-				for (int n = 0; n < vals.jac_it.size(); ++n)
-				{
-					trafo = vals.jac_it[n].inverse();
-
-					if (problem_dim == 2 || problem_dim == 3)
-					{
-
-						if (solution.size() > 0)
-						{
-							deform_mat.resize(problem_dim, problem_dim);
-							deform_mat.setZero();
-							for (const auto &b : vals.basis_values)
-								for (const auto &g : b.global)
-									for (int d = 0; d < problem_dim; ++d)
-										deform_mat.row(d) += solution(g.index * problem_dim + d) * b.grad.row(n);
-
-							trafo += deform_mat;
-						}
-					}
-
-					normals.row(n) = tmp_n * vals.jac_it[n];
-					normals.row(n).normalize();
-
-					displaced_normals.row(n) = tmp_n * trafo.inverse();
-					displaced_normals.row(n).normalize();
-				}
-
-				allnormals.push_back(normals);
-				displaced_allnormals.push_back(displaced_normals);
 
-				tmp_n.setZero();
-				for (int n = 0; n < vals.jac_it.size(); ++n)
-				{
-					tmp_n += normals.row(n);
-				}
+					// orient the triangles as the outward normal of the facet
+					gbs.eval_geom_mapping(local_pts, mapped);
+					vals.compute(lb.element_id(), true, local_pts, bs, gbs);
+					boundary_sample_normals(vals, tmp_n, Eigen::MatrixXd(), 3, normals, displaced_normals);
 
-				if (mesh.is_volume())
-				{
-					Eigen::Vector3d e1 = vertices.back().row(std::get<1>(tris.back()) - size) - vertices.back().row(std::get<0>(tris.back()) - size);
-					Eigen::Vector3d e2 = vertices.back().row(std::get<2>(tris.back()) - size) - vertices.back().row(std::get<0>(tris.back()) - size);
+					Eigen::Vector3d e1 = mapped.row(std::get<1>(tris.back()) - size) - mapped.row(std::get<0>(tris.back()) - size);
+					Eigen::Vector3d e2 = mapped.row(std::get<2>(tris.back()) - size) - mapped.row(std::get<0>(tris.back()) - size);
 
 					Eigen::Vector3d n = e1.cross(e2);
-					Eigen::Vector3d nn = tmp_n.transpose();
+					Eigen::Vector3d nn = normals.colwise().sum().transpose();
 
 					if (n.dot(nn) < 0)
 					{
@@ -582,208 +580,194 @@ namespace polyfem::io
 						}
 					}
 				}
+				else
+				{
+					for (int i = 0; i < local_pts.rows() - 1; ++i)
+						edges.emplace_back(i + size, i + size + 1);
+				}
 
-				size += vertices.back().rows();
+				size += local_pts.rows();
 			}
 		}
-
-		boundary_vis_vertices.resize(size, vertices.front().cols());
-		boundary_vis_local_vertices.resize(size, vertices.front().cols());
-		boundary_vis_elements_ids.resize(size, 1);
-		boundary_vis_primitive_ids.resize(size, 1);
-		boundary_vis_normals.resize(size, vertices.front().cols());
-		displaced_boundary_vis_normals.resize(size, vertices.front().cols());
+		cache.offsets.push_back(size);
 
 		if (mesh.is_volume())
-			boundary_vis_elements.resize(tris.size(), 3);
-		else
-			boundary_vis_elements.resize(edges.size(), 2);
-
-		int index = 0;
-		int ii = 0;
-		for (const auto &v : vertices)
 		{
-			boundary_vis_vertices.block(index, 0, v.rows(), v.cols()) = v;
-			boundary_vis_local_vertices.block(index, 0, v.rows(), v.cols()) = lv[ii];
-			boundary_vis_elements_ids.block(index, 0, v.rows(), 1).setConstant(el_ids[ii]);
-			boundary_vis_primitive_ids.block(index, 0, v.rows(), 1).setConstant(global_primitive_ids[ii++]);
-			index += v.rows();
+			cache.cells.resize(tris.size(), 3);
+			for (int i = 0; i < tris.size(); ++i)
+				cache.cells.row(i) << std::get<0>(tris[i]), std::get<1>(tris[i]), std::get<2>(tris[i]);
 		}
-
-		index = 0;
-		for (const auto &n : allnormals)
+		else
 		{
-			boundary_vis_normals.block(index, 0, n.rows(), n.cols()) = n;
-			index += n.rows();
+			cache.cells.resize(edges.size(), 2);
+			for (int i = 0; i < edges.size(); ++i)
+				cache.cells.row(i) << edges[i].first, edges[i].second;
 		}
 
-		index = 0;
-		for (const auto &n : displaced_allnormals)
-		{
-			displaced_boundary_vis_normals.block(index, 0, n.rows(), n.cols()) = n;
-			index += n.rows();
-		}
+		cache.valid = true;
+	}
 
-		index = 0;
-		if (mesh.is_volume())
-		{
-			for (const auto &t : tris)
-			{
-				boundary_vis_elements.row(index) << std::get<0>(t), std::get<1>(t), std::get<2>(t);
-				++index;
-			}
-		}
-		else
-		{
-			for (const auto &e : edges)
+	void OutGeometryData::build_vis_boundary_mesh(
+		const mesh::Mesh &mesh,
+		const std::vector<basis::ElementBases> &bases,
+		const std::vector<basis::ElementBases> &gbases,
+		const std::vector<mesh::LocalBoundary> &total_local_boundary,
+		const Eigen::MatrixXd &solution,
+		const int problem_dim,
+		Eigen::MatrixXd &boundary_vis_vertices,
+		Eigen::MatrixXd &boundary_vis_local_vertices,
+		Eigen::MatrixXi &boundary_vis_elements,
+		Eigen::MatrixXi &boundary_vis_elements_ids,
+		Eigen::MatrixXi &boundary_vis_primitive_ids,
+		Eigen::MatrixXd &boundary_vis_normals,
+		Eigen::MatrixXd &displaced_boundary_vis_normals) const
+	{
+		if (!vis_boundary_cache.valid)
+			build_vis_boundary_cache(mesh, bases, gbases, total_local_boundary);
+		const VisBoundaryCache &cache = vis_boundary_cache;
+
+		const int n_facets = cache.element_ids.size();
+		const int size = cache.offsets.back();
+		const int dim = mesh.dimension();
+
+		boundary_vis_vertices.resize(size, dim);
+		boundary_vis_local_vertices.resize(size, dim);
+		boundary_vis_elements_ids.resize(size, 1);
+		boundary_vis_primitive_ids.resize(size, 1);
+		boundary_vis_normals.resize(size, dim);
+		displaced_boundary_vis_normals.resize(size, dim);
+		boundary_vis_elements = cache.cells;
+
+		utils::maybe_parallel_for(n_facets, [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd mapped, normals, displaced_normals;
+			assembler::ElementAssemblyValues vals;
+
+			for (int f = start; f < end; ++f)
 			{
-				boundary_vis_elements.row(index) << e.first, e.second;
-				++index;
+				const int e = cache.element_ids[f];
+				const int offset = cache.offsets[f];
+				const Eigen::MatrixXd &local_pts = cache.local_points[f];
+				const int n = local_pts.rows();
+
+				gbases[e].eval_geom_mapping(local_pts, mapped);
+				vals.compute(e, mesh.is_volume(), local_pts, bases[e], gbases[e]);
+				boundary_sample_normals(vals, cache.reference_normal[f], solution, problem_dim, normals, displaced_normals);
+
+				boundary_vis_vertices.middleRows(offset, n) = mapped;
+				boundary_vis_local_vertices.middleRows(offset, n) = local_pts;
+				boundary_vis_elements_ids.middleRows(offset, n).setConstant(e);
+				boundary_vis_primitive_ids.middleRows(offset, n).setConstant(cache.primitive_ids[f]);
+				boundary_vis_normals.middleRows(offset, n) = normals;
+				displaced_boundary_vis_normals.middleRows(offset, n) = displaced_normals;
 			}
-		}
+		});
 	}
 
-	void OutGeometryData::build_vis_mesh(
+	void OutGeometryData::build_vis_mesh_cache(
 		const mesh::Mesh &mesh,
 		const Eigen::VectorXi &disc_orders,
 		const std::vector<basis::ElementBases> &gbases,
 		const std::map<int, Eigen::MatrixXd> &polys,
 		const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
-		const bool boundary_only,
-		Eigen::MatrixXd &points,
-		Eigen::MatrixXi &tets,
-		Eigen::MatrixXi &el_id,
-		Eigen::MatrixXd &discr) const
+		const bool boundary_only) const
 	{
-		// if (!mesh)
-		// {
-		// 	logger().error("Load the mesh first!");
-		// 	return;
-		// }
-		// if (n_bases <= 0)
-		// {
-		// 	logger().error("Build the bases first!");
-		// 	return;
-		// }
-
 		const auto &sampler = ref_element_sampler;
 
-		const auto &current_bases = gbases;
-		int tet_total_size = 0;
-		int pts_total_size = 0;
+		VisMeshCache &cache = vis_mesh_cache;
+		cache = VisMeshCache();
+		cache.boundary_only = boundary_only;
 
+		std::vector<Eigen::MatrixXi> element_cells;
 		Eigen::MatrixXd vis_pts_poly;
 		Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
+		int tet_total_size = 0;
+		int pts_total_size = 0;
 
-		for (size_t i = 0; i < current_bases.size(); ++i)
+		for (size_t i = 0; i < gbases.size(); ++i)
 		{
-			const auto &bs = current_bases[i];
-
 			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
 				continue;
 
 			if (mesh.is_simplex(i))
 			{
-				tet_total_size += sampler.simplex_volume().rows();
-				pts_total_size += sampler.simplex_points().rows();
+				cache.local_points.push_back(sampler.simplex_points(i));
+				element_cells.push_back(sampler.simplex_volume(i));
 			}
 			else if (mesh.is_cube(i))
 			{
-				tet_total_size += sampler.cube_volume().rows();
-				pts_total_size += sampler.cube_points().rows();
+				cache.local_points.push_back(sampler.cube_points());
+				element_cells.push_back(sampler.cube_volume());
 			}
 			else
 			{
 				if (mesh.is_volume())
-				{
 					sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, vis_pts_poly, vis_faces_poly, vis_edges_poly);
-
-					tet_total_size += vis_faces_poly.rows();
-					pts_total_size += vis_pts_poly.rows();
-				}
 				else
-				{
 					sampler.sample_polygon(polys.at(i), vis_pts_poly, vis_faces_poly, vis_edges_poly);
 
-					tet_total_size += vis_faces_poly.rows();
-					pts_total_size += vis_pts_poly.rows();
-				}
+				cache.local_points.push_back(vis_pts_poly);
+				element_cells.push_back(vis_faces_poly);
 			}
-		}
-
-		points.resize(pts_total_size, mesh.dimension());
-		tets.resize(tet_total_size, mesh.is_volume() ? 4 : 3);
 
-		el_id.resize(pts_total_size, 1);
-		discr.resize(pts_total_size, 1);
+			cache.elements.push_back(i);
+			cache.offsets.push_back(pts_total_size);
+			tet_total_size += element_cells.back().rows();
+			pts_total_size += cache.local_points.back().rows();
+		}
+		cache.offsets.push_back(pts_total_size);
 
-		Eigen::MatrixXd mapped, tmp;
-		int tet_index = 0, pts_index = 0;
+		cache.cells.resize(tet_total_size, mesh.is_volume() ? 4 : 3);
+		cache.el_id.resize(pts_total_size, 1);
+		cache.discr.resize(pts_total_size, 1);
 
-		for (size_t i = 0; i < current_bases.size(); ++i)
+		int tet_index = 0;
+		for (int k = 0; k < cache.elements.size(); ++k)
 		{
-			const auto &bs = current_bases[i];
+			const int i = cache.elements[k];
+			const int pts_index = cache.offsets[k];
+			const int n_pts = cache.local_points[k].rows();
 
-			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
-				continue;
+			cache.cells.block(tet_index, 0, element_cells[k].rows(), cache.cells.cols()) = element_cells[k].array() + pts_index;
+			tet_index += element_cells[k].rows();
 
-			if (mesh.is_simplex(i))
-			{
-				bs.eval_geom_mapping(sampler.simplex_points(), mapped);
+			cache.discr.block(pts_index, 0, n_pts, 1).setConstant(mesh.is_simplex(i) || mesh.is_cube(i) ? disc_orders(i) : -1);
+			cache.el_id.block(pts_index, 0, n_pts, 1).setConstant(i);
+		}
 
-				tets.block(tet_index, 0, sampler.simplex_volume().rows(), tets.cols()) = sampler.simplex_volume().array() + pts_index;
-				tet_index += sampler.simplex_volume().rows();
+		assert(tet_index == cache.cells.rows());
+		cache.valid = true;
+	}
 
-				points.block(pts_index, 0, mapped.rows(), points.cols()) = mapped;
-				discr.block(pts_index, 0, mapped.rows(), 1).setConstant(disc_orders(i));
-				el_id.block(pts_index, 0, mapped.rows(), 1).setConstant(i);
-				pts_index += mapped.rows();
-			}
-			else if (mesh.is_cube(i))
-			{
-				bs.eval_geom_mapping(sampler.cube_points(), mapped);
+	void OutGeometryData::build_vis_mesh(
+		const mesh::Mesh &mesh,
+		const Eigen::VectorXi &disc_orders,
+		const std::vector<basis::ElementBases> &gbases,
+		const std::map<int, Eigen::MatrixXd> &polys,
+		const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+		const bool boundary_only,
+		Eigen::MatrixXd &points,
+		Eigen::MatrixXi &tets,
+		Eigen::MatrixXi &el_id,
+		Eigen::MatrixXd &discr) const
+	{
+		if (!vis_mesh_cache.valid || vis_mesh_cache.boundary_only != boundary_only)
+			build_vis_mesh_cache(mesh, disc_orders, gbases, polys, polys_3d, boundary_only);
+		const VisMeshCache &cache = vis_mesh_cache;
 
-				tets.block(tet_index, 0, sampler.cube_volume().rows(), tets.cols()) = sampler.cube_volume().array() + pts_index;
-				tet_index += sampler.cube_volume().rows();
+		tets = cache.cells;
+		el_id = cache.el_id;
+		discr = cache.discr;
 
-				points.block(pts_index, 0, mapped.rows(), points.cols()) = mapped;
-				discr.block(pts_index, 0, mapped.rows(), 1).setConstant(disc_orders(i));
-				el_id.block(pts_index, 0, mapped.rows(), 1).setConstant(i);
-				pts_index += mapped.rows();
-			}
-			else
+		// only the geometric mapping is evaluated again, the vertices may have moved since the last export
+		points.resize(cache.offsets.back(), mesh.dimension());
+		utils::maybe_parallel_for(int(cache.elements.size()), [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd mapped;
+			for (int k = start; k < end; ++k)
 			{
-				if (mesh.is_volume())
-				{
-					sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, vis_pts_poly, vis_faces_poly, vis_edges_poly);
-					bs.eval_geom_mapping(vis_pts_poly, mapped);
-
-					tets.block(tet_index, 0, vis_faces_poly.rows(), tets.cols()) = vis_faces_poly.array() + pts_index;
-					tet_index += vis_faces_poly.rows();
-
-					points.block(pts_index, 0, mapped.rows(), points.cols()) = mapped;
-					discr.block(pts_index, 0, mapped.rows(), 1).setConstant(-1);
-					el_id.block(pts_index, 0, mapped.rows(), 1).setConstant(i);
-					pts_index += mapped.rows();
-				}
-				else
-				{
-					sampler.sample_polygon(polys.at(i), vis_pts_poly, vis_faces_poly, vis_edges_poly);
-					bs.eval_geom_mapping(vis_pts_poly, mapped);
-
-					tets.block(tet_index, 0, vis_faces_poly.rows(), tets.cols()) = vis_faces_poly.array() + pts_index;
-					tet_index += vis_faces_poly.rows();
-
-					points.block(pts_index, 0, mapped.rows(), points.cols()) = mapped;
-					discr.block(pts_index, 0, mapped.rows(), 1).setConstant(-1);
-					el_id.block(pts_index, 0, mapped.rows(), 1).setConstant(i);
-					pts_index += mapped.rows();
-				}
+				gbases[cache.elements[k]].eval_geom_mapping(cache.local_points[k], mapped);
+				points.middleRows(cache.offsets[k], mapped.rows()) = mapped;
 			}
-		}
-
-		assert(pts_index == points.rows());
-		assert(tet_index == tets.rows());
+		});
 	}
 
 	void OutGeometryData::build_high_order_vis_mesh(
@@ -1107,6 +1091,7 @@ namespace polyfem::io
 		reorder_output = args["output"]["data"]["advanced"]["reorder_nodes"];
 
 		use_hdf5 = args["output"]["paraview"]["options"]["use_hdf5"];
+		transient_hdf5 = solve_export_to_file && args["output"]["paraview"]["transient"]["enabled"];
 
 		this->solve_export_to_file = solve_export_to_file;
 	}
@@ -1120,7 +1105,8 @@ namespace polyfem::io
 		const double dt,
 		const ExportOptions &opts,
 		const bool is_contact_enabled,
-		std::vector<SolutionFrame> &solution_frames) const
+		std::vector<SolutionFrame> &solution_frames,
+		TransientHDF5Writer *transient_writer) const
 	{
 		if (!state.mesh)
 		{
@@ -1152,7 +1138,7 @@ namespace polyfem::io
 
 		if (opts.volume)
 		{
-			save_volume(base_path + opts.file_extension(), state, sol, pressure, t, dt, opts, solution_frames);
+			save_volume(base_path + opts.file_extension(), state, sol, pressure, t, dt, opts, solution_frames, transient_writer);
 		}
 
 		if (opts.surface)
@@ -1180,8 +1166,13 @@ namespace polyfem::io
 		if (!opts.solve_export_to_file)
 			return;
 
+		// The streamed volume is indexed by the xdmf of the transient writer
+		const bool has_volume = opts.volume && transient_writer == nullptr;
+		if (!has_volume && !opts.surface && !(is_contact_enabled && (opts.contact_forces || opts.friction_forces)) && !opts.wire && !opts.points)
+			return;
+
 		paraviewo::VTMWriter vtm(t);
-		if (opts.volume)
+		if (has_volume)
 			vtm.add_dataset("Volume", "data", path_stem + opts.file_extension());
 		if (opts.surface)
 			vtm.add_dataset("Surface", "data", path_stem + "_surf" + opts.file_extension());
@@ -1202,7 +1193,8 @@ namespace polyfem::io
 		const double t,
 		const double dt,
 		const ExportOptions &opts,
-		std::vector<SolutionFrame> &solution_frames) const
+		std::vector<SolutionFrame> &solution_frames,
+		TransientHDF5Writer *transient_writer) const
 	{
 		const Eigen::VectorXi &disc_orders = state.disc_orders;
 		const auto &density = state.mass_matrix_assembler->density();
@@ -1340,9 +1332,15 @@ namespace polyfem::io
 		else
 			tmpw = std::make_shared<paraviewo::VTUWriter>();
 		paraviewo::ParaviewWriter &writer = *tmpw;
+		const auto add_field = [&](const std::string &name, const Eigen::MatrixXd &data) {
+			if (transient_writer)
+				transient_writer->add_field(name, data);
+			else
+				add_field(name, data);
+		};
 
 		if (opts.solve_export_to_file && opts.nodes)
-			writer.add_field("nodes", node_fun);
+			add_field("nodes", node_fun);
 
 		if (problem.is_time_dependent())
 		{
@@ -1352,14 +1350,14 @@ namespace polyfem::io
 			{
 				const Eigen::VectorXd velocity =
 					is_time_integrator_valid ? (time_integrator->v_prev()) : Eigen::VectorXd::Zero(sol.size());
-				save_volume_vector_field(state, points, opts, "velocity", velocity, writer);
+				save_volume_vector_field(state, points, opts, "velocity", velocity, add_field);
 			}
 
 			if (opts.acceleration)
 			{
 				const Eigen::VectorXd acceleration =
 					is_time_integrator_valid ? (time_integrator->a_prev()) : Eigen::VectorXd::Zero(sol.size());
-				save_volume_vector_field(state, points, opts, "acceleration", acceleration, writer);
+				save_volume_vector_field(state, points, opts, "acceleration", acceleration, add_field);
 			}
 		}
 
@@ -1386,7 +1384,7 @@ namespace polyfem::io
 					force.setZero(sol.size());
 				}
 
-				save_volume_vector_field(state, points, opts, name + "_forces", force, writer);
+				save_volume_vector_field(state, points, opts, name + "_forces", force, add_field);
 			}
 		}
 
@@ -1406,7 +1404,7 @@ namespace polyfem::io
 			}
 
 			if (opts.solve_export_to_file)
-				writer.add_field("pressure", interp_p);
+				add_field("pressure", interp_p);
 			else
 				solution_frames.back().pressure = interp_p;
 		}
@@ -1418,14 +1416,14 @@ namespace polyfem::io
 		}
 
 		if (opts.solve_export_to_file && opts.discretization_order)
-			writer.add_field("discr", discr);
+			add_field("discr", discr);
 
 		if (problem.has_exact_sol())
 		{
 			if (opts.solve_export_to_file)
 			{
-				writer.add_field("exact", exact_fun);
-				writer.add_field("error", err);
+				add_field("exact", exact_fun);
+				add_field("error", err);
 			}
 			else
 			{
@@ -1451,7 +1449,7 @@ namespace polyfem::io
 				if (opts.solve_export_to_file)
 				{
 					for (const auto &[name, v] : vals)
-						writer.add_field(name, v);
+						add_field(name, v);
 				}
 				else if (vals.size() > 0)
 					solution_frames.back().scalar_value = vals[0].second;
@@ -1478,7 +1476,7 @@ namespace polyfem::io
 						assert(tmp.cols() == stride);
 
 						const int ii = (i / stride) + 1;
-						writer.add_field(fmt::format("{:s}_{:d}", name, ii), tmp);
+						add_field(fmt::format("{:s}_{:d}", name, ii), tmp);
 					}
 				}
 			}
@@ -1505,7 +1503,7 @@ namespace polyfem::io
 					if (opts.solve_export_to_file)
 					{
 						for (const auto &v : vals)
-							writer.add_field(fmt::format("{:s}_avg", v.first), v.second);
+							add_field(fmt::format("{:s}_avg", v.first), v.second);
 					}
 					else if (vals.size() > 0)
 						solution_frames.back().scalar_value_avg = vals[0].second;
@@ -1513,7 +1511,7 @@ namespace polyfem::io
 				// for(int i = 0; i < tvals.cols(); ++i){
 				// 	const int ii = (i / mesh.dimension()) + 1;
 				// 	const int jj = (i % mesh.dimension()) + 1;
-				// 	writer.add_field("tensor_value_avg_" + std::to_string(ii) + std::to_string(jj), tvals.col(i));
+				// 	add_field("tensor_value_avg_" + std::to_string(ii) + std::to_string(jj), tvals.col(i));
 				// }
 			}
 		}
@@ -1540,7 +1538,7 @@ namespace polyfem::io
 				if (opts.use_sampler)
 				{
 					if (mesh.is_simplex(e))
-						local_pts = sampler.simplex_points();
+						local_pts = sampler.simplex_points(e);
 					else if (mesh.is_cube(e))
 						local_pts = sampler.cube_points();
 					else
@@ -1610,8 +1608,8 @@ namespace polyfem::io
 				rhos.bottomRows(obstacle.n_vertices()).setZero();
 			}
 			for (const auto &[p, tmp] : param_val)
-				writer.add_field(p, tmp);
-			writer.add_field("rho", rhos);
+				add_field(p, tmp);
+			add_field("rho", rhos);
 		}
 
 		if (opts.body_ids)
@@ -1630,7 +1628,7 @@ namespace polyfem::io
 				ids.bottomRows(obstacle.n_vertices()).setZero();
 			}
 
-			writer.add_field("body_ids", ids);
+			add_field("body_ids", ids);
 		}
 
 		// interpolate_function(pts_index, rhs, fun, opts.boundary_only);
@@ -1652,7 +1650,7 @@ namespace polyfem::io
 				traction_forces_fun.bottomRows(obstacle.n_vertices()).setZero();
 			}
 
-			writer.add_field("traction_force", traction_forces_fun);
+			add_field("traction_force", traction_forces_fun);
 		}
 
 		if (fun.cols() != 1 && state.mixed_assembler == nullptr)
@@ -1673,7 +1671,7 @@ namespace polyfem::io
 					potential_grad_fun.bottomRows(obstacle.n_vertices()).setZero();
 				}
 
-				writer.add_field("gradient_of_potential", potential_grad_fun);
+				add_field("gradient_of_potential", potential_grad_fun);
 			}
 			catch (std::exception &)
 			{
@@ -1682,7 +1680,7 @@ namespace polyfem::io
 
 		// Write the solution last so it is the default for warp-by-vector
 		if (opts.solve_export_to_file)
-			writer.add_field("solution", fun);
+			add_field("solution", fun);
 		else
 			solution_frames.back().solution = fun;
 
@@ -1725,7 +1723,14 @@ namespace polyfem::io
 				}
 			}
 
-			if (elements.empty())
+			if (transient_writer)
+			{
+				if (elements.empty())
+					transient_writer->write_step(t, points, tets);
+				else
+					transient_writer->write_step(t, points, elements);
+			}
+			else if (elements.empty())
 				writer.write_mesh(path, points, tets);
 			else
 				writer.write_mesh(path, points, elements, true, disc_orders.maxCoeff() == 1);
@@ -1744,7 +1749,7 @@ namespace polyfem::io
 		const ExportOptions &opts,
 		const std::string &name,
 		const Eigen::VectorXd &field,
-		paraviewo::ParaviewWriter &writer) const
+		const std::function<void(const std::string &, const Eigen::MatrixXd &)> &add_field) const
 	{
 		Eigen::MatrixXd inerpolated_field;
 		Evaluator::interpolate_function(
@@ -1762,7 +1767,7 @@ namespace polyfem::io
 
 		if (opts.solve_export_to_file)
 		{
-			writer.add_field(name, inerpolated_field);
+			add_field(name, inerpolated_field);
 		}
 		// TODO: else save to solution frames
 	}
@@ -2090,9 +2095,9 @@ namespace polyfem::io
 
 			if (mesh.is_simplex(i))
 			{
-				pts_total_size += sampler.simplex_points().rows();
-				seg_total_size += sampler.simplex_edges().rows();
-				faces_total_size += sampler.simplex_faces().rows();
+				pts_total_size += sampler.simplex_points(i).rows();
+				seg_total_size += sampler.simplex_edges(i).rows();
+				faces_total_size += sampler.simplex_faces(i).rows();
 			}
 			else if (mesh.is_cube(i))
 			{
@@ -2126,12 +2131,12 @@ namespace polyfem::io
 
 			if (mesh.is_simplex(i))
 			{
-				bs.eval_geom_mapping(sampler.simplex_points(), mapped);
-				edges.block(seg_index, 0, sampler.simplex_edges().rows(), edges.cols()) = sampler.simplex_edges().array() + pts_index;
-				seg_index += sampler.simplex_edges().rows();
+				bs.eval_geom_mapping(sampler.simplex_points(i), mapped);
+				edges.block(seg_index, 0, sampler.simplex_edges(i).rows(), edges.cols()) = sampler.simplex_edges(i).array() + pts_index;
+				seg_index += sampler.simplex_edges(i).rows();
 
-				faces.block(face_index, 0, sampler.simplex_faces().rows(), 3) = sampler.simplex_faces().array() + pts_index;
-				face_index += sampler.simplex_faces().rows();
+				faces.block(face_index, 0, sampler.simplex_faces(i).rows(), 3) = sampler.simplex_faces(i).array() + pts_index;
+				face_index += sampler.simplex_faces(i).rows();
 
 				points.block(pts_index, 0, mapped.rows(), points.cols()) = mapped;
 				pts_index += mapped.rows();
@@ -2312,9 +2317,96 @@ namespace polyfem::io
 		paraviewo::PVDWriter::save_pvd(name, vtu_names, time_steps, t0, dt, skip_frame);
 	}
 
+	void OutGeometryData::save_pvd(
+		const std::string &name,
+		const std::function<std::string(int)> &vtu_names,
+		const std::vector<double> &times, int skip_frame) const
+	{
+		std::ofstream os(name);
+		if (!os.good())
+		{
+			logger().error("Unable to write the pvd {}", name);
+			return;
+		}
+
+		os << "<?xml version=\"1.0\"?>\n";
+		os << "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"LittleEndian\" compressor=\"vtkZLibDataCompressor\">\n";
+		os << "\t<Collection>\n";
+		for (int i = 0; i < times.size(); i += skip_frame)
+			os << fmt::format("\t\t<DataSet timestep=\"{:.17g}\" group=\"\" part=\"0\" file=\"{}\"/>\n", times[i], vtu_names(i));
+		os << "\t</Collection>\n";
+		os << "</VTKFile>\n";
+	}
+
 	void OutGeometryData::init_sampler(const polyfem::mesh::Mesh &mesh, const double vismesh_rel_area)
 	{
 		ref_element_sampler.init(mesh.is_volume(), mesh.n_elements(), vismesh_rel_area);
+		reset_vis_cache();
+	}
+
+	void OutGeometryData::init_element_sampling(
+		const mesh::Mesh &mesh,
+		const Eigen::VectorXi &disc_orders,
+		const std::vector<basis::ElementBases> &gbases,
+		const bool adaptive)
+	{
+		using Sampling = utils::RefElementSampler::Sampling;
+
+		reset_vis_cache();
+		if (!adaptive)
+		{
+			ref_element_sampler.clear_element_sampling();
+			return;
+		}
+
+		const int n_corners = mesh.dimension() + 1;
+		const Eigen::MatrixXd &corners = ref_element_sampler.simplex_corners();
+
+		// the sampling points, with the edge midpoints and the centroid in case the sampling only has the corners
+		const Eigen::MatrixXd &samples = ref_element_sampler.simplex_points();
+		Eigen::MatrixXd pts(samples.rows() + n_corners * (n_corners - 1) / 2 + 1, samples.cols());
+		pts.topRows(samples.rows()) = samples;
+		int index = samples.rows();
+		for (int i = 0; i < n_corners; ++i)
+			for (int j = i + 1; j < n_corners; ++j)
+				pts.row(index++) = (corners.row(i) + corners.row(j)) / 2;
+		pts.row(index) = corners.colwise().mean();
+
+		std::vector<Sampling> sampling(gbases.size(), Sampling::UNIFORM);
+		utils::maybe_parallel_for(int(gbases.size()), [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd mapped_corners, mapped;
+			for (int e = start; e < end; ++e)
+			{
+				if (!mesh.is_simplex(e))
+					continue;
+
+				bool is_affine = int(gbases[e].bases.size()) == n_corners;
+				if (!is_affine)
+				{
+					// compare the mapping with the affine map through the mapped corners
+					gbases[e].eval_geom_mapping(corners, mapped_corners);
+					gbases[e].eval_geom_mapping(pts, mapped);
+
+					const Eigen::MatrixXd edges = mapped_corners.bottomRows(n_corners - 1).rowwise() - mapped_corners.row(0);
+					const Eigen::MatrixXd affine = (pts * edges).rowwise() + mapped_corners.row(0);
+					const double size = edges.rowwise().norm().maxCoeff();
+					is_affine = (mapped - affine).rowwise().norm().maxCoeff() <= CURVED_SIMPLEX_TOLERANCE * size;
+				}
+
+				if (!is_affine)
+					sampling[e] = Sampling::CURVED;
+				else if (disc_orders(e) == 1)
+					sampling[e] = Sampling::LINEAR;
+			}
+		});
+
+		ref_element_sampler.set_element_sampling(sampling);
+	}
+
+	void OutGeometryData::reset_vis_cache()
+	{
+		vis_mesh_cache = VisMeshCache();
+		vis_boundary_cache = VisBoundaryCache();
 	}
 
 	void OutGeometryData::build_grid(const polyfem::mesh::Mesh &mesh, const double spacing)
@@ -2357,67 +2449,17 @@ namespace polyfem::io
 
 		assert(index == n);
 
-		std::vector<std::array<Eigen::Vector3d, 2>> boxes;
-		mesh.elements_boxes(boxes);
-
-		SimpleBVH::BVH bvh;
-		bvh.init(boxes);
-
-		const double eps = 1e-6;
-
-		grid_points_to_elements.resize(grid_points.rows(), 1);
-		grid_points_to_elements.setConstant(-1);
-
-		grid_points_bc.resize(grid_points.rows(), mesh.is_volume() ? 4 : 3);
-
-		for (int i = 0; i < grid_points.rows(); ++i)
-		{
-			const Eigen::Vector3d min(
-				grid_points(i, 0) - eps,
-				grid_points(i, 1) - eps,
-				(mesh.is_volume() ? grid_points(i, 2) : 0) - eps);
-
-			const Eigen::Vector3d max(
-				grid_points(i, 0) + eps,
-				grid_points(i, 1) + eps,
-				(mesh.is_volume() ? grid_points(i, 2) : 0) + eps);
-
-			std::vector<unsigned int> candidates;
-
-			bvh.intersect_box(min, max, candidates);
-
-			for (const auto cand : candidates)
-			{
-				if (!mesh.is_simplex(cand))
-				{
-					logger().warn("Element {} is not simplex, skipping", cand);
-					continue;
-				}
-
-				Eigen::MatrixXd coords;
-				mesh.barycentric_coords(grid_points.row(i), cand, coords);
-
-				for (int d = 0; d < coords.size(); ++d)
-				{
-					if (fabs(coords(d)) < 1e-8)
-						coords(d) = 0;
-					else if (fabs(coords(d) - 1) < 1e-8)
-						coords(d) = 1;
-				}
+		if (!mesh.is_simplicial())
+			logger().warn("Only the simplices are located in the grid, other elements are skipped");
 
-				if (coords.array().minCoeff() >= 0 && coords.array().maxCoeff() <= 1)
-				{
-					grid_points_to_elements(i) = cand;
-					grid_points_bc.row(i) = coords;
-					break;
-				}
-			}
-		}
+		Eigen::VectorXi element_ids;
+		mesh.locate_points(grid_points, element_ids, grid_points_bc);
+		grid_points_to_elements = element_ids;
 	}
 
 	void OutStatsData::compute_mesh_size(const polyfem::mesh::Mesh &mesh_in, const std::vector<polyfem::basis::ElementBases> &bases_in, const int n_samples, const bool use_curved_mesh_size)
 	{
-		Eigen::MatrixXd samples_simplex, samples_cube, mapped, p0, p1, p;
+		Eigen::MatrixXd samples_simplex, samples_cube, p0, p1, p;
 
 		mesh_size = 0;
 		average_edge_length = 0;
@@ -2449,41 +2491,79 @@ namespace polyfem::io
 			utils::EdgeSampler::sample_2d_cube(n_samples, samples_cube);
 		}
 
-		int n = 0;
-		for (size_t i = 0; i < bases_in.size(); ++i)
+		// the edges of elements with a linear geometric mapping are straight, their endpoints are enough
+		const int n_simplex_edges = mesh_in.is_volume() ? 6 : 3;
+		const int n_cube_edges = mesh_in.is_volume() ? 12 : 4;
+		Eigen::MatrixXd endpoints_simplex(2 * n_simplex_edges, samples_simplex.cols());
+		Eigen::MatrixXd endpoints_cube(2 * n_cube_edges, samples_cube.cols());
+		for (int j = 0; j < n_simplex_edges; ++j)
 		{
-			if (mesh_in.is_polytope(i))
-				continue;
-			int n_edges;
+			endpoints_simplex.row(2 * j) = samples_simplex.row(j * n_samples);
+			endpoints_simplex.row(2 * j + 1) = samples_simplex.row(j * n_samples + n_samples - 1);
+		}
+		for (int j = 0; j < n_cube_edges; ++j)
+		{
+			endpoints_cube.row(2 * j) = samples_cube.row(j * n_samples);
+			endpoints_cube.row(2 * j + 1) = samples_cube.row(j * n_samples + n_samples - 1);
+		}
+		const int n_simplex_vertices = mesh_in.dimension() + 1;
+		const int n_cube_vertices = mesh_in.is_volume() ? 8 : 4;
 
-			if (mesh_in.is_simplex(i))
-			{
-				n_edges = mesh_in.is_volume() ? 6 : 3;
-				bases_in[i].eval_geom_mapping(samples_simplex, mapped);
-			}
-			else
-			{
-				n_edges = mesh_in.is_volume() ? 12 : 4;
-				bases_in[i].eval_geom_mapping(samples_cube, mapped);
-			}
+		struct LocalThreadStorage
+		{
+			Eigen::MatrixXd mapped;
+			double max_edge = 0;
+			double min_edge = std::numeric_limits<double>::max();
+			double sum_edges = 0;
+			int n = 0;
+		};
+
+		auto storage = utils::create_thread_storage(LocalThreadStorage());
 
-			for (int j = 0; j < n_edges; ++j)
+		utils::maybe_parallel_for(int(bases_in.size()), [&](int start, int end, int thread_id) {
+			LocalThreadStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			Eigen::MatrixXd &mapped = local_storage.mapped;
+
+			for (int i = start; i < end; ++i)
 			{
-				double current_edge = 0;
-				for (int k = 0; k < n_samples - 1; ++k)
+				if (mesh_in.is_polytope(i))
+					continue;
+
+				const bool is_simplex = mesh_in.is_simplex(i);
+				const int n_edges = is_simplex ? n_simplex_edges : n_cube_edges;
+				const bool is_linear = int(bases_in[i].bases.size()) == (is_simplex ? n_simplex_vertices : n_cube_vertices);
+
+				if (is_linear)
+					bases_in[i].eval_geom_mapping(is_simplex ? endpoints_simplex : endpoints_cube, mapped);
+				else
+					bases_in[i].eval_geom_mapping(is_simplex ? samples_simplex : samples_cube, mapped);
+
+				for (int j = 0; j < n_edges; ++j)
 				{
-					p0 = mapped.row(j * n_samples + k);
-					p1 = mapped.row(j * n_samples + k + 1);
-					p = p0 - p1;
+					double current_edge = 0;
+					if (is_linear)
+						current_edge = (mapped.row(2 * j) - mapped.row(2 * j + 1)).norm();
+					else
+					{
+						for (int k = 0; k < n_samples - 1; ++k)
+							current_edge += (mapped.row(j * n_samples + k) - mapped.row(j * n_samples + k + 1)).norm();
+					}
 
-					current_edge += p.norm();
+					local_storage.max_edge = std::max(current_edge, local_storage.max_edge);
+					local_storage.min_edge = std::min(current_edge, local_storage.min_edge);
+					local_storage.sum_edges += current_edge;
+					++local_storage.n;
 				}
-
-				mesh_size = std::max(current_edge, mesh_size);
-				min_edge_length = std::min(current_edge, min_edge_length);
-				average_edge_length += current_edge;
-				++n;
 			}
+		});
+
+		int n = 0;
+		for (const LocalThreadStorage &local_storage : storage)
+		{
+			mesh_size = std::max(mesh_size, local_storage.max_edge);
+			min_edge_length = std::min(min_edge_length, local_storage.min_edge);
+			average_edge_length += local_storage.sum_edges;
+			n += local_storage.n;
 		}
 
 		average_edge_length /= n;
@@ -2509,14 +2589,19 @@ namespace polyfem::io
 		logger().info("Counting flipped elements...");
 		const auto &els_tag = mesh.elements_tag();
 
-		// flipped_elements.clear();
+		std::vector<char> flipped(gbases.size(), false);
+		utils::maybe_parallel_for(int(gbases.size()), [&](int start, int end, int thread_id) {
+			polyfem::assembler::ElementAssemblyValues vals;
+			for (int i = start; i < end; ++i)
+			{
+				if (!mesh.is_polytope(i))
+					flipped[i] = !vals.is_geom_mapping_positive(mesh.is_volume(), gbases[i]);
+			}
+		});
+
 		for (size_t i = 0; i < gbases.size(); ++i)
 		{
-			if (mesh.is_polytope(i))
-				continue;
-
-			polyfem::assembler::ElementAssemblyValues vals;
-			if (!vals.is_geom_mapping_positive(mesh.is_volume(), gbases[i]))
+			if (flipped[i])
 			{
 				++n_flipped;
 
@@ -2551,6 +2636,7 @@ namespace polyfem::io
 		const int n_bases,
 		const std::vector<polyfem::basis::ElementBases> &bases,
 		const std::vector<polyfem::basis::ElementBases> &gbases,
+		const assembler::AssemblyValsCache &ass_vals_cache,
 		const polyfem::mesh::Mesh &mesh,
 		const assembler::Problem &problem,
 		const double tend,
@@ -2578,106 +2664,91 @@ namespace polyfem::io
 
 		const int n_el = int(bases.size());
 
-		Eigen::MatrixXd v_exact, v_approx;
-		Eigen::MatrixXd v_exact_grad(0, 0), v_approx_grad;
-
-		l2_err = 0;
-		h1_err = 0;
-		grad_max_err = 0;
-		h1_semi_err = 0;
-		linf_err = 0;
-		lp_err = 0;
-		// double pred_norm = 0;
-
 		static const int p = 8;
 
-		// Eigen::MatrixXd err_per_el(n_el, 5);
-		polyfem::assembler::ElementAssemblyValues vals;
-
-		for (int e = 0; e < n_el; ++e)
+		struct LocalThreadStorage
 		{
-			vals.compute(e, mesh.is_volume(), bases[e], gbases[e]);
-
-			if (problem.has_exact_sol())
-			{
-				problem.exact(vals.val, tend, v_exact);
-				problem.exact_grad(vals.val, tend, v_exact_grad);
-			}
+			polyfem::assembler::ElementAssemblyValues vals;
+			Eigen::MatrixXd v_exact, v_approx;
+			Eigen::MatrixXd v_exact_grad, v_approx_grad;
 
-			v_approx.resize(vals.val.rows(), actual_dim);
-			v_approx.setZero();
+			double l2_err = 0;
+			double h1_err = 0;
+			double lp_err = 0;
+			double linf_err = 0;
+			double grad_max_err = 0;
+		};
 
-			v_approx_grad.resize(vals.val.rows(), mesh.dimension() * actual_dim);
-			v_approx_grad.setZero();
+		auto storage = utils::create_thread_storage(LocalThreadStorage());
 
-			const int n_loc_bases = int(vals.basis_values.size());
+		utils::maybe_parallel_for(n_el, [&](int start, int end, int thread_id) {
+			LocalThreadStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			polyfem::assembler::ElementAssemblyValues &vals = local_storage.vals;
+			Eigen::MatrixXd &v_exact = local_storage.v_exact;
+			Eigen::MatrixXd &v_approx = local_storage.v_approx;
+			Eigen::MatrixXd &v_exact_grad = local_storage.v_exact_grad;
+			Eigen::MatrixXd &v_approx_grad = local_storage.v_approx_grad;
 
-			for (int i = 0; i < n_loc_bases; ++i)
+			for (int e = start; e < end; ++e)
 			{
-				const auto &val = vals.basis_values[i];
+				ass_vals_cache.compute(e, mesh.is_volume(), bases[e], gbases[e], vals);
 
-				for (size_t ii = 0; ii < val.global.size(); ++ii)
+				if (problem.has_exact_sol())
 				{
-					for (int d = 0; d < actual_dim; ++d)
-					{
-						v_approx.col(d) += val.global[ii].val * sol(val.global[ii].index * actual_dim + d) * val.val;
-						v_approx_grad.block(0, d * val.grad_t_m.cols(), v_approx_grad.rows(), val.grad_t_m.cols()) += val.global[ii].val * sol(val.global[ii].index * actual_dim + d) * val.grad_t_m;
-					}
+					// the gradient evaluation tabulates the values as well
+					problem.exact_grad(vals.val, tend, v_exact_grad);
+					problem.exact(vals.val, tend, v_exact);
 				}
-			}
-
-			const auto err = problem.has_exact_sol() ? (v_exact - v_approx).eval().rowwise().norm().eval() : (v_approx).eval().rowwise().norm().eval();
-			const auto err_grad = problem.has_exact_sol() ? (v_exact_grad - v_approx_grad).eval().rowwise().norm().eval() : (v_approx_grad).eval().rowwise().norm().eval();
 
-			// for(long i = 0; i < err.size(); ++i)
-			// errors.push_back(err(i));
+				v_approx.resize(vals.val.rows(), actual_dim);
+				v_approx.setZero();
 
-			linf_err = std::max(linf_err, err.maxCoeff());
-			grad_max_err = std::max(linf_err, err_grad.maxCoeff());
+				v_approx_grad.resize(vals.val.rows(), mesh.dimension() * actual_dim);
+				v_approx_grad.setZero();
 
-			// {
-			// 	const auto &mesh3d = *dynamic_cast<Mesh3D *>(mesh.get());
-			// 	const auto v0 = mesh3d.point(mesh3d.cell_vertex(e, 0));
-			// 	const auto v1 = mesh3d.point(mesh3d.cell_vertex(e, 1));
-			// 	const auto v2 = mesh3d.point(mesh3d.cell_vertex(e, 2));
-			// 	const auto v3 = mesh3d.point(mesh3d.cell_vertex(e, 3));
+				const int n_loc_bases = int(vals.basis_values.size());
 
-			// 	Eigen::Matrix<double, 6, 3> ee;
-			// 	ee.row(0) = v0 - v1;
-			// 	ee.row(1) = v1 - v2;
-			// 	ee.row(2) = v2 - v0;
-
-			// 	ee.row(3) = v0 - v3;
-			// 	ee.row(4) = v1 - v3;
-			// 	ee.row(5) = v2 - v3;
+				for (int i = 0; i < n_loc_bases; ++i)
+				{
+					const auto &val = vals.basis_values[i];
 
-			// 	Eigen::Matrix<double, 6, 1> en = ee.rowwise().norm();
+					for (size_t ii = 0; ii < val.global.size(); ++ii)
+					{
+						for (int d = 0; d < actual_dim; ++d)
+						{
+							v_approx.col(d) += val.global[ii].val * sol(val.global[ii].index * actual_dim + d) * val.val;
+							v_approx_grad.block(0, d * val.grad_t_m.cols(), v_approx_grad.rows(), val.grad_t_m.cols()) += val.global[ii].val * sol(val.global[ii].index * actual_dim + d) * val.grad_t_m;
+						}
+					}
+				}
 
-			// 	// Eigen::Matrix<double, 3*4, 1> alpha;
-			// 	// alpha(0) = angle3(e.row(0), -e.row(1));	 	alpha(1) = angle3(e.row(1), -e.row(2));	 	alpha(2) = angle3(e.row(2), -e.row(0));
-			// 	// alpha(3) = angle3(e.row(0), -e.row(4));	 	alpha(4) = angle3(e.row(4), e.row(3));	 	alpha(5) = angle3(-e.row(3), -e.row(0));
-			// 	// alpha(6) = angle3(-e.row(4), -e.row(1));	alpha(7) = angle3(e.row(1), -e.row(5));	 	alpha(8) = angle3(e.row(5), e.row(4));
-			// 	// alpha(9) = angle3(-e.row(2), -e.row(5));	alpha(10) = angle3(e.row(5), e.row(3));		alpha(11) = angle3(-e.row(3), e.row(2));
+				const Eigen::VectorXd err = problem.has_exact_sol() ? (v_exact - v_approx).rowwise().norm().eval() : v_approx.rowwise().norm().eval();
+				const Eigen::VectorXd err_grad = problem.has_exact_sol() ? (v_exact_grad - v_approx_grad).rowwise().norm().eval() : v_approx_grad.rowwise().norm().eval();
+				const Eigen::ArrayXd da = vals.det.array() * vals.quadrature.weights.array();
 
-			// 	const double S = (ee.row(0).cross(ee.row(1)).norm() + ee.row(0).cross(ee.row(4)).norm() + ee.row(4).cross(ee.row(1)).norm() + ee.row(2).cross(ee.row(5)).norm()) / 2;
-			// 	const double V = std::abs(ee.row(3).dot(ee.row(2).cross(-ee.row(0))))/6;
-			// 	const double rho = 3 * V / S;
-			// 	const double hp = en.maxCoeff();
-			// 	const int pp = disc_orders(e);
-			// 	const int p_ref = args["space"]["discr_order"];
+				local_storage.linf_err = std::max(local_storage.linf_err, err.maxCoeff());
+				local_storage.grad_max_err = std::max(local_storage.grad_max_err, err_grad.maxCoeff());
 
-			// 	err_per_el(e, 0) = err.mean();
-			// 	err_per_el(e, 1) = err.maxCoeff();
-			// 	err_per_el(e, 2) = std::pow(hp, pp+1)/(rho/hp); // /std::pow(average_edge_length, p_ref+1) * (sqrt(6)/12);
-			// 	err_per_el(e, 3) = rho/hp;
-			// 	err_per_el(e, 4) = (vals.det.array() * vals.quadrature.weights.array()).sum();
+				local_storage.l2_err += (err.array() * err.array() * da).sum();
+				local_storage.h1_err += (err_grad.array() * err_grad.array() * da).sum();
+				local_storage.lp_err += (err.array().pow(p) * da).sum();
+			}
+		});
 
-			// 	// pred_norm += (pow(std::pow(hp, pp+1)/(rho/hp),p) * vals.det.array() * vals.quadrature.weights.array()).sum();
-			// }
+		l2_err = 0;
+		h1_err = 0;
+		grad_max_err = 0;
+		h1_semi_err = 0;
+		linf_err = 0;
+		lp_err = 0;
 
-			l2_err += (err.array() * err.array() * vals.det.array() * vals.quadrature.weights.array()).sum();
-			h1_err += (err_grad.array() * err_grad.array() * vals.det.array() * vals.quadrature.weights.array()).sum();
-			lp_err += (err.array().pow(p) * vals.det.array() * vals.quadrature.weights.array()).sum();
+		for (const LocalThreadStorage &local_storage : storage)
+		{
+			l2_err += local_storage.l2_err;
+			h1_err += local_storage.h1_err;
+			lp_err += local_storage.lp_err;
+			linf_err = std::max(linf_err, local_storage.linf_err);
+			grad_max_err = std::max(grad_max_err, local_storage.grad_max_err);
 		}
 
 		h1_semi_err = sqrt(fabs(h1_err));
@@ -2686,8 +2757,6 @@ namespace polyfem::io
 
 		lp_err = pow(fabs(lp_err), 1. / p);
 
-		// pred_norm = pow(fabs(pred_norm), 1./p);
-
 		timer.stop();
 		const double computing_errors_time = timer.getElapsedTime();
 		logger().info(" took {}s", computing_errors_time);
@@ -2696,7 +2765,6 @@ namespace polyfem::io
 		logger().info("-- Lp error: {}", lp_err);
 		logger().info("-- H1 error: {}", h1_err);
 		logger().info("-- H1 semi error: {}", h1_semi_err);
-		// logger().info("-- Perd norm: {}", pred_norm);
 
 		logger().info("-- Linf error: {}", linf_err);
 		logger().info("-- grad max error: {}", grad_max_err);
@@ -2725,42 +2793,55 @@ namespace polyfem::io
 
 		const auto &els_tag = mesh.elements_tag();
 
-		for (size_t i = 0; i < els_tag.size(); ++i)
-		{
-			const ElementType type = els_tag[i];
+		constexpr int n_types = static_cast<int>(ElementType::UNDEFINED) + 1;
+		auto storage = utils::create_thread_storage(std::array<int, n_types>{});
 
-			switch (type)
+		utils::maybe_parallel_for(int(els_tag.size()), [&](int start, int end, int thread_id) {
+			std::array<int, n_types> &local_counts = utils::get_local_thread_storage(storage, thread_id);
+			for (int i = start; i < end; ++i)
+				++local_counts[static_cast<int>(els_tag[i])];
+		});
+
+		std::array<int, n_types> counts{};
+		for (const auto &local_counts : storage)
+			for (int t = 0; t < n_types; ++t)
+				counts[t] += local_counts[t];
+
+		for (int t = 0; t < n_types; ++t)
+		{
+			const int count = counts[t];
+			switch (static_cast<ElementType>(t))
 			{
 			case ElementType::SIMPLEX:
-				simplex_count++;
+				simplex_count += count;
 				break;
 			case ElementType::REGULAR_INTERIOR_CUBE:
-				regular_count++;
+				regular_count += count;
 				break;
 			case ElementType::REGULAR_BOUNDARY_CUBE:
-				regular_boundary_count++;
+				regular_boundary_count += count;
 				break;
 			case ElementType::SIMPLE_SINGULAR_INTERIOR_CUBE:
-				simple_singular_count++;
+				simple_singular_count += count;
 				break;
 			case ElementType::MULTI_SINGULAR_INTERIOR_CUBE:
-				multi_singular_count++;
+				multi_singular_count += count;
 				break;
 			case ElementType::SIMPLE_SINGULAR_BOUNDARY_CUBE:
-				boundary_count++;
+				boundary_count += count;
 				break;
 			case ElementType::INTERFACE_CUBE:
 			case ElementType::MULTI_SINGULAR_BOUNDARY_CUBE:
-				multi_singular_boundary_count++;
+				multi_singular_boundary_count += count;
 				break;
 			case ElementType::BOUNDARY_POLYTOPE:
-				non_regular_boundary_count++;
+				non_regular_boundary_count += count;
 				break;
 			case ElementType::INTERIOR_POLYTOPE:
-				non_regular_count++;
+				non_regular_count += count;
 				break;
 			case ElementType::UNDEFINED:
-				undefined_count++;
+				undefined_count += count;
 				break;
 			default:
 				throw std::runtime_error("Unknown element type");
@@ -2846,6 +2927,14 @@ namespace polyfem::io
 		j["time_assembling_mass_mat"] = runtime.assembling_mass_mat_time;
 		j["time_assigning_rhs"] = runtime.assigning_rhs_time;
 		j["time_solving"] = runtime.solving_time;
+		j["time_ccd_broad_phase"] = runtime.ccd_broad_phase_time;
+		j["time_ccd_narrow_phase"] = runtime.ccd_narrow_phase_time;
+		j["time_ccd"] = runtime.ccd_time;
+		j["ccd_broad_phase_method"] = runtime.ccd_broad_phase_method;
+		j["ccd_broad_phase_selections"] = runtime.ccd_broad_phase_selections;
+
+		if (utils::Profiler::instance().enabled())
+			j["profile"] = utils::Profiler::instance().to_json();
 		// j["time_computing_errors"] = runtime.computing_errors_time;
 
 		j["solver_info"] = solver_info;
@@ -2864,6 +2953,8 @@ namespace polyfem::io
 		j["is_simplicial"] = mesh.n_elements() == simplex_count;
 
 		j["peak_memory"] = getPeakRSS() / (1024 * 1024);
+		if (!memory.empty())
+			j["memory"] = memory.to_json();
 
 		const int actual_dim = problem.is_scalar() ? 1 : mesh.dimension();
 
@@ -2935,14 +3026,40 @@ namespace polyfem::io
 		const double s = solve_data.time_integrator
 							 ? solve_data.time_integrator->acceleration_scaling()
 							 : 1;
+
+		// Values of the last energy evaluation, if the solver stopped at sol, instead of evaluating the forms again
+		const std::vector<std::shared_ptr<solver::Form>> &nl_forms = solve_data.nl_problem->forms();
+		const std::vector<double> *form_values = solve_data.nl_problem->cached_form_values(sol);
+
 		file << i << ",";
 		for (const auto &[_, form] : solve_data.named_forms())
 		{
+			double value = 0;
+			if (form && form->enabled())
+			{
+				const auto it = std::find(nl_forms.begin(), nl_forms.end(), form);
+				value = (form_values && it != nl_forms.end()) ? (*form_values)[it - nl_forms.begin()] : form->value(sol);
+			}
 			// Divide by acceleration scaling to get the energy (units of J)
-			file << ((form && form->enabled()) ? form->value(sol) : 0) / s << ",";
+			file << value / s << ",";
+		}
+
+		double total_energy = 0;
+		if (form_values)
+		{
+			for (const double v : *form_values)
+				total_energy += v;
+		}
+		else
+			total_energy = solve_data.nl_problem->value(sol);
+		file << total_energy / s << "\n";
+
+		// the rows are buffered, flushed every few steps and when the writer is destroyed
+		if (++rows_since_flush >= FLUSH_INTERVAL)
+		{
+			file.flush();
+			rows_since_flush = 0;
 		}
-		file << solve_data.nl_problem->value(sol) / s << "\n";
-		file.flush();
 	}
 
 	RuntimeStatsCSVWriter::RuntimeStatsCSVWriter(const std::string &path, const State &state, const double t0, const double dt)
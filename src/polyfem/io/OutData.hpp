@@ -14,6 +14,9 @@
 #include <paraviewo/VTUWriter.hpp>
 #include <paraviewo/HDF5VTUWriter.hpp>
 
+#include <polyfem/io/TransientHDF5Writer.hpp>
+
+#include <polyfem/utils/MemoryUsage.hpp>
 #include <polyfem/utils/RefElementSampler.hpp>
 
 #include <Eigen/Dense>
@@ -74,6 +77,9 @@ namespace polyfem::io
 
 			bool use_hdf5;
 
+			/// stream the volume of time steps into a single hdf5 file, see TransientHDF5Writer
+			bool transient_hdf5;
+
 			/// @brief initialize the flags based on the input args
 			/// @param[in] args input arguments used to set most of the flags
 			/// @param[in] is_mesh_linear if the mesh is linear
@@ -113,6 +119,20 @@ namespace polyfem::io
 		/// @param[in] vismesh_rel_area relative sampling size
 		void init_sampler(const polyfem::mesh::Mesh &mesh, const double vismesh_rel_area);
 
+		/// @brief chooses the sampling of every simplex: only its corners for linear affine elements, a finer one for curved elements
+		/// @param[in] mesh mesh
+		/// @param[in] disc_orders per element discretization order
+		/// @param[in] gbases geometric bases
+		/// @param[in] adaptive if false, all elements use the uniform sampling
+		void init_element_sampling(
+			const mesh::Mesh &mesh,
+			const Eigen::VectorXi &disc_orders,
+			const std::vector<basis::ElementBases> &gbases,
+			const bool adaptive);
+
+		/// @brief drops the cached visualization meshes, to call when the mesh or the bases change
+		void reset_vis_cache();
+
 		/// @brief builds the grid to export the solution
 		/// @param[in] mesh mesh
 		/// @param[in] spacing grid spacing, <=0 mean no grid
@@ -159,6 +179,7 @@ namespace polyfem::io
 		/// @param[in] opts export options
 		/// @param[in] is_contact_enabled if contact is enabled
 		/// @param[out] solution_frames saves the output here instead of vtu
+		/// @param[out] transient_writer if not null, the volume is streamed in it instead of saved in a vtu
 		void save_vtu(const std::string &path,
 					  const State &state,
 					  const Eigen::MatrixXd &sol,
@@ -167,7 +188,8 @@ namespace polyfem::io
 					  const double dt,
 					  const ExportOptions &opts,
 					  const bool is_contact_enabled,
-					  std::vector<SolutionFrame> &solution_frames) const;
+					  std::vector<SolutionFrame> &solution_frames,
+					  TransientHDF5Writer *transient_writer = nullptr) const;
 
 		/// saves the volume vtu file
 		/// @param[in] path filename
@@ -178,6 +200,7 @@ namespace polyfem::io
 		/// @param[in] dt delta t
 		/// @param[in] opts export options
 		/// @param[out] solution_frames saves the output here instead of vtu
+		/// @param[out] transient_writer if not null, the volume is streamed in it instead of saved in a vtu
 		void save_volume(const std::string &path,
 						 const State &state,
 						 const Eigen::MatrixXd &sol,
@@ -185,7 +208,8 @@ namespace polyfem::io
 						 const double t,
 						 const double dt,
 						 const ExportOptions &opts,
-						 std::vector<SolutionFrame> &solution_frames) const;
+						 std::vector<SolutionFrame> &solution_frames,
+						 TransientHDF5Writer *transient_writer = nullptr) const;
 
 		/// saves the surface vtu file for for surface quantites, eg traction forces
 		/// @param[in] export_surface filename
@@ -265,10 +289,64 @@ namespace polyfem::io
 		void save_pvd(const std::string &name, const std::function<std::string(int)> &vtu_names,
 					  int time_steps, double t0, double dt, int skip_frame = 1) const;
 
+		/// save a PVD of a time dependent simulation with variable time steps
+		/// @param[in] name filename
+		/// @param[in] vtu_names names of the vtu files
+		/// @param[in] times time of every time step
+		/// @param[in] skip_frame every which frame to skip
+		void save_pvd(const std::string &name, const std::function<std::string(int)> &vtu_names,
+					  const std::vector<double> &times, int skip_frame = 1) const;
+
 	private:
 		/// used to sample the solution
 		utils::RefElementSampler ref_element_sampler;
 
+		/// sampling of the visualization mesh, built on the first export and reused until reset_vis_cache,
+		/// the following exports only evaluate the geometric mapping and the fields
+		struct VisMeshCache
+		{
+			bool valid = false;
+			bool boundary_only = false;
+
+			std::vector<int> elements;                 ///< sampled elements
+			std::vector<Eigen::MatrixXd> local_points; ///< reference sample points of each sampled element
+			std::vector<int> offsets;                  ///< first vis point of each sampled element, the last entry is the total
+			Eigen::MatrixXi cells;
+			Eigen::MatrixXi el_id;
+			Eigen::MatrixXd discr;
+		};
+		mutable VisMeshCache vis_mesh_cache;
+
+		/// sampling of the boundary visualization mesh, one facet per boundary primitive
+		struct VisBoundaryCache
+		{
+			bool valid = false;
+
+			std::vector<int> element_ids;                  ///< element of each facet
+			std::vector<int> primitive_ids;                ///< global edge/face id of each facet
+			std::vector<Eigen::MatrixXd> local_points;     ///< reference sample points of each facet
+			std::vector<Eigen::MatrixXd> reference_normal; ///< normal of each facet in the reference element
+			std::vector<int> offsets;                      ///< first vis point of each facet, the last entry is the total
+			Eigen::MatrixXi cells;                         ///< triangles in 3d, edges in 2d
+		};
+		mutable VisBoundaryCache vis_boundary_cache;
+
+		/// samples the boundary facets and builds their connectivity in vis_boundary_cache
+		void build_vis_boundary_cache(
+			const mesh::Mesh &mesh,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const std::vector<mesh::LocalBoundary> &total_local_boundary) const;
+
+		/// samples the elements and builds their connectivity in vis_mesh_cache
+		void build_vis_mesh_cache(
+			const mesh::Mesh &mesh,
+			const Eigen::VectorXi &disc_orders,
+			const std::vector<basis::ElementBases> &gbases,
+			const std::map<int, Eigen::MatrixXd> &polys,
+			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+			const bool boundary_only) const;
+
 		/// grid mesh points to export solution sampled on a grid
 		Eigen::MatrixXd grid_points;
 		/// grid mesh mapping to fe elements
@@ -356,7 +434,7 @@ namespace polyfem::io
 			const ExportOptions &opts,
 			const std::string &name,
 			const Eigen::VectorXd &field,
-			paraviewo::ParaviewWriter &writer) const;
+			const std::function<void(const std::string &, const Eigen::MatrixXd &)> &add_field) const;
 	};
 
 	/// @brief stores all runtime data
@@ -377,6 +455,16 @@ namespace polyfem::io
 		double assigning_rhs_time;
 		/// time to solve
 		double solving_time;
+		/// time spent building the CCD candidates, included in solving_time
+		double ccd_broad_phase_time = 0;
+		/// time spent bounding the time of impact of the CCD candidates, included in solving_time
+		double ccd_narrow_phase_time = 0;
+		/// time spent in continuous collision detection, included in solving_time
+		double ccd_time = 0;
+		/// broad-phase method used at the end of the solve, the one selected last if autotuned
+		std::string ccd_broad_phase_method;
+		/// number of times the broad-phase autotuning selected a method
+		int ccd_broad_phase_selections = 0;
 
 		/// @brief computes total time
 		/// @return total time
@@ -411,6 +499,9 @@ namespace polyfem::io
 		/// num dof is the total dof in the system
 		long long nn_zero, mat_size, num_dofs;
 
+		/// memory used by the bases, caches, matrices, collision sets, and saved solutions
+		utils::MemoryStats memory;
+
 		/// statiscs on angle, compute only when using p_ref (false by default)
 		double max_angle;
 		/// statiscs on tri/tet quality, compute only when using p_ref (false by default)
@@ -444,6 +535,7 @@ namespace polyfem::io
 		/// @param[in] n_bases number of base
 		/// @param[in] bases bases
 		/// @param[in] gbases geometric bases
+		/// @param[in] ass_vals_cache assembly values cache of bases, shared with the solve
 		/// @param[in] mesh mesh
 		/// @param[in] problem problem
 		/// @param[in] tend end time step
@@ -451,6 +543,7 @@ namespace polyfem::io
 		void compute_errors(const int n_bases,
 							const std::vector<polyfem::basis::ElementBases> &bases,
 							const std::vector<polyfem::basis::ElementBases> &gbases,
+							const assembler::AssemblyValsCache &ass_vals_cache,
 							const polyfem::mesh::Mesh &mesh,
 							const assembler::Problem &problem,
 							const double tend,
@@ -512,11 +605,16 @@ namespace polyfem::io
 		EnergyCSVWriter(const std::string &path, const solver::SolveData &solve_data);
 		~EnergyCSVWriter();
 
+		/// @brief Write the energies at sol, reusing the values of the last energy evaluation of the solver at sol
 		void write(const int i, const Eigen::MatrixXd &sol);
 
 	protected:
+		/// number of rows written between two flushes of the file
+		static constexpr int FLUSH_INTERVAL = 10;
+
 		std::ofstream file;
 		const solver::SolveData &solve_data;
+		int rows_since_flush = 0;
 	};
 
 	class RuntimeStatsCSVWriter
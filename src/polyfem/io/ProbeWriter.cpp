@@ -0,0 +1,132 @@
+#include "ProbeWriter.hpp"
+
+#include <polyfem/assembler/Assembler.hpp>
+#include <polyfem/basis/ElementBases.hpp>
+#include <polyfem/mesh/Mesh.hpp>
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace polyfem::io
+{
+	ProbeWriter::ProbeWriter(const std::string &path, const Eigen::MatrixXd &points, const bool scalar_values)
+		: path_(path), points_(points), scalar_values_(scalar_values)
+	{
+		out_.open(path_);
+		if (!out_.is_open())
+			log_and_throw_error("Unable to open {}", path_);
+		out_.precision(std::numeric_limits<double>::max_digits10);
+	}
+
+	void ProbeWriter::locate(
+		const mesh::Mesh &mesh,
+		const std::vector<basis::ElementBases> &bases,
+		const int n_bases,
+		const int actual_dim)
+	{
+		if (points_.cols() != mesh.dimension())
+			log_and_throw_error("Probes are {}D points in a {}D mesh.", points_.cols(), mesh.dimension());
+
+		Eigen::MatrixXd coords;
+		mesh.locate_points(points_, element_ids_, coords);
+
+		// the reference coordinates of a simplex are the barycentric coordinates without the first one
+		local_pts_ = coords.rightCols(mesh.dimension());
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int i = 0; i < n_probes(); ++i)
+		{
+			const int e = element_ids_(i);
+			if (e < 0)
+			{
+				logger().warn("Probe {} ({}) is outside of the mesh", i, points_.row(i));
+				continue;
+			}
+
+			std::vector<assembler::AssemblyValues> vals;
+			bases[e].evaluate_bases(local_pts_.row(i), vals);
+			for (const assembler::AssemblyValues &v : vals)
+			{
+				for (const basis::Local2Global &g : v.global)
+				{
+					for (int d = 0; d < actual_dim; ++d)
+						entries.emplace_back(i * actual_dim + d, g.index * actual_dim + d, g.val * v.val(0));
+				}
+			}
+		}
+
+		interpolation_.resize(n_probes() * actual_dim, n_bases * actual_dim);
+		interpolation_.setFromTriplets(entries.begin(), entries.end());
+
+		located_ = true;
+	}
+
+	void ProbeWriter::write_step(
+		const int step,
+		const double t,
+		const mesh::Mesh &mesh,
+		const std::vector<basis::ElementBases> &bases,
+		const std::vector<basis::ElementBases> &gbases,
+		const assembler::Assembler &assembler,
+		const int n_bases,
+		const int actual_dim,
+		const Eigen::MatrixXd &sol)
+	{
+		if (!located_)
+			locate(mesh, bases, n_bases, actual_dim);
+
+		assert(sol.cols() == 1 && sol.rows() >= interpolation_.cols());
+		const Eigen::VectorXd values = interpolation_ * sol.topRows(interpolation_.cols());
+
+		std::vector<std::vector<assembler::Assembler::NamedMatrix>> scalars(n_probes());
+		if (scalar_values_)
+		{
+			utils::maybe_parallel_for(n_probes(), [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+				{
+					const int e = element_ids_(i);
+					if (e < 0)
+						continue;
+					const Eigen::MatrixXd local_pt = local_pts_.row(i);
+					assembler.compute_scalar_value(assembler::OutputData(t, e, bases[e], gbases[e], local_pt, sol), scalars[i]);
+				}
+			});
+		}
+
+		if (!header_written_)
+		{
+			// the names of the scalar values are only known once they have been evaluated in some element
+			const auto located = std::find_if(scalars.begin(), scalars.end(), [](const auto &s) { return !s.empty(); });
+			n_scalars_ = located == scalars.end() ? 0 : located->size();
+
+			out_ << "step,t,probe";
+			for (int d = 0; d < mesh.dimension(); ++d)
+				out_ << ",x" << d;
+			for (int d = 0; d < actual_dim; ++d)
+				out_ << ",u" << d;
+			for (int s = 0; s < n_scalars_; ++s)
+				out_ << "," << (*located)[s].first;
+			out_ << "\n";
+			header_written_ = true;
+		}
+
+		for (int i = 0; i < n_probes(); ++i)
+		{
+			const bool inside = element_ids_(i) >= 0;
+
+			out_ << step << "," << t << "," << i;
+			for (int d = 0; d < points_.cols(); ++d)
+				out_ << "," << points_(i, d);
+			for (int d = 0; d < actual_dim; ++d)
+				out_ << "," << (inside ? values(i * actual_dim + d) : std::numeric_limits<double>::quiet_NaN());
+			for (int s = 0; s < n_scalars_; ++s)
+				out_ << "," << (s < scalars[i].size() ? scalars[i][s].second(0) : std::numeric_limits<double>::quiet_NaN());
+			out_ << "\n";
+		}
+
+		// flushed at every step so that the probes can be monitored during the run
+		out_.flush();
+	}
+} // namespace polyfem::io
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <polyfem/utils/Types.hpp>
+
+#include <Eigen/Dense>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace polyfem
+{
+	namespace mesh
+	{
+		class Mesh;
+	}
+	namespace basis
+	{
+		class ElementBases;
+	}
+	namespace assembler
+	{
+		class Assembler;
+	}
+} // namespace polyfem
+
+namespace polyfem::io
+{
+	/// Streams the solution at a few probe points into a CSV file, one row per probe and time step.
+	/// The probes are located once and their values are a single sparse product with the solution,
+	/// so long runs can monitor them without exporting the full fields.
+	class ProbeWriter
+	{
+	public:
+		/// @param[in] path output path of the CSV file
+		/// @param[in] points positions of the probes in the rest mesh, one per row
+		/// @param[in] scalar_values also writes the scalar values of the assembler (e.g., von Mises) at the probes
+		ProbeWriter(const std::string &path, const Eigen::MatrixXd &points, const bool scalar_values);
+
+		/// @brief drops the location of the probes, they are located again at the next step
+		/// To be called when the mesh or the bases change
+		void invalidate() { located_ = false; }
+
+		/// @brief writes the values at the probes of a time step
+		/// @param[in] step time step index
+		/// @param[in] t time
+		/// @param[in] mesh rest mesh
+		/// @param[in] bases bases of the solution
+		/// @param[in] gbases geometric bases
+		/// @param[in] assembler assembler computing the scalar values
+		/// @param[in] n_bases number of bases
+		/// @param[in] actual_dim size of the problem (e.g., 1 for Laplace, dim for elasticity)
+		/// @param[in] sol solution
+		void write_step(
+			const int step,
+			const double t,
+			const mesh::Mesh &mesh,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const assembler::Assembler &assembler,
+			const int n_bases,
+			const int actual_dim,
+			const Eigen::MatrixXd &sol);
+
+		/// path of the CSV file
+		const std::string &path() const { return path_; }
+		/// number of probes
+		int n_probes() const { return points_.rows(); }
+
+	private:
+		/// @brief finds the element and local coordinates of every probe and builds the interpolation matrix
+		void locate(
+			const mesh::Mesh &mesh,
+			const std::vector<basis::ElementBases> &bases,
+			const int n_bases,
+			const int actual_dim);
+
+		std::string path_;
+		std::ofstream out_;
+		bool header_written_ = false;
+		/// number of scalar values per probe, fixed by the header
+		int n_scalars_ = 0;
+
+		Eigen::MatrixXd points_;
+		const bool scalar_values_;
+
+		bool located_ = false;
+		/// element containing every probe, -1 if it is outside of the mesh
+		Eigen::VectorXi element_ids_;
+		/// coordinates of every probe in the reference element
+		Eigen::MatrixXd local_pts_;
+		/// maps the solution to the values at the probes, #probes * actual_dim x #bases * actual_dim
+		StiffnessMatrix interpolation_;
+	};
+} // namespace polyfem::io
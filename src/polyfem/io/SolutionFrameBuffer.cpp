@@ -0,0 +1,159 @@
+#include "SolutionFrameBuffer.hpp"
+
+#include <polyfem/utils/MemoryUsage.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace polyfem::io
+{
+	namespace
+	{
+		constexpr double int16_levels = 65535;
+	} // namespace
+
+	SolutionFrameBuffer::SolutionFrameBuffer(const int capacity, const Storage storage, const Compression compression, const std::vector<std::string> &fields)
+		: capacity_(std::max(capacity, 0)), storage_(storage), compression_(compression), fields_(fields.begin(), fields.end())
+	{
+	}
+
+	void SolutionFrameBuffer::push(const int step, const double t, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure, SolutionFrame &&fields)
+	{
+		if (storage_ == Storage::DOFS)
+			fields = SolutionFrame();
+		else
+			select_fields(fields);
+
+		if (callback_)
+			callback_(step, t, sol, pressure, fields);
+
+		if (capacity_ > 0 && int(frames_.size()) >= capacity_)
+		{
+			frames_.pop_front();
+			++n_dropped_;
+		}
+
+		Frame &frame = frames_.emplace_back();
+		frame.step = step;
+		frame.t = t;
+		frame.sol = encode(sol);
+		frame.pressure = encode(pressure);
+		frame.fields = std::move(fields);
+	}
+
+	void SolutionFrameBuffer::dofs(const int i, Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure) const
+	{
+		assert(i >= 0 && i < size());
+		decode(frames_[i].sol, sol);
+		decode(frames_[i].pressure, pressure);
+	}
+
+	void SolutionFrameBuffer::clear()
+	{
+		frames_.clear();
+		n_dropped_ = 0;
+	}
+
+	size_t SolutionFrameBuffer::memory_usage() const
+	{
+		size_t bytes = 0;
+		for (const Frame &frame : frames_)
+		{
+			bytes += sizeof(Frame);
+			for (const EncodedMatrix *enc : {&frame.sol, &frame.pressure})
+				bytes += enc->data.capacity() + utils::memory_usage(enc->offset) + utils::memory_usage(enc->scale);
+
+			const SolutionFrame &f = frame.fields;
+			bytes += utils::memory_usage(f.points) + utils::memory_usage(f.connectivity) + utils::memory_usage(f.solution)
+					 + utils::memory_usage(f.pressure) + utils::memory_usage(f.exact) + utils::memory_usage(f.error)
+					 + utils::memory_usage(f.scalar_value) + utils::memory_usage(f.scalar_value_avg);
+		}
+		return bytes;
+	}
+
+	SolutionFrameBuffer::EncodedMatrix SolutionFrameBuffer::encode(const Eigen::MatrixXd &mat) const
+	{
+		EncodedMatrix enc;
+		enc.rows = mat.rows();
+		enc.cols = mat.cols();
+		const Eigen::Index n = mat.size();
+
+		switch (compression_)
+		{
+		case Compression::NONE:
+			enc.data.resize(n * sizeof(double));
+			std::memcpy(enc.data.data(), mat.data(), n * sizeof(double));
+			break;
+		case Compression::FLOAT32:
+		{
+			const Eigen::MatrixXf tmp = mat.cast<float>();
+			enc.data.resize(n * sizeof(float));
+			std::memcpy(enc.data.data(), tmp.data(), n * sizeof(float));
+			break;
+		}
+		case Compression::INT16:
+		{
+			enc.offset.resize(enc.cols);
+			enc.scale.resize(enc.cols);
+			enc.data.resize(n * sizeof(uint16_t));
+			uint16_t *q = reinterpret_cast<uint16_t *>(enc.data.data());
+			for (Eigen::Index c = 0; c < enc.cols; ++c)
+			{
+				const double min = enc.rows > 0 ? mat.col(c).minCoeff() : 0;
+				const double max = enc.rows > 0 ? mat.col(c).maxCoeff() : 0;
+				enc.offset(c) = min;
+				enc.scale(c) = max > min ? (max - min) / int16_levels : 0;
+				for (Eigen::Index r = 0; r < enc.rows; ++r)
+					q[c * enc.rows + r] = enc.scale(c) > 0 ? uint16_t(std::lround((mat(r, c) - min) / enc.scale(c))) : 0;
+			}
+			break;
+		}
+		}
+
+		return enc;
+	}
+
+	void SolutionFrameBuffer::decode(const EncodedMatrix &enc, Eigen::MatrixXd &mat) const
+	{
+		mat.resize(enc.rows, enc.cols);
+		const Eigen::Index n = mat.size();
+
+		switch (compression_)
+		{
+		case Compression::NONE:
+			std::memcpy(mat.data(), enc.data.data(), n * sizeof(double));
+			break;
+		case Compression::FLOAT32:
+			mat = Eigen::Map<const Eigen::MatrixXf>(reinterpret_cast<const float *>(enc.data.data()), enc.rows, enc.cols).cast<double>();
+			break;
+		case Compression::INT16:
+		{
+			const uint16_t *q = reinterpret_cast<const uint16_t *>(enc.data.data());
+			for (Eigen::Index c = 0; c < enc.cols; ++c)
+				for (Eigen::Index r = 0; r < enc.rows; ++r)
+					mat(r, c) = enc.offset(c) + q[c * enc.rows + r] * enc.scale(c);
+			break;
+		}
+		}
+	}
+
+	void SolutionFrameBuffer::select_fields(SolutionFrame &frame) const
+	{
+		if (fields_.empty())
+			return;
+
+		const auto drop = [this](const std::string &name, auto &field) {
+			if (fields_.find(name) == fields_.end())
+				field.resize(0, 0);
+		};
+		drop("points", frame.points);
+		drop("connectivity", frame.connectivity);
+		drop("solution", frame.solution);
+		drop("pressure", frame.pressure);
+		drop("exact", frame.exact);
+		drop("error", frame.error);
+		drop("scalar_value", frame.scalar_value);
+		drop("scalar_value_avg", frame.scalar_value_avg);
+	}
+} // namespace polyfem::io
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <polyfem/io/OutData.hpp>
+
+#include <Eigen/Dense>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace polyfem::io
+{
+	/// Bounded in-memory storage of the time steps of a solve, used instead of State::solution_frames when
+	/// the frames are not exported to files. When the buffer is full the oldest frame is dropped.
+	/// Frames keep either the evaluated fields (restricted to a selection) or only the dofs, from which
+	/// the fields can be evaluated again on demand. The dofs can be stored with a lossy compression.
+	class SolutionFrameBuffer
+	{
+	public:
+		/// what is kept for every frame
+		enum class Storage
+		{
+			FIELDS, ///< dofs and evaluated fields
+			DOFS    ///< dofs only, the fields are not evaluated when the frame is pushed
+		};
+
+		/// encoding of the stored dofs
+		enum class Compression
+		{
+			NONE,    ///< doubles, lossless
+			FLOAT32, ///< single precision floats, relative error ~1e-7
+			INT16    ///< 16 bits quantization of every column between its min and max
+		};
+
+		/// called for every pushed frame with the uncompressed data, fields is empty with Storage::DOFS
+		using Callback = std::function<void(const int step, const double t, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure, const SolutionFrame &fields)>;
+
+		/// @param[in] capacity maximum number of frames kept, 0 for no limit
+		/// @param[in] storage what is kept for every frame
+		/// @param[in] compression encoding of the stored dofs
+		/// @param[in] fields names of the SolutionFrame fields kept (points, connectivity, solution, pressure, exact, error, scalar_value, scalar_value_avg), all of them if empty
+		SolutionFrameBuffer(const int capacity = 0,
+							const Storage storage = Storage::FIELDS,
+							const Compression compression = Compression::NONE,
+							const std::vector<std::string> &fields = {});
+
+		/// @brief stores a frame, dropping the oldest one if the buffer is full
+		/// @param[in] step time step index
+		/// @param[in] t time
+		/// @param[in] sol solution dofs
+		/// @param[in] pressure pressure dofs
+		/// @param[in] fields evaluated fields, ignored with Storage::DOFS
+		void push(const int step, const double t, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure, SolutionFrame &&fields);
+
+		/// @brief decodes the dofs of the i-th stored frame, oldest first
+		void dofs(const int i, Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure) const;
+
+		/// evaluated fields of the i-th stored frame, oldest first, empty with Storage::DOFS
+		const SolutionFrame &fields(const int i) const { return frames_[i].fields; }
+		/// time step index of the i-th stored frame
+		int step(const int i) const { return frames_[i].step; }
+		/// time of the i-th stored frame
+		double time(const int i) const { return frames_[i].t; }
+
+		/// number of stored frames
+		int size() const { return frames_.size(); }
+		int capacity() const { return capacity_; }
+		Storage storage() const { return storage_; }
+		/// number of frames dropped because the buffer was full
+		int n_dropped() const { return n_dropped_; }
+
+		void clear();
+
+		/// @brief sets the function called for every pushed frame, empty to disable it
+		void set_callback(const Callback &callback) { callback_ = callback; }
+
+		/// bytes used by the stored frames
+		size_t memory_usage() const;
+
+	private:
+		/// matrix encoded with compression_
+		struct EncodedMatrix
+		{
+			Eigen::Index rows = 0, cols = 0;
+			std::vector<uint8_t> data;
+			Eigen::VectorXd offset, scale; ///< per column, for Compression::INT16
+		};
+
+		struct Frame
+		{
+			int step;
+			double t;
+			EncodedMatrix sol, pressure;
+			SolutionFrame fields;
+		};
+
+		EncodedMatrix encode(const Eigen::MatrixXd &mat) const;
+		void decode(const EncodedMatrix &enc, Eigen::MatrixXd &mat) const;
+
+		/// drops the fields that are not selected
+		void select_fields(SolutionFrame &frame) const;
+
+		const int capacity_;
+		const Storage storage_;
+		const Compression compression_;
+		const std::set<std::string> fields_;
+
+		std::deque<Frame> frames_;
+		int n_dropped_ = 0;
+		Callback callback_;
+	};
+} // namespace polyfem::io
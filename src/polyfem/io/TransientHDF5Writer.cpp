@@ -0,0 +1,213 @@
+#include "TransientHDF5Writer.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <h5pp/h5pp.h>
+
+#include <filesystem>
+
+namespace polyfem::io
+{
+	namespace
+	{
+		using RowMatrixXd = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+		const std::string xdmf_footer = "\t\t</Grid>\n\t</Domain>\n</Xdmf>\n";
+
+		std::string data_item(const std::string &file_name, const std::string &dataset, const long rows, const long cols, const bool is_int)
+		{
+			const std::string dims = cols > 0 ? fmt::format("{} {}", rows, cols) : fmt::format("{}", rows);
+			return fmt::format(
+				"<DataItem Dimensions=\"{}\" NumberType=\"{}\" Precision=\"8\" Format=\"HDF\">{}:{}</DataItem>",
+				dims, is_int ? "Int" : "Float", file_name, dataset);
+		}
+
+		std::string attribute_type(const int cols)
+		{
+			switch (cols)
+			{
+			case 1:
+				return "Scalar";
+			case 2:
+			case 3:
+				return "Vector";
+			case 6:
+				return "Tensor6";
+			case 9:
+				return "Tensor";
+			default:
+				return "Matrix";
+			}
+		}
+	} // namespace
+
+	TransientHDF5Writer::TransientHDF5Writer(const std::string &path, const int compression, const std::vector<std::string> &fields)
+		: path_(path), fields_(fields.begin(), fields.end())
+	{
+		xdmf_path_ = std::filesystem::path(path).replace_extension(".xdmf").string();
+
+		file_ = std::make_unique<h5pp::File>(path_, h5pp::FileAccess::REPLACE);
+		file_->setCompressionLevel(compression);
+
+		xdmf_.open(xdmf_path_);
+		if (!xdmf_.is_open())
+			log_and_throw_error("Unable to open {}", xdmf_path_);
+
+		xdmf_ << "<?xml version=\"1.0\" ?>\n"
+			  << "<Xdmf Version=\"3.0\">\n"
+			  << "\t<Domain>\n"
+			  << "\t\t<Grid Name=\"TimeSeries\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+		xdmf_end_ = xdmf_.tellp();
+		xdmf_ << xdmf_footer;
+		xdmf_.flush();
+	}
+
+	TransientHDF5Writer::~TransientHDF5Writer() = default;
+
+	void TransientHDF5Writer::add_field(const std::string &name, const Eigen::MatrixXd &data)
+	{
+		if (!fields_.empty() && fields_.count(name) == 0)
+			return;
+
+		pending_fields_.emplace_back(name, data);
+	}
+
+	void TransientHDF5Writer::write_step(const double t, const Eigen::MatrixXd &points, const Eigen::MatrixXi &cells)
+	{
+		std::vector<std::vector<int>> tmp(cells.rows(), std::vector<int>(cells.cols()));
+		for (int i = 0; i < cells.rows(); ++i)
+		{
+			for (int j = 0; j < cells.cols(); ++j)
+				tmp[i][j] = cells(i, j);
+		}
+
+		write_step(t, points, tmp);
+	}
+
+	void TransientHDF5Writer::write_step(const double t, const Eigen::MatrixXd &points, const std::vector<std::vector<int>> &cells)
+	{
+		update_mesh(points, mixed_topology(points.cols(), cells), cells.size());
+
+		const std::string step = fmt::format("/steps/{}", n_steps_);
+		file_->writeDataset(t, step + "/time");
+		file_->writeDataset(n_meshes_ - 1, step + "/mesh");
+
+		step_fields_.clear();
+		for (const auto &[name, data] : pending_fields_)
+		{
+			if (data.rows() != points.rows())
+			{
+				logger().warn("Skipping field {} with {} values on a mesh with {} points", name, data.rows(), points.rows());
+				continue;
+			}
+			if (data.size() == 0)
+				continue;
+
+			const RowMatrixXd tmp = data;
+			file_->writeDataset(tmp, step + "/" + name, H5D_CHUNKED);
+			step_fields_.emplace_back(name, int(data.cols()));
+		}
+		pending_fields_.clear();
+
+		++n_steps_;
+		write_xdmf_step(t);
+	}
+
+	Eigen::Matrix<int64_t, Eigen::Dynamic, 1> TransientHDF5Writer::mixed_topology(const int dim, const std::vector<std::vector<int>> &cells) const
+	{
+		// XDMF cell types
+		constexpr int POLYVERTEX = 1, POLYLINE = 2, POLYGON = 3, TRIANGLE = 4, QUADRILATERAL = 5, TETRAHEDRON = 6, HEXAHEDRON = 9;
+
+		long size = 0;
+		for (const auto &c : cells)
+			size += c.size() + 2;
+
+		Eigen::Matrix<int64_t, Eigen::Dynamic, 1> topology(size);
+		long index = 0;
+		bool has_unsupported = false;
+		for (const auto &c : cells)
+		{
+			const int n = c.size();
+			if (n == 1 || n == 2)
+			{
+				topology(index++) = n == 1 ? POLYVERTEX : POLYLINE;
+				topology(index++) = n;
+			}
+			else if (n == 3)
+				topology(index++) = TRIANGLE;
+			else if (n == 4)
+				topology(index++) = dim == 3 ? TETRAHEDRON : QUADRILATERAL;
+			else if (n == 8 && dim == 3)
+				topology(index++) = HEXAHEDRON;
+			else if (dim == 2)
+			{
+				topology(index++) = POLYGON;
+				topology(index++) = n;
+			}
+			else
+			{
+				// High-order cells are exported as their nodes
+				has_unsupported = true;
+				topology(index++) = POLYVERTEX;
+				topology(index++) = n;
+			}
+
+			for (const int v : c)
+				topology(index++) = v;
+		}
+		topology.conservativeResize(index);
+
+		if (has_unsupported)
+			logger().warn("Cells with more than 8 nodes are written as vertices in {}", xdmf_path_);
+
+		return topology;
+	}
+
+	void TransientHDF5Writer::update_mesh(const Eigen::MatrixXd &points, const Eigen::Matrix<int64_t, Eigen::Dynamic, 1> &topology, const int n_cells)
+	{
+		if (n_meshes_ > 0
+			&& points.rows() == mesh_points_.rows() && points.cols() == mesh_points_.cols() && points == mesh_points_
+			&& topology.size() == mesh_topology_.size() && topology == mesh_topology_)
+			return;
+
+		mesh_points_ = points;
+		mesh_topology_ = topology;
+		n_cells_ = n_cells;
+
+		const std::string mesh = fmt::format("/meshes/{}", n_meshes_);
+		const RowMatrixXd tmp = points;
+		file_->writeDataset(tmp, mesh + "/points", H5D_CHUNKED);
+		file_->writeDataset(topology, mesh + "/cells", H5D_CHUNKED);
+		++n_meshes_;
+	}
+
+	void TransientHDF5Writer::write_xdmf_step(const double t)
+	{
+		const std::string file_name = std::filesystem::path(path_).filename().string();
+		const std::string mesh = fmt::format("/meshes/{}", n_meshes_ - 1);
+		const std::string step = fmt::format("/steps/{}", n_steps_ - 1);
+
+		// Overwrite the closing tags of the previous step
+		xdmf_.seekp(xdmf_end_);
+		xdmf_ << fmt::format("\t\t\t<Grid Name=\"step_{}\" GridType=\"Uniform\">\n", n_steps_ - 1)
+			  << fmt::format("\t\t\t\t<Time Value=\"{}\"/>\n", t)
+			  << fmt::format("\t\t\t\t<Topology TopologyType=\"Mixed\" NumberOfElements=\"{}\">\n", n_cells_)
+			  << "\t\t\t\t\t" << data_item(file_name, mesh + "/cells", mesh_topology_.size(), 0, true) << "\n"
+			  << "\t\t\t\t</Topology>\n"
+			  << fmt::format("\t\t\t\t<Geometry GeometryType=\"{}\">\n", mesh_points_.cols() == 3 ? "XYZ" : "XY")
+			  << "\t\t\t\t\t" << data_item(file_name, mesh + "/points", mesh_points_.rows(), mesh_points_.cols(), false) << "\n"
+			  << "\t\t\t\t</Geometry>\n";
+
+		for (const auto &[name, cols] : step_fields_)
+		{
+			xdmf_ << fmt::format("\t\t\t\t<Attribute Name=\"{}\" AttributeType=\"{}\" Center=\"Node\">\n", name, attribute_type(cols))
+				  << "\t\t\t\t\t" << data_item(file_name, step + "/" + name, mesh_points_.rows(), cols, false) << "\n"
+				  << "\t\t\t\t</Attribute>\n";
+		}
+
+		xdmf_ << "\t\t\t</Grid>\n";
+		xdmf_end_ = xdmf_.tellp();
+		xdmf_ << xdmf_footer;
+		xdmf_.flush();
+	}
+} // namespace polyfem::io
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace h5pp
+{
+	class File;
+}
+
+namespace polyfem::io
+{
+	/// Streams the point fields of a time dependent simulation into a single HDF5 file.
+	/// The mesh is written once (and again only when it changes) and every time step only adds its fields,
+	/// stored in chunked compressed datasets. An XDMF index with the same stem is kept up to date for Paraview.
+	class TransientHDF5Writer
+	{
+	public:
+		/// @param[in] path output path of the HDF5 file
+		/// @param[in] compression compression level of the datasets (0-9)
+		/// @param[in] fields names of the fields to export, all of them if empty
+		TransientHDF5Writer(const std::string &path, const int compression, const std::vector<std::string> &fields);
+		~TransientHDF5Writer();
+
+		/// @brief adds a point field to the next time step, ignored if the field is not exported
+		/// @param[in] name name of the field
+		/// @param[in] data #points x #components values
+		void add_field(const std::string &name, const Eigen::MatrixXd &data);
+
+		/// @brief writes a time step with the fields added since the previous one
+		/// @param[in] t time
+		/// @param[in] points mesh points
+		/// @param[in] cells mesh cells
+		void write_step(const double t, const Eigen::MatrixXd &points, const Eigen::MatrixXi &cells);
+
+		/// @brief writes a time step with the fields added since the previous one
+		/// @param[in] t time
+		/// @param[in] points mesh points
+		/// @param[in] cells mesh cells, possibly of different types
+		void write_step(const double t, const Eigen::MatrixXd &points, const std::vector<std::vector<int>> &cells);
+
+		/// path of the HDF5 file
+		const std::string &path() const { return path_; }
+		/// path of the XDMF index
+		const std::string &xdmf_path() const { return xdmf_path_; }
+		/// number of time steps written
+		int n_steps() const { return n_steps_; }
+
+	private:
+		/// XDMF mixed topology of the cells ([type, (n_nodes), ids...] for every cell)
+		Eigen::Matrix<int64_t, Eigen::Dynamic, 1> mixed_topology(const int dim, const std::vector<std::vector<int>> &cells) const;
+
+		/// writes the mesh if it is the first one or it changed since the last step
+		void update_mesh(const Eigen::MatrixXd &points, const Eigen::Matrix<int64_t, Eigen::Dynamic, 1> &topology, const int n_cells);
+
+		/// adds the grid of the last step to the XDMF index
+		void write_xdmf_step(const double t);
+
+		std::string path_;
+		std::string xdmf_path_;
+		std::set<std::string> fields_;
+
+		std::unique_ptr<h5pp::File> file_;
+		std::ofstream xdmf_;
+		/// position of the closing tags of the XDMF file, overwritten by the next step
+		std::streampos xdmf_end_;
+
+		/// fields added since the last step
+		std::vector<std::pair<std::string, Eigen::MatrixXd>> pending_fields_;
+		/// names and number of components of the fields of the last step
+		std::vector<std::pair<std::string, int>> step_fields_;
+
+		int n_steps_ = 0;
+		int n_meshes_ = 0;
+		int n_cells_ = 0;
+		Eigen::MatrixXd mesh_points_;
+		Eigen::Matrix<int64_t, Eigen::Dynamic, 1> mesh_topology_;
+	};
+} // namespace polyfem::io
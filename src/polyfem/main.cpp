@@ -1,4 +1,6 @@
 #include <filesystem>
+#include <iostream>
+#include <sstream>
 
 #include <CLI/CLI.hpp>
 
@@ -68,6 +70,11 @@ int optimization_simulation(const CLI::App &command_line,
 							const spdlog::level::level_enum &log_level,
 							json &opt_args);
 
+int solver_service(const CLI::App &command_line,
+				   const unsigned max_threads,
+				   const bool is_strict,
+				   json &in_args);
+
 int main(int argc, char **argv)
 {
 	using namespace polyfem;
@@ -103,6 +110,9 @@ int main(int argc, char **argv)
 	bool fallback_solver = false;
 	command_line.add_flag("--enable_overwrite_solver", fallback_solver, "If solver in input is not present, falls back to default.");
 
+	bool server = false;
+	command_line.add_flag("--server", server, "Reads one JSON job per line from stdin, each patching the input JSON, and writes one JSON result per line to stdout.");
+
 	const std::vector<std::pair<std::string, spdlog::level::level_enum>>
 		SPDLOG_LEVEL_NAMES_TO_LEVELS = {
 			{"trace", spdlog::level::trace},
@@ -129,6 +139,8 @@ int main(int argc, char **argv)
 
 		if (in_args.contains("states"))
 			return optimization_simulation(command_line, max_threads, is_strict, log_level, in_args);
+		else if (server)
+			return solver_service(command_line, max_threads, is_strict, in_args);
 		else
 			return forward_simulation(command_line, "", output_dir, max_threads,
 									  is_strict, fallback_solver, log_level, in_args);
@@ -147,10 +159,6 @@ int forward_simulation(const CLI::App &command_line,
 					   const spdlog::level::level_enum &log_level,
 					   json &in_args)
 {
-	std::vector<std::string> names;
-	std::vector<Eigen::MatrixXi> cells;
-	std::vector<Eigen::MatrixXd> vertices;
-
 	if (in_args.empty() && hdf5_file.empty())
 	{
 		logger().error("No input file specified!");
@@ -159,24 +167,16 @@ int forward_simulation(const CLI::App &command_line,
 
 	if (in_args.empty() && !hdf5_file.empty())
 	{
-		using MatrixXl = Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic>;
-
 		h5pp::File file(hdf5_file, h5pp::FileAccess::READONLY);
 		std::string json_string = file.readDataset<std::string>("json");
 
 		in_args = json::parse(json_string);
 		in_args["root_path"] = hdf5_file;
 
-		names = file.findGroups("", "/meshes");
-		cells.resize(names.size());
-		vertices.resize(names.size());
-
-		for (int i = 0; i < names.size(); ++i)
-		{
-			const std::string &name = names[i];
-			cells[i] = file.readDataset<MatrixXl>("/meshes/" + name + "/c").cast<int>();
-			vertices[i] = file.readDataset<Eigen::MatrixXd>("/meshes/" + name + "/v");
-		}
+		// The inline meshes are not read: read_fem_geometry only loads the geometry of the json so far
+		const std::vector<std::string> inline_meshes = file.findGroups("", "/meshes");
+		if (!inline_meshes.empty())
+			logger().warn("The {} meshes stored in {} are ignored, the geometry of the json is used", inline_meshes.size(), hdf5_file);
 	}
 
 	json tmp = json::object();
@@ -193,7 +193,7 @@ int forward_simulation(const CLI::App &command_line,
 
 	State state;
 	state.init(in_args, is_strict);
-	state.load_mesh(/*non_conforming=*/false, names, cells, vertices);
+	state.load_mesh(/*non_conforming=*/false);
 
 	// Mesh was not loaded successfully; load_mesh() logged the error.
 	if (state.mesh == nullptr)
@@ -202,15 +202,48 @@ int forward_simulation(const CLI::App &command_line,
 		return EXIT_FAILURE;
 	}
 
+	Eigen::MatrixXd sol;
+	Eigen::MatrixXd pressure;
+
+	if (state.args["output"]["advanced"]["convergence_study"]["levels"].get<int>() > 0)
+	{
+		state.convergence_study(sol, pressure);
+
+		logger().info("total time: {}s", state.timings.total_time());
+
+		state.export_data(sol, pressure);
+		return EXIT_SUCCESS;
+	}
+
 	state.stats.compute_mesh_stats(*state.mesh);
 
 	state.build_basis();
 
+	if (state.args["output"]["advanced"]["memory_estimate"])
+	{
+		state.save_memory_estimate();
+		return EXIT_SUCCESS;
+	}
+
 	state.assemble_rhs();
 	state.assemble_mass_mat();
 
-	Eigen::MatrixXd sol;
-	Eigen::MatrixXd pressure;
+	if (!state.args["load_cases"].empty())
+	{
+		state.solve_load_cases(sol);
+
+		logger().info("total time: {}s", state.timings.total_time());
+		return EXIT_SUCCESS;
+	}
+
+	if (state.args["modal_analysis"]["n_modes"].get<int>() > 0)
+	{
+		Eigen::VectorXd eigenvalues;
+		state.modal_analysis(eigenvalues, sol);
+
+		logger().info("total time: {}s", state.timings.total_time());
+		return EXIT_SUCCESS;
+	}
 
 	state.solve_problem(sol, pressure);
 
@@ -256,3 +289,77 @@ int optimization_simulation(const CLI::App &command_line,
 	opt_state.solve(x);
 	return EXIT_SUCCESS;
 }
+
+int solver_service(const CLI::App &command_line,
+				   const unsigned max_threads,
+				   const bool is_strict,
+				   json &in_args)
+{
+	// stdout carries the results, the console log is disabled
+	json tmp = json::object();
+	tmp["/output/log/quiet"_json_pointer] = true;
+	if (has_arg(command_line, "max_threads"))
+		tmp["/solver/max_threads"_json_pointer] = max_threads;
+	in_args.merge_patch(tmp);
+
+	// the State, and the mesh it loaded, are kept while the geometry of the jobs does not change
+	State state;
+	json geometry;
+
+	std::string line;
+	while (std::getline(std::cin, line))
+	{
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+
+		json result = json::object();
+		try
+		{
+			const json job = json::parse(line);
+			if (job.contains("id"))
+				result["id"] = job["id"];
+
+			json job_args = in_args;
+			if (job.contains("args"))
+				job_args.merge_patch(job["args"]);
+			job_args.merge_patch(tmp);
+
+			if (job_args["geometry"] != geometry)
+			{
+				state.mesh.reset();
+				geometry = job_args["geometry"];
+			}
+
+			state.init(job_args, is_strict);
+			state.load_mesh();
+			if (state.mesh == nullptr)
+				log_and_throw_error("Unable to load the mesh");
+
+			state.stats.compute_mesh_stats(*state.mesh);
+			state.build_basis();
+			state.assemble_rhs();
+			state.assemble_mass_mat();
+
+			Eigen::MatrixXd sol, pressure;
+			state.solve_problem(sol, pressure);
+			state.compute_errors(sol);
+
+			std::stringstream stats;
+			state.save_json(sol, stats);
+			result["stats"] = json::parse(stats.str());
+			if (job.value("solution", false))
+				result["solution"] = std::vector<double>(sol.data(), sol.data() + sol.size());
+
+			state.export_data(sol, pressure);
+		}
+		catch (const std::exception &e)
+		{
+			result["error"] = e.what();
+			geometry = json();
+		}
+
+		std::cout << result.dump() << std::endl;
+	}
+
+	return EXIT_SUCCESS;
+}
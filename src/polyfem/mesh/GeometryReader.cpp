@@ -1,8 +1,10 @@
 #include "GeometryReader.hpp"
 
+#include <polyfem/mesh/ImplicitObstacle.hpp>
 #include <polyfem/mesh/Mesh.hpp>
 #include <polyfem/mesh/MeshUtils.hpp>
 #include <polyfem/io/MshReader.hpp>
+#include <polyfem/io/MatrixIO.hpp>
 #include <polyfem/utils/StringUtils.hpp>
 
 #include <polyfem/utils/JSONUtils.hpp>
@@ -17,11 +19,138 @@
 #include <strnatcmp.h>
 #include <glob/glob.h>
 #include <filesystem>
+#include <map>
 
 namespace polyfem::mesh
 {
 	using namespace polyfem::utils;
 
+	namespace
+	{
+		/// @brief Path of the cached processed mesh, keyed by the geometry JSON and the mesh file's size and modification time.
+		std::string mesh_cache_path(
+			const Units &units,
+			const json &j_mesh,
+			const std::string &root_path,
+			const bool non_conforming)
+		{
+			const std::string cache_dir = resolve_path(j_mesh["advanced"]["cache"], root_path);
+			const std::string mesh_path = resolve_path(j_mesh["mesh"], root_path);
+
+			std::string key = fmt::format("v1;{};{};{};{}", j_mesh.dump(), root_path, units.length(), non_conforming);
+			if (std::filesystem::exists(mesh_path))
+				key += fmt::format(
+					";{};{}", std::filesystem::file_size(mesh_path),
+					std::filesystem::last_write_time(mesh_path).time_since_epoch().count());
+
+			std::filesystem::create_directories(cache_dir);
+			return (std::filesystem::path(cache_dir) / fmt::format("{:016x}.bin", std::hash<std::string>{}(key))).string();
+		}
+
+		/// @brief Write the processed mesh (vertices, cells, body and boundary ids) to a binary cache.
+		/// Meshes with polytopes or high-order geometry are not cached.
+		void write_cached_mesh(const std::string &path, const Mesh &mesh)
+		{
+			if (mesh.n_elements() == 0 || mesh.has_poly() || !mesh.is_linear())
+				return;
+
+			const auto n_element_vertices = [&](const int e) {
+				return mesh.is_volume() ? mesh.n_cell_vertices(e) : mesh.n_face_vertices(e);
+			};
+
+			const int n_cell_vertices = n_element_vertices(0);
+			Eigen::MatrixXi cells(mesh.n_elements(), n_cell_vertices);
+			for (int e = 0; e < mesh.n_elements(); ++e)
+			{
+				if (n_element_vertices(e) != n_cell_vertices)
+					return;
+				for (int lv = 0; lv < n_cell_vertices; ++lv)
+					cells(e, lv) = mesh.element_vertex(e, lv);
+			}
+
+			Eigen::MatrixXd vertices(mesh.n_vertices(), mesh.dimension());
+			for (int v = 0; v < mesh.n_vertices(); ++v)
+				vertices.row(v) = mesh.point(v);
+
+			io::write_matrix(path, "vertices", vertices);
+			io::write_matrix(path, "cells", cells, /*replace=*/false);
+
+			if (mesh.has_body_ids())
+			{
+				const std::vector<int> &body_ids = mesh.get_body_ids();
+				io::write_matrix(path, "body_ids", Eigen::MatrixXi(Eigen::Map<const Eigen::VectorXi>(body_ids.data(), body_ids.size())), /*replace=*/false);
+			}
+
+			if (mesh.has_boundary_ids())
+			{
+				// boundary ids are stored with the sorted vertices of their primitive, the primitive numbering is not stable
+				const int n_primitives = mesh.is_volume() ? mesh.n_faces() : mesh.n_edges();
+				const int max_vertices = mesh.is_volume() ? 4 : 2;
+				Eigen::MatrixXi boundary_ids = Eigen::MatrixXi::Constant(n_primitives, max_vertices + 1, -1);
+				for (int p = 0; p < n_primitives; ++p)
+				{
+					const int n_vertices = mesh.is_volume() ? mesh.n_face_vertices(p) : 2;
+					if (n_vertices > max_vertices)
+						return;
+
+					std::vector<int> vs(n_vertices);
+					for (int lv = 0; lv < n_vertices; ++lv)
+						vs[lv] = mesh.is_volume() ? mesh.face_vertex(p, lv) : mesh.edge_vertex(p, lv);
+					std::sort(vs.begin(), vs.end());
+
+					for (int lv = 0; lv < n_vertices; ++lv)
+						boundary_ids(p, lv) = vs[lv];
+					boundary_ids(p, max_vertices) = mesh.get_boundary_id(p);
+				}
+				io::write_matrix(path, "boundary_ids", boundary_ids, /*replace=*/false);
+			}
+
+			logger().debug("Cached processed mesh to {}", path);
+		}
+
+		/// @brief Read a processed mesh written by write_cached_mesh.
+		/// @return nullptr if the cache does not exist
+		std::unique_ptr<Mesh> read_cached_mesh(const std::string &path, const bool non_conforming)
+		{
+			Eigen::MatrixXd vertices;
+			Eigen::MatrixXi cells;
+			if (!std::filesystem::exists(path)
+				|| !io::read_matrix(path, "vertices", vertices)
+				|| !io::read_matrix(path, "cells", cells))
+				return nullptr;
+
+			std::unique_ptr<Mesh> mesh = Mesh::create(vertices, cells, non_conforming);
+			if (mesh == nullptr)
+				return nullptr;
+
+			Eigen::MatrixXi body_ids;
+			if (io::read_matrix(path, "body_ids", body_ids))
+				mesh->set_body_ids(std::vector<int>(body_ids.data(), body_ids.data() + body_ids.size()));
+
+			Eigen::MatrixXi boundary_ids;
+			if (io::read_matrix(path, "boundary_ids", boundary_ids))
+			{
+				const int max_vertices = boundary_ids.cols() - 1;
+				std::map<std::vector<int>, int> vertices_to_id;
+				for (int p = 0; p < boundary_ids.rows(); ++p)
+				{
+					std::vector<int> vs;
+					for (int lv = 0; lv < max_vertices && boundary_ids(p, lv) >= 0; ++lv)
+						vs.push_back(boundary_ids(p, lv));
+					vertices_to_id[vs] = boundary_ids(p, max_vertices);
+				}
+
+				mesh->compute_boundary_ids([&](const std::vector<int> &vs, bool is_boundary) {
+					const auto it = vertices_to_id.find(vs);
+					return it != vertices_to_id.end() ? it->second : -1;
+				});
+			}
+
+			logger().info("Loaded processed mesh from cache {}", path);
+			return mesh;
+		}
+	} // namespace
+
 	std::unique_ptr<Mesh> read_fem_mesh(
 		const Units &units,
 		const json &j_mesh,
@@ -34,6 +163,17 @@ namespace polyfem::mesh
 		if (j_mesh["extract"].get<std::string>() != "volume")
 			log_and_throw_error("Only volumetric elements are implemented for FEM meshes!");
 
+		const bool use_cache = !j_mesh["advanced"]["cache"].get<std::string>().empty()
+							   && !is_param_valid(j_mesh, "point_selection");
+		std::string cache_path;
+		if (use_cache)
+		{
+			cache_path = mesh_cache_path(units, j_mesh, root_path, non_conforming);
+			std::unique_ptr<Mesh> mesh = read_cached_mesh(cache_path, non_conforming);
+			if (mesh != nullptr)
+				return mesh;
+		}
+
 		std::unique_ptr<Mesh> mesh = Mesh::create(resolve_path(j_mesh["mesh"], root_path), non_conforming);
 
 		// --------------------------------------------------------------------
@@ -168,16 +308,24 @@ namespace polyfem::mesh
 
 		if (!surface_selections.empty())
 		{
+			// gather the primitives first, then test them against the selections in batches
+			const int n_primitives = mesh->n_boundary_elements();
+			std::vector<std::vector<int>> primitive_vs(n_primitives);
+			Eigen::MatrixXd primitive_ps(n_primitives, mesh->dimension());
+			std::vector<char> is_boundary_primitive(n_primitives, false);
 			mesh->compute_boundary_ids([&](const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p, bool is_boundary) {
-				if (!is_boundary)
-					return -1;
+				primitive_vs[p_id] = vs;
+				primitive_ps.row(p_id) = p;
+				is_boundary_primitive[p_id] = is_boundary;
+				return -1;
+			});
 
-				for (const auto &selection : surface_selections)
-				{
-					if (selection->inside(p_id, vs, p))
-						return selection->id(p_id, vs, p);
-				}
-				return std::numeric_limits<int>::max(); // default for no selected boundary
+			const std::vector<int> boundary_ids = Selection::compute_ids(
+				surface_selections, primitive_vs, primitive_ps, is_boundary_primitive,
+				std::numeric_limits<int>::max()); // default for no selected boundary
+
+			mesh->compute_boundary_ids([&](const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p, bool is_boundary) {
+				return boundary_ids[p_id];
 			});
 		}
 
@@ -209,19 +357,28 @@ namespace polyfem::mesh
 			if (mesh->has_body_ids())
 				volume_selections.push_back(std::make_shared<SpecifiedSelection>(mesh->get_body_ids()));
 
+			// TODO: add vs to compute_body_ids
+			const int n_elements = mesh->n_elements();
+			const std::vector<std::vector<int>> element_vs(n_elements);
+			Eigen::MatrixXd element_ps(n_elements, mesh->dimension());
 			mesh->compute_body_ids([&](const size_t cell_id, const RowVectorNd &p) -> int {
-				for (const auto &selection : volume_selections)
-				{
-					// TODO: add vs to compute_body_ids
-					if (selection->inside(cell_id, {}, p))
-						return selection->id(cell_id, {}, p);
-				}
+				element_ps.row(cell_id) = p;
 				return 0;
 			});
+
+			const std::vector<int> body_ids = Selection::compute_ids(
+				volume_selections, element_vs, element_ps, std::vector<char>(n_elements, true), 0);
+
+			mesh->compute_body_ids([&](const size_t cell_id, const RowVectorNd &p) -> int {
+				return body_ids[cell_id];
+			});
 		}
 
 		// --------------------------------------------------------------------
 
+		if (use_cache)
+			write_cached_mesh(cache_path, *mesh);
+
 		return mesh;
 	}
 
@@ -608,6 +765,25 @@ namespace polyfem::mesh
 				const VectorNd point = height * normal; // origin + height * normal
 				obstacle.append_plane(point, normal);
 			}
+			else if (geometry["type"] == "implicit_plane")
+			{
+				const VectorNd point = geometry["point"];
+				const VectorNd normal = geometry["normal"];
+				obstacle.append_implicit(std::make_shared<ImplicitPlane>(point.head(dim), normal.head(dim)));
+			}
+			else if (geometry["type"] == "implicit_mesh")
+			{
+				Eigen::MatrixXd vertices;
+				Eigen::VectorXi codim_vertices;
+				Eigen::MatrixXi codim_edges;
+				Eigen::MatrixXi faces;
+				read_obstacle_mesh(units,
+								   geometry, root_path, dim, vertices, codim_vertices,
+								   codim_edges, faces);
+
+				obstacle.append_implicit(std::make_shared<ImplicitMesh>(
+					vertices, faces, geometry["grid_spacing"]));
+			}
 			else if (geometry["type"] == "mesh_sequence")
 			{
 				namespace fs = std::filesystem;
@@ -0,0 +1,45 @@
+#include "ImplicitObstacle.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <cmath>
+
+namespace polyfem::mesh
+{
+	ImplicitPlane::ImplicitPlane(const VectorNd &point, const VectorNd &normal)
+		: point_(point), normal_(normal.normalized())
+	{
+		assert(point.size() == normal.size());
+		assert(!normal.isZero());
+	}
+
+	void ImplicitPlane::distance(const Eigen::MatrixXd &points, Eigen::VectorXd &distances, Eigen::MatrixXd &grads) const
+	{
+		assert(points.cols() == point_.size());
+		distances = (points.rowwise() - point_.transpose()) * normal_;
+		grads = normal_.transpose().replicate(points.rows(), 1);
+	}
+
+	ImplicitMesh::ImplicitMesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const double grid_spacing)
+		: V_(V), F_(F), grid_(3, grid_spacing)
+	{
+		if (V.cols() != 3 || F.cols() != 3)
+			log_and_throw_error("Implicit mesh obstacles are only available for 3D triangle meshes.");
+		if (grid_spacing <= 0)
+			log_and_throw_error("Invalid grid spacing {} for an implicit mesh obstacle.", grid_spacing);
+
+		tree_.init(V_, F_);
+	}
+
+	void ImplicitMesh::distance(const Eigen::MatrixXd &points, Eigen::VectorXd &distances, Eigen::MatrixXd &grads) const
+	{
+		assert(points.cols() == 3);
+		grid_.cache_grid([this](const Eigen::MatrixXd &point, double &distance) {
+			int idx;
+			Eigen::Matrix<double, 1, 3> closest;
+			distance = std::sqrt(tree_.squared_distance(V_, F_, point.col(0), idx, closest));
+		},
+						 points);
+		grid_.evaluate(points, distances, grads);
+	}
+} // namespace polyfem::mesh
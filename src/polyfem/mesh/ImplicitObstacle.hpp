@@ -0,0 +1,60 @@
+#pragma once
+
+#include <polyfem/utils/Types.hpp>
+#include <polyfem/utils/LazyCubicInterpolator.hpp>
+
+#include <igl/AABB.h>
+
+#include <Eigen/Dense>
+
+namespace polyfem::mesh
+{
+	/// @brief Static obstacle represented by a distance function instead of triangles in the collision mesh.
+	/// The collision vertices are tested against it directly, without broad phase.
+	class ImplicitObstacle
+	{
+	public:
+		virtual ~ImplicitObstacle() = default;
+
+		/// @brief Distance to the obstacle and its gradient at a batch of points
+		/// @param[in] points one point per row
+		/// @param[out] distances distance at every point, non positive inside or behind the obstacle
+		/// @param[out] grads gradient of the distance at every point, one per row
+		virtual void distance(const Eigen::MatrixXd &points, Eigen::VectorXd &distances, Eigen::MatrixXd &grads) const = 0;
+	};
+
+	/// @brief Half space {x : (x - point)·normal ≤ 0}, with its exact signed distance
+	class ImplicitPlane : public ImplicitObstacle
+	{
+	public:
+		ImplicitPlane(const VectorNd &point, const VectorNd &normal);
+
+		void distance(const Eigen::MatrixXd &points, Eigen::VectorXd &distances, Eigen::MatrixXd &grads) const override;
+
+	private:
+		VectorNd point_;
+		VectorNd normal_;
+	};
+
+	/// @brief Unsigned distance to a triangle mesh, sampled lazily on a sparse grid around the queried points
+	/// and interpolated with cubic splines. Only the grid nodes near the collision vertices are computed, so
+	/// the size of the mesh only matters for the distance queries of these nodes.
+	class ImplicitMesh : public ImplicitObstacle
+	{
+	public:
+		/// @param V vertices of the mesh (3D)
+		/// @param F triangles of the mesh
+		/// @param grid_spacing spacing of the grid, should be a fraction of dhat
+		ImplicitMesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const double grid_spacing);
+
+		void distance(const Eigen::MatrixXd &points, Eigen::VectorXd &distances, Eigen::MatrixXd &grads) const override;
+
+	private:
+		Eigen::MatrixXd V_;
+		Eigen::MatrixXi F_;
+		igl::AABB<Eigen::MatrixXd, 3> tree_;
+
+		/// grid nodes computed so far, shared by all the queries
+		mutable LazyCubicInterpolator grid_;
+	};
+} // namespace polyfem::mesh
@@ -11,6 +11,7 @@
 
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <geogram/mesh/mesh_io.h>
 #include <geogram/mesh/mesh_geometry.h>
@@ -21,6 +22,8 @@
 #include <igl/oriented_facets.h>
 #include <igl/edges.h>
 
+#include <SimpleBVH/BVH.hpp>
+
 #include <filesystem>
 #include <unordered_set>
 
@@ -241,7 +244,7 @@ namespace polyfem::mesh
 	}
 
 	std::unique_ptr<Mesh> Mesh::create(
-		const Eigen::MatrixXd &vertices, const Eigen::MatrixXi &cells, const bool non_conforming)
+		const ConstMatrixXdView &vertices, const ConstMatrixXiView &cells, const bool non_conforming)
 	{
 		const int dim = vertices.cols();
 
@@ -284,7 +287,8 @@ namespace polyfem::mesh
 		{
 			if (cells.cols() == 4)
 			{
-				get_faces(cells, mesh->in_ordered_faces_);
+				// libigl is only instantiated for plain matrices
+				get_faces(Eigen::MatrixXi(cells), mesh->in_ordered_faces_);
 				igl::edges(mesh->in_ordered_faces_, mesh->in_ordered_edges_);
 			}
 			// else TODO
@@ -487,8 +491,71 @@ namespace polyfem::mesh
 		return res;
 	}
 
+	const SimpleBVH::BVH &Mesh::element_bvh() const
+	{
+		if (!element_bvh_)
+		{
+			std::vector<std::array<Eigen::Vector3d, 2>> boxes;
+			elements_boxes(boxes);
+
+			auto bvh = std::make_shared<SimpleBVH::BVH>();
+			bvh->init(boxes);
+			element_bvh_ = bvh;
+		}
+
+		return *element_bvh_;
+	}
+
+	void Mesh::locate_points(const Eigen::MatrixXd &points, Eigen::VectorXi &element_ids, Eigen::MatrixXd &coords, const double tol) const
+	{
+		assert(points.cols() == dimension());
+
+		const SimpleBVH::BVH &bvh = element_bvh();
+
+		element_ids.setConstant(points.rows(), -1);
+		coords.setZero(points.rows(), dimension() + 1);
+
+		utils::maybe_parallel_for(points.rows(), [&](int start, int end, int thread_id) {
+			std::vector<unsigned int> candidates;
+			Eigen::MatrixXd bc;
+			for (int i = start; i < end; ++i)
+			{
+				Eigen::Vector3d min = Eigen::Vector3d::Zero(), max = Eigen::Vector3d::Zero();
+				min.head(dimension()) = points.row(i).transpose().array() - tol;
+				max.head(dimension()) = points.row(i).transpose().array() + tol;
+
+				candidates.clear();
+				bvh.intersect_box(min, max, candidates);
+
+				for (const unsigned int cand : candidates)
+				{
+					if (!is_simplex(cand))
+						continue;
+
+					barycentric_coords(points.row(i), cand, bc);
+					for (int d = 0; d < bc.size(); ++d)
+					{
+						if (std::abs(bc(d)) < tol)
+							bc(d) = 0;
+						else if (std::abs(bc(d) - 1) < tol)
+							bc(d) = 1;
+					}
+
+					if (bc.minCoeff() >= 0 && bc.maxCoeff() <= 1)
+					{
+						element_ids(i) = cand;
+						coords.row(i) = bc;
+						break;
+					}
+				}
+			}
+		});
+	}
+
 	void Mesh::append(const Mesh &mesh)
 	{
+		invalidate_element_bvh();
+
 		const int n_vertices = this->n_vertices();
 
 		elements_tag_.insert(elements_tag_.end(), mesh.elements_tag_.begin(), mesh.elements_tag_.end());
@@ -627,6 +694,8 @@ namespace polyfem::mesh
 
 	void Mesh::apply_affine_transformation(const MatrixNd &A, const VectorNd &b)
 	{
+		invalidate_element_bvh();
+
 		for (int i = 0; i < n_vertices(); ++i)
 		{
 			VectorNd p = point(i).transpose();
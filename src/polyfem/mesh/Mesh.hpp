@@ -11,6 +11,11 @@
 
 #include <memory>
 
+namespace SimpleBVH
+{
+	class BVH;
+} // namespace SimpleBVH
+
 namespace polyfem
 {
 	namespace mesh
@@ -82,11 +87,11 @@ namespace polyfem
 			///
 			/// factory to build the proper mesh
 			///
-			/// @param[in] vertices list of vertices
-			/// @param[in] cells list of cells
+			/// @param[in] vertices list of vertices, can be a view of a buffer owned by the caller
+			/// @param[in] cells list of cells, can be a view of a buffer owned by the caller
 			/// @param[in] non_conforming yes or no for non conforming mesh
 			/// @return pointer to the mesh
-			static std::unique_ptr<Mesh> create(const Eigen::MatrixXd &vertices, const Eigen::MatrixXi &cells, const bool non_conforming = false);
+			static std::unique_ptr<Mesh> create(const ConstMatrixXdView &vertices, const ConstMatrixXiView &cells, const bool non_conforming = false);
 
 			///
 			/// factory to build the proper empty mesh
@@ -253,7 +258,7 @@ namespace polyfem
 			/// @param[in] V vertices
 			/// @param[in] F connectivity
 			/// @return if success
-			virtual bool build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F) = 0;
+			virtual bool build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F) = 0;
 
 		public:
 			/// @brief attach high order nodes
@@ -366,6 +371,21 @@ namespace polyfem
 			/// @param[out] coord matrix containing the barycentric coodinates
 			virtual void barycentric_coords(const RowVectorNd &p, const int el_id, Eigen::MatrixXd &coord) const = 0;
 
+			/// @brief BVH of the elements boxes, built on first use and kept until the geometry changes.
+			/// WARNING the first call is not thread safe, call it before a parallel loop
+			///
+			/// @return BVH whose leaves are the elements
+			const SimpleBVH::BVH &element_bvh() const;
+			/// @brief drops the element BVH, to be called after moving the vertices outside of the mesh methods
+			void invalidate_element_bvh() { element_bvh_.reset(); }
+			/// @brief locates a batch of points in the elements, in parallel. WARNING works only for simplices
+			///
+			/// @param[in] points query points, one per row
+			/// @param[out] element_ids element containing every point, -1 if none
+			/// @param[out] coords barycentric coordinates of every point in its element, one per row
+			/// @param[in] tol tolerance on the barycentric coordinates, points on the faces belong to the first element found
+			void locate_points(const Eigen::MatrixXd &points, Eigen::VectorXi &element_ids, Eigen::MatrixXd &coords, const double tol = 1e-8) const;
+
 			/// @brief computes the bbox of the mesh
 			///
 			/// @param[out] min min coodiante
@@ -682,6 +702,9 @@ namespace polyfem
 			Eigen::MatrixXi in_ordered_edges_;
 			/// Order of the input faces, TODO: change to std::vector of Eigen::Vector
 			Eigen::MatrixXi in_ordered_faces_;
+
+			/// BVH of the elements boxes, see element_bvh()
+			mutable std::shared_ptr<const SimpleBVH::BVH> element_bvh_;
 		};
 	} // namespace mesh
 } // namespace polyfem
@@ -604,6 +604,27 @@ namespace polyfem::mesh
 		return res;
 	}
 
+	void MeshNodes::renumber_nodes(const Eigen::VectorXi &old_to_new)
+	{
+		assert(old_to_new.size() == n_nodes());
+
+		for (int &node_id : primitive_to_node_)
+		{
+			if (node_id >= 0)
+				node_id = old_to_new[node_id];
+		}
+
+		std::vector<int> node_to_primitive(n_nodes());
+		std::vector<int> node_to_primitive_gid(n_nodes());
+		for (int i = 0; i < n_nodes(); ++i)
+		{
+			node_to_primitive[old_to_new[i]] = node_to_primitive_[i];
+			node_to_primitive_gid[old_to_new[i]] = node_to_primitive_gid_[i];
+		}
+		node_to_primitive_ = std::move(node_to_primitive);
+		node_to_primitive_gid_ = std::move(node_to_primitive_gid);
+	}
+
 	int MeshNodes::count_nonnegative_nodes(int start_i, int end_i) const
 	{
 		int count = 0;
@@ -79,6 +79,9 @@ namespace polyfem
 			// Retrieve a list of nodes which are marked as boundary
 			std::vector<int> boundary_nodes() const;
 
+			// Renumber the assigned nodes, old_to_new contains the new id of every node
+			void renumber_nodes(const Eigen::VectorXi &old_to_new);
+
 		private:
 			int count_nonnegative_nodes(int start_i, int end_i) const;
 
@@ -572,7 +572,7 @@ namespace
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void polyfem::mesh::to_geogram_mesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, GEO::Mesh &M)
+void polyfem::mesh::to_geogram_mesh(const ConstMatrixXdView &V, const ConstMatrixXiView &F, GEO::Mesh &M)
 {
 	M.clear();
 	// Setup vertices
@@ -91,7 +91,7 @@ namespace polyfem
 		/// @param[in]  F      #F x 3 input mesh surface
 		/// @param[out] M      Output Geogram mesh
 		///
-		void to_geogram_mesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, GEO::Mesh &M);
+		void to_geogram_mesh(const ConstMatrixXdView &V, const ConstMatrixXiView &F, GEO::Mesh &M);
 		// void to_geogram_mesh_3d(const Eigen::MatrixXd &V, const Eigen::MatrixXi &C, GEO::Mesh &M);
 
 		///
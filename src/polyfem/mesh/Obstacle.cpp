@@ -4,6 +4,7 @@
 #include <polyfem/utils/JSONUtils.hpp>
 #include <polyfem/utils/StringUtils.hpp>
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <igl/edges.h>
 #include <ipc/utils/eigen_ext.hpp>
@@ -31,10 +32,12 @@ namespace polyfem
 			in_v_.resize(0);
 
 			displacements_.clear();
+			sequences_.clear();
 
 			endings_.clear();
 
 			planes_.clear();
+			implicit_obstacles_.clear();
 		}
 
 		void Obstacle::append_mesh(
@@ -103,6 +106,7 @@ namespace polyfem
 			append_mesh(vertices, codim_vertices, codim_edges, faces);
 
 			displacements_.emplace_back();
+			sequences_.emplace_back();
 			for (size_t d = 0; d < dim_; ++d)
 			{
 				assert(displacement["value"].is_array());
@@ -133,31 +137,20 @@ namespace polyfem
 
 			append_mesh(vertices[0], codim_vertices, codim_edges, faces);
 
-			std::array<std::vector<Eigen::MatrixXd>, 3> displacements_xyz;
+			// the keyframes are stored contiguously and interpolated in update_sequence_displacement
+			auto sequence = std::make_shared<MeshSequence>();
+			sequence->fps = fps;
+			sequence->frames.resize(vertices[0].size(), vertices.size());
 			for (size_t i = 0; i < vertices.size(); ++i)
 			{
-				Eigen::MatrixXd displacement = vertices[i] - vertices[0];
-				for (size_t d = 0; d < dim_; ++d)
-					displacements_xyz[d].push_back(displacement.col(d));
+				const Eigen::MatrixXd displacement = vertices[i] - vertices[0];
+				sequence->frames.col(i) = displacement.reshaped<Eigen::RowMajor>();
 			}
 
 			displacements_.emplace_back();
 			for (size_t d = 0; d < dim_; ++d)
-			{
-				const std::vector<Eigen::MatrixXd> displacements = displacements_xyz[d];
-				displacements_.back().value[d].init(
-					[displacements, fps](double x, double y, double z, double t, int index) -> double {
-						const double frame = t * fps;
-						const double interp = frame - floor(frame);
-						const int frame0 = (int)floor(frame);
-						const int frame1 = (int)ceil(frame);
-						if (frame1 >= displacements.size())
-							return displacements.back()(index);
-						const double u0 = displacements[frame0](index);
-						const double u1 = displacements[frame1](index);
-						return (u1 - u0) * interp + u0;
-					});
-			}
+				displacements_.back().value[d].init(0.0);
+			sequences_.push_back(sequence);
 		}
 
 		void Obstacle::append_plane(const VectorNd &origin, const VectorNd &normal)
@@ -169,6 +162,11 @@ namespace polyfem
 			planes_.emplace_back(origin.head(dim_), normal.head(dim_).normalized());
 		}
 
+		void Obstacle::append_implicit(const std::shared_ptr<const ImplicitObstacle> &implicit_obstacle)
+		{
+			implicit_obstacles_.push_back(implicit_obstacle);
+		}
+
 		void Obstacle::change_displacement(const int oid, const Eigen::RowVector3d &val, const std::string &interp)
 		{
 			change_displacement(oid, val, interp.empty() ? std::make_shared<NoInterpolation>() : Interpolation::build(interp));
@@ -184,6 +182,7 @@ namespace polyfem
 
 		void Obstacle::change_displacement(const int oid, const Eigen::RowVector3d &val, const std::shared_ptr<Interpolation> &interp)
 		{
+			sequences_[oid].reset();
 			for (size_t k = 0; k < val.size(); ++k)
 				displacements_[oid].value[k].init(val[k]);
 
@@ -193,6 +192,7 @@ namespace polyfem
 
 		void Obstacle::change_displacement(const int oid, const std::function<Eigen::MatrixXd(double x, double y, double z, double t)> &func, const std::shared_ptr<Interpolation> &interp)
 		{
+			sequences_[oid].reset();
 			for (size_t k = 0; k < displacements_.back().value.size(); ++k)
 				displacements_[oid].value[k].init(func, k);
 
@@ -202,6 +202,7 @@ namespace polyfem
 
 		void Obstacle::change_displacement(const int oid, const json &val, const std::shared_ptr<Interpolation> &interp)
 		{
+			sequences_[oid].reset();
 			for (size_t k = 0; k < val.size(); ++k)
 				displacements_[oid].value[k].init(val[k]);
 
@@ -219,23 +220,94 @@ namespace polyfem
 			for (int k = 0; k < endings_.size(); ++k)
 			{
 				const int to = endings_[k];
-				const auto &disp = displacements_[k];
 
-				for (int i = start; i < to; ++i)
-				{
-					for (int d = 0; d < dim_; ++d)
-					{
-						const int sol_row = sol.cols() == 1 ? (offset + i * dim_ + d) : (offset + i);
-						const int sol_col = sol.cols() == 1 ? 0 : d;
-						sol(sol_row, sol_col) = disp.eval(v_.row(i), d, t, i - start);
-					}
-				}
+				if (sequences_[k])
+					update_sequence_displacement(*sequences_[k], t, start, to, offset, sol);
+				else
+					update_value_displacement(displacements_[k], t, start, to, offset, sol);
 
 				start = to;
 			}
 			assert(endings_.empty() || (start * (sol.cols() == 1 ? dim_ : 1) + offset) == sol.rows());
 		}
 
+		void Obstacle::update_sequence_displacement(const MeshSequence &sequence, const double t, const int start, const int end, const int offset, Eigen::MatrixXd &sol) const
+		{
+			const double frame = t * sequence.fps;
+			const double interp = frame - floor(frame);
+			const int frame0 = (int)floor(frame);
+			const int frame1 = (int)ceil(frame);
+
+			const int n = (end - start) * dim_;
+			assert(sequence.frames.rows() == n);
+
+			maybe_parallel_for(n, [&](int chunk_start, int chunk_end, int thread_id) {
+				const int size = chunk_end - chunk_start;
+				Eigen::VectorXd u;
+				if (frame1 >= sequence.frames.cols())
+					u = sequence.frames.col(sequence.frames.cols() - 1).segment(chunk_start, size);
+				else
+					u = (1 - interp) * sequence.frames.col(frame0).segment(chunk_start, size)
+						+ interp * sequence.frames.col(frame1).segment(chunk_start, size);
+
+				// the frames are vertex major, as a flattened solution
+				if (sol.cols() == 1)
+					sol.col(0).segment(offset + start * dim_ + chunk_start, size) = u;
+				else
+					for (int j = 0; j < size; ++j)
+						sol(offset + start + (chunk_start + j) / dim_, (chunk_start + j) % dim_) = u(j);
+			});
+		}
+
+		void Obstacle::update_value_displacement(const assembler::TensorBCValue &disp, const double t, const int start, const int end, const int offset, Eigen::MatrixXd &sol) const
+		{
+			const auto sol_entry = [&](const int i, const int d) -> double & {
+				return sol.cols() == 1 ? sol(offset + i * dim_ + d, 0) : sol(offset + i, d);
+			};
+
+			for (int d = 0; d < dim_; ++d)
+			{
+				const ExpressionValue &value = disp.value[d];
+
+				if (value.is_constant())
+				{
+					// translation, evaluated once for all the vertices
+					const double u = disp.eval(v_.row(start), d, t);
+					for (int i = start; i < end; ++i)
+						sol_entry(i, d) = u;
+				}
+				else if (value.is_expression())
+				{
+					// the same scaling as TensorBCValue::eval
+					double scale = 1;
+					if (disp.interpolation.size() == 1)
+						scale = disp.interpolation[0]->eval(t);
+					else if (!disp.interpolation.empty())
+						scale = disp.interpolation[d]->eval(t);
+
+					maybe_parallel_for(end - start, [&](int chunk_start, int chunk_end, int thread_id) {
+						Eigen::VectorXd u;
+						value(v_.middleRows(start + chunk_start, chunk_end - chunk_start), t, u);
+						for (int j = 0; j < u.size(); ++j)
+							sol_entry(start + chunk_start + j, d) = scale * u(j);
+					});
+				}
+				else if (!value.is_function())
+				{
+					maybe_parallel_for(end - start, [&](int chunk_start, int chunk_end, int thread_id) {
+						for (int i = start + chunk_start; i < start + chunk_end; ++i)
+							sol_entry(i, d) = disp.eval(v_.row(i), d, t, i - start);
+					});
+				}
+				else
+				{
+					// user functions are called serially
+					for (int i = start; i < end; ++i)
+						sol_entry(i, d) = disp.eval(v_.row(i), d, t, i - start);
+				}
+			}
+		}
+
 		void Obstacle::set_zero(Eigen::MatrixXd &sol) const
 		{
 			// NOTE: assumes obstacle displacements is stored at the bottom of sol
@@ -13,6 +13,8 @@ namespace polyfem
 {
 	namespace mesh
 	{
+		class ImplicitObstacle;
+
 		class Obstacle
 		{
 		public:
@@ -32,6 +34,8 @@ namespace polyfem
 				const Eigen::MatrixXi &faces,
 				const int fps);
 			void append_plane(const VectorNd &point, const VectorNd &normal);
+			/// @brief adds a static obstacle represented by its distance function, it is not part of the collision mesh
+			void append_implicit(const std::shared_ptr<const ImplicitObstacle> &implicit_obstacle);
 
 			inline int n_vertices() const { return v_.rows(); }
 			inline int n_edges() const { return e_.rows(); }
@@ -63,6 +67,8 @@ namespace polyfem
 			class Plane;
 			inline const std::vector<Plane> &planes() const { return planes_; };
 
+			inline const std::vector<std::shared_ptr<const ImplicitObstacle>> &implicit_obstacles() const { return implicit_obstacles_; }
+
 			void set_units(const Units &units);
 
 		private:
@@ -72,6 +78,19 @@ namespace polyfem
 				const Eigen::MatrixXi &codim_edges,
 				const Eigen::MatrixXi &faces);
 
+			/// keyframes of an obstacle appended with append_mesh_sequence
+			struct MeshSequence
+			{
+				int fps;
+				/// (#vertices * dim) x #frames, the displacement of every frame is contiguous and vertex major
+				Eigen::MatrixXd frames;
+			};
+
+			/// @brief writes the displacement of the vertices [start, end) of a mesh sequence at time t
+			void update_sequence_displacement(const MeshSequence &sequence, const double t, const int start, const int end, const int offset, Eigen::MatrixXd &sol) const;
+			/// @brief writes the displacement of the vertices [start, end) of an obstacle with displacement disp at time t
+			void update_value_displacement(const assembler::TensorBCValue &disp, const double t, const int start, const int end, const int offset, Eigen::MatrixXd &sol) const;
+
 			int dim_;
 			Eigen::MatrixXd v_;
 			Eigen::VectorXi codim_v_;
@@ -83,10 +102,14 @@ namespace polyfem
 			Eigen::MatrixXi in_e_;
 
 			std::vector<assembler::TensorBCValue> displacements_;
+			/// keyframes of the mesh sequences, aligned with displacements_, null for the other obstacles
+			std::vector<std::shared_ptr<const MeshSequence>> sequences_;
 
 			std::vector<int> endings_;
 
 			std::vector<Plane> planes_;
+
+			std::vector<std::shared_ptr<const ImplicitObstacle>> implicit_obstacles_;
 		};
 
 		class Obstacle::Plane
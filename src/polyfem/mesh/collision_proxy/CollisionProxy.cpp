@@ -5,6 +5,7 @@
 #include <polyfem/mesh/GeometryReader.hpp>
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <SimpleBVH/BVH.hpp>
 #include <igl/edges.h>
@@ -12,12 +13,14 @@
 #include <h5pp/h5pp.h>
 // #include <fcpw/fcpw.h>
 
+#include <filesystem>
+
 namespace polyfem::mesh
 {
 	namespace
 	{
-		template <typename T>
-		using RowMajorMatrixX = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+		/// incremented when the output of build_collision_proxy changes, to invalidate cached proxies
+		constexpr int collision_proxy_cache_version = 1;
 
 		/// @brief Convert from 2D barycentric coordinates (BCs) of a triangle to 3D BCs in a tet.
 		/// @param uv 2D BCs of a triangular face
@@ -94,72 +97,102 @@ namespace polyfem::mesh
 		// • the tessellations of all faces need to be stitched together
 		//   - this means duplicate weights should be removed
 
-		std::vector<double> proxy_vertices_list;
-		std::vector<int> proxy_faces_list;
-		std::vector<Eigen::Triplet<double>> displacement_map_entries_tmp;
+		// flatten the boundary faces so that they can be processed independently
+		std::vector<std::array<int, 2>> boundary_faces; // (element id, local face id)
+		for (const LocalBoundary &local_boundary : total_local_boundary)
+		{
+			if (local_boundary.type() != BoundaryType::TRI)
+				log_and_throw_error("build_collision_proxy() is only implemented for tetrahedra!");
+
+			for (int fi = 0; fi < local_boundary.size(); fi++)
+				boundary_faces.push_back({{local_boundary.element_id(), local_boundary.local_primitive_id(fi)}});
+		}
+		const int n_faces = boundary_faces.size();
 
 		Eigen::MatrixXd UV;
 		Eigen::MatrixXi F_local;
+		std::vector<Eigen::MatrixXd> faces_UV;
+		std::vector<Eigen::MatrixXi> faces_F;
 		if (tessellation == CollisionProxyTessellation::REGULAR)
 		{
 			// TODO: use max_edge_length to determine the tessellation
 			regular_grid_triangle_barycentric_coordinates(/*n=*/10, UV, F_local);
 		}
-
-		for (const LocalBoundary &local_boundary : total_local_boundary)
+		else
 		{
-			if (local_boundary.type() != BoundaryType::TRI)
-				log_and_throw_error("build_collision_proxy() is only implemented for tetrahedra!");
-
-			const basis::ElementBases elm = bases[local_boundary.element_id()];
-			const basis::ElementBases g = geom_bases[local_boundary.element_id()];
-			for (int fi = 0; fi < local_boundary.size(); fi++)
+			// Use the shape of f to determine the tessellation.
+			// NOTE: Triangle is not reentrant, so this is done serially
+			faces_UV.resize(n_faces);
+			faces_F.resize(n_faces);
+			for (int f = 0; f < n_faces; f++)
 			{
-				const int local_fid = local_boundary.local_primitive_id(fi);
+				const auto [element_id, local_fid] = boundary_faces[f];
+				const Eigen::MatrixXd node_positions = extract_face_vertices(geom_bases[element_id], local_fid);
+				irregular_triangle_barycentric_coordinates(
+					node_positions.row(0), node_positions.row(1), node_positions.row(2),
+					max_edge_length, faces_UV[f], faces_F[f]);
+			}
+		}
 
-				if (tessellation == CollisionProxyTessellation::IRREGULAR)
-				{
-					// Use the shape of f to determine the tessellation
-					const Eigen::MatrixXd node_positions = extract_face_vertices(g, local_fid);
-					irregular_triangle_barycentric_coordinates(
-						node_positions.row(0), node_positions.row(1), node_positions.row(2),
-						max_edge_length, UV, F_local);
-				}
+		// map the tessellation of each face and evaluate the bases at its nodes,
+		// the rows of the weights are local to the face
+		std::vector<Eigen::MatrixXd> faces_V(n_faces);
+		std::vector<std::vector<Eigen::Triplet<double>>> faces_W(n_faces);
+		utils::maybe_parallel_for(n_faces, [&](int start, int end, int thread_id) {
+			for (int f = start; f < end; f++)
+			{
+				const auto [element_id, local_fid] = boundary_faces[f];
+				const basis::ElementBases &elm = bases[element_id];
+				const basis::ElementBases &g = geom_bases[element_id];
 
 				// Convert UV to appropirate UVW based on the local face id
-				Eigen::MatrixXd UVW = uv_to_uvw(UV, local_fid);
+				const Eigen::MatrixXd UVW = uv_to_uvw(faces_UV.empty() ? UV : faces_UV[f], local_fid);
 
-				Eigen::MatrixXd V_local;
-				g.eval_geom_mapping(UVW, V_local);
-				assert(V_local.rows() == UV.rows());
-
-				const int offset = proxy_vertices_list.size() / dim;
-				for (const double x : V_local.reshaped<Eigen::RowMajor>())
-					proxy_vertices_list.push_back(x);
-				for (const int i : F_local.reshaped<Eigen::RowMajor>())
-					proxy_faces_list.push_back(i + offset);
+				g.eval_geom_mapping(UVW, faces_V[f]);
+				assert(faces_V[f].rows() == UVW.rows());
 
+				faces_W[f].reserve(elm.bases.size() * UVW.rows());
 				for (const basis::Basis &basis : elm.bases)
 				{
 					assert(basis.global().size() == 1);
 					const int basis_id = basis.global()[0].index;
 
+					// all the nodes of the face are evaluated at once
 					const Eigen::MatrixXd basis_values = basis(UVW);
 
 					for (int i = 0; i < basis_values.size(); i++)
-					{
-						displacement_map_entries_tmp.emplace_back(
-							offset + i, basis_id, basis_values(i));
-					}
+						faces_W[f].emplace_back(i, basis_id, basis_values(i));
 				}
 			}
+		});
+
+		// concatenate the faces in order, so the result does not depend on the number of threads
+		std::vector<int> vertex_offsets(n_faces + 1, 0), face_offsets(n_faces + 1, 0);
+		size_t n_entries = 0;
+		for (int f = 0; f < n_faces; f++)
+		{
+			vertex_offsets[f + 1] = vertex_offsets[f] + faces_V[f].rows();
+			face_offsets[f + 1] = face_offsets[f] + (faces_F.empty() ? F_local : faces_F[f]).rows();
+			n_entries += faces_W[f].size();
+		}
+
+		Eigen::MatrixXd V_tmp(vertex_offsets.back(), dim);
+		Eigen::MatrixXi F_tmp(face_offsets.back(), dim);
+		std::vector<Eigen::Triplet<double>> displacement_map_entries_tmp;
+		displacement_map_entries_tmp.reserve(n_entries);
+		for (int f = 0; f < n_faces; f++)
+		{
+			const int offset = vertex_offsets[f];
+			V_tmp.middleRows(offset, faces_V[f].rows()) = faces_V[f];
+			F_tmp.middleRows(face_offsets[f], face_offsets[f + 1] - face_offsets[f]) =
+				(faces_F.empty() ? F_local : faces_F[f]).array() + offset;
+			for (const Eigen::Triplet<double> &w : faces_W[f])
+				displacement_map_entries_tmp.emplace_back(offset + w.row(), w.col(), w.value());
 		}
 
 		// stitch collision proxy together
 		stitch_mesh(
-			Eigen::Map<RowMajorMatrixX<double>>(proxy_vertices_list.data(), proxy_vertices_list.size() / dim, dim),
-			Eigen::Map<RowMajorMatrixX<int>>(proxy_faces_list.data(), proxy_faces_list.size() / dim, dim),
-			displacement_map_entries_tmp,
+			V_tmp, F_tmp, displacement_map_entries_tmp,
 			proxy_vertices, proxy_faces, displacement_map_entries);
 	}
 
@@ -245,69 +278,99 @@ namespace polyfem::mesh
 
 		// --------------------------------------------------------------------
 
-		for (int i = 0; i < proxy_vertices.rows(); i++)
-		{
-			Eigen::Vector3d v = Eigen::Vector3d::Zero();
-			v.head(dim) = proxy_vertices.row(i);
-
+		// find which element each proxy vertex belongs to
+		std::vector<int> vertex_elements(proxy_vertices.rows(), -1);
+		Eigen::MatrixXd vertex_vhats(proxy_vertices.rows(), dim);
+		utils::maybe_parallel_for(proxy_vertices.rows(), [&](int start, int end, int thread_id) {
 			std::vector<unsigned int> candidates;
-			bvh.intersect_box(v, v, candidates);
-
-			// find which element the proxy vertex belongs to
-			int closest_element_id = -1;
-			VectorNd vhat;
-			for (const unsigned int element_id : candidates)
+			for (int i = start; i < end; i++)
 			{
-				const Eigen::MatrixXd nodes = geom_bases[element_id].nodes();
-				if (dim == 2)
-				{
-					assert(nodes.rows() == 3);
-					Eigen::RowVector3d bc;
-					igl::barycentric_coordinates(
-						proxy_vertices.row(i), nodes.row(0), nodes.row(1), nodes.row(2), bc);
-					vhat = bc.head<2>();
-				}
-				else
-				{
-					assert(dim == 3 && nodes.rows() == 4);
-					Eigen::RowVector4d bc;
-					igl::barycentric_coordinates(
-						proxy_vertices.row(i), nodes.row(0), nodes.row(1), nodes.row(2), nodes.row(3), bc);
-					vhat = bc.head<3>();
-				}
-				if (vhat.minCoeff() >= 0 && vhat.maxCoeff() <= 1 && vhat.sum() <= 1)
+				Eigen::Vector3d v = Eigen::Vector3d::Zero();
+				v.head(dim) = proxy_vertices.row(i);
+
+				candidates.clear();
+				bvh.intersect_box(v, v, candidates);
+
+				for (const unsigned int element_id : candidates)
 				{
-					closest_element_id = element_id;
-					break;
+					const Eigen::MatrixXd nodes = geom_bases[element_id].nodes();
+					VectorNd vhat;
+					if (dim == 2)
+					{
+						assert(nodes.rows() == 3);
+						Eigen::RowVector3d bc;
+						igl::barycentric_coordinates(
+							proxy_vertices.row(i), nodes.row(0), nodes.row(1), nodes.row(2), bc);
+						vhat = bc.head<2>();
+					}
+					else
+					{
+						assert(dim == 3 && nodes.rows() == 4);
+						Eigen::RowVector4d bc;
+						igl::barycentric_coordinates(
+							proxy_vertices.row(i), nodes.row(0), nodes.row(1), nodes.row(2), nodes.row(3), bc);
+						vhat = bc.head<3>();
+					}
+					if (vhat.minCoeff() >= 0 && vhat.maxCoeff() <= 1 && vhat.sum() <= 1)
+					{
+						vertex_elements[i] = element_id;
+						vertex_vhats.row(i) = vhat.transpose();
+						break;
+					}
 				}
 			}
+		});
 
-			if (closest_element_id < 0)
-			{
-				// perform a closest point query
-				log_and_throw_error("build_collision_proxy_displacement_map(): closest point query not implemented!");
-				// fcpw::Interaction<3> cpq_interaction;
-				// scene.findClosestPoint(v.cast<float>(), cpq_interaction);
+		if (std::find(vertex_elements.begin(), vertex_elements.end(), -1) != vertex_elements.end())
+		{
+			// perform a closest point query
+			log_and_throw_error("build_collision_proxy_displacement_map(): closest point query not implemented!");
+			// fcpw::Interaction<3> cpq_interaction;
+			// scene.findClosestPoint(v.cast<float>(), cpq_interaction);
 
-				// closest_element_id = cpq_interaction.primitiveIndex / 4;
+			// closest_element_id = cpq_interaction.primitiveIndex / 4;
 
-				// const Eigen::MatrixXd nodes = geom_bases[closest_element_id].nodes();
+			// const Eigen::MatrixXd nodes = geom_bases[closest_element_id].nodes();
 
-				// assert(dim == 3 && nodes.rows() == 4);
-				// Eigen::RowVector4d bc;
-				// igl::barycentric_coordinates(
-				// 	proxy_vertices.row(i), nodes.row(0), nodes.row(1), nodes.row(2), nodes.row(3), bc);
-				// vhat = bc.head<3>();
-			}
+			// assert(dim == 3 && nodes.rows() == 4);
+			// Eigen::RowVector4d bc;
+			// igl::barycentric_coordinates(
+			// 	proxy_vertices.row(i), nodes.row(0), nodes.row(1), nodes.row(2), nodes.row(3), bc);
+			// vhat = bc.head<3>();
+		}
+
+		// --------------------------------------------------------------------
+		// compute the displacement map entries, the entries of vertex i start at entry_offsets[i]
 
-			// compute the displacement map entries
-			for (const basis::Basis &basis : bases[closest_element_id].bases)
+		std::vector<size_t> entry_offsets(proxy_vertices.rows() + 1, displacement_map_entries.size());
+		std::vector<std::vector<int>> element_vertices(geom_bases.size());
+		for (int i = 0; i < proxy_vertices.rows(); i++)
+		{
+			entry_offsets[i + 1] = entry_offsets[i] + bases[vertex_elements[i]].bases.size();
+			element_vertices[vertex_elements[i]].push_back(i);
+		}
+		displacement_map_entries.resize(entry_offsets.back());
+
+		// the bases of an element are evaluated at all its proxy vertices at once
+		utils::maybe_parallel_for(element_vertices.size(), [&](int start, int end, int thread_id) {
+			for (int e = start; e < end; e++)
 			{
-				assert(basis.global().size() == 1);
-				const int j = basis.global()[0].index;
-				displacement_map_entries.emplace_back(i, j, basis(vhat.transpose())(0));
+				const std::vector<int> &vids = element_vertices[e];
+				if (vids.empty())
+					continue;
+
+				const Eigen::MatrixXd vhats = vertex_vhats(vids, Eigen::all);
+				const std::vector<basis::Basis> &element_bases = bases[e].bases;
+				for (int b = 0; b < element_bases.size(); b++)
+				{
+					assert(element_bases[b].global().size() == 1);
+					const int j = element_bases[b].global()[0].index;
+					const Eigen::MatrixXd values = element_bases[b](vhats);
+					for (int k = 0; k < vids.size(); k++)
+						displacement_map_entries[entry_offsets[vids[k]] + b] = Eigen::Triplet<double>(vids[k], j, values(k));
+				}
 			}
-		}
+		});
 	}
 
 	// ========================================================================
@@ -391,4 +454,108 @@ namespace polyfem::mesh
 			displacement_map_entries.emplace_back(rows[i], in_node_to_node[cols[i]], values[i]);
 		}
 	}
-} // namespace polyfem::mesh
\ No newline at end of file
+
+	// ========================================================================
+
+	std::string collision_proxy_hash(
+		const std::vector<basis::ElementBases> &bases,
+		const std::vector<basis::ElementBases> &geom_bases,
+		const std::vector<mesh::LocalBoundary> &total_local_boundary,
+		const double max_edge_length,
+		const CollisionProxyTessellation tessellation)
+	{
+		// 64-bit FNV-1a, stable across platforms and runs
+		uint64_t hash = 0xcbf29ce484222325ull;
+		const auto hash_bytes = [&hash](const void *data, const size_t size) {
+			const unsigned char *bytes = static_cast<const unsigned char *>(data);
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 0x100000001b3ull;
+			}
+		};
+		const auto hash_value = [&hash_bytes](const auto value) { hash_bytes(&value, sizeof(value)); };
+
+		hash_value(collision_proxy_cache_version);
+		hash_value(max_edge_length);
+		hash_value(int(tessellation));
+
+		for (const LocalBoundary &local_boundary : total_local_boundary)
+		{
+			const int element_id = local_boundary.element_id();
+			hash_value(element_id);
+			for (int fi = 0; fi < local_boundary.size(); fi++)
+				hash_value(local_boundary.local_primitive_id(fi));
+
+			const Eigen::MatrixXd nodes = geom_bases[element_id].nodes();
+			hash_bytes(nodes.data(), nodes.size() * sizeof(double));
+
+			for (const basis::Basis &basis : bases[element_id].bases)
+			{
+				hash_value(basis.order());
+				for (const basis::Local2Global &g : basis.global())
+				{
+					hash_value(g.index);
+					hash_value(g.val);
+				}
+			}
+		}
+
+		return fmt::format("{:016x}", hash);
+	}
+
+	void save_collision_proxy(
+		const std::string &filename,
+		const std::string &hash,
+		const int num_fe_nodes,
+		const Eigen::MatrixXd &vertices,
+		const Eigen::MatrixXi &faces,
+		const std::vector<Eigen::Triplet<double>> &displacement_map_entries)
+	{
+		Eigen::VectorXd values(displacement_map_entries.size());
+		Eigen::VectorXi rows(displacement_map_entries.size()), cols(displacement_map_entries.size());
+		for (int i = 0; i < displacement_map_entries.size(); i++)
+		{
+			values[i] = displacement_map_entries[i].value();
+			rows[i] = displacement_map_entries[i].row();
+			cols[i] = displacement_map_entries[i].col();
+		}
+
+		h5pp::File file(filename, h5pp::FileAccess::REPLACE);
+		file.writeDataset(hash, "hash");
+		file.writeDataset(vertices, "vertices");
+		file.writeDataset(faces, "faces");
+		file.writeDataset(values, "weight_triplets/values");
+		file.writeDataset(rows, "weight_triplets/rows");
+		file.writeDataset(cols, "weight_triplets/cols");
+		file.writeAttribute(std::array<long, 2>{{long(vertices.rows()), long(num_fe_nodes)}}, "weight_triplets", "shape");
+	}
+
+	bool load_cached_collision_proxy(
+		const std::string &filename,
+		const std::string &hash,
+		const int num_fe_nodes,
+		Eigen::MatrixXd &vertices,
+		Eigen::MatrixXi &faces,
+		std::vector<Eigen::Triplet<double>> &displacement_map_entries)
+	{
+		if (!std::filesystem::exists(filename))
+			return false;
+
+		{
+			h5pp::File file(filename, h5pp::FileAccess::READONLY);
+			if (!file.linkExists("hash") || file.readDataset<std::string>("hash") != hash)
+				return false;
+
+			vertices = file.readDataset<Eigen::MatrixXd>("vertices");
+			faces = file.readDataset<Eigen::MatrixXi>("faces");
+		}
+
+		// the columns are saved in node order
+		load_collision_proxy_displacement_map(
+			filename, Eigen::VectorXi::LinSpaced(num_fe_nodes, 0, num_fe_nodes - 1),
+			vertices.rows(), displacement_map_entries);
+
+		return true;
+	}
+} // namespace polyfem::mesh
@@ -106,4 +106,50 @@ namespace polyfem::mesh
 		const Eigen::VectorXi &in_node_to_node,
 		const size_t num_proxy_vertices,
 		std::vector<Eigen::Triplet<double>> &displacement_map_entries);
+
+	/// @brief Hash of the inputs of build_collision_proxy, used to key a cached collision proxy.
+	/// @param[in] bases Bases for elements
+	/// @param[in] geom_bases Geometry bases for elements
+	/// @param[in] total_local_boundary Local boundaries for elements
+	/// @param[in] max_edge_length Maximum edge length of the proxy mesh
+	/// @param[in] tessellation Type of tessellation to use
+	/// @return Hexadecimal hash of the boundary elements and the tessellation parameters
+	std::string collision_proxy_hash(
+		const std::vector<basis::ElementBases> &bases,
+		const std::vector<basis::ElementBases> &geom_bases,
+		const std::vector<mesh::LocalBoundary> &total_local_boundary,
+		const double max_edge_length,
+		const CollisionProxyTessellation tessellation);
+
+	/// @brief Save a built collision proxy to an HDF5 file. The displacement map is stored in the
+	/// format read by load_collision_proxy_displacement_map with the columns in node order.
+	/// @param[in] filename HDF5 filename
+	/// @param[in] hash Hash of the inputs (see collision_proxy_hash)
+	/// @param[in] num_fe_nodes Number of FE nodes (columns of the displacement map)
+	/// @param[in] vertices Vertices of the proxy mesh
+	/// @param[in] faces Faces of the proxy mesh
+	/// @param[in] displacement_map_entries Displacement map entries
+	void save_collision_proxy(
+		const std::string &filename,
+		const std::string &hash,
+		const int num_fe_nodes,
+		const Eigen::MatrixXd &vertices,
+		const Eigen::MatrixXi &faces,
+		const std::vector<Eigen::Triplet<double>> &displacement_map_entries);
+
+	/// @brief Load a collision proxy saved with save_collision_proxy.
+	/// @param[in] filename HDF5 filename
+	/// @param[in] hash Expected hash of the inputs (see collision_proxy_hash)
+	/// @param[in] num_fe_nodes Number of FE nodes (columns of the displacement map)
+	/// @param[out] vertices Output vertices of the proxy mesh
+	/// @param[out] faces Output faces of the proxy mesh
+	/// @param[out] displacement_map_entries Output displacement map entries
+	/// @return False if the file does not exist or was saved for different inputs
+	bool load_cached_collision_proxy(
+		const std::string &filename,
+		const std::string &hash,
+		const int num_fe_nodes,
+		Eigen::MatrixXd &vertices,
+		Eigen::MatrixXi &faces,
+		std::vector<Eigen::Triplet<double>> &displacement_map_entries);
 } // namespace polyfem::mesh
\ No newline at end of file
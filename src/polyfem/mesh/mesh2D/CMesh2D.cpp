@@ -24,6 +24,8 @@ namespace polyfem
 	{
 		void CMesh2D::refine(const int n_refinement, const double t)
 		{
+			invalidate_element_bvh();
+
 			// return;
 			if (n_refinement <= 0)
 			{
@@ -95,6 +97,8 @@ namespace polyfem
 
 		bool CMesh2D::load(const std::string &path)
 		{
+			invalidate_element_bvh();
+
 			// This method should be used for special loading, like hybrid in 3d
 
 			// edge_nodes_.clear();
@@ -141,6 +145,8 @@ namespace polyfem
 
 		bool CMesh2D::load(const GEO::Mesh &mesh)
 		{
+			invalidate_element_bvh();
+
 			edge_nodes_.clear();
 			face_nodes_.clear();
 			cell_nodes_.clear();
@@ -170,8 +176,10 @@ namespace polyfem
 			return true;
 		}
 
-		bool CMesh2D::build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F)
+		bool CMesh2D::build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F)
 		{
+			invalidate_element_bvh();
+
 			edge_nodes_.clear();
 			face_nodes_.clear();
 			cell_nodes_.clear();
@@ -412,6 +420,7 @@ namespace polyfem
 
 		void CMesh2D::normalize()
 		{
+			invalidate_element_bvh();
 
 			GEO::vec3 min_corner, max_corner;
 			GEO::get_bbox(mesh_, &min_corner[0], &max_corner[0]);
@@ -465,6 +474,8 @@ namespace polyfem
 
 		void CMesh2D::set_point(const int global_index, const RowVectorNd &p)
 		{
+			invalidate_element_bvh();
+
 			mesh_.vertices.point(global_index).x = p(0);
 			mesh_.vertices.point(global_index).y = p(1);
 		}
@@ -22,6 +22,8 @@ namespace polyfem
 
 		void NCMesh2D::refine(const int n_refinement, const double t)
 		{
+			invalidate_element_bvh();
+
 			if (n_refinement <= 0)
 				return;
 			std::vector<bool> refine_mask(elements.size(), false);
@@ -36,8 +38,10 @@ namespace polyfem
 			refine(n_refinement - 1, t);
 		}
 
-		bool NCMesh2D::build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F)
+		bool NCMesh2D::build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F)
 		{
+			invalidate_element_bvh();
+
 			GEO::Mesh mesh_;
 			mesh_.clear(false, false);
 			to_geogram_mesh(V, F, mesh_);
@@ -547,12 +551,16 @@ namespace polyfem
 
 		bool NCMesh2D::load(const std::string &path)
 		{
+			invalidate_element_bvh();
+
 			assert(false);
 			return false;
 		}
 
 		bool NCMesh2D::load(const GEO::Mesh &mesh)
 		{
+			invalidate_element_bvh();
+
 			GEO::Mesh mesh_;
 			mesh_.clear(false, false);
 			mesh_.copy(mesh);
@@ -682,6 +690,8 @@ namespace polyfem
 
 		void NCMesh2D::normalize()
 		{
+			invalidate_element_bvh();
+
 			polyfem::RowVectorNd min, max;
 			bounding_box(min, max);
 
@@ -711,6 +721,8 @@ namespace polyfem
 
 		void NCMesh2D::set_point(const int global_index, const RowVectorNd &p)
 		{
+			invalidate_element_bvh();
+
 			vertices[valid_to_all_vertex(global_index)].pos = p;
 		}
 
@@ -227,7 +227,7 @@ namespace polyfem
 				return false;
 			}
 
-			bool build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F) override;
+			bool build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F) override;
 
 			void attach_higher_order_nodes(const Eigen::MatrixXd &V, const std::vector<std::vector<int>> &nodes) override;
 			RowVectorNd edge_node(const Navigation::Index &index, const int n_new_nodes, const int i) const override;
@@ -2,6 +2,7 @@
 #include <polyfem/mesh/mesh3D/MeshProcessing3D.hpp>
 #include <polyfem/mesh/MeshUtils.hpp>
 #include <polyfem/utils/StringUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <polyfem/utils/Logger.hpp>
 
@@ -18,6 +19,8 @@ namespace polyfem
 	{
 		void CMesh3D::refine(const int n_refinement, const double t)
 		{
+			invalidate_element_bvh();
+
 			if (n_refinement <= 0)
 			{
 				return;
@@ -79,6 +82,8 @@ namespace polyfem
 
 		bool CMesh3D::load(const std::string &path)
 		{
+			invalidate_element_bvh();
+
 			edge_nodes_.clear();
 			face_nodes_.clear();
 			cell_nodes_.clear();
@@ -203,6 +208,8 @@ namespace polyfem
 		// if loading a surface mesh, it assumes there is only one polyhedral cell, and the last vertex id a point in the kernel
 		bool CMesh3D::load(const GEO::Mesh &M)
 		{
+			invalidate_element_bvh();
+
 			edge_nodes_.clear();
 			face_nodes_.clear();
 			cell_nodes_.clear();
@@ -466,8 +473,10 @@ namespace polyfem
 			return true;
 		}
 
-		bool CMesh3D::build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F)
+		bool CMesh3D::build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F)
 		{
+			invalidate_element_bvh();
+
 			assert(F.cols() == 4 || F.cols() == 8);
 			edge_nodes_.clear();
 			face_nodes_.clear();
@@ -1010,6 +1019,8 @@ namespace polyfem
 
 		void CMesh3D::normalize()
 		{
+			invalidate_element_bvh();
+
 			RowVectorNd minV, maxV;
 			bounding_box(minV, maxV);
 			auto &V = mesh_.points;
@@ -1316,6 +1327,8 @@ namespace polyfem
 
 		void CMesh3D::set_point(const int global_index, const RowVectorNd &p)
 		{
+			invalidate_element_bvh();
+
 			mesh_.points.col(global_index) = p.transpose();
 			if (mesh_.vertices[global_index].v.size() == 3)
 			{
@@ -1349,7 +1362,7 @@ namespace polyfem
 
 			// boundary flags
 			std::vector<bool> bv_flag(mesh_.vertices.size(), false), be_flag(mesh_.edges.size(), false), bf_flag(mesh_.faces.size(), false);
-			for (auto f : mesh_.faces)
+			for (const auto &f : mesh_.faces)
 				if (f.boundary)
 					bf_flag[f.id] = true;
 				else
@@ -1367,170 +1380,173 @@ namespace polyfem
 						bv_flag[mesh_.faces[i].vs[j]] = true;
 					}
 
-			for (auto &ele : mesh_.elements)
-			{
-				if (ele.hex)
+			utils::maybe_parallel_for(mesh_.elements.size(), [&](int start, int end, int thread_id) {
+				for (int e = start; e < end; ++e)
 				{
-					bool attaching_non_hex = false, on_boundary = false;
-					;
-					for (auto vid : ele.vs)
+					const auto &ele = mesh_.elements[e];
+					if (ele.hex)
 					{
-						for (auto eleid : mesh_.vertices[vid].neighbor_hs)
-							if (!mesh_.elements[eleid].hex)
+						bool attaching_non_hex = false, on_boundary = false;
+						;
+						for (auto vid : ele.vs)
+						{
+							for (auto eleid : mesh_.vertices[vid].neighbor_hs)
+								if (!mesh_.elements[eleid].hex)
+								{
+									attaching_non_hex = true;
+									break;
+								}
+							if (mesh_.vertices[vid].boundary)
 							{
-								attaching_non_hex = true;
+								on_boundary = true;
 								break;
 							}
-						if (mesh_.vertices[vid].boundary)
+							if (on_boundary || attaching_non_hex)
+								break;
+						}
+						if (attaching_non_hex)
 						{
-							on_boundary = true;
-							break;
+							ele_tag[ele.id] = ElementType::INTERFACE_CUBE;
+							continue;
 						}
-						if (on_boundary || attaching_non_hex)
-							break;
-					}
-					if (attaching_non_hex)
-					{
-						ele_tag[ele.id] = ElementType::INTERFACE_CUBE;
-						continue;
-					}
 
-					if (on_boundary)
-					{
-						ele_tag[ele.id] = ElementType::MULTI_SINGULAR_BOUNDARY_CUBE;
-						// has no boundary edge--> singular
-						bool boundary_edge = false, boundary_edge_singular = false, interior_edge_singular = false;
-						int n_interior_edge_singular = 0;
-						for (auto eid : ele.es)
+						if (on_boundary)
 						{
-							int en = 0;
-							if (be_flag[eid])
-							{
-								boundary_edge = true;
-								for (auto nhid : mesh_.edges[eid].neighbor_hs)
-									if (mesh_.elements[nhid].hex)
-										en++;
-								if (en > 2)
-									boundary_edge_singular = true;
-							}
-							else
+							ele_tag[ele.id] = ElementType::MULTI_SINGULAR_BOUNDARY_CUBE;
+							// has no boundary edge--> singular
+							bool boundary_edge = false, boundary_edge_singular = false, interior_edge_singular = false;
+							int n_interior_edge_singular = 0;
+							for (auto eid : ele.es)
 							{
-								for (auto nhid : mesh_.edges[eid].neighbor_hs)
-									if (mesh_.elements[nhid].hex)
-										en++;
-								if (en != 4)
+								int en = 0;
+								if (be_flag[eid])
+								{
+									boundary_edge = true;
+									for (auto nhid : mesh_.edges[eid].neighbor_hs)
+										if (mesh_.elements[nhid].hex)
+											en++;
+									if (en > 2)
+										boundary_edge_singular = true;
+								}
+								else
 								{
-									interior_edge_singular = true;
-									n_interior_edge_singular++;
+									for (auto nhid : mesh_.edges[eid].neighbor_hs)
+										if (mesh_.elements[nhid].hex)
+											en++;
+									if (en != 4)
+									{
+										interior_edge_singular = true;
+										n_interior_edge_singular++;
+									}
 								}
 							}
-						}
-						if (!boundary_edge || boundary_edge_singular || n_interior_edge_singular > 1)
-							continue;
+							if (!boundary_edge || boundary_edge_singular || n_interior_edge_singular > 1)
+								continue;
 
-						bool has_singular_v = false, has_iregular_v = false;
-						int n_in_irregular_v = 0;
-						for (auto vid : ele.vs)
-						{
-							int vn = 0;
-							if (bv_flag[vid])
+							bool has_singular_v = false, has_iregular_v = false;
+							int n_in_irregular_v = 0;
+							for (auto vid : ele.vs)
 							{
-								int nh = 0;
-								for (auto nhid : mesh_.vertices[vid].neighbor_hs)
-									if (mesh_.elements[nhid].hex)
-										nh++;
-								if (nh > 4)
-									has_iregular_v = true;
-								continue; // not sure the conditions
-							}
-							else
-							{
-								if (mesh_.vertices[vid].neighbor_hs.size() != 8)
-									n_in_irregular_v++;
-								int n_irregular_e = 0;
-								for (auto eid : mesh_.vertices[vid].neighbor_es)
+								int vn = 0;
+								if (bv_flag[vid])
 								{
-									if (mesh_.edges[eid].neighbor_hs.size() != 4)
-										n_irregular_e++;
+									int nh = 0;
+									for (auto nhid : mesh_.vertices[vid].neighbor_hs)
+										if (mesh_.elements[nhid].hex)
+											nh++;
+									if (nh > 4)
+										has_iregular_v = true;
+									continue; // not sure the conditions
 								}
-								if (n_irregular_e != 0 && n_irregular_e != 2)
+								else
 								{
-									has_singular_v = true;
-									break;
+									if (mesh_.vertices[vid].neighbor_hs.size() != 8)
+										n_in_irregular_v++;
+									int n_irregular_e = 0;
+									for (auto eid : mesh_.vertices[vid].neighbor_es)
+									{
+										if (mesh_.edges[eid].neighbor_hs.size() != 4)
+											n_irregular_e++;
+									}
+									if (n_irregular_e != 0 && n_irregular_e != 2)
+									{
+										has_singular_v = true;
+										break;
+									}
 								}
 							}
-						}
-						int n_irregular_e = 0;
-						for (auto eid : ele.es)
-							if (!be_flag[eid] && mesh_.edges[eid].neighbor_hs.size() != 4)
-								n_irregular_e++;
-						if (has_singular_v)
-							continue;
-						if (!has_singular_v)
-						{
-							if (n_irregular_e == 1)
+							int n_irregular_e = 0;
+							for (auto eid : ele.es)
+								if (!be_flag[eid] && mesh_.edges[eid].neighbor_hs.size() != 4)
+									n_irregular_e++;
+							if (has_singular_v)
+								continue;
+							if (!has_singular_v)
 							{
-								ele_tag[ele.id] = ElementType::SIMPLE_SINGULAR_BOUNDARY_CUBE;
+								if (n_irregular_e == 1)
+								{
+									ele_tag[ele.id] = ElementType::SIMPLE_SINGULAR_BOUNDARY_CUBE;
+								}
+								else if (n_irregular_e == 0 && n_in_irregular_v == 0 && !has_iregular_v)
+									ele_tag[ele.id] = ElementType::REGULAR_BOUNDARY_CUBE;
+								else
+									continue;
 							}
-							else if (n_irregular_e == 0 && n_in_irregular_v == 0 && !has_iregular_v)
-								ele_tag[ele.id] = ElementType::REGULAR_BOUNDARY_CUBE;
-							else
-								continue;
+							continue;
 						}
-						continue;
-					}
 
-					// type 1
-					bool has_irregular_v = false;
-					for (auto vid : ele.vs)
-						if (mesh_.vertices[vid].neighbor_hs.size() != 8)
+						// type 1
+						bool has_irregular_v = false;
+						for (auto vid : ele.vs)
+							if (mesh_.vertices[vid].neighbor_hs.size() != 8)
+							{
+								has_irregular_v = true;
+								break;
+							}
+						if (!has_irregular_v)
 						{
-							has_irregular_v = true;
-							break;
+							ele_tag[ele.id] = ElementType::REGULAR_INTERIOR_CUBE;
+							continue;
 						}
-					if (!has_irregular_v)
-					{
-						ele_tag[ele.id] = ElementType::REGULAR_INTERIOR_CUBE;
-						continue;
-					}
-					// type 2
-					bool has_singular_v = false;
-					int n_irregular_v = 0;
-					for (auto vid : ele.vs)
-					{
-						if (mesh_.vertices[vid].neighbor_hs.size() != 8)
-							n_irregular_v++;
-						int n_irregular_e = 0;
-						for (auto eid : mesh_.vertices[vid].neighbor_es)
+						// type 2
+						bool has_singular_v = false;
+						int n_irregular_v = 0;
+						for (auto vid : ele.vs)
 						{
-							if (mesh_.edges[eid].neighbor_hs.size() != 4)
-								n_irregular_e++;
+							if (mesh_.vertices[vid].neighbor_hs.size() != 8)
+								n_irregular_v++;
+							int n_irregular_e = 0;
+							for (auto eid : mesh_.vertices[vid].neighbor_es)
+							{
+								if (mesh_.edges[eid].neighbor_hs.size() != 4)
+									n_irregular_e++;
+							}
+							if (n_irregular_e != 0 && n_irregular_e != 2)
+							{
+								has_singular_v = true;
+								break;
+							}
 						}
-						if (n_irregular_e != 0 && n_irregular_e != 2)
+						if (!has_singular_v && n_irregular_v == 2)
 						{
-							has_singular_v = true;
-							break;
+							ele_tag[ele.id] = ElementType::SIMPLE_SINGULAR_INTERIOR_CUBE;
+							continue;
 						}
+
+						ele_tag[ele.id] = ElementType::MULTI_SINGULAR_INTERIOR_CUBE;
 					}
-					if (!has_singular_v && n_irregular_v == 2)
+					else
 					{
-						ele_tag[ele.id] = ElementType::SIMPLE_SINGULAR_INTERIOR_CUBE;
-						continue;
+						ele_tag[ele.id] = ElementType::INTERIOR_POLYTOPE;
+						for (auto fid : ele.fs)
+							if (mesh_.faces[fid].boundary)
+							{
+								ele_tag[ele.id] = ElementType::BOUNDARY_POLYTOPE;
+								break;
+							}
 					}
-
-					ele_tag[ele.id] = ElementType::MULTI_SINGULAR_INTERIOR_CUBE;
 				}
-				else
-				{
-					ele_tag[ele.id] = ElementType::INTERIOR_POLYTOPE;
-					for (auto fid : ele.fs)
-						if (mesh_.faces[fid].boundary)
-						{
-							ele_tag[ele.id] = ElementType::BOUNDARY_POLYTOPE;
-							break;
-						}
-				}
-			}
+			});
 
 			// TODO correct?
 			for (auto &ele : mesh_.elements)
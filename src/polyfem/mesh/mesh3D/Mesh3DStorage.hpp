@@ -75,6 +75,27 @@ namespace polyfem
 			Eigen::MatrixXi FV, FE, FH, FHi; // FV (3, nf), FE(3, nf), FH (2, nf), FHi(2, nf)
 			Eigen::MatrixXi HV, HF;          // HV(4, nh), HE(6, nh), HF(4, nh)
 
+			// half-face adjacency of the non-tet meshes, built by Navigation3D::prepare_mesh.
+			// A half-face is a face of an element, numbered element by element; an edge slot is an edge of a half-face, numbered half-face by half-face.
+			std::vector<int> element_half_faces; // first half-face of every element, n_elements + 1 entries
+			std::vector<int> half_face_element;  // element of every half-face
+			std::vector<int> half_face_opposite; // same face in the neighboring element, -1 on the boundary
+			std::vector<int> half_face_edges;    // first edge slot of every half-face, n_half_faces + 1 entries
+			std::vector<int> edge_slot_face;     // other local face of the element sharing the edge of the slot, -1 if not unique
+			std::vector<int> edge_slot_opposite; // local position of the edge in that face
+
+			bool has_half_faces() const { return !element_half_faces.empty() && element_half_faces.size() == elements.size() + 1; }
+
+			void clear_half_faces()
+			{
+				element_half_faces.clear();
+				half_face_element.clear();
+				half_face_opposite.clear();
+				half_face_edges.clear();
+				edge_slot_face.clear();
+				edge_slot_opposite.clear();
+			}
+
 			void append(const Mesh3DStorage &other)
 			{
 				if (other.type != type)
@@ -193,6 +214,8 @@ namespace polyfem
 				// assert(HF.size() == 0 || HF.rows() == other.HF.rows());
 				// HF.conservativeResize(std::max(HF.rows(), other.HF.rows()), other.HF.cols() + HF.cols());
 				// HF.rightCols(other.HF.cols()) = other.HF.array() + n_f;
+
+				clear_half_faces();
 			}
 		};
 
@@ -1,10 +1,12 @@
 #include "MeshProcessing3D.hpp"
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <Eigen/Dense>
 
 #include <algorithm>
 #include <map>
+#include <numeric>
 #include <set>
 #include <queue>
 #include <iterator>
@@ -15,46 +17,129 @@ using namespace polyfem;
 using namespace std;
 using namespace Eigen;
 
-void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
+namespace
 {
-	hmi.edges.clear();
-	if (hmi.type == MeshType::TRI || hmi.type == MeshType::QUA || hmi.type == MeshType::H_SUR)
+	/// @brief Inverts an incidence relation into compressed rows.
+	/// Row t of the result lists the sources referencing target t, in increasing source order.
+	/// @param n_sources number of sources
+	/// @param n_targets number of targets
+	/// @param targets_of targets referenced by a source
+	/// @param[out] offsets row t is values[offsets[t], offsets[t + 1])
+	/// @param[out] values concatenated rows
+	template <typename TargetsOf>
+	void invert_incidence(const uint32_t n_sources, const uint32_t n_targets, const TargetsOf &targets_of, std::vector<uint32_t> &offsets, std::vector<uint32_t> &values)
+	{
+		offsets.assign(n_targets + 1, 0);
+		for (uint32_t i = 0; i < n_sources; ++i)
+			for (const uint32_t t : targets_of(i))
+				++offsets[t + 1];
+
+		for (uint32_t t = 0; t < n_targets; ++t)
+			offsets[t + 1] += offsets[t];
+
+		values.resize(offsets.back());
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (uint32_t i = 0; i < n_sources; ++i)
+			for (const uint32_t t : targets_of(i))
+				values[cursor[t]++] = i;
+	}
+
+	/// copies one compressed row, allocating the list once at its final size
+	void assign_row(const std::vector<uint32_t> &offsets, const std::vector<uint32_t> &values, const uint32_t row, std::vector<uint32_t> &out)
 	{
-		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> temp;
-		temp.reserve(hmi.faces.size() * 3);
+		out.assign(values.begin() + offsets[row], values.begin() + offsets[row + 1]);
+	}
+
+	/// @brief Numbers the runs of equal entries of a sorted list.
+	/// @param sorted sorted entries
+	/// @param same true if two entries belong to the same run
+	/// @param[out] ids run of every entry
+	/// @return number of runs
+	template <typename T, typename Same>
+	uint32_t number_runs(const std::vector<T> &sorted, const Same &same, std::vector<uint32_t> &ids)
+	{
+		ids.resize(sorted.size());
+		if (sorted.empty())
+			return 0;
+
+		utils::maybe_parallel_for(sorted.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				ids[i] = (i == 0 || !same(sorted[i - 1], sorted[i])) ? 1 : 0;
+		});
+		std::partial_sum(ids.begin(), ids.end(), ids.begin());
+		utils::maybe_parallel_for(ids.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				--ids[i];
+		});
+
+		return ids.back() + 1;
+	}
+
+	/// (v0, v1, face, local edge) with v0 < v1
+	typedef std::tuple<uint32_t, uint32_t, uint32_t, uint32_t> EdgeKey;
+
+	/// sorted keys of the edges of every face, sizes the edge list of every face
+	void face_edge_keys(Mesh3DStorage &hmi, std::vector<EdgeKey> &temp)
+	{
+		std::vector<uint32_t> offsets(hmi.faces.size() + 1, 0);
 		for (uint32_t i = 0; i < hmi.faces.size(); ++i)
-		{
-			int vn = hmi.faces[i].vs.size();
-			for (uint32_t j = 0; j < vn; ++j)
+			offsets[i + 1] = offsets[i] + hmi.faces[i].vs.size();
+
+		temp.resize(offsets.back());
+		utils::maybe_parallel_for(hmi.faces.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
 			{
-				uint32_t v0 = hmi.faces[i].vs[j], v1 = hmi.faces[i].vs[(j + 1) % vn];
-				if (v0 > v1)
-					std::swap(v0, v1);
-				temp.push_back(std::make_tuple(v0, v1, i, j));
+				const auto &vs = hmi.faces[i].vs;
+				const uint32_t vn = vs.size();
+				for (uint32_t j = 0; j < vn; ++j)
+				{
+					uint32_t v0 = vs[j], v1 = vs[(j + 1) % vn];
+					if (v0 > v1)
+						std::swap(v0, v1);
+					temp[offsets[i] + j] = std::make_tuple(v0, v1, i, j);
+				}
+				hmi.faces[i].es.resize(vn);
 			}
-			hmi.faces[i].es.resize(vn);
-		}
-		std::sort(temp.begin(), temp.end());
-		hmi.edges.reserve(temp.size() / 2);
-		uint32_t E_num = 0;
-		Edge e;
-		e.boundary = true;
-		e.vs.resize(2);
-		for (uint32_t i = 0; i < temp.size(); ++i)
-		{
-			if (i == 0 || (i != 0 && (std::get<0>(temp[i]) != std::get<0>(temp[i - 1]) || std::get<1>(temp[i]) != std::get<1>(temp[i - 1]))))
+		});
+		utils::maybe_parallel_sort(temp.begin(), temp.end());
+	}
+
+	/// @brief Creates one edge per run of equal vertex pairs and links the faces to their edges.
+	/// @param temp sorted keys from face_edge_keys
+	/// @param boundary_from_count flag edges with a single face as boundary, otherwise no edge is
+	void build_edges(Mesh3DStorage &hmi, const std::vector<EdgeKey> &temp, const bool boundary_from_count)
+	{
+		std::vector<uint32_t> ids;
+		const uint32_t E_num = number_runs(
+			temp, [](const EdgeKey &a, const EdgeKey &b) { return std::get<0>(a) == std::get<0>(b) && std::get<1>(a) == std::get<1>(b); }, ids);
+
+		hmi.edges.resize(E_num);
+		utils::maybe_parallel_for(temp.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
 			{
-				e.id = E_num;
-				E_num++;
-				e.vs[0] = std::get<0>(temp[i]);
-				e.vs[1] = std::get<1>(temp[i]);
-				hmi.edges.push_back(e);
+				const uint32_t eid = ids[i];
+				if (i == 0 || ids[i - 1] != eid)
+				{
+					Edge &e = hmi.edges[eid];
+					e.id = eid;
+					e.vs = {std::get<0>(temp[i]), std::get<1>(temp[i])};
+					e.boundary = boundary_from_count && (i + 1 == temp.size() || ids[i + 1] != eid);
+				}
+				hmi.faces[std::get<2>(temp[i])].es[std::get<3>(temp[i])] = eid;
 			}
-			else if (i != 0 && (std::get<0>(temp[i]) == std::get<0>(temp[i - 1]) && std::get<1>(temp[i]) == std::get<1>(temp[i - 1])))
-				hmi.edges[E_num - 1].boundary = false;
+		});
+	}
+} // namespace
 
-			hmi.faces[std::get<2>(temp[i])].es[std::get<3>(temp[i])] = E_num - 1;
-		}
+void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
+{
+	hmi.clear_half_faces();
+	hmi.edges.clear();
+	if (hmi.type == MeshType::TRI || hmi.type == MeshType::QUA || hmi.type == MeshType::H_SUR)
+	{
+		std::vector<EdgeKey> temp;
+		face_edge_keys(hmi, temp);
+		build_edges(hmi, temp, /*boundary_from_count=*/true);
 		// boundary
 		for (auto &v : hmi.vertices)
 			v.boundary = false;
@@ -66,73 +151,53 @@ void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 	}
 	else if (hmi.type == MeshType::HEX)
 	{
-
 		std::vector<std::vector<uint32_t>> total_fs(hmi.elements.size() * 6);
 		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t>> tempF(hmi.elements.size() * 6);
-		std::vector<uint32_t> vs(4);
-		for (uint32_t i = 0; i < hmi.elements.size(); ++i)
-		{
-			for (short j = 0; j < 6; j++)
+		utils::maybe_parallel_for(hmi.elements.size(), [&](int start, int end, int thread_id) {
+			std::vector<uint32_t> vs(4);
+			for (int i = start; i < end; ++i)
 			{
-				for (short k = 0; k < 4; k++)
-					vs[k] = hmi.elements[i].vs[hex_face_table[j][k]];
-				uint32_t id = 6 * i + j;
-				total_fs[id] = vs;
-				std::sort(vs.begin(), vs.end());
-				tempF[id] = std::make_tuple(vs[0], vs[1], vs[2], vs[3], id, i, j);
+				for (short j = 0; j < 6; j++)
+				{
+					for (short k = 0; k < 4; k++)
+						vs[k] = hmi.elements[i].vs[hex_face_table[j][k]];
+					uint32_t id = 6 * i + j;
+					total_fs[id] = vs;
+					std::sort(vs.begin(), vs.end());
+					tempF[id] = std::make_tuple(vs[0], vs[1], vs[2], vs[3], id, i, j);
+				}
+				hmi.elements[i].fs.resize(6);
 			}
-			hmi.elements[i].fs.resize(6);
-		}
-		std::sort(tempF.begin(), tempF.end());
-		hmi.faces.reserve(tempF.size() / 3);
-		Face f;
-		f.boundary = true;
-		uint32_t F_num = 0;
-		for (uint32_t i = 0; i < tempF.size(); ++i)
-		{
-			if (i == 0 || (i != 0 && (std::get<0>(tempF[i]) != std::get<0>(tempF[i - 1]) || std::get<1>(tempF[i]) != std::get<1>(tempF[i - 1]) || std::get<2>(tempF[i]) != std::get<2>(tempF[i - 1]) || std::get<3>(tempF[i]) != std::get<3>(tempF[i - 1]))))
+		});
+		utils::maybe_parallel_sort(tempF.begin(), tempF.end());
+
+		std::vector<uint32_t> ids;
+		const uint32_t F_num = number_runs(
+			tempF, [](const auto &a, const auto &b) {
+				return std::get<0>(a) == std::get<0>(b) && std::get<1>(a) == std::get<1>(b) && std::get<2>(a) == std::get<2>(b) && std::get<3>(a) == std::get<3>(b);
+			},
+			ids);
+
+		hmi.faces.clear();
+		hmi.faces.resize(F_num);
+		utils::maybe_parallel_for(tempF.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
 			{
-				f.id = F_num;
-				F_num++;
-				f.vs = total_fs[std::get<4>(tempF[i])];
-				hmi.faces.push_back(f);
+				const uint32_t fid = ids[i];
+				if (i == 0 || ids[i - 1] != fid)
+				{
+					Face &f = hmi.faces[fid];
+					f.id = fid;
+					f.vs = total_fs[std::get<4>(tempF[i])];
+					f.boundary = i + 1 == tempF.size() || ids[i + 1] != fid;
+				}
+				hmi.elements[std::get<5>(tempF[i])].fs[std::get<6>(tempF[i])] = fid;
 			}
-			else if (i != 0 && (std::get<0>(tempF[i]) == std::get<0>(tempF[i - 1]) && std::get<1>(tempF[i]) == std::get<1>(tempF[i - 1]) && std::get<2>(tempF[i]) == std::get<2>(tempF[i - 1]) && std::get<3>(tempF[i]) == std::get<3>(tempF[i - 1])))
-				hmi.faces[F_num - 1].boundary = false;
-
-			hmi.elements[std::get<5>(tempF[i])].fs[std::get<6>(tempF[i])] = F_num - 1;
-		}
+		});
 
-		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> temp(hmi.faces.size() * 4);
-		for (uint32_t i = 0; i < hmi.faces.size(); ++i)
-		{
-			for (uint32_t j = 0; j < 4; ++j)
-			{
-				uint32_t v0 = hmi.faces[i].vs[j], v1 = hmi.faces[i].vs[(j + 1) % 4];
-				if (v0 > v1)
-					std::swap(v0, v1);
-				temp[4 * i + j] = std::make_tuple(v0, v1, i, j);
-			}
-			hmi.faces[i].es.resize(4);
-		}
-		std::sort(temp.begin(), temp.end());
-		hmi.edges.reserve(temp.size() / 2);
-		uint32_t E_num = 0;
-		Edge e;
-		e.boundary = false;
-		e.vs.resize(2);
-		for (uint32_t i = 0; i < temp.size(); ++i)
-		{
-			if (i == 0 || (i != 0 && (std::get<0>(temp[i]) != std::get<0>(temp[i - 1]) || std::get<1>(temp[i]) != std::get<1>(temp[i - 1]))))
-			{
-				e.id = E_num;
-				E_num++;
-				e.vs[0] = std::get<0>(temp[i]);
-				e.vs[1] = std::get<1>(temp[i]);
-				hmi.edges.push_back(e);
-			}
-			hmi.faces[std::get<2>(temp[i])].es[std::get<3>(temp[i])] = E_num - 1;
-		}
+		std::vector<EdgeKey> temp;
+		face_edge_keys(hmi, temp);
+		build_edges(hmi, temp, /*boundary_from_count=*/false);
 		// boundary
 		for (auto &v : hmi.vertices)
 			v.boundary = false;
@@ -148,43 +213,15 @@ void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 	else if (hmi.type == MeshType::HYB || hmi.type == MeshType::TET)
 	{
 		vector<bool> bf_flag(hmi.faces.size(), false);
-		for (auto h : hmi.elements)
+		for (const auto &h : hmi.elements)
 			for (auto f : h.fs)
 				bf_flag[f] = !bf_flag[f];
 		for (auto &f : hmi.faces)
 			f.boundary = bf_flag[f.id];
 
-		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> temp;
-		for (uint32_t i = 0; i < hmi.faces.size(); ++i)
-		{
-			int fl = hmi.faces[i].vs.size();
-			for (uint32_t j = 0; j < hmi.faces[i].vs.size(); ++j)
-			{
-				uint32_t v0 = hmi.faces[i].vs[j], v1 = hmi.faces[i].vs[(j + 1) % fl];
-				if (v0 > v1)
-					std::swap(v0, v1);
-				temp.push_back(std::make_tuple(v0, v1, i, j));
-			}
-			hmi.faces[i].es.resize(fl);
-		}
-		std::sort(temp.begin(), temp.end());
-		hmi.edges.reserve(temp.size() / 2);
-		uint32_t E_num = 0;
-		Edge e;
-		e.boundary = false;
-		e.vs.resize(2);
-		for (uint32_t i = 0; i < temp.size(); ++i)
-		{
-			if (i == 0 || (i != 0 && (std::get<0>(temp[i]) != std::get<0>(temp[i - 1]) || std::get<1>(temp[i]) != std::get<1>(temp[i - 1]))))
-			{
-				e.id = E_num;
-				E_num++;
-				e.vs[0] = std::get<0>(temp[i]);
-				e.vs[1] = std::get<1>(temp[i]);
-				hmi.edges.push_back(e);
-			}
-			hmi.faces[std::get<2>(temp[i])].es[std::get<3>(temp[i])] = E_num - 1;
-		}
+		std::vector<EdgeKey> temp;
+		face_edge_keys(hmi, temp);
+		build_edges(hmi, temp, /*boundary_from_count=*/false);
 		// boundary
 		for (auto &v : hmi.vertices)
 			v.boundary = false;
@@ -198,59 +235,77 @@ void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 				}
 	}
 	// f_nhs;
-	for (auto &f : hmi.faces)
-		f.neighbor_hs.clear();
-	for (uint32_t i = 0; i < hmi.elements.size(); i++)
 	{
-		for (uint32_t j = 0; j < hmi.elements[i].fs.size(); j++)
-		{
-			hmi.faces[hmi.elements[i].fs[j]].neighbor_hs.push_back(i);
-		}
+		std::vector<uint32_t> offsets, values;
+		invert_incidence(
+			hmi.elements.size(), hmi.faces.size(), [&](uint32_t i) -> const std::vector<uint32_t> & { return hmi.elements[i].fs; }, offsets, values);
+		utils::maybe_parallel_for(hmi.faces.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				assign_row(offsets, values, i, hmi.faces[i].neighbor_hs);
+		});
 	}
 	// e_nfs, v_nfs
-	for (auto &e : hmi.edges)
-		e.neighbor_fs.clear();
-	for (auto &v : hmi.vertices)
-		v.neighbor_fs.clear();
-	for (uint32_t i = 0; i < hmi.faces.size(); i++)
 	{
-		for (uint32_t j = 0; j < hmi.faces[i].es.size(); j++)
-			hmi.edges[hmi.faces[i].es[j]].neighbor_fs.push_back(i);
-		for (uint32_t j = 0; j < hmi.faces[i].vs.size(); j++)
-			hmi.vertices[hmi.faces[i].vs[j]].neighbor_fs.push_back(i);
+		std::vector<uint32_t> offsets, values;
+		invert_incidence(
+			hmi.faces.size(), hmi.edges.size(), [&](uint32_t i) -> const std::vector<uint32_t> & { return hmi.faces[i].es; }, offsets, values);
+		utils::maybe_parallel_for(hmi.edges.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				assign_row(offsets, values, i, hmi.edges[i].neighbor_fs);
+		});
+
+		invert_incidence(
+			hmi.faces.size(), hmi.vertices.size(), [&](uint32_t i) -> const std::vector<uint32_t> & { return hmi.faces[i].vs; }, offsets, values);
+		utils::maybe_parallel_for(hmi.vertices.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				assign_row(offsets, values, i, hmi.vertices[i].neighbor_fs);
+		});
 	}
 	// v_nes, v_nvs
-	for (auto &v : hmi.vertices)
 	{
-		v.neighbor_es.clear();
-		v.neighbor_vs.clear();
-	}
-	for (uint32_t i = 0; i < hmi.edges.size(); i++)
-	{
-		uint32_t v0 = hmi.edges[i].vs[0], v1 = hmi.edges[i].vs[1];
-		hmi.vertices[v0].neighbor_es.push_back(i);
-		hmi.vertices[v1].neighbor_es.push_back(i);
-		hmi.vertices[v0].neighbor_vs.push_back(v1);
-		hmi.vertices[v1].neighbor_vs.push_back(v0);
+		std::vector<uint32_t> offsets, values;
+		invert_incidence(
+			hmi.edges.size(), hmi.vertices.size(), [&](uint32_t i) -> const std::vector<uint32_t> & { return hmi.edges[i].vs; }, offsets, values);
+		utils::maybe_parallel_for(hmi.vertices.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				auto &v = hmi.vertices[i];
+				assign_row(offsets, values, i, v.neighbor_es);
+
+				v.neighbor_vs.resize(v.neighbor_es.size());
+				for (uint32_t j = 0; j < v.neighbor_es.size(); j++)
+				{
+					const auto &evs = hmi.edges[v.neighbor_es[j]].vs;
+					v.neighbor_vs[j] = evs[0] == i ? evs[1] : evs[0];
+				}
+			}
+		});
 	}
 	// e_nhs
-	for (auto &e : hmi.edges)
-		e.neighbor_hs.clear();
-	for (auto &ele : hmi.elements)
-		ele.es.clear();
-	for (uint32_t i = 0; i < hmi.edges.size(); i++)
 	{
-		std::vector<uint32_t> nhs;
-		for (uint32_t j = 0; j < hmi.edges[i].neighbor_fs.size(); j++)
-		{
-			uint32_t nfid = hmi.edges[i].neighbor_fs[j];
-			nhs.insert(nhs.end(), hmi.faces[nfid].neighbor_hs.begin(), hmi.faces[nfid].neighbor_hs.end());
-		}
-		std::sort(nhs.begin(), nhs.end());
-		nhs.erase(std::unique(nhs.begin(), nhs.end()), nhs.end());
-		hmi.edges[i].neighbor_hs = nhs;
-		for (auto nhid : nhs)
-			hmi.elements[nhid].es.push_back(i);
+		utils::maybe_parallel_for(hmi.edges.size(), [&](int start, int end, int thread_id) {
+			std::vector<uint32_t> nhs;
+			for (int i = start; i < end; ++i)
+			{
+				nhs.clear();
+				for (uint32_t j = 0; j < hmi.edges[i].neighbor_fs.size(); j++)
+				{
+					uint32_t nfid = hmi.edges[i].neighbor_fs[j];
+					nhs.insert(nhs.end(), hmi.faces[nfid].neighbor_hs.begin(), hmi.faces[nfid].neighbor_hs.end());
+				}
+				std::sort(nhs.begin(), nhs.end());
+				nhs.erase(std::unique(nhs.begin(), nhs.end()), nhs.end());
+				hmi.edges[i].neighbor_hs = nhs;
+			}
+		});
+
+		std::vector<uint32_t> offsets, values;
+		invert_incidence(
+			hmi.edges.size(), hmi.elements.size(), [&](uint32_t i) -> const std::vector<uint32_t> & { return hmi.edges[i].neighbor_hs; }, offsets, values);
+		utils::maybe_parallel_for(hmi.elements.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				assign_row(offsets, values, i, hmi.elements[i].es);
+		});
 	}
 	// v_nhs; ordering fs for hex
 	if (hmi.type != MeshType::HYB && hmi.type != MeshType::TET)
@@ -395,31 +450,34 @@ void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 		hmi.FE.resize(3, hmi.faces.size());
 		hmi.FH.resize(2, hmi.faces.size());
 		hmi.FHi.resize(2, hmi.faces.size());
-		for (const auto &f : hmi.faces)
-		{
-			hmi.FV(0, f.id) = f.vs[0];
-			hmi.FV(1, f.id) = f.vs[1];
-			hmi.FV(2, f.id) = f.vs[2];
-
-			hmi.FE(0, f.id) = f.es[0];
-			hmi.FE(1, f.id) = f.es[1];
-			hmi.FE(2, f.id) = f.es[2];
-
-			hmi.FH(0, f.id) = f.neighbor_hs[0];
-			for (int i = 0; i < hmi.elements[f.neighbor_hs[0]].fs.size(); i++)
-				if (f.id == hmi.elements[f.neighbor_hs[0]].fs[i])
-					hmi.FHi(0, f.id) = i;
-
-			hmi.FH(1, f.id) = -1;
-			hmi.FHi(1, f.id) = -1;
-			if (f.neighbor_hs.size() == 2)
+		utils::maybe_parallel_for(hmi.faces.size(), [&](int start, int end, int thread_id) {
+			for (int fi = start; fi < end; ++fi)
 			{
-				hmi.FH(1, f.id) = f.neighbor_hs[1];
-				for (int i = 0; i < hmi.elements[f.neighbor_hs[1]].fs.size(); i++)
-					if (f.id == hmi.elements[f.neighbor_hs[1]].fs[i])
-						hmi.FHi(1, f.id) = i;
+				const auto &f = hmi.faces[fi];
+				hmi.FV(0, f.id) = f.vs[0];
+				hmi.FV(1, f.id) = f.vs[1];
+				hmi.FV(2, f.id) = f.vs[2];
+
+				hmi.FE(0, f.id) = f.es[0];
+				hmi.FE(1, f.id) = f.es[1];
+				hmi.FE(2, f.id) = f.es[2];
+
+				hmi.FH(0, f.id) = f.neighbor_hs[0];
+				for (int i = 0; i < hmi.elements[f.neighbor_hs[0]].fs.size(); i++)
+					if (f.id == hmi.elements[f.neighbor_hs[0]].fs[i])
+						hmi.FHi(0, f.id) = i;
+
+				hmi.FH(1, f.id) = -1;
+				hmi.FHi(1, f.id) = -1;
+				if (f.neighbor_hs.size() == 2)
+				{
+					hmi.FH(1, f.id) = f.neighbor_hs[1];
+					for (int i = 0; i < hmi.elements[f.neighbor_hs[1]].fs.size(); i++)
+						if (f.id == hmi.elements[f.neighbor_hs[1]].fs[i])
+							hmi.FHi(1, f.id) = i;
+				}
 			}
-		}
+		});
 		hmi.HV.resize(4, hmi.elements.size());
 		hmi.HF.resize(4, hmi.elements.size());
 		for (const auto &h : hmi.elements)
@@ -438,7 +496,7 @@ void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 
 	// boundary flags for hybrid mesh
 	std::vector<bool> bv_flag(hmi.vertices.size(), false), be_flag(hmi.edges.size(), false), bf_flag(hmi.faces.size(), false);
-	for (auto f : hmi.faces)
+	for (const auto &f : hmi.faces)
 		if (f.boundary && hmi.elements[f.neighbor_hs[0]].hex)
 			bf_flag[f.id] = true;
 		else if (!f.boundary)
@@ -1121,174 +1179,114 @@ void MeshProcessing3D::refine_catmul_clark_polar(Mesh3DStorage &M, int iter, boo
 }
 void MeshProcessing3D::refine_red_refinement_tet(Mesh3DStorage &M, int iter)
 {
-
-	// double hmin=10000, hmax=0, havg=0;
-	// for(const auto & e:M.edges){
-	// 	Eigen::Vector3d v0 = M.points.col(e.vs[0]), v1 = M.points.col(e.vs[1]);
-	// 	double len = (v0-v1).norm();
-	// 	if(len<hmin) hmin=len;
-	// 	if(len>hmax) hmax = len;
-	// 	havg+=len;
-	// }
-	// havg/=M.edges.size();
-	// std::cout<<"hmin, hmax, havg: "<<hmin<<" "<<hmax<<" "<<havg<<std::endl;
-
 	for (int i = 0; i < iter; i++)
 	{
-
 		Mesh3DStorage M_;
 		M_.type = MeshType::TET;
 
+		// vertices first, then one vertex at every edge midpoint
+		const int n_vertices = M.vertices.size();
 		vector<int> E2V(M.edges.size());
+		M_.vertices.resize(n_vertices + M.edges.size());
+		M_.points.resize(3, M_.vertices.size());
 
-		int vn = 0;
-		for (const auto &v : M.vertices)
-		{
-			Vertex v_;
-			v_.id = vn++;
-			v_.v.resize(3);
-			for (int j = 0; j < 3; j++)
-				v_.v[j] = M.points(j, v.id);
-			M_.vertices.push_back(v_);
-		}
-
-		for (const auto &e : M.edges)
-		{
-			Vertex v;
-			v.id = vn++;
-			v.v.resize(3);
-
-			Vector3d center;
-			center.setZero();
-			for (auto vid : e.vs)
-				center += M.points.col(vid);
-			center /= e.vs.size();
-			for (int j = 0; j < 3; j++)
-				v.v[j] = center[j];
-
-			M_.vertices.push_back(v);
-			E2V[e.id] = v.id;
-		}
-		// for (const auto &ele : M.elements) {
-		// 	Element ele_;
-		// 	ele_.id = M_.elements.size();
-		// 	ele_.fs.resize(4, -1);
-		// 	ele_.fs_flag.resize(4, 1);
-		// 	ele_.vs = ele.vs;
-
-		// 	ele_.hex = false;
-		// 	ele_.v_in_Kernel.resize(3);
-
-		// 	Vector3d center;
-		// 	center.setZero();
-		// 	for (const auto &evid : ele_.vs) for (int j = 0; j < 3; j++)center[j] += M_.vertices[evid].v[j];
-		// 	center /= ele_.vs.size();
-		// 	for (int j = 0; j < 3; j++)ele_.v_in_Kernel[j] = center[j];
-
-		// 	M_.elements.push_back(ele_);
-		// }
-
-		auto shared_edge = [&](int v0, int v1, int &e) -> bool {
-			auto &es0 = M.vertices[v0].neighbor_es, &es1 = M.vertices[v1].neighbor_es;
-			std::sort(es0.begin(), es0.end());
-			std::sort(es1.begin(), es1.end());
-			std::vector<uint32_t> es;
-			std::set_intersection(es0.begin(), es0.end(), es1.begin(), es1.end(), back_inserter(es));
-			if (es.size())
+		utils::maybe_parallel_for(n_vertices, [&](int start, int end, int thread_id) {
+			for (int v = start; v < end; ++v)
 			{
-				e = es[0];
-				return true;
+				Vertex &v_ = M_.vertices[v];
+				v_.id = v;
+				M_.points.col(v) = M.points.col(M.vertices[v].id);
+				v_.v.assign(M_.points.col(v).data(), M_.points.col(v).data() + 3);
 			}
-			return false;
-		};
+		});
 
-		std::vector<bool> e_flag(M.edges.size(), false);
-
-		for (const auto &ele : M.elements)
-		{ // 1 --> 8
-
-			for (short i = 0; i < 4; i++)
-			{ // four corners
-				Element ele_;
-				ele_.id = M_.elements.size();
-				ele_.fs.resize(4, -1);
-				ele_.fs_flag.resize(4, 1);
-
-				ele_.hex = false;
-				ele_.v_in_Kernel.resize(3);
+		utils::maybe_parallel_for(M.edges.size(), [&](int start, int end, int thread_id) {
+			for (int k = start; k < end; ++k)
+			{
+				const auto &e = M.edges[k];
+				Vertex &v = M_.vertices[n_vertices + k];
+				v.id = n_vertices + k;
 
-				ele_.vs.push_back(ele.vs[i]);
-				for (short j = 0; j < 4; j++)
-				{
-					if (j == i)
-						continue;
-					int v0 = ele.vs[i], v1 = ele.vs[j];
-					int e = -1;
-					if (shared_edge(v0, v1, e))
-						ele_.vs.push_back(E2V[e]);
-				}
 				Vector3d center;
 				center.setZero();
-				for (const auto &evid : ele_.vs)
-					for (int j = 0; j < 3; j++)
-						center[j] += M_.vertices[evid].v[j];
-				center /= ele_.vs.size();
-				for (int j = 0; j < 3; j++)
-					ele_.v_in_Kernel[j] = center[j];
+				for (auto vid : e.vs)
+					center += M.points.col(vid);
+				center /= e.vs.size();
 
-				M_.elements.push_back(ele_);
+				M_.points.col(v.id) = center;
+				v.v.assign(center.data(), center.data() + 3);
+				E2V[e.id] = v.id;
 			}
+		});
 
-			// 6 edges
-			std::vector<int> edges(6);
-			for (int i = 0; i < 6; i++)
+		// the edges of a tet are among its own edges, no need to search the vertex neighborhoods
+		auto element_edge = [&](const Element &ele, int v0, int v1) -> int {
+			for (const uint32_t e : ele.es)
 			{
-				int v0 = ele.vs[tet_edges[i][0]], v1 = ele.vs[tet_edges[i][1]];
-				int e = -1;
-				if (shared_edge(v0, v1, e))
-					edges[i] = e;
+				const auto &vs = M.edges[e].vs;
+				if ((vs[0] == v0 && vs[1] == v1) || (vs[0] == v1 && vs[1] == v0))
+					return e;
 			}
-			// the longest edge
-			int lv0 = E2V[edges[0]], lv1 = E2V[edges[5]];
-			e_flag[edges[0]] = true;
-			e_flag[edges[5]] = true;
-			for (short i = 0; i < 4; i++)
-			{ // four faces
-				Element ele_;
-				ele_.id = M_.elements.size();
-				ele_.fs.resize(4, -1);
-				ele_.fs_flag.resize(4, 1);
+			assert(false);
+			return -1;
+		};
 
-				ele_.hex = false;
-				ele_.v_in_Kernel.resize(3);
+		auto make_element = [&](const int id, Element &ele_) {
+			ele_.id = id;
+			ele_.fs.assign(4, -1);
+			ele_.fs_flag.assign(4, 1);
+			ele_.hex = false;
 
-				ele_.vs.push_back(lv0);
-				ele_.vs.push_back(lv1);
-				for (short j = 0; j < 3; j++)
-				{
-					int c_e = M.faces[ele.fs[i]].es[j];
-					if (e_flag[c_e])
-						continue;
-					ele_.vs.push_back(E2V[c_e]);
+			Vector3d center;
+			center.setZero();
+			for (const auto &evid : ele_.vs)
+				center += M_.points.col(evid);
+			center /= ele_.vs.size();
+			ele_.v_in_Kernel.assign(center.data(), center.data() + 3);
+		};
+
+		// every tet is split independently into 8 children stored at 8 * parent
+		M_.elements.resize(M.elements.size() * 8);
+		utils::maybe_parallel_for(M.elements.size(), [&](int start, int end, int thread_id) {
+			for (int e = start; e < end; ++e)
+			{
+				const auto &ele = M.elements[e];
+				int child = 8 * e;
+
+				for (short i = 0; i < 4; i++)
+				{ // four corners
+					Element &ele_ = M_.elements[child];
+					ele_.vs.reserve(4);
+					ele_.vs.push_back(ele.vs[i]);
+					for (short j = 0; j < 4; j++)
+					{
+						if (j == i)
+							continue;
+						ele_.vs.push_back(E2V[element_edge(ele, ele.vs[i], ele.vs[j])]);
+					}
+					make_element(child++, ele_);
 				}
-				Vector3d center;
-				center.setZero();
-				for (const auto &evid : ele_.vs)
-					for (int j = 0; j < 3; j++)
-						center[j] += M_.vertices[evid].v[j];
-				center /= ele_.vs.size();
-				for (int j = 0; j < 3; j++)
-					ele_.v_in_Kernel[j] = center[j];
 
-				M_.elements.push_back(ele_);
+				// the diagonal joining the midpoints of edges 0 and 5
+				const int e0 = element_edge(ele, ele.vs[tet_edges[0][0]], ele.vs[tet_edges[0][1]]);
+				const int e5 = element_edge(ele, ele.vs[tet_edges[5][0]], ele.vs[tet_edges[5][1]]);
+				for (short i = 0; i < 4; i++)
+				{ // four faces
+					Element &ele_ = M_.elements[child];
+					ele_.vs.reserve(4);
+					ele_.vs.push_back(E2V[e0]);
+					ele_.vs.push_back(E2V[e5]);
+					for (short j = 0; j < 3; j++)
+					{
+						const int c_e = M.faces[ele.fs[i]].es[j];
+						if (c_e == e0 || c_e == e5)
+							continue;
+						ele_.vs.push_back(E2V[c_e]);
+					}
+					make_element(child++, ele_);
+				}
 			}
-			e_flag[edges[0]] = e_flag[edges[5]] = false;
-		}
-
-		M_.points.resize(3, M_.vertices.size());
-		for (auto v : M_.vertices)
-			for (int j = 0; j < 3; j++)
-				M_.points(j, v.id) = v.v[j];
+		});
 
 		// orient tets
 		const auto &t = M.elements[0].vs;
@@ -1296,38 +1294,42 @@ void MeshProcessing3D::refine_red_refinement_tet(Mesh3DStorage &M, int iter)
 		Vector3d c1 = M.points.col(t[1]);
 		Vector3d c2 = M.points.col(t[2]);
 		Vector3d c3 = M.points.col(t[3]);
-		bool signed_volume = a_jacobian(c0, c1, c2, c3) > 0 ? true : false;
+		const bool signed_volume = a_jacobian(c0, c1, c2, c3) > 0 ? true : false;
 
-		for (auto &ele : M_.elements)
-		{
-			c0 = M_.points.col(ele.vs[0]);
-			c1 = M_.points.col(ele.vs[1]);
-			c2 = M_.points.col(ele.vs[2]);
-			c3 = M_.points.col(ele.vs[3]);
-			bool sign = a_jacobian(c0, c1, c2, c3) > 0 ? true : false;
-			if (sign != signed_volume)
-				std::swap(ele.vs[1], ele.vs[3]);
-		}
+		utils::maybe_parallel_for(M_.elements.size(), [&](int start, int end, int thread_id) {
+			for (int e = start; e < end; ++e)
+			{
+				auto &ele = M_.elements[e];
+				Vector3d p0 = M_.points.col(ele.vs[0]);
+				Vector3d p1 = M_.points.col(ele.vs[1]);
+				Vector3d p2 = M_.points.col(ele.vs[2]);
+				Vector3d p3 = M_.points.col(ele.vs[3]);
+				const bool sign = a_jacobian(p0, p1, p2, p3) > 0 ? true : false;
+				if (sign != signed_volume)
+					std::swap(ele.vs[1], ele.vs[3]);
+			}
+		});
 
 		// Fs
-		std::vector<std::vector<uint32_t>> total_fs;
-		total_fs.reserve(M.elements.size() * 4);
-		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t>> tempF;
-		tempF.reserve(M.elements.size() * 4);
-		std::vector<uint32_t> vs(3);
-		for (const auto &ele : M_.elements)
-		{
-			for (int i = 0; i < 4; i++)
+		std::vector<std::vector<uint32_t>> total_fs(M_.elements.size() * 4);
+		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t>> tempF(M_.elements.size() * 4);
+		utils::maybe_parallel_for(M_.elements.size(), [&](int start, int end, int thread_id) {
+			std::vector<uint32_t> vs(3);
+			for (int e = start; e < end; ++e)
 			{
-				vs[0] = ele.vs[tet_faces[i][0]];
-				vs[1] = ele.vs[tet_faces[i][1]];
-				vs[2] = ele.vs[tet_faces[i][2]];
-				total_fs.push_back(vs);
-				std::sort(vs.begin(), vs.end());
-				tempF.push_back(std::make_tuple(vs[0], vs[1], vs[2], ele.id * 4 + i, ele.id, i));
+				const auto &ele = M_.elements[e];
+				for (int i = 0; i < 4; i++)
+				{
+					vs[0] = ele.vs[tet_faces[i][0]];
+					vs[1] = ele.vs[tet_faces[i][1]];
+					vs[2] = ele.vs[tet_faces[i][2]];
+					total_fs[ele.id * 4 + i] = vs;
+					std::sort(vs.begin(), vs.end());
+					tempF[ele.id * 4 + i] = std::make_tuple(vs[0], vs[1], vs[2], ele.id * 4 + i, ele.id, i);
+				}
 			}
-		}
-		std::sort(tempF.begin(), tempF.end());
+		});
+		utils::maybe_parallel_sort(tempF.begin(), tempF.end());
 		M_.faces.reserve(tempF.size() / 3);
 		Face f;
 		f.boundary = true;
@@ -1351,21 +1353,7 @@ void MeshProcessing3D::refine_red_refinement_tet(Mesh3DStorage &M, int iter)
 		orient_volume_mesh(M_);
 		build_connectivity(M_);
 
-		M = M_;
-
-		double hmin = 10000, hmax = 0, havg = 0;
-		for (const auto &e : M.edges)
-		{
-			Eigen::Vector3d v0 = M.points.col(e.vs[0]), v1 = M.points.col(e.vs[1]);
-			double len = (v0 - v1).norm();
-			if (len < hmin)
-				hmin = len;
-			if (len > hmax)
-				hmax = len;
-			havg += len;
-		}
-		havg /= M.edges.size();
-		// std::cout<<"hmin, hmax, havg: "<<hmin<<" "<<hmax<<" "<<havg<<std::endl;
+		M = std::move(M_);
 	}
 }
 void MeshProcessing3D::straight_sweeping(const Mesh3DStorage &Mi, int sweep_coord, double height, int nlayer, Mesh3DStorage &Mo)
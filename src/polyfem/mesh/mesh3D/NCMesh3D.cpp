@@ -3,6 +3,7 @@
 #include <polyfem/utils/StringUtils.hpp>
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <igl/writeMESH.h>
 
@@ -25,6 +26,8 @@ namespace polyfem
 
 		void NCMesh3D::refine(const int n_refinement, const double t)
 		{
+			invalidate_element_bvh();
+
 			if (n_refinement <= 0)
 				return;
 			std::vector<bool> refine_mask(elements.size(), false);
@@ -49,8 +52,10 @@ namespace polyfem
 			return false;
 		}
 
-		bool NCMesh3D::build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F)
+		bool NCMesh3D::build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F)
 		{
+			invalidate_element_bvh();
+
 			n_elements = 0;
 			elements.clear();
 			vertices.clear();
@@ -86,6 +91,8 @@ namespace polyfem
 
 		void NCMesh3D::normalize()
 		{
+			invalidate_element_bvh();
+
 			polyfem::RowVectorNd min, max;
 			bounding_box(min, max);
 
@@ -119,6 +126,8 @@ namespace polyfem
 
 		void NCMesh3D::set_point(const int global_index, const RowVectorNd &p)
 		{
+			invalidate_element_bvh();
+
 			vertices[valid_to_all_vertex(global_index)].pos = p;
 		}
 
@@ -793,6 +802,25 @@ namespace polyfem
 			refineHistory.push_back(parent_id);
 		}
 
+		void NCMesh3D::coarsen_elements(const std::vector<int> &ids)
+		{
+			// siblings are coarsened once, through the first of them in the batch
+			std::vector<int> parents;
+			parents.reserve(ids.size());
+			for (int i : ids)
+			{
+				const int parent_id = elements[valid_to_all_elem(i)].parent;
+				if (parent_id < 0)
+					throw std::runtime_error("Cannot coarsen an element without parent!");
+				parents.push_back(parent_id);
+			}
+			std::sort(parents.begin(), parents.end());
+			parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+
+			for (int parent_id : parents)
+				coarsen_element(elements[parent_id].children(0));
+		}
+
 		void NCMesh3D::mark_boundary()
 		{
 			for (auto &face : faces)
@@ -928,6 +956,8 @@ namespace polyfem
 
 		bool NCMesh3D::load(const std::string &path)
 		{
+			invalidate_element_bvh();
+
 			if (!StringUtils::endswith(path, ".HYBRID"))
 			{
 				GEO::Mesh M;
@@ -938,6 +968,8 @@ namespace polyfem
 		}
 		bool NCMesh3D::load(const GEO::Mesh &M)
 		{
+			invalidate_element_bvh();
+
 			assert(M.vertices.dimension() == 3);
 
 			Eigen::MatrixXd V(M.vertices.nb(), 2);
@@ -1068,14 +1100,20 @@ namespace polyfem
 				edge.weights.setConstant(-1);
 			}
 
+			// the traversals only read the hash maps, collect them in parallel and link the chains in order
+			std::vector<std::vector<follower_edge>> all_followers(edges.size());
+			utils::maybe_parallel_for(edges.size(), [&](int start, int end, int thread_id) {
+				for (int e_id = start; e_id < end; e_id++)
+					if (edges[e_id].n_elem() > 0)
+						traverse_edge(edges[e_id].vertices, 0, 1, 0, all_followers[e_id]);
+			});
+
 			for (int e_id = 0; e_id < edges.size(); e_id++)
 			{
 				auto &edge = edges[e_id];
 				if (edge.n_elem() == 0)
 					continue;
-				std::vector<follower_edge> followers;
-				traverse_edge(edge.vertices, 0, 1, 0, followers);
-				for (auto &s : followers)
+				for (auto &s : all_followers[e_id])
 				{
 					if (edges[s.id].leader >= 0 && std::abs(edges[s.id].weights(1) - edges[s.id].weights(0)) < std::abs(s.p2 - s.p1))
 						continue;
@@ -1147,20 +1185,29 @@ namespace polyfem
 				edge.leader_face = -1;
 			}
 
+			std::vector<std::vector<follower_face>> all_followers(faces.size());
+			std::vector<std::vector<int>> all_interior_edges(faces.size());
+			utils::maybe_parallel_for(faces.size(), [&](int start, int end, int thread_id) {
+				for (int f_id = start; f_id < end; f_id++)
+				{
+					const auto &face = faces[f_id];
+					if (face.n_elem() == 0)
+						continue;
+					traverse_face(face.vertices(0), face.vertices(1), face.vertices(2), Eigen::Vector2d(0, 0), Eigen::Vector2d(1, 0), Eigen::Vector2d(0, 1), 0, all_followers[f_id], all_interior_edges[f_id]); // order is important
+				}
+			});
+
 			for (int f_id = 0; f_id < faces.size(); f_id++)
 			{
 				auto &face = faces[f_id];
 				if (face.n_elem() == 0)
 					continue;
-				std::vector<follower_face> followers;
-				std::vector<int> interior_edges;
-				traverse_face(face.vertices(0), face.vertices(1), face.vertices(2), Eigen::Vector2d(0, 0), Eigen::Vector2d(1, 0), Eigen::Vector2d(0, 1), 0, followers, interior_edges); // order is important
-				for (auto &s : followers)
+				for (auto &s : all_followers[f_id])
 				{
 					faces[s.id].leader = f_id;
 					face.followers.push_back(s.id);
 				}
-				for (int s : interior_edges)
+				for (int s : all_interior_edges[f_id])
 					if (s >= 0 && edges[s].leader < 0 && edges[s].n_elem() > 0)
 						edges[s].leader_face = f_id;
 			}
@@ -237,7 +237,7 @@ namespace polyfem
 				return false;
 			}
 
-			bool build_from_matrices(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F) override;
+			bool build_from_matrices(const ConstMatrixXdView &V, const ConstMatrixXiView &F) override;
 
 			void attach_higher_order_nodes(const Eigen::MatrixXd &V, const std::vector<std::vector<int>> &nodes) override;
 
@@ -343,6 +343,8 @@ namespace polyfem
 			void refine_elements(const std::vector<int> &ids);
 
 			void coarsen_element(int id_full);
+			/// coarsen the parents of the given (valid) elements at once, call prepare_mesh afterwards
+			void coarsen_elements(const std::vector<int> &ids);
 
 			void mark_boundary();
 
@@ -1,21 +1,104 @@
 #include "Navigation3D.hpp"
 #include "MeshProcessing3D.hpp"
 
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
 // #include <igl/Timer.h>
 #include <algorithm>
 #include <iterator>
 #include <set>
+#include <tuple>
 #include <cassert>
 
 using namespace polyfem::mesh::Navigation3D;
 using namespace polyfem;
 using namespace std;
 
-// double polyfem::mesh::Navigation3D::get_index_from_element_face_time;
-// double polyfem::mesh::Navigation3D::switch_vertex_time;
-// double polyfem::mesh::Navigation3D::switch_edge_time;
-// double polyfem::mesh::Navigation3D::switch_face_time;
-// double polyfem::mesh::Navigation3D::switch_element_time;
+namespace
+{
+	/// @brief Builds the half-face adjacency of a non-tet mesh, used by switch_face and switch_element.
+	void build_half_faces(polyfem::mesh::Mesh3DStorage &M)
+	{
+		const int n_elements = M.elements.size();
+
+		M.element_half_faces.resize(n_elements + 1);
+		M.element_half_faces[0] = 0;
+		for (int e = 0; e < n_elements; ++e)
+			M.element_half_faces[e + 1] = M.element_half_faces[e] + M.elements[e].fs.size();
+		const int n_half_faces = M.element_half_faces.back();
+
+		M.half_face_element.resize(n_half_faces);
+		M.half_face_opposite.assign(n_half_faces, -1);
+		M.half_face_edges.resize(n_half_faces + 1);
+		M.half_face_edges[0] = 0;
+		std::vector<int> face_half_face(M.faces.size(), -1);
+		for (int e = 0; e < n_elements; ++e)
+		{
+			for (int lf = 0; lf < M.elements[e].fs.size(); ++lf)
+			{
+				const int h = M.element_half_faces[e] + lf;
+				const int f = M.elements[e].fs[lf];
+				M.half_face_element[h] = e;
+				M.half_face_edges[h + 1] = M.half_face_edges[h] + M.faces[f].es.size();
+
+				if (face_half_face[f] < 0)
+					face_half_face[f] = h;
+				else
+				{
+					M.half_face_opposite[h] = face_half_face[f];
+					M.half_face_opposite[face_half_face[f]] = h;
+				}
+			}
+		}
+
+		// in every element, each edge is shared by exactly two faces
+		M.edge_slot_face.resize(M.half_face_edges.back());
+		M.edge_slot_opposite.resize(M.half_face_edges.back());
+		utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+			std::vector<std::tuple<uint32_t, int, int>> slots; // edge, local face, position in the face
+			for (int e = start; e < end; ++e)
+			{
+				const auto &fs = M.elements[e].fs;
+				slots.clear();
+				for (int lf = 0; lf < fs.size(); ++lf)
+				{
+					const auto &es = M.faces[fs[lf]].es;
+					for (int k = 0; k < es.size(); ++k)
+						slots.emplace_back(es[k], lf, k);
+				}
+				std::sort(slots.begin(), slots.end());
+
+				for (int i = 0; i < slots.size();)
+				{
+					int j = i + 1;
+					while (j < slots.size() && std::get<0>(slots[j]) == std::get<0>(slots[i]))
+						++j;
+
+					for (int l = i; l < j; ++l)
+					{
+						const int slot = M.half_face_edges[M.element_half_faces[e] + std::get<1>(slots[l])] + std::get<2>(slots[l]);
+						if (j - i == 2)
+						{
+							const auto &other = slots[l == i ? j - 1 : i];
+							M.edge_slot_face[slot] = std::get<1>(other);
+							M.edge_slot_opposite[slot] = std::get<2>(other);
+						}
+						else
+						{
+							M.edge_slot_face[slot] = -1;
+							M.edge_slot_opposite[slot] = -1;
+						}
+					}
+					i = j;
+				}
+			}
+		});
+
+		// degenerate elements keep the searches of the navigation
+		if (std::find(M.edge_slot_face.begin(), M.edge_slot_face.end(), -1) != M.edge_slot_face.end())
+			M.clear_half_faces();
+	}
+} // namespace
 
 void polyfem::mesh::Navigation3D::prepare_mesh(Mesh3DStorage &M)
 {
@@ -23,6 +106,9 @@ void polyfem::mesh::Navigation3D::prepare_mesh(Mesh3DStorage &M)
 		M.type = MeshType::HYB;
 	MeshProcessing3D::build_connectivity(M);
 	MeshProcessing3D::global_orientation_hexes(M);
+
+	if (M.type != MeshType::TET)
+		build_half_faces(M);
 }
 
 polyfem::mesh::Navigation3D::Index polyfem::mesh::Navigation3D::get_index_from_element_face(const Mesh3DStorage &M, int hi)
@@ -391,6 +477,24 @@ polyfem::mesh::Navigation3D::Index polyfem::mesh::Navigation3D::switch_face(cons
 			}
 		}
 	}
+	else if (M.has_half_faces())
+	{
+		const auto &es = M.faces[idx.face].es;
+		const int n = es.size();
+		// the edge of the index starts or ends at its corner
+		const int k = es[idx.face_corner] == idx.edge ? idx.face_corner : (idx.face_corner - 1 + n) % n;
+		assert(es[k] == idx.edge);
+		const int slot = M.half_face_edges[M.element_half_faces[idx.element] + idx.element_patch] + k;
+		assert(M.edge_slot_face[slot] >= 0);
+
+		idx.element_patch = M.edge_slot_face[slot];
+		idx.face = M.elements[idx.element].fs[idx.element_patch];
+
+		const vector<uint32_t> &fvs = M.faces[idx.face].vs;
+		const int k1 = M.edge_slot_opposite[slot];
+		idx.face_corner = fvs[k1] == idx.vertex ? k1 : (k1 + 1) % fvs.size();
+		assert(fvs[idx.face_corner] == idx.vertex);
+	}
 	else
 	{
 		const vector<uint32_t> &efs = M.edges[idx.edge].neighbor_fs, &hfs = M.elements[idx.element].fs;
@@ -444,6 +548,17 @@ polyfem::mesh::Navigation3D::Index polyfem::mesh::Navigation3D::switch_element(c
 			idx.element_patch = M.FHi(0, idx.face);
 		}
 	}
+	else if (M.has_half_faces())
+	{
+		const int h = M.half_face_opposite[M.element_half_faces[idx.element] + idx.element_patch];
+		if (h < 0)
+		{
+			idx.element = -1;
+			return idx;
+		}
+		idx.element = M.half_face_element[h];
+		idx.element_patch = h - M.element_half_faces[idx.element];
+	}
 	else
 	{
 		if (M.faces[idx.face].neighbor_hs.size() == 1)
@@ -8,12 +8,6 @@ namespace polyfem
 	{
 		namespace Navigation3D
 		{
-			// extern double get_index_from_element_face_time;
-			// extern double switch_vertex_time;
-			// extern double switch_edge_time;
-			// extern double switch_face_time;
-			// extern double switch_element_time;
-
 			struct Index
 			{
 				int vertex;
@@ -23,6 +17,7 @@ namespace polyfem
 				int element;
 				int element_patch;
 			};
+			// Builds the connectivity and, for non-tet meshes, the half-face adjacency used by switch_face and switch_element
 			void prepare_mesh(Mesh3DStorage &M);
 			// Retrieve the index (v,e,f,h) of one vertex incident to the given face and element
 			Index get_index_from_element_face(const Mesh3DStorage &M, int hi);
@@ -142,9 +142,10 @@ namespace polyfem::mesh
 		constexpr int al_max_weight = 100 * al_initial_weight;
 		constexpr double al_eta_tol = 0.99;
 		constexpr size_t al_max_solver_iter = 1000;
+		double al_weight = 0;
 		ALSolver al_solver(
 			bc_lagrangian_form, bc_penalty_form, al_initial_weight,
-			al_scaling, al_max_weight, al_eta_tol,
+			al_scaling, al_max_weight, al_eta_tol, al_weight,
 			/*update_barrier_stiffness=*/[&](const Eigen::MatrixXd &x) {});
 
 		Eigen::MatrixXd sol = x0;
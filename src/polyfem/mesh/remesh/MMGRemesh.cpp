@@ -14,7 +14,12 @@
 #include <geogram/mesh/mesh_io.h>
 #include <mmg/libmmg.h>
 
+#include <polyfem/mesh/Mesh.hpp>
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <algorithm>
+#include <cmath>
 ////////////////////////////////////////////////////////////////////////////////
 //
 // Wrapper for 3D remeshing comes from:
@@ -29,90 +34,6 @@ namespace polyfem::mesh
 {
 	namespace
 	{
-		void to_geogram_mesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, GEO::Mesh &M)
-		{
-			M.clear();
-			// Setup vertices
-			M.vertices.create_vertices((int)V.rows());
-			for (int i = 0; i < (int)M.vertices.nb(); ++i)
-			{
-				GEO::vec3 &p = M.vertices.point(i);
-				p[0] = V(i, 0);
-				p[1] = V(i, 1);
-				p[2] = (V.cols() == 2 ? 0 : V(i, 2));
-			}
-			// Setup faces
-			if (F.cols() == 3)
-			{
-				M.facets.create_triangles((int)F.rows());
-			}
-			else if (F.cols() == 4)
-			{
-				M.facets.create_quads((int)F.rows());
-			}
-			else
-			{
-				throw std::runtime_error("Mesh faces not supported");
-			}
-			for (int c = 0; c < (int)M.facets.nb(); ++c)
-			{
-				for (int lv = 0; lv < F.cols(); ++lv)
-				{
-					M.facets.set_vertex(c, lv, F(c, lv));
-				}
-			}
-			M.facets.connect();
-		}
-
-		void to_geogram_mesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::MatrixXi &T, GEO::Mesh &M)
-		{
-			to_geogram_mesh(V, F, M);
-			if (T.cols() == 4)
-			{
-				M.cells.create_tets((int)T.rows());
-			}
-			else if (T.rows() != 0)
-			{
-				throw std::runtime_error("Mesh cells not supported");
-			}
-			for (int c = 0; c < (int)M.cells.nb(); ++c)
-			{
-				for (int lv = 0; lv < T.cols(); ++lv)
-				{
-					M.cells.set_vertex(c, lv, T(c, lv));
-				}
-			}
-			M.cells.connect();
-		}
-
-		void from_geogram_mesh(const GEO::Mesh &M, Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &T)
-		{
-			V.resize(M.vertices.nb(), 3);
-			for (int i = 0; i < (int)M.vertices.nb(); ++i)
-			{
-				GEO::vec3 p = M.vertices.point(i);
-				V.row(i) << p[0], p[1], p[2];
-			}
-			assert(M.facets.are_simplices());
-			F.resize(M.facets.nb(), 3);
-			for (int c = 0; c < (int)M.facets.nb(); ++c)
-			{
-				for (int lv = 0; lv < 3; ++lv)
-				{
-					F(c, lv) = M.facets.vertex(c, lv);
-				}
-			}
-			assert(M.cells.are_simplices());
-			T.resize(M.cells.nb(), 4);
-			for (int c = 0; c < (int)M.cells.nb(); ++c)
-			{
-				for (int lv = 0; lv < 4; ++lv)
-				{
-					T(c, lv) = M.cells.vertex(c, lv);
-				}
-			}
-		}
-
 		bool mmg_to_geo(const MMG5_pMesh mmg, GEO::Mesh &M)
 		{
 			logger().trace("converting MMG5_pMesh to GEO::Mesh ...");
@@ -254,6 +175,130 @@ namespace polyfem::mesh
 			return true;
 		}
 
+		bool eigen_to_mmg(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::MatrixXi &T,
+						  MMG5_pMesh &mmg, MMG5_pSol &sol, bool volume_mesh = true)
+		{
+			logger().trace("converting Eigen mesh to MMG5_pMesh ...");
+			assert(V.cols() == 2 || V.cols() == 3);
+			assert(F.rows() == 0 || F.cols() == 3);
+			assert(T.rows() == 0 || T.cols() == 4);
+
+			if (volume_mesh)
+			{
+				MMG3D_Init_mesh(MMG5_ARG_start, MMG5_ARG_ppMesh, &mmg, MMG5_ARG_ppMet, &sol, MMG5_ARG_end);
+			}
+			else
+			{
+				MMGS_Init_mesh(MMG5_ARG_start, MMG5_ARG_ppMesh, &mmg, MMG5_ARG_ppMet, &sol, MMG5_ARG_end);
+			}
+
+			if (volume_mesh && MMG3D_Set_meshSize(mmg, (int)V.rows(), (int)T.rows(), 0, (int)F.rows(), 0, 0) != 1)
+			{
+				logger().error("failed to MMG3D_Set_meshSize");
+				return false;
+			}
+			else if (!volume_mesh && MMGS_Set_meshSize(mmg, (int)V.rows(), (int)F.rows(), 0) != 1)
+			{
+				logger().error("failed to MMGS_Set_meshSize");
+				return false;
+			}
+
+			// Write straight into the MMG buffers, indexing starts at 1 in MMG
+			utils::maybe_parallel_for(V.rows(), [&](int start, int end, int thread_id) {
+				for (int v = start; v < end; ++v)
+				{
+					for (int d = 0; d < 3; ++d)
+						mmg->point[v + 1].c[d] = d < V.cols() ? V(v, d) : 0;
+				}
+			});
+			utils::maybe_parallel_for(F.rows(), [&](int start, int end, int thread_id) {
+				for (int t = start; t < end; ++t)
+				{
+					for (int lv = 0; lv < 3; ++lv)
+						mmg->tria[t + 1].v[lv] = F(t, lv) + 1;
+				}
+			});
+			if (volume_mesh)
+			{
+				utils::maybe_parallel_for(T.rows(), [&](int start, int end, int thread_id) {
+					for (int c = start; c < end; ++c)
+					{
+						for (int lv = 0; lv < 4; ++lv)
+							mmg->tetra[c + 1].v[lv] = T(c, lv) + 1;
+					}
+				});
+			}
+
+			if (volume_mesh && MMG3D_Set_solSize(mmg, sol, MMG5_Vertex, (int)V.rows(), MMG5_Scalar) != 1)
+			{
+				logger().error("failed to MMG3D_Set_solSize");
+				return false;
+			}
+			else if (!volume_mesh && MMGS_Set_solSize(mmg, sol, MMG5_Vertex, (int)V.rows(), MMG5_Scalar) != 1)
+			{
+				logger().error("failed to MMGS_Set_solSize");
+				return false;
+			}
+			std::fill(sol->m + 1, sol->m + 1 + V.rows(), 1.);
+			if (volume_mesh && MMG3D_Chk_meshData(mmg, sol) != 1)
+			{
+				logger().error("error in mmg: inconsistent mesh and sol");
+				return false;
+			}
+			else if (!volume_mesh && MMGS_Chk_meshData(mmg, sol) != 1)
+			{
+				logger().error("error in mmg: inconsistent mesh and sol");
+				return false;
+			}
+
+			if (volume_mesh)
+			{
+				MMG3D_Set_handGivenMesh(mmg); /* because we don't use the API functions */
+			}
+
+			return true;
+		}
+
+		void mmg_to_eigen(const MMG5_pMesh mmg, Eigen::MatrixXd &V, Eigen::MatrixXi &F, Eigen::MatrixXi &T)
+		{
+			logger().trace("converting MMG5_pMesh to Eigen mesh ...");
+			assert(mmg->dim == 3);
+
+			V.resize(mmg->np, 3);
+			F.resize(mmg->nt, 3);
+			T.resize(mmg->ne, 4);
+
+			utils::maybe_parallel_for(V.rows(), [&](int start, int end, int thread_id) {
+				for (int v = start; v < end; ++v)
+				{
+					for (int d = 0; d < 3; ++d)
+						V(v, d) = mmg->point[v + 1].c[d];
+				}
+			});
+			utils::maybe_parallel_for(F.rows(), [&](int start, int end, int thread_id) {
+				for (int t = start; t < end; ++t)
+				{
+					for (int lv = 0; lv < 3; ++lv)
+						F(t, lv) = mmg->tria[t + 1].v[lv] - 1;
+				}
+			});
+			utils::maybe_parallel_for(T.rows(), [&](int start, int end, int thread_id) {
+				for (int c = start; c < end; ++c)
+				{
+					for (int lv = 0; lv < 4; ++lv)
+						T(c, lv) = mmg->tetra[c + 1].v[lv] - 1;
+				}
+			});
+		}
+
+		void set_mmg_metric(const Eigen::VectorXd &S, MMG5_pSol met)
+		{
+			utils::maybe_parallel_for(S.size(), [&](int start, int end, int thread_id) {
+				for (int v = start; v < end; ++v)
+					met->m[v + 1] = S(v);
+			});
+		}
+
 		void mmg2d_free(MMG5_pMesh mmg, MMG5_pSol sol)
 		{
 			MMG2D_Free_all(MMG5_ARG_start,
@@ -284,11 +329,12 @@ namespace polyfem::mesh
 			return ok;
 		}
 
-		bool mmg2d_tri_remesh(const GEO::Mesh &M, GEO::Mesh &M_out, const MmgOptions &opt)
+		bool mmg2d_tri_remesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::VectorXd &S,
+							  Eigen::MatrixXd &OV, Eigen::MatrixXi &OF, const MmgOptions &opt)
 		{
 			MMG5_pMesh mesh = nullptr;
 			MMG5_pSol met = nullptr;
-			bool ok = geo_to_mmg(M, mesh, met, false);
+			bool ok = eigen_to_mmg(V, F, Eigen::MatrixXi(), mesh, met, false);
 			if (!ok)
 			{
 				logger().error("mmg2d_remesh: failed to convert mesh to MMG5_pMesh");
@@ -321,16 +367,8 @@ namespace polyfem::mesh
 			MMG2D_Set_iparameter(mesh, met, MMG2D_IPARAM_nosurf, int(opt.nosurf));
 			if (opt.metric_attribute != "no_metric")
 			{
-				if (!M.vertices.attributes().is_defined(opt.metric_attribute))
-				{
-					logger().error("mmg2D_remesh: {} is not a vertex attribute, cancel", opt.metric_attribute);
-					return false;
-				}
-				GEO::Attribute<double> h_local(M.vertices.attributes(), opt.metric_attribute);
-				for (uint v = 0; v < M.vertices.nb(); ++v)
-				{
-					met->m[v + 1] = h_local[v];
-				}
+				assert(S.size() == V.rows());
+				set_mmg_metric(S, met);
 			}
 
 			int ier = MMG2D_mmg2dlib(mesh, met);
@@ -341,7 +379,8 @@ namespace polyfem::mesh
 				return false;
 			}
 
-			ok = mmg_to_geo(mesh, M_out);
+			Eigen::MatrixXi OT;
+			mmg_to_eigen(mesh, OV, OF, OT);
 
 			mmg2d_free(mesh, met);
 			return ok;
@@ -409,11 +448,12 @@ namespace polyfem::mesh
 			return ok;
 		}
 
-		bool mmg3d_tet_remesh(const GEO::Mesh &M, GEO::Mesh &M_out, const MmgOptions &opt)
+		bool mmg3d_tet_remesh(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::VectorXd &S,
+							  Eigen::MatrixXd &OV, Eigen::MatrixXi &OF, Eigen::MatrixXi &OT, const MmgOptions &opt)
 		{
 			MMG5_pMesh mesh = nullptr;
 			MMG5_pSol met = nullptr;
-			bool ok = geo_to_mmg(M, mesh, met, true);
+			bool ok = eigen_to_mmg(V, Eigen::MatrixXi(), T, mesh, met, true);
 			if (!ok)
 			{
 				logger().error("mmg3d_remesh: failed to convert mesh to MMG5_pMesh");
@@ -449,16 +489,8 @@ namespace polyfem::mesh
 			MMG3D_Set_iparameter(mesh, met, MMG3D_IPARAM_optimLES, int(opt.optimLES));
 			if (opt.metric_attribute != "no_metric")
 			{
-				if (!M.vertices.attributes().is_defined(opt.metric_attribute))
-				{
-					logger().error("mmg3D_remesh: {} is not a vertex attribute, cancel", opt.metric_attribute);
-					return false;
-				}
-				GEO::Attribute<double> h_local(M.vertices.attributes(), opt.metric_attribute);
-				for (uint v = 0; v < M.vertices.nb(); ++v)
-				{
-					met->m[v + 1] = h_local[v];
-				}
+				assert(S.size() == V.rows());
+				set_mmg_metric(S, met);
 			}
 
 			int ier = MMG3D_mmg3dlib(mesh, met);
@@ -469,7 +501,7 @@ namespace polyfem::mesh
 				return false;
 			}
 
-			ok = mmg_to_geo(mesh, M_out);
+			mmg_to_eigen(mesh, OV, OF, OT);
 
 			mmg3d_free(mesh, met);
 			return ok;
@@ -589,24 +621,12 @@ namespace polyfem::mesh
 	{
 		assert(V.cols() == 2 || V.cols() == 3);
 		assert(V.rows() == S.size());
-		GEO::Mesh M, M_out;
-		to_geogram_mesh(V, F, M);
 
 		// Remeshing options
 		opt.metric_attribute = "scalar";
 
-		GEO::Attribute<double> scalar(M.vertices.attributes(), opt.metric_attribute);
-		for (int v = 0; v < M.vertices.nb(); ++v)
-		{
-			scalar[v] = S(v);
-		}
-
 		// Remesh surface
-		mmg2d_tri_remesh(M, M_out, opt);
-
-		// Convert output
-		Eigen::MatrixXi OT;
-		from_geogram_mesh(M_out, OV, OF, OT);
+		mmg2d_tri_remesh(V, F, S, OV, OF, opt);
 
 		// Promised a 2D mesh, so drop z-coordinate
 		OV.conservativeResize(OV.rows(), 2);
@@ -617,23 +637,64 @@ namespace polyfem::mesh
 	{
 		assert(V.cols() == 3);
 		assert(V.rows() == S.size());
-		GEO::Mesh M, M_out;
-		to_geogram_mesh(V, Eigen::MatrixXi(0, 3), T, M);
 
 		// Remeshing options
 		opt.metric_attribute = "scalar";
 
-		GEO::Attribute<double> scalar(M.vertices.attributes(), opt.metric_attribute);
-		for (int v = 0; v < M.vertices.nb(); ++v)
+		// Remesh volume
+		mmg3d_tet_remesh(V, T, S, OV, OF, OT, opt);
+	}
+
+	std::unique_ptr<Mesh> remesh_adaptive(const Eigen::MatrixXd &V, const Eigen::MatrixXi &cells, const Eigen::VectorXd &S,
+										  const MmgOptions &opt)
+	{
+		Eigen::MatrixXd OV;
+		Eigen::MatrixXi OF, OT;
+		if (cells.cols() == 3)
 		{
-			scalar[v] = S(v);
+			remesh_adaptive_2d(V, cells, S, OV, OF, opt);
+			return Mesh::create(OV, OF);
 		}
 
-		// Remesh volume
-		mmg3d_tet_remesh(M, M_out, opt);
+		assert(cells.cols() == 4);
+		remesh_adaptive_3d(V, cells, S, OV, OF, OT, opt);
+		return Mesh::create(OV, OT);
+	}
+
+	Eigen::VectorXd sizing_from_error_indicator(const Eigen::MatrixXd &V, const Eigen::MatrixXi &cells,
+												const Eigen::VectorXd &indicator, const int order,
+												const MmgOptions &opt)
+	{
+		assert(indicator.size() == cells.rows());
+		assert(order >= 1);
+
+		// Equidistribution: every element should carry the same share of the total squared error
+		const double target = indicator.norm() / std::sqrt(std::max<double>(cells.rows(), 1));
+
+		// η_e ∝ h_e^p, so the size giving the target error is h_e (η* / η_e)^(1/p)
+		Eigen::VectorXd element_sizes(cells.rows());
+		utils::maybe_parallel_for(cells.rows(), [&](int start, int end, int thread_id) {
+			for (int e = start; e < end; ++e)
+			{
+				double h = 0;
+				for (int i = 0; i < cells.cols(); ++i)
+					for (int j = i + 1; j < cells.cols(); ++j)
+						h = std::max(h, (V.row(cells(e, i)) - V.row(cells(e, j))).norm());
+
+				double new_h = opt.hmax;
+				if (indicator(e) > 0)
+					new_h = h * std::pow(target / indicator(e), 1.0 / order);
+				element_sizes(e) = std::clamp(new_h, opt.hmin, opt.hmax);
+			}
+		});
+
+		// The size of a vertex is the smallest one of its elements
+		Eigen::VectorXd S = Eigen::VectorXd::Constant(V.rows(), opt.hmax);
+		for (int e = 0; e < cells.rows(); ++e)
+			for (int i = 0; i < cells.cols(); ++i)
+				S(cells(e, i)) = std::min(S(cells(e, i)), element_sizes(e));
 
-		// Convert output
-		from_geogram_mesh(M_out, OV, OF, OT);
+		return S;
 	}
 
 } // namespace polyfem::mesh
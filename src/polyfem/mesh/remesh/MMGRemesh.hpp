@@ -8,10 +8,13 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 #include <Eigen/Dense>
+
+#include <memory>
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace polyfem::mesh
 {
+	class Mesh;
 
 	// See MmgTools documentation for interpreation
 	// https://www.mmgtools.org/mmg-remesher-try-mmg/mmg-remesher-options
@@ -66,6 +69,31 @@ namespace polyfem::mesh
 	void remesh_adaptive_3d(const Eigen::MatrixXd &V, const Eigen::MatrixXi &T, const Eigen::VectorXd &S,
 							Eigen::MatrixXd &OV, Eigen::MatrixXi &OF, Eigen::MatrixXi &OT, MmgOptions opt = MmgOptions());
 
+	///
+	/// Remesh a triangle or tet-mesh adaptively and build the polyfem mesh of the result.
+	///
+	/// @param[in]  V     { #V x (2|3) input mesh vertices }
+	/// @param[in]  cells { #C x (3|4) input mesh triangles or tetrahedra }
+	/// @param[in]  S     { #V x 1 per-vertex scalar field to follow }
+	/// @return     remeshed mesh
+	///
+	std::unique_ptr<Mesh> remesh_adaptive(const Eigen::MatrixXd &V, const Eigen::MatrixXi &cells, const Eigen::VectorXd &S,
+										  const MmgOptions &opt = MmgOptions());
+
+	///
+	/// Per-vertex target size equidistributing a per-element error indicator (e.g., Zienkiewicz-Zhu).
+	///
+	/// @param[in]  V         { #V x (2|3) mesh vertices }
+	/// @param[in]  cells     { #C x (3|4) mesh triangles or tetrahedra }
+	/// @param[in]  indicator { #C x 1 per-element error indicator }
+	/// @param[in]  order     { convergence order of the indicator in the element size }
+	/// @param[in]  opt       { hmin and hmax bound the sizes }
+	/// @return     { #V x 1 per-vertex size, the smallest of the incident elements }
+	///
+	Eigen::VectorXd sizing_from_error_indicator(const Eigen::MatrixXd &V, const Eigen::MatrixXi &cells,
+												const Eigen::VectorXd &indicator, const int order,
+												const MmgOptions &opt = MmgOptions());
+
 } // namespace polyfem::mesh
 
 #endif
@@ -34,11 +34,66 @@ namespace polyfem::mesh
 				return false;
 			});
 
+		// Without contact, all the forms are sums over the elements and overlapping patches share their energies
+		if (!include_global_boundary)
+		{
+			double energy = 0;
+			for (const Tuple &t : local_mesh_tuples)
+				energy += element_energy(t);
+			return energy;
+		}
+
 		LocalMesh<Super> local_mesh(*this, local_mesh_tuples, include_global_boundary);
 		LocalRelaxationData data(this->state, local_mesh, this->current_time, include_global_boundary);
 		return data.solve_data.nl_problem->value(data.sol());
 	}
 
+	template <class WMTKMesh>
+	void PhysicsRemesher<WMTKMesh>::element_energy_key(
+		const Tuple &t, std::vector<int> &ids, Eigen::VectorXd &values) const
+	{
+		const size_t tid = this->element_id(t);
+		const auto vids = this->element_vids(t);
+
+		ids.clear();
+		std::vector<double> tmp;
+		for (const size_t vid : vids)
+		{
+			const auto &v = vertex_attrs[vid];
+			ids.push_back(vid);
+			ids.push_back(v.fixed);
+			tmp.insert(tmp.end(), v.rest_position.data(), v.rest_position.data() + v.rest_position.size());
+			tmp.insert(tmp.end(), v.position.data(), v.position.data() + v.position.size());
+			tmp.insert(tmp.end(), v.projection_quantities.data(), v.projection_quantities.data() + v.projection_quantities.size());
+		}
+		ids.push_back(this->element_attrs[tid].body_id);
+		for (int i = 0; i < Super::FACETS_PER_ELEMENT; ++i)
+			ids.push_back(this->boundary_attrs[this->facet_id(this->tuple_from_facet(tid, i))].boundary_id);
+
+		values = Eigen::Map<const Eigen::VectorXd>(tmp.data(), tmp.size());
+	}
+
+	template <class WMTKMesh>
+	double PhysicsRemesher<WMTKMesh>::element_energy(const Tuple &t) const
+	{
+		std::vector<int> ids;
+		Eigen::VectorXd values;
+		element_energy_key(t, ids, values);
+
+		// Operations do not keep element ids stable, so the entry is validated against the element data
+		auto &cache = element_energies.local();
+		const auto it = cache.find(this->element_id(t));
+		if (it != cache.end() && it->second.ids == ids && it->second.values == values)
+			return it->second.energy;
+
+		LocalMesh<Super> local_mesh(*this, std::vector<Tuple>(1, t), false);
+		LocalRelaxationData data(this->state, local_mesh, this->current_time, false);
+		const double energy = data.solve_data.nl_problem->value(data.sol());
+
+		cache[this->element_id(t)] = ElementEnergy{std::move(ids), std::move(values), energy};
+		return energy;
+	}
+
 	template <class WMTKMesh>
 	typename PhysicsRemesher<WMTKMesh>::Operations
 	PhysicsRemesher<WMTKMesh>::renew_neighbor_tuples(
@@ -99,9 +154,10 @@ namespace polyfem::mesh
 			volume += this->element_volume(t);
 		assert(volume > 0);
 
-		LocalMesh<Super> local_mesh(*this, elements, false);
-		LocalRelaxationData data(this->state, local_mesh, this->current_time, false);
-		return data.solve_data.nl_problem->value(data.sol()) / volume; // average energy
+		double energy = 0;
+		for (const auto &t : elements)
+			energy += element_energy(t);
+		return energy / volume; // average energy
 	}
 
 	template <class WMTKMesh>
@@ -5,6 +5,8 @@
 #include <polyfem/mesh/remesh/wild_remesh/OperationCache.hpp>
 #include <polyfem/mesh/remesh/wild_remesh/LocalMesh.hpp>
 
+#include <tbb/enumerable_thread_specific.h>
+
 namespace polyfem::mesh
 {
 	template <class WMTKMesh>
@@ -97,19 +99,42 @@ namespace polyfem::mesh
 		}
 
 		/// @brief Compute the energy of a local n-ring around a vertex.
+		/// Without contact with the global boundary, the energy is the sum of the cached element energies.
 		/// @param local_mesh_center Center of the local n-ring.
 		/// @return Energy of the local n-ring.
 		double local_mesh_energy(const VectorNd &local_mesh_center) const;
 
 		/// @brief Get the energy of the local n-ring around a vertex.
-		double local_energy_before() const { return this->op_cache->local_energy; }
+		double local_energy_before() const { return this->op_cache()->local_energy; }
 
 		/// @brief Compute the average elastic energy of the faces containing an edge.
 		double edge_elastic_energy(const Tuple &e) const;
 
+		/// @brief Energy of a single element, reused while its vertices and attributes are unchanged.
+		/// @param t Element tuple
+		/// @return Energy of the element alone (no contact)
+		double element_energy(const Tuple &t) const;
+
 		/// @brief Write a visualization mesh of the priority queue
 		/// @param e current edge tuple to be split
 		void write_priority_queue_mesh(const std::string &path, const Tuple &e) const;
+
+	private:
+		/// @brief Cached energy of an element with the data it was computed from
+		struct ElementEnergy
+		{
+			/// @brief Vertex ids, fixed flags, body id, and boundary ids of the facets
+			std::vector<int> ids;
+			/// @brief Rest positions, positions, and projection quantities of the vertices
+			Eigen::VectorXd values;
+			double energy;
+		};
+
+		/// @brief Gather the data an element energy depends on
+		void element_energy_key(const Tuple &t, std::vector<int> &ids, Eigen::VectorXd &values) const;
+
+		/// @brief Element energies indexed by element id, one cache per thread
+		mutable tbb::enumerable_thread_specific<std::unordered_map<size_t, ElementEnergy>> element_energies;
 	};
 
 	class PhysicsTriRemesher : public PhysicsRemesher<wmtk::TriMesh>
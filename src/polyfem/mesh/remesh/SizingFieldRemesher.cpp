@@ -1,5 +1,7 @@
 #include "SizingFieldRemesher.hpp"
 
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
 #include <ipc/collision_mesh.hpp>
 #include <ipc/candidates/candidates.hpp>
 #include <ipc/broad_phase/hash_grid.hpp>
@@ -13,7 +15,7 @@ namespace polyfem::mesh
 	void SizingFieldRemesher<WMTKMesh>::split_edges()
 	{
 		Operations splits;
-		const std::unordered_map<size_t, double> edge_sizings = this->compute_edge_sizings();
+		const EdgeSizings edge_sizings = this->compute_edge_sizings();
 		double min = std::numeric_limits<double>::max();
 		double max = std::numeric_limits<double>::min();
 		for (const Tuple &e : WMTKMesh::get_edges())
@@ -40,7 +42,7 @@ namespace polyfem::mesh
 	void SizingFieldRemesher<WMTKMesh>::collapse_edges()
 	{
 		Operations collapses;
-		const std::unordered_map<size_t, double> edge_sizings = this->compute_edge_sizings();
+		const EdgeSizings edge_sizings = this->compute_edge_sizings();
 		for (const Tuple &e : WMTKMesh::get_edges())
 			if (edge_sizings.at(e.eid(*this)) <= 0.8)
 				collapses.emplace_back("edge_collapse", e);
@@ -75,27 +77,23 @@ namespace polyfem::mesh
 		if (!Super::collapse_edge_after(t))
 			return false;
 
+		// Only the edges around the new vertex changed, the others keep their sizing
+		std::vector<Tuple> edges;
 		if constexpr (Super::DIM == 2)
 		{
-			const std::unordered_map<size_t, double> edge_sizings = this->compute_edge_sizings();
-			for (const Tuple &e : WMTKMesh::get_one_ring_edges_for_vertex(t))
-				if (edge_sizings.at(e.eid(*this)) > 0.8)
-					return false;
+			edges = WMTKMesh::get_one_ring_edges_for_vertex(t);
 		}
 		else
 		{
-			const std::unordered_map<size_t, double> edge_sizings = this->compute_edge_sizings();
 			for (const Tuple &tet : WMTKMesh::get_one_ring_tets_for_vertex(t))
-			{
 				for (int i = 0; i < 6; ++i)
-				{
-					const Tuple e = WMTKMesh::tuple_from_edge(tet.tid(*this), i);
-					if (edge_sizings.at(e.eid(*this)) > 0.8)
-						return false;
-				}
-			}
+					edges.push_back(WMTKMesh::tuple_from_edge(tet.tid(*this), i));
 		}
 
+		for (const double sizing : this->compute_edge_sizings(edges))
+			if (sizing > 0.8)
+				return false;
+
 		return true;
 	}
 
@@ -213,114 +211,107 @@ namespace polyfem::mesh
 	}
 
 	template <class WMTKMesh>
-	std::unordered_map<size_t, double>
+	typename SizingFieldRemesher<WMTKMesh>::EdgeSizings
 	SizingFieldRemesher<WMTKMesh>::compute_edge_sizings() const
 	{
-		const SparseSizingField sizing_field =
-			combine_sizing_fields(
-				compute_elasticity_sizing_field(),
-				smooth_contact_sizing_field(compute_contact_sizing_field()));
+		size_t element_capacity;
+		if constexpr (std::is_same_v<wmtk::TriMesh, WMTKMesh>)
+			element_capacity = WMTKMesh::tri_capacity();
+		else
+			element_capacity = WMTKMesh::tet_capacity();
 
-		std::unordered_map<size_t, double> edge_sizings;
-		for (const Tuple &e : WMTKMesh::get_edges())
-		{
-			const std::array<size_t, 2> vids =
-				{{e.vid(*this), e.switch_vertex(*this).vid(*this)}};
+		const std::vector<Tuple> edges = WMTKMesh::get_edges();
+		const std::vector<double> sizings = compute_edge_sizings(edges);
 
-			const VectorNd xi_bar = vertex_attrs[vids[0]].rest_position;
-			const VectorNd xj_bar = vertex_attrs[vids[1]].rest_position;
+		// Edge ids are (element id, local edge id) pairs
+		EdgeSizings edge_sizings(
+			Super::EDGES_PER_ELEMENT * element_capacity,
+			std::numeric_limits<double>::quiet_NaN());
+		for (size_t i = 0; i < edges.size(); ++i)
+			edge_sizings[edges[i].eid(*this)] = sizings[i];
+		return edge_sizings;
+	}
 
-			const VectorNd xij_bar = xj_bar - xi_bar;
+	template <class WMTKMesh>
+	std::vector<double>
+	SizingFieldRemesher<WMTKMesh>::compute_edge_sizings(const std::vector<Tuple> &edges) const
+	{
+		const SparseSizingField contact_sizing_field =
+			smooth_contact_sizing_field(compute_contact_sizing_field());
 
-			const MatrixNd M = sizing_field.at(e.eid(*this));
+		std::vector<double> edge_sizings(edges.size());
+		utils::maybe_parallel_for(edges.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const Tuple &e = edges[i];
+				MatrixNd M = edge_elasticity_sizing(e);
 
-			edge_sizings[e.eid(*this)] = sqrt(xij_bar.transpose() * M * xij_bar);
-		}
+				// same as combine_sizing_fields
+				const auto it = contact_sizing_field.find(e.eid(*this));
+				if (it != contact_sizing_field.end())
+					M = (M + it->second) / 2;
+
+				edge_sizings[i] = edge_sizing(e, M);
+			}
+		});
 		return edge_sizings;
 	}
 
 	template <class WMTKMesh>
-	typename SizingFieldRemesher<WMTKMesh>::SparseSizingField
-	SizingFieldRemesher<WMTKMesh>::compute_elasticity_sizing_field() const
+	double SizingFieldRemesher<WMTKMesh>::edge_sizing(const Tuple &e, const MatrixNd &M) const
 	{
-		std::unordered_map<size_t, MatrixNd> Fs, Fs_inv;
-		for (const Tuple &t : this->get_elements())
-		{
-			const auto vids = this->element_vids(t);
-			MatrixNd Dm, Ds;
-			if constexpr (std::is_same_v<WMTKMesh, wmtk::TriMesh>)
-			{
-				Dm.col(0) = vertex_attrs[vids[1]].rest_position - vertex_attrs[vids[0]].rest_position;
-				Dm.col(1) = vertex_attrs[vids[2]].rest_position - vertex_attrs[vids[0]].rest_position;
-				Ds.col(0) = vertex_attrs[vids[1]].position - vertex_attrs[vids[0]].position;
-				Ds.col(1) = vertex_attrs[vids[2]].position - vertex_attrs[vids[0]].position;
-			}
-			else
-			{
-				Dm.col(0) = vertex_attrs[vids[1]].rest_position - vertex_attrs[vids[0]].rest_position;
-				Dm.col(1) = vertex_attrs[vids[2]].rest_position - vertex_attrs[vids[0]].rest_position;
-				Dm.col(2) = vertex_attrs[vids[3]].rest_position - vertex_attrs[vids[0]].rest_position;
-				Ds.col(0) = vertex_attrs[vids[1]].position - vertex_attrs[vids[0]].position;
-				Ds.col(1) = vertex_attrs[vids[2]].position - vertex_attrs[vids[0]].position;
-				Ds.col(2) = vertex_attrs[vids[3]].position - vertex_attrs[vids[0]].position;
-			}
-			Fs[this->element_id(t)] = Ds * Dm.inverse();
-			Fs_inv[this->element_id(t)] = Dm * Ds.inverse();
-		}
+		const VectorNd xi_bar = vertex_attrs[e.vid(*this)].rest_position;
+		const VectorNd xj_bar = vertex_attrs[e.switch_vertex(*this).vid(*this)].rest_position;
 
-		const double k = 1.0;
+		const VectorNd xij_bar = xj_bar - xi_bar;
 
-		std::unordered_map<size_t, VectorNd> element_centers;
-		for (const Tuple &t : this->get_elements())
-		{
-			VectorNd center = VectorNd::Zero();
-			const auto &vids = this->element_vids(t);
-			for (const size_t &vid : vids)
-				center += vertex_attrs[vid].rest_position;
-			element_centers[this->element_id(t)] = center / vids.size();
-		}
+		return sqrt(xij_bar.transpose() * M * xij_bar);
+	}
 
-		SparseSizingField element_sizing_field;
-		for (const Tuple &t : this->get_elements())
+	template <class WMTKMesh>
+	typename SizingFieldRemesher<WMTKMesh>::MatrixNd
+	SizingFieldRemesher<WMTKMesh>::element_elasticity_sizing(const Tuple &t) const
+	{
+		const auto vids = this->element_vids(t);
+		MatrixNd Dm, Ds;
+		for (int i = 0; i < Super::DIM; ++i)
 		{
-			const size_t tid = this->element_id(t);
-
-			// std::unordered_set<size_t> adjacent_tids;
-			// for (const Tuple &v : this->element_vertices(t))
-			// 	for (const Tuple &adj_t : this->get_one_ring_elements_for_vertex(v))
-			// 		adjacent_tids.insert(this->element_id(adj_t));
-			// adjacent_tids.erase(tid);
-
-			// const VectorNd &t_center = element_centers.at(tid);
-
-			// MatrixNd M = MatrixNd::Zero();
-			// for (const size_t adj_tid : adjacent_tids)
-			// {
-			// 	const VectorNd dt = element_centers.at(adj_tid) - t_center;
-			// 	M += dt * (dt.transpose() / dt.squaredNorm())
-			// 		 * std::max((Fs[tid] * Fs_inv[adj_tid]).norm(),
-			// 					(Fs[adj_tid] * Fs_inv[tid]).norm())
-			// 		 / dt.norm();
-			// }
-			// M.array() *= k / adjacent_tids.size();
-
-			element_sizing_field[tid] = Fs[tid].transpose() * Fs[tid];
+			Dm.col(i) = vertex_attrs[vids[i + 1]].rest_position - vertex_attrs[vids[0]].rest_position;
+			Ds.col(i) = vertex_attrs[vids[i + 1]].position - vertex_attrs[vids[0]].position;
 		}
-		assert(!element_sizing_field.empty());
+		const MatrixNd F = Ds * Dm.inverse();
+		return F.transpose() * F;
+	}
+
+	template <class WMTKMesh>
+	typename SizingFieldRemesher<WMTKMesh>::MatrixNd
+	SizingFieldRemesher<WMTKMesh>::edge_elasticity_sizing(const Tuple &e) const
+	{
+		const std::vector<Tuple> incident_elements = this->get_incident_elements_for_edge(e);
+		assert(!incident_elements.empty());
+
+		MatrixNd M = MatrixNd::Zero();
+		for (const Tuple &t : incident_elements)
+			M += element_elasticity_sizing(t);
+		return M / (incident_elements.size() * std::pow(state.starting_max_edge_length, 2));
+	}
+
+	template <class WMTKMesh>
+	typename SizingFieldRemesher<WMTKMesh>::SparseSizingField
+	SizingFieldRemesher<WMTKMesh>::compute_elasticity_sizing_field() const
+	{
+		const std::vector<Tuple> edges = this->get_edges();
+
+		std::vector<MatrixNd> edge_fields(edges.size());
+		utils::maybe_parallel_for(edges.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				edge_fields[i] = edge_elasticity_sizing(edges[i]);
+		});
 
 		SparseSizingField sizing_field;
-		for (const Tuple &e : this->get_edges())
-		{
-			const size_t eid = e.eid(*this);
-			const auto &incident_elements = this->get_incident_elements_for_edge(e);
-			for (const Tuple &t : incident_elements)
-			{
-				if (sizing_field.find(eid) == sizing_field.end())
-					sizing_field[eid] = MatrixNd::Zero();
-				sizing_field[eid] += element_sizing_field[this->element_id(t)];
-			}
-			sizing_field[eid] /= incident_elements.size() * std::pow(state.starting_max_edge_length, 2);
-		}
+		for (size_t i = 0; i < edges.size(); ++i)
+			sizing_field[edges[i].eid(*this)] = edge_fields[i];
+		assert(!sizing_field.empty());
 
 		return sizing_field;
 	}
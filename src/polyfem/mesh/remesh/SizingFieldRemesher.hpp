@@ -51,13 +51,31 @@ namespace polyfem::mesh
 
 		SparseSizingField compute_elasticity_sizing_field() const;
 
-		std::unordered_map<size_t, double> compute_edge_sizings() const;
+		/// @brief Sizing of every edge, indexed by edge id (NaN for the unused ids)
+		using EdgeSizings = std::vector<double>;
+
+		/// @brief Compute the sizing of all the edges in parallel
+		EdgeSizings compute_edge_sizings() const;
+
+		/// @brief Compute the sizing of a subset of the edges
+		/// @param edges Edges to evaluate, the elasticity part is only computed on their incident elements
+		/// @return Sizing of every edge, in the order of edges
+		std::vector<double> compute_edge_sizings(const std::vector<Tuple> &edges) const;
 
 		static SparseSizingField combine_sizing_fields(
 			const SparseSizingField &field1,
 			const SparseSizingField &field2);
 
 	private:
+		/// @brief Elastic sizing metric FᵀF of an element
+		MatrixNd element_elasticity_sizing(const Tuple &t) const;
+
+		/// @brief Elastic sizing metric of an edge, the average of its incident elements
+		MatrixNd edge_elasticity_sizing(const Tuple &e) const;
+
+		/// @brief Sizing of an edge from its metric, the length of the edge in the rest configuration
+		double edge_sizing(const Tuple &e, const MatrixNd &M) const;
+
 		template <typename Candidates>
 		SparseSizingField compute_contact_sizing_field_from_candidates(
 			const Candidates &candidates,
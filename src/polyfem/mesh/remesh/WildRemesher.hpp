@@ -7,6 +7,8 @@
 #include <wmtk/TetMesh.h>
 #include <wmtk/ExecutionScheduler.hpp>
 
+#include <tbb/enumerable_thread_specific.h>
+
 #include <type_traits>
 
 namespace polyfem::mesh
@@ -414,11 +416,16 @@ namespace polyfem::mesh
 		int m_n_quantities;
 		double total_volume;
 
-		// TODO: make this thread local
-		typename std::conditional<
+		using OperationCache = typename std::conditional<
 			std::is_same<WMTKMesh, wmtk::TriMesh>::value,
-			std::shared_ptr<TriOperationCache>,
-			std::shared_ptr<TetOperationCache>>::type op_cache;
+			TriOperationCache,
+			TetOperationCache>::type;
+
+		/// @brief Cache of the operation executed by the calling thread
+		std::shared_ptr<OperationCache> &op_cache() const { return op_caches.local(); }
+
+		/// @brief One operation cache per thread, so that operations on disjoint patches can run concurrently
+		mutable tbb::enumerable_thread_specific<std::shared_ptr<OperationCache>> op_caches;
 
 	private:
 		wmtk::AttributeCollection<EdgeAttributes> edge_attrs; // not used for tri mesh
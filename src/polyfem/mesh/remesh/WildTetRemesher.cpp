@@ -224,7 +224,7 @@ namespace polyfem::mesh
 	template <>
 	bool WildTetRemesher::is_boundary_op() const
 	{
-		return op_cache->is_boundary_op();
+		return op_cache()->is_boundary_op();
 	}
 
 	template <>
@@ -161,7 +161,7 @@ namespace polyfem::mesh
 	template <>
 	bool WildTriRemesher::is_boundary_op() const
 	{
-		return op_cache->is_boundary_op();
+		return op_cache()->is_boundary_op();
 	}
 
 	template <>
@@ -10,8 +10,8 @@ namespace polyfem::mesh
 	template <class WMTKMesh>
 	void WildRemesher<WMTKMesh>::cache_collapse_edge(const Tuple &e, const CollapseEdgeTo collapse_to)
 	{
-		op_cache = decltype(op_cache)::element_type::collapse_edge(*this, e);
-		op_cache->collapse_to = collapse_to;
+		op_cache() = OperationCache::collapse_edge(*this, e);
+		op_cache()->collapse_to = collapse_to;
 	}
 
 	template <class WMTKMesh>
@@ -89,16 +89,16 @@ namespace polyfem::mesh
 		const VectorNd &v0 = vertex_attrs[t.vid(*this)].rest_position;
 		const VectorNd &v1 = vertex_attrs[t.switch_vertex(*this).vid(*this)].rest_position;
 
-		switch (this->op_cache->collapse_to)
+		switch (this->op_cache()->collapse_to)
 		{
 		case CollapseEdgeTo::V0:
-			this->op_cache->local_energy = local_mesh_energy(v0);
+			this->op_cache()->local_energy = local_mesh_energy(v0);
 			break;
 		case CollapseEdgeTo::V1:
-			this->op_cache->local_energy = local_mesh_energy(v1);
+			this->op_cache()->local_energy = local_mesh_energy(v1);
 			break;
 		case CollapseEdgeTo::MIDPOINT:
-			this->op_cache->local_energy = local_mesh_energy((v0 + v1) / 2);
+			this->op_cache()->local_energy = local_mesh_energy((v0 + v1) / 2);
 			break;
 		default:
 			assert(false);
@@ -312,14 +312,14 @@ namespace polyfem::mesh
 	void WildTriRemesher::map_edge_collapse_vertex_attributes(const Tuple &t)
 	{
 		vertex_attrs[t.vid(*this)] = VertexAttributes::edge_collapse(
-			op_cache->v0().second, op_cache->v1().second, op_cache->collapse_to);
+			op_cache()->v0().second, op_cache()->v1().second, op_cache()->collapse_to);
 	}
 
 	template <>
 	void WildTetRemesher::map_edge_collapse_vertex_attributes(const Tuple &t)
 	{
 		vertex_attrs[t.vid(*this)] = VertexAttributes::edge_collapse(
-			op_cache->v0().second, op_cache->v1().second, op_cache->collapse_to);
+			op_cache()->v0().second, op_cache()->v1().second, op_cache()->collapse_to);
 	}
 
 	// -------------------------------------------------------------------------
@@ -330,9 +330,9 @@ namespace polyfem::mesh
 	template <>
 	void WildTetRemesher::map_edge_collapse_edge_attributes(const Tuple &t)
 	{
-		const auto &[old_v0_id, old_v0] = op_cache->v0();
-		const auto &[old_v1_id, old_v1] = op_cache->v1();
-		const auto &old_edges = op_cache->edges();
+		const auto &[old_v0_id, old_v0] = op_cache()->v0();
+		const auto &[old_v1_id, old_v1] = op_cache()->v1();
+		const auto &old_edges = op_cache()->edges();
 
 		const size_t new_vid = t.vid(*this);
 
@@ -380,9 +380,9 @@ namespace polyfem::mesh
 	template <>
 	void WildTriRemesher::map_edge_collapse_boundary_attributes(const Tuple &t)
 	{
-		const auto &[old_v0_id, old_v0] = op_cache->v0();
-		const auto &[old_v1_id, old_v1] = op_cache->v1();
-		const auto &old_edges = op_cache->edges();
+		const auto &[old_v0_id, old_v0] = op_cache()->v0();
+		const auto &[old_v1_id, old_v1] = op_cache()->v1();
+		const auto &old_edges = op_cache()->edges();
 
 		const size_t new_vid = t.vid(*this);
 
@@ -435,9 +435,9 @@ namespace polyfem::mesh
 	template <>
 	void WildTetRemesher::map_edge_collapse_boundary_attributes(const Tuple &t)
 	{
-		const auto &[old_v0_id, old_v0] = op_cache->v0();
-		const auto &[old_v1_id, old_v1] = op_cache->v1();
-		const auto &old_faces = op_cache->faces();
+		const auto &[old_v0_id, old_v0] = op_cache()->v0();
+		const auto &[old_v1_id, old_v1] = op_cache()->v1();
+		const auto &old_faces = op_cache()->faces();
 
 		const size_t new_vid = t.vid(*this);
 
@@ -3,6 +3,7 @@
 #include <polyfem/solver/forms/BodyForm.hpp>
 #include <polyfem/solver/NLProblem.hpp>
 #include <polyfem/time_integrator/ImplicitTimeIntegrator.hpp>
+#include <polyfem/utils/Logger.hpp>
 
 #include <polysolve/nonlinear/Solver.hpp>
 
@@ -160,7 +161,9 @@ namespace polyfem::mesh
 			fmt::format(fmt::fg(fmt::terminal_color::green), "accept");
 		static const std::string reject_str =
 			fmt::format(fmt::fg(fmt::terminal_color::yellow), "reject");
-		logger().debug(
+		// one message per local relaxation would flood the log, at most ten per second
+		POLYFEM_LOG_EVERY_N_SEC(
+			spdlog::level::debug, 0.1,
 			"[{:s}] E0={:<10g} E1={:<10g} (E0-E1)={:<11g} tol={:g} local_ndof={:d} n_iters={:d}",
 			accept ? accept_str : reject_str, local_energy_before(),
 			local_energy_after, abs_diff, dt_sqr * acceptance_tolerance,
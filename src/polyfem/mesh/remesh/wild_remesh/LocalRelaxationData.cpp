@@ -243,7 +243,7 @@ namespace polyfem::mesh
 				dirichlet_nodes_position, neumann_nodes_position, n_bases(),
 				dim(), bases, /*geom_bases=*/bases, mass_assembly_vals_cache,
 				*state.problem, state.args["space"]["advanced"]["bc_method"],
-				rhs_solver_params);
+				rhs_solver_params, state.args["space"]["advanced"]["initial_projection"]);
 
 			solve_data.rhs_assembler->assemble(mass_matrix_assembler->density(), rhs);
 			rhs *= -1;
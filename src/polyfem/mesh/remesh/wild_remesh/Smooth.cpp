@@ -172,15 +172,15 @@ namespace polyfem::mesh
 		if (!Super::smooth_before(v))
 			return false;
 
-		if (this->op_cache == nullptr)
+		if (this->op_cache() == nullptr)
 		{
 			if constexpr (std::is_same_v<WMTKMesh, wmtk::TriMesh>)
-				this->op_cache = std::make_shared<TriOperationCache>();
+				this->op_cache() = std::make_shared<TriOperationCache>();
 			else
-				this->op_cache = std::make_shared<TetOperationCache>();
+				this->op_cache() = std::make_shared<TetOperationCache>();
 		}
 
-		this->op_cache->local_energy = local_mesh_energy(
+		this->op_cache()->local_energy = local_mesh_energy(
 			vertex_attrs[v.vid(*this)].rest_position);
 
 		return true;
@@ -5,7 +5,7 @@ namespace polyfem::mesh
 	template <class WMTKMesh>
 	void WildRemesher<WMTKMesh>::cache_split_edge(const Tuple &e)
 	{
-		op_cache = decltype(op_cache)::element_type::split_edge(*this, e);
+		op_cache() = OperationCache::split_edge(*this, e);
 	}
 
 	template <class WMTKMesh>
@@ -50,10 +50,10 @@ namespace polyfem::mesh
 
 		const auto &v0 = this->vertex_attrs[e.vid(*this)].rest_position;
 		const auto &v1 = this->vertex_attrs[e.switch_vertex(*this).vid(*this)].rest_position;
-		this->op_cache->local_energy = local_mesh_energy((v0 + v1) / 2);
-		// assert(this->op_cache->local_energy >= 0);
+		this->op_cache()->local_energy = local_mesh_energy((v0 + v1) / 2);
+		// assert(this->op_cache()->local_energy >= 0);
 		// Do not split if the energy of the local mesh is too small
-		// if (this->op_cache->local_energy < args["split"]["acceptance_tolerance"].template get<double>())
+		// if (this->op_cache()->local_energy < args["split"]["acceptance_tolerance"].template get<double>())
 		// 	return false;
 
 		return true;
@@ -85,8 +85,8 @@ namespace polyfem::mesh
 		else
 			new_vertex = t;
 
-		const auto &[old_v0_id, v0] = op_cache->v0();
-		const auto &[old_v1_id, v1] = op_cache->v1();
+		const auto &[old_v0_id, v0] = op_cache()->v0();
+		const auto &[old_v1_id, v1] = op_cache()->v1();
 
 		VertexAttributes &new_vertex_attr = vertex_attrs[new_vertex.vid(*this)];
 		constexpr double alpha = 0.5; // TODO: maybe we want to use a different barycentric coordinate?
@@ -201,9 +201,9 @@ namespace polyfem::mesh
 	template <>
 	void WildTetRemesher::map_edge_split_edge_attributes(const Tuple &new_vertex)
 	{
-		const auto &[old_v0_id, old_v0] = op_cache->v0();
-		const auto &[old_v1_id, old_v1] = op_cache->v1();
-		const auto &old_edges = op_cache->edges();
+		const auto &[old_v0_id, old_v0] = op_cache()->v0();
+		const auto &[old_v1_id, old_v1] = op_cache()->v1();
+		const auto &old_edges = op_cache()->edges();
 
 		EdgeAttributes old_split_edge = old_edges.at({{old_v0_id, old_v1_id}});
 		old_split_edge.op_attempts = 0;
@@ -254,9 +254,9 @@ namespace polyfem::mesh
 	template <>
 	void WildTriRemesher::map_edge_split_boundary_attributes(const Tuple &new_vertex)
 	{
-		const auto &[old_v0_id, v0] = op_cache->v0();
-		const auto &[old_v1_id, v1] = op_cache->v1();
-		const auto &old_edges = op_cache->edges();
+		const auto &[old_v0_id, v0] = op_cache()->v0();
+		const auto &[old_v1_id, v1] = op_cache()->v1();
+		const auto &old_edges = op_cache()->edges();
 
 		BoundaryAttributes old_split_edge = old_edges.at({{old_v0_id, old_v1_id}});
 		old_split_edge.op_attempts = 0;
@@ -302,9 +302,9 @@ namespace polyfem::mesh
 	template <>
 	void WildTetRemesher::map_edge_split_boundary_attributes(const Tuple &new_vertex)
 	{
-		const auto &[old_v0_id, old_v0] = op_cache->v0();
-		const auto &[old_v1_id, old_v1] = op_cache->v1();
-		const auto &old_faces = op_cache->faces();
+		const auto &[old_v0_id, old_v0] = op_cache()->v0();
+		const auto &[old_v1_id, old_v1] = op_cache()->v1();
+		const auto &old_faces = op_cache()->faces();
 
 		const size_t new_vid = new_vertex.vid(*this);
 		for (const auto &t : get_one_ring_tets_for_vertex(new_vertex))
@@ -352,7 +352,7 @@ namespace polyfem::mesh
 	template <>
 	void WildTriRemesher::map_edge_split_element_attributes(const Tuple &t)
 	{
-		const auto &old_faces = op_cache->faces();
+		const auto &old_faces = op_cache()->faces();
 
 		Tuple nav = t.switch_vertex(*this);
 		element_attrs[nav.fid(*this)] = old_faces[0];
@@ -371,9 +371,9 @@ namespace polyfem::mesh
 	template <>
 	void WildTetRemesher::map_edge_split_element_attributes(const Tuple &new_vertex)
 	{
-		const auto &[old_v0_id, old_v0] = op_cache->v0();
-		const auto &[old_v1_id, old_v1] = op_cache->v1();
-		const auto &old_tets = op_cache->tets();
+		const auto &[old_v0_id, old_v0] = op_cache()->v0();
+		const auto &[old_v1_id, old_v1] = op_cache()->v1();
+		const auto &old_tets = op_cache()->tets();
 
 		const size_t new_vid = new_vertex.vid(*this);
 		const std::vector<Tuple> new_tets = get_one_ring_tets_for_vertex(new_vertex);
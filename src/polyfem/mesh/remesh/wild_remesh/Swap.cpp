@@ -8,9 +8,9 @@ namespace polyfem::mesh
 	void WildRemesher<WMTKMesh>::cache_swap_edge(const Tuple &e)
 	{
 		if constexpr (std::is_same_v<WMTKMesh, wmtk::TriMesh>)
-			op_cache = TriOperationCache::swap_edge(*this, e);
+			op_cache() = TriOperationCache::swap_edge(*this, e);
 		else
-			op_cache = TetOperationCache::swap_32(*this, e);
+			op_cache() = TetOperationCache::swap_32(*this, e);
 	}
 
 	template <class WMTKMesh>
@@ -75,7 +75,7 @@ namespace polyfem::mesh
 
 		const VectorNd &v0 = vertex_attrs[e.vid(*this)].rest_position;
 		const VectorNd &v1 = vertex_attrs[e.switch_vertex(*this).vid(*this)].rest_position;
-		this->op_cache->local_energy = local_mesh_energy((v0 + v1) / 2);
+		this->op_cache()->local_energy = local_mesh_energy((v0 + v1) / 2);
 
 		return true;
 	}
@@ -83,7 +83,7 @@ namespace polyfem::mesh
 	template <>
 	void WildTriRemesher::map_edge_swap_edge_attributes(const Tuple &e)
 	{
-		const auto &old_edges = op_cache->edges();
+		const auto &old_edges = op_cache()->edges();
 		for (const Tuple &e : get_edges_for_elements({{e, e.switch_face(*this).value()}}))
 		{
 			size_t v0_id = e.vid(*this);
@@ -99,7 +99,7 @@ namespace polyfem::mesh
 				assert(e.switch_face(*this).has_value());
 				// swapped interior edge
 				boundary_attrs[e.eid(*this)] =
-					old_edges.find({{op_cache->v0().first, op_cache->v1().first}})->second;
+					old_edges.find({{op_cache()->v0().first, op_cache()->v1().first}})->second;
 			}
 		}
 	}
@@ -107,9 +107,9 @@ namespace polyfem::mesh
 	template <>
 	void WildTriRemesher::map_edge_swap_element_attributes(const Tuple &e)
 	{
-		assert(op_cache->faces()[0].body_id == op_cache->faces()[1].body_id);
-		element_attrs[e.fid(*this)] = op_cache->faces()[0];
-		element_attrs[e.switch_face(*this)->fid(*this)] = op_cache->faces()[1];
+		assert(op_cache()->faces()[0].body_id == op_cache()->faces()[1].body_id);
+		element_attrs[e.fid(*this)] = op_cache()->faces()[0];
+		element_attrs[e.switch_face(*this)->fid(*this)] = op_cache()->faces()[1];
 	}
 
 	template <>
@@ -1,9 +1,22 @@
 #include "ProblemWithSolution.hpp"
 
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
 namespace polyfem
 {
 	namespace problem
 	{
+		namespace
+		{
+			/// points padded to 3d, used as keys of the table
+			Eigen::Vector3d table_key(const Eigen::MatrixXd &pts, const long i)
+			{
+				Eigen::Vector3d key = Eigen::Vector3d::Zero();
+				key.head(pts.cols()) = pts.row(i).transpose();
+				return key;
+			}
+		} // namespace
+
 		ProblemWithSolution::ProblemWithSolution(const std::string &name)
 			: Problem(name)
 		{
@@ -14,18 +27,35 @@ namespace polyfem
 			const int size = size_for(pts);
 			val.resize(pts.rows(), size);
 
-			for (long i = 0; i < pts.rows(); ++i)
-			{
-				DiffScalarBase::setVariableCount(pts.cols());
-				AutodiffHessianPt pt(pts.cols());
-
-				for (long d = 0; d < pts.cols(); ++d)
-					pt(d) = AutodiffScalarHessian(d, pts(i, d));
-
-				const auto res = eval_fun(pt, t);
-
-				val.row(i) = assembler.compute_rhs(res).transpose();
-			}
+			utils::maybe_parallel_for(pts.rows(), [&](int start, int end, int thread_id) {
+				for (long i = start; i < end; ++i)
+				{
+					Tabulated entry = find(pts, i, t, &assembler);
+					if (entry.rhs.size() == 0)
+					{
+						DiffScalarBase::setVariableCount(pts.cols());
+						AutodiffHessianPt pt(pts.cols());
+
+						for (long d = 0; d < pts.cols(); ++d)
+							pt(d) = AutodiffScalarHessian(d, pts(i, d));
+
+						const auto res = eval_fun(pt, t);
+
+						// the hessian evaluation gives the exact solution and its gradient for free
+						entry.rhs = assembler.compute_rhs(res).transpose();
+						entry.value.resize(size);
+						entry.grad.resize(pts.cols() * size);
+						for (int m = 0; m < size; ++m)
+						{
+							entry.value(m) = res(m).getValue();
+							entry.grad.segment(m * pts.cols(), pts.cols()) = res(m).getGradient().transpose();
+						}
+						store(pts, i, t, &assembler, entry);
+					}
+
+					val.row(i) = entry.rhs;
+				}
+			});
 		}
 
 		void ProblemWithSolution::dirichlet_bc(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
@@ -37,10 +67,19 @@ namespace polyfem
 		{
 			val.resize(pts.rows(), size_for(pts));
 
-			for (long i = 0; i < pts.rows(); ++i)
-			{
-				val.row(i) = eval_fun(VectorNd(pts.row(i)), t);
-			}
+			utils::maybe_parallel_for(pts.rows(), [&](int start, int end, int thread_id) {
+				for (long i = start; i < end; ++i)
+				{
+					Tabulated entry = find(pts, i, t, nullptr);
+					if (entry.value.size() == 0)
+					{
+						entry.value = eval_fun(VectorNd(pts.row(i)), t).transpose();
+						store(pts, i, t, nullptr, entry);
+					}
+
+					val.row(i) = entry.value;
+				}
+			});
 		}
 
 		void ProblemWithSolution::exact_grad(const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
@@ -48,24 +87,89 @@ namespace polyfem
 			const int size = size_for(pts);
 			val.resize(pts.rows(), pts.cols() * size);
 
-			for (long i = 0; i < pts.rows(); ++i)
-			{
-				DiffScalarBase::setVariableCount(pts.cols());
-				AutodiffGradPt pt(pts.cols());
+			utils::maybe_parallel_for(pts.rows(), [&](int start, int end, int thread_id) {
+				for (long i = start; i < end; ++i)
+				{
+					Tabulated entry = find(pts, i, t, nullptr);
+					if (entry.grad.size() == 0)
+					{
+						DiffScalarBase::setVariableCount(pts.cols());
+						AutodiffGradPt pt(pts.cols());
+
+						for (long d = 0; d < pts.cols(); ++d)
+							pt(d) = AutodiffScalarGrad(d, pts(i, d));
+
+						const auto res = eval_fun(pt, t);
+
+						entry.value.resize(size);
+						entry.grad.resize(pts.cols() * size);
+						for (int m = 0; m < size; ++m)
+						{
+							entry.value(m) = res(m).getValue();
+							entry.grad.segment(m * pts.cols(), pts.cols()) = res(m).getGradient().transpose();
+						}
+						store(pts, i, t, nullptr, entry);
+					}
+
+					val.row(i) = entry.grad;
+				}
+			});
+		}
 
-				for (long d = 0; d < pts.cols(); ++d)
-					pt(d) = AutodiffScalarGrad(d, pts(i, d));
+		void ProblemWithSolution::clear_table() const
+		{
+			std::lock_guard<std::mutex> lock(table_mutex_);
+			table_.clear();
+			table_t_ = std::numeric_limits<double>::quiet_NaN();
+			table_assembler_ = nullptr;
+		}
 
-				const auto res = eval_fun(pt, t);
+		void ProblemWithSolution::validate_table(const double t, const assembler::Assembler *assembler) const
+		{
+			if (t != table_t_)
+			{
+				table_.clear();
+				table_t_ = t;
+			}
 
-				for (int m = 0; m < size; ++m)
+			if (assembler != nullptr && assembler != table_assembler_)
+			{
+				if (table_assembler_ != nullptr)
 				{
-					const auto &tmp = res(m);
-					val.block(i, m * pts.cols(), 1, pts.cols()) = tmp.getGradient().transpose();
+					for (auto &it : table_)
+						it.second.rhs.resize(0);
 				}
+				table_assembler_ = assembler;
 			}
 		}
 
+		ProblemWithSolution::Tabulated ProblemWithSolution::find(const Eigen::MatrixXd &pts, const long i, const double t, const assembler::Assembler *assembler) const
+		{
+			const Eigen::Vector3d key = table_key(pts, i);
+
+			std::lock_guard<std::mutex> lock(table_mutex_);
+			validate_table(t, assembler);
+
+			const auto it = table_.find(key);
+			return it == table_.end() ? Tabulated() : it->second;
+		}
+
+		void ProblemWithSolution::store(const Eigen::MatrixXd &pts, const long i, const double t, const assembler::Assembler *assembler, const Tabulated &entry) const
+		{
+			const Eigen::Vector3d key = table_key(pts, i);
+
+			std::lock_guard<std::mutex> lock(table_mutex_);
+			validate_table(t, assembler);
+
+			Tabulated &stored = table_[key];
+			if (entry.value.size() > 0)
+				stored.value = entry.value;
+			if (entry.grad.size() > 0)
+				stored.grad = entry.grad;
+			if (entry.rhs.size() > 0)
+				stored.rhs = entry.rhs;
+		}
+
 		BilaplacianProblemWithSolution::BilaplacianProblemWithSolution(const std::string &name)
 			: Problem(name)
 		{
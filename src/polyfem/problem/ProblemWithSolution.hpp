@@ -4,6 +4,11 @@
 #include <polyfem/assembler/Assembler.hpp>
 
 #include <polyfem/utils/AutodiffTypes.hpp>
+#include <polyfem/utils/HashUtils.hpp>
+
+#include <limits>
+#include <mutex>
+#include <unordered_map>
 
 namespace polyfem
 {
@@ -23,6 +28,9 @@ namespace polyfem
 			virtual bool has_exact_sol() const override { return true; }
 			virtual bool is_rhs_zero() const override { return false; }
 
+			/// @brief Drops the tabulated values, to call when the parameters of the solution change
+			void clear_table() const;
+
 			virtual ~ProblemWithSolution() {}
 
 		protected:
@@ -31,6 +39,29 @@ namespace polyfem
 			virtual AutodiffHessianPt eval_fun(const AutodiffHessianPt &pt, double t) const = 0;
 
 			virtual int size_for(const Eigen::MatrixXd &pts) const { return is_scalar() ? 1 : pts.cols(); }
+
+		private:
+			/// Values of the solution at a point, empty if not evaluated yet
+			struct Tabulated
+			{
+				Eigen::RowVectorXd value;
+				Eigen::RowVectorXd grad;
+				Eigen::RowVectorXd rhs;
+			};
+
+			/// @brief Tabulated values at the i-th point, valid for the time t and the assembler (null if not needed)
+			Tabulated find(const Eigen::MatrixXd &pts, const long i, const double t, const assembler::Assembler *assembler) const;
+			/// @brief Adds the non empty fields of entry to the values at the i-th point
+			void store(const Eigen::MatrixXd &pts, const long i, const double t, const assembler::Assembler *assembler, const Tabulated &entry) const;
+			/// @brief Clears the table if it was filled at another time or with another assembler, needs table_mutex_
+			void validate_table(const double t, const assembler::Assembler *assembler) const;
+
+			/// Evaluations at the quadrature points, shared by the rhs, the errors and the boundary conditions.
+			/// Only the values of a single time are kept.
+			mutable std::mutex table_mutex_;
+			mutable std::unordered_map<Eigen::Vector3d, Tabulated, utils::HashMatrix> table_;
+			mutable double table_t_ = std::numeric_limits<double>::quiet_NaN();
+			mutable const assembler::Assembler *table_assembler_ = nullptr;
 		};
 
 		class BilaplacianProblemWithSolution : public assembler::Problem
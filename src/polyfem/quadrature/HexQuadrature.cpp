@@ -1,4 +1,5 @@
 #include "HexQuadrature.hpp"
+#include "QuadratureCache.hpp"
 #include "LineQuadrature.hpp"
 
 #include <vector>
@@ -10,38 +11,47 @@ namespace polyfem
 {
 	namespace quadrature
 	{
-		HexQuadrature::HexQuadrature()
+		namespace
 		{
-		}
-
-		void HexQuadrature::get_quadrature(const int order, Quadrature &quad)
-		{
-			Quadrature tmp;
-			LineQuadrature one_d_quad;
-			one_d_quad.get_quadrature(order, tmp);
+			void build_quadrature(const int order, Quadrature &quad)
+			{
+				Quadrature tmp;
+				LineQuadrature one_d_quad;
+				one_d_quad.get_quadrature(order, tmp);
 
-			const long n_quad_pts = tmp.weights.size();
+				const long n_quad_pts = tmp.weights.size();
 
-			quad.points = Eigen::MatrixXd(n_quad_pts * n_quad_pts * n_quad_pts, 3);
-			quad.weights = Eigen::MatrixXd(n_quad_pts * n_quad_pts * n_quad_pts, 1);
+				quad.points = Eigen::MatrixXd(n_quad_pts * n_quad_pts * n_quad_pts, 3);
+				quad.weights = Eigen::MatrixXd(n_quad_pts * n_quad_pts * n_quad_pts, 1);
 
-			for (long i = 0; i < n_quad_pts; ++i)
-			{
-				for (long j = 0; j < n_quad_pts; ++j)
+				for (long i = 0; i < n_quad_pts; ++i)
 				{
-					for (long k = 0; k < n_quad_pts; ++k)
+					for (long j = 0; j < n_quad_pts; ++j)
 					{
-						const long index = (i * n_quad_pts + j) * n_quad_pts + k;
-						quad.points.row(index) = Eigen::Vector3d(tmp.points(k), tmp.points(j), tmp.points(i));
-						quad.weights(index) = tmp.weights(i) * tmp.weights(j) * tmp.weights(k);
+						for (long k = 0; k < n_quad_pts; ++k)
+						{
+							const long index = (i * n_quad_pts + j) * n_quad_pts + k;
+							quad.points.row(index) = Eigen::Vector3d(tmp.points(k), tmp.points(j), tmp.points(i));
+							quad.weights(index) = tmp.weights(i) * tmp.weights(j) * tmp.weights(k);
+						}
 					}
 				}
+
+				assert(fabs(quad.weights.sum() - 1) < 1e-14);
+				assert(quad.points.minCoeff() >= 0 && quad.points.maxCoeff() <= 1);
+
+				assert((quad.points.rows() == quad.weights.size()));
 			}
+		} // namespace
 
-			assert(fabs(quad.weights.sum() - 1) < 1e-14);
-			assert(quad.points.minCoeff() >= 0 && quad.points.maxCoeff() <= 1);
+		HexQuadrature::HexQuadrature()
+		{
+		}
 
-			assert((quad.points.rows() == quad.weights.size()));
+		void HexQuadrature::get_quadrature(const int order, Quadrature &quad)
+		{
+			static QuadratureCache cache(build_quadrature);
+			quad = cache.get(order);
 		}
 	} // namespace quadrature
 } // namespace polyfem
\ No newline at end of file
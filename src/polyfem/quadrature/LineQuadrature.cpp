@@ -1,4 +1,5 @@
 #include "LineQuadrature.hpp"
+#include "QuadratureCache.hpp"
 
 #include <vector>
 #include <cassert>
@@ -4698,39 +4699,45 @@ namespace polyfem
 				}
 				}
 			}
-		} // namespace
 
-		LineQuadrature::LineQuadrature()
-		{
-		}
+			void build_quadrature(const int order, Quadrature &quad)
+			{
+				std::vector<double> xi = quadrature_points(order);
+				std::vector<double> wi = quadrature_weights(order);
 
-		void LineQuadrature::get_quadrature(const int order, Quadrature &quad)
-		{
-			std::vector<double> xi = quadrature_points(order);
-			std::vector<double> wi = quadrature_weights(order);
+				assert((xi.size() == wi.size()));
 
-			assert((xi.size() == wi.size()));
+				std::sort(wi.begin(), wi.end(), [xi](int i1, int i2) {
+					return xi[i1] < xi[i2];
+				});
 
-			std::sort(wi.begin(), wi.end(), [xi](int i1, int i2) {
-				return xi[i1] < xi[i2];
-			});
+				std::sort(xi.begin(), xi.end(), [xi](int i1, int i2) {
+					return xi[i1] < xi[i2];
+				});
 
-			std::sort(xi.begin(), xi.end(), [xi](int i1, int i2) {
-				return xi[i1] < xi[i2];
-			});
+				quad.points = Eigen::Map<Eigen::MatrixXd>(&xi[0], xi.size(), 1);
+				quad.weights = Eigen::Map<Eigen::MatrixXd>(&wi[0], wi.size(), 1);
 
-			quad.points = Eigen::Map<Eigen::MatrixXd>(&xi[0], xi.size(), 1);
-			quad.weights = Eigen::Map<Eigen::MatrixXd>(&wi[0], wi.size(), 1);
+				quad.weights /= 2;
+				quad.points /= 2;
+				quad.points += Eigen::MatrixXd::Ones(quad.points.rows(), quad.points.cols()) * 0.5;
 
-			quad.weights /= 2;
-			quad.points /= 2;
-			quad.points += Eigen::MatrixXd::Ones(quad.points.rows(), quad.points.cols()) * 0.5;
+				assert(fabs(quad.weights.sum() - 1) < 1e-14);
+				assert(quad.points.minCoeff() >= 0 && quad.points.maxCoeff() <= 1);
 
-			assert(fabs(quad.weights.sum() - 1) < 1e-14);
-			assert(quad.points.minCoeff() >= 0 && quad.points.maxCoeff() <= 1);
+				assert((quad.points.size() == quad.weights.size()));
+				quad.weights /= quad.weights.sum();
+			}
+		} // namespace
 
-			assert((quad.points.size() == quad.weights.size()));
-			quad.weights /= quad.weights.sum();
+		LineQuadrature::LineQuadrature()
+		{
+		}
+
+		void LineQuadrature::get_quadrature(const int order, Quadrature &quad)
+		{
+			static QuadratureCache cache(build_quadrature);
+			quad = cache.get(order);
 		}
 	} // namespace quadrature
 } // namespace polyfem
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "QuadQuadrature.hpp"
+#include "QuadratureCache.hpp"
 #include "LineQuadrature.hpp"
 
 #include <vector>
@@ -9,34 +10,43 @@ namespace polyfem
 {
 	namespace quadrature
 	{
-		QuadQuadrature::QuadQuadrature()
+		namespace
 		{
-		}
-
-		void QuadQuadrature::get_quadrature(const int order, Quadrature &quad)
-		{
-			Quadrature tmp;
-			LineQuadrature one_d_quad;
-			one_d_quad.get_quadrature(order, tmp);
+			void build_quadrature(const int order, Quadrature &quad)
+			{
+				Quadrature tmp;
+				LineQuadrature one_d_quad;
+				one_d_quad.get_quadrature(order, tmp);
 
-			const long n_quad_pts = tmp.weights.size();
+				const long n_quad_pts = tmp.weights.size();
 
-			quad.points = Eigen::MatrixXd(n_quad_pts * n_quad_pts, 2);
-			quad.weights = Eigen::MatrixXd(n_quad_pts * n_quad_pts, 1);
+				quad.points = Eigen::MatrixXd(n_quad_pts * n_quad_pts, 2);
+				quad.weights = Eigen::MatrixXd(n_quad_pts * n_quad_pts, 1);
 
-			for (long i = 0; i < n_quad_pts; ++i)
-			{
-				for (long j = 0; j < n_quad_pts; ++j)
+				for (long i = 0; i < n_quad_pts; ++i)
 				{
-					quad.points.row(i * n_quad_pts + j) = Eigen::Vector2d(tmp.points(j), tmp.points(i));
-					quad.weights(i * n_quad_pts + j) = tmp.weights(i) * tmp.weights(j);
+					for (long j = 0; j < n_quad_pts; ++j)
+					{
+						quad.points.row(i * n_quad_pts + j) = Eigen::Vector2d(tmp.points(j), tmp.points(i));
+						quad.weights(i * n_quad_pts + j) = tmp.weights(i) * tmp.weights(j);
+					}
 				}
+
+				assert(fabs(quad.weights.sum() - 1) < 1e-14);
+				assert(quad.points.minCoeff() >= 0 && quad.points.maxCoeff() <= 1);
+
+				assert((quad.points.rows() == quad.weights.size()));
 			}
+		} // namespace
 
-			assert(fabs(quad.weights.sum() - 1) < 1e-14);
-			assert(quad.points.minCoeff() >= 0 && quad.points.maxCoeff() <= 1);
+		QuadQuadrature::QuadQuadrature()
+		{
+		}
 
-			assert((quad.points.rows() == quad.weights.size()));
+		void QuadQuadrature::get_quadrature(const int order, Quadrature &quad)
+		{
+			static QuadratureCache cache(build_quadrature);
+			quad = cache.get(order);
 		}
 	} // namespace quadrature
 } // namespace polyfem
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "QuadratureCache.hpp"
+
+#include <mutex>
+
+namespace polyfem::quadrature
+{
+	QuadratureCache::QuadratureCache(Builder builder)
+		: builder_(std::move(builder))
+	{
+	}
+
+	const Quadrature &QuadratureCache::get(const int order)
+	{
+		{
+			std::shared_lock lock(mutex_);
+			const auto it = rules_.find(order);
+			if (it != rules_.end())
+				return *it->second;
+		}
+
+		auto quad = std::make_unique<Quadrature>();
+		builder_(order, *quad);
+
+		std::unique_lock lock(mutex_);
+		// another thread may have built it in the meantime, keep the first one
+		const auto it = rules_.emplace(order, std::move(quad)).first;
+		return *it->second;
+	}
+} // namespace polyfem::quadrature
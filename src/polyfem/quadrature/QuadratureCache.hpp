@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Quadrature.hpp"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+
+namespace polyfem::quadrature
+{
+	/// Thread-safe table of the quadrature rules of one reference element, each order is built once on first use
+	class QuadratureCache
+	{
+	public:
+		/// builds the rule of a given order
+		using Builder = std::function<void(const int order, Quadrature &quad)>;
+
+		/// @param[in] builder function building the rule of a given order
+		explicit QuadratureCache(Builder builder);
+
+		/// returns the rule of the given order, building it if needed
+		/// @param[in] order quadrature order
+		/// @return rule, the reference stays valid for the lifetime of the cache
+		const Quadrature &get(const int order);
+
+	private:
+		Builder builder_;
+		std::shared_mutex mutex_;
+		std::map<int, std::unique_ptr<const Quadrature>> rules_;
+	};
+} // namespace polyfem::quadrature
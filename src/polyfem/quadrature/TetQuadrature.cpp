@@ -1,4 +1,5 @@
 #include "TetQuadrature.hpp"
+#include "QuadratureCache.hpp"
 #include "LineQuadrature.hpp"
 
 #include <vector>
@@ -22,6 +23,18 @@ namespace polyfem
 					assert(false);
 				};
 			}
+
+			void build_quadrature(const int order, Quadrature &quad)
+			{
+				get_weight_and_points(order, quad.points, quad.weights);
+
+				assert(fabs(quad.weights.sum() - 1) < 1e-12);
+				assert(quad.points.minCoeff() >= 0 && quad.points.maxCoeff() <= 1);
+
+				assert(quad.points.rows() == quad.weights.size());
+
+				quad.weights /= 6;
+			}
 		} // namespace
 
 		TetQuadrature::TetQuadrature()
@@ -30,16 +43,8 @@ namespace polyfem
 
 		void TetQuadrature::get_quadrature(const int order, Quadrature &quad)
 		{
-			Quadrature tmp;
-
-			get_weight_and_points(order, quad.points, quad.weights);
-
-			assert(fabs(quad.weights.sum() - 1) < 1e-12);
-			assert(quad.points.minCoeff() >= 0 && quad.points.maxCoeff() <= 1);
-
-			assert(quad.points.rows() == quad.weights.size());
-
-			quad.weights /= 6;
+			static QuadratureCache cache(build_quadrature);
+			quad = cache.get(order);
 		}
 	} // namespace quadrature
 } // namespace polyfem
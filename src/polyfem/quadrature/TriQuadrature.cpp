@@ -1,4 +1,5 @@
 #include "TriQuadrature.hpp"
+#include "QuadratureCache.hpp"
 #include "LineQuadrature.hpp"
 
 #include <vector>
@@ -21,6 +22,18 @@ namespace polyfem
 					assert(false);
 				};
 			}
+
+			void build_quadrature(const int order, Quadrature &quad)
+			{
+				get_weight_and_points(order, quad.points, quad.weights);
+
+				assert(fabs(quad.weights.sum() - 1) < 1e-14);
+				assert(quad.points.minCoeff() >= 0 && quad.points.maxCoeff() <= 1);
+
+				assert(quad.points.rows() == quad.weights.size());
+
+				quad.weights /= 2;
+			}
 		} // namespace
 
 		TriQuadrature::TriQuadrature()
@@ -29,16 +42,8 @@ namespace polyfem
 
 		void TriQuadrature::get_quadrature(const int order, Quadrature &quad)
 		{
-			Quadrature tmp;
-
-			get_weight_and_points(order, quad.points, quad.weights);
-
-			assert(fabs(quad.weights.sum() - 1) < 1e-14);
-			assert(quad.points.minCoeff() >= 0 && quad.points.maxCoeff() <= 1);
-
-			assert(quad.points.rows() == quad.weights.size());
-
-			quad.weights /= 2;
+			static QuadratureCache cache(build_quadrature);
+			quad = cache.get(order);
 		}
 	} // namespace quadrature
 } // namespace polyfem
@@ -0,0 +1,131 @@
+#include "APosteriori.hpp"
+
+#include <polyfem/assembler/AssemblyValsCache.hpp>
+#include <polyfem/assembler/ElementAssemblyValues.hpp>
+#include <polyfem/assembler/MassMatrixAssembler.hpp>
+#include <polyfem/io/Evaluator.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+#include <numeric>
+
+namespace polyfem::refinement
+{
+	using namespace assembler;
+	using namespace utils;
+
+	void APosteriori::zz_error_indicator(const bool is_volume,
+										 const int actual_dim,
+										 const int n_bases,
+										 const std::vector<basis::ElementBases> &bases,
+										 const std::vector<basis::ElementBases> &gbases,
+										 const Eigen::MatrixXd &sol,
+										 Eigen::VectorXd &indicator)
+	{
+		const int dim = is_volume ? 3 : 2;
+		const int n_cols = actual_dim * dim;
+
+		// recovered gradient: M G = ∫ φᵢ ∇uₕ
+		StiffnessMatrix mass;
+		{
+			MassMatrixAssembler assembler;
+			NoDensity no_density;
+			AssemblyValsCache cache;
+			assembler.assemble(is_volume, 1, n_bases, no_density, bases, gbases, cache, mass);
+		}
+
+		struct LocalThreadStorage
+		{
+			Eigen::MatrixXd rhs;
+			ElementAssemblyValues vals;
+			Eigen::MatrixXd u, grad_u;
+		};
+
+		LocalThreadStorage initial;
+		initial.rhs.setZero(n_bases, n_cols);
+		auto storage = create_thread_storage(initial);
+
+		maybe_parallel_for(int(bases.size()), [&](int start, int end, int thread_id) {
+			LocalThreadStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			ElementAssemblyValues &vals = local_storage.vals;
+
+			for (int e = start; e < end; ++e)
+			{
+				vals.compute(e, is_volume, bases[e], gbases[e]);
+				io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, sol, local_storage.u, local_storage.grad_u);
+
+				const Eigen::VectorXd da = vals.det.array() * vals.quadrature.weights.array();
+				for (const AssemblyValues &v : vals.basis_values)
+				{
+					const Eigen::RowVectorXd local = (v.val.array() * da.array()).matrix().transpose() * local_storage.grad_u;
+					for (const auto &g : v.global)
+						local_storage.rhs.row(g.index) += g.val * local;
+				}
+			}
+		});
+
+		Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(n_bases, n_cols);
+		for (const LocalThreadStorage &local_storage : storage)
+			rhs += local_storage.rhs;
+
+		Eigen::SimplicialLDLT<StiffnessMatrix> solver(mass);
+		if (solver.info() != Eigen::Success)
+			log_and_throw_error("Unable to factorize the mass matrix of the error indicator");
+		const Eigen::MatrixXd recovered = solver.solve(rhs);
+
+		// η_e² = ∫_e |G - ∇uₕ|²
+		indicator.resize(bases.size());
+		maybe_parallel_for(int(bases.size()), [&](int start, int end, int thread_id) {
+			LocalThreadStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			ElementAssemblyValues &vals = local_storage.vals;
+
+			for (int e = start; e < end; ++e)
+			{
+				vals.compute(e, is_volume, bases[e], gbases[e]);
+				io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, sol, local_storage.u, local_storage.grad_u);
+
+				Eigen::MatrixXd diff = -local_storage.grad_u;
+				for (const AssemblyValues &v : vals.basis_values)
+					for (const auto &g : v.global)
+						diff += g.val * v.val * recovered.row(g.index);
+
+				const Eigen::VectorXd da = vals.det.array() * vals.quadrature.weights.array();
+				indicator(e) = std::sqrt(diff.rowwise().squaredNorm().dot(da));
+			}
+		});
+	}
+
+	int APosteriori::p_refine(const Eigen::VectorXd &indicator,
+							  const double fraction,
+							  const int discr_order_max,
+							  Eigen::VectorXi &disc_orders)
+	{
+		assert(indicator.size() == disc_orders.size());
+
+		std::vector<int> order(indicator.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](int a, int b) { return indicator(a) > indicator(b); });
+
+		const double target = fraction * indicator.squaredNorm();
+		double marked = 0;
+		int n_refined = 0;
+		for (const int e : order)
+		{
+			if (marked >= target)
+				break;
+			marked += indicator(e) * indicator(e);
+
+			if (disc_orders(e) < discr_order_max)
+			{
+				++disc_orders(e);
+				++n_refined;
+			}
+		}
+
+		logger().debug("A posteriori p-refinement raised the order of {} elements", n_refined);
+		return n_refined;
+	}
+} // namespace polyfem::refinement
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+
+#include <Eigen/Core>
+
+#include <vector>
+
+namespace polyfem::refinement
+{
+	/// Class for a posteriori p-refinement driven by a recovery-based error indicator
+	class APosteriori
+	{
+	private:
+		APosteriori() {}
+
+	public:
+		/// compute the Zienkiewicz-Zhu error indicator: the gradient of the solution is L2 projected
+		/// onto the (continuous) space of the bases and compared to the FE gradient on every element
+		/// @param[in] is_volume if the mesh is volumetric
+		/// @param[in] actual_dim size of the problem (e.g., 1 for Laplace, dim for elasticity)
+		/// @param[in] n_bases number of bases
+		/// @param[in] bases bases
+		/// @param[in] gbases geom bases
+		/// @param[in] sol solution
+		/// @param[out] indicator per element error indicator
+		static void zz_error_indicator(const bool is_volume,
+									   const int actual_dim,
+									   const int n_bases,
+									   const std::vector<basis::ElementBases> &bases,
+									   const std::vector<basis::ElementBases> &gbases,
+									   const Eigen::MatrixXd &sol,
+									   Eigen::VectorXd &indicator);
+
+		/// raise the order of the elements with the largest indicators until they account for
+		/// a fraction of the total squared error (Dörfler marking)
+		/// @param[in] indicator per element error indicator
+		/// @param[in] fraction fraction of the total squared error to mark
+		/// @param[in] discr_order_max maximum element degree
+		/// @param[in,out] disc_orders per element order
+		/// @return number of elements whose order was raised
+		static int p_refine(const Eigen::VectorXd &indicator,
+							const double fraction,
+							const int discr_order_max,
+							Eigen::VectorXi &disc_orders);
+	};
+} // namespace polyfem::refinement
@@ -6,9 +6,6 @@
 
 namespace polyfem::solver
 {
-	double ALSolver::previous_eta_sa = 0.0;
-	double ALSolver::previous_al_weight_sa = 0.0;
-
 	ALSolver::ALSolver(
 		std::shared_ptr<BCLagrangianForm> lagr_form,
 		std::shared_ptr<BCPenaltyForm> pen_form,
@@ -16,6 +13,7 @@ namespace polyfem::solver
 		const double scaling,
 		const double max_al_weight,
 		const double eta_tol,
+		double &previous_al_weight,
 		const std::function<void(const Eigen::VectorXd &)> &update_barrier_stiffness)
 		: lagr_form(lagr_form),
 		  pen_form(pen_form),
@@ -23,6 +21,7 @@ namespace polyfem::solver
 		  scaling(scaling),
 		  max_al_weight(max_al_weight),
 		  eta_tol(eta_tol),
+		  previous_al_weight(previous_al_weight),
 		  update_barrier_stiffness(update_barrier_stiffness)
 	{
 
@@ -38,15 +37,14 @@ namespace polyfem::solver
 
 		// --------------------------------------------------------------------
 		double al_weight;
-		int al_check = 0;
-		if(previous_al_weight_sa<initial_al_weight){
+		if (previous_al_weight < initial_al_weight)
+		{
 			al_weight = initial_al_weight;
-			previous_al_weight_sa = al_weight;
-
-
+			previous_al_weight = al_weight;
 		}
-		else{
-			al_weight = ALSolver::previous_al_weight_sa;
+		else
+		{
+			al_weight = previous_al_weight;
 		}
 
 
@@ -54,6 +52,7 @@ namespace polyfem::solver
 		const int iters = nl_solver->stop_criteria().iterations;
 
 		const double initial_error = pen_form->compute_error(sol);
+		double previous_error = initial_error;
 
 		nl_problem.line_search_begin(sol, tmp_sol);
 
@@ -95,26 +94,32 @@ namespace polyfem::solver
 			tmp_sol = nl_problem.full_to_reduced(sol);
 			nl_problem.line_search_begin(sol, tmp_sol);
 
-			if ((eta <= previous_eta_sa && eta <= eta_tol) || al_check == 1)
+			// Adapt to the constraint violation: if the subsolve removed enough of the remaining violation
+			// the weight is adequate and the multipliers absorb the rest, otherwise the penalty is too weak
+			const double error = eta < 0 ? initial_error : current_error;
+			const double progress = previous_error > 0 ? (1 - sqrt(error / previous_error)) : 1;
+			logger().debug("Current AL progress = {}", progress);
+
+			if (eta < 0 || (eta <= eta_tol && progress < sufficient_progress))
 			{
-				al_weight *= scaling;
-				previous_al_weight_sa = al_weight;
-				al_check = 0;
+				// grow faster if the subsolve did not reduce the violation at all
+				al_weight *= progress > 0 ? scaling : scaling * scaling;
+				previous_al_weight = al_weight;
 			}
 			else
 			{
 				lagr_form->update_lagrangian(sol, al_weight);
-				al_check = 1;
 			}
-
-
-			previous_eta_sa = eta;
+			previous_error = error;
 
 			post_subsolve(al_weight);
 			++al_steps;
 		}
 		nl_problem.line_search_end();
 		nl_solver->stop_criteria().iterations = iters;
+
+		// the boundary conditions were just checked to be applicable to sol
+		validated_sol = sol;
 	}
 
 	void ALSolver::solve_reduced(std::shared_ptr<NLSolver> nl_solver, NLProblem &nl_problem, Eigen::MatrixXd &sol)
@@ -122,12 +127,20 @@ namespace polyfem::solver
 		assert(sol.size() == nl_problem.full_size());
 
 		Eigen::VectorXd tmp_sol = nl_problem.full_to_reduced(sol);
-		nl_problem.line_search_begin(sol, tmp_sol);
 
-		if (!std::isfinite(nl_problem.value(tmp_sol))
-			|| !nl_problem.is_step_valid(sol, tmp_sol)
-			|| !nl_problem.is_step_collision_free(sol, tmp_sol))
-			log_and_throw_error("Failed to apply boundary conditions; solve with augmented lagrangian first!");
+		// skip the checks (and the collision detection) if solve_al already did them at this solution
+		const bool validated = validated_sol.size() == sol.size() && validated_sol == sol;
+		validated_sol.resize(0, 0);
+
+		if (!validated)
+		{
+			nl_problem.line_search_begin(sol, tmp_sol);
+
+			if (!std::isfinite(nl_problem.value(tmp_sol))
+				|| !nl_problem.is_step_valid(sol, tmp_sol)
+				|| !nl_problem.is_step_collision_free(sol, tmp_sol))
+				log_and_throw_error("Failed to apply boundary conditions; solve with augmented lagrangian first!");
+		}
 
 		// --------------------------------------------------------------------
 		// Perform one final solve with the DBC projected out
@@ -18,9 +18,8 @@ namespace polyfem::solver
 		using NLSolver = polysolve::nonlinear::Solver;
 
 	public:
-		static double previous_eta_sa;
-		static double previous_al_weight_sa;
-
+		/// @param previous_al_weight weight reached by the previous solves of the same problem, updated by solve_al.
+		/// Owned by the caller so concurrent independent problems do not share it.
 		ALSolver(
 			std::shared_ptr<BCLagrangianForm> lagr_form,
 			std::shared_ptr<BCPenaltyForm> pen_form,
@@ -28,6 +27,7 @@ namespace polyfem::solver
 			const double scaling,
 			const double max_al_weight,
 			const double eta_tol,
+			double &previous_al_weight,
 			const std::function<void(const Eigen::VectorXd &)> &update_barrier_stiffness);
 		virtual ~ALSolver() = default;
 
@@ -45,9 +45,16 @@ namespace polyfem::solver
 		const double scaling;
 		const double max_al_weight;
 		const double eta_tol;
+		double &previous_al_weight;
+
+		/// fraction of the remaining constraint violation a subsolve has to remove for the weight to be kept
+		static constexpr double sufficient_progress = 0.5;
 
 		// TODO: replace this with a member function
 		std::function<void(const Eigen::VectorXd &)> update_barrier_stiffness;
+
+		/// solution at which solve_al last verified that the boundary conditions can be applied directly
+		Eigen::MatrixXd validated_sol;
 	};
 
 } // namespace polyfem::solver
\ No newline at end of file
@@ -2,7 +2,9 @@
 
 #include <polyfem/solver/forms/adjoint_forms/AdjointForm.hpp>
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/par_for.hpp>
 #include <polyfem/utils/Timer.hpp>
 #include <polyfem/io/OBJWriter.hpp>
 #include <polyfem/State.hpp>
@@ -14,10 +16,22 @@
 #include <polyfem/solver/forms/PeriodicContactForm.hpp>
 #include <polyfem/solver/NLHomoProblem.hpp>
 #include <polyfem/solver/AdjointTools.hpp>
+#include <polyfem/solver/NLProblem.hpp>
+#include <polyfem/solver/Optimizations.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
 #include <list>
+#include <numeric>
 #include <stack>
 
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#endif
+
 namespace polyfem::solver
 {
 	namespace
@@ -120,6 +134,81 @@ namespace polyfem::solver
 
 			return sorted;
 		}
+
+		/// @brief runs every task once the tasks it depends on are done
+		/// each task runs in a TBB arena whose concurrency is its share of the total cost, so that the nested
+		/// parallel loops of the simulations do not oversubscribe the threads
+		/// @param[in] dependencies tasks that must be done before every task
+		/// @param[in] costs estimated cost of every task
+		/// @param[in] task runs a task
+		void run_task_graph(const std::vector<std::vector<int>> &dependencies, const std::vector<double> &costs, const std::function<void(int)> &task)
+		{
+			const int n_tasks = dependencies.size();
+			assert(costs.size() == n_tasks);
+
+#ifdef POLYFEM_WITH_TBB
+			std::vector<std::vector<int>> dependents(n_tasks);
+			std::vector<std::atomic<int>> remaining(n_tasks);
+			for (int i = 0; i < n_tasks; ++i)
+			{
+				remaining[i] = dependencies[i].size();
+				for (const int j : dependencies[i])
+					dependents[j].push_back(i);
+			}
+
+			const int n_threads = std::max(1, tbb::this_task_arena::max_concurrency());
+			const double total_cost = std::max(std::accumulate(costs.begin(), costs.end(), 0.0), 1e-16);
+
+			tbb::task_group group;
+			std::function<void(int)> spawn = [&](const int i) {
+				group.run([&, i]() {
+					const int concurrency = std::clamp(int(std::round(n_threads * costs[i] / total_cost)), 1, n_threads);
+					tbb::task_arena arena(concurrency);
+					arena.execute([&]() { task(i); });
+
+					for (const int j : dependents[i])
+						if (--remaining[j] == 0)
+							spawn(j);
+				});
+			};
+
+			for (int i = 0; i < n_tasks; ++i)
+				if (remaining[i] == 0)
+					spawn(i);
+			group.wait();
+#else
+			// dependencies first
+			std::vector<bool> done(n_tasks, false);
+			std::function<void(int)> run = [&](const int i) {
+				if (done[i])
+					return;
+				done[i] = true;
+				for (const int j : dependencies[i])
+					run(j);
+				task(i);
+			};
+			for (int i = 0; i < n_tasks; ++i)
+				run(i);
+#endif
+		}
+
+		/// whether every basis node is an input node of the mesh, whose order does not change with the shape
+		bool nodes_are_input_nodes(const State &state)
+		{
+			return state.in_node_to_node.size() == state.n_bases && (state.n_bases == 0 || state.in_node_to_node.minCoeff() >= 0);
+		}
+
+		/// whether the state is solved by init_nonlinear_tensor_solve, the only one using State::warm_start_sol
+		bool uses_warm_start(const State &state)
+		{
+			return !state.problem->is_time_dependent() && !state.is_problem_linear() && !state.problem->is_scalar() && state.mixed_assembler == nullptr;
+		}
+
+		/// contact makes the solutions non-smooth in the variables, their POD is a poor surrogate
+		bool uses_reduced_model(const State &state)
+		{
+			return uses_warm_start(state) && !state.is_contact_enabled() && !state.is_homogenization();
+		}
 	} // namespace
 
 	AdjointNLProblem::AdjointNLProblem(std::shared_ptr<AdjointForm> form, const VariableToSimulationGroup &variables_to_simulation, const std::vector<std::shared_ptr<State>> &all_states, const json &args)
@@ -130,7 +219,27 @@ namespace polyfem::solver
 		  save_freq(args["output"]["save_frequency"]),
 		  enable_slim(args["solver"]["advanced"]["enable_slim"]),
 		  smooth_line_search(args["solver"]["advanced"]["smooth_line_search"]),
-		  solve_in_parallel(args["solver"]["advanced"]["solve_in_parallel"])
+		  solve_in_parallel(args["solver"]["advanced"]["solve_in_parallel"]),
+		  warm_start([&] {
+			  const std::string policy = args["solver"]["advanced"]["warm_start"];
+			  if (policy == "previous")
+				  return WarmStart::Previous;
+			  if (policy == "extrapolate")
+				  return WarmStart::Extrapolate;
+			  return WarmStart::None;
+		  }()),
+		  reduced_model(args["solver"]["advanced"]["reduced_model"]["enabled"]),
+		  reduced_refresh_frequency(args["solver"]["advanced"]["reduced_model"]["refresh_frequency"]),
+		  reduced_max_iterations(args["solver"]["advanced"]["reduced_model"]["max_iterations"]),
+		  reduced_relative_residual(args["solver"]["advanced"]["reduced_model"]["relative_residual"]),
+		  reduced_residual_tol(args["solver"]["advanced"]["reduced_model"]["residual_tol"]),
+		  derivative_check(args["solver"]["advanced"]["derivative_check"]["enabled"]),
+		  derivative_check_directions(args["solver"]["advanced"]["derivative_check"]["directions"]),
+		  derivative_check_step(args["solver"]["advanced"]["derivative_check"]["step"]),
+		  derivative_check_frequency(args["solver"]["advanced"]["derivative_check"]["frequency"]),
+		  derivative_check_copies(args["solver"]["advanced"]["derivative_check"]["copies"]),
+		  args_(args),
+		  speculative_trials(args["solver"]["advanced"]["speculative_line_search"]["enabled"] ? args["solver"]["advanced"]["speculative_line_search"]["trials"].get<int>() : 0)
 	{
 		cur_grad.setZero(0);
 
@@ -142,13 +251,21 @@ namespace polyfem::solver
 		}
 
 		solve_in_order.clear();
+		state_dependencies.assign(all_states.size(), {});
+		state_solve_time.assign(all_states.size(), 0);
+		warm_start_sol.resize(all_states.size());
+		reduced_bases.assign(all_states.size(), ReducedBasis(args["solver"]["advanced"]["reduced_model"]["max_snapshots"], args["solver"]["advanced"]["reduced_model"]["energy_tol"]));
+		reduced_solves.assign(all_states.size(), 0);
 		{
 			Graph G(all_states.size());
 			for (int k = 0; k < all_states.size(); k++)
 			{
 				auto &arg = args["states"][k];
 				if (arg["initial_guess"].get<int>() >= 0)
+				{
 					G.addEdge(arg["initial_guess"].get<int>(), k);
+					state_dependencies[k].push_back(arg["initial_guess"].get<int>());
+				}
 			}
 
 			solve_in_order = G.topologicalSort();
@@ -183,11 +300,17 @@ namespace polyfem::solver
 
 	double AdjointNLProblem::value(const Eigen::VectorXd &x)
 	{
+		if (deferred_value_ && x == curr_x)
+			return *deferred_value_;
+
+		solve_deferred();
 		return form_->value(x);
 	}
 
 	void AdjointNLProblem::gradient(const Eigen::VectorXd &x, Eigen::VectorXd &gradv)
 	{
+		solve_deferred();
+
 		if (cur_grad.size() == x.size())
 			gradv = cur_grad;
 		else
@@ -196,8 +319,22 @@ namespace polyfem::solver
 
 			{
 				POLYFEM_SCOPED_TIMER("adjoint solve");
-				for (int i = 0; i < all_states_.size(); i++)
-					all_states_[i]->solve_adjoint_cached(form_->compute_reduced_adjoint_rhs(x, *all_states_[i])); // caches inside state
+				if (solve_in_parallel)
+				{
+					// the right-hand sides go through the forms, only the solves run in parallel
+					std::vector<Eigen::MatrixXd> adjoint_rhs(all_states_.size());
+					for (int i = 0; i < all_states_.size(); i++)
+						adjoint_rhs[i] = form_->compute_reduced_adjoint_rhs(x, *all_states_[i]);
+
+					run_task_graph(std::vector<std::vector<int>>(all_states_.size()), state_costs(), [&](const int i) {
+						all_states_[i]->solve_adjoint_cached(adjoint_rhs[i]); // caches inside state
+					});
+				}
+				else
+				{
+					for (int i = 0; i < all_states_.size(); i++)
+						all_states_[i]->solve_adjoint_cached(form_->compute_reduced_adjoint_rhs(x, *all_states_[i])); // caches inside state
+				}
 			}
 
 			{
@@ -273,18 +410,141 @@ namespace polyfem::solver
 	void AdjointNLProblem::line_search_begin(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1)
 	{
 		form_->line_search_begin(x0, x1);
+
+		if (speculative_trials > 0)
+			solve_speculative_trials(x0, x1);
 	}
 
 	void AdjointNLProblem::line_search_end()
 	{
 		form_->line_search_end();
+		speculative_values_.clear();
+	}
+
+	void AdjointNLProblem::create_problem_copies(const int n_problems)
+	{
+		if (problem_copies_.size() >= n_problems)
+			return;
+
+		// the copies must not overwrite the outputs of the optimization
+		json copy_args = args_;
+		copy_args["output"]["solution"] = "";
+		copy_args["solver"]["advanced"]["derivative_check"]["enabled"] = false;
+		copy_args["solver"]["advanced"]["speculative_line_search"]["enabled"] = false;
+
+		const CacheLevel level = all_states_.empty() ? CacheLevel::Derivatives : all_states_[0]->optimization_enabled;
+		const size_t copy_threads = std::max<int>(1, utils::get_n_threads() / n_problems);
+		adjoint_logger().debug("Creating {} copies of the problem...", n_problems - problem_copies_.size());
+		while (problem_copies_.size() < n_problems)
+			problem_copies_.push_back(AdjointOptUtils::create_problem(copy_args, level, copy_threads));
+	}
+
+	void AdjointNLProblem::solve_speculative_trials(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1)
+	{
+		// SLIM smooths the shapes from the previous one, the copies would not reproduce the trials of the line search
+		if (enable_slim)
+			return;
+
+		POLYFEM_SCOPED_TIMER("speculative line search");
+		create_problem_copies(speculative_trials);
+
+		const double max_step = std::min(1.0, form_->max_step_size(x0, x1));
+		std::vector<std::optional<double>> values(speculative_trials);
+		utils::maybe_parallel_for(speculative_trials, [&](int start, int end, int thread_id) {
+			for (int k = start; k < end; ++k)
+			{
+				const Eigen::VectorXd xk = x0 + (max_step / std::pow(2.0, k)) * (x1 - x0);
+				AdjointNLProblem &problem = *problem_copies_[k];
+				try
+				{
+					problem.solution_changed(xk);
+					values[k] = problem.value(xk);
+				}
+				catch (const std::exception &e)
+				{
+					// the line search solves this trial itself, and reports the failure if it happens again
+					adjoint_logger().debug("Speculative line search trial {} failed: {}", k, e.what());
+				}
+			}
+		});
+
+		speculative_values_.clear();
+		for (int k = 0; k < speculative_trials; ++k)
+		{
+			if (values[k])
+				speculative_values_.emplace_back(x0 + (max_step / std::pow(2.0, k)) * (x1 - x0), *values[k]);
+		}
+	}
+
+	void AdjointNLProblem::solve_deferred()
+	{
+		if (!deferred_value_)
+			return;
+		deferred_value_.reset();
+
+		if (warm_start != WarmStart::None)
+			set_warm_start(curr_x);
+		solve_pde();
+		if (warm_start != WarmStart::None)
+			record_warm_start(curr_x);
+
+		form_->solution_changed(curr_x);
 	}
 
 	void AdjointNLProblem::post_step(const polysolve::nonlinear::PostStepData &data)
 	{
+		solve_deferred();
 		save_to_file(save_iter++, data.x);
 
 		form_->post_step(data);
+
+		if (derivative_check && data.iter_num % derivative_check_frequency == 0)
+			check_derivatives(data.x, data.grad, derivative_check_directions, derivative_check_step, derivative_check_copies);
+	}
+
+	Eigen::VectorXd AdjointNLProblem::check_derivatives(const Eigen::VectorXd &x, const Eigen::VectorXd &grad, const int n_directions, const double step, const int n_copies)
+	{
+		POLYFEM_SCOPED_TIMER("derivative check");
+		assert(grad.size() == x.size());
+
+		std::vector<Eigen::VectorXd> directions(n_directions);
+		for (auto &d : directions)
+		{
+			d = Eigen::VectorXd::Random(x.size());
+			d.normalize();
+		}
+
+		// one evaluation per perturbation, 2 * i for +step along direction i and 2 * i + 1 for -step
+		const int n_evals = 2 * n_directions;
+		const int n_threads = utils::get_n_threads();
+		const int n_problems = std::max(1, std::min(n_evals, n_copies > 0 ? n_copies : n_threads));
+
+		create_problem_copies(n_problems);
+
+		Eigen::VectorXd values(n_evals);
+		utils::maybe_parallel_for(n_problems, [&](int start, int end, int thread_id) {
+			for (int p = start; p < end; ++p)
+			{
+				AdjointNLProblem &problem = *problem_copies_[p];
+				for (int e = p; e < n_evals; e += n_problems)
+				{
+					const Eigen::VectorXd xe = x + ((e % 2 == 0) ? step : -step) * directions[e / 2];
+					problem.solution_changed(xe);
+					values(e) = problem.value(xe);
+				}
+			}
+		});
+
+		Eigen::VectorXd errors(n_directions);
+		for (int i = 0; i < n_directions; ++i)
+		{
+			const double derivative = grad.dot(directions[i]);
+			const double finite_difference = (values(2 * i) - values(2 * i + 1)) / (2 * step);
+			errors(i) = std::abs(derivative - finite_difference) / std::max(std::abs(finite_difference), 1e-12);
+			adjoint_logger().info("Derivative check along direction {}: gradient {:.12e}, finite difference {:.12e}, relative error {:.3e}", i, derivative, finite_difference, errors(i));
+		}
+
+		return errors;
 	}
 
 	void AdjointNLProblem::save_to_file(const int iter_num, const Eigen::VectorXd &x0)
@@ -390,14 +650,32 @@ namespace polyfem::solver
 			}
 		}
 
+		// the topology does not change, only the geometric quantities are recomputed
 		if (need_rebuild_basis)
 		{
 			for (const auto &state : all_states_)
-				state->build_basis();
+				state->update_geometry();
+		}
+
+		// the objective of a speculative trial is already known, the states are solved only if the line search accepts it
+		deferred_value_.reset();
+		for (const auto &[trial, value] : speculative_values_)
+		{
+			if ((newX - trial).norm() <= 1e-12 * std::max(1.0, newX.norm()))
+			{
+				deferred_value_ = value;
+				cur_grad.resize(0);
+				curr_x = newX;
+				return;
+			}
 		}
 
 		// solve PDE
+		if (warm_start != WarmStart::None)
+			set_warm_start(newX);
 		solve_pde();
+		if (warm_start != WarmStart::None)
+			record_warm_start(newX);
 
 		form_->solution_changed(newX);
 
@@ -410,17 +688,13 @@ namespace polyfem::solver
 		{
 			adjoint_logger().info("Run simulations in parallel...");
 
-			utils::maybe_parallel_for(all_states_.size(), [&](int start, int end, int thread_id) {
-				for (int i = start; i < end; i++)
+			run_task_graph(state_dependencies, state_costs(), [&](const int i) {
+				auto state = all_states_[i];
+				if (active_state_mask[i] || state->diff_cached.size() == 0)
 				{
-					auto state = all_states_[i];
-					if (active_state_mask[i] || state->diff_cached.size() == 0)
-					{
-						state->assemble_rhs();
-						state->assemble_mass_mat();
-						Eigen::MatrixXd sol, pressure; // solution is also cached in state
-						state->solve_problem(sol, pressure);
-					}
+					state_solve_time[i] = 0;
+					POLYFEM_SCOPED_TIMER(state_solve_time[i]);
+					solve_state(i);
 				}
 			});
 		}
@@ -428,28 +702,184 @@ namespace polyfem::solver
 		{
 			adjoint_logger().info("Run simulations in serial...");
 
-			Eigen::MatrixXd sol, pressure; // solution is also cached in state
 			for (int i : solve_in_order)
 			{
 				auto state = all_states_[i];
 				if (active_state_mask[i] || state->diff_cached.size() == 0)
-				{
-					state->assemble_rhs();
-					state->assemble_mass_mat();
-
-					state->solve_problem(sol, pressure);
-				}
+					solve_state(i);
 			}
 		}
 
 		cur_grad.resize(0);
 	}
 
+	void AdjointNLProblem::solve_state(const int i)
+	{
+		State &state = *all_states_[i];
+		state.assemble_rhs();
+		state.assemble_mass_mat();
+
+		const Eigen::MatrixXd warm_start_sol = state.warm_start_sol;
+		if (reduced_solve(i))
+			return;
+
+		Eigen::MatrixXd sol, pressure; // solution is also cached in state
+		state.solve_problem(sol, pressure);
+		state.warm_start_sol = warm_start_sol;
+
+		if (reduced_model && uses_reduced_model(state) && state.diff_cached.size() > 0)
+		{
+			Eigen::MatrixXd snapshot = state.diff_cached.u(0);
+			if (nodes_are_input_nodes(state))
+				snapshot = utils::unreorder_matrix(snapshot, state.in_node_to_node, state.n_bases, state.mesh->dimension());
+			reduced_bases[i].add_snapshot(snapshot);
+			reduced_solves[i] = 0;
+		}
+	}
+
+	bool AdjointNLProblem::reduced_solve(const int i)
+	{
+		State &state = *all_states_[i];
+		const ReducedBasis &rom = reduced_bases[i];
+		if (!reduced_model || !uses_reduced_model(state) || rom.size() == 0 || reduced_solves[i] >= reduced_refresh_frequency)
+			return false;
+
+		Eigen::MatrixXd sol, pressure;
+		state.init_solve(sol, pressure);
+		state.init_nonlinear_tensor_solve(sol);
+
+		NLProblem &problem = *state.solve_data.nl_problem;
+		if (problem.uses_lagging())
+			return false;
+
+		Eigen::MatrixXd modes = rom.basis();
+		Eigen::MatrixXd latest = rom.latest();
+		if (nodes_are_input_nodes(state))
+		{
+			modes = utils::reorder_matrix(modes, state.in_node_to_node, state.n_bases, state.mesh->dimension());
+			latest = utils::reorder_matrix(latest, state.in_node_to_node, state.n_bases, state.mesh->dimension());
+		}
+		if (modes.rows() != state.ndof())
+			return false;
+
+		// the Dirichlet DOFs are set by the problem, the modes only span the free DOFs
+		Eigen::MatrixXd free_modes(problem.reduced_size(), modes.cols());
+		for (int k = 0; k < modes.cols(); k++)
+			free_modes.col(k) = problem.full_to_reduced(modes.col(k));
+		const Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(free_modes);
+		const Eigen::MatrixXd basis = qr.householderQ() * Eigen::MatrixXd::Identity(free_modes.rows(), qr.rank());
+
+		// residual of the previous solution
+		Eigen::VectorXd x = problem.full_to_reduced(latest);
+		Eigen::VectorXd grad;
+		problem.init(problem.reduced_to_full(x));
+		problem.solution_changed(x);
+		problem.gradient(x, grad);
+		const double tol = std::max(reduced_relative_residual * grad.norm(), reduced_residual_tol);
+
+		const bool converged = galerkin_solve(problem, basis, x, reduced_max_iterations, 0.1 * tol);
+		if (converged)
+			problem.gradient(x, grad);
+
+		if (!converged || !(grad.norm() <= tol))
+		{
+			adjoint_logger().debug("Reduced solve of state {} rejected, residual {} > {}", i, converged ? grad.norm() : std::nan(""), tol);
+			// the full solve starts from the reduced solution
+			state.warm_start_sol = problem.reduced_to_full(x);
+			return false;
+		}
+
+		adjoint_logger().debug("Reduced solve of state {} with {} modes, residual {}", i, basis.cols(), grad.norm());
+		sol = problem.reduced_to_full(x);
+		state.cache_transient_adjoint_quantities(0, sol, Eigen::MatrixXd::Zero(state.mesh->dimension(), state.mesh->dimension()));
+		reduced_solves[i]++;
+		return true;
+	}
+
+	void AdjointNLProblem::set_warm_start(const Eigen::VectorXd &x)
+	{
+		// secant step of the last two solutions, projected on the change of the variables
+		double s = 0;
+		if (warm_start == WarmStart::Extrapolate && warm_start_x[1].size() == x.size())
+		{
+			const Eigen::VectorXd dx = warm_start_x[0] - warm_start_x[1];
+			const double dx_norm2 = dx.squaredNorm();
+			if (dx_norm2 > 0)
+				s = std::clamp((x - warm_start_x[0]).dot(dx) / dx_norm2, -1., 1.);
+		}
+
+		for (int i = 0; i < all_states_.size(); i++)
+		{
+			State &state = *all_states_[i];
+			const auto &[sol, prev_sol] = warm_start_sol[i];
+			if (!uses_warm_start(state) || sol.size() != state.ndof())
+			{
+				state.warm_start_sol.resize(0, 0);
+				continue;
+			}
+
+			// the shape variables move the nodes, the displacement of every node is kept
+			Eigen::MatrixXd guess = sol;
+			if (s != 0 && prev_sol.size() == sol.size())
+				guess += s * (sol - prev_sol);
+			if (nodes_are_input_nodes(state))
+				guess = utils::reorder_matrix(guess, state.in_node_to_node, state.n_bases, state.mesh->dimension());
+			state.warm_start_sol = guess;
+		}
+	}
+
+	void AdjointNLProblem::record_warm_start(const Eigen::VectorXd &x)
+	{
+		warm_start_x[1] = warm_start_x[0];
+		warm_start_x[0] = x;
+
+		for (int i = 0; i < all_states_.size(); i++)
+		{
+			const State &state = *all_states_[i];
+			auto &[sol, prev_sol] = warm_start_sol[i];
+			if (!uses_warm_start(state) || state.diff_cached.size() == 0)
+			{
+				sol.resize(0, 0);
+				prev_sol.resize(0, 0);
+				continue;
+			}
+
+			prev_sol = sol;
+			sol = state.diff_cached.u(0);
+			if (nodes_are_input_nodes(state))
+				sol = utils::unreorder_matrix(sol, state.in_node_to_node, state.n_bases, state.mesh->dimension());
+		}
+	}
+
+	std::vector<double> AdjointNLProblem::state_costs() const
+	{
+		// previous solve time when every state has been timed, number of DOFs otherwise
+		const bool timed = std::all_of(state_solve_time.begin(), state_solve_time.end(), [](const double t) { return t > 0; });
+
+		std::vector<double> costs(all_states_.size());
+		for (int i = 0; i < all_states_.size(); i++)
+			costs[i] = timed ? state_solve_time[i] : double(all_states_[i]->ndof());
+		return costs;
+	}
+
 	bool AdjointNLProblem::stop(const TVector &x)
 	{
+		if (gradient_norm_stop_ > 0)
+		{
+			Eigen::VectorXd grad;
+			gradient(x, grad);
+			if (grad.norm() < gradient_norm_stop_)
+			{
+				adjoint_logger().info("Gradient norm {:g} below {:g}, stopping", grad.norm(), gradient_norm_stop_);
+				return true;
+			}
+		}
+
 		if (stopping_conditions_.size() == 0)
 			return false;
 
+		solve_deferred();
+
 		for (auto &obj : stopping_conditions_)
 		{
 			obj->solution_changed(x);
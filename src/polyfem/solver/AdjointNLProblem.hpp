@@ -4,7 +4,10 @@
 #include <polyfem/Common.hpp>
 #include "FullNLProblem.hpp"
 #include <polyfem/solver/forms/adjoint_forms/VariableToSimulation.hpp>
+#include <polyfem/solver/ReducedBasis.hpp>
+#include <array>
 #include <fstream>
+#include <optional>
 
 namespace polyfem
 {
@@ -39,6 +42,20 @@ namespace polyfem::solver
 		void solution_changed(const Eigen::VectorXd &new_x) override;
 		void solve_pde();
 
+		/// @brief stop the optimization once the norm of the gradient is below tol, in addition to the stopping conditions
+		/// @param tol gradient norm, non-positive to disable
+		void set_gradient_norm_stop(const double tol) { gradient_norm_stop_ = tol; }
+
+		/// @brief checks the gradient against central finite differences along random unit directions,
+		/// the perturbed problems are solved concurrently on independent copies of the states
+		/// @param x variable
+		/// @param grad gradient at x
+		/// @param n_directions number of random directions
+		/// @param step finite difference step
+		/// @param n_copies number of copies of the problem, 0 for one per perturbation up to the number of threads
+		/// @return relative error of the directional derivative along every direction
+		Eigen::VectorXd check_derivatives(const Eigen::VectorXd &x, const Eigen::VectorXd &grad, const int n_directions, const double step, const int n_copies = 0);
+
 	private:
 		std::shared_ptr<AdjointForm> form_;
 		const VariableToSimulationGroup variables_to_simulation_;
@@ -53,11 +70,74 @@ namespace polyfem::solver
 		const bool enable_slim;
 		const bool smooth_line_search;
 
+		/// estimated cost of the forward solve of every state, used to size their TBB arenas
+		std::vector<double> state_costs() const;
+
 		const bool solve_in_parallel;
 		std::vector<int> solve_in_order;
+		std::vector<std::vector<int>> state_dependencies; ///< states whose solution is the initial guess of every state
+		std::vector<double> state_solve_time;             ///< duration of the last forward solve of every state
+
+		/// initial guess of the static nonlinear forward solves
+		enum class WarmStart
+		{
+			None,       ///< default initial solution
+			Previous,   ///< previous solution
+			Extrapolate ///< secant extrapolation of the last two solutions
+		};
+		const WarmStart warm_start;
+
+		/// sets the initial guess of every state from its previous solutions
+		void set_warm_start(const Eigen::VectorXd &x);
+		/// records the solutions of the states solved at x
+		void record_warm_start(const Eigen::VectorXd &x);
+
+		std::array<Eigen::VectorXd, 2> warm_start_x;                ///< last two variables solved, the latest first
+		std::vector<std::array<Eigen::MatrixXd, 2>> warm_start_sol; ///< solutions of every state at warm_start_x, in the order of the input nodes
+
+		/// assembles and solves the forward problem of a state
+		void solve_state(const int i);
+		/// @brief solves a state in the span of the POD of its previous solutions
+		/// @return false if the reduced model is not used or its residual is too large
+		bool reduced_solve(const int i);
+
+		/// reduced-order surrogate of the static nonlinear forward solves
+		const bool reduced_model;
+		const int reduced_refresh_frequency;     ///< reduced solves between two full solves
+		const int reduced_max_iterations;        ///< Newton iterations of a reduced solve
+		const double reduced_relative_residual;  ///< accepted residual, relative to the residual of the previous solution
+		const double reduced_residual_tol;       ///< accepted absolute residual
+		std::vector<ReducedBasis> reduced_bases; ///< POD of the full solutions of every state, in the order of the input nodes
+		std::vector<int> reduced_solves;         ///< reduced solves of every state since its last full solve
 
 		int save_iter = 0;
 
+		/// periodic gradient check after the optimization steps
+		const bool derivative_check;
+		const int derivative_check_directions;
+		const double derivative_check_step;
+		const int derivative_check_frequency;
+		const int derivative_check_copies;
+
+		json args_;                                                   ///< optimization arguments, used to create the copies of the problem
+		std::vector<std::unique_ptr<AdjointNLProblem>> problem_copies_; ///< independent copies solving the finite differences and the line search trials
+
+		/// @brief creates the copies of the problem missing to have n_problems of them
+		void create_problem_copies(const int n_problems);
+
+		/// speculative line search, the trials of the backtracking are solved concurrently on the copies of the problem
+		const int speculative_trials; ///< number of trials solved at the beginning of every line search, 0 if disabled
+		std::vector<std::pair<Eigen::VectorXd, double>> speculative_values_; ///< trials of the current line search and their objective
+
+		/// @brief solves the trials x0 + α (x1 - x0) with α = α0, α0 / 2, α0 / 4, ..., α0 the largest collision-free step
+		void solve_speculative_trials(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1);
+
+		/// objective of the speculative trial curr_x, whose forward solve solution_changed deferred
+		std::optional<double> deferred_value_;
+		/// @brief runs the forward solve deferred by solution_changed, if any
+		void solve_deferred();
+
 		std::vector<std::shared_ptr<AdjointForm>> stopping_conditions_; // if all the stopping conditions are non-positive, stop the optimization
+		double gradient_norm_stop_ = 0;                                 ///< stop once the gradient norm is below it, if positive
 	};
 } // namespace polyfem::solver
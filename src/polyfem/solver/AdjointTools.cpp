@@ -53,6 +53,28 @@ namespace polyfem::solver
 	{
 		double dot(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B) { return (A.array() * B.array()).sum(); }
 
+		/// stacks grad_u^T tau at every quadrature point in blocks of dim rows,
+		/// the shape derivative of tau : grad_u along a basis is then -(grad_u^T tau) grad_phi
+		void stack_grad_u_tau(const Eigen::MatrixXd &grad_u, const Eigen::MatrixXd &dj_dgradu, const int dim, const int actual_dim, Eigen::MatrixXd &grad_u_tau)
+		{
+			Eigen::MatrixXd tau_q, grad_u_q;
+			grad_u_tau.resize(grad_u.rows() * dim, dim);
+			for (int q = 0; q < grad_u.rows(); ++q)
+			{
+				if (dim == actual_dim) // Elasticity PDE
+				{
+					vector2matrix(dj_dgradu.row(q), tau_q);
+					vector2matrix(grad_u.row(q), grad_u_q);
+				}
+				else // Laplacian PDE
+				{
+					tau_q = dj_dgradu.row(q);
+					grad_u_q = grad_u.row(q);
+				}
+				grad_u_tau.middleRows(q * dim, dim) = grad_u_q.transpose() * tau_q;
+			}
+		}
+
 		class LocalThreadScalarStorage
 		{
 		public:
@@ -80,6 +102,37 @@ namespace polyfem::solver
 			}
 		};
 
+		/// contributions of the elements to a vector, stored as blocks on the nodes of the elements only
+		class LocalThreadSparseVecStorage
+		{
+		public:
+			std::vector<int> nodes;     ///< node of every block
+			std::vector<double> blocks; ///< block_size values per block
+			assembler::ElementAssemblyValues vals, gvals;
+			QuadratureVector da;
+			Eigen::MatrixXd grad_u_tau;
+
+			LocalThreadSparseVecStorage(const int block_size) : block_size_(block_size) {}
+
+			/// appends a zero block at a node, valid until the next call
+			Eigen::Map<Eigen::VectorXd> add(const int node)
+			{
+				nodes.push_back(node);
+				blocks.resize(blocks.size() + block_size_, 0);
+				return Eigen::Map<Eigen::VectorXd>(blocks.data() + blocks.size() - block_size_, block_size_);
+			}
+
+			/// sums the blocks into vec
+			void add_to(Eigen::VectorXd &vec) const
+			{
+				for (size_t k = 0; k < nodes.size(); ++k)
+					vec.segment(size_t(nodes[k]) * block_size_, block_size_) += Eigen::Map<const Eigen::VectorXd>(blocks.data() + k * block_size_, block_size_);
+			}
+
+		private:
+			int block_size_;
+		};
+
 		typedef DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1>> Diff;
 
 		template <typename T>
@@ -175,6 +228,36 @@ namespace polyfem::solver
 		}
 	} // namespace
 
+	std::vector<int> AdjointTools::active_integration_domain(
+		const State &state,
+		const std::set<int> &interested_ids,
+		const SpatialIntegralType spatial_integral_type)
+	{
+		std::vector<int> domain;
+		if (spatial_integral_type == SpatialIntegralType::Volume)
+		{
+			for (int e = 0; e < state.bases.size(); ++e)
+				if (interested_ids.size() == 0 || interested_ids.find(state.mesh->get_body_id(e)) != interested_ids.end())
+					domain.push_back(e);
+		}
+		else if (spatial_integral_type == SpatialIntegralType::Surface)
+		{
+			for (int lb_id = 0; lb_id < state.total_local_boundary.size(); ++lb_id)
+			{
+				const auto &lb = state.total_local_boundary[lb_id];
+				for (int i = 0; i < lb.size(); i++)
+				{
+					if (interested_ids.size() == 0 || interested_ids.find(state.mesh->get_boundary_id(lb.global_primitive_id(i))) != interested_ids.end())
+					{
+						domain.push_back(lb_id);
+						break;
+					}
+				}
+			}
+		}
+		return domain;
+	}
+
 	double AdjointTools::integrate_objective(
 		const State &state,
 		const IntegrableFunctional &j,
@@ -188,7 +271,8 @@ namespace polyfem::solver
 
 		const int dim = state.mesh->dimension();
 		const int actual_dim = state.problem->is_scalar() ? 1 : dim;
-		const int n_elements = int(bases.size());
+		// the loops only visit the elements (or local boundaries) the objective is restricted to
+		const std::vector<int> domain = active_integration_domain(state, interested_ids, spatial_integral_type);
 		const double t0 = state.problem->is_time_dependent() ? state.args["time"]["t0"].get<double>() : 0.0;
 		const double dt = state.problem->is_time_dependent() ? state.args["time"]["dt"].get<double>() : 0.0;
 
@@ -196,7 +280,7 @@ namespace polyfem::solver
 		if (spatial_integral_type == SpatialIntegralType::Volume)
 		{
 			auto storage = utils::create_thread_storage(LocalThreadScalarStorage());
-			utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+			utils::maybe_parallel_for(domain.size(), [&](int start, int end, int thread_id) {
 				LocalThreadScalarStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
 				IntegrableFunctional::ParameterType params;
@@ -206,11 +290,9 @@ namespace polyfem::solver
 				Eigen::MatrixXd u, grad_u;
 				Eigen::MatrixXd result;
 
-				for (int e = start; e < end; ++e)
+				for (int k = start; k < end; ++k)
 				{
-					if (interested_ids.size() != 0 && interested_ids.find(state.mesh->get_body_id(e)) == interested_ids.end())
-						continue;
-
+					const int e = domain[k];
 					assembler::ElementAssemblyValues &vals = local_storage.vals;
 					state.ass_vals_cache.compute(e, state.mesh->is_volume(), bases[e], gbases[e], vals);
 					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
@@ -233,7 +315,7 @@ namespace polyfem::solver
 		else if (spatial_integral_type == SpatialIntegralType::Surface)
 		{
 			auto storage = utils::create_thread_storage(LocalThreadScalarStorage());
-			utils::maybe_parallel_for(state.total_local_boundary.size(), [&](int start, int end, int thread_id) {
+			utils::maybe_parallel_for(domain.size(), [&](int start, int end, int thread_id) {
 				LocalThreadScalarStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
 				Eigen::MatrixXd uv;
@@ -246,9 +328,9 @@ namespace polyfem::solver
 				params.t = dt * cur_step + t0;
 				params.step = cur_step;
 
-				for (int lb_id = start; lb_id < end; ++lb_id)
+				for (int k = start; k < end; ++k)
 				{
-					const auto &lb = state.total_local_boundary[lb_id];
+					const auto &lb = state.total_local_boundary[domain[k]];
 					const int e = lb.element_id();
 
 					for (int i = 0; i < lb.size(); i++)
@@ -326,15 +408,17 @@ namespace polyfem::solver
 		const double t0 = state.problem->is_time_dependent() ? state.args["time"]["t0"].get<double>() : 0.0;
 		const double dt = state.problem->is_time_dependent() ? state.args["time"]["dt"].get<double>() : 0.0;
 
-		const int n_elements = int(bases.size());
+		// the loops only visit the elements (or local boundaries) the objective is restricted to
+		const std::vector<int> domain = active_integration_domain(state, interested_ids, spatial_integral_type);
+		const bool iso_parametric = state.iso_parametric();
 		term.setZero(state.n_geom_bases * dim, 1);
 
-		auto storage = utils::create_thread_storage(LocalThreadVecStorage(term.size()));
+		auto storage = utils::create_thread_storage(LocalThreadSparseVecStorage(dim));
 
 		if (spatial_integral_type == SpatialIntegralType::Volume)
 		{
-			utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
-				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			utils::maybe_parallel_for(domain.size(), [&](int start, int end, int thread_id) {
+				LocalThreadSparseVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
 				Eigen::MatrixXd u, grad_u, j_val, dj_dgradu, dj_dx;
 
@@ -342,17 +426,17 @@ namespace polyfem::solver
 				params.t = cur_time_step * dt + t0;
 				params.step = cur_time_step;
 
-				for (int e = start; e < end; ++e)
+				for (int k = start; k < end; ++k)
 				{
-					if (interested_ids.size() != 0 && interested_ids.find(state.mesh->get_body_id(e)) == interested_ids.end())
-						continue;
-
+					const int e = domain[k];
 					assembler::ElementAssemblyValues &vals = local_storage.vals;
 					state.ass_vals_cache.compute(e, state.mesh->is_volume(), bases[e], gbases[e], vals);
 					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
 
-					assembler::ElementAssemblyValues gvals;
-					gvals.compute(e, state.mesh->is_volume(), vals.quadrature.points, gbases[e], gbases[e]);
+					// the geometric values of iso-parametric elements are the cached values of the forward solve
+					if (!iso_parametric)
+						local_storage.gvals.compute(e, state.mesh->is_volume(), vals.quadrature.points, gbases[e], gbases[e]);
+					const assembler::ElementAssemblyValues &gvals = iso_parametric ? vals : local_storage.gvals;
 
 					const quadrature::Quadrature &quadrature = vals.quadrature;
 					local_storage.da = vals.det.array() * quadrature.weights.array();
@@ -370,31 +454,22 @@ namespace polyfem::solver
 					if (j.depend_on_x())
 						j.dj_dx(lame_params, quadrature.points, vals.val, u, grad_u, Eigen::MatrixXd::Zero(0, 0) /*Not used*/, vals, params, dj_dx);
 
-					Eigen::MatrixXd tau_q, grad_u_q;
+					// shared by the nodes of the element
+					if (j.depend_on_gradu())
+						stack_grad_u_tau(grad_u, dj_dgradu, dim, actual_dim, local_storage.grad_u_tau);
+
 					for (auto &v : gvals.basis_values)
 					{
+						Eigen::Map<Eigen::VectorXd> block = local_storage.add(v.global[0].index);
 						for (int q = 0; q < local_storage.da.size(); ++q)
 						{
-							local_storage.vec.block(v.global[0].index * dim, 0, dim, 1) += (j_val(q) * local_storage.da(q)) * v.grad_t_m.row(q).transpose();
+							block += (j_val(q) * local_storage.da(q)) * v.grad_t_m.row(q).transpose();
 
 							if (j.depend_on_x())
-								local_storage.vec.block(v.global[0].index * dim, 0, dim, 1) += (v.val(q) * local_storage.da(q)) * dj_dx.row(q).transpose();
+								block += (v.val(q) * local_storage.da(q)) * dj_dx.row(q).transpose();
 
 							if (j.depend_on_gradu())
-							{
-								if (dim == actual_dim) // Elasticity PDE
-								{
-									vector2matrix(dj_dgradu.row(q), tau_q);
-									vector2matrix(grad_u.row(q), grad_u_q);
-								}
-								else // Laplacian PDE
-								{
-									tau_q = dj_dgradu.row(q);
-									grad_u_q = grad_u.row(q);
-								}
-								for (int d = 0; d < dim; d++)
-									local_storage.vec(v.global[0].index * dim + d) += -dot(tau_q, grad_u_q.col(d) * v.grad_t_m.row(q)) * local_storage.da(q);
-							}
+								block -= local_storage.da(q) * local_storage.grad_u_tau.middleRows(q * dim, dim) * v.grad_t_m.row(q).transpose();
 						}
 					}
 				}
@@ -402,8 +477,8 @@ namespace polyfem::solver
 		}
 		else if (spatial_integral_type == SpatialIntegralType::Surface)
 		{
-			utils::maybe_parallel_for(state.total_local_boundary.size(), [&](int start, int end, int thread_id) {
-				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			utils::maybe_parallel_for(domain.size(), [&](int start, int end, int thread_id) {
+				LocalThreadSparseVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
 				Eigen::MatrixXd uv, points, normal;
 				Eigen::VectorXd &weights = local_storage.da;
@@ -414,9 +489,9 @@ namespace polyfem::solver
 				params.t = cur_time_step * dt + t0;
 				params.step = cur_time_step;
 
-				for (int lb_id = start; lb_id < end; ++lb_id)
+				for (int k = start; k < end; ++k)
 				{
-					const auto &lb = state.total_local_boundary[lb_id];
+					const auto &lb = state.total_local_boundary[domain[k]];
 					const int e = lb.element_id();
 
 					for (int i = 0; i < lb.size(); i++)
@@ -485,40 +560,30 @@ namespace polyfem::solver
 							velocity_div_mat = edge_velocity_divergence(V);
 						}
 
-						Eigen::MatrixXd grad_u_q, tau_q, grad_x_q;
 						for (long n = 0; n < nodes.size(); ++n)
 						{
 							const assembler::AssemblyValues &v = vals.basis_values[nodes(n)];
 
-							local_storage.vec.block(v.global[0].index * dim, 0, dim, 1) += j_val.sum() * velocity_div_mat.row(n).transpose();
+							local_storage.add(v.global[0].index) += j_val.sum() * velocity_div_mat.row(n).transpose();
 						}
 
+						// shared by the nodes of the element
+						if (j.depend_on_gradu())
+							stack_grad_u_tau(grad_u, dj_dgradu, dim, actual_dim, local_storage.grad_u_tau);
+
 						for (long n = 0; n < n_loc_bases_; ++n)
 						{
 							const assembler::AssemblyValues &v = vals.basis_values[n];
+							Eigen::Map<Eigen::VectorXd> block = local_storage.add(v.global[0].index);
 
 							if (j.depend_on_x())
-								local_storage.vec.block(v.global[0].index * dim, 0, dim, 1) += dj_dx.transpose() * v.val;
+								block += dj_dx.transpose() * v.val;
 
 							// integrate j * div(gbases) over the whole boundary
 							if (j.depend_on_gradu())
 							{
 								for (int q = 0; q < weights.size(); ++q)
-								{
-									if (dim == actual_dim) // Elasticity PDE
-									{
-										vector2matrix(grad_u.row(q), grad_u_q);
-										vector2matrix(dj_dgradu.row(q), tau_q);
-									}
-									else // Laplacian PDE
-									{
-										grad_u_q = grad_u.row(q);
-										tau_q = dj_dgradu.row(q);
-									}
-
-									for (int d = 0; d < dim; d++)
-										local_storage.vec(v.global[0].index * dim + d) += -dot(tau_q, grad_u_q.col(d) * v.grad_t_m.row(q));
-								}
+									block -= local_storage.grad_u_tau.middleRows(q * dim, dim) * v.grad_t_m.row(q).transpose();
 							}
 
 							if (j.depend_on_gradx())
@@ -526,7 +591,7 @@ namespace polyfem::solver
 								for (int d = 0; d < dim; d++)
 								{
 									for (int q = 0; q < weights.size(); ++q)
-										local_storage.vec(v.global[0].index * dim + d) += dot(dj_dgradx.block(q, d * dim, 1, dim), v.grad.row(q));
+										block(d) += dot(dj_dgradx.block(q, d * dim, 1, dim), v.grad.row(q));
 								}
 							}
 						}
@@ -538,8 +603,8 @@ namespace polyfem::solver
 		{
 			log_and_throw_adjoint_error("Shape derivative of vertex sum type functional is not implemented!");
 		}
-		for (const LocalThreadVecStorage &local_storage : storage)
-			term += local_storage.vec;
+		for (const LocalThreadSparseVecStorage &local_storage : storage)
+			local_storage.add_to(term);
 
 		term = utils::flatten(utils::unflatten(term, dim)(state.primitive_to_node(), Eigen::all));
 	}
@@ -922,7 +987,8 @@ namespace polyfem::solver
 
 		const int dim = state.mesh->dimension();
 		const int actual_dim = state.problem->is_scalar() ? 1 : dim;
-		const int n_elements = int(bases.size());
+		// the loops only visit the elements (or local boundaries) the objective is restricted to
+		const std::vector<int> domain = active_integration_domain(state, interested_ids, spatial_integral_type);
 		const double t0 = state.problem->is_time_dependent() ? state.args["time"]["t0"].get<double>() : 0.0;
 		const double dt = state.problem->is_time_dependent() ? state.args["time"]["dt"].get<double>() : 0.0;
 
@@ -933,9 +999,9 @@ namespace polyfem::solver
 
 		if (spatial_integral_type == SpatialIntegralType::Volume)
 		{
-			auto storage = utils::create_thread_storage(LocalThreadVecStorage(term.size()));
-			utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
-				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			auto storage = utils::create_thread_storage(LocalThreadSparseVecStorage(actual_dim));
+			utils::maybe_parallel_for(domain.size(), [&](int start, int end, int thread_id) {
+				LocalThreadSparseVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
 				Eigen::MatrixXd u, grad_u;
 				Eigen::MatrixXd lambda, mu;
@@ -945,11 +1011,9 @@ namespace polyfem::solver
 				params.t = dt * cur_step + t0;
 				params.step = cur_step;
 
-				for (int e = start; e < end; ++e)
+				for (int k = start; k < end; ++k)
 				{
-					if (interested_ids.size() != 0 && interested_ids.find(state.mesh->get_body_id(e)) == interested_ids.end())
-						continue;
-
+					const int e = domain[k];
 					assembler::ElementAssemblyValues &vals = local_storage.vals;
 					state.ass_vals_cache.compute(e, state.mesh->is_volume(), bases[e], gbases[e], vals);
 
@@ -985,6 +1049,7 @@ namespace polyfem::solver
 					{
 						const assembler::AssemblyValues &v = vals.basis_values[i];
 						assert(v.global.size() == 1);
+						Eigen::Map<Eigen::VectorXd> block = local_storage.add(v.global[0].index);
 						for (int d = 0; d < actual_dim; d++)
 						{
 							double val = 0;
@@ -1002,19 +1067,19 @@ namespace polyfem::solver
 								for (int q = 0; q < local_storage.da.size(); ++q)
 									val += dj_du(q, d) * v.val(q);
 							}
-							local_storage.vec(v.global[0].index * actual_dim + d) += val;
+							block(d) += val;
 						}
 					}
 				}
 			});
-			for (const LocalThreadVecStorage &local_storage : storage)
-				term += local_storage.vec;
+			for (const LocalThreadSparseVecStorage &local_storage : storage)
+				local_storage.add_to(term);
 		}
 		else if (spatial_integral_type == SpatialIntegralType::Surface)
 		{
-			auto storage = utils::create_thread_storage(LocalThreadVecStorage(term.size()));
-			utils::maybe_parallel_for(state.total_local_boundary.size(), [&](int start, int end, int thread_id) {
-				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			auto storage = utils::create_thread_storage(LocalThreadSparseVecStorage(actual_dim));
+			utils::maybe_parallel_for(domain.size(), [&](int start, int end, int thread_id) {
+				LocalThreadSparseVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
 				Eigen::MatrixXd uv, samples, gtmp;
 				Eigen::MatrixXd points, normal;
@@ -1028,9 +1093,9 @@ namespace polyfem::solver
 				params.t = dt * cur_step + t0;
 				params.step = cur_step;
 
-				for (int lb_id = start; lb_id < end; ++lb_id)
+				for (int k = start; k < end; ++k)
 				{
-					const auto &lb = state.total_local_boundary[lb_id];
+					const auto &lb = state.total_local_boundary[domain[k]];
 					const int e = lb.element_id();
 
 					for (int i = 0; i < lb.size(); i++)
@@ -1087,6 +1152,7 @@ namespace polyfem::solver
 							{
 								const assembler::AssemblyValues &v = vals.basis_values[nodes(n)];
 								assert(v.global.size() == 1);
+								Eigen::Map<Eigen::VectorXd> block = local_storage.add(v.global[0].index);
 								for (int d = 0; d < actual_dim; d++)
 								{
 									double val = 0;
@@ -1109,15 +1175,15 @@ namespace polyfem::solver
 										for (int q = 0; q < weights.size(); ++q)
 											val += dj_du(q, d) * v.val(q);
 									}
-									local_storage.vec(v.global[0].index * actual_dim + d) += val;
+									block(d) += val;
 								}
 							}
 						}
 					}
 				}
 			});
-			for (const LocalThreadVecStorage &local_storage : storage)
-				term += local_storage.vec;
+			for (const LocalThreadSparseVecStorage &local_storage : storage)
+				local_storage.add_to(term);
 		}
 		else if (spatial_integral_type == SpatialIntegralType::VertexSum)
 		{
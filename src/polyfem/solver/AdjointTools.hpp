@@ -32,6 +32,12 @@ namespace polyfem::solver
 
 	namespace AdjointTools
 	{
+		/// @brief Elements of the bodies in interested_ids for volume integrals, indices in State::total_local_boundary of the
+		/// local boundaries with a surface in interested_ids for surface integrals, all of them if interested_ids is empty
+		std::vector<int> active_integration_domain(
+			const State &state,
+			const std::set<int> &interested_ids,
+			const SpatialIntegralType spatial_integral_type);
 		double integrate_objective(
 			const State &state,
 			const IntegrableFunctional &j,
@@ -2,19 +2,33 @@
 
 #include <polyfem/Common.hpp>
 #include <polyfem/utils/Types.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
+#include <polyfem/utils/SparseMatrixSpill.hpp>
 #include <ipc/ipc.hpp>
 #include <ipc/collisions/collisions.hpp>
 #include <ipc/friction/friction_collisions.hpp>
 
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <memory>
+
 namespace polyfem::solver
 {
 	enum class CacheLevel
 	{
 		None,
 		Solution,
-		Derivatives
+		Derivatives,
+		Checkpoints ///< derivatives, keeping the Jacobians and collision sets of a bounded number of time steps
 	};
 
+	/// whether the forward solve is differentiated
+	inline bool caches_derivatives(const CacheLevel level)
+	{
+		return level == CacheLevel::Derivatives || level == CacheLevel::Checkpoints;
+	}
+
 	class DiffCache
 	{
 	public:
@@ -32,11 +46,39 @@ namespace polyfem::solver
 				acc_.setZero(ndof, n_time_steps + 1);
 				// gradu_h_prev_.resize(n_time_steps + 1);
 			}
-			gradu_h_.resize(n_time_steps + 1);
-			collision_set_.resize(n_time_steps + 1);
- 			friction_collision_set_.resize(n_time_steps + 1);
+			gradu_h_.assign(n_time_steps + 1, StiffnessMatrix());
+			collision_set_.assign(n_time_steps + 1, ipc::Collisions());
+			friction_collision_set_.assign(n_time_steps + 1, ipc::FrictionCollisions());
+
+			checkpoint_budget_ = 0;
+			recompute_ = nullptr;
+			spill_ = nullptr;
+			stored_.assign(n_time_steps + 1, true);
+			lru_.clear();
+		}
+
+		/// recomputes the Jacobian and the collision sets of a time step from the cached solutions
+		using RecomputeFunc = std::function<void(const int step, StiffnessMatrix &gradu_h, ipc::Collisions &collision_set, ipc::FrictionCollisions &friction_collision_set)>;
+
+		/// @brief keeps the Jacobians and collision sets of at most budget time steps, the others are recomputed on access
+		/// @param[in] budget number of time steps stored besides the first one, 0 stores all of them
+		/// @param[in] recompute recomputes the quantities of an evicted time step
+		void set_checkpoints(const int budget, const RecomputeFunc &recompute)
+		{
+			assert(budget <= 0 || recompute);
+			checkpoint_budget_ = std::max(budget, 0);
+			recompute_ = recompute;
 		}
 
+		inline int checkpoint_budget() const { return checkpoint_budget_; }
+
+		/// @brief writes the Jacobians to a scratch file, evicted Jacobians are read back instead of recomputed
+		/// the collision sets stay in memory, the number of Jacobians in memory is the checkpoint budget
+		/// @param[in] spill scratch file, nullptr keeps the Jacobians in memory
+		void set_spill(const std::shared_ptr<utils::SparseMatrixSpill> &spill) { spill_ = spill; }
+
+		inline const std::shared_ptr<utils::SparseMatrixSpill> &spill() const { return spill_; }
+
         void cache_quantities_static(
             const Eigen::MatrixXd &u,
             const StiffnessMatrix &gradu_h,
@@ -72,10 +114,13 @@ namespace polyfem::solver
 			acc_.col(cur_step) = acc;
 
 			gradu_h_[cur_step] = gradu_h;
+			if (spill_)
+				spill_->write(cur_step, gradu_h);
 			// gradu_h_prev_[cur_step] = gradu_h_prev;
 
 			collision_set_[cur_step] = collision_set;
 			friction_collision_set_[cur_step] = friction_collision_set;
+			stored(cur_step);
 
 			cur_size_++;
 		}
@@ -89,8 +134,11 @@ namespace polyfem::solver
         {
             u_.col(cur_step) = u;
             gradu_h_[cur_step] = gradu_h;
+            if (spill_)
+                spill_->write(cur_step, gradu_h);
             collision_set_[cur_step] = contact_set;
             disp_grad_[cur_step] = disp_grad;
+            stored(cur_step);
 
             cur_size_++;
         }
@@ -99,6 +147,22 @@ namespace polyfem::solver
 		const Eigen::MatrixXd &adjoint_mat() const { return adjoint_mat_; }
 
 		inline int size() const { return cur_size_; }
+
+		/// bytes allocated by the cached forward and adjoint quantities
+		size_t memory_usage() const
+		{
+			size_t bytes = utils::memory_usage(u_) + utils::memory_usage(v_) + utils::memory_usage(acc_)
+						   + utils::memory_usage(bdf_order_) + utils::memory_usage(adjoint_mat_);
+			for (const auto &disp_grad : disp_grad_)
+				bytes += utils::memory_usage(disp_grad);
+			for (const auto &gradu_h : gradu_h_)
+				bytes += utils::memory_usage(gradu_h);
+			for (const auto &collision_set : collision_set_)
+				bytes += utils::memory_usage(collision_set);
+			for (const auto &friction_collision_set : friction_collision_set_)
+				bytes += utils::memory_usage(friction_collision_set);
+			return bytes;
+		}
 		inline int bdf_order(int step) const
 		{
 			assert(step < size());
@@ -136,6 +200,7 @@ namespace polyfem::solver
 			assert(step < size());
 			if (step < 0)
 				step += gradu_h_.size();
+			load(step);
 			return gradu_h_[step];
 		}
 		// const StiffnessMatrix &gradu_h_prev(const int step) const { assert(step < size()); return gradu_h_prev_[step]; }
@@ -145,6 +210,7 @@ namespace polyfem::solver
 			assert(step < size());
 			if (step < 0)
 				step += collision_set_.size();
+			load(step);
 			return collision_set_[step];
 		}
 		const ipc::FrictionCollisions &friction_collision_set(int step) const
@@ -152,10 +218,59 @@ namespace polyfem::solver
 			assert(step < size());
 			if (step < 0)
 				step += friction_collision_set_.size();
+			load(step);
 			return friction_collision_set_[step];
 		}
 
 	private:
+		/// marks a time step as the most recently used, evicting the least recently used ones beyond the budget
+		void stored(const int step) const
+		{
+			if (checkpoint_budget_ <= 0 || step == 0)
+				return;
+
+			if (stored_[step])
+				lru_.remove(step);
+			stored_[step] = true;
+			lru_.push_front(step);
+
+			while (lru_.size() > size_t(checkpoint_budget_))
+			{
+				const int evicted = lru_.back();
+				lru_.pop_back();
+				stored_[evicted] = false;
+				gradu_h_[evicted] = StiffnessMatrix();
+				if (!spill_)
+				{
+					collision_set_[evicted] = ipc::Collisions();
+					friction_collision_set_[evicted] = ipc::FrictionCollisions();
+				}
+			}
+		}
+
+		/// reads or recomputes the quantities of an evicted time step
+		void load(const int step) const
+		{
+			if (checkpoint_budget_ <= 0 || step == 0)
+				return;
+
+			if (!stored_[step])
+			{
+				if (spill_)
+					spill_->read(step, gradu_h_[step]);
+				else
+					recompute_(step, gradu_h_[step], collision_set_[step], friction_collision_set_[step]);
+			}
+			stored(step);
+
+			// read-ahead in both directions, the adjoint goes backward and the shape derivatives forward
+			if (spill_)
+			{
+				spill_->prefetch(step - 1);
+				spill_->prefetch(step + 1);
+			}
+		}
+
 		int n_time_steps_ = 0;
 		int cur_size_ = 0;
 
@@ -166,11 +281,18 @@ namespace polyfem::solver
 
 		Eigen::VectorXi bdf_order_; // BDF orders used at each time step in forward simulation
 
-		std::vector<StiffnessMatrix> gradu_h_; // gradient of force at time T wrt. u  at time T
+		// mutable since evicted time steps are recomputed on access
+		mutable std::vector<StiffnessMatrix> gradu_h_; // gradient of force at time T wrt. u  at time T
 		// std::vector<StiffnessMatrix> gradu_h_prev_; // gradient of force at time T wrt. u at time (T-1) in transient simulations
 
-		std::vector<ipc::Collisions> collision_set_;
-		std::vector<ipc::FrictionCollisions> friction_collision_set_;
+		mutable std::vector<ipc::Collisions> collision_set_;
+		mutable std::vector<ipc::FrictionCollisions> friction_collision_set_;
+
+		int checkpoint_budget_ = 0;
+		RecomputeFunc recompute_;
+		std::shared_ptr<utils::SparseMatrixSpill> spill_;
+		mutable std::vector<bool> stored_; // whether the Jacobian and collision sets of a time step are in memory
+		mutable std::list<int> lru_;       // stored time steps, most recently used first
 
 		Eigen::MatrixXd adjoint_mat_;
 	};
@@ -1,7 +1,42 @@
 #include "FullNLProblem.hpp"
 
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Profiler.hpp>
+
+#include <algorithm>
+
 namespace polyfem::solver
 {
+	namespace
+	{
+		/// positions of the entries of h in the pattern of merged, false if some are missing
+		bool find_slots(const StiffnessMatrix &h, const StiffnessMatrix &merged, std::vector<StorageIndex> &positions)
+		{
+			if (merged.rows() != h.rows() || merged.cols() != h.cols())
+				return false;
+
+			const StorageIndex *merged_outer = merged.outerIndexPtr();
+			const StorageIndex *merged_inner = merged.innerIndexPtr();
+			positions.resize(h.nonZeros());
+
+			// inner indices are sorted in both patterns
+			for (int k = 0; k < h.outerSize(); ++k)
+			{
+				StorageIndex p = merged_outer[k];
+				const StorageIndex p_end = merged.isCompressed() ? merged_outer[k + 1] : p + merged.innerNonZeroPtr()[k];
+				for (StorageIndex j = h.outerIndexPtr()[k]; j < h.outerIndexPtr()[k + 1]; ++j)
+				{
+					while (p < p_end && merged_inner[p] < h.innerIndexPtr()[j])
+						++p;
+					if (p == p_end || merged_inner[p] != h.innerIndexPtr()[j])
+						return false;
+					positions[j] = p;
+				}
+			}
+			return true;
+		}
+	} // namespace
+
 	FullNLProblem::FullNLProblem(const std::vector<std::shared_ptr<Form>> &forms)
 		: forms_(forms)
 	{
@@ -9,6 +44,7 @@ namespace polyfem::solver
 
 	void FullNLProblem::init(const TVector &x)
 	{
+		clear_iterate_cache();
 		for (auto &f : forms_)
 			f->init(x);
 	}
@@ -21,12 +57,14 @@ namespace polyfem::solver
 
 	void FullNLProblem::init_lagging(const TVector &x)
 	{
+		clear_iterate_cache();
 		for (auto &f : forms_)
 			f->init_lagging(x);
 	}
 
 	void FullNLProblem::update_lagging(const TVector &x, const int iter_num)
 	{
+		clear_iterate_cache();
 		for (auto &f : forms_)
 			f->update_lagging(x, iter_num);
 	}
@@ -49,6 +87,8 @@ namespace polyfem::solver
 
 	void FullNLProblem::line_search_begin(const TVector &x0, const TVector &x1)
 	{
+		// the forms may have been changed directly (e.g., the AL multipliers), the trials of this search are cached again
+		clear_iterate_cache();
 		for (auto &f : forms_)
 			f->line_search_begin(x0, x1);
 	}
@@ -61,6 +101,7 @@ namespace polyfem::solver
 
 	double FullNLProblem::max_step_size(const TVector &x0, const TVector &x1)
 	{
+		POLYFEM_PROFILE_ZONE("max step size");
 		double step = 1;
 		for (auto &f : forms_)
 			if (f->enabled())
@@ -84,43 +125,261 @@ namespace polyfem::solver
 		return true;
 	}
 
+	// The forms are independent, so they are evaluated concurrently into their own buffers,
+	// which are then summed in the order of the forms to keep the result deterministic.
+
+	const std::vector<double> *FullNLProblem::cached_form_values(const TVector &x) const
+	{
+		const IterateCache &cache = iterate_cache_;
+		if (!cache.has_value || cache.weights.size() != forms_.size() || cache.x.size() != x.size() || cache.x != x)
+			return nullptr;
+
+		for (int i = 0; i < forms_.size(); ++i)
+			if (cache.weights[i] != (forms_[i]->enabled() ? forms_[i]->weight() : 0))
+				return nullptr;
+
+		return &cache.form_values;
+	}
+
+	bool FullNLProblem::use_iterate_cache(const TVector &x)
+	{
+		IterateCache &cache = iterate_cache_;
+
+		Eigen::VectorXd weights(forms_.size());
+		for (int i = 0; i < forms_.size(); ++i)
+			weights[i] = forms_[i]->enabled() ? forms_[i]->weight() : 0;
+
+		if (cache.x.size() == x.size() && cache.weights.size() == weights.size() && cache.x == x && cache.weights == weights)
+			return true;
+
+		cache.x = x;
+		cache.weights = weights;
+		cache.has_value = false;
+		cache.has_grad = false;
+		return false;
+	}
+
 	double FullNLProblem::value(const TVector &x)
 	{
+		POLYFEM_PROFILE_ZONE("energy");
+		if (use_iterate_cache(x) && iterate_cache_.has_value)
+			return iterate_cache_.value;
+
+		std::vector<double> values(forms_.size(), 0);
+		utils::maybe_parallel_for(int(forms_.size()), [&](int i) {
+			if (forms_[i]->enabled())
+				values[i] = forms_[i]->value(x);
+		});
+
 		double val = 0;
-		for (auto &f : forms_)
-			if (f->enabled())
-				val += f->value(x);
+		for (const double v : values)
+			val += v;
+
+		iterate_cache_.value = val;
+		iterate_cache_.form_values = values;
+		iterate_cache_.has_value = true;
 		return val;
 	}
 
 	void FullNLProblem::gradient(const TVector &x, TVector &grad)
 	{
-		grad = TVector::Zero(x.size());
-		for (auto &f : forms_)
+		POLYFEM_PROFILE_ZONE("gradient");
+		if (use_iterate_cache(x) && iterate_cache_.has_grad)
 		{
-			if (!f->enabled())
-				continue;
-			TVector tmp;
-			f->first_derivative(x, tmp);
-			grad += tmp;
+			grad = iterate_cache_.grad;
+			return;
 		}
+
+		std::vector<TVector> grads(forms_.size());
+		utils::maybe_parallel_for(int(forms_.size()), [&](int i) {
+			if (forms_[i]->enabled())
+				forms_[i]->first_derivative(x, grads[i]);
+		});
+
+		grad = TVector::Zero(x.size());
+		for (int i = 0; i < forms_.size(); ++i)
+			if (forms_[i]->enabled())
+				grad += grads[i];
+
+		iterate_cache_.grad = grad;
+		iterate_cache_.has_grad = true;
 	}
 
 	void FullNLProblem::hessian(const TVector &x, THessian &hessian)
 	{
+		POLYFEM_PROFILE_ZONE("hessian");
+		std::vector<THessian> hessians(forms_.size());
+		utils::maybe_parallel_for(int(forms_.size()), [&](int i) {
+			if (forms_[i]->enabled())
+				forms_[i]->second_derivative(x, hessians[i]);
+		});
+
+		std::vector<THessian> enabled_hessians;
+		for (int i = 0; i < forms_.size(); ++i)
+			if (forms_[i]->enabled())
+				enabled_hessians.push_back(std::move(hessians[i]));
+
 		hessian.resize(x.size(), x.size());
-		for (auto &f : forms_)
+		sum_hessians(enabled_hessians, hessian);
+	}
+
+	void FullNLProblem::hessian_vector_product(const TVector &x, const TVector &v, TVector &hv)
+	{
+		std::vector<TVector> hvs(forms_.size());
+		utils::maybe_parallel_for(int(forms_.size()), [&](int i) {
+			if (forms_[i]->enabled())
+				forms_[i]->hessian_vector_product(x, v, hvs[i]);
+		});
+
+		hv = TVector::Zero(x.size());
+		for (int i = 0; i < forms_.size(); ++i)
+			if (forms_[i]->enabled())
+				hv += hvs[i];
+	}
+
+	void FullNLProblem::evaluate(const TVector &x, double *value, TVector *grad, THessian *hessian)
+	{
+		POLYFEM_PROFILE_ZONE("evaluate");
+		IterateCache &cache = iterate_cache_;
+		if (use_iterate_cache(x))
 		{
-			if (!f->enabled())
+			if (value && cache.has_value)
+			{
+				*value = cache.value;
+				value = nullptr;
+			}
+			if (grad && cache.has_grad)
+			{
+				*grad = cache.grad;
+				grad = nullptr;
+			}
+			if (!value && !grad && !hessian)
+				return;
+		}
+
+		std::vector<double> values(forms_.size(), 0);
+		std::vector<TVector> grads(forms_.size());
+		std::vector<THessian> hessians(forms_.size());
+		utils::maybe_parallel_for(int(forms_.size()), [&](int i) {
+			if (forms_[i]->enabled())
+				forms_[i]->evaluate(x, value ? &values[i] : nullptr, grad ? &grads[i] : nullptr, hessian ? &hessians[i] : nullptr);
+		});
+
+		if (value)
+		{
+			*value = 0;
+			for (const double v : values)
+				*value += v;
+
+			cache.value = *value;
+			cache.form_values = values;
+			cache.has_value = true;
+		}
+		if (grad)
+		{
+			*grad = TVector::Zero(x.size());
+			for (int i = 0; i < forms_.size(); ++i)
+				if (forms_[i]->enabled())
+					*grad += grads[i];
+
+			cache.grad = *grad;
+			cache.has_grad = true;
+		}
+		if (hessian)
+		{
+			std::vector<THessian> enabled_hessians;
+			for (int i = 0; i < forms_.size(); ++i)
+				if (forms_[i]->enabled())
+					enabled_hessians.push_back(std::move(hessians[i]));
+
+			hessian->resize(x.size(), x.size());
+			sum_hessians(enabled_hessians, *hessian);
+		}
+	}
+
+	void FullNLProblem::sum_hessians(std::vector<THessian> &hessians, THessian &hessian)
+	{
+		POLYFEM_PROFILE_ZONE("sum hessians");
+		HessianSumCache &cache = hessian_sum_cache_;
+		const int n = hessian.rows();
+
+		if (cache.merged.rows() != n || cache.outer.size() != hessians.size())
+		{
+			cache.merged.resize(n, n);
+			cache.outer.assign(hessians.size(), {});
+			cache.inner.assign(hessians.size(), {});
+			cache.positions.assign(hessians.size(), {});
+		}
+
+		// Only the forms whose sparsity changed (e.g., the contacts) need new slots
+		bool fits = true;
+		for (int i = 0; i < hessians.size(); ++i)
+		{
+			THessian &h = hessians[i];
+			h.makeCompressed();
+
+			const bool same_pattern =
+				cache.outer[i].size() == h.outerSize() + 1 && cache.inner[i].size() == h.nonZeros()
+				&& std::equal(cache.outer[i].begin(), cache.outer[i].end(), h.outerIndexPtr())
+				&& std::equal(cache.inner[i].begin(), cache.inner[i].end(), h.innerIndexPtr());
+			if (same_pattern)
 				continue;
-			THessian tmp;
-			f->second_derivative(x, tmp);
-			hessian += tmp;
+
+			cache.outer[i].assign(h.outerIndexPtr(), h.outerIndexPtr() + h.outerSize() + 1);
+			cache.inner[i].assign(h.innerIndexPtr(), h.innerIndexPtr() + h.nonZeros());
+			fits = find_slots(h, cache.merged, cache.positions[i]) && fits;
 		}
+
+		if (!fits)
+		{
+			// Grow the merged pattern to the union of the forms. The slots reserved by previous
+			// calls (e.g., contacts that came and went) are kept unless they dominate the pattern.
+			StorageIndex forms_nnz = 0;
+			for (const THessian &h : hessians)
+				forms_nnz += h.nonZeros();
+
+			THessian merged(n, n);
+			if (cache.merged.nonZeros() <= forms_nnz)
+				merged = cache.merged;
+			for (const THessian &h : hessians)
+				merged += h;
+			merged.makeCompressed();
+			cache.merged = std::move(merged);
+
+			for (int i = 0; i < hessians.size(); ++i)
+			{
+				[[maybe_unused]] const bool found = find_slots(hessians[i], cache.merged, cache.positions[i]);
+				assert(found);
+			}
+		}
+
+		hessian = cache.merged;
+		double *values = hessian.valuePtr();
+		std::fill(values, values + hessian.nonZeros(), 0);
+
+		// every column of the merged pattern is only written by one thread
+		utils::maybe_parallel_for(n, [&](int start, int end, int thread_id) {
+			for (int i = 0; i < hessians.size(); ++i)
+			{
+				const std::vector<StorageIndex> &positions = cache.positions[i];
+				const double *form_values = hessians[i].valuePtr();
+				for (StorageIndex j = hessians[i].outerIndexPtr()[start]; j < hessians[i].outerIndexPtr()[end]; ++j)
+					values[positions[j]] += form_values[j];
+			}
+		});
 	}
 
 	void FullNLProblem::solution_changed(const TVector &x)
 	{
+		// e.g., the accepted trial of the line search, whose collision sets are already up to date
+		IterateCache &cache = iterate_cache_;
+		if (cache.has_solution && cache.solution.size() == x.size() && cache.solution == x)
+			return;
+		cache.solution = x;
+		cache.has_solution = true;
+		cache.has_value = false;
+		cache.has_grad = false;
+
 		for (auto &f : forms_)
 			f->solution_changed(x);
 	}
@@ -18,6 +18,14 @@ namespace polyfem::solver
 		virtual double value(const TVector &x) override;
 		virtual void gradient(const TVector &x, TVector &gradv) override;
 		virtual void hessian(const TVector &x, THessian &hessian) override;
+		/// @brief Product of the Hessian at x with v, without assembling the global Hessian when the forms allow it
+		virtual void hessian_vector_product(const TVector &x, const TVector &v, TVector &hv);
+		/// @brief Compute the requested quantities at x in a single pass over the forms
+		/// @param[in] x Current solution
+		/// @param[out] value Output value, not computed if nullptr
+		/// @param[out] gradv Output gradient, not computed if nullptr
+		/// @param[out] hessian Output Hessian, not computed if nullptr
+		virtual void evaluate(const TVector &x, double *value, TVector *gradv, THessian *hessian);
 
 		virtual bool is_step_valid(const TVector &x0, const TVector &x1) override;
 		virtual bool is_step_collision_free(const TVector &x0, const TVector &x1);
@@ -38,9 +46,61 @@ namespace polyfem::solver
 
 		std::vector<std::shared_ptr<Form>> &forms() { return forms_; }
 
+		/// @brief Values of the forms, in the order of forms(), from the last evaluation of the energy
+		/// @param x Full solution
+		/// @return nullptr if the energy was not evaluated at x with the current weights, 0 for the disabled forms
+		const std::vector<double> *cached_form_values(const TVector &x) const;
+
 		virtual bool stop(const TVector &x) override { return false; }
 
 	protected:
 		std::vector<std::shared_ptr<Form>> forms_;
+
+		/// @brief forgets the cached iterate, to be called when the forms change for a fixed x (e.g., a new time step)
+		void clear_iterate_cache() { iterate_cache_.clear(); }
+
+		/// @brief sums the Hessians of the forms by scattering their values into slots of a merged pattern
+		/// @note The merged pattern only grows when a form adds entries it does not have, entries dropped by a form stay as explicit zeros.
+		/// @param hessians Hessians of the enabled forms, compressed in place
+		/// @param hessian sum of the Hessians, with the merged pattern
+		void sum_hessians(std::vector<THessian> &hessians, THessian &hessian);
+
+		/// Sparsity of the Hessian of every form and the slots of its values in the merged pattern.
+		struct HessianSumCache
+		{
+			std::vector<std::vector<StorageIndex>> outer;
+			std::vector<std::vector<StorageIndex>> inner;
+			std::vector<std::vector<StorageIndex>> positions;
+			THessian merged;
+		};
+		HessianSumCache hessian_sum_cache_;
+
+	private:
+		/// Value, gradient and solution (i.e., collision sets) at the last iterate. The accepted trial of the line search
+		/// is evaluated again by the next Newton iteration, the weights catch forms changed in between (e.g., barrier stiffness).
+		struct IterateCache
+		{
+			TVector x;               ///< iterate of the cached value and gradient
+			Eigen::VectorXd weights; ///< weights of the forms at x, 0 for the disabled ones
+			double value;
+			std::vector<double> form_values; ///< weighted value of every form summed into value
+			TVector grad;
+			bool has_value = false;
+			bool has_grad = false;
+
+			TVector solution; ///< last iterate passed to solution_changed
+			bool has_solution = false;
+
+			void clear()
+			{
+				has_value = false;
+				has_grad = false;
+				has_solution = false;
+			}
+		};
+		IterateCache iterate_cache_;
+
+		/// @brief true if the cached value and gradient were computed at x with the current weights, otherwise resets the cache to x
+		bool use_iterate_cache(const TVector &x);
 	};
 } // namespace polyfem::solver
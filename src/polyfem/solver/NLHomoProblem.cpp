@@ -155,6 +155,14 @@ namespace polyfem::solver
 
         NLProblem::full_hessian_to_reduced_hessian(mid, reduced);
     }
+    void NLHomoProblem::hessian_vector_product(const TVector &x, const TVector &v, TVector &hv)
+    {
+        // the macro strain couples all the dofs, use the assembled Hessian
+        THessian hessian;
+        this->hessian(x, hessian);
+        hv = hessian * v;
+    }
+
     void NLHomoProblem::hessian(const TVector &x, THessian &hessian)
     {
         NLProblem::hessian(x, hessian);
@@ -192,6 +200,32 @@ namespace polyfem::solver
                 macro_mid_to_reduced_(j++, i) = 1;
     }
 
+    Eigen::MatrixXd NLHomoProblem::effective_stiffness(const TVector &x, polysolve::linear::Solver &solver)
+    {
+        const int dof2 = macro_reduced_size();
+        const int dof1 = reduced_size();
+        assert(x.size() == dof1 + dof2);
+        assert(fixed_mask_.sum() == 0);
+
+        THessian hessian;
+        this->hessian(x, hessian);
+
+        const StiffnessMatrix A = hessian.topLeftCorner(dof1, dof1);
+        const Eigen::MatrixXd B = Eigen::MatrixXd(hessian.topRightCorner(dof1, dof2));
+        const Eigen::MatrixXd C = Eigen::MatrixXd(hessian.bottomRightCorner(dof2, dof2));
+
+        // the load cases only differ by their right-hand side
+        solver.analyze_pattern(A, A.rows());
+        solver.factorize(A);
+        Eigen::MatrixXd X(dof1, dof2);
+        for (int i = 0; i < dof2; ++i)
+            solver.solve(B.col(i), X.col(i));
+
+        const Eigen::MatrixXd reduced_stiffness = C - B.transpose() * X;
+        const Eigen::MatrixXd P = macro_mid_to_reduced_ * macro_full_to_mid_;
+        return P.transpose() * reduced_stiffness * P;
+    }
+
     void NLHomoProblem::full_hessian_to_reduced_hessian(const THessian &full, THessian &reduced) const
     {
         const int dim = state_.mesh->dimension();
@@ -226,6 +260,13 @@ namespace polyfem::solver
         NLProblem::full_hessian_to_reduced_hessian(mid, reduced);
     }
 
+    void NLHomoProblem::full_hessian_to_reduced_hessian_in_place(THessian &hessian) const
+    {
+        // the macro strain adds rows and columns, the reduction cannot be done in place
+        const THessian full = std::move(hessian);
+        full_hessian_to_reduced_hessian(full, hessian);
+    }
+
     NLHomoProblem::TVector NLHomoProblem::full_to_reduced(const TVector &full) const
     {
         log_and_throw_error("Invalid function!");
@@ -2,6 +2,8 @@
 
 #include "NLProblem.hpp"
 
+#include <polysolve/linear/Solver.hpp>
+
 namespace polyfem
 {
 	class State;
@@ -33,8 +35,10 @@ namespace polyfem::solver
 		double value(const TVector &x) override;
 		void gradient(const TVector &x, TVector &gradv) override;
 		void hessian(const TVector &x, THessian &hessian) override;
+		void hessian_vector_product(const TVector &x, const TVector &v, TVector &hv) override;
 
 		void full_hessian_to_reduced_hessian(const THessian &full, THessian &reduced) const override;
+		void full_hessian_to_reduced_hessian_in_place(THessian &hessian) const override;
 
 		int macro_reduced_size() const;
 
@@ -50,6 +54,13 @@ namespace polyfem::solver
 
 		void set_fixed_entry(const Eigen::VectorXi &fixed_entry);
 
+		/// @brief Effective stiffness of the cell at x: the Hessian of the energy wrt the macro strain with the fluctuation relaxed,
+		/// i.e. the Schur complement of the fluctuation block. All unit macro strain load cases are solved with one factorization.
+		/// @param x Reduced solution, with no fixed macro strain entry
+		/// @param solver Linear solver for the fluctuation block
+		/// @return (dim*dim) x (dim*dim) stiffness wrt the flattened displacement gradient
+		Eigen::MatrixXd effective_stiffness(const TVector &x, polysolve::linear::Solver &solver);
+
 		void init(const TVector &x0) override;
 		bool is_step_valid(const TVector &x0, const TVector &x1) override;
 		bool is_step_collision_free(const TVector &x0, const TVector &x1) override;
@@ -1,6 +1,11 @@
 #include "NLProblem.hpp"
 
 #include <polyfem/io/OBJWriter.hpp>
+#include <polyfem/io/MatrixIO.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <numeric>
 
 /*
 m \frac{\partial^2 u}{\partial t^2} = \psi = \text{div}(\sigma[u])\newline
@@ -72,6 +77,9 @@ namespace polyfem::solver
 	void NLProblem::update_quantities(const double t, const TVector &x)
 	{
 		t_ = t;
+		clear_iterate_cache();
+		// the gradient norms of the previous step do not measure the progress of the next one
+		lagged_hessian_.grad_norm = lagged_hessian_.prev_grad_norm = -1;
 		const TVector full = reduced_to_full(x);
 		for (auto &f : forms_)
 			f->update_quantities(t, full);
@@ -112,20 +120,85 @@ namespace polyfem::solver
 
 	void NLProblem::hessian(const TVector &x, THessian &hessian)
 	{
-		THessian full_hessian;
-		FullNLProblem::hessian(reduced_to_full(x), full_hessian);
+		if (reuse_lagged_hessian())
+		{
+			logger().debug("Reusing the Hessian of {} iterations ago", lagged_hessian_.uses);
+			hessian = lagged_hessian_.hessian;
+			++lagged_hessian_.uses;
+			return;
+		}
+
+		FullNLProblem::hessian(reduced_to_full(x), hessian);
+
+		full_hessian_to_reduced_hessian_in_place(hessian);
+		export_hessian(hessian);
+
+		if (hessian_lag_iterations_ > 1)
+		{
+			lagged_hessian_.hessian = hessian;
+			lagged_hessian_.uses = 1;
+		}
+	}
+
+	bool NLProblem::reuse_lagged_hessian() const
+	{
+		const LaggedHessian &lagged = lagged_hessian_;
+		if (lagged.uses <= 0 || lagged.uses >= hessian_lag_iterations_ || lagged.hessian.rows() != current_size())
+			return false;
+
+		// without the norms of two iterations (i.e., at the first one of a step) only the number of uses limits the reuse
+		if (lagged.grad_norm < 0 || lagged.prev_grad_norm <= 0)
+			return true;
+		return lagged.grad_norm <= hessian_lag_ratio_ * lagged.prev_grad_norm;
+	}
 
-		full_hessian_to_reduced_hessian(full_hessian, hessian);
+	void NLProblem::set_hessian_lagging(const int max_iterations, const double residual_ratio)
+	{
+		hessian_lag_iterations_ = std::max(1, max_iterations);
+		hessian_lag_ratio_ = residual_ratio;
+		lagged_hessian_ = LaggedHessian();
 	}
 
-	void NLProblem::solution_changed(const TVector &newX)
+	void NLProblem::hessian_vector_product(const TVector &x, const TVector &v, TVector &hv)
+	{
+		// v is a direction, its Dirichlet entries are zero instead of the boundary values
+		TVector full_v;
+		reduced_to_full_aux(boundary_nodes_, full_size(), current_size(), v, Eigen::MatrixXd::Zero(full_size(), 1), full_v);
+
+		TVector full_hv;
+		FullNLProblem::hessian_vector_product(reduced_to_full(x), full_v, full_hv);
+		hv = full_to_reduced_grad(full_hv);
+	}
+
+	void NLProblem::evaluate(const TVector &x, double *value, TVector *grad, THessian *hessian)
+	{
+		TVector full_grad;
+		FullNLProblem::evaluate(reduced_to_full(x), value, grad ? &full_grad : nullptr, hessian);
+
+		if (grad)
+			*grad = full_to_reduced_grad(full_grad);
+		if (hessian)
+		{
+			full_hessian_to_reduced_hessian_in_place(*hessian);
+			export_hessian(*hessian);
+		}
+	}
+
+		void NLProblem::solution_changed(const TVector &newX)
 	{
 		FullNLProblem::solution_changed(reduced_to_full(newX));
 	}
 
 	void NLProblem::post_step(const polysolve::nonlinear::PostStepData &data)
 	{
-		FullNLProblem::post_step(polysolve::nonlinear::PostStepData(data.iter_num, data.solver_info, reduced_to_full(data.x), reduced_to_full(data.grad)));
+		lagged_hessian_.prev_grad_norm = lagged_hessian_.grad_norm;
+		lagged_hessian_.grad_norm = data.grad.norm();
+
+		const TVector full_x = reduced_to_full(data.x);
+		FullNLProblem::post_step(polysolve::nonlinear::PostStepData(data.iter_num, data.solver_info, full_x, reduced_to_full(data.grad)));
+
+		if (post_step_callback)
+			post_step_callback(data.iter_num, full_x);
 
 		// TODO: add me back
 		// if (state_.args["output"]["advanced"]["save_nl_solve_sequence"])
@@ -143,6 +216,26 @@ namespace polyfem::solver
 		TVector full = reduced_to_full(x);
 		for (auto &form : forms_)
 			form->set_apply_DBC(full, val);
+		// the forms changed, so did their Hessian
+		lagged_hessian_.uses = 0;
+	}
+
+	void NLProblem::set_hessian_export(const std::string &path, const int compression)
+	{
+		hessian_export_path_ = path;
+		hessian_export_compression_ = compression;
+		n_exported_hessians_ = 0;
+	}
+
+	void NLProblem::export_hessian(const THessian &hessian)
+	{
+		if (hessian_export_path_.empty())
+			return;
+
+		const bool replace = n_exported_hessians_ == 0;
+		if (!io::write_sparse_matrix(hessian_export_path_, fmt::format("hessian_{:04d}", n_exported_hessians_), hessian, replace, hessian_export_compression_))
+			logger().warn("Unable to export the Hessian to {}", hessian_export_path_);
+		++n_exported_hessians_;
 	}
 
 	NLProblem::TVector NLProblem::full_to_reduced(const TVector &full) const
@@ -288,14 +381,150 @@ namespace polyfem::solver
 	void NLProblem::full_hessian_to_reduced_hessian(const THessian &full, THessian &reduced) const
 	{
 		// POLYFEM_SCOPED_TIMER("\tfull hessian to reduced hessian");
-		THessian mid = full;
-		
-		if (periodic_bc_)
-			periodic_bc_->full_to_periodic(mid);
+		if (!periodic_bc_ && current_size() == full_size())
+		{
+			reduced = full;
+			return;
+		}
+
+		// The periodic identification and the Dirichlet removal are applied together through the dof remap table
+		if (full.isCompressed())
+			reduce_hessian_with_cached_pattern(full, reduced);
+		else
+		{
+			THessian compressed = full;
+			compressed.makeCompressed();
+			reduce_hessian_with_cached_pattern(compressed, reduced);
+		}
+	}
 
-		if (current_size() < full_size())
-			utils::full_to_reduced_matrix(mid.rows(), mid.rows() - boundary_nodes_.size(), boundary_nodes_, mid, reduced);
+	void NLProblem::full_hessian_to_reduced_hessian_in_place(THessian &hessian) const
+	{
+		if (periodic_bc_ || current_size() == full_size())
+		{
+			const THessian full = std::move(hessian);
+			full_hessian_to_reduced_hessian(full, hessian);
+			return;
+		}
+
+		utils::full_to_reduced_matrix_in_place(boundary_nodes_, hessian);
+	}
+
+	int NLProblem::reduced_dof_index(const int n_full, const bool remove_boundary, std::vector<int> &index) const
+	{
+		int n_mid = n_full;
+		if (periodic_bc_)
+		{
+			const Eigen::VectorXi periodic_index = periodic_bc_->full_to_periodic_index(n_full);
+			index.assign(periodic_index.data(), periodic_index.data() + n_full);
+			n_mid = n_full > 0 ? periodic_index.maxCoeff() + 1 : 0;
+		}
 		else
-			reduced = mid;
+		{
+			index.resize(n_full);
+			std::iota(index.begin(), index.end(), 0);
+		}
+
+		if (!remove_boundary)
+			return n_mid;
+
+		// boundary_nodes_ are in the periodic numbering
+		std::vector<int> shifted(n_mid);
+		int j = 0;
+		size_t k = 0;
+		for (int i = 0; i < n_mid; ++i)
+		{
+			if (k < boundary_nodes_.size() && boundary_nodes_[k] == i)
+			{
+				++k;
+				shifted[i] = -1;
+			}
+			else
+				shifted[i] = j++;
+		}
+
+		for (int &i : index)
+			i = shifted[i];
+
+		return j;
+	}
+
+	bool NLProblem::reduce_hessian_with_cached_pattern(const THessian &full, THessian &reduced) const
+	{
+		assert(full.isCompressed());
+
+		ReducedHessianCache &cache = reduced_hessian_cache_;
+		const bool remove_boundary = current_size() < full_size();
+		const StorageIndex n_outer = full.outerSize() + 1;
+		const StorageIndex nnz = full.nonZeros();
+		const StorageIndex *full_outer = full.outerIndexPtr();
+		const StorageIndex *full_inner = full.innerIndexPtr();
+
+		const bool same_pattern =
+			cache.remove_boundary == remove_boundary
+			&& StorageIndex(cache.full_outer.size()) == n_outer && StorageIndex(cache.full_inner.size()) == nnz
+			&& std::equal(cache.full_outer.begin(), cache.full_outer.end(), full_outer)
+			&& std::equal(cache.full_inner.begin(), cache.full_inner.end(), full_inner);
+
+		if (!same_pattern)
+		{
+			// New pattern: remap the entries once and record the reduced slot of every full value
+			std::vector<int> index;
+			const int n_reduced = reduced_dof_index(full.rows(), remove_boundary, index);
+
+			std::vector<Eigen::Triplet<double>> entries;
+			entries.reserve(nnz);
+			for (int k = 0; k < full.outerSize(); ++k)
+			{
+				if (index[k] < 0)
+					continue;
+				for (StorageIndex j = full_outer[k]; j < full_outer[k + 1]; ++j)
+				{
+					if (index[full_inner[j]] >= 0)
+						entries.emplace_back(index[full_inner[j]], index[k], 0);
+				}
+			}
+
+			cache.reduced.resize(n_reduced, n_reduced);
+			cache.reduced.setFromTriplets(entries.begin(), entries.end());
+			cache.reduced.makeCompressed();
+
+			const StorageIndex *reduced_outer = cache.reduced.outerIndexPtr();
+			const StorageIndex *reduced_inner = cache.reduced.innerIndexPtr();
+			cache.slots.resize(nnz);
+			for (int k = 0; k < full.outerSize(); ++k)
+			{
+				const int c = index[k];
+				for (StorageIndex j = full_outer[k]; j < full_outer[k + 1]; ++j)
+				{
+					const int r = index[full_inner[j]];
+					if (c < 0 || r < 0)
+					{
+						cache.slots[j] = -1;
+						continue;
+					}
+
+					const StorageIndex *begin = reduced_inner + reduced_outer[c];
+					const StorageIndex *end = reduced_inner + reduced_outer[c + 1];
+					cache.slots[j] = std::lower_bound(begin, end, r) - reduced_inner;
+				}
+			}
+
+			cache.full_outer.assign(full_outer, full_outer + n_outer);
+			cache.full_inner.assign(full_inner, full_inner + nnz);
+			cache.remove_boundary = remove_boundary;
+		}
+
+		reduced = cache.reduced;
+		double *values = reduced.valuePtr();
+		const double *full_values = full.valuePtr();
+		std::fill(values, values + reduced.nonZeros(), 0.0);
+		for (StorageIndex j = 0; j < nnz; ++j)
+		{
+			if (cache.slots[j] >= 0)
+				values[cache.slots[j]] += full_values[j];
+		}
+
+		return same_pattern;
 	}
 } // namespace polyfem::solver
@@ -5,6 +5,8 @@
 #include <polyfem/mesh/LocalBoundary.hpp>
 #include <polyfem/assembler/PeriodicBoundary.hpp>
 
+#include <functional>
+
 namespace polyfem::solver
 {
 	class NLProblem : public FullNLProblem
@@ -34,6 +36,8 @@ namespace polyfem::solver
 		virtual double value(const TVector &x) override;
 		virtual void gradient(const TVector &x, TVector &gradv) override;
 		virtual void hessian(const TVector &x, THessian &hessian) override;
+		virtual void hessian_vector_product(const TVector &x, const TVector &v, TVector &hv) override;
+		virtual void evaluate(const TVector &x, double *value, TVector *gradv, THessian *hessian) override;
 
 		virtual bool is_step_valid(const TVector &x0, const TVector &x1) override;
 		virtual bool is_step_collision_free(const TVector &x0, const TVector &x1) override;
@@ -60,10 +64,29 @@ namespace polyfem::solver
 		virtual TVector full_to_reduced(const TVector &full) const;
 		virtual TVector full_to_reduced_grad(const TVector &full) const;
 		virtual void full_hessian_to_reduced_hessian(const THessian &full, THessian &reduced) const;
+		/// reduces the full Hessian in place, without materializing a second matrix when possible
+		virtual void full_hessian_to_reduced_hessian_in_place(THessian &hessian) const;
 		virtual TVector reduced_to_full(const TVector &reduced) const;
 
 		void set_apply_DBC(const TVector &x, const bool val);
 
+		/// time of the current step
+		double time() const { return t_; }
+
+		/// called after every nonlinear iteration with the iteration number and the full solution
+		std::function<void(const int, const TVector &)> post_step_callback;
+
+		/// writes every reduced Hessian to path (hdf5, or binary if the extension is .bin) as hessian_<i>
+		/// @param[in] path output file, replaced by the first Hessian, empty to disable the export
+		/// @param[in] compression compression level of the hdf5 datasets (0-9)
+		void set_hessian_export(const std::string &path, const int compression);
+
+		/// lagged (Shamanskii) Newton: a Hessian is reused by the following iterations, including those of the next
+		/// time steps, until it has served max_iterations of them or an iteration stagnates
+		/// @param[in] max_iterations iterations served by the same Hessian, 1 assembles it at every iteration
+		/// @param[in] residual_ratio refreshes the Hessian when an iteration reduces the gradient norm by less than this factor
+		void set_hessian_lagging(const int max_iterations, const double residual_ratio);
+
 	protected:
 		virtual Eigen::MatrixXd boundary_values() const;
 
@@ -89,6 +112,27 @@ namespace polyfem::solver
 		double t_;
 
 	private:
+		void export_hessian(const THessian &hessian);
+
+		/// @return if the lagged Hessian can serve one more iteration
+		bool reuse_lagged_hessian() const;
+
+		/// last assembled Hessian and the gradient norms of the iterations it served
+		struct LaggedHessian
+		{
+			THessian hessian;
+			int uses = 0;
+			double grad_norm = -1;      ///< gradient norm after the last iteration, -1 at the start of a step
+			double prev_grad_norm = -1; ///< gradient norm before the last iteration
+		};
+		LaggedHessian lagged_hessian_;
+		int hessian_lag_iterations_ = 1;
+		double hessian_lag_ratio_ = 0.5;
+
+		std::string hessian_export_path_;
+		int hessian_export_compression_ = 0;
+		int n_exported_hessians_ = 0;
+
 		const assembler::RhsAssembler *rhs_assembler_;
 		const std::vector<mesh::LocalBoundary> *local_boundary_;
 		const int n_boundary_samples_;
@@ -99,6 +143,26 @@ namespace polyfem::solver
 		template <class ReducedMat, class FullMat>
 		void reduced_to_full_aux(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const ReducedMat &reduced, const Eigen::MatrixXd &rhs, FullMat &full) const;
 
+		/// @brief reduces full to reduced reusing the pattern of the previous call if full has the same sparsity
+		/// @return true if the pattern was reused
+		bool reduce_hessian_with_cached_pattern(const THessian &full, THessian &reduced) const;
+
+		/// @brief index of every full dof in the reduced problem (periodic identification then Dirichlet removal), -1 if removed
+		/// @return size of the reduced problem
+		int reduced_dof_index(const int n_full, const bool remove_boundary, std::vector<int> &index) const;
+
+		/// Sparsity of the last full Hessian and the slot of the reduced Hessian each of its values is added to.
+		/// Periodic dofs merge several full entries in one reduced slot, Dirichlet entries have no slot (-1).
+		struct ReducedHessianCache
+		{
+			std::vector<StorageIndex> full_outer;
+			std::vector<StorageIndex> full_inner;
+			std::vector<StorageIndex> slots;
+			bool remove_boundary = false;
+			THessian reduced; ///< reduced Hessian with the cached pattern
+		};
+		mutable ReducedHessianCache reduced_hessian_cache_;
+
 		template <class FullMat, class ReducedMat>
 		void full_to_reduced_aux_grad(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const FullMat &full, ReducedMat &reduced) const;
 	};
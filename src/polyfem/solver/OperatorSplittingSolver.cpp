@@ -3,6 +3,10 @@
 
 #include <polysolve/linear/FEMSolver.hpp>
 
+#include <algorithm>
+#include <array>
+#include <map>
+
 #ifdef POLYFEM_WITH_OPENVDB
 #include <openvdb/openvdb.h>
 #endif
@@ -135,6 +139,35 @@ namespace polyfem::solver
 		average_intersection_num /= hash_table.size();
 		logger().debug("average intersection number for hash grid: {}", average_intersection_num);
 		logger().debug("max intersection number for hash grid: {}", max_intersection_num);
+
+		// neighbor across the face opposite to every vertex of a simplex, -1 on the boundary
+		face_neighbors.resize(0, 0);
+		if (shape == dim + 1)
+		{
+			face_neighbors.setConstant(T.rows(), T.cols(), -1);
+			std::map<std::array<int, 3>, std::pair<int, int>> open_faces;
+			for (int e = 0; e < T.rows(); e++)
+			{
+				for (int i = 0; i < T.cols(); i++)
+				{
+					std::array<int, 3> face = {{-1, -1, -1}};
+					for (int j = 0, k = 0; j < T.cols(); j++)
+						if (j != i)
+							face[k++] = T(e, j);
+					std::sort(face.begin(), face.begin() + dim);
+
+					const auto it = open_faces.find(face);
+					if (it == open_faces.end())
+						open_faces.emplace(face, std::make_pair(e, i));
+					else
+					{
+						face_neighbors(e, i) = it->second.first;
+						face_neighbors(it->second.first, it->second.second) = e;
+						open_faces.erase(it);
+					}
+				}
+			}
+		}
 	}
 
 	void OperatorSplittingSolver::initialize_solver(const mesh::Mesh &mesh,
@@ -177,7 +210,10 @@ namespace polyfem::solver
 		logger().info("Prefactorization begins...");
 
 		solver_mass = polysolve::linear::Solver::create(params, logger());
-		// if (solver_type == "Pardiso" || solver_type == "Eigen::SimplicialLDLT" || solver_type == "Eigen::SparseLU")
+		// a lumped velocity mass turns the projection into a diagonal scaling
+		if (mass_velocity.nonZeros() == mass_velocity.rows())
+			velocity_mass_diagonal = mass_velocity.diagonal();
+		else
 		{
 			StiffnessMatrix mat1 = mass_velocity;
 			prefactorize(*solver_mass, mat1, boundary_nodes_, mat1.rows(), "");
@@ -275,11 +311,12 @@ namespace polyfem::solver
 											RowVectorNd &vel_2,
 											Eigen::MatrixXd &local_pos,
 											const Eigen::MatrixXd &sol,
-											const double dt)
+											const double dt,
+											const long hint)
 	{
 		pos_2 = pos_1 - vel_1 * dt;
 
-		return interpolator(gbases, bases, pos_2, vel_2, local_pos, sol);
+		return interpolator(gbases, bases, pos_2, vel_2, local_pos, sol, hint);
 	}
 
 	int OperatorSplittingSolver::interpolator(const std::vector<basis::ElementBases> &gbases,
@@ -287,12 +324,13 @@ namespace polyfem::solver
 											  const RowVectorNd &pos,
 											  RowVectorNd &vel,
 											  Eigen::MatrixXd &local_pos,
-											  const Eigen::MatrixXd &sol)
+											  const Eigen::MatrixXd &sol,
+											  const long hint)
 	{
 		bool insideDomain = true;
 
 		int new_elem;
-		if ((new_elem = search_cell(gbases, pos, local_pos)) == -1)
+		if ((new_elem = search_cell(gbases, pos, local_pos, hint)) == -1)
 		{
 			insideDomain = false;
 			RowVectorNd pos_ = pos;
@@ -394,7 +432,7 @@ namespace polyfem::solver
 									  pos_(d) = mapped(i, d) - vel_(d) * dt;
 
 								  Eigen::MatrixXd local_pos;
-								  interpolator(gbases, bases, pos_, vel_, local_pos, sol);
+								  interpolator(gbases, bases, pos_, vel_, local_pos, sol, e);
 
 								  new_sol.block(global * dim, 0, dim, 1) = vel_.transpose();
 							  }
@@ -503,12 +541,12 @@ namespace polyfem::solver
 									  const long idx = i + (long)j * (grid_cell_num(0) + 1);
 
 									  RowVectorNd vel1, pos_;
-									  interpolator(gbases, bases, pos, vel1, local_pos, sol);
+									  const long elem = interpolator(gbases, bases, pos, vel1, local_pos, sol);
 									  if (RK > 1)
 									  {
 										  RowVectorNd vel2, vel3;
-										  interpolator(gbases, bases, pos - 0.5 * dt * vel1, vel2, local_pos, sol);
-										  interpolator(gbases, bases, pos - 0.75 * dt * vel2, vel3, local_pos, sol);
+										  const long elem2 = interpolator(gbases, bases, pos - 0.5 * dt * vel1, vel2, local_pos, sol, elem);
+										  interpolator(gbases, bases, pos - 0.75 * dt * vel2, vel3, local_pos, sol, elem2 >= 0 ? elem2 : elem);
 										  pos_ = pos - (2 * vel1 + 3 * vel2 + 4 * vel3) * dt / 9;
 									  }
 									  else
@@ -528,12 +566,12 @@ namespace polyfem::solver
 										  const long idx = i + (j + (long)k * (grid_cell_num(1) + 1)) * (grid_cell_num(0) + 1);
 
 										  RowVectorNd vel1, pos_;
-										  interpolator(gbases, bases, pos, vel1, local_pos, sol);
+										  const long elem = interpolator(gbases, bases, pos, vel1, local_pos, sol);
 										  if (RK > 1)
 										  {
 											  RowVectorNd vel2, vel3;
-											  interpolator(gbases, bases, pos - 0.5 * dt * vel1, vel2, local_pos, sol);
-											  interpolator(gbases, bases, pos - 0.75 * dt * vel2, vel3, local_pos, sol);
+											  const long elem2 = interpolator(gbases, bases, pos - 0.5 * dt * vel1, vel2, local_pos, sol, elem);
+											  interpolator(gbases, bases, pos - 0.75 * dt * vel2, vel3, local_pos, sol, elem2 >= 0 ? elem2 : elem);
 											  pos_ = pos - (2 * vel1 + 3 * vel2 + 4 * vel3) * dt / 9;
 										  }
 										  else
@@ -727,7 +765,7 @@ namespace polyfem::solver
 							  RowVectorNd newvel;
 							  Eigen::MatrixXd local_pos;
 							  cellI_particle[pI] = trace_back(gbases, bases, position_particle[pI], velocity_particle[pI],
-															  position_particle[pI], newvel, local_pos, sol, -dt);
+															  position_particle[pI], newvel, local_pos, sol, -dt, cellI_particle[pI]);
 
 							  // RK3:
 							  // RowVectorNd bypass, vel2, vel3;
@@ -849,7 +887,7 @@ namespace polyfem::solver
 								  RowVectorNd newvel;
 								  Eigen::MatrixXd local_pos;
 								  cellI_particle[ppe * e + j] = trace_back(gbases, bases, position_particle[ppe * e + j], velocity_particle[e * ppe + j],
-																		   position_particle[ppe * e + j], newvel, local_pos, sol, -dt);
+																		   position_particle[ppe * e + j], newvel, local_pos, sol, -dt, e);
 
 								  // RK3:
 								  // RowVectorNd bypass, vel2, vel3;
@@ -1035,15 +1073,11 @@ namespace polyfem::solver
 			rhs(boundary_nodes_[i]) = 0;
 		}
 
-		if (solver_diffusion->name() == "Pardiso" || solver_diffusion->name() == "Eigen::SimplicialLDLT" || solver_diffusion->name() == "Eigen::SparseLU")
-		{
-			dirichlet_solve_prefactorized(*solver_mass, velocity_mass, rhs, boundary_nodes_, dx);
-		}
+		// the mass was factorized (or its preconditioner built) in the constructor, only the solve is left
+		if (velocity_mass_diagonal.size() == rhs.size())
+			dx = rhs.cwiseQuotient(velocity_mass_diagonal);
 		else
-		{
-			auto mat = velocity_mass;
-			dirichlet_solve(*solver_mass, mat, rhs, boundary_nodes_, dx, velocity_mass.rows(), "", false, false, false);
-		}
+			dirichlet_solve_prefactorized(*solver_mass, velocity_mass, rhs, boundary_nodes_, dx);
 
 		sol -= dx;
 	}
@@ -1056,34 +1090,40 @@ namespace polyfem::solver
 											 Eigen::MatrixXd &pressure,
 											 Eigen::MatrixXd &sol)
 	{
-		Eigen::VectorXd grad_pressure = Eigen::VectorXd::Zero(n_bases * dim);
-		Eigen::VectorXi traversed = Eigen::VectorXi::Zero(n_bases);
-
-		assembler::ElementAssemblyValues vals;
-		for (int e = 0; e < n_el; ++e)
+		// the nodal pressure gradient only depends on the mesh, assemble it once and reuse it every step
+		if (nodal_pressure_gradient.rows() != n_bases * dim || nodal_pressure_gradient.cols() != pressure.size())
 		{
-			vals.compute(e, dim == 3, local_pts, pressure_bases[e], gbases[e]);
-			for (int j = 0; j < local_pts.rows(); j++)
+			Eigen::VectorXi traversed = Eigen::VectorXi::Zero(n_bases);
+			std::vector<Eigen::Triplet<double>> coefficients;
+
+			assembler::ElementAssemblyValues vals;
+			for (int e = 0; e < n_el; ++e)
 			{
-				int global_ = bases[e].bases[j].global()[0].index;
-				for (int i = 0; i < vals.basis_values.size(); i++)
+				vals.compute(e, dim == 3, local_pts, pressure_bases[e], gbases[e]);
+				for (int j = 0; j < local_pts.rows(); j++)
 				{
-					for (int d = 0; d < dim; d++)
+					int global_ = bases[e].bases[j].global()[0].index;
+					for (int i = 0; i < vals.basis_values.size(); i++)
 					{
-						assert(pressure_bases[e].bases[i].global().size() == 1);
-						grad_pressure(global_ * dim + d) += vals.basis_values[i].grad_t_m(j, d) * pressure(pressure_bases[e].bases[i].global()[0].index);
+						for (int d = 0; d < dim; d++)
+						{
+							assert(pressure_bases[e].bases[i].global().size() == 1);
+							coefficients.emplace_back(global_ * dim + d, pressure_bases[e].bases[i].global()[0].index, vals.basis_values[i].grad_t_m(j, d));
+						}
 					}
+					traversed(global_)++;
 				}
-				traversed(global_)++;
-			}
-		}
-		for (int i = 0; i < traversed.size(); i++)
-		{
-			for (int d = 0; d < dim; d++)
-			{
-				sol(i * dim + d) -= grad_pressure(i * dim + d) / traversed(i);
 			}
+
+			// average the contributions of the elements sharing a node
+			for (auto &c : coefficients)
+				c = Eigen::Triplet<double>(c.row(), c.col(), c.value() / traversed(c.row() / dim));
+
+			nodal_pressure_gradient.resize(n_bases * dim, pressure.size());
+			nodal_pressure_gradient.setFromTriplets(coefficients.begin(), coefficients.end());
 		}
+
+		sol -= nodal_pressure_gradient * pressure;
 	}
 
 	void OperatorSplittingSolver::initialize_density(const std::shared_ptr<assembler::Problem> &problem)
@@ -1116,8 +1156,38 @@ namespace polyfem::solver
 		}
 	}
 
-	long OperatorSplittingSolver::search_cell(const std::vector<basis::ElementBases> &gbases, const RowVectorNd &pos, Eigen::MatrixXd &local_pts)
+	long OperatorSplittingSolver::search_cell(const std::vector<basis::ElementBases> &gbases, const RowVectorNd &pos, Eigen::MatrixXd &local_pts, const long hint)
 	{
+		// walk from the hint towards pos, leaving every simplex through the face with the most negative barycentric coordinate
+		if (hint >= 0 && hint < n_el)
+		{
+			const int max_walk_steps = shape == dim + 1 ? 8 : 1;
+			long e = hint;
+			for (int step = 0; step < max_walk_steps && e >= 0; step++)
+			{
+				calculate_local_pts(gbases[e], e, pos, local_pts);
+
+				if (shape == dim + 1)
+				{
+					int exit_face = 0;
+					double min_bary = 1 - local_pts.sum();
+					for (int d = 0; d < dim; d++)
+					{
+						if (local_pts(d) < min_bary)
+						{
+							min_bary = local_pts(d);
+							exit_face = d + 1;
+						}
+					}
+					if (min_bary > -1e-13)
+						return e;
+					e = face_neighbors(e, exit_face);
+				}
+				else if (local_pts.minCoeff() > -1e-13 && local_pts.maxCoeff() < 1 + 1e-13)
+					return e;
+			}
+		}
+
 		Eigen::Matrix<long, Eigen::Dynamic, 1> pos_int(dim);
 		for (int d = 0; d < dim; d++)
 		{
@@ -68,14 +68,16 @@ namespace polyfem
 						   RowVectorNd &vel_2,
 						   Eigen::MatrixXd &local_pos,
 						   const Eigen::MatrixXd &sol,
-						   const double dt);
+						   const double dt,
+						   const long hint = -1);
 
 			int interpolator(const std::vector<basis::ElementBases> &gbases,
 							 const std::vector<basis::ElementBases> &bases,
 							 const RowVectorNd &pos,
 							 RowVectorNd &vel,
 							 Eigen::MatrixXd &local_pos,
-							 const Eigen::MatrixXd &sol);
+							 const Eigen::MatrixXd &sol,
+							 const long hint = -1);
 
 			void interpolator(const RowVectorNd &pos, double &val);
 
@@ -132,7 +134,9 @@ namespace polyfem
 
 			void initialize_density(const std::shared_ptr<assembler::Problem> &problem);
 
-			long search_cell(const std::vector<basis::ElementBases> &gbases, const RowVectorNd &pos, Eigen::MatrixXd &local_pts);
+			/// finds the element containing pos, walking from the hint element (e.g., the previous cell of a particle)
+			/// before falling back to the hash grid; returns -1 if pos is outside the mesh
+			long search_cell(const std::vector<basis::ElementBases> &gbases, const RowVectorNd &pos, Eigen::MatrixXd &local_pts, const long hint = -1);
 
 			bool outside_quad(const std::vector<RowVectorNd> &vert, const RowVectorNd &pos);
 
@@ -159,6 +163,7 @@ namespace polyfem
 
 			std::vector<std::vector<long>> hash_table;
 			Eigen::Matrix<long, Eigen::Dynamic, 1, Eigen::ColMajor, 3, 1> hash_table_cell_num;
+			Eigen::MatrixXi face_neighbors; ///< simplices only: element across the face opposite to each vertex
 
 			std::vector<Eigen::Matrix<double, 1, Eigen::Dynamic, Eigen::RowMajor, 1, 3>> position_particle;
 			std::vector<Eigen::Matrix<double, 1, Eigen::Dynamic, Eigen::RowMajor, 1, 3>> velocity_particle;
@@ -175,6 +180,8 @@ namespace polyfem
 
 			StiffnessMatrix mat_diffusion;
 			StiffnessMatrix mat_projection;
+			Eigen::VectorXd velocity_mass_diagonal;  ///< set instead of factorizing the velocity mass when it is lumped
+			StiffnessMatrix nodal_pressure_gradient; ///< averaged pressure gradient at the velocity nodes, built on the first projection
 
 			Eigen::VectorXd density;
 			// Eigen::VectorXi density_cell_no;
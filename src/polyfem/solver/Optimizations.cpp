@@ -27,6 +27,8 @@
 
 #include <polysolve/nonlinear/BoxConstraintSolver.hpp>
 
+#include <filesystem>
+
 namespace spdlog::level
 {
 	NLOHMANN_JSON_SERIALIZE_ENUM(
@@ -497,10 +499,11 @@ namespace polyfem::solver
 		return x;
 	}
 
-	std::shared_ptr<State> AdjointOptUtils::create_state(const json &args, CacheLevel level, const size_t max_threads)
+	std::shared_ptr<State> AdjointOptUtils::create_state(const json &args, CacheLevel level, const size_t max_threads, const std::shared_ptr<const State> &assembly_caches_source)
 	{
 		std::shared_ptr<State> state = std::make_shared<State>();
 		state->set_max_threads(max_threads);
+		state->assembly_caches_source = assembly_caches_source;
 
 		json in_args = args;
 		in_args["solver"]["max_threads"] = max_threads;
@@ -528,21 +531,65 @@ namespace polyfem::solver
 		return state;
 	}
 
-	std::vector<std::shared_ptr<State>> AdjointOptUtils::create_states(const json &state_args, const CacheLevel &level, const size_t max_threads)
+	std::vector<std::shared_ptr<State>> AdjointOptUtils::create_states(const json &state_args, const CacheLevel &level, const size_t max_threads, const json &state_patch)
 	{
 		std::vector<std::shared_ptr<State>> states(state_args.size());
+		std::vector<json> discretizations(state_args.size());
 		int i = 0;
 		for (const json &args : state_args)
 		{
 			json cur_args;
 			if (!load_json(args["path"], cur_args))
 				log_and_throw_adjoint_error("Can't find json for State {}", i);
+			if (!state_patch.is_null())
+				cur_args.merge_patch(state_patch);
+
+			// candidate for sharing the caches, the bases are compared once built
+			discretizations[i] = {
+				{"directory", std::filesystem::path(args["path"].get<std::string>()).parent_path().string()},
+				{"geometry", cur_args.contains("geometry") ? cur_args["geometry"] : json()},
+				{"space", cur_args.contains("space") ? cur_args["space"] : json()}};
+			std::shared_ptr<const State> source;
+			for (int j = 0; j < i && !source; ++j)
+			{
+				if (discretizations[j] == discretizations[i])
+					source = states[j];
+			}
 
-			states[i++] = AdjointOptUtils::create_state(cur_args, level, max_threads);
+			states[i] = AdjointOptUtils::create_state(cur_args, level, max_threads, source);
+			++i;
 		}
 		return states;
 	}
 
+	std::unique_ptr<AdjointNLProblem> AdjointOptUtils::create_problem(const json &args, const CacheLevel &level, const size_t max_threads, const json &state_patch)
+	{
+		std::vector<std::shared_ptr<State>> states = create_states(args["states"], level, max_threads, state_patch);
+
+		int ndof = 0;
+		std::vector<int> variable_sizes;
+		for (const auto &arg : args["parameters"])
+		{
+			const int size = compute_variable_size(arg, states);
+			ndof += size;
+			variable_sizes.push_back(size);
+		}
+
+		VariableToSimulationGroup var2sim;
+		var2sim.init(args["variable_to_simulation"], states, variable_sizes);
+
+		std::shared_ptr<AdjointForm> obj = create_form(args["functionals"], var2sim, states);
+		std::vector<std::shared_ptr<AdjointForm>> stopping_conditions;
+		for (const auto &arg : args["stopping_conditions"])
+			stopping_conditions.push_back(create_form(arg, var2sim, states));
+
+		// initializes the parametrizations
+		const Eigen::VectorXd x = inverse_evaluation(args["parameters"], ndof, variable_sizes, var2sim);
+		var2sim.update(x);
+
+		return std::make_unique<AdjointNLProblem>(obj, stopping_conditions, var2sim, states, args);
+	}
+
 	void AdjointOptUtils::solve_pde(State &state)
 	{
 		state.assemble_rhs();
@@ -28,9 +28,12 @@ namespace polyfem::solver
 
 		static std::shared_ptr<polysolve::nonlinear::Solver> make_nl_solver(const json &solver_params, const json &linear_solver_params, const double characteristic_length);
 
-		static std::shared_ptr<State> create_state(const json &args, CacheLevel level, const size_t max_threads);
+		/// @param assembly_caches_source State whose assembly values caches are reused if it has the same discretization
+		static std::shared_ptr<State> create_state(const json &args, CacheLevel level, const size_t max_threads, const std::shared_ptr<const State> &assembly_caches_source = nullptr);
 
-		static std::vector<std::shared_ptr<State>> create_states(const json &state_args, const CacheLevel &level, const size_t max_threads);
+		/// States with the same mesh and discretization share their assembly values caches until their shapes diverge
+		/// @param state_patch merged into the arguments of every state (e.g., a lower discretization order)
+		static std::vector<std::shared_ptr<State>> create_states(const json &state_args, const CacheLevel &level, const size_t max_threads, const json &state_patch = json());
 
 		static Eigen::VectorXd inverse_evaluation(const json &args, const int ndof, const std::vector<int> &variable_sizes, VariableToSimulationGroup &var2sim);
 
@@ -43,5 +46,12 @@ namespace polyfem::solver
 		static std::unique_ptr<VariableToSimulation> create_variable_to_simulation(const json &args, const std::vector<std::shared_ptr<State>> &states, const std::vector<int> &variable_sizes);
 
 		static int compute_variable_size(const json &args, const std::vector<std::shared_ptr<State>> &states);
+
+		/// @brief creates the states, variables and functionals of an optimization, initialized at the initial parameters
+		/// @param args optimization arguments, with the defaults of the spec
+		/// @param level derivative cache level of the states
+		/// @param max_threads maximum number of threads of every state
+		/// @param state_patch merged into the arguments of every state
+		static std::unique_ptr<AdjointNLProblem> create_problem(const json &args, const CacheLevel &level, const size_t max_threads, const json &state_patch = json());
 	};
 } // namespace polyfem::solver
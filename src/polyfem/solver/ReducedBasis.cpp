@@ -0,0 +1,125 @@
+#include "ReducedBasis.hpp"
+
+#include <polyfem/solver/NLProblem.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <Eigen/SVD>
+
+#include <cmath>
+
+namespace polyfem::solver
+{
+	ReducedBasis::ReducedBasis(const int max_snapshots, const double energy_tol)
+		: max_snapshots_(max_snapshots), energy_tol_(energy_tol)
+	{
+		assert(max_snapshots_ > 0);
+	}
+
+	void ReducedBasis::add_snapshot(const Eigen::VectorXd &x)
+	{
+		if (!snapshots_.empty() && snapshots_.front().size() != x.size())
+			snapshots_.clear();
+
+		snapshots_.push_back(x);
+		while (snapshots_.size() > max_snapshots_)
+			snapshots_.pop_front();
+
+		update_basis();
+	}
+
+	void ReducedBasis::clear()
+	{
+		snapshots_.clear();
+		basis_.resize(0, 0);
+	}
+
+	void ReducedBasis::update_basis()
+	{
+		if (snapshots_.empty())
+		{
+			basis_.resize(0, 0);
+			return;
+		}
+
+		Eigen::MatrixXd S(snapshots_.front().size(), snapshots_.size());
+		for (int i = 0; i < snapshots_.size(); ++i)
+			S.col(i) = snapshots_[i];
+
+		const Eigen::BDCSVD<Eigen::MatrixXd> svd(S, Eigen::ComputeThinU);
+		const Eigen::VectorXd energy = svd.singularValues().array().square();
+		const double total = energy.sum();
+
+		int n_modes = 0;
+		if (total > 0)
+		{
+			// singular values are sorted in decreasing order
+			double kept = 0;
+			while (n_modes < energy.size() && kept < (1 - energy_tol_) * total && energy(n_modes) > 1e-14 * energy(0))
+				kept += energy(n_modes++);
+		}
+
+		basis_ = svd.matrixU().leftCols(n_modes);
+		logger().debug("Reduced basis with {} modes from {} snapshots", n_modes, snapshots_.size());
+	}
+
+	bool galerkin_solve(NLProblem &problem, const Eigen::MatrixXd &basis, Eigen::VectorXd &x, const int max_iterations, const double grad_tol)
+	{
+		assert(basis.rows() == x.size());
+		if (basis.cols() == 0)
+			return false;
+
+		x = basis * (basis.transpose() * x);
+
+		problem.solution_changed(x);
+		double energy = problem.value(x);
+		if (!std::isfinite(energy))
+			return false;
+
+		Eigen::VectorXd grad;
+		StiffnessMatrix hessian;
+		for (int iter = 0; iter < max_iterations; ++iter)
+		{
+			problem.gradient(x, grad);
+			const Eigen::VectorXd reduced_grad = basis.transpose() * grad;
+			logger().trace("Galerkin iteration {}: energy {}, projected gradient {}", iter, energy, reduced_grad.norm());
+			if (reduced_grad.norm() <= grad_tol)
+				return true;
+
+			problem.hessian(x, hessian);
+			const Eigen::MatrixXd reduced_hessian = basis.transpose() * (hessian * basis);
+			const Eigen::LDLT<Eigen::MatrixXd> ldlt(reduced_hessian);
+			Eigen::VectorXd dq = -ldlt.solve(reduced_grad);
+			if (ldlt.info() != Eigen::Success || !ldlt.isPositive() || !(dq.dot(reduced_grad) < 0))
+				dq = -reduced_grad; // gradient descent if the projected Hessian is not positive definite
+
+			// backtracking on the energy
+			const Eigen::VectorXd dx = basis * dq;
+			const double decrease = 1e-4 * reduced_grad.dot(dq);
+			bool accepted = false;
+			for (double step = 1; step > 1e-10 && !accepted; step /= 2)
+			{
+				const Eigen::VectorXd x1 = x + step * dx;
+				if (!problem.is_step_valid(x, x1))
+					continue;
+
+				problem.solution_changed(x1);
+				const double energy1 = problem.value(x1);
+				if (std::isfinite(energy1) && energy1 <= energy + step * decrease)
+				{
+					x = x1;
+					energy = energy1;
+					accepted = true;
+				}
+			}
+
+			if (!accepted)
+			{
+				problem.solution_changed(x);
+				return false;
+			}
+		}
+
+		problem.gradient(x, grad);
+		return (basis.transpose() * grad).norm() <= grad_tol;
+	}
+} // namespace polyfem::solver
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <deque>
+
+namespace polyfem::solver
+{
+	class NLProblem;
+
+	/// POD basis of the most recent solutions of a forward problem, used as a reduced-order surrogate of the full solve
+	class ReducedBasis
+	{
+	public:
+		/// @param max_snapshots number of most recent snapshots kept
+		/// @param energy_tol fraction of the energy of the snapshots dropped by the truncation of the POD
+		ReducedBasis(const int max_snapshots = 10, const double energy_tol = 1e-8);
+
+		/// @brief adds a snapshot and recomputes the basis, the snapshots of a different size are removed
+		/// @param[in] x snapshot
+		void add_snapshot(const Eigen::VectorXd &x);
+
+		void clear();
+
+		/// orthonormal modes, one per column
+		const Eigen::MatrixXd &basis() const { return basis_; }
+		int size() const { return basis_.cols(); }
+		int n_snapshots() const { return snapshots_.size(); }
+		/// most recent snapshot
+		const Eigen::VectorXd &latest() const { return snapshots_.back(); }
+
+	private:
+		/// thin SVD of the snapshots, truncated to the modes keeping 1 - energy_tol of their energy
+		void update_basis();
+
+		int max_snapshots_;
+		double energy_tol_;
+
+		std::deque<Eigen::VectorXd> snapshots_;
+		Eigen::MatrixXd basis_;
+	};
+
+	/// @brief minimizes a nonlinear problem restricted to the span of a basis with Newton's method (Galerkin projection)
+	/// @param problem nonlinear problem, x is in its current (reduced) size
+	/// @param[in] basis orthonormal modes in the size of x
+	/// @param[in,out] x initial guess, projected on the basis, and solution
+	/// @param[in] max_iterations maximum number of Newton iterations
+	/// @param[in] grad_tol tolerance on the norm of the projected gradient
+	/// @return whether Newton converged
+	bool galerkin_solve(NLProblem &problem, const Eigen::MatrixXd &basis, Eigen::VectorXd &x, const int max_iterations, const double grad_tol);
+} // namespace polyfem::solver
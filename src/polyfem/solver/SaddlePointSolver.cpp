@@ -0,0 +1,173 @@
+#include "SaddlePointSolver.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <cmath>
+
+namespace polyfem::solver
+{
+	SaddlePointSolver::SaddlePointSolver(const json &linear_solver_params, const int max_iterations, const double tolerance)
+		: max_iterations_(max_iterations), tolerance_(tolerance)
+	{
+		velocity_solver_ = polysolve::linear::Solver::create(linear_solver_params, logger());
+	}
+
+	void SaddlePointSolver::dirichlet_solve(const StiffnessMatrix &A, const Eigen::VectorXd &b,
+											const std::vector<int> &boundary_nodes,
+											const int n_velocity, const bool skip_last_col,
+											Eigen::VectorXd &x, const bool refactorize)
+	{
+		assert(A.rows() == A.cols() && A.rows() == b.size());
+		assert(n_velocity > 0 && n_velocity < A.rows());
+
+		const int n = A.rows();
+		std::vector<bool> is_boundary(n, false);
+		for (const int i : boundary_nodes)
+			is_boundary[i] = true;
+
+		std::vector<bool> zero_col(n, true);
+		std::vector<Eigen::Triplet<double>> entries;
+		entries.reserve(A.nonZeros() + n);
+		for (int k = 0; k < A.outerSize(); ++k)
+		{
+			for (StiffnessMatrix::InnerIterator it(A, k); it; ++it)
+			{
+				if (std::abs(it.value()) > 1e-12)
+					zero_col[it.col()] = false;
+				if (!is_boundary[it.row()])
+					entries.emplace_back(it.row(), it.col(), it.value());
+			}
+		}
+		if (skip_last_col)
+			zero_col[n - 1] = false;
+		for (int i = 0; i < n; ++i)
+		{
+			if (is_boundary[i] || zero_col[i])
+				entries.emplace_back(i, i, 1);
+		}
+
+		StiffnessMatrix mat(n, n);
+		mat.setFromTriplets(entries.begin(), entries.end());
+		mat.makeCompressed();
+
+		// a stale preconditioner only slows down the Krylov iterations, the system solved is always mat
+		if (refactorize || !factorized_ || n_velocity != n_velocity_ || schur_solver_.rows() != n - n_velocity)
+			factorize(mat, n_velocity);
+
+		if (x.size() != n)
+			x.setZero(n);
+
+		const double b_norm = b.norm();
+		if (b_norm == 0)
+		{
+			x.setZero();
+			return;
+		}
+
+		// right preconditioned FGMRES, the preconditioner varies if the velocity solver is iterative
+		Eigen::MatrixXd V(n, restart_ + 1), Z(n, restart_);
+		Eigen::MatrixXd H = Eigen::MatrixXd::Zero(restart_ + 1, restart_);
+		Eigen::VectorXd cs(restart_), sn(restart_), g(restart_ + 1);
+		Eigen::VectorXd z;
+
+		Eigen::VectorXd r = b - mat * x;
+		double residual = r.norm();
+		int iter = 0;
+		while (residual > tolerance_ * b_norm && iter < max_iterations_)
+		{
+			V.col(0) = r / residual;
+			g.setZero();
+			g(0) = residual;
+			H.setZero();
+
+			int k = 0;
+			for (; k < restart_ && iter < max_iterations_; ++k, ++iter)
+			{
+				apply_preconditioner(V.col(k), z);
+				Z.col(k) = z;
+				Eigen::VectorXd w = mat * z;
+				for (int i = 0; i <= k; ++i)
+				{
+					H(i, k) = V.col(i).dot(w);
+					w -= H(i, k) * V.col(i);
+				}
+				H(k + 1, k) = w.norm();
+				if (H(k + 1, k) > 0)
+					V.col(k + 1) = w / H(k + 1, k);
+
+				for (int i = 0; i < k; ++i)
+				{
+					const double tmp = cs(i) * H(i, k) + sn(i) * H(i + 1, k);
+					H(i + 1, k) = -sn(i) * H(i, k) + cs(i) * H(i + 1, k);
+					H(i, k) = tmp;
+				}
+				const double denom = std::hypot(H(k, k), H(k + 1, k));
+				cs(k) = denom > 0 ? H(k, k) / denom : 1;
+				sn(k) = denom > 0 ? H(k + 1, k) / denom : 0;
+				H(k, k) = denom;
+				H(k + 1, k) = 0;
+				g(k + 1) = -sn(k) * g(k);
+				g(k) = cs(k) * g(k);
+
+				residual = std::abs(g(k + 1));
+				if (residual <= tolerance_ * b_norm)
+				{
+					++k;
+					++iter;
+					break;
+				}
+			}
+
+			const Eigen::VectorXd y = H.topLeftCorner(k, k).triangularView<Eigen::Upper>().solve(g.head(k));
+			x += Z.leftCols(k) * y;
+
+			r = b - mat * x;
+			residual = r.norm();
+		}
+
+		if (residual > tolerance_ * b_norm)
+			logger().warn("Saddle point solver did not converge after {} iterations, relative residual {}", iter, residual / b_norm);
+		else
+			logger().debug("\tsaddle point solver converged in {} iterations", iter);
+	}
+
+	void SaddlePointSolver::factorize(const StiffnessMatrix &A, const int n_velocity)
+	{
+		n_velocity_ = n_velocity;
+		const int n_pressure = A.rows() - n_velocity;
+
+		const StiffnessMatrix F = A.topLeftCorner(n_velocity, n_velocity);
+		velocity_pressure_ = A.topRightCorner(n_velocity, n_pressure);
+		const StiffnessMatrix pressure_velocity = A.bottomLeftCorner(n_pressure, n_velocity);
+		const StiffnessMatrix C = A.bottomRightCorner(n_pressure, n_pressure);
+
+		velocity_solver_->analyze_pattern(F, F.rows());
+		velocity_solver_->factorize(F);
+
+		Eigen::VectorXd inv_diag = F.diagonal();
+		for (int i = 0; i < inv_diag.size(); ++i)
+			inv_diag(i) = inv_diag(i) != 0 ? 1 / inv_diag(i) : 1;
+
+		const StiffnessMatrix S = C - pressure_velocity * inv_diag.asDiagonal() * velocity_pressure_;
+		schur_solver_.compute(S);
+		if (schur_solver_.info() != Eigen::Success)
+			log_and_throw_error("Unable to factorize the Schur complement of the saddle point system");
+		factorized_ = true;
+	}
+
+	void SaddlePointSolver::apply_preconditioner(const Eigen::VectorXd &r, Eigen::VectorXd &z) const
+	{
+		// block upper triangular [F B^T; 0 S]^-1
+		z.resize(r.size());
+		const int n_pressure = r.size() - n_velocity_;
+
+		const Eigen::VectorXd zp = schur_solver_.solve(r.tail(n_pressure));
+		const Eigen::VectorXd rv = r.head(n_velocity_) - velocity_pressure_ * zp;
+
+		Eigen::VectorXd zv = Eigen::VectorXd::Zero(n_velocity_);
+		velocity_solver_->solve(rv, zv);
+
+		z.head(n_velocity_) = zv;
+		z.tail(n_pressure) = zp;
+	}
+} // namespace polyfem::solver
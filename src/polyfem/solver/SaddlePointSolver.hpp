@@ -0,0 +1,55 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <polysolve/linear/Solver.hpp>
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseLU>
+
+#include <memory>
+#include <vector>
+
+namespace polyfem::solver
+{
+	/// Block preconditioned FGMRES for the velocity-pressure systems of the (Navier-)Stokes solvers.
+	/// The velocity and pressure blocks are kept separate: the velocity block is solved with the
+	/// configured linear solver (e.g., AMG) and the Schur complement is approximated SIMPLE-style,
+	/// S = C - B diag(F)^-1 B^T, and factorized directly since it only has pressure dofs.
+	class SaddlePointSolver
+	{
+	public:
+		/// @param[in] linear_solver_params parameters of the velocity block solver
+		/// @param[in] max_iterations maximum number of FGMRES iterations
+		/// @param[in] tolerance relative residual tolerance
+		SaddlePointSolver(const json &linear_solver_params, const int max_iterations = 1000, const double tolerance = 1e-8);
+
+		/// solves A x = b, replacing the rows of the Dirichlet nodes by the identity and adding a unit
+		/// diagonal to the empty columns, like dirichlet_solve with remove_zero_cols
+		/// @param[in] A merged velocity-pressure matrix, velocity dofs first
+		/// @param[in] b right-hand side
+		/// @param[in] boundary_nodes Dirichlet dofs
+		/// @param[in] n_velocity number of velocity dofs
+		/// @param[in] skip_last_col do not check the last column for emptiness (average pressure multiplier)
+		/// @param[in,out] x solution, used as initial guess if it has the right size
+		/// @param[in] refactorize if false, keep the preconditioner of the previous call (when the sizes match)
+		void dirichlet_solve(const StiffnessMatrix &A, const Eigen::VectorXd &b,
+							 const std::vector<int> &boundary_nodes,
+							 const int n_velocity, const bool skip_last_col,
+							 Eigen::VectorXd &x, const bool refactorize = true);
+
+	private:
+		void factorize(const StiffnessMatrix &A, const int n_velocity);
+		void apply_preconditioner(const Eigen::VectorXd &r, Eigen::VectorXd &z) const;
+
+		std::unique_ptr<polysolve::linear::Solver> velocity_solver_;
+		Eigen::SparseLU<StiffnessMatrix> schur_solver_;
+		StiffnessMatrix velocity_pressure_; ///< B^T block
+		int n_velocity_ = 0;
+		bool factorized_ = false;
+
+		const int max_iterations_;
+		const double tolerance_;
+		static constexpr int restart_ = 50;
+	};
+} // namespace polyfem::solver
@@ -0,0 +1,194 @@
+#include "ShiftInvertLanczos.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <numeric>
+
+namespace polyfem::solver
+{
+	namespace
+	{
+		/// attempts to replace a column in the span of the basis before giving up
+		constexpr int MAX_REPLACEMENTS = 3;
+	} // namespace
+
+	ShiftInvertLanczos::ShiftInvertLanczos(const StiffnessMatrix &mass, const std::vector<int> &fixed, const double shift, const ShiftedSolve &shifted_solve)
+		: mass_(mass), shift_(shift), shifted_solve_(shifted_solve), is_fixed_(mass.rows(), false)
+	{
+		assert(mass.rows() == mass.cols());
+		for (const int i : fixed)
+			is_fixed_[i] = true;
+	}
+
+	void ShiftInvertLanczos::mask(Eigen::MatrixXd &x) const
+	{
+		for (int i = 0; i < x.rows(); ++i)
+		{
+			if (is_fixed_[i])
+				x.row(i).setZero();
+		}
+	}
+
+	void ShiftInvertLanczos::orthonormalize(const int k, Eigen::MatrixXd &block) const
+	{
+		for (int j = 0; j < block.cols(); ++j)
+		{
+			Eigen::VectorXd v = block.col(j);
+			for (int attempt = 0; attempt <= MAX_REPLACEMENTS; ++attempt)
+			{
+				Eigen::VectorXd Mv = mass_ * v;
+				const double initial_norm = std::sqrt(std::max(0.0, v.dot(Mv)));
+
+				// classical Gram-Schmidt twice is as stable as the modified one and uses dense products
+				for (int pass = 0; pass < 2; ++pass)
+				{
+					v -= Q_.leftCols(k) * (Q_.leftCols(k).transpose() * Mv) + block.leftCols(j) * (block.leftCols(j).transpose() * Mv);
+					Mv = mass_ * v;
+				}
+
+				const double norm = std::sqrt(std::max(0.0, v.dot(Mv)));
+				if (norm > 1e-10 * initial_norm && norm > 0)
+				{
+					v /= norm;
+					break;
+				}
+
+				logger().trace("Lanczos vector {} is in the span of the basis, replaced by a random one", j);
+				Eigen::MatrixXd random = Eigen::VectorXd::Random(v.size());
+				mask(random);
+				v = random;
+			}
+			block.col(j) = v;
+		}
+	}
+
+	int ShiftInvertLanczos::compute(
+		const int n_modes,
+		const int block_size,
+		const double tol,
+		const int max_restarts,
+		Eigen::VectorXd &eigenvalues,
+		Eigen::MatrixXd &eigenvectors)
+	{
+		const int n = mass_.rows();
+		const int n_free = std::count(is_fixed_.begin(), is_fixed_.end(), false);
+		const int n_wanted = std::min(n_modes, n_free);
+		const int p = std::clamp(block_size, 1, std::max(1, n_free));
+		// room for the kept Ritz vectors and at least two new blocks
+		const int m = std::min(n_free, std::max(2 * n_wanted, n_wanted + 2 * p));
+
+		n_solves_ = 0;
+		eigenvalues.resize(0);
+		eigenvectors.resize(n, 0);
+		if (n_wanted <= 0)
+			return 0;
+
+		Q_.resize(n, m);
+		MQ_.resize(n, m);
+		W_.resize(n, m);
+
+		Eigen::MatrixXd block = Eigen::MatrixXd::Random(n, p);
+		mask(block);
+		orthonormalize(0, block);
+
+		int k = 0;
+		int n_converged = 0;
+		for (int restart = 0; restart <= max_restarts; ++restart)
+		{
+			// --------------------------------------------------------------------
+			// extends the basis by blocks, every block is one block solve
+
+			while (k < m)
+			{
+				if (block.cols() > m - k)
+					block.conservativeResize(Eigen::NoChange, m - k);
+
+				const int b = block.cols();
+				Q_.middleCols(k, b) = block;
+				MQ_.middleCols(k, b) = mass_ * block;
+
+				Eigen::MatrixXd rhs = MQ_.middleCols(k, b);
+				mask(rhs);
+				Eigen::MatrixXd x;
+				shifted_solve_(rhs, x);
+				mask(x);
+				W_.middleCols(k, b) = x;
+				n_solves_ += b;
+
+				k += b;
+				if (k < m)
+				{
+					block = x;
+					orthonormalize(k, block);
+				}
+			}
+
+			// --------------------------------------------------------------------
+			// Rayleigh-Ritz, the wanted pairs are the largest of the shift-invert operator
+
+			Eigen::MatrixXd T = MQ_.leftCols(k).transpose() * W_.leftCols(k);
+			T = (T + T.transpose()) / 2;
+			const Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(T);
+
+			std::vector<int> order(k);
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&](const int a, const int b) {
+				return std::abs(eig.eigenvalues()(a)) > std::abs(eig.eigenvalues()(b));
+			});
+
+			Eigen::VectorXd theta(n_wanted);
+			Eigen::MatrixXd S(k, n_wanted);
+			for (int i = 0; i < n_wanted; ++i)
+			{
+				theta(i) = eig.eigenvalues()(order[i]);
+				S.col(i) = eig.eigenvectors().col(order[i]);
+			}
+
+			const Eigen::MatrixXd ritz = Q_.leftCols(k) * S;
+			const Eigen::MatrixXd op_ritz = W_.leftCols(k) * S;
+			Eigen::MatrixXd residuals = op_ritz - ritz * theta.asDiagonal();
+			const Eigen::VectorXd residual_norms = (residuals.transpose() * (mass_ * residuals)).diagonal().cwiseMax(0).cwiseSqrt();
+
+			n_converged = 0;
+			while (n_converged < n_wanted && residual_norms(n_converged) <= tol * std::abs(theta(n_converged)))
+				++n_converged;
+
+			logger().debug("Lanczos restart {}: {}/{} converged eigenpairs, {} solves", restart, n_converged, n_wanted, n_solves_);
+
+			eigenvalues = (1.0 / theta.array()) + shift_;
+			eigenvectors = ritz;
+
+			if (n_converged == n_wanted || restart == max_restarts || k == n_free)
+				break;
+
+			// --------------------------------------------------------------------
+			// thick restart: the Ritz vectors are kept, the next block are the residuals of the unconverged ones
+
+			const Eigen::MatrixXd MQS = MQ_.leftCols(k) * S;
+			Q_.leftCols(n_wanted) = ritz;
+			MQ_.leftCols(n_wanted) = MQS;
+			W_.leftCols(n_wanted) = op_ritz;
+			k = n_wanted;
+
+			block.resize(n, p);
+			for (int j = 0; j < p; ++j)
+			{
+				const int i = n_converged + j;
+				if (i < n_wanted)
+					block.col(j) = residuals.col(i);
+				else
+					block.col(j).setRandom();
+			}
+			mask(block);
+			orthonormalize(k, block);
+		}
+
+		if (n_converged < n_wanted)
+			logger().warn("Only {}/{} eigenpairs converged in {} restarts", n_converged, n_wanted, max_restarts);
+
+		return n_converged;
+	}
+} // namespace polyfem::solver
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <polyfem/utils/Types.hpp>
+
+#include <Eigen/Dense>
+
+#include <functional>
+#include <vector>
+
+namespace polyfem::solver
+{
+	/// Eigenpairs K x = lambda M x closest to a shift sigma, by block Lanczos on the shift-invert operator
+	/// (K - sigma M)^-1 M, which is self-adjoint in the M inner product and maps the wanted eigenvalues to
+	/// its largest ones, 1 / (lambda - sigma). The shifted system is factorized once by the caller, every
+	/// iteration is a block of back-substitutions. The basis is fully reorthogonalized and thick restarted
+	/// with the wanted Ritz vectors.
+	class ShiftInvertLanczos
+	{
+	public:
+		/// @brief solves (K - sigma M) x = b for a block of right-hand sides, which vanish on the fixed dofs
+		/// @param[in] b right-hand sides, one per column
+		/// @param[out] x solutions, one per column, vanishing on the fixed dofs
+		typedef std::function<void(const Eigen::MatrixXd &b, Eigen::MatrixXd &x)> ShiftedSolve;
+
+		/// @param[in] mass mass matrix M, symmetric positive definite on the free dofs
+		/// @param[in] fixed constrained dofs, the modes vanish on them
+		/// @param[in] shift shift sigma
+		/// @param[in] shifted_solve applies (K - sigma M)^-1 with the factorization of the caller
+		ShiftInvertLanczos(const StiffnessMatrix &mass, const std::vector<int> &fixed, const double shift, const ShiftedSolve &shifted_solve);
+
+		/// @brief computes the eigenpairs closest to the shift
+		/// @param[in] n_modes number of wanted eigenpairs
+		/// @param[in] block_size number of vectors of a Lanczos block, solved together
+		/// @param[in] tol tolerance on the M-norm of the residual of the Ritz pairs of the shift-invert operator, relative to their value
+		/// @param[in] max_restarts maximum number of thick restarts
+		/// @param[out] eigenvalues eigenvalues lambda, sorted by increasing distance to the shift
+		/// @param[out] eigenvectors M-orthonormal eigenvectors, one per column
+		/// @return number of converged eigenpairs, the first ones
+		int compute(
+			const int n_modes,
+			const int block_size,
+			const double tol,
+			const int max_restarts,
+			Eigen::VectorXd &eigenvalues,
+			Eigen::MatrixXd &eigenvectors);
+
+		/// number of applications of the shift-invert operator of the last computation, one per column
+		int n_solves() const { return n_solves_; }
+
+	private:
+		/// @brief M-orthonormalizes the columns of block against the first k columns of the basis and between them,
+		/// the columns (numerically) in the span are replaced by random vectors
+		void orthonormalize(const int k, Eigen::MatrixXd &block) const;
+
+		/// sets the fixed rows to zero
+		void mask(Eigen::MatrixXd &x) const;
+
+		const StiffnessMatrix &mass_;
+		const double shift_;
+		const ShiftedSolve shifted_solve_;
+		std::vector<bool> is_fixed_;
+
+		/// Lanczos basis Q, its product with the mass M Q and with the operator W = (K - sigma M)^-1 M Q
+		Eigen::MatrixXd Q_, MQ_, W_;
+
+		int n_solves_ = 0;
+	};
+} // namespace polyfem::solver
@@ -9,9 +9,11 @@
 #include <polyfem/solver/forms/BodyForm.hpp>
 #include <polyfem/solver/forms/PressureForm.hpp>
 #include <polyfem/solver/forms/PeriodicContactForm.hpp>
+#include <polyfem/solver/forms/ImplicitObstacleForm.hpp>
 #include <polyfem/solver/forms/MacroStrainALForm.hpp>
 #include <polyfem/solver/forms/ElasticForm.hpp>
 #include <polyfem/solver/forms/FrictionForm.hpp>
+#include <polyfem/solver/forms/HourglassForm.hpp>
 #include <polyfem/solver/forms/InertiaForm.hpp>
 #include <polyfem/solver/forms/LaggedRegForm.hpp>
 #include <polyfem/solver/forms/RayleighDampingForm.hpp>
@@ -97,7 +99,13 @@ namespace polyfem::solver
 		const int friction_iterations,
 
 		// Rayleigh damping form
-		const json &rayleigh_damping)
+		const json &rayleigh_damping,
+
+		// Implicit obstacles
+		const std::vector<std::shared_ptr<const mesh::ImplicitObstacle>> &implicit_obstacles,
+
+		// Hourglass form
+		const StiffnessMatrix &hourglass_stiffness)
 	{
 		const bool is_time_dependent = time_integrator != nullptr;
 		assert(!is_time_dependent || time_integrator != nullptr);
@@ -114,6 +122,14 @@ namespace polyfem::solver
 			t, dt, is_volume);
 		forms.push_back(elastic_form);
 
+		hourglass_form = nullptr;
+		if (hourglass_stiffness.size() > 0)
+		{
+			assert(hourglass_stiffness.rows() == ndof);
+			hourglass_form = std::make_shared<HourglassForm>(hourglass_stiffness);
+			forms.push_back(hourglass_form);
+		}
+
 		if (rhs_assembler != nullptr)
 		{
 			body_form = std::make_shared<BodyForm>(
@@ -193,6 +209,7 @@ namespace polyfem::solver
 
 		contact_form = nullptr;
 		periodic_contact_form = nullptr;
+		implicit_obstacle_form = nullptr;
 		friction_form = nullptr;
 		if (contact_enabled)
 		{
@@ -241,6 +258,13 @@ namespace polyfem::solver
 				if (contact_form)
 					forms.push_back(contact_form);
 
+				if (!implicit_obstacles.empty())
+				{
+					implicit_obstacle_form = std::make_shared<ImplicitObstacleForm>(
+						collision_mesh, obstacle_ndof / dim, implicit_obstacles, *contact_form);
+					forms.push_back(implicit_obstacle_form);
+				}
+
 				// ----------------------------------------------------------------
 			}
 
@@ -285,18 +309,22 @@ namespace polyfem::solver
 		if (contact_form == nullptr || !contact_form->use_adaptive_barrier_stiffness())
 			return;
 
-		Eigen::VectorXd grad_energy = Eigen::VectorXd::Zero(x.size());
-		const std::array<std::shared_ptr<Form>, 4> energy_forms{
-			{elastic_form, inertia_form, body_form, pressure_form}};
-		for (const std::shared_ptr<Form> &form : energy_forms)
-		{
-			if (form == nullptr || !form->enabled())
-				continue;
+		// only assembled if the contact form initializes the stiffness from it
+		const auto grad_energy = [&]() {
+			Eigen::VectorXd grad = Eigen::VectorXd::Zero(x.size());
+			const std::array<std::shared_ptr<Form>, 4> energy_forms{
+				{elastic_form, inertia_form, body_form, pressure_form}};
+			for (const std::shared_ptr<Form> &form : energy_forms)
+			{
+				if (form == nullptr || !form->enabled())
+					continue;
 
-			Eigen::VectorXd grad_form;
-			form->first_derivative(x, grad_form);
-			grad_energy += grad_form;
-		}
+				Eigen::VectorXd grad_form;
+				form->first_derivative(x, grad_form);
+				grad += grad_form;
+			}
+			return grad;
+		};
 
 		contact_form->update_barrier_stiffness(x, grad_energy);
 	}
@@ -306,14 +334,20 @@ namespace polyfem::solver
 		if (time_integrator == nullptr) // if is not time dependent
 			return;
 
-		const std::array<std::shared_ptr<Form>, 6> energy_forms{
-			{elastic_form, body_form, pressure_form, damping_form, contact_form, friction_form}};
+		const std::array<std::shared_ptr<Form>, 7> energy_forms{
+			{elastic_form, body_form, pressure_form, damping_form, contact_form, implicit_obstacle_form, friction_form}};
 		for (const std::shared_ptr<Form> &form : energy_forms)
 		{
 			if (form == nullptr)
 				continue;
 			form->set_weight(time_integrator->acceleration_scaling());
 		}
+
+		for (const std::shared_ptr<ElasticForm> &form : {elastic_form, damping_form})
+		{
+			if (form != nullptr)
+				form->set_dt(time_integrator->dt());
+		}
 	}
 
 	std::vector<std::pair<std::string, std::shared_ptr<solver::Form>>> SolveData::named_forms() const
@@ -331,6 +365,8 @@ namespace polyfem::solver
 			{"strain_augmented_lagrangian_lagr", strain_al_lagr_form},
 			{"strain_augmented_lagrangian_penalty", strain_al_pen_form},
 			{"periodic_contact", periodic_contact_form},
+			{"implicit_obstacle", implicit_obstacle_form},
+			{"hourglass", hourglass_form},
 		};
 	}
 } // namespace polyfem::solver
@@ -20,6 +20,7 @@
 namespace polyfem::time_integrator
 {
 	class ImplicitTimeIntegrator;
+	class ExplicitTimeIntegrator;
 } // namespace polyfem::time_integrator
 
 namespace polyfem::assembler
@@ -35,8 +36,10 @@ namespace polyfem::solver
 	class Form;
 	class ContactForm;
 	class PeriodicContactForm;
+	class ImplicitObstacleForm;
 	class MacroStrainALForm;
 	class FrictionForm;
+	class HourglassForm;
 	class BodyForm;
 	class BCLagrangianForm;
 	class BCPenaltyForm;
@@ -123,7 +126,13 @@ namespace polyfem::solver
 			const int friction_iterations,
 
 			// Rayleigh damping form
-			const json &rayleigh_damping);
+			const json &rayleigh_damping,
+
+			// Implicit obstacles
+			const std::vector<std::shared_ptr<const mesh::ImplicitObstacle>> &implicit_obstacles = {},
+
+			// Hourglass form
+			const StiffnessMatrix &hourglass_stiffness = StiffnessMatrix());
 
 		/// @brief update the barrier stiffness for the forms
 		/// @param x current solution
@@ -148,11 +157,18 @@ namespace polyfem::solver
 		std::shared_ptr<solver::ElasticForm> damping_form;
 		std::shared_ptr<solver::ElasticForm> elastic_form;
 		std::shared_ptr<solver::FrictionForm> friction_form;
+		std::shared_ptr<solver::HourglassForm> hourglass_form;
 		std::shared_ptr<solver::InertiaForm> inertia_form;
 		std::shared_ptr<solver::PressureForm> pressure_form;
 
 		std::shared_ptr<solver::PeriodicContactForm> periodic_contact_form;
+		std::shared_ptr<solver::ImplicitObstacleForm> implicit_obstacle_form;
 
 		std::shared_ptr<time_integrator::ImplicitTimeIntegrator> time_integrator;
+		/// explicit integrator stepping the solution, time_integrator then only evaluates the velocities of the forms
+		std::shared_ptr<time_integrator::ExplicitTimeIntegrator> explicit_time_integrator;
+
+		/// AL weight reached by the last augmented Lagrangian solve, the next one starts from it
+		double al_weight = 0;
 	};
 } // namespace polyfem::solver
@@ -10,6 +10,7 @@
 
 #include <unsupported/Eigen/SparseExtra>
 
+#include <algorithm>
 #include <cmath>
 
 namespace polyfem
@@ -26,6 +27,11 @@ namespace polyfem
 		{
 			gradNorm = solver_param["nonlinear"]["grad_norm"];
 			iterations = solver_param["nonlinear"]["max_iterations"];
+
+			jacobian_reuse_ratio = solver_param["advanced"]["jacobian_reuse_ratio"];
+
+			if (solver_param["advanced"]["saddle_point_solver"] == "SIMPLE")
+				saddle_point_solver = std::make_unique<SaddlePointSolver>(solver_param["linear"]);
 		}
 
 		void TransientNavierStokesSolver::minimize(
@@ -80,7 +86,13 @@ namespace polyfem
 			{
 				b[b.size() - 1] = 0;
 			}
-			dirichlet_solve(*solver, stoke_stiffness, b, boundary_nodes, x, precond_num, "", false, true, use_avg_pressure);
+			// when factorizations are reused across time steps, the previous step is the initial guess
+			if (jacobian_reuse_ratio > 0 && has_previous_step)
+				logger().debug("\tskipping the Stokes initial guess");
+			else if (saddle_point_solver)
+				saddle_point_solver->dirichlet_solve(stoke_stiffness, b, boundary_nodes, precond_num, use_avg_pressure, x);
+			else
+				dirichlet_solve(*solver, stoke_stiffness, b, boundary_nodes, x, precond_num, "", false, true, use_avg_pressure);
 			// solver->get_info(solver_info);
 			time.stop();
 			stokes_solve_time = time.getElapsedTimeInSec();
@@ -156,6 +168,7 @@ namespace polyfem
 			solver_info["time_stokes_solve"] = stokes_solve_time;
 
 			logger().info("finished with niter: {},  ||g||_2 = {}", it, nlres_norm);
+			has_previous_step = true;
 		}
 
 		int TransientNavierStokesSolver::minimize_aux(
@@ -209,6 +222,7 @@ namespace polyfem
 			while (nlres_norm > grad_norm && it < iterations)
 			{
 				++it;
+				const double prev_nlres_norm = nlres_norm;
 
 				time.start();
 				if (!is_picard)
@@ -219,7 +233,7 @@ namespace polyfem
 														 (velocity_stiffness + nl_matrix) + velocity_mass, mixed_stiffness, pressure_stiffness,
 														 total_matrix);
 				}
-				dirichlet_solve(*solver, total_matrix, nlres, boundary_nodes, dx, precond_num, "", false, true, use_avg_pressure);
+				solve_step(total_matrix, nlres, boundary_nodes, skipping, precond_num, use_avg_pressure, solver, dx);
 				// for (int i : boundary_nodes)
 				// 	dx[i] = 0;
 				time.stop();
@@ -251,6 +265,9 @@ namespace polyfem
 
 				logger().debug("\titer: {},  ||g||_2 = {}, ||step|| = {}\n",
 							   it, nlres_norm, dx.norm());
+
+				if (nlres_norm > jacobian_reuse_ratio * prev_nlres_norm)
+					refactorize_jacobian = true;
 			}
 
 			if (it >= iterations)
@@ -264,5 +281,48 @@ namespace polyfem
 
 			return it;
 		}
+
+		void TransientNavierStokesSolver::solve_step(const StiffnessMatrix &total_matrix, const Eigen::VectorXd &nlres,
+												const std::vector<int> &boundary_nodes, const std::vector<int> &skipping,
+												const int precond_num, const bool use_avg_pressure,
+												std::unique_ptr<linear::Solver> &solver, Eigen::VectorXd &dx)
+		{
+			if (jacobian_reuse_ratio <= 0)
+			{
+				if (saddle_point_solver)
+					saddle_point_solver->dirichlet_solve(total_matrix, nlres, boundary_nodes, precond_num, use_avg_pressure, dx);
+				else
+					dirichlet_solve(*solver, total_matrix, nlres, boundary_nodes, dx, precond_num, "", false, true, use_avg_pressure);
+				return;
+			}
+
+			if (saddle_point_solver)
+			{
+				saddle_point_solver->dirichlet_solve(total_matrix, nlres, boundary_nodes, precond_num, use_avg_pressure, dx, refactorize_jacobian);
+				refactorize_jacobian = false;
+				return;
+			}
+
+			// Dirichlet and empty dofs are identity rows of the factorized matrix
+			std::vector<int> fixed_dofs = boundary_nodes;
+			fixed_dofs.insert(fixed_dofs.end(), skipping.begin(), skipping.end());
+			std::sort(fixed_dofs.begin(), fixed_dofs.end());
+			fixed_dofs.erase(std::unique(fixed_dofs.begin(), fixed_dofs.end()), fixed_dofs.end());
+
+			if (refactorize_jacobian || !jacobian_solver || factorized_jacobian.rows() != total_matrix.rows())
+			{
+				if (!jacobian_solver)
+					jacobian_solver = linear::Solver::create(solver_param["linear"], logger());
+				factorized_jacobian = total_matrix;
+				StiffnessMatrix mat = total_matrix;
+				prefactorize(*jacobian_solver, mat, fixed_dofs, precond_num, "");
+				refactorize_jacobian = false;
+			}
+			else
+				logger().debug("\treusing the previous factorization");
+
+			dx.setZero(nlres.size());
+			dirichlet_solve_prefactorized(*jacobian_solver, factorized_jacobian, nlres, fixed_dofs, dx);
+		}
 	} // namespace solver
 } // namespace polyfem
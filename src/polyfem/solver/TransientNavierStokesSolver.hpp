@@ -4,6 +4,7 @@
 #include <polyfem/basis/ElementBases.hpp>
 #include <polyfem/assembler/NavierStokes.hpp>
 #include <polyfem/assembler/AssemblyValsCache.hpp>
+#include <polyfem/solver/SaddlePointSolver.hpp>
 
 #include <polysolve/linear/Solver.hpp>
 
@@ -62,7 +63,22 @@ namespace polyfem
 							 std::unique_ptr<polysolve::linear::Solver> &solver, double &nlres_norm,
 							 Eigen::VectorXd &x);
 
+			/// solves total_matrix dx = nlres, keeping the last factorization while jacobian_reuse_ratio allows it
+			void solve_step(const StiffnessMatrix &total_matrix, const Eigen::VectorXd &nlres,
+							const std::vector<int> &boundary_nodes, const std::vector<int> &skipping,
+							const int precond_num, const bool use_avg_pressure,
+							std::unique_ptr<polysolve::linear::Solver> &solver, Eigen::VectorXd &dx);
+
 			const json solver_param;
+			/// block solver used instead of the monolithic linear solver, null if not requested
+			std::unique_ptr<SaddlePointSolver> saddle_point_solver;
+
+			/// a factorization is kept while every step reduces the residual below this fraction of the previous one, 0 refactorizes every iteration
+			double jacobian_reuse_ratio;
+			std::unique_ptr<polysolve::linear::Solver> jacobian_solver;
+			StiffnessMatrix factorized_jacobian;
+			bool refactorize_jacobian = true;
+			bool has_previous_step = false;
 
 			double gradNorm;
 			int iterations;
@@ -57,12 +57,22 @@ namespace polyfem::solver
 		  is_formulation_mixed_(is_formulation_mixed)
 	{
 		t_ = 0;
+
+		const assembler::Problem &problem = rhs_assembler_.problem();
+		split_loads_ = !is_formulation_mixed_
+					   && (problem.is_constant_in_time() || (problem.is_rhs_time_independent() && !density_.depends_on_time()))
+					   && problem.n_neumann_time_parts() >= 0;
+
 		if (!is_time_dependent)
 			update_current_rhs(Eigen::VectorXd());
 	}
 
 	double BodyForm::value_unweighted(const Eigen::VectorXd &x) const
 	{
+		// the loads do not depend on x
+		if (split_loads_)
+			return -current_loads_.col(0).dot(x);
+
 		return rhs_assembler_.compute_energy(x, x_prev_, local_neumann_boundary_, density_, n_boundary_samples_, t_);
 	}
 
@@ -77,6 +87,11 @@ namespace polyfem::solver
 		hessian.resize(x.size(), x.size());
 	}
 
+	void BodyForm::hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+	{
+		hv.setZero(x.size());
+	}
+
 	void BodyForm::update_quantities(const double t, const Eigen::VectorXd &x)
 	{
 		this->t_ = t;
@@ -86,6 +101,33 @@ namespace polyfem::solver
 
 	void BodyForm::update_current_rhs(const Eigen::VectorXd &x)
 	{
+		if (split_loads_)
+		{
+			// the body force is rhs_ and the Neumann loads are a combination of parts, no assembly per time step
+			if (neumann_parts_.empty())
+			{
+				neumann_parts_.resize(rhs_assembler_.problem().n_neumann_time_parts());
+				for (int k = 0; k < neumann_parts_.size(); ++k)
+				{
+					neumann_parts_[k].setZero(rhs_.rows(), rhs_.cols());
+					rhs_assembler_.assemble_neumann_part(k, n_boundary_samples_, local_neumann_boundary_, neumann_parts_[k]);
+				}
+			}
+
+			current_loads_ = rhs_;
+			for (int k = 0; k < neumann_parts_.size(); ++k)
+				current_loads_ += rhs_assembler_.problem().neumann_time_factor(k, t_) * neumann_parts_[k];
+
+			current_rhs_ = current_loads_;
+			// Apply Dirichlet boundary conditions, the empty call only updates the obstacle
+			rhs_assembler_.set_bc(
+				apply_DBC_ ? local_boundary_ : std::vector<mesh::LocalBoundary>(),
+				apply_DBC_ ? boundary_nodes_ : std::vector<int>(),
+				n_boundary_samples_, std::vector<mesh::LocalBoundary>(),
+				current_rhs_, x, t_);
+			return;
+		}
+
 		rhs_assembler_.compute_energy_grad(
 			local_boundary_, boundary_nodes_, density_,
 			n_boundary_samples_, local_neumann_boundary_,
@@ -49,6 +49,12 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
+		/// @brief Compute the product of the second derivative wrt x with v
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply the Hessian with
+		/// @param[out] hv Output product of the Hessian with v
+		void hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const override;
+
 	public:
 		/// @brief Update time dependent quantities
 		/// @param t New time
@@ -103,6 +109,11 @@ namespace polyfem::solver
 
 		Eigen::MatrixXd current_rhs_; ///< Cached RHS for the current time
 
+		/// If true, the body force is time independent and the Neumann loads are time factors of cached parts
+		bool split_loads_;
+		std::vector<Eigen::MatrixXd> neumann_parts_; ///< Integrated time independent parts of the Neumann loads, built on first use
+		Eigen::MatrixXd current_loads_;              ///< Body and Neumann loads at the current time, without the Dirichlet values
+
 		/// @brief Update current_rhs
 		void update_current_rhs(const Eigen::VectorXd &x);
 	};
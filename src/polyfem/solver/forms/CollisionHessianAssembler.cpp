@@ -0,0 +1,169 @@
+#include "CollisionHessianAssembler.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <algorithm>
+
+namespace polyfem::solver
+{
+	bool CollisionHessianAssembler::set_displacement_map(const ipc::CollisionMesh &collision_mesh, const StiffnessMatrix &displacement_map)
+	{
+		vertex_to_nodes_.resize(0, 0);
+		keys_.clear();
+		pattern_.resize(0, 0);
+
+		const int n_full_vertices = collision_mesh.full_num_vertices();
+		if (displacement_map.size() > 0 && displacement_map.rows() != n_full_vertices)
+		{
+			logger().debug("Displacement map ({}×{}) does not match the collision mesh ({} vertices), using the global mapping",
+						   displacement_map.rows(), displacement_map.cols(), n_full_vertices);
+			return false;
+		}
+
+		const int n_vertices = collision_mesh.num_vertices();
+		const int n_nodes = displacement_map.size() > 0 ? displacement_map.cols() : n_full_vertices;
+		dim_ = collision_mesh.dim();
+
+		std::vector<Eigen::Triplet<double>> entries;
+		if (displacement_map.size() > 0)
+		{
+			const Eigen::SparseMatrix<double, Eigen::RowMajor> rows = displacement_map;
+			for (int vi = 0; vi < n_vertices; ++vi)
+				for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(rows, collision_mesh.to_full_vertex_id(vi)); it; ++it)
+					entries.emplace_back(vi, it.col(), it.value());
+		}
+		else
+		{
+			for (int vi = 0; vi < n_vertices; ++vi)
+				entries.emplace_back(vi, collision_mesh.to_full_vertex_id(vi), 1.0);
+		}
+
+		vertex_to_nodes_.resize(n_vertices, n_nodes);
+		vertex_to_nodes_.setFromTriplets(entries.begin(), entries.end());
+		vertex_to_nodes_.makeCompressed();
+
+		return true;
+	}
+
+	void CollisionHessianAssembler::build_pattern(const std::vector<std::array<long, 4>> &vertex_ids) const
+	{
+		const int n_collisions = vertex_ids.size();
+		const int dim = dim_;
+
+		nodes_.resize(n_collisions);
+		local_maps_.resize(n_collisions);
+		slots_.resize(n_collisions);
+
+		utils::maybe_parallel_for(n_collisions, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const std::array<long, 4> &vis = vertex_ids[i];
+				const int n_v = std::count_if(vis.begin(), vis.end(), [](const long v) { return v >= 0; });
+
+				std::vector<int> &nodes = nodes_[i];
+				nodes.clear();
+				for (int k = 0; k < n_v; ++k)
+					for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(vertex_to_nodes_, vis[k]); it; ++it)
+						nodes.push_back(it.col());
+				std::sort(nodes.begin(), nodes.end());
+				nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+				Eigen::MatrixXd &local_map = local_maps_[i];
+				local_map.setZero(n_v * dim, nodes.size() * dim);
+				for (int k = 0; k < n_v; ++k)
+				{
+					for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(vertex_to_nodes_, vis[k]); it; ++it)
+					{
+						const int a = std::lower_bound(nodes.begin(), nodes.end(), int(it.col())) - nodes.begin();
+						for (int d = 0; d < dim; ++d)
+							local_map(k * dim + d, a * dim + d) = it.value();
+					}
+				}
+			}
+		});
+
+		size_t n_entries = 0;
+		for (const std::vector<int> &nodes : nodes_)
+			n_entries += nodes.size() * nodes.size() * dim * dim;
+
+		std::vector<Eigen::Triplet<double>> triplets;
+		triplets.reserve(n_entries);
+		for (const std::vector<int> &nodes : nodes_)
+		{
+			for (const int a : nodes)
+				for (const int b : nodes)
+					for (int r = 0; r < dim; ++r)
+						for (int c = 0; c < dim; ++c)
+							triplets.emplace_back(a * dim + r, b * dim + c, 0);
+		}
+
+		const int ndof = vertex_to_nodes_.cols() * dim;
+		pattern_.resize(ndof, ndof);
+		pattern_.setFromTriplets(triplets.begin(), triplets.end());
+		pattern_.makeCompressed();
+
+		const auto *outer = pattern_.outerIndexPtr();
+		const auto *inner = pattern_.innerIndexPtr();
+		utils::maybe_parallel_for(n_collisions, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const std::vector<int> &nodes = nodes_[i];
+				const int n_local = nodes.size() * dim;
+
+				// column major, as the local Hessians
+				std::vector<StorageIndex> &slots = slots_[i];
+				slots.clear();
+				slots.reserve(n_local * n_local);
+				for (int c = 0; c < n_local; ++c)
+				{
+					const int col = nodes[c / dim] * dim + c % dim;
+					for (int r = 0; r < n_local; ++r)
+					{
+						const int row = nodes[r / dim] * dim + r % dim;
+						const auto *it = std::lower_bound(inner + outer[col], inner + outer[col + 1], row);
+						assert(it != inner + outer[col + 1] && *it == row);
+						slots.push_back(it - inner);
+					}
+				}
+			}
+		});
+
+		keys_ = vertex_ids;
+	}
+
+	void CollisionHessianAssembler::assemble(
+		const std::vector<std::array<long, 4>> &vertex_ids,
+		const std::vector<Eigen::MatrixXd> &local_hessians,
+		StiffnessMatrix &hessian) const
+	{
+		assert(is_set());
+		assert(vertex_ids.size() == local_hessians.size());
+
+		if (vertex_ids != keys_ || pattern_.size() == 0)
+			build_pattern(vertex_ids);
+
+		// map the local blocks in parallel, the scatter is serial
+		std::vector<Eigen::MatrixXd> full_blocks(vertex_ids.size());
+		utils::maybe_parallel_for(vertex_ids.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				assert(local_hessians[i].rows() == local_maps_[i].rows());
+				full_blocks[i].noalias() = local_maps_[i].transpose() * local_hessians[i] * local_maps_[i];
+			}
+		});
+
+		double *values = pattern_.valuePtr();
+		std::fill(values, values + pattern_.nonZeros(), 0.0);
+		for (int i = 0; i < full_blocks.size(); ++i)
+		{
+			const double *block = full_blocks[i].data();
+			const std::vector<StorageIndex> &slots = slots_[i];
+			assert(slots.size() == full_blocks[i].size());
+			for (int j = 0; j < slots.size(); ++j)
+				values[slots[j]] += block[j];
+		}
+
+		hessian = pattern_;
+	}
+} // namespace polyfem::solver
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <polyfem/utils/Types.hpp>
+
+#include <ipc/collision_mesh.hpp>
+
+#include <Eigen/Dense>
+
+#include <array>
+#include <vector>
+
+namespace polyfem::solver
+{
+	/// @brief Assembles Hessians of collision potentials directly wrt the FE dofs.
+	///
+	/// ipc::CollisionMesh::to_full_dof maps a Hessian over the collision mesh vertices with the
+	/// global sparse product Jᵀ H J, J being the displacement map from the FE dofs. Here the FE nodes
+	/// of each collision are gathered from the rows of the map, and its local block is mapped with a
+	/// small dense product Jᵢᵀ Hᵢ Jᵢ and scattered into a sparsity pattern kept while the collisions
+	/// do not change. The surface Hessian is never formed.
+	class CollisionHessianAssembler
+	{
+	public:
+		/// @brief Set the map from the FE nodes to the collision mesh vertices
+		/// @param collision_mesh Collision mesh
+		/// @param displacement_map Displacement map the collision mesh was built with (full vertices × FE nodes), empty for the identity
+		/// @return False if the map does not match the collision mesh, in which case the assembler is not set
+		bool set_displacement_map(const ipc::CollisionMesh &collision_mesh, const StiffnessMatrix &displacement_map);
+
+		/// @brief Is the displacement map set?
+		bool is_set() const { return vertex_to_nodes_.rows() > 0; }
+
+		/// @brief Assemble Σᵢ Jᵢᵀ Hᵢ Jᵢ
+		/// @param[in] vertex_ids Collision mesh vertex ids of each collision, padded with -1
+		/// @param[in] local_hessians Hessian of each collision wrt the dofs of its vertices
+		/// @param[out] hessian Hessian wrt the FE dofs
+		void assemble(
+			const std::vector<std::array<long, 4>> &vertex_ids,
+			const std::vector<Eigen::MatrixXd> &local_hessians,
+			StiffnessMatrix &hessian) const;
+
+	private:
+		/// @brief Rebuild the sparsity pattern and the local maps for new collisions
+		void build_pattern(const std::vector<std::array<long, 4>> &vertex_ids) const;
+
+		/// @brief Rows of the displacement map of the collision mesh vertices (collision vertices × FE nodes)
+		Eigen::SparseMatrix<double, Eigen::RowMajor> vertex_to_nodes_;
+		int dim_ = 0;
+
+		/// @brief Collisions of the current pattern
+		mutable std::vector<std::array<long, 4>> keys_;
+		/// @brief FE nodes touched by each collision
+		mutable std::vector<std::vector<int>> nodes_;
+		/// @brief Jᵢ, from the dofs of the FE nodes of collision i to the dofs of its vertices
+		mutable std::vector<Eigen::MatrixXd> local_maps_;
+		/// @brief Offsets of the entries of each collision in the values of pattern_
+		mutable std::vector<std::vector<StorageIndex>> slots_;
+		/// @brief Hessian with the sparsity pattern of keys_
+		mutable StiffnessMatrix pattern_;
+	};
+} // namespace polyfem::solver
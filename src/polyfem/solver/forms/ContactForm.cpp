@@ -3,10 +3,12 @@
 #include <polyfem/solver/NLProblem.hpp>
 #include <polyfem/solver/forms/FrictionForm.hpp>
 #include <polyfem/utils/Types.hpp>
+#include <polyfem/utils/HashUtils.hpp>
 #include <polyfem/utils/Timer.hpp>
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Profiler.hpp>
 
 #include <polyfem/io/OBJWriter.hpp>
 
@@ -15,10 +17,54 @@
 
 #include <igl/writePLY.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <numeric>
+#include <unordered_map>
 
 namespace polyfem::solver
 {
+	namespace
+	{
+		/// The CCD returns a conservative time of impact, a candidate is skipped only when
+		/// this fraction of its lower bound is already past the current earliest time of impact
+		constexpr double TOI_LOWER_BOUND_SAFETY = 0.5;
+
+		/// The brute force broad phase is quadratic, it is only benchmarked on small collision meshes
+		constexpr int MAX_BRUTE_FORCE_VERTICES = 1000;
+
+		void atomic_min(std::atomic<double> &value, const double v)
+		{
+			double current = value.load();
+			while (v < current && !value.compare_exchange_weak(current, v))
+				;
+		}
+
+		/// Selects the candidates closer than max_distance, the distances are evaluated in parallel
+		template <typename Candidate>
+		void select_close_candidates(
+			const std::vector<Candidate> &candidates,
+			const Eigen::MatrixXd &V,
+			const Eigen::MatrixXi &E,
+			const Eigen::MatrixXi &F,
+			const double max_distance,
+			std::vector<Candidate> &selected)
+		{
+			std::vector<char> is_close(candidates.size());
+			utils::maybe_parallel_for(candidates.size(), [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+					// compute_distance returns the squared distance
+					is_close[i] = candidates[i].compute_distance(candidates[i].dof(V, E, F)) < max_distance * max_distance;
+			});
+
+			selected.clear();
+			for (size_t i = 0; i < candidates.size(); ++i)
+				if (is_close[i])
+					selected.push_back(candidates[i]);
+		}
+	} // namespace
+
 	ContactForm::ContactForm(const ipc::CollisionMesh &collision_mesh,
 							 const double dhat,
 							 const double avg_mass,
@@ -48,6 +94,79 @@ namespace polyfem::solver
 		collision_set_.set_are_shape_derivatives_enabled(enable_shape_derivatives);
 	}
 
+	void ContactForm::set_broad_phase_autotuning(const int trial_calls, const int period)
+	{
+		autotuning_ = BroadPhaseAutotuning();
+		if (trial_calls <= 0)
+			return;
+
+		autotuning_.trial_calls = trial_calls;
+		autotuning_.period = std::max(period, 0);
+		// STQ runs on the GPU with its own narrow phase, it is not a drop-in candidate builder
+		autotuning_.methods = {
+			ipc::BroadPhaseMethod::HASH_GRID,
+			ipc::BroadPhaseMethod::SPATIAL_HASH,
+			ipc::BroadPhaseMethod::BVH,
+			ipc::BroadPhaseMethod::SWEEP_AND_PRUNE};
+		if (collision_mesh_.num_vertices() <= MAX_BRUTE_FORCE_VERTICES)
+			autotuning_.methods.push_back(ipc::BroadPhaseMethod::BRUTE_FORCE);
+		autotuning_.timings.resize(autotuning_.methods.size());
+		autotuning_.remaining_trials = trial_calls;
+
+		if (broad_phase_method_ == ipc::BroadPhaseMethod::SWEEP_AND_TINIEST_QUEUE)
+			broad_phase_method_ = ipc::BroadPhaseMethod::HASH_GRID;
+	}
+
+	void ContactForm::build_candidates(ipc::Candidates &candidates, const std::function<void(ipc::BroadPhaseMethod, ipc::Candidates &)> &build) const
+	{
+		if (autotuning_.remaining_trials <= 0)
+		{
+			build(broad_phase_method_, candidates);
+			if (autotuning_.period > 0 && ++autotuning_.calls >= autotuning_.period)
+				autotuning_.remaining_trials = autotuning_.trial_calls;
+			return;
+		}
+
+		// Every method builds the candidates of the same positions, the ones of the fastest are kept
+		POLYFEM_SCOPED_TIMER("benchmark broad phase");
+		double fastest = std::numeric_limits<double>::infinity();
+		for (size_t i = 0; i < autotuning_.methods.size(); ++i)
+		{
+			utils::Timing &timing = autotuning_.timings[i];
+			const double previous_time = timing.time;
+			ipc::Candidates trial;
+			{
+				POLYFEM_SCOPED_TIMER(timing);
+				build(autotuning_.methods[i], trial);
+			}
+			if (timing.time - previous_time < fastest)
+			{
+				fastest = timing.time - previous_time;
+				candidates = std::move(trial);
+			}
+		}
+
+		if (--autotuning_.remaining_trials > 0)
+			return;
+
+		size_t best = 0;
+		for (size_t i = 1; i < autotuning_.methods.size(); ++i)
+		{
+			if (autotuning_.timings[i].time < autotuning_.timings[best].time)
+				best = i;
+		}
+		for (size_t i = 0; i < autotuning_.methods.size(); ++i)
+			logger().trace("Broad phase {} took {:.3g}s in {} calls", json(autotuning_.methods[i]).get<std::string>(), autotuning_.timings[i].time, autotuning_.timings[i].count);
+		if (autotuning_.methods[best] != broad_phase_method_)
+			logger().debug("Switching broad phase from {} to {}", json(broad_phase_method_).get<std::string>(), json(autotuning_.methods[best]).get<std::string>());
+
+		broad_phase_method_ = autotuning_.methods[best];
+		std::fill(autotuning_.timings.begin(), autotuning_.timings.end(), utils::Timing());
+		autotuning_.calls = 0;
+		++autotuning_.n_selections;
+		POLYFEM_PROFILE_COUNTER("broad phase method", static_cast<int>(broad_phase_method_));
+	}
+
 	void ContactForm::init(const Eigen::VectorXd &x)
 	{
 		update_collision_set(compute_displaced_surface(x));
@@ -73,11 +192,19 @@ namespace polyfem::solver
 		return collision_mesh_.displace_vertices(utils::unflatten(x, collision_mesh_.dim()));
 	}
 
-	void ContactForm::update_barrier_stiffness(const Eigen::VectorXd &x, const Eigen::MatrixXd &grad_energy)
+	void ContactForm::update_barrier_stiffness(const Eigen::VectorXd &x, const std::function<Eigen::VectorXd()> &grad_energy)
 	{
 		if (!use_adaptive_barrier_stiffness())
 			return;
 
+		// The stiffness is then only adjusted in post_step, the gradients are not needed
+		if (!needs_initial_barrier_stiffness())
+		{
+			//max_barrier_stiffness not used in this scheme, so set to a very high number for now
+			max_barrier_stiffness_ = 1e30;
+			return;
+		}
+
 		const Eigen::MatrixXd displaced_surface = compute_displaced_surface(x);
 
 		// The adative stiffness is designed for the non-convergent formulation,
@@ -85,21 +212,24 @@ namespace polyfem::solver
 		// After we can map it to a good value for the convergent formulation.
 		ipc::Collisions nonconvergent_constraints;
 		nonconvergent_constraints.set_use_convergent_formulation(false);
-		nonconvergent_constraints.build(
-			collision_mesh_, displaced_surface, dhat_, dmin_, broad_phase_method_);
+		if (are_persistent_candidates_valid(displaced_surface))
+			nonconvergent_constraints.build(
+				persistent_candidates_, collision_mesh_, displaced_surface, dhat_, dmin_);
+		else
+			nonconvergent_constraints.build(
+				collision_mesh_, displaced_surface, dhat_, dmin_, broad_phase_method_);
 		Eigen::VectorXd grad_barrier = barrier_potential_.gradient(
 			nonconvergent_constraints, collision_mesh_, displaced_surface);
 		grad_barrier = collision_mesh_.to_full_dof(grad_barrier);
 
-		if(prev_distance_ == -1 && prev_distance_ == INFINITY && prev_distance_ == -INFINITY)
-			barrier_stiffness_ = ipc::initial_barrier_stiffness(
-				ipc::world_bbox_diagonal_length(displaced_surface), barrier_potential_.barrier(), dhat_, avg_mass_,
-				grad_energy, grad_barrier, max_barrier_stiffness_);
-		
+		barrier_stiffness_ = ipc::initial_barrier_stiffness(
+			ipc::world_bbox_diagonal_length(displaced_surface), barrier_potential_.barrier(), dhat_, avg_mass_,
+			grad_energy(), grad_barrier, max_barrier_stiffness_);
+
 		//max_barrier_stiffness not used in this scheme, so set to a very high number for now
 		max_barrier_stiffness_ = 1e30;
-		
-		if (use_convergent_formulation() && (prev_distance_ == -1 && prev_distance_ == INFINITY &&  prev_distance_ == -INFINITY))
+
+		if (use_convergent_formulation())
 		{
 			double scaling_factor = 0;
 			if (!nonconvergent_constraints.empty())
@@ -123,8 +253,7 @@ namespace polyfem::solver
 
 		// The barrier stiffness is choosen based on including the acceleration scaling,
 		// but the acceleration scaling will be applied later. Therefore, we need to remove it.
-		if(prev_distance_ == -1 && prev_distance_ == INFINITY &&  prev_distance_ == -INFINITY)
-			barrier_stiffness_ /= weight_;
+		barrier_stiffness_ /= weight_;
 
 		logger().debug(
 			"Setting adaptive barrier stiffness to {}",
@@ -134,17 +263,80 @@ namespace polyfem::solver
 	void ContactForm::update_collision_set(const Eigen::MatrixXd &displaced_surface)
 	{
 		// Store the previous value used to compute the constraint set to avoid duplicate computation.
-		static Eigen::MatrixXd cached_displaced_surface;
-		if (cached_displaced_surface.size() == displaced_surface.size() && cached_displaced_surface == displaced_surface)
+		if (collision_set_surface_.size() == displaced_surface.size() && collision_set_surface_ == displaced_surface)
 			return;
 
 		if (use_cached_candidates_)
 			collision_set_.build(
 				candidates_, collision_mesh_, displaced_surface, dhat_);
+		else if (broad_phase_skin_ > 0)
+		{
+			if (!are_persistent_candidates_valid(displaced_surface))
+			{
+				POLYFEM_SCOPED_TIMER("rebuild persistent candidates");
+				build_candidates(persistent_candidates_, [&](const ipc::BroadPhaseMethod method, ipc::Candidates &out) {
+					out.build(
+						collision_mesh_, displaced_surface,
+						/*inflation_radius=*/(dhat_ + broad_phase_skin_) / 2,
+						method);
+				});
+				persistent_candidates_surface_ = displaced_surface;
+				near_candidates_surface_.resize(0, 0);
+			}
+			if (!are_near_candidates_valid(displaced_surface))
+				update_near_candidates(displaced_surface);
+			collision_set_.build(
+				near_candidates_, collision_mesh_, displaced_surface, dhat_);
+		}
 		else
 			collision_set_.build(
 				collision_mesh_, displaced_surface, dhat_, dmin_, broad_phase_method_);
-		cached_displaced_surface = displaced_surface;
+		collision_set_surface_ = displaced_surface;
+
+		POLYFEM_PROFILE_COUNTER("collisions", collision_set_.size());
+	}
+
+	void ContactForm::update_near_candidates(const Eigen::MatrixXd &displaced_surface)
+	{
+		POLYFEM_SCOPED_TIMER("update near candidates");
+		assert(are_persistent_candidates_valid(displaced_surface));
+
+		// Same margin as the persistent candidates, but on the exact distances instead of the inflated boxes
+		const double max_distance = dhat_ + dmin_ + broad_phase_skin_;
+		const Eigen::MatrixXi &E = collision_mesh_.edges();
+		const Eigen::MatrixXi &F = collision_mesh_.faces();
+		select_close_candidates(persistent_candidates_.ev_candidates, displaced_surface, E, F, max_distance, near_candidates_.ev_candidates);
+		select_close_candidates(persistent_candidates_.ee_candidates, displaced_surface, E, F, max_distance, near_candidates_.ee_candidates);
+		select_close_candidates(persistent_candidates_.fv_candidates, displaced_surface, E, F, max_distance, near_candidates_.fv_candidates);
+		near_candidates_surface_ = displaced_surface;
+
+		POLYFEM_PROFILE_COUNTER("near candidates", near_candidates_.size());
+	}
+
+	bool ContactForm::are_near_candidates_valid(const Eigen::MatrixXd &displaced_surface) const
+	{
+		if (near_candidates_surface_.rows() != displaced_surface.rows()
+			|| near_candidates_surface_.cols() != displaced_surface.cols()
+			|| displaced_surface.rows() == 0)
+			return false;
+
+		// The pairs left out were farther than dhat + skin, both primitives moving less than
+		// skin / 2 they are still farther than dhat
+		const double max_motion = (displaced_surface - near_candidates_surface_).rowwise().norm().maxCoeff();
+		return max_motion <= broad_phase_skin_ / 2;
+	}
+
+	bool ContactForm::are_persistent_candidates_valid(const Eigen::MatrixXd &displaced_surface) const
+	{
+		if (broad_phase_skin_ <= 0 || displaced_surface.rows() == 0
+			|| persistent_candidates_surface_.rows() != displaced_surface.rows()
+			|| persistent_candidates_surface_.cols() != displaced_surface.cols())
+			return false;
+
+		// Pairs missing from the candidates were more than dhat + skin apart, if every vertex
+		// moved less than skin / 2 they are still farther than dhat
+		const double max_motion = (displaced_surface - persistent_candidates_surface_).rowwise().norm().maxCoeff();
+		return max_motion <= broad_phase_skin_ / 2;
 	}
 
 	double ContactForm::value_unweighted(const Eigen::VectorXd &x) const
@@ -211,8 +403,180 @@ namespace polyfem::solver
 	void ContactForm::second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const
 	{
 		POLYFEM_SCOPED_TIMER("barrier hessian");
-		hessian = barrier_potential_.hessian(collision_set_, collision_mesh_, compute_displaced_surface(x), project_to_psd_);
-		hessian = collision_mesh_.to_full_dof(hessian);
+		if (!full_hessian_assembler_.is_set())
+		{
+			hessian = collision_mesh_.to_full_dof(assemble_surface_hessian(compute_displaced_surface(x)));
+			return;
+		}
+
+		// The local blocks are mapped to the FE dofs directly, without the surface Hessian
+		update_hessian_blocks(compute_displaced_surface(x));
+
+		std::vector<std::array<long, 4>> vertex_ids(hessian_keys_.size());
+		std::vector<Eigen::MatrixXd> local_hessians(hessian_blocks_.size());
+		for (int i = 0; i < hessian_keys_.size(); ++i)
+		{
+			std::copy(hessian_keys_[i].begin() + 1, hessian_keys_[i].end(), vertex_ids[i].begin());
+			local_hessians[i] = hessian_blocks_[i].hessian;
+		}
+		full_hessian_assembler_.assemble(vertex_ids, local_hessians, hessian);
+	}
+
+	bool ContactForm::set_displacement_map(const StiffnessMatrix &displacement_map)
+	{
+		return full_hessian_assembler_.set_displacement_map(collision_mesh_, displacement_map);
+	}
+
+	void ContactForm::hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+	{
+		POLYFEM_SCOPED_TIMER("barrier hessian-vector product");
+		// Only the surface Hessian is assembled, v is mapped to the collision mesh and back
+		const StiffnessMatrix &surface_hessian = assemble_surface_hessian(compute_displaced_surface(x));
+		const Eigen::VectorXd surface_v = utils::flatten(collision_mesh_.map_displacements(utils::unflatten(v, collision_mesh_.dim())));
+		hv = collision_mesh_.to_full_dof(Eigen::VectorXd(surface_hessian * surface_v));
+	}
+
+	void ContactForm::update_hessian_blocks(const Eigen::MatrixXd &V) const
+	{
+		const Eigen::MatrixXi &E = collision_mesh_.edges();
+		const Eigen::MatrixXi &F = collision_mesh_.faces();
+		const int n_collisions = collision_set_.size();
+
+		std::vector<CollisionKey> keys(n_collisions);
+		for (int i = 0; i < n_collisions; ++i)
+		{
+			const std::array<long, 4> vis = collision_set_[i].vertex_ids(E, F);
+			// edge-edge and face-vertex stencils can share the same vertex ids
+			keys[i] = {{collision_set_.is_edge_edge(i) ? 1 : 0, vis[0], vis[1], vis[2], vis[3]}};
+		}
+
+		const bool same_collisions = keys == hessian_keys_;
+
+		// When the active set changed, blocks of the surviving collisions are found by key
+		std::unordered_map<CollisionKey, int, utils::HashArray> previous_blocks;
+		if (!same_collisions)
+		{
+			previous_blocks.reserve(hessian_keys_.size());
+			for (int i = 0; i < hessian_keys_.size(); ++i)
+				previous_blocks.emplace(hessian_keys_[i], i);
+		}
+
+		std::vector<CachedHessianBlock> blocks(n_collisions);
+		auto storage = utils::create_thread_storage<int>(0);
+
+		utils::maybe_parallel_for(n_collisions, [&](int start, int end, int thread_id) {
+			int &n_recomputed = utils::get_local_thread_storage(storage, thread_id);
+
+			for (int i = start; i < end; ++i)
+			{
+				int prev = i;
+				if (!same_collisions)
+				{
+					const auto it = previous_blocks.find(keys[i]);
+					prev = it == previous_blocks.end() ? -1 : it->second;
+				}
+
+				CachedHessianBlock &block = blocks[i];
+				block.dof = collision_set_[i].dof(V, E, F);
+				block.weight = collision_set_[i].weight;
+				block.project_to_psd = project_to_psd_;
+
+				if (prev >= 0)
+				{
+					const CachedHessianBlock &cached = hessian_blocks_[prev];
+					if (cached.weight == block.weight && cached.project_to_psd == block.project_to_psd
+						&& cached.dof.size() == block.dof.size() && cached.dof == block.dof)
+					{
+						block.hessian = cached.hessian;
+						continue;
+					}
+				}
+
+				block.hessian = barrier_potential_.hessian(collision_set_[i], block.dof, project_to_psd_);
+				++n_recomputed;
+			}
+		});
+
+		int n_recomputed = 0;
+		for (const int n : storage)
+			n_recomputed += n;
+		POLYFEM_LOG_TRACE("Recomputed {}/{} barrier hessian blocks", n_recomputed, n_collisions);
+
+		hessian_blocks_ = std::move(blocks);
+		if (!same_collisions)
+		{
+			hessian_keys_ = std::move(keys);
+			surface_hessian_valid_ = false;
+		}
+	}
+
+	const StiffnessMatrix &ContactForm::assemble_surface_hessian(const Eigen::MatrixXd &V) const
+	{
+		const int dim = collision_mesh_.dim();
+		const int ndof = V.size();
+
+		update_hessian_blocks(V);
+		const int n_collisions = hessian_keys_.size();
+		const std::vector<CollisionKey> &keys = hessian_keys_;
+		const std::vector<CachedHessianBlock> &blocks = hessian_blocks_;
+
+		// Rebuild the sparsity pattern and the entry offsets only when the collisions changed
+		if (!surface_hessian_valid_ || surface_hessian_.rows() != ndof)
+		{
+			std::vector<Eigen::Triplet<double>> triplets;
+			for (int i = 0; i < n_collisions; ++i)
+			{
+				const int n_v = collision_set_[i].num_vertices();
+				for (int r = 0; r < n_v * dim; ++r)
+					for (int c = 0; c < n_v * dim; ++c)
+						triplets.emplace_back(keys[i][1 + r / dim] * dim + r % dim, keys[i][1 + c / dim] * dim + c % dim, 0);
+			}
+
+			surface_hessian_.resize(ndof, ndof);
+			surface_hessian_.setFromTriplets(triplets.begin(), triplets.end());
+			surface_hessian_.makeCompressed();
+
+			hessian_slots_.resize(n_collisions);
+			const auto *outer = surface_hessian_.outerIndexPtr();
+			const auto *inner = surface_hessian_.innerIndexPtr();
+			for (int i = 0; i < n_collisions; ++i)
+			{
+				const int n_v = collision_set_[i].num_vertices();
+				std::vector<StorageIndex> &slots = hessian_slots_[i];
+				slots.clear();
+				slots.reserve(n_v * dim * n_v * dim);
+				for (int r = 0; r < n_v * dim; ++r)
+				{
+					const int row = keys[i][1 + r / dim] * dim + r % dim;
+					for (int c = 0; c < n_v * dim; ++c)
+					{
+						const int col = keys[i][1 + c / dim] * dim + c % dim;
+						const auto *it = std::lower_bound(inner + outer[col], inner + outer[col + 1], row);
+						assert(it != inner + outer[col + 1] && *it == row);
+						slots.push_back(it - inner);
+					}
+				}
+			}
+
+			surface_hessian_valid_ = true;
+		}
+
+		// Patch the values in place
+		double *values = surface_hessian_.valuePtr();
+		std::fill(values, values + surface_hessian_.nonZeros(), 0.0);
+		for (int i = 0; i < n_collisions; ++i)
+		{
+			const Eigen::MatrixXd &local_hessian = blocks[i].hessian;
+			const std::vector<StorageIndex> &slots = hessian_slots_[i];
+			assert(slots.size() == local_hessian.size());
+
+			int slot = 0;
+			for (int r = 0; r < local_hessian.rows(); ++r)
+				for (int c = 0; c < local_hessian.cols(); ++c)
+					values[slots[slot++]] += local_hessian(r, c);
+		}
+
+		return surface_hessian_;
 	}
 
 	void ContactForm::solution_changed(const Eigen::VectorXd &new_x)
@@ -235,12 +599,32 @@ namespace polyfem::solver
 		}
 
 		double max_step;
-		if (use_cached_candidates_ && broad_phase_method_ != ipc::BroadPhaseMethod::SWEEP_AND_TINIEST_QUEUE)
-			max_step = candidates_.compute_collision_free_stepsize(
-				collision_mesh_, V0, V1, dmin_, ccd_tolerance_, ccd_max_iterations_);
-		else
+		if (broad_phase_method_ == ipc::BroadPhaseMethod::SWEEP_AND_TINIEST_QUEUE)
+		{
+			// STQ runs its own narrow phase
+			POLYFEM_SCOPED_TIMER(ccd_timings_.ccd);
 			max_step = ipc::compute_collision_free_stepsize(
 				collision_mesh_, V0, V1, broad_phase_method_, ccd_tolerance_, ccd_max_iterations_);
+		}
+		else if (use_cached_candidates_)
+			max_step = compute_collision_free_stepsize(candidates_, V0, V1);
+		else if (are_persistent_candidates_valid(V0) && are_persistent_candidates_valid(V1))
+			// the linear trajectory stays within the skin of the persistent candidates
+			max_step = compute_collision_free_stepsize(persistent_candidates_, V0, V1);
+		else
+		{
+			ipc::Candidates candidates;
+			{
+				POLYFEM_SCOPED_TIMER(ccd_timings_.broad_phase);
+				build_candidates(candidates, [&](const ipc::BroadPhaseMethod method, ipc::Candidates &out) {
+					out.build(
+						collision_mesh_, V0, V1,
+						/*inflation_radius=*/dmin_ / 2,
+						method);
+				});
+			}
+			max_step = compute_collision_free_stepsize(candidates, V0, V1);
+		}
 
 		if (save_ccd_debug_meshes && ipc::has_intersections(collision_mesh_, (V1 - V0) * max_step + V0, broad_phase_method_))
 		{
@@ -267,14 +651,103 @@ namespace polyfem::solver
 		return max_step;
 	}
 
+	double ContactForm::compute_collision_free_stepsize(
+		const ipc::Candidates &candidates,
+		const ipc::CollisionMesh &collision_mesh,
+		const Eigen::MatrixXd &V0,
+		const Eigen::MatrixXd &V1,
+		const double dmin,
+		const double tolerance,
+		const long max_iterations,
+		CCDTimings &timings)
+	{
+		const int n_candidates = candidates.size();
+		POLYFEM_PROFILE_COUNTER("ccd candidates", n_candidates);
+		if (n_candidates == 0)
+			return 1;
+
+		const Eigen::MatrixXi &E = collision_mesh.edges();
+		const Eigen::MatrixXi &F = collision_mesh.faces();
+
+		// Every point of a candidate moves at most as much as its fastest vertex, so the
+		// distance cannot close before (d₀ - dmin) / (2 max motion)
+		std::vector<double> toi_lower_bounds(n_candidates);
+		std::vector<int> order(n_candidates);
+		{
+			POLYFEM_SCOPED_TIMER(timings.narrow_phase);
+			const Eigen::VectorXd motion = (V1 - V0).rowwise().norm();
+
+			utils::maybe_parallel_for(n_candidates, [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+				{
+					const auto &candidate = candidates[i];
+					const std::array<long, 4> vis = candidate.vertex_ids(E, F);
+					double max_motion = 0;
+					for (int j = 0; j < candidate.num_vertices(); ++j)
+						max_motion = std::max(max_motion, motion(vis[j]));
+
+					if (max_motion == 0)
+						toi_lower_bounds[i] = std::numeric_limits<double>::infinity();
+					else
+					{
+						// compute_distance returns the squared distance
+						const double distance = std::sqrt(candidate.compute_distance(candidate.dof(V0, E, F)));
+						toi_lower_bounds[i] = std::max(distance - dmin, 0.0) / (2 * max_motion);
+					}
+				}
+			});
+
+			// Process the most likely impacts first so the shared bound drops early
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&](int a, int b) { return toi_lower_bounds[a] < toi_lower_bounds[b]; });
+		}
+
+		std::atomic<double> earliest_toi(1);
+		{
+			POLYFEM_SCOPED_TIMER(timings.ccd);
+			utils::maybe_parallel_for(n_candidates, [&](int start, int end, int thread_id) {
+				int n_queries = 0;
+				for (int k = start; k < end; ++k)
+				{
+					const int i = order[k];
+					const double tmax = earliest_toi.load();
+					// The batch is sorted, none of the remaining candidates can lower the bound
+					if (TOI_LOWER_BOUND_SAFETY * toi_lower_bounds[i] >= tmax)
+						break;
+					++n_queries;
+
+					const auto &candidate = candidates[i];
+					double toi = std::numeric_limits<double>::infinity();
+					const bool are_colliding = candidate.ccd(
+						candidate.dof(V0, E, F), candidate.dof(V1, E, F), toi,
+						dmin, tmax, tolerance, max_iterations);
+
+					if (are_colliding)
+						atomic_min(earliest_toi, toi);
+				}
+				POLYFEM_PROFILE_COUNTER("ccd queries", n_queries);
+			});
+		}
+
+		const double max_step = earliest_toi.load();
+		assert(max_step >= 0 && max_step <= 1);
+		return max_step;
+	}
+
 	void ContactForm::line_search_begin(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1)
 	{
-		candidates_.build(
-			collision_mesh_,
-			compute_displaced_surface(x0),
-			compute_displaced_surface(x1),
-			/*inflation_radius=*/dhat_ / 2,
-			broad_phase_method_);
+		const Eigen::MatrixXd V0 = compute_displaced_surface(x0);
+		const Eigen::MatrixXd V1 = compute_displaced_surface(x1);
+
+		if (are_persistent_candidates_valid(V0) && are_persistent_candidates_valid(V1))
+			candidates_ = persistent_candidates_;
+		else
+			build_candidates(candidates_, [&](const ipc::BroadPhaseMethod method, ipc::Candidates &out) {
+				out.build(
+					collision_mesh_, V0, V1,
+					/*inflation_radius=*/dhat_ / 2,
+					method);
+			});
 
 		use_cached_candidates_ = true;
 	}
@@ -362,6 +835,10 @@ namespace polyfem::solver
 			is_valid = candidates_.is_step_collision_free(
 				collision_mesh_, displaced0, displaced1, dmin_,
 				ccd_tolerance_, ccd_max_iterations_);
+		else if (are_persistent_candidates_valid(displaced0) && are_persistent_candidates_valid(displaced1))
+			is_valid = persistent_candidates_.is_step_collision_free(
+				collision_mesh_, displaced0, displaced1, dmin_,
+				ccd_tolerance_, ccd_max_iterations_);
 		else
 			is_valid = ipc::is_step_collision_free(
 				collision_mesh_, displaced0, displaced1, broad_phase_method_,
@@ -1,16 +1,21 @@
 #pragma once
 
 #include "Form.hpp"
+#include "CollisionHessianAssembler.hpp"
 
 #include <polyfem/Common.hpp>
 #include <polyfem/utils/Types.hpp>
+#include <polyfem/utils/Timer.hpp>
 
 #include <ipc/collisions/collisions.hpp>
 #include <ipc/collision_mesh.hpp>
 #include <ipc/broad_phase/broad_phase.hpp>
 #include <ipc/potentials/barrier_potential.hpp>
 
+#include <array>
+#include <functional>
 #include <limits>
+#include <vector>
 
 // map BroadPhaseMethod values to JSON as strings
 namespace ipc
@@ -28,7 +33,9 @@ namespace ipc
 		 {ipc::BroadPhaseMethod::SWEEP_AND_PRUNE, "sweep_and_prune"},
 		 {ipc::BroadPhaseMethod::SWEEP_AND_PRUNE, "SAP"},
 		 {ipc::BroadPhaseMethod::SWEEP_AND_TINIEST_QUEUE, "sweep_and_tiniest_queue"},
-		 {ipc::BroadPhaseMethod::SWEEP_AND_TINIEST_QUEUE, "STQ"}})
+		 {ipc::BroadPhaseMethod::SWEEP_AND_TINIEST_QUEUE, "STQ"},
+		 // autotuned by the contact form, hash grid until a method is selected
+		 {ipc::BroadPhaseMethod::HASH_GRID, "auto"}})
 } // namespace ipc
 
 namespace polyfem::solver
@@ -87,6 +94,12 @@ namespace polyfem::solver
 		/// @param hessian Output Hessian of the value wrt x
 		virtual void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
+		/// @brief Compute the product of the second derivative wrt x with v
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply the Hessian with
+		/// @param[out] hv Output product of the Hessian with v
+		virtual void hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const override;
+
 	public:
 		/// @brief Update time-dependent fields
 		/// @param t Current time
@@ -122,7 +135,8 @@ namespace polyfem::solver
 
 		/// @brief Update the barrier stiffness based on the current elasticity energy
 		/// @param x Current solution
-		virtual void update_barrier_stiffness(const Eigen::VectorXd &x, const Eigen::MatrixXd &grad_energy);
+		/// @param grad_energy Computes the gradient of the elasticity energy, only called if the stiffness is initialized from it
+		virtual void update_barrier_stiffness(const Eigen::VectorXd &x, const std::function<Eigen::VectorXd()> &grad_energy);
 
 		/// @brief Compute the displaced positions of the surface nodes
 		Eigen::MatrixXd compute_displaced_surface(const Eigen::VectorXd &x) const;
@@ -143,6 +157,57 @@ namespace polyfem::solver
 		/// @brief If true, output debug files
 		bool save_ccd_debug_meshes = false;
 
+		/// @brief Set the extra inflation of the persistent broad-phase candidates
+		/// @param skin Candidates are reused until a vertex moves more than half of it, 0 disables the reuse
+		void set_broad_phase_skin(const double skin) { broad_phase_skin_ = skin; }
+		/// @brief Get the extra inflation of the persistent broad-phase candidates
+		double broad_phase_skin() const { return broad_phase_skin_; }
+
+		/// @brief Benchmark the broad-phase methods on the candidate builds and keep the fastest one
+		/// @param trial_calls Number of candidate builds every method is timed on, 0 disables the autotuning
+		/// @param period Number of candidate builds after which the methods are benchmarked again, 0 never
+		void set_broad_phase_autotuning(const int trial_calls, const int period);
+		/// @brief Get the broad-phase method in use, the one selected by the autotuning if enabled
+		ipc::BroadPhaseMethod broad_phase_method() const { return broad_phase_method_; }
+		/// @brief Get the number of times the autotuning selected a broad-phase method
+		int broad_phase_selections() const { return autotuning_.n_selections; }
+
+		/// @brief Assemble the Hessian wrt the FE dofs from the local blocks, instead of mapping the surface Hessian
+		/// @param displacement_map Displacement map the collision mesh was built with, empty if none
+		/// @return False if the map does not match the collision mesh, the surface Hessian is mapped then
+		bool set_displacement_map(const StiffnessMatrix &displacement_map);
+
+		/// @brief Time spent in the phases of max_step_size
+		struct CCDTimings
+		{
+			utils::Timing broad_phase;  ///< Building the candidates
+			utils::Timing narrow_phase; ///< Bounding the time of impact of the candidates
+			utils::Timing ccd;          ///< Continuous collision detection
+		};
+
+		/// @brief Get the accumulated CCD timings
+		const CCDTimings &ccd_timings() const { return ccd_timings_; }
+
+		/// @brief Compute the earliest time of impact of the candidates, processed in parallel batches sharing the current bound
+		/// @param candidates Candidates containing all pairs that can collide between V0 and V1
+		/// @param collision_mesh Collision mesh of the candidates
+		/// @param V0 Surface vertex positions at the start of the step
+		/// @param V1 Surface vertex positions at the end of the step
+		/// @param dmin Minimum distance
+		/// @param tolerance CCD tolerance
+		/// @param max_iterations Maximum number of CCD iterations
+		/// @param timings Timings the narrow phase and the CCD are accumulated in
+		/// @return Maximum collision-free step size in [0, 1]
+		static double compute_collision_free_stepsize(
+			const ipc::Candidates &candidates,
+			const ipc::CollisionMesh &collision_mesh,
+			const Eigen::MatrixXd &V0,
+			const Eigen::MatrixXd &V1,
+			const double dmin,
+			const double tolerance,
+			const long max_iterations,
+			CCDTimings &timings);
+
 		double dhat() const { return dhat_; }
 		const ipc::Collisions &collision_set() const { return collision_set_; }
 		const ipc::BarrierPotential &barrier_potential() const { return barrier_potential_; }
@@ -155,6 +220,45 @@ namespace polyfem::solver
 		/// @param displaced_surface Vertex positions displaced by the current solution
 		void update_collision_set(const Eigen::MatrixXd &displaced_surface);
 
+		/// @brief Check if the persistent candidates contain every pair that can be in contact at the given positions
+		/// @param displaced_surface Vertex positions displaced by the current solution
+		bool are_persistent_candidates_valid(const Eigen::MatrixXd &displaced_surface) const;
+
+		/// @brief Select the persistent candidates close enough to be in contact before a vertex moves more than half of the skin
+		/// @param displaced_surface Vertex positions displaced by the current solution
+		void update_near_candidates(const Eigen::MatrixXd &displaced_surface);
+
+		/// @brief Check if the near candidates contain every pair that can be in contact at the given positions
+		/// @param displaced_surface Vertex positions displaced by the current solution
+		bool are_near_candidates_valid(const Eigen::MatrixXd &displaced_surface) const;
+
+		/// @brief Is the barrier stiffness set from the energy and barrier gradients at the next update?
+		/// Otherwise only post_step adjusts it, from the minimum distance of the collision set.
+		bool needs_initial_barrier_stiffness() const
+		{
+			return prev_distance_ == -1 && prev_distance_ == INFINITY && prev_distance_ == -INFINITY;
+		}
+
+		/// @brief Build candidates with the broad-phase method in use, or benchmark all the methods while autotuning
+		/// @param[out] candidates Built candidates
+		/// @param build Builds the candidates with the given method
+		void build_candidates(ipc::Candidates &candidates, const std::function<void(ipc::BroadPhaseMethod, ipc::Candidates &)> &build) const;
+
+		/// @brief Compute the earliest time of impact of the candidates with the CCD settings of this form
+		double compute_collision_free_stepsize(const ipc::Candidates &candidates, const Eigen::MatrixXd &V0, const Eigen::MatrixXd &V1) const
+		{
+			return compute_collision_free_stepsize(candidates, collision_mesh_, V0, V1, dmin_, ccd_tolerance_, ccd_max_iterations_, ccd_timings_);
+		}
+
+		/// @brief Update the local barrier Hessians of the collisions, reusing the cached blocks that did not move
+		/// @param displaced_surface Vertex positions displaced by the current solution
+		void update_hessian_blocks(const Eigen::MatrixXd &displaced_surface) const;
+
+		/// @brief Assemble the barrier Hessian wrt the collision mesh vertices, reusing the cached local blocks
+		/// @param displaced_surface Vertex positions displaced by the current solution
+		/// @return Hessian of the barrier potential over the surface dofs
+		const StiffnessMatrix &assemble_surface_hessian(const Eigen::MatrixXd &displaced_surface) const;
+
 		/// @brief Collision mesh
 		const ipc::CollisionMesh &collision_mesh_;
 
@@ -180,8 +284,8 @@ namespace polyfem::solver
 		/// @brief Enable shape derivatives computation
 		const bool enable_shape_derivatives_;
 
-		/// @brief Broad phase method to use for distance and CCD evaluations
-		const ipc::BroadPhaseMethod broad_phase_method_;
+		/// @brief Broad phase method to use for distance and CCD evaluations (mutable because the autotuning can change it in max_step_size)
+		mutable ipc::BroadPhaseMethod broad_phase_method_;
 		/// @brief Continuous collision detection tolerance
 		const double ccd_tolerance_;
 		/// @brief Continuous collision detection maximum iterations
@@ -197,8 +301,64 @@ namespace polyfem::solver
 		/// @brief Cached candidate set for the current solution
 		ipc::Candidates candidates_;
 
+		/// @brief Extra inflation of the persistent candidates, 0 disables them
+		double broad_phase_skin_ = 0;
+		/// @brief Candidates kept across time steps, built with a dhat + skin inflation
+		ipc::Candidates persistent_candidates_;
+		/// @brief Vertex positions used to build the persistent candidates
+		Eigen::MatrixXd persistent_candidates_surface_;
+		/// @brief Persistent candidates closer than dhat + skin, the ones the collision set is built from across
+		/// Newton iterations and time steps until a vertex moves more than half of the skin
+		ipc::Candidates near_candidates_;
+		/// @brief Vertex positions used to select the near candidates
+		Eigen::MatrixXd near_candidates_surface_;
+		/// @brief Vertex positions of the current collision set
+		Eigen::MatrixXd collision_set_surface_;
+
+		/// @brief Accumulated CCD timings (mutable because max_step_size is const)
+		mutable CCDTimings ccd_timings_;
+
+		/// @brief State of the broad-phase autotuning
+		struct BroadPhaseAutotuning
+		{
+			int trial_calls = 0;                        ///< Candidate builds every method is timed on, 0 if disabled
+			int period = 0;                             ///< Candidate builds between two benchmarks, 0 never
+			std::vector<ipc::BroadPhaseMethod> methods; ///< Benchmarked methods
+			std::vector<utils::Timing> timings;         ///< Time of the methods in the current benchmark
+			int remaining_trials = 0;                   ///< Candidate builds left in the current benchmark
+			int calls = 0;                              ///< Candidate builds since the last selection
+			int n_selections = 0;                       ///< Number of completed benchmarks
+		};
+		/// @brief Broad-phase autotuning (mutable because max_step_size is const)
+		mutable BroadPhaseAutotuning autotuning_;
+
 		const ipc::BarrierPotential barrier_potential_;
 
+		/// @brief Collision identified by its type (edge-edge or not) and vertex ids
+		using CollisionKey = std::array<long, 5>;
+
+		/// @brief Local barrier Hessian of a collision, reused while its stencil does not move
+		struct CachedHessianBlock
+		{
+			Eigen::VectorXd dof;
+			double weight = 0;
+			bool project_to_psd = false;
+			Eigen::MatrixXd hessian;
+		};
+
+		/// @brief Collisions of the last Hessian assembly
+		mutable std::vector<CollisionKey> hessian_keys_;
+		/// @brief Local Hessians of the last assembly, aligned with hessian_keys_
+		mutable std::vector<CachedHessianBlock> hessian_blocks_;
+		/// @brief Surface Hessian, its sparsity pattern is kept while the collisions do not change
+		mutable StiffnessMatrix surface_hessian_;
+		/// @brief Offsets of the entries of each collision in the values of surface_hessian_
+		mutable std::vector<std::vector<StorageIndex>> hessian_slots_;
+		/// @brief Is the sparsity pattern of surface_hessian_ the one of hessian_keys_?
+		mutable bool surface_hessian_valid_ = false;
+		/// @brief Maps the local blocks to the FE dofs, used if the displacement map is set
+		CollisionHessianAssembler full_hessian_assembler_;
+
 		// Probably should declare these as a global constant in ICP toolkit or transfer these changes to the update update_barrier_stiffness in ICP Toolkit
 		// Duplicating based on ipc/barrier/adaptive_stiffness.hpp for now
 		const double dhat_epsilon_scale = 1e-9;
@@ -5,6 +5,7 @@
 #include <polyfem/assembler/MatParams.hpp>
 #include <polyfem/utils/Timer.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
 #include <polyfem/assembler/ViscousDamping.hpp>
 
 using namespace polyfem::assembler;
@@ -50,14 +51,38 @@ namespace polyfem::solver
 		if (assembler_.is_linear())
 			compute_cached_stiffness();
 		// mat_cache_ = std::make_unique<utils::DenseMatrixCache>();
-		mat_cache_ = std::make_unique<utils::SparseMatrixCache>();
+		auto mat_cache = std::make_unique<utils::SparseMatrixCache>();
+		// the Hessians of the energies are symmetric, the Jacobians of the fluids are not
+		mat_cache->set_symmetric(!assembler_.is_fluid());
+		mat_cache_ = std::move(mat_cache);
+	}
+
+	void ElasticForm::update_quantities(const double t, const Eigen::VectorXd &x)
+	{
+		t_ = t;
+		x_prev_ = x;
+		iterate_cache_.clear();
+		last_hessian_x_.resize(0);
+
+		// the deformation gradient at x_prev is constant during the time step
+		if (const ViscousDamping *damping = dynamic_cast<const ViscousDamping *>(&assembler_))
+			damping->update_prev_def_grads(is_volume_, bases_, geom_bases_, ass_vals_cache_, x_prev_);
 	}
 
 	double ElasticForm::value_unweighted(const Eigen::VectorXd &x) const
 	{
-		return assembler_.assemble_energy(
+		if (iterate_cache_.has_energy && iterate_cache_.matches(x))
+			return iterate_cache_.energy;
+
+		const double energy = assembler_.assemble_energy(
 			is_volume_,
 			bases_, geom_bases_, ass_vals_cache_, t_, dt_, x, x_prev_);
+
+		iterate_cache_.x = x;
+		iterate_cache_.energy = energy;
+		iterate_cache_.has_energy = true;
+		iterate_cache_.has_gradient = false;
+		return energy;
 	}
 
 	Eigen::VectorXd ElasticForm::value_per_element_unweighted(const Eigen::VectorXd &x) const
@@ -70,10 +95,24 @@ namespace polyfem::solver
 
 	void ElasticForm::first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
 	{
+		if (iterate_cache_.has_gradient && iterate_cache_.matches(x))
+		{
+			gradv = iterate_cache_.gradient;
+			return;
+		}
+
+		// the energy comes with the same pass over the elements
 		Eigen::MatrixXd grad;
-		assembler_.assemble_gradient(is_volume_, n_bases_, bases_, geom_bases_,
-									 ass_vals_cache_, t_, dt_, x, x_prev_, grad);
+		const double energy = assembler_.assemble_energy_gradient(
+			is_volume_, n_bases_, bases_, geom_bases_,
+			ass_vals_cache_, t_, dt_, x, x_prev_, grad);
 		gradv = grad;
+
+		iterate_cache_.x = x;
+		iterate_cache_.energy = energy;
+		iterate_cache_.gradient = gradv;
+		iterate_cache_.has_energy = true;
+		iterate_cache_.has_gradient = true;
 	}
 
 	void ElasticForm::second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const
@@ -87,15 +126,51 @@ namespace polyfem::solver
 			assert(cached_stiffness_.rows() == x.size() && cached_stiffness_.cols() == x.size());
 			hessian = cached_stiffness_;
 		}
+		else if (keep_last_hessian_ && last_hessian_projected_ == project_to_psd_
+				 && last_hessian_x_.size() == x.size() && last_hessian_x_ == x)
+		{
+			hessian = last_hessian_;
+		}
 		else
 		{
 			// NOTE: mat_cache_ is marked as mutable so we can modify it here
 			assembler_.assemble_hessian(
 				is_volume_, n_bases_, project_to_psd_, bases_,
 				geom_bases_, ass_vals_cache_, t_, dt_, x, x_prev_, *mat_cache_, hessian);
+
+			if (keep_last_hessian_)
+			{
+				last_hessian_ = hessian;
+				last_hessian_x_ = x;
+				last_hessian_projected_ = project_to_psd_;
+			}
 		}
 	}
 
+	void ElasticForm::hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+	{
+		POLYFEM_SCOPED_TIMER("elastic hessian-vector product");
+
+		if (assembler_.is_linear())
+		{
+			assert(cached_stiffness_.rows() == x.size() && cached_stiffness_.cols() == x.size());
+			hv = cached_stiffness_ * v;
+		}
+		else
+		{
+			Eigen::MatrixXd tmp;
+			assembler_.assemble_hessian_vector_product(
+				is_volume_, n_bases_, project_to_psd_, bases_,
+				geom_bases_, ass_vals_cache_, t_, dt_, x, x_prev_, v, tmp);
+			hv = tmp;
+		}
+	}
+
+	size_t ElasticForm::memory_usage() const
+	{
+		return utils::memory_usage(cached_stiffness_) + utils::memory_usage(last_hessian_) + (mat_cache_ ? mat_cache_->memory_usage() : 0);
+	}
+
 	bool ElasticForm::is_step_valid(const Eigen::VectorXd &, const Eigen::VectorXd &x1) const
 	{
 		Eigen::VectorXd grad;
@@ -26,6 +26,10 @@ namespace polyfem::solver
 
 		std::string name() const override { return "elastic"; }
 
+		/// @brief Initialize the form, drops the energy and gradient of the previous solve
+		/// @param x Current solution
+		void init(const Eigen::VectorXd &x) override { iterate_cache_.clear(); }
+
 	protected:
 		/// @brief Compute the elastic potential value
 		/// @param x Current solution
@@ -47,6 +51,12 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
+		/// @brief Compute the product of the second derivative wrt x with v
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply the Hessian with
+		/// @param[out] hv Output product of the Hessian with v
+		void hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const override;
+
 	public:
 		/// @brief Determine if a step from solution x0 to solution x1 is allowed
 		/// @param x0 Current solution
@@ -54,13 +64,28 @@ namespace polyfem::solver
 		/// @return True if the step is allowed
 		bool is_step_valid(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const override;
 
+		/// @brief The stiffness of linear elasticity is assembled once
+		bool is_second_derivative_constant() const override { return assembler_.is_linear(); }
+
+		/// @brief Keep the last assembled Hessian, returned again if it is requested at the same solution.
+		/// Used when another form (e.g., Rayleigh damping) evaluates the Hessian at the Newton iterate.
+		void set_keep_last_hessian(const bool val)
+		{
+			keep_last_hessian_ = val;
+			last_hessian_ = StiffnessMatrix();
+			last_hessian_x_.resize(0);
+		}
+
 		/// @brief Update time-dependent fields
 		/// @param t Current time
 		/// @param x Current solution at time t
-		void update_quantities(const double t, const Eigen::VectorXd &x) override
+		void update_quantities(const double t, const Eigen::VectorXd &x) override;
+
+		/// @brief Set the time step size, used by the viscous damping
+		void set_dt(const double dt)
 		{
-			t_ = t;
-			x_prev_ = x;
+			dt_ = dt;
+			iterate_cache_.clear();
 		}
 
 		/// @brief Compute the derivative of the force wrt lame/damping parameters, then multiply the resulting matrix with adjoint_sol.
@@ -78,6 +103,9 @@ namespace polyfem::solver
 		/// @param[out] term Derivative of force multiplied by the adjoint
 		void force_shape_derivative(const double t, const int n_verts, const Eigen::MatrixXd &x, const Eigen::MatrixXd &x_prev, const Eigen::MatrixXd &adjoint, Eigen::VectorXd &term);
 
+		/// @brief Bytes allocated by the cached stiffness matrix and the Hessian assembly cache
+		size_t memory_usage() const;
+
 	private:
 		const int n_bases_;
 		const std::vector<basis::ElementBases> &bases_;
@@ -86,7 +114,7 @@ namespace polyfem::solver
 		const assembler::Assembler &assembler_; ///< Reference to the assembler
 		const assembler::AssemblyValsCache &ass_vals_cache_;
 		double t_;
-		const double dt_;
+		double dt_;
 		const bool is_volume_;
 
 		StiffnessMatrix cached_stiffness_;                      ///< Cached stiffness matrix for linear elasticity
@@ -95,6 +123,28 @@ namespace polyfem::solver
 		/// @brief Compute the stiffness matrix (cached)
 		void compute_cached_stiffness();
 
+		/// @brief Energy and gradient at the last iterate they were assembled at.
+		/// The gradient is assembled together with the energy, so that the value requested at the same
+		/// iterate (e.g., after is_step_valid in the line search or at the start of the next Newton step) is free.
+		struct IterateCache
+		{
+			Eigen::VectorXd x;
+			double energy;
+			Eigen::VectorXd gradient;
+			bool has_energy = false;
+			bool has_gradient = false;
+
+			bool matches(const Eigen::VectorXd &y) const { return x.size() == y.size() && x == y; }
+			void clear() { has_energy = has_gradient = false; }
+		};
+		mutable IterateCache iterate_cache_; ///< mutable because it is filled in value_unweighted and first_derivative_unweighted
+
 		Eigen::VectorXd x_prev_;
+
+		bool keep_last_hessian_ = false;
+		/// @brief Last assembled Hessian and the solution and projection it was assembled with (mutable because they are filled in second_derivative_unweighted)
+		mutable StiffnessMatrix last_hessian_;
+		mutable Eigen::VectorXd last_hessian_x_;
+		mutable bool last_hessian_projected_ = false;
 	};
 } // namespace polyfem::solver
@@ -53,6 +53,32 @@ namespace polyfem::solver
 			hessian *= weight();
 		}
 
+		/// @brief Compute the product of the second derivative wrt x with v, multiplied with the weigth
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply the Hessian with
+		/// @param[out] hv Output product of the Hessian with v
+		inline void hessian_vector_product(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+		{
+			hessian_vector_product_unweighted(x, v, hv);
+			hv *= weight();
+		}
+
+		/// @brief Compute the requested quantities at the same solution, multiplied with the weight
+		/// @note The default evaluates them separately, forms sharing work between them override it.
+		/// @param[in] x Current solution
+		/// @param[out] value Output value, not computed if nullptr
+		/// @param[out] gradv Output gradient of the value wrt x, not computed if nullptr
+		/// @param[out] hessian Output Hessian of the value wrt x, not computed if nullptr
+		virtual void evaluate(const Eigen::VectorXd &x, double *value, Eigen::VectorXd *gradv, StiffnessMatrix *hessian) const
+		{
+			if (gradv)
+				first_derivative(x, *gradv);
+			if (value)
+				*value = this->value(x);
+			if (hessian)
+				second_derivative(x, *hessian);
+		}
+
 		/// @brief Determine if a step from solution x0 to solution x1 is allowed
 		/// @param x0 Current solution
 		/// @param x1 Proposed next solution
@@ -104,6 +130,9 @@ namespace polyfem::solver
 		/// @return True if the form requires lagging
 		virtual bool uses_lagging() const { return false; }
 
+		/// @brief Is the second derivative independent of x (e.g., linear elasticity)?
+		virtual bool is_second_derivative_constant() const { return false; }
+
 		/// @brief Set project to psd
 		/// @param val If true, the form's second derivative is projected to be positive semidefinite
 		void set_project_to_psd(bool val) { project_to_psd_ = val; }
@@ -180,5 +209,17 @@ namespace polyfem::solver
 		/// @param[in] x Current solution
 		/// @param[out] hessian Output Hessian of the value wrt x
 		virtual void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const = 0;
+
+		/// @brief Compute the product of the second derivative wrt x with v
+		/// @note The default assembles the Hessian, forms override it to avoid storing the matrix.
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply the Hessian with
+		/// @param[out] hv Output product of the Hessian with v
+		virtual void hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+		{
+			StiffnessMatrix hessian;
+			second_derivative_unweighted(x, hessian);
+			hv = hessian * v;
+		}
 	};
 } // namespace polyfem::solver
@@ -3,9 +3,58 @@
 
 #include <polyfem/utils/Timer.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <algorithm>
+#include <iterator>
 
 namespace polyfem::solver
 {
+	namespace
+	{
+		/// builds the lagged friction collisions (closest points, tangent bases, normal forces) of one type concurrently
+		/// the collisions are not default constructible, so every chunk is built separately and they are concatenated in order
+		template <typename FrictionCollision, typename Collision>
+		void build_friction_collisions(
+			const std::vector<Collision> &collisions,
+			const ipc::CollisionMesh &mesh,
+			const Eigen::MatrixXd &vertices,
+			const ipc::BarrierPotential &barrier_potential,
+			const double barrier_stiffness,
+			const double mu,
+			std::vector<FrictionCollision> &friction_collisions)
+		{
+			typedef std::vector<std::pair<int, std::vector<FrictionCollision>>> Chunks;
+
+			auto storage = utils::create_thread_storage(Chunks());
+			utils::maybe_parallel_for(int(collisions.size()), [&](int start, int end, int thread_id) {
+				Chunks &local_chunks = utils::get_local_thread_storage(storage, thread_id);
+				local_chunks.emplace_back(start, std::vector<FrictionCollision>());
+
+				std::vector<FrictionCollision> &chunk = local_chunks.back().second;
+				chunk.reserve(end - start);
+				for (int i = start; i < end; ++i)
+				{
+					chunk.emplace_back(
+						collisions[i], collisions[i].dof(vertices, mesh.edges(), mesh.faces()),
+						barrier_potential, barrier_stiffness);
+					chunk.back().mu = mu;
+				}
+			});
+
+			Chunks chunks;
+			for (Chunks &local_chunks : storage)
+				for (auto &chunk : local_chunks)
+					chunks.push_back(std::move(chunk));
+			std::sort(chunks.begin(), chunks.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+			friction_collisions.clear();
+			friction_collisions.reserve(collisions.size());
+			for (auto &chunk : chunks)
+				std::move(chunk.second.begin(), chunk.second.end(), std::back_inserter(friction_collisions));
+		}
+	} // namespace
+
 	FrictionForm::FrictionForm(
 		const ipc::CollisionMesh &collision_mesh,
 		const std::shared_ptr<time_integrator::ImplicitTimeIntegrator> time_integrator,
@@ -118,10 +167,38 @@ namespace polyfem::solver
 	{
 		POLYFEM_SCOPED_TIMER("friction hessian");
 
-		hessian = dv_dx() * friction_potential_.hessian( //
-					  friction_collision_set_, collision_mesh_, compute_surface_velocities(x), project_to_psd_);
+		if (!full_hessian_assembler_.is_set())
+		{
+			hessian = dv_dx() * friction_potential_.hessian( //
+						  friction_collision_set_, collision_mesh_, compute_surface_velocities(x), project_to_psd_);
+
+			hessian = collision_mesh_.to_full_dof(hessian);
+			return;
+		}
+
+		// The local blocks are mapped to the FE dofs directly, without the surface Hessian
+		const Eigen::MatrixXd velocities = compute_surface_velocities(x);
+		const Eigen::MatrixXi &E = collision_mesh_.edges();
+		const Eigen::MatrixXi &F = collision_mesh_.faces();
+		const double scale = dv_dx();
+
+		std::vector<std::array<long, 4>> vertex_ids(friction_collision_set_.size());
+		std::vector<Eigen::MatrixXd> local_hessians(friction_collision_set_.size());
+		utils::maybe_parallel_for(friction_collision_set_.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const ipc::FrictionCollision &collision = friction_collision_set_[i];
+				vertex_ids[i] = collision.vertex_ids(E, F);
+				local_hessians[i] = scale * friction_potential_.hessian(collision, collision.dof(velocities, E, F), project_to_psd_);
+			}
+		});
+
+		full_hessian_assembler_.assemble(vertex_ids, local_hessians, hessian);
+	}
 
-		hessian = collision_mesh_.to_full_dof(hessian);
+	bool FrictionForm::set_displacement_map(const StiffnessMatrix &displacement_map)
+	{
+		return full_hessian_assembler_.set_displacement_map(collision_mesh_, displacement_map);
 	}
 
 	void FrictionForm::update_lagging(const Eigen::VectorXd &x, const int iter_num)
@@ -134,8 +211,23 @@ namespace polyfem::solver
 		collision_set.build(
 			collision_mesh_, displaced_surface, contact_form_.dhat(), /*dmin=*/0, broad_phase_method_);
 
-		friction_collision_set_.build(
-			collision_mesh_, displaced_surface, collision_set,
-			contact_form_.barrier_potential(), contact_form_.barrier_stiffness(), mu_);
+		// same as friction_collision_set_.build with a constant coefficient, but parallel over the collisions
+		POLYFEM_SCOPED_TIMER("build friction collisions");
+		const ipc::BarrierPotential &barrier_potential = contact_form_.barrier_potential();
+		const double barrier_stiffness = contact_form_.barrier_stiffness();
+
+		friction_collision_set_.clear();
+		build_friction_collisions(
+			collision_set.vv_collisions, collision_mesh_, displaced_surface,
+			barrier_potential, barrier_stiffness, mu_, friction_collision_set_.vv_collisions);
+		build_friction_collisions(
+			collision_set.ev_collisions, collision_mesh_, displaced_surface,
+			barrier_potential, barrier_stiffness, mu_, friction_collision_set_.ev_collisions);
+		build_friction_collisions(
+			collision_set.ee_collisions, collision_mesh_, displaced_surface,
+			barrier_potential, barrier_stiffness, mu_, friction_collision_set_.ee_collisions);
+		build_friction_collisions(
+			collision_set.fv_collisions, collision_mesh_, displaced_surface,
+			barrier_potential, barrier_stiffness, mu_, friction_collision_set_.fv_collisions);
 	}
 } // namespace polyfem::solver
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Form.hpp"
+#include "CollisionHessianAssembler.hpp"
 
 #include <polyfem/time_integrator/ImplicitTimeIntegrator.hpp>
 #include <polyfem/utils/Types.hpp>
@@ -88,6 +89,11 @@ namespace polyfem::solver
 		const ipc::FrictionCollisions &friction_collision_set() const { return friction_collision_set_; }
 		const ipc::FrictionPotential &friction_potential() const { return friction_potential_; }
 
+		/// @brief Assemble the Hessian wrt the FE dofs from the local blocks, instead of mapping the surface Hessian
+		/// @param displacement_map Displacement map the collision mesh was built with, empty if none
+		/// @return False if the map does not match the collision mesh, the surface Hessian is mapped then
+		bool set_displacement_map(const StiffnessMatrix &displacement_map);
+
 	private:
 		/// Reference to the collision mesh
 		const ipc::CollisionMesh &collision_mesh_;
@@ -105,5 +111,8 @@ namespace polyfem::solver
 		const ContactForm &contact_form_; ///< necessary to have the barrier stiffnes, maybe clean me
 
 		const ipc::FrictionPotential friction_potential_;
+
+		/// Maps the local blocks to the FE dofs, used if the displacement map is set
+		CollisionHessianAssembler full_hessian_assembler_;
 	};
 } // namespace polyfem::solver
@@ -0,0 +1,30 @@
+#include "HourglassForm.hpp"
+
+namespace polyfem::solver
+{
+	HourglassForm::HourglassForm(const StiffnessMatrix &stiffness)
+		: stiffness_(stiffness)
+	{
+		assert(stiffness.rows() == stiffness.cols());
+	}
+
+	double HourglassForm::value_unweighted(const Eigen::VectorXd &x) const
+	{
+		return 0.5 * x.dot(stiffness_ * x);
+	}
+
+	void HourglassForm::first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
+	{
+		gradv = stiffness_ * x;
+	}
+
+	void HourglassForm::second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const
+	{
+		hessian = stiffness_;
+	}
+
+	void HourglassForm::hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+	{
+		hv = stiffness_ * v;
+	}
+} // namespace polyfem::solver
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Form.hpp"
+
+#include <polyfem/utils/Types.hpp>
+
+namespace polyfem::solver
+{
+	/// @brief Hourglass control of the elements integrated with one point, the quadratic energy ½ xᵀ K x
+	/// of a constant stiffness, see assembler::HourglassStabilization
+	class HourglassForm : public Form
+	{
+	public:
+		/// @brief Construct a new Hourglass Form object
+		/// @param stiffness Hourglass stiffness
+		HourglassForm(const StiffnessMatrix &stiffness);
+
+		std::string name() const override { return "hourglass"; }
+
+	protected:
+		/// @brief Compute the value of the form
+		/// @param x Current solution
+		/// @return Computed value
+		double value_unweighted(const Eigen::VectorXd &x) const override;
+
+		/// @brief Compute the first derivative of the value wrt x
+		/// @param[in] x Current solution
+		/// @param[out] gradv Output gradient of the value wrt x
+		void first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const override;
+
+		/// @brief Compute the second derivative of the value wrt x
+		/// @param[in] x Current solution
+		/// @param[out] hessian Output Hessian of the value wrt x
+		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
+
+		/// @brief Compute the product of the second derivative wrt x with v
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply the Hessian with
+		/// @param[out] hv Output product of the Hessian with v
+		void hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const override;
+
+	private:
+		const StiffnessMatrix stiffness_; ///< Hourglass stiffness
+	};
+} // namespace polyfem::solver
@@ -0,0 +1,262 @@
+#include "ImplicitObstacleForm.hpp"
+
+#include "ContactForm.hpp"
+
+#include <polyfem/mesh/ImplicitObstacle.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Timer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace polyfem::solver
+{
+	namespace
+	{
+		/// fraction of its distance a vertex keeps at the end of the largest step, as the conservative rescaling of the CCD
+		constexpr double MAX_STEP_DISTANCE_RATIO = 0.2;
+		/// fraction of its distance below which a vertex is considered colliding
+		constexpr double COLLISION_DISTANCE_RATIO = 1e-3;
+		/// fraction of the distance bound advanced at every iteration, the interpolated distances are not exactly 1-Lipschitz
+		constexpr double ADVANCEMENT_SAFETY = 0.9;
+		constexpr int MAX_ADVANCEMENT_ITERATIONS = 100;
+	} // namespace
+
+	ImplicitObstacleForm::ImplicitObstacleForm(
+		const ipc::CollisionMesh &collision_mesh,
+		const int n_obstacle_vertices,
+		const std::vector<std::shared_ptr<const mesh::ImplicitObstacle>> &obstacles,
+		const ContactForm &contact_form)
+		: collision_mesh_(collision_mesh),
+		  n_vertices_(collision_mesh.num_vertices() - n_obstacle_vertices),
+		  obstacles_(obstacles),
+		  contact_form_(contact_form)
+	{
+		assert(n_vertices_ >= 0);
+
+		if (contact_form_.use_convergent_formulation())
+			vertex_weights_ = collision_mesh_.vertex_areas().head(n_vertices_);
+		else
+			vertex_weights_.setOnes(n_vertices_);
+	}
+
+	double ImplicitObstacleForm::weight() const
+	{
+		return weight_ * contact_form_.barrier_stiffness();
+	}
+
+	Eigen::MatrixXd ImplicitObstacleForm::compute_displaced_vertices(const Eigen::VectorXd &x) const
+	{
+		return collision_mesh_.displace_vertices(utils::unflatten(x, collision_mesh_.dim())).topRows(n_vertices_);
+	}
+
+	const ImplicitObstacleForm::Distances &ImplicitObstacleForm::distances(const Eigen::MatrixXd &V) const
+	{
+		if (cached_vertices_.rows() == V.rows() && cached_vertices_.cols() == V.cols() && cached_vertices_ == V)
+			return cached_distances_;
+
+		POLYFEM_SCOPED_TIMER("implicit obstacle distances");
+		cached_distances_.values.resize(V.rows(), obstacles_.size());
+		cached_distances_.grads.resize(obstacles_.size());
+		for (int o = 0; o < obstacles_.size(); ++o)
+		{
+			Eigen::VectorXd values;
+			obstacles_[o]->distance(V, values, cached_distances_.grads[o]);
+			cached_distances_.values.col(o) = values;
+		}
+		cached_vertices_ = V;
+
+		return cached_distances_;
+	}
+
+	void ImplicitObstacleForm::solution_changed(const Eigen::VectorXd &new_x)
+	{
+		distances(compute_displaced_vertices(new_x));
+	}
+
+	double ImplicitObstacleForm::value_unweighted(const Eigen::VectorXd &x) const
+	{
+		const Distances &dist = distances(compute_displaced_vertices(x));
+		const ipc::Barrier &barrier = contact_form_.barrier_potential().barrier();
+		const double dhat = contact_form_.dhat();
+
+		// the barrier is evaluated on the squared distances, as for the collisions of the contact form
+		auto storage = utils::create_thread_storage<double>(0.0);
+		utils::maybe_parallel_for(n_vertices_, [&](int start, int end, int thread_id) {
+			double &local_value = utils::get_local_thread_storage(storage, thread_id);
+			for (int i = start; i < end; ++i)
+			{
+				for (int o = 0; o < obstacles_.size(); ++o)
+				{
+					const double d = dist.values(i, o);
+					if (d >= dhat)
+						continue;
+					local_value += d > 0 ? vertex_weights_(i) * barrier(d * d, dhat * dhat) : std::numeric_limits<double>::infinity();
+				}
+			}
+		});
+
+		double value = 0;
+		for (const double local_value : storage)
+			value += local_value;
+		return value;
+	}
+
+	void ImplicitObstacleForm::first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
+	{
+		const Distances &dist = distances(compute_displaced_vertices(x));
+		const ipc::Barrier &barrier = contact_form_.barrier_potential().barrier();
+		const double dhat = contact_form_.dhat();
+		const int dim = collision_mesh_.dim();
+
+		// ∇b(d²) = 2 d b'(d²) ∇d
+		Eigen::VectorXd grad = Eigen::VectorXd::Zero(collision_mesh_.num_vertices() * dim);
+		utils::maybe_parallel_for(n_vertices_, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				for (int o = 0; o < obstacles_.size(); ++o)
+				{
+					const double d = dist.values(i, o);
+					if (d >= dhat || d <= 0)
+						continue;
+					grad.segment(i * dim, dim) += vertex_weights_(i) * 2 * d * barrier.first_derivative(d * d, dhat * dhat) * dist.grads[o].row(i).transpose();
+				}
+			}
+		});
+
+		gradv = collision_mesh_.to_full_dof(grad);
+	}
+
+	void ImplicitObstacleForm::second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const
+	{
+		POLYFEM_SCOPED_TIMER("implicit obstacle hessian");
+		const Distances &dist = distances(compute_displaced_vertices(x));
+		const ipc::Barrier &barrier = contact_form_.barrier_potential().barrier();
+		const double dhat = contact_form_.dhat();
+		const int dim = collision_mesh_.dim();
+
+		// ∇²b(d²) ≈ (4 d² b''(d²) + 2 b'(d²)) ∇d ∇dᵀ, without the curvature term 2 d b'(d²) ∇²d
+		std::vector<Eigen::MatrixXd> blocks(n_vertices_);
+		utils::maybe_parallel_for(n_vertices_, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				for (int o = 0; o < obstacles_.size(); ++o)
+				{
+					const double d = dist.values(i, o);
+					if (d >= dhat || d <= 0)
+						continue;
+
+					double coeff = 4 * d * d * barrier.second_derivative(d * d, dhat * dhat) + 2 * barrier.first_derivative(d * d, dhat * dhat);
+					if (project_to_psd_)
+						coeff = std::max(coeff, 0.0);
+					if (coeff == 0)
+						continue;
+
+					const Eigen::VectorXd g = dist.grads[o].row(i).transpose();
+					if (blocks[i].size() == 0)
+						blocks[i].setZero(dim, dim);
+					blocks[i] += vertex_weights_(i) * coeff * g * g.transpose();
+				}
+			}
+		});
+
+		std::vector<Eigen::Triplet<double>> triplets;
+		for (int i = 0; i < n_vertices_; ++i)
+		{
+			if (blocks[i].size() == 0)
+				continue;
+			for (int r = 0; r < dim; ++r)
+				for (int c = 0; c < dim; ++c)
+					triplets.emplace_back(i * dim + r, i * dim + c, blocks[i](r, c));
+		}
+
+		const int ndof = collision_mesh_.num_vertices() * dim;
+		StiffnessMatrix surface_hessian(ndof, ndof);
+		surface_hessian.setFromTriplets(triplets.begin(), triplets.end());
+		hessian = collision_mesh_.to_full_dof(surface_hessian);
+	}
+
+	double ImplicitObstacleForm::max_step_size(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const
+	{
+		return compute_earliest_toi(compute_displaced_vertices(x0), compute_displaced_vertices(x1), MAX_STEP_DISTANCE_RATIO);
+	}
+
+	bool ImplicitObstacleForm::is_step_collision_free(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const
+	{
+		return compute_earliest_toi(compute_displaced_vertices(x0), compute_displaced_vertices(x1), COLLISION_DISTANCE_RATIO) >= 1;
+	}
+
+	double ImplicitObstacleForm::compute_earliest_toi(const Eigen::MatrixXd &V0, const Eigen::MatrixXd &V1, const double stop_ratio) const
+	{
+		POLYFEM_SCOPED_TIMER("implicit obstacle ccd");
+		const Eigen::MatrixXd dV = V1 - V0;
+		const Eigen::VectorXd motion = dV.rowwise().norm();
+		const Distances &dist0 = distances(V0);
+
+		double earliest_toi = 1;
+		for (int o = 0; o < obstacles_.size(); ++o)
+		{
+			// Only the vertices moving more than their distance to the stopping distance can reach it
+			std::vector<int> active;
+			for (int i = 0; i < n_vertices_; ++i)
+			{
+				const double d = dist0.values(i, o);
+				if (d <= 0)
+					return 0;
+				if (motion(i) > 0 && d - motion(i) < stop_ratio * d)
+					active.push_back(i);
+			}
+
+			// Conservative advancement of all the active vertices together, one batch of distance queries per iteration
+			Eigen::VectorXd t = Eigen::VectorXd::Zero(active.size());
+			Eigen::VectorXd d = Eigen::VectorXd::Zero(active.size());
+			for (int k = 0; k < active.size(); ++k)
+				d(k) = dist0.values(active[k], o);
+
+			for (int iter = 0; iter < MAX_ADVANCEMENT_ITERATIONS && !active.empty(); ++iter)
+			{
+				int n_remaining = 0;
+				for (int k = 0; k < active.size(); ++k)
+				{
+					const int i = active[k];
+					const double stop_distance = stop_ratio * dist0.values(i, o);
+					const double gap = d(k) - stop_distance;
+					if (gap <= 0.1 * stop_distance)
+					{
+						earliest_toi = std::min(earliest_toi, t(k));
+						continue;
+					}
+
+					const double next_t = t(k) + ADVANCEMENT_SAFETY * gap / motion(i);
+					// safe until the earliest impact found so far
+					if (next_t >= earliest_toi)
+						continue;
+
+					active[n_remaining] = i;
+					t(n_remaining) = next_t;
+					++n_remaining;
+				}
+				active.resize(n_remaining);
+				t.conservativeResize(n_remaining);
+				if (active.empty())
+					break;
+
+				Eigen::MatrixXd points(n_remaining, V0.cols());
+				for (int k = 0; k < n_remaining; ++k)
+					points.row(k) = V0.row(active[k]) + t(k) * dV.row(active[k]);
+
+				Eigen::MatrixXd unused_grads;
+				obstacles_[o]->distance(points, d, unused_grads);
+			}
+
+			// Vertices still advancing are stopped where they are
+			for (int k = 0; k < active.size(); ++k)
+				earliest_toi = std::min(earliest_toi, t(k));
+		}
+
+		assert(earliest_toi >= 0 && earliest_toi <= 1);
+		return earliest_toi;
+	}
+} // namespace polyfem::solver
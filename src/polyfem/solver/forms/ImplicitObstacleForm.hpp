@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Form.hpp"
+
+#include <polyfem/utils/Types.hpp>
+
+#include <ipc/collision_mesh.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace polyfem::mesh
+{
+	class ImplicitObstacle;
+} // namespace polyfem::mesh
+
+namespace polyfem::solver
+{
+	class ContactForm;
+
+	/// @brief Barrier between the collision vertices and static obstacles represented by their distance function.
+	///
+	/// The obstacles are not part of the collision mesh: the distances of all the vertices are evaluated in
+	/// batches, without broad phase, and the step size is bounded by conservative advancement along the
+	/// distance function. The barrier, dhat and stiffness are the ones of the contact form. Only the vertices
+	/// collide with the obstacles, the edges and faces can go through their sharp features.
+	class ImplicitObstacleForm : public Form
+	{
+	public:
+		/// @brief Construct a new Implicit Obstacle Form object
+		/// @param collision_mesh Collision mesh, its last n_obstacle_vertices vertices belong to the mesh obstacles and are ignored
+		/// @param n_obstacle_vertices Number of vertices of the mesh obstacles in the collision mesh
+		/// @param obstacles Implicit obstacles
+		/// @param contact_form Contact form the barrier and its stiffness are taken from
+		ImplicitObstacleForm(
+			const ipc::CollisionMesh &collision_mesh,
+			const int n_obstacle_vertices,
+			const std::vector<std::shared_ptr<const mesh::ImplicitObstacle>> &obstacles,
+			const ContactForm &contact_form);
+
+		std::string name() const override { return "implicit-obstacle"; }
+
+		/// @brief The weight is scaled by the barrier stiffness of the contact form
+		double weight() const override;
+
+		void solution_changed(const Eigen::VectorXd &new_x) override;
+
+		/// @brief Largest step keeping every vertex farther than a fraction of its current distance to the obstacles
+		double max_step_size(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const override;
+
+		bool is_step_collision_free(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const override;
+
+	protected:
+		double value_unweighted(const Eigen::VectorXd &x) const override;
+
+		void first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const override;
+
+		/// @note The curvature of the distance is neglected, the blocks are exact for planes
+		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
+
+	private:
+		/// @brief Distances of the vertices to the obstacles
+		struct Distances
+		{
+			Eigen::MatrixXd values;            ///< #vertices × #obstacles
+			std::vector<Eigen::MatrixXd> grads; ///< per obstacle, #vertices × dim
+		};
+
+		/// @brief Positions of the colliding vertices displaced by x, one per row
+		Eigen::MatrixXd compute_displaced_vertices(const Eigen::VectorXd &x) const;
+
+		/// @brief Distances at the given positions, reused while the positions do not change
+		const Distances &distances(const Eigen::MatrixXd &V) const;
+
+		/// @brief Earliest time at which a vertex gets closer to an obstacle than stop_ratio times its distance at V0
+		/// @param V0 Vertex positions at the start of the step
+		/// @param V1 Vertex positions at the end of the step
+		/// @param stop_ratio Fraction of the initial distance
+		/// @return Time of impact in [0, 1]
+		double compute_earliest_toi(const Eigen::MatrixXd &V0, const Eigen::MatrixXd &V1, const double stop_ratio) const;
+
+		const ipc::CollisionMesh &collision_mesh_;
+		/// @brief Number of colliding vertices, the first ones of the collision mesh
+		const int n_vertices_;
+		const std::vector<std::shared_ptr<const mesh::ImplicitObstacle>> obstacles_;
+		const ContactForm &contact_form_;
+
+		/// @brief Weight of every vertex, its area with the convergent formulation
+		Eigen::VectorXd vertex_weights_;
+
+		mutable Eigen::MatrixXd cached_vertices_;
+		mutable Distances cached_distances_;
+	};
+} // namespace polyfem::solver
@@ -36,20 +36,39 @@ namespace polyfem::solver
 		: mass_(mass), time_integrator_(time_integrator)
 	{
 		assert(mass.size() != 0);
+
+		bool is_diagonal = true;
+		for (int k = 0; k < mass_.outerSize() && is_diagonal; ++k)
+		{
+			for (StiffnessMatrix::InnerIterator it(mass_, k); it; ++it)
+			{
+				if (it.row() != it.col())
+				{
+					is_diagonal = false;
+					break;
+				}
+			}
+		}
+
+		if (is_diagonal)
+			lumped_mass_ = mass_.diagonal();
 	}
 
 	double InertiaForm::value_unweighted(const Eigen::VectorXd &x) const
 	{
 		const Eigen::VectorXd tmp = x - time_integrator_.x_tilde();
 		// FIXME: DBC on x tilde
-		const double prod = tmp.transpose() * mass_ * tmp;
+		const double prod = is_lumped() ? tmp.dot(lumped_mass_.cwiseProduct(tmp)) : double(tmp.transpose() * mass_ * tmp);
 		const double energy = 0.5 * prod;
 		return energy;
 	}
 
 	void InertiaForm::first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
 	{
-		gradv = mass_ * (x - time_integrator_.x_tilde());
+		if (is_lumped())
+			gradv = lumped_mass_.cwiseProduct(x - time_integrator_.x_tilde());
+		else
+			gradv = mass_ * (x - time_integrator_.x_tilde());
 	}
 
 	void InertiaForm::second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const
@@ -57,6 +76,14 @@ namespace polyfem::solver
 		hessian = mass_;
 	}
 
+	void InertiaForm::hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+	{
+		if (is_lumped())
+			hv = lumped_mass_.cwiseProduct(v);
+		else
+			hv = mass_ * v;
+	}
+
 	void InertiaForm::force_shape_derivative(
 		bool is_volume,
 		const int n_geom_bases,
@@ -26,6 +26,7 @@ namespace polyfem::solver
 	{
 	public:
 		/// @brief Construct a new Inertia Form object
+		/// @note If the mass matrix is diagonal (e.g., lumped), only its diagonal is used for the value and gradient.
 		/// @param mass Mass matrix
 		/// @param time_integrator Time integrator
 		InertiaForm(const StiffnessMatrix &mass,
@@ -33,6 +34,9 @@ namespace polyfem::solver
 
 		std::string name() const override { return "inertia"; }
 
+		/// @brief Is the mass matrix diagonal (i.e., lumped)?
+		bool is_lumped() const { return lumped_mass_.size() > 0; }
+
 		static void force_shape_derivative(
 			bool is_volume,
 			const int n_geom_bases,
@@ -61,9 +65,17 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
+		/// @brief Compute the product of the second derivative wrt x with v
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply the Hessian with
+		/// @param[out] hv Output product of the Hessian with v
+		void hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const override;
+
 	private:
 		// TODO mass might be time dependent
 		const StiffnessMatrix &mass_;                                    ///< Mass matrix
 		const time_integrator::ImplicitTimeIntegrator &time_integrator_; ///< Time integrator
+
+		Eigen::VectorXd lumped_mass_; ///< Diagonal of the mass matrix if it is diagonal, empty otherwise
 	};
 } // namespace polyfem::solver
@@ -9,6 +9,8 @@
 #include <ipc/utils/local_to_global.hpp>
 #include <ipc/utils/eigen_ext.hpp>
 
+#include <atomic>
+
 namespace polyfem::solver
 {
 	InversionBarrierForm::InversionBarrierForm(
@@ -174,15 +176,36 @@ namespace polyfem::solver
 	{
 		const Eigen::MatrixXd V = rest_positions_ + utils::unflatten(x1, dim_);
 
-		for (size_t i = 0; i < elements_.rows(); ++i)
-		{
-			// TODO: use exact predicate for this
-			if (element_volume(V(elements_.row(i), Eigen::all)) <= 0)
+		// Checked on every line search trial: stop all threads at the first inverted element
+		std::atomic<bool> valid(true);
+
+		utils::maybe_parallel_for(elements_.rows(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end && valid.load(std::memory_order_relaxed); ++i)
 			{
-				return false;
+				// TODO: use exact predicate for this
+				if (signed_volume(V, i) <= 0)
+					valid.store(false, std::memory_order_relaxed);
 			}
+		});
+
+		return valid;
+	}
+
+	double InversionBarrierForm::signed_volume(const Eigen::MatrixXd &V, const int e) const
+	{
+		const auto element = elements_.row(e);
+		if (element.size() == 3)
+		{
+			assert(V.cols() == 2);
+			const Eigen::Vector2d e0 = V.row(element(1)) - V.row(element(0));
+			const Eigen::Vector2d e1 = V.row(element(2)) - V.row(element(0));
+			return 0.5 * (e0.x() * e1.y() - e0.y() * e1.x());
 		}
 
-		return true;
+		assert(element.size() == 4 && V.cols() == 3);
+		const Eigen::Vector3d e0 = V.row(element(1)) - V.row(element(0));
+		const Eigen::Vector3d e1 = V.row(element(2)) - V.row(element(0));
+		const Eigen::Vector3d e2 = V.row(element(3)) - V.row(element(0));
+		return e0.cross(e1).dot(e2) / 6.0;
 	}
 } // namespace polyfem::solver
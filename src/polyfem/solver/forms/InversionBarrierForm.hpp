@@ -44,6 +44,9 @@ namespace polyfem::solver
 		static Eigen::MatrixXd element_volume_hessian(const Eigen::MatrixXd &element_vertices);
 
 	private:
+		/// signed volume of element e without gathering its vertices, same as element_volume(V(elements_.row(e), Eigen::all))
+		double signed_volume(const Eigen::MatrixXd &V, const int e) const;
+
 		Eigen::MatrixXd rest_positions_;
 		Eigen::MatrixXi elements_;
 		int dim_;
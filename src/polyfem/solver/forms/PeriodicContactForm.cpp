@@ -32,12 +32,29 @@ namespace polyfem::solver
         //     collision_mesh_.edges(), collision_mesh_.faces());
     }
 
+    void PeriodicContactForm::hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+    {
+        update_projection();
+
+        Eigen::VectorXd hv_full;
+        ContactForm::hessian_vector_product_unweighted(single_to_tiled(x), proj_transpose * v, hv_full);
+        hv = proj * hv_full;
+    }
+
     void PeriodicContactForm::update_projection() const
     {
-        const int dim = collision_mesh_.dim();
         const auto &boundary_vertices = collision_mesh_.rest_positions();
+        // the projection only depends on the rest positions, rebuilt if the tiled mesh was updated in place
+        if (proj.size() > 0
+            && proj_rest_positions.rows() == boundary_vertices.rows()
+            && proj_rest_positions.cols() == boundary_vertices.cols()
+            && proj_rest_positions == boundary_vertices)
+            return;
+
+        const int dim = collision_mesh_.dim();
 
         std::vector<Eigen::Triplet<double>> entries;
+        entries.reserve(collision_mesh_.num_vertices() * (dim + dim * dim));
         for (int i = 0; i < collision_mesh_.num_vertices(); i++)
         {
             const int i_full = collision_mesh_.to_full_vertex_id(i);
@@ -52,49 +69,22 @@ namespace polyfem::solver
         proj.resize(n_single_dof_ * dim + dim * dim, tiled_to_single_.size() * dim);
         proj.setZero();
         proj.setFromTriplets(entries.begin(), entries.end());
+        proj_transpose = proj.transpose();
+        proj_rest_positions = boundary_vertices;
     }
 
     Eigen::VectorXd PeriodicContactForm::single_to_tiled(const Eigen::VectorXd &x) const
     {
-        const int dim = collision_mesh_.dim();
-        const auto &boundary_vertices = collision_mesh_.rest_positions();
-        assert(x.size() == n_single_dof_ * dim + dim * dim);
-
-        Eigen::VectorXd tiled_x;
-        tiled_x.setZero(tiled_to_single_.size() * dim);
-        for (int i = 0; i < collision_mesh_.num_vertices(); i++)
-        {
-            const int i_full = collision_mesh_.to_full_vertex_id(i);
-            for (int d = 0; d < dim; d++)
-                tiled_x(i_full * dim + d) += x(tiled_to_single_(i_full) * dim + d);
-            
-            for (int p = 0; p < dim; p++)
-                for (int q = 0; q < dim; q++)
-                    tiled_x(i_full * dim + p) += x(n_single_dof_ * dim + p * dim + q) * boundary_vertices(i, q);
-        }
-
-        return tiled_x;
+        assert(x.size() == n_single_dof_ * collision_mesh_.dim() + collision_mesh_.dim() * collision_mesh_.dim());
+        update_projection();
+        return proj_transpose * x;
     }
+
     Eigen::VectorXd PeriodicContactForm::tiled_to_single_grad(const Eigen::VectorXd &grad) const
     {
-        const int dim = collision_mesh_.dim();
-        const auto &boundary_vertices = collision_mesh_.rest_positions();
-        assert(grad.size() == tiled_to_single_.size() * dim);
-
-        Eigen::VectorXd reduced_grad;
-        reduced_grad.setZero(n_single_dof_ * dim + dim * dim);
-        for (int i = 0; i < collision_mesh_.num_vertices(); i++)
-        {
-            const int i_full = collision_mesh_.to_full_vertex_id(i);
-            for (int d = 0; d < dim; d++)
-                reduced_grad(tiled_to_single_(i_full) * dim + d) += grad(i_full * dim + d);
-            
-            for (int p = 0; p < dim; p++)
-                for (int q = 0; q < dim; q++)
-                    reduced_grad(n_single_dof_ * dim + p * dim + q) += boundary_vertices(i, q) * grad(i_full * dim + p);
-        }
-
-        return reduced_grad;
+        assert(grad.size() == tiled_to_single_.size() * collision_mesh_.dim());
+        update_projection();
+        return proj * grad;
     }
 
     void PeriodicContactForm::init(const Eigen::VectorXd &x)
@@ -119,7 +109,7 @@ namespace polyfem::solver
         ContactForm::second_derivative_unweighted(single_to_tiled(x), hessian_full);
         
         update_projection();
-        hessian = proj * hessian_full * proj.transpose();
+        hessian = proj * hessian_full * proj_transpose;
 
         // const Eigen::MatrixXd displaced = collision_mesh_.displace_vertices(utils::unflatten(single_to_tiled(x), collision_mesh_.dim()));
 
@@ -160,8 +150,8 @@ namespace polyfem::solver
         return ContactForm::is_step_collision_free(single_to_tiled(x0), single_to_tiled(x1));
     }
 
-    void PeriodicContactForm::update_barrier_stiffness(const Eigen::VectorXd &x, const Eigen::MatrixXd &grad_energy) 
+    void PeriodicContactForm::update_barrier_stiffness(const Eigen::VectorXd &x, const std::function<Eigen::VectorXd()> &grad_energy) 
     {
-        ContactForm::update_barrier_stiffness(single_to_tiled(x), single_to_tiled(grad_energy));
+        ContactForm::update_barrier_stiffness(single_to_tiled(x), [&]() { return single_to_tiled(grad_energy()); });
     }
 }
\ No newline at end of file
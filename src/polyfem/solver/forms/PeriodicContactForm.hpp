@@ -52,6 +52,12 @@ namespace polyfem::solver
 		/// @param hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
+		/// @brief Compute the product of the second derivative wrt x with v
+		/// @param[in] x Current solution
+		/// @param[in] v Vector to multiply the Hessian with
+		/// @param[out] hv Output product of the Hessian with v
+		void hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const override;
+
     public:
 		/// @brief Update time-dependent fields
 		/// @param t Current time
@@ -84,13 +90,18 @@ namespace polyfem::solver
 
 		/// @brief Update the barrier stiffness based on the current elasticity energy
 		/// @param x Current solution
-		void update_barrier_stiffness(const Eigen::VectorXd &x, const Eigen::MatrixXd &grad_energy) override;
+		void update_barrier_stiffness(const Eigen::VectorXd &x, const std::function<Eigen::VectorXd()> &grad_energy) override;
 
     private:
+		/// @brief Build the map from the tiled to the periodic dofs, only if the rest positions changed
 		void update_projection() const;
 
         const Eigen::VectorXi tiled_to_single_;
 		const int n_single_dof_;
+		/// periodic dofs × tiled dofs, its transpose maps the periodic solution to the tiled mesh
 		mutable StiffnessMatrix proj;
+		mutable StiffnessMatrix proj_transpose;
+		/// rest positions the projection was built for
+		mutable Eigen::MatrixXd proj_rest_positions;
     };
 }
\ No newline at end of file
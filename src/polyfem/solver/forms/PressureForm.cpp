@@ -51,12 +51,29 @@ namespace polyfem::solver
 	}
 
 	void PressureForm::second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const
+	{
+		pressure_assembler_.compute_energy_hess(x, local_pressure_boundary_, dirichlet_nodes_, n_boundary_samples_, t_, project_to_psd_, hessian);
+		if (!local_pressure_cavity_.empty())
+		{
+			StiffnessMatrix pressure_cavity_hessian;
+			pressure_assembler_.compute_cavity_energy_hess(x, local_pressure_cavity_, dirichlet_nodes_, n_boundary_samples_, t_, project_to_psd_, pressure_cavity_hessian);
+			hessian += pressure_cavity_hessian;
+		}
+		hessian *= -1;
+	}
+
+	void PressureForm::hessian_vector_product_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
 	{
 		StiffnessMatrix pressure_hessian, pressure_cavity_hessian;
+		Eigen::MatrixXd U;
+		Eigen::VectorXd coeffs;
 		pressure_assembler_.compute_energy_hess(x, local_pressure_boundary_, dirichlet_nodes_, n_boundary_samples_, t_, project_to_psd_, pressure_hessian);
-		pressure_assembler_.compute_cavity_energy_hess(x, local_pressure_cavity_, dirichlet_nodes_, n_boundary_samples_, t_, project_to_psd_, pressure_cavity_hessian);
-		hessian = pressure_hessian + pressure_cavity_hessian;
-		hessian *= -1;
+		pressure_assembler_.compute_cavity_energy_hess(x, local_pressure_cavity_, dirichlet_nodes_, n_boundary_samples_, t_, project_to_psd_, pressure_cavity_hessian, U, coeffs);
+
+		hv = pressure_hessian * v + pressure_cavity_hessian * v;
+		if (U.cols() > 0)
+			hv += U * (coeffs.array() * (U.transpose() * v).array()).matrix();
+		hv *= -1;
 	}
 
 	void PressureForm::update_quantities(const double t, const Eigen::VectorXd &x)
@@ -33,6 +33,10 @@ namespace polyfem::solver
 		if (form_to_damp == nullptr)
 			log_and_throw_error("Cannot use Rayleigh damping on {0} form because {0} is disabled", form_name);
 
+		// the damping evaluates the Hessian at the iterate Newton assembles it at next
+		if (std::shared_ptr<ElasticForm> elastic_form = std::dynamic_pointer_cast<ElasticForm>(form_to_damp))
+			elastic_form->set_keep_last_hessian(true);
+
 		const bool use_stiffness_as_ratio = params.contains("stiffness_ratio");
 		const double stiffness = use_stiffness_as_ratio ? params["stiffness_ratio"] : params["stiffness"];
 
@@ -66,6 +70,10 @@ namespace polyfem::solver
 
 	void RayleighDampingForm::update_lagging(const Eigen::VectorXd &x, const int iter_num)
 	{
+		// the damping matrix of a constant stiffness is assembled once
+		if (form_to_damp_.is_second_derivative_constant() && lagged_stiffness_matrix_.rows() == x.size())
+			return;
+
 		form_to_damp_.second_derivative(x, lagged_stiffness_matrix_);
 		// Divide by form_to_damp_.weight() to cancel out the weighting in form_to_damp_.second_derivative
 		lagged_stiffness_matrix_ /= form_to_damp_.weight();
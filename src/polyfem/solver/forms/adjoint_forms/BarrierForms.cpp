@@ -38,6 +38,36 @@ namespace polyfem::solver
 
 	} // namespace
 
+	bool PersistentCandidates::is_valid(const Eigen::MatrixXd &displaced_surface) const
+	{
+		if (skin_ <= 0 || displaced_surface.rows() == 0
+			|| surface_.rows() != displaced_surface.rows()
+			|| surface_.cols() != displaced_surface.cols())
+			return false;
+
+		// Pairs missing from the candidates were farther than the activation distance + skin,
+		// if every vertex moved less than skin / 2 they are still farther than the activation distance
+		const double max_motion = (displaced_surface - surface_).rowwise().norm().maxCoeff();
+		return max_motion <= skin_ / 2;
+	}
+
+	const ipc::Candidates &PersistentCandidates::update(
+		const ipc::CollisionMesh &collision_mesh,
+		const Eigen::MatrixXd &displaced_surface,
+		const double activation_distance,
+		const ipc::BroadPhaseMethod broad_phase_method)
+	{
+		if (!is_valid(displaced_surface))
+		{
+			candidates_.build(
+				collision_mesh, displaced_surface,
+				/*inflation_radius=*/(activation_distance + skin_) / 2,
+				broad_phase_method);
+			surface_ = displaced_surface;
+		}
+		return candidates_;
+	}
+
 	CollisionBarrierForm::CollisionBarrierForm(const VariableToSimulationGroup &variable_to_simulation, const State &state, const double dhat, const double dmin)
 		: AdjointForm(variable_to_simulation), state_(state), dhat_(dhat), dmin_(dmin), barrier_potential_(dhat)
 	{
@@ -52,11 +82,12 @@ namespace polyfem::solver
 		X_init = utils::flatten(V);
 
 		broad_phase_method_ = ipc::BroadPhaseMethod::HASH_GRID;
+		persistent_candidates_.set_skin(dhat_);
 	}
 
 	double CollisionBarrierForm::value_unweighted(const Eigen::VectorXd &x) const
 	{
-		const Eigen::MatrixXd displaced_surface = collision_mesh_.vertices(utils::unflatten(get_updated_mesh_nodes(x), state_.mesh->dimension()));
+		const Eigen::MatrixXd displaced_surface = compute_displaced_surface(x);
 		return barrier_potential_(collision_set, collision_mesh_, displaced_surface);
 	}
 
@@ -64,7 +95,7 @@ namespace polyfem::solver
 	{
 
 		gradv = weight() * variable_to_simulations_.apply_parametrization_jacobian(ParameterType::Shape, &state_, x, [this, &x]() {
-			const Eigen::MatrixXd displaced_surface = collision_mesh_.vertices(utils::unflatten(get_updated_mesh_nodes(x), state_.mesh->dimension()));
+			const Eigen::MatrixXd displaced_surface = compute_displaced_surface(x);
 			const Eigen::VectorXd grad = collision_mesh_.to_full_dof(barrier_potential_.gradient(collision_set, collision_mesh_, displaced_surface));
 			return AdjointTools::map_node_to_primitive_order(state_, grad);
 		});
@@ -74,54 +105,94 @@ namespace polyfem::solver
 	{
 		AdjointForm::solution_changed(x);
 
-		const Eigen::MatrixXd displaced_surface = collision_mesh_.vertices(utils::unflatten(get_updated_mesh_nodes(x), state_.mesh->dimension()));
-		build_collision_set(displaced_surface);
+		build_collision_set(compute_displaced_surface(x));
 	}
 
 	bool CollisionBarrierForm::is_step_collision_free(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const
 	{
-		const Eigen::MatrixXd V0 = utils::unflatten(get_updated_mesh_nodes(x0), state_.mesh->dimension());
-		const Eigen::MatrixXd V1 = utils::unflatten(get_updated_mesh_nodes(x1), state_.mesh->dimension());
+		const Eigen::MatrixXd V0 = compute_displaced_surface(x0);
+		const Eigen::MatrixXd V1 = compute_displaced_surface(x1);
 
 		// Skip CCD if the displacement is zero.
 		if ((V1 - V0).lpNorm<Eigen::Infinity>() == 0.0)
 			return true;
 
-		bool is_valid = ipc::is_step_collision_free(
-			collision_mesh_,
-			collision_mesh_.vertices(V0),
-			collision_mesh_.vertices(V1),
-			broad_phase_method_,
-			1e-6, 1e6);
+		ipc::Candidates candidates;
+		bool is_valid = step_candidates(V0, V1, candidates).is_step_collision_free(
+			collision_mesh_, V0, V1, dmin_, 1e-6, 1e6);
 
 		return is_valid;
 	}
 
 	double CollisionBarrierForm::max_step_size(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const
 	{
-		const Eigen::MatrixXd V0 = utils::unflatten(get_updated_mesh_nodes(x0), state_.mesh->dimension());
-		const Eigen::MatrixXd V1 = utils::unflatten(get_updated_mesh_nodes(x1), state_.mesh->dimension());
+		const Eigen::MatrixXd V0 = compute_displaced_surface(x0);
+		const Eigen::MatrixXd V1 = compute_displaced_surface(x1);
 
-		double max_step = ipc::compute_collision_free_stepsize(
-			collision_mesh_,
-			collision_mesh_.vertices(V0),
-			collision_mesh_.vertices(V1),
-			broad_phase_method_, dmin_, 1e-6, 1e6);
+		ipc::Candidates candidates;
+		double max_step = ContactForm::compute_collision_free_stepsize(
+			step_candidates(V0, V1, candidates), collision_mesh_, V0, V1,
+			dmin_, 1e-6, 1e6, ccd_timings_);
 
 		adjoint_logger().info("Objective {}: max step size is {}.", name(), max_step);
 
 		return max_step;
 	}
 
+	void CollisionBarrierForm::line_search_begin(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1)
+	{
+		const Eigen::MatrixXd V0 = compute_displaced_surface(x0);
+		const Eigen::MatrixXd V1 = compute_displaced_surface(x1);
+
+		if (persistent_candidates_.is_valid(V0) && persistent_candidates_.is_valid(V1))
+			candidates_ = persistent_candidates_.candidates();
+		else
+		{
+			POLYFEM_SCOPED_TIMER(ccd_timings_.broad_phase);
+			candidates_.build(
+				collision_mesh_, V0, V1,
+				/*inflation_radius=*/(dhat_ + dmin_) / 2,
+				broad_phase_method_);
+		}
+
+		use_cached_candidates_ = true;
+	}
+
+	void CollisionBarrierForm::line_search_end()
+	{
+		candidates_.clear();
+		use_cached_candidates_ = false;
+	}
+
+	const ipc::Candidates &CollisionBarrierForm::step_candidates(const Eigen::MatrixXd &V0, const Eigen::MatrixXd &V1, ipc::Candidates &candidates) const
+	{
+		if (use_cached_candidates_)
+			return candidates_;
+		// the linear trajectory stays within the skin of the persistent candidates
+		if (persistent_candidates_.is_valid(V0) && persistent_candidates_.is_valid(V1))
+			return persistent_candidates_.candidates();
+
+		POLYFEM_SCOPED_TIMER(ccd_timings_.broad_phase);
+		candidates.build(
+			collision_mesh_, V0, V1,
+			/*inflation_radius=*/dmin_ / 2,
+			broad_phase_method_);
+		return candidates;
+	}
+
 	void CollisionBarrierForm::build_collision_set(const Eigen::MatrixXd &displaced_surface)
 	{
-		static Eigen::MatrixXd cached_displaced_surface;
-		if (cached_displaced_surface.size() == displaced_surface.size() && cached_displaced_surface == displaced_surface)
+		if (cached_displaced_surface_.size() == displaced_surface.size() && cached_displaced_surface_ == displaced_surface)
 			return;
 
-		collision_set.build(collision_mesh_, displaced_surface, dhat_, dmin_, broad_phase_method_);
+		if (use_cached_candidates_)
+			collision_set.build(candidates_, collision_mesh_, displaced_surface, dhat_, dmin_);
+		else
+			collision_set.build(
+				persistent_candidates_.update(collision_mesh_, displaced_surface, dhat_ + dmin_, broad_phase_method_),
+				collision_mesh_, displaced_surface, dhat_, dmin_);
 
-		cached_displaced_surface = displaced_surface;
+		cached_displaced_surface_ = displaced_surface;
 	}
 
 	Eigen::VectorXd CollisionBarrierForm::get_updated_mesh_nodes(const Eigen::VectorXd &x) const
@@ -131,6 +202,11 @@ namespace polyfem::solver
 		return AdjointTools::map_primitive_to_node_order(state_, X);
 	}
 
+	Eigen::MatrixXd CollisionBarrierForm::compute_displaced_surface(const Eigen::VectorXd &x) const
+	{
+		return collision_mesh_.vertices(utils::unflatten(get_updated_mesh_nodes(x), state_.mesh->dimension()));
+	}
+
 	DeformedCollisionBarrierForm::DeformedCollisionBarrierForm(const VariableToSimulationGroup &variable_to_simulation, const State &state, const double dhat)
 		: AdjointForm(variable_to_simulation), state_(state), dhat_(dhat), barrier_potential_(dhat)
 	{
@@ -148,6 +224,7 @@ namespace polyfem::solver
 		X_init = utils::flatten(V);
 
 		broad_phase_method_ = ipc::BroadPhaseMethod::HASH_GRID;
+		persistent_candidates_.set_skin(dhat_);
 	}
 
 	double DeformedCollisionBarrierForm::value_unweighted(const Eigen::VectorXd &x) const
@@ -209,13 +286,14 @@ namespace polyfem::solver
 
 	void DeformedCollisionBarrierForm::build_collision_set(const Eigen::MatrixXd &displaced_surface)
 	{
-		static Eigen::MatrixXd cached_displaced_surface;
-		if (cached_displaced_surface.size() == displaced_surface.size() && cached_displaced_surface == displaced_surface)
+		if (cached_displaced_surface_.size() == displaced_surface.size() && cached_displaced_surface_ == displaced_surface)
 			return;
 
-		collision_set.build(collision_mesh_, displaced_surface, dhat_, 0, broad_phase_method_);
+		collision_set.build(
+			persistent_candidates_.update(collision_mesh_, displaced_surface, dhat_, broad_phase_method_),
+			collision_mesh_, displaced_surface, dhat_);
 
-		cached_displaced_surface = displaced_surface;
+		cached_displaced_surface_ = displaced_surface;
 	}
 
 	Eigen::VectorXd DeformedCollisionBarrierForm::get_updated_mesh_nodes(const Eigen::VectorXd &x) const
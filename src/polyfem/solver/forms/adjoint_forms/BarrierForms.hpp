@@ -8,6 +8,36 @@
 
 namespace polyfem::solver
 {
+	/// @brief Broad-phase candidates inflated by the activation distance + skin, kept across solution changes and optimization
+	/// iterations until a vertex moved more than skin / 2 from the positions they were built at
+	class PersistentCandidates
+	{
+	public:
+		/// @param skin Extra inflation of the candidates, 0 disables the reuse
+		void set_skin(const double skin) { skin_ = skin; }
+		double skin() const { return skin_; }
+
+		/// @brief Check if the candidates contain every pair closer than the activation distance at the given positions
+		bool is_valid(const Eigen::MatrixXd &displaced_surface) const;
+
+		/// @brief Rebuild the candidates if they are not valid for the given positions
+		/// @param activation_distance Distance below which pairs must be candidates (dhat + dmin)
+		/// @return Candidates containing every pair closer than the activation distance
+		const ipc::Candidates &update(
+			const ipc::CollisionMesh &collision_mesh,
+			const Eigen::MatrixXd &displaced_surface,
+			const double activation_distance,
+			const ipc::BroadPhaseMethod broad_phase_method);
+
+		const ipc::Candidates &candidates() const { return candidates_; }
+
+	private:
+		double skin_ = 0;
+		ipc::Candidates candidates_;
+		/// @brief Vertex positions used to build the candidates
+		Eigen::MatrixXd surface_;
+	};
+
 	class CollisionBarrierForm : public AdjointForm
 	{
 	public:
@@ -25,10 +55,24 @@ namespace polyfem::solver
 
 		double max_step_size(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const override;
 
+		void line_search_begin(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) override;
+		void line_search_end() override;
+
+		/// @brief Set the extra inflation of the persistent broad-phase candidates, dhat by default
+		void set_broad_phase_skin(const double skin) { persistent_candidates_.set_skin(skin); }
+
+		/// @brief Get the accumulated CCD timings
+		const ContactForm::CCDTimings &ccd_timings() const { return ccd_timings_; }
+
 	protected:
 		void build_collision_set(const Eigen::MatrixXd &displaced_surface);
 
+		/// @brief Candidates containing every pair that can collide between V0 and V1
+		/// @param[out] candidates Storage used if neither the line search nor the persistent candidates can be used
+		const ipc::Candidates &step_candidates(const Eigen::MatrixXd &V0, const Eigen::MatrixXd &V1, ipc::Candidates &candidates) const;
+
 		Eigen::VectorXd get_updated_mesh_nodes(const Eigen::VectorXd &x) const;
+		Eigen::MatrixXd compute_displaced_surface(const Eigen::VectorXd &x) const;
 
 		const State &state_;
 
@@ -41,6 +85,15 @@ namespace polyfem::solver
 		ipc::BroadPhaseMethod broad_phase_method_;
 
 		ipc::BarrierPotential barrier_potential_;
+
+		/// @brief Positions the collision set was built at
+		Eigen::MatrixXd cached_displaced_surface_;
+		PersistentCandidates persistent_candidates_;
+		/// @brief Candidates of the step of the current line search
+		ipc::Candidates candidates_;
+		bool use_cached_candidates_ = false;
+
+		mutable ContactForm::CCDTimings ccd_timings_;
 	};
 
 	class LayerThicknessForm : public CollisionBarrierForm
@@ -97,5 +150,9 @@ namespace polyfem::solver
 		ipc::BroadPhaseMethod broad_phase_method_;
 
 		const ipc::BarrierPotential barrier_potential_;
+
+		/// @brief Positions the collision set was built at
+		Eigen::MatrixXd cached_displaced_surface_;
+		PersistentCandidates persistent_candidates_;
 	};
 } // namespace polyfem::solver
\ No newline at end of file
@@ -1,9 +1,30 @@
 #include "SmoothingForms.hpp"
 #include <polyfem/State.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 namespace polyfem::solver
 {
+	namespace
+	{
+		class LocalThreadScalarStorage
+		{
+		public:
+			double val = 0;
+		};
+
+		class LocalThreadVecStorage
+		{
+		public:
+			Eigen::VectorXd vec;
+
+			LocalThreadVecStorage(const int size)
+			{
+				vec.setZero(size);
+			}
+		};
+	} // namespace
+
 	BoundarySmoothingForm::BoundarySmoothingForm(
 		const VariableToSimulationGroup &variable_to_simulations, 
 		const State &state, 
@@ -84,26 +105,33 @@ namespace polyfem::solver
 		double val = 0;
 		if (scale_invariant_)
 		{
-			for (int b = 0; b < adj.rows(); b++)
-			{
-				polyfem::RowVectorNd s;
-				s.setZero(dim);
-				double sum_norm = 0;
-				int valence = 0;
-				for (Eigen::SparseMatrix<bool, Eigen::RowMajor>::InnerIterator it(adj, b); it; ++it)
-				{
-					assert(it.col() != b);
-					auto x = mesh.point(b) - mesh.point(it.col());
-					s += x;
-					sum_norm += x.norm();
-					valence += 1;
-				}
-				if (valence)
+			auto storage = utils::create_thread_storage(LocalThreadScalarStorage());
+			utils::maybe_parallel_for(adj.rows(), [&](int start, int end, int thread_id) {
+				LocalThreadScalarStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+				for (int b = start; b < end; b++)
 				{
-					s = s / sum_norm;
-					val += pow(s.norm(), power_);
+					polyfem::RowVectorNd s;
+					s.setZero(dim);
+					double sum_norm = 0;
+					int valence = 0;
+					for (Eigen::SparseMatrix<bool, Eigen::RowMajor>::InnerIterator it(adj, b); it; ++it)
+					{
+						assert(it.col() != b);
+						auto x = mesh.point(b) - mesh.point(it.col());
+						s += x;
+						sum_norm += x.norm();
+						valence += 1;
+					}
+					if (valence)
+					{
+						s = s / sum_norm;
+						local_storage.val += pow(s.norm(), power_);
+					}
 				}
-			}
+			});
+
+			for (const LocalThreadScalarStorage &local_storage : storage)
+				val += local_storage.val;
 		}
 		else
 		{
@@ -125,33 +153,41 @@ namespace polyfem::solver
 		Eigen::VectorXd grad;
 		if (scale_invariant_)
 		{
-			grad.setZero(n_verts * dim);
-			for (int b = 0; b < adj.rows(); b++)
-			{
-				polyfem::RowVectorNd s;
-				s.setZero(dim);
-				double sum_norm = 0;
-				auto sum_normalized = s;
-				int valence = 0;
-				for (Eigen::SparseMatrix<bool, Eigen::RowMajor>::InnerIterator it(adj, b); it; ++it)
+			// the vertices scatter into their neighbors, each thread accumulates in its own vector
+			auto storage = utils::create_thread_storage(LocalThreadVecStorage(n_verts * dim));
+			utils::maybe_parallel_for(adj.rows(), [&](int start, int end, int thread_id) {
+				Eigen::VectorXd &local_grad = utils::get_local_thread_storage(storage, thread_id).vec;
+				for (int b = start; b < end; b++)
 				{
-					assert(it.col() != b);
-					auto x = mesh.point(b) - mesh.point(it.col());
-					s += x;
-					sum_norm += x.norm();
-					sum_normalized += x.normalized();
-					valence += 1;
-				}
-				if (valence)
-				{
-					s = s / sum_norm;
-					const double coeff = power_ * pow(s.norm(), power_ - 2.) / sum_norm;
-
-					grad.segment(b * dim, dim) += (s * valence - s.squaredNorm() * sum_normalized) * coeff;
+					polyfem::RowVectorNd s;
+					s.setZero(dim);
+					double sum_norm = 0;
+					auto sum_normalized = s;
+					int valence = 0;
 					for (Eigen::SparseMatrix<bool, Eigen::RowMajor>::InnerIterator it(adj, b); it; ++it)
-						grad.segment(it.col() * dim, dim) -= (s + s.squaredNorm() * (mesh.point(it.col()) - mesh.point(b)).normalized()) * coeff;
+					{
+						assert(it.col() != b);
+						auto x = mesh.point(b) - mesh.point(it.col());
+						s += x;
+						sum_norm += x.norm();
+						sum_normalized += x.normalized();
+						valence += 1;
+					}
+					if (valence)
+					{
+						s = s / sum_norm;
+						const double coeff = power_ * pow(s.norm(), power_ - 2.) / sum_norm;
+
+						local_grad.segment(b * dim, dim) += (s * valence - s.squaredNorm() * sum_normalized) * coeff;
+						for (Eigen::SparseMatrix<bool, Eigen::RowMajor>::InnerIterator it(adj, b); it; ++it)
+							local_grad.segment(it.col() * dim, dim) -= (s + s.squaredNorm() * (mesh.point(it.col()) - mesh.point(b)).normalized()) * coeff;
+					}
 				}
-			}
+			});
+
+			grad.setZero(n_verts * dim);
+			for (const LocalThreadVecStorage &local_storage : storage)
+				grad += local_storage.vec;
 		}
 		else
 		{
@@ -821,6 +821,8 @@ namespace polyfem::solver
 			collision_sets_.back()->set_are_shape_derivatives_enabled(true);
 		}
 
+		forces_.resize(collision_sets_.size());
+
 		if (quadratic_potential)
 			barrier_potential_.set_barrier(std::make_shared<QuadraticBarrier>());
 	}
@@ -962,15 +964,23 @@ namespace polyfem::solver
 		return *collision_sets_[time_step];
 	}
 
+	const Eigen::MatrixXd &ProxyContactForceForm::get_or_compute_forces(const int time_step, const Eigen::MatrixXd &displaced_surface) const
+	{
+		if (forces_[time_step].size() == 0)
+		{
+			const ipc::Collisions &collision_set = get_or_compute_collision_set(time_step, displaced_surface);
+			forces_[time_step] = collision_mesh_.to_full_dof(barrier_potential_.gradient(collision_set, collision_mesh_, displaced_surface));
+		}
+		return forces_[time_step];
+	}
+
 	double ProxyContactForceForm::value_unweighted_step(const int time_step, const Eigen::VectorXd &x) const
 	{
 		assert(state_.solve_data.time_integrator != nullptr);
 		assert(state_.solve_data.contact_form != nullptr);
 
 		const Eigen::MatrixXd displaced_surface = collision_mesh_.displace_vertices(utils::unflatten(state_.diff_cached.u(time_step), collision_mesh_.dim()));
-		auto collision_set = get_or_compute_collision_set(time_step, displaced_surface);
-
-		Eigen::MatrixXd forces = collision_mesh_.to_full_dof(barrier_potential_.gradient(collision_set, collision_mesh_, displaced_surface));
+		const Eigen::MatrixXd &forces = get_or_compute_forces(time_step, displaced_surface);
 
 		double sum = (forces.array() * forces.array()).sum();
 
@@ -983,9 +993,9 @@ namespace polyfem::solver
 		assert(state_.solve_data.contact_form != nullptr);
 
 		const Eigen::MatrixXd displaced_surface = collision_mesh_.displace_vertices(utils::unflatten(state_.diff_cached.u(time_step), collision_mesh_.dim()));
-		auto collision_set = get_or_compute_collision_set(time_step, displaced_surface);
+		const ipc::Collisions &collision_set = get_or_compute_collision_set(time_step, displaced_surface);
 
-		Eigen::MatrixXd forces = collision_mesh_.to_full_dof(barrier_potential_.gradient(collision_set, collision_mesh_, displaced_surface));
+		const Eigen::MatrixXd &forces = get_or_compute_forces(time_step, displaced_surface);
 		StiffnessMatrix hessian = collision_mesh_.to_full_dof(barrier_potential_.hessian(collision_set, collision_mesh_, displaced_surface, false));
 
 		Eigen::VectorXd gradu = 2 * hessian.transpose() * forces;
@@ -1021,9 +1031,9 @@ namespace polyfem::solver
 		gradv = weight() * variable_to_simulations_.apply_parametrization_jacobian(ParameterType::Shape, &state_, x, [this, time_step, &x]() {
 			const Eigen::MatrixXd displaced_surface = collision_mesh_.displace_vertices(utils::unflatten(state_.diff_cached.u(time_step), collision_mesh_.dim()));
 
-			auto collision_set = get_or_compute_collision_set(time_step, displaced_surface);
+			const ipc::Collisions &collision_set = get_or_compute_collision_set(time_step, displaced_surface);
 
-			Eigen::MatrixXd forces = collision_mesh_.to_full_dof(barrier_potential_.gradient(collision_set, collision_mesh_, displaced_surface));
+			const Eigen::MatrixXd &forces = get_or_compute_forces(time_step, displaced_surface);
 
 			StiffnessMatrix shape_derivative = collision_mesh_.to_full_dof(barrier_potential_.shape_derivative(collision_set, collision_mesh_, displaced_surface));
 
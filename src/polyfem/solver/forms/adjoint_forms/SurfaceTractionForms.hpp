@@ -78,6 +78,8 @@ namespace polyfem::solver
 				return;
 
 			collision_set_indicator_.setZero();
+			for (Eigen::MatrixXd &forces : forces_)
+				forces.resize(0, 0);
 			build_collision_mesh();
 			curr_x_ = x;
 		}
@@ -86,6 +88,8 @@ namespace polyfem::solver
 		void build_collision_mesh();
 		void build_forward_collision_mesh();
 		const ipc::Collisions &get_or_compute_collision_set(const int time_step, const Eigen::MatrixXd &displaced_surface) const;
+		/// @brief Barrier forces on the full dofs, shared by the value and the derivatives until the solution changes
+		const Eigen::MatrixXd &get_or_compute_forces(const int time_step, const Eigen::MatrixXd &displaced_surface) const;
 
 		const State &state_;
 		std::set<int> boundary_ids_;
@@ -96,6 +100,7 @@ namespace polyfem::solver
 
 		mutable Eigen::VectorXi collision_set_indicator_;
 		std::vector<std::shared_ptr<ipc::Collisions>> collision_sets_;
+		mutable std::vector<Eigen::MatrixXd> forces_;
 
 		ipc::CollisionMesh collision_mesh_;
 		const double dhat_;
@@ -27,6 +27,70 @@ namespace polyfem::solver
 				val = 0;
 			}
 		};
+
+		class LocalThreadPointStorage
+		{
+		public:
+			std::vector<Eigen::MatrixXd> points;
+			assembler::ElementAssemblyValues vals;
+		};
+
+		/// deformed surface quadrature points of the selected boundaries (all if ids is empty), one per row
+		Eigen::MatrixXd deformed_surface_points(const State &state, const std::set<int> &ids, const int dim, const Eigen::MatrixXd &sol)
+		{
+			const auto &bases = state.bases;
+			const auto &gbases = state.geom_bases();
+			const int actual_dim = state.problem->is_scalar() ? 1 : dim;
+
+			auto storage = utils::create_thread_storage(LocalThreadPointStorage());
+			utils::maybe_parallel_for(state.total_local_boundary.size(), [&](int start, int end, int thread_id) {
+				LocalThreadPointStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+
+				Eigen::MatrixXd uv, points, normal;
+				Eigen::VectorXd weights;
+
+				Eigen::MatrixXd u, grad_u;
+
+				for (int lb_id = start; lb_id < end; ++lb_id)
+				{
+					const auto &lb = state.total_local_boundary[lb_id];
+					const int e = lb.element_id();
+
+					for (int i = 0; i < lb.size(); i++)
+					{
+						const int global_primitive_id = lb.global_primitive_id(i);
+						if (ids.size() != 0 && ids.find(state.mesh->get_boundary_id(global_primitive_id)) == ids.end())
+							continue;
+
+						utils::BoundarySampler::boundary_quadrature(lb, state.n_boundary_samples(), *state.mesh, i, false, uv, points, normal, weights);
+
+						assembler::ElementAssemblyValues &vals = local_storage.vals;
+						vals.compute(e, state.mesh->is_volume(), points, bases[e], gbases[e]);
+						io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, sol, u, grad_u);
+
+						local_storage.points.push_back(vals.val + u);
+					}
+				}
+			});
+
+			int n_points = 0;
+			for (const LocalThreadPointStorage &local_storage : storage)
+				for (const Eigen::MatrixXd &points : local_storage.points)
+					n_points += points.rows();
+
+			Eigen::MatrixXd all_points(n_points, dim);
+			n_points = 0;
+			for (const LocalThreadPointStorage &local_storage : storage)
+			{
+				for (const Eigen::MatrixXd &points : local_storage.points)
+				{
+					all_points.middleRows(n_points, points.rows()) = points;
+					n_points += points.rows();
+				}
+			}
+
+			return all_points;
+		}
 	} // namespace
 
 	IntegrableFunctional TargetForm::get_integral_functional() const
@@ -188,44 +252,9 @@ namespace polyfem::solver
 
 	void SDFTargetForm::solution_changed_step(const int time_step, const Eigen::VectorXd &x)
 	{
-		const auto &bases = state_.bases;
-		const auto &gbases = state_.geom_bases();
-		const int actual_dim = state_.problem->is_scalar() ? 1 : dim;
-
-		auto storage = utils::create_thread_storage(LocalThreadScalarStorage());
-		utils::maybe_parallel_for(state_.total_local_boundary.size(), [&](int start, int end, int thread_id) {
-			LocalThreadScalarStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
-
-			Eigen::MatrixXd uv, samples, gtmp;
-			Eigen::MatrixXd points, normal;
-			Eigen::VectorXd weights;
-
-			Eigen::MatrixXd u, grad_u;
-
-			for (int lb_id = start; lb_id < end; ++lb_id)
-			{
-				const auto &lb = state_.total_local_boundary[lb_id];
-				const int e = lb.element_id();
-
-				for (int i = 0; i < lb.size(); i++)
-				{
-					const int global_primitive_id = lb.global_primitive_id(i);
-					if (ids_.size() != 0 && ids_.find(state_.mesh->get_boundary_id(global_primitive_id)) == ids_.end())
-						continue;
-
-					utils::BoundarySampler::boundary_quadrature(lb, state_.n_boundary_samples(), *state_.mesh, i, false, uv, points, normal, weights);
-
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					vals.compute(e, state_.mesh->is_volume(), points, bases[e], gbases[e]);
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, state_.diff_cached.u(time_step), u, grad_u);
-
-					normal = normal * vals.jac_it[0]; // assuming linear geometry
-
-					for (int q = 0; q < u.rows(); q++)
-						interpolation_fn->cache_grid([this](const Eigen::MatrixXd &point, double &distance) { compute_distance(point, distance); }, vals.val.row(q) + u.row(q));
-				}
-			}
-		});
+		// a single batch, the missing grid nodes of all the points are evaluated in parallel
+		const Eigen::MatrixXd points = deformed_surface_points(state_, ids_, dim, state_.diff_cached.u(time_step));
+		interpolation_fn->cache_grid([this](const Eigen::MatrixXd &point, double &distance) { compute_distance(point, distance); }, points);
 	}
 
 	void SDFTargetForm::set_bspline_target(const Eigen::MatrixXd &control_points, const Eigen::VectorXd &knots, const double delta)
@@ -345,27 +374,17 @@ namespace polyfem::solver
 	{
 		IntegrableFunctional j;
 		auto j_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), 1);
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd unused_grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, unused_grad);
-				val(q) = pow(distance, 2);
-			}
+			Eigen::VectorXd distance;
+			Eigen::MatrixXd unused_grad;
+			interpolation_fn->evaluate(u + pts, distance, unused_grad);
+			val = distance.array().square().matrix();
 		};
 
 		auto djdu_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), u.cols());
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, grad);
-				val.row(q) = 2 * distance * grad.transpose();
-			}
+			Eigen::VectorXd distance;
+			Eigen::MatrixXd grad;
+			interpolation_fn->evaluate(u + pts, distance, grad);
+			val = 2 * distance.asDiagonal() * grad;
 		};
 
 		j.set_j(j_func);
@@ -391,76 +410,30 @@ namespace polyfem::solver
 
 	void MeshTargetForm::solution_changed_step(const int time_step, const Eigen::VectorXd &x)
 	{
-		const auto &bases = state_.bases;
-		const auto &gbases = state_.geom_bases();
-		const int actual_dim = state_.problem->is_scalar() ? 1 : dim;
-
-		auto storage = utils::create_thread_storage(LocalThreadScalarStorage());
-		utils::maybe_parallel_for(state_.total_local_boundary.size(), [&](int start, int end, int thread_id) {
-			LocalThreadScalarStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
-
-			Eigen::MatrixXd uv, samples, gtmp;
-			Eigen::MatrixXd points, normal;
-			Eigen::VectorXd weights;
-
-			Eigen::MatrixXd u, grad_u;
-
-			for (int lb_id = start; lb_id < end; ++lb_id)
-			{
-				const auto &lb = state_.total_local_boundary[lb_id];
-				const int e = lb.element_id();
-
-				for (int i = 0; i < lb.size(); i++)
-				{
-					const int global_primitive_id = lb.global_primitive_id(i);
-					if (ids_.size() != 0 && ids_.find(state_.mesh->get_boundary_id(global_primitive_id)) == ids_.end())
-						continue;
-
-					utils::BoundarySampler::boundary_quadrature(lb, state_.n_boundary_samples(), *state_.mesh, i, false, uv, points, normal, weights);
-
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					vals.compute(e, state_.mesh->is_volume(), points, bases[e], gbases[e]);
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, state_.diff_cached.u(time_step), u, grad_u);
-
-					normal = normal * vals.jac_it[0]; // assuming linear geometry
-
-					for (int q = 0; q < u.rows(); q++)
-						interpolation_fn->cache_grid([this](const Eigen::MatrixXd &point, double &distance) {
-							int idx;
-							Eigen::Matrix<double, 1, 3> closest;
-							distance = pow(tree_.squared_distance(V_, F_, point.col(0), idx, closest), 0.5);
-						},
-													 vals.val.row(q) + u.row(q));
-				}
-			}
-		});
+		const Eigen::MatrixXd points = deformed_surface_points(state_, ids_, dim, state_.diff_cached.u(time_step));
+		interpolation_fn->cache_grid([this](const Eigen::MatrixXd &point, double &distance) {
+			int idx;
+			Eigen::Matrix<double, 1, 3> closest;
+			distance = pow(tree_.squared_distance(V_, F_, point.col(0), idx, closest), 0.5);
+		},
+									 points);
 	}
 
 	IntegrableFunctional MeshTargetForm::get_integral_functional() const
 	{
 		IntegrableFunctional j;
 		auto j_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), 1);
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd unused_grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, unused_grad);
-				val(q) = pow(distance, 2);
-			}
+			Eigen::VectorXd distance;
+			Eigen::MatrixXd unused_grad;
+			interpolation_fn->evaluate(u + pts, distance, unused_grad);
+			val = distance.array().square().matrix();
 		};
 
 		auto djdu_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), u.cols());
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, grad);
-				val.row(q) = 2 * distance * grad.transpose();
-			}
+			Eigen::VectorXd distance;
+			Eigen::MatrixXd grad;
+			interpolation_fn->evaluate(u + pts, distance, grad);
+			val = 2 * distance.asDiagonal() * grad;
 		};
 
 		j.set_j(j_func);
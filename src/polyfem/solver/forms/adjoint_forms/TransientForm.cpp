@@ -29,7 +29,18 @@ namespace polyfem::solver
 				mat.setZero();
 			}
 		};
+
+		/// time steps with a nonzero quadrature weight, the only ones the objective is evaluated at
+		std::vector<int> active_steps(const std::vector<double> &weights)
+		{
+			std::vector<int> steps;
+			for (int i = 0; i < weights.size(); i++)
+				if (weights[i] != 0)
+					steps.push_back(i);
+			return steps;
+		}
 	} // namespace
+
 	std::vector<double> TransientForm::get_transient_quadrature_weights() const
 	{
 		std::vector<double> weights;
@@ -77,16 +88,16 @@ namespace polyfem::solver
 
 	double TransientForm::value_unweighted(const Eigen::VectorXd &x) const
 	{
-		std::vector<double> weights = get_transient_quadrature_weights();
+		const std::vector<double> weights = get_transient_quadrature_weights();
+		const std::vector<int> steps = active_steps(weights);
 		auto storage = utils::create_thread_storage(LocalThreadScalarStorage());
 
-		utils::maybe_parallel_for(time_steps_ + 1, [&](int start, int end, int thread_id) {
+		utils::maybe_parallel_for(steps.size(), [&](int start, int end, int thread_id) {
 			LocalThreadScalarStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
-			for (int i = start; i < end; i++)
+			for (int k = start; k < end; k++)
 			{
-				if (weights[i] == 0)
-					continue;
+				const int i = steps[k];
 				const double tmp = obj_->value_unweighted_step(i, x);
 				local_storage.val += (weights[i] * obj_->weight()) * tmp;
 			}
@@ -102,42 +113,45 @@ namespace polyfem::solver
 	{
 		Eigen::MatrixXd terms;
 		terms.setZero(state.ndof(), time_steps_ + 1);
-		std::vector<double> weights = get_transient_quadrature_weights();
-
-		auto storage = utils::create_thread_storage(LocalThreadMatStorage(terms.rows(), terms.cols()));
-
-		utils::maybe_parallel_for(time_steps_ + 1, [&](int start, int end, int thread_id) {
-			LocalThreadMatStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+		const std::vector<double> weights = get_transient_quadrature_weights();
+		const std::vector<int> steps = active_steps(weights);
 
-			for (int i = start; i < end; i++)
+		// every step writes its own terms, they are summed in the columns once all are computed
+		std::vector<Eigen::VectorXd> step_terms(steps.size()), prev_step_terms(steps.size());
+		utils::maybe_parallel_for(steps.size(), [&](int start, int end, int thread_id) {
+			for (int k = start; k < end; k++)
 			{
-				if (weights[i] == 0)
-					continue;
-				local_storage.mat.col(i) = weights[i] * obj_->compute_adjoint_rhs_step(i, x, state);
+				const int i = steps[k];
+				step_terms[k] = obj_->compute_adjoint_rhs_step(i, x, state);
 				if (obj_->depends_on_step_prev() && i > 0)
-					local_storage.mat.col(i - 1) = weights[i] * obj_->compute_adjoint_rhs_step_prev(i, x, state);
+					prev_step_terms[k] = obj_->compute_adjoint_rhs_step_prev(i, x, state);
 			}
 		});
 
-		for (const LocalThreadMatStorage &local_storage : storage)
-			terms += local_storage.mat;
+		for (int k = 0; k < steps.size(); k++)
+		{
+			const int i = steps[k];
+			terms.col(i) += weights[i] * step_terms[k];
+			if (prev_step_terms[k].size() > 0)
+				terms.col(i - 1) += weights[i] * prev_step_terms[k];
+		}
 
 		return terms * weight();
 	}
 	void TransientForm::compute_partial_gradient(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
 	{
 		gradv.setZero(x.size());
-		std::vector<double> weights = get_transient_quadrature_weights();
+		const std::vector<double> weights = get_transient_quadrature_weights();
+		const std::vector<int> steps = active_steps(weights);
 		auto storage = utils::create_thread_storage(LocalThreadMatStorage(gradv.size()));
 
-		utils::maybe_parallel_for(time_steps_ + 1, [&](int start, int end, int thread_id) {
+		utils::maybe_parallel_for(steps.size(), [&](int start, int end, int thread_id) {
 			LocalThreadMatStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
 			Eigen::VectorXd tmp;
-			for (int i = start; i < end; i++)
+			for (int k = start; k < end; k++)
 			{
-				if (weights[i] == 0)
-					continue;
+				const int i = steps[k];
 				obj_->compute_partial_gradient_step(i, x, tmp);
 				local_storage.mat += weights[i] * tmp;
 			}
@@ -182,13 +196,8 @@ namespace polyfem::solver
 	{
 		AdjointForm::solution_changed(new_x);
 		// obj_->solution_changed(new_x);
-		std::vector<double> weights = get_transient_quadrature_weights();
-		for (int i = 0; i <= time_steps_; i++)
-		{
-			if (weights[i] == 0)
-				continue;
+		for (const int i : active_steps(get_transient_quadrature_weights()))
 			obj_->solution_changed_step(i, new_x);
-		}
 	}
 	bool TransientForm::is_step_collision_free(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const
 	{
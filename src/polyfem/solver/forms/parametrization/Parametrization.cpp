@@ -1,14 +1,52 @@
 #include "Parametrization.hpp"
 #include <polyfem/utils/Logger.hpp>
 
+#include <functional>
+
 namespace polyfem::solver
 {
+	namespace
+	{
+		size_t vector_hash(const Eigen::VectorXd &x)
+		{
+			size_t seed = std::hash<Eigen::Index>()(x.size());
+			for (int i = 0; i < x.size(); ++i)
+				seed ^= std::hash<double>()(x(i)) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+			return seed;
+		}
+	} // namespace
+
 	Eigen::VectorXd Parametrization::inverse_eval(const Eigen::VectorXd &y)
 	{
 		log_and_throw_adjoint_error("Not supported");
 		return Eigen::VectorXd();
 	}
 
+	StiffnessMatrix Parametrization::affine_jacobian(const int x_size) const
+	{
+		assert(is_affine());
+
+		Eigen::VectorXd x = Eigen::VectorXd::Zero(x_size);
+		const Eigen::VectorXd y0 = eval(x);
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int j = 0; j < x_size; ++j)
+		{
+			x(j) = 1;
+			const Eigen::VectorXd col = eval(x) - y0;
+			x(j) = 0;
+
+			// differences below the round-off of the offset are structural zeros
+			for (int i = 0; i < col.size(); ++i)
+				if (std::abs(col(i)) > 1e-14 * std::max(1., std::abs(y0(i))))
+					entries.emplace_back(i, j, col(i));
+		}
+
+		StiffnessMatrix jacobian(y0.size(), x_size);
+		jacobian.setFromTriplets(entries.begin(), entries.end());
+		return jacobian;
+	}
+
 	int CompositeParametrization::size(const int x_size) const
 	{
 		int cur_size = x_size;
@@ -20,6 +58,9 @@ namespace polyfem::solver
 
 	Eigen::VectorXd CompositeParametrization::inverse_eval(const Eigen::VectorXd &y)
 	{
+		// the parametrizations may be reinitialized
+		clear_cache();
+
 		if (parametrizations_.empty())
 			return y;
 
@@ -32,19 +73,115 @@ namespace polyfem::solver
 		return x;
 	}
 
-	Eigen::VectorXd CompositeParametrization::eval(const Eigen::VectorXd &x) const
+	bool CompositeParametrization::is_affine() const
 	{
-		if (parametrizations_.empty())
-			return x;
+		for (const auto &p : parametrizations_)
+			if (!p->is_affine())
+				return false;
+		return true;
+	}
+
+	StiffnessMatrix CompositeParametrization::affine_jacobian(const int x_size) const
+	{
+		assert(is_affine());
+
+		build_segments(x_size);
+		if (segments_.empty())
+		{
+			StiffnessMatrix identity(x_size, x_size);
+			identity.setIdentity();
+			return identity;
+		}
+
+		assert(segments_.size() == 1);
+		return segments_[0].jacobian;
+	}
 
+	void CompositeParametrization::clear_cache()
+	{
+		segments_x_size_ = -1;
+		segments_.clear();
+		cached_x_.resize(0);
+		cached_y_.resize(0);
+		cached_inputs_.clear();
+	}
+
+	void CompositeParametrization::build_segments(const int x_size) const
+	{
+		if (segments_x_size_ == x_size)
+			return;
+
+		segments_.clear();
+		cached_x_.resize(0);
+		cached_inputs_.clear();
+
+		int cur_size = x_size;
+		for (int i = 0; i < parametrizations_.size();)
+		{
+			Segment segment;
+			segment.begin = i;
+			segment.affine = parametrizations_[i]->is_affine();
+			if (segment.affine)
+			{
+				Eigen::VectorXd y = Eigen::VectorXd::Zero(cur_size);
+				segment.jacobian.resize(cur_size, cur_size);
+				segment.jacobian.setIdentity();
+				for (; i < parametrizations_.size() && parametrizations_[i]->is_affine(); ++i)
+				{
+					const StiffnessMatrix jacobian = parametrizations_[i]->affine_jacobian(cur_size);
+					segment.jacobian = (jacobian * segment.jacobian).pruned();
+					y = parametrizations_[i]->eval(y);
+					cur_size = parametrizations_[i]->size(cur_size);
+					assert(jacobian.rows() == cur_size && y.size() == cur_size);
+				}
+				segment.offset = y;
+			}
+			else
+			{
+				cur_size = parametrizations_[i]->size(cur_size);
+				++i;
+			}
+			segment.end = i;
+			segments_.push_back(std::move(segment));
+		}
+
+		segments_x_size_ = x_size;
+	}
+
+	void CompositeParametrization::evaluate(const Eigen::VectorXd &x) const
+	{
+		build_segments(x.size());
+
+		const size_t hash = vector_hash(x);
+		if (!cached_inputs_.empty() && hash == cached_hash_ && cached_x_.size() == x.size() && cached_x_ == x)
+			return;
+
+		cached_inputs_.resize(segments_.size());
 		Eigen::VectorXd y = x;
-		for (const auto &p : parametrizations_)
+		for (int s = 0; s < segments_.size(); ++s)
 		{
-			y = p->eval(y);
+			const Segment &segment = segments_[s];
+			cached_inputs_[s] = y;
+			if (segment.affine)
+				y = segment.jacobian * y + segment.offset;
+			else
+				y = parametrizations_[segment.begin]->eval(y);
 		}
 
-		return y;
+		cached_hash_ = hash;
+		cached_x_ = x;
+		cached_y_ = y;
 	}
+
+	Eigen::VectorXd CompositeParametrization::eval(const Eigen::VectorXd &x) const
+	{
+		if (parametrizations_.empty())
+			return x;
+
+		evaluate(x);
+		return cached_y_;
+	}
+
 	Eigen::VectorXd CompositeParametrization::apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const
 	{
 		Eigen::VectorXd gradv = grad_full;
@@ -52,17 +189,16 @@ namespace polyfem::solver
 		if (parametrizations_.empty())
 			return gradv;
 
-		std::vector<Eigen::VectorXd> ys;
-		auto y = x;
-		for (const auto &p : parametrizations_)
+		evaluate(x);
+		for (int s = segments_.size() - 1; s >= 0; --s)
 		{
-			ys.emplace_back(y);
-			y = p->eval(y);
+			const Segment &segment = segments_[s];
+			if (segment.affine)
+				gradv = segment.jacobian.transpose() * gradv;
+			else
+				gradv = parametrizations_[segment.begin]->apply_jacobian(gradv, cached_inputs_[s]);
 		}
 
-		for (int i = parametrizations_.size() - 1; i >= 0; --i)
-			gradv = parametrizations_[i]->apply_jacobian(gradv, ys[i]);
-
 		return gradv;
 	}
-} // namespace polyfem::solver
\ No newline at end of file
+} // namespace polyfem::solver
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <polyfem/utils/Types.hpp>
+
 #include <memory>
 #include <vector>
 
@@ -21,8 +23,16 @@ namespace polyfem::solver
 		virtual int size(const int x_size) const = 0; // just for verification
 		virtual Eigen::VectorXd eval(const Eigen::VectorXd &x) const = 0;
 		virtual Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const = 0;
+
+		/// whether eval(x) = J x + eval(0) with a constant Jacobian J
+		virtual bool is_affine() const { return false; }
+		/// @brief constant Jacobian of an affine parametrization, by default assembled column by column from eval
+		/// @param[in] x_size size of the input
+		/// @return sparse Jacobian of size size(x_size) x x_size
+		virtual StiffnessMatrix affine_jacobian(const int x_size) const;
 	};
 
+	/// Chain of parametrizations, memoizing the last evaluation and collapsing consecutive affine parametrizations into a single sparse matrix
 	class CompositeParametrization : public Parametrization
 	{
 	public:
@@ -36,7 +46,34 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const override;
 
+		bool is_affine() const override;
+		StiffnessMatrix affine_jacobian(const int x_size) const override;
+
 	private:
+		/// range [begin, end) of the parametrizations, replaced by y = jacobian * x + offset if affine
+		struct Segment
+		{
+			int begin, end;
+			bool affine;
+			StiffnessMatrix jacobian;
+			Eigen::VectorXd offset;
+		};
+
+		/// splits the chain in segments for inputs of size x_size
+		void build_segments(const int x_size) const;
+		/// evaluates the chain at x and stores the inputs of all segments, unless x is the last evaluated input
+		void evaluate(const Eigen::VectorXd &x) const;
+		/// drops the memoized evaluation and the affine segments
+		void clear_cache();
+
 		const std::vector<std::shared_ptr<Parametrization>> parametrizations_;
+
+		// caches, not thread-safe
+		mutable int segments_x_size_ = -1;
+		mutable std::vector<Segment> segments_;
+		mutable size_t cached_hash_ = 0;
+		mutable Eigen::VectorXd cached_x_;
+		mutable Eigen::VectorXd cached_y_;
+		mutable std::vector<Eigen::VectorXd> cached_inputs_; ///< input of each segment at cached_x_
 	};
-} // namespace polyfem::solver
\ No newline at end of file
+} // namespace polyfem::solver
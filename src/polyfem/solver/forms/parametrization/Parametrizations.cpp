@@ -97,6 +97,22 @@ namespace polyfem::solver
 			return scale_ * grad.array();
 	}
 
+	StiffnessMatrix Scaling::affine_jacobian(const int x_size) const
+	{
+		Eigen::VectorXd diag = Eigen::VectorXd::Ones(x_size);
+		if (from_ >= 0)
+			diag.segment(from_, to_ - from_).setConstant(scale_);
+		else
+			diag.setConstant(scale_);
+
+		StiffnessMatrix jacobian(x_size, x_size);
+		jacobian.reserve(Eigen::VectorXi::Ones(x_size));
+		for (int i = 0; i < x_size; ++i)
+			jacobian.insert(i, i) = diag(i);
+		jacobian.makeCompressed();
+		return jacobian;
+	}
+
 	Eigen::VectorXd PowerMap::inverse_eval(const Eigen::VectorXd &y)
 	{
 		if (from_ >= 0)
@@ -349,6 +365,17 @@ namespace polyfem::solver
 		return grad_full;
 	}
 
+	StiffnessMatrix SliceMap::affine_jacobian(const int x_size) const
+	{
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int i = 0; i < to_ - from_; ++i)
+			entries.emplace_back(i, from_ + i, 1);
+
+		StiffnessMatrix jacobian(to_ - from_, x_size);
+		jacobian.setFromTriplets(entries.begin(), entries.end());
+		return jacobian;
+	}
+
 	InsertConstantMap::InsertConstantMap(const int size, const double val, const int start_index) : start_index_(start_index)
 	{
 		if (size <= 0)
@@ -411,6 +438,19 @@ namespace polyfem::solver
 		return reduced_grad;
 	}
 
+	StiffnessMatrix InsertConstantMap::affine_jacobian(const int x_size) const
+	{
+		const int start = start_index_ >= 0 ? start_index_ : x_size;
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int i = 0; i < x_size; ++i)
+			entries.emplace_back(i < start ? i : i + values_.size(), i, 1);
+
+		StiffnessMatrix jacobian(size(x_size), x_size);
+		jacobian.setFromTriplets(entries.begin(), entries.end());
+		return jacobian;
+	}
+
 	LinearFilter::LinearFilter(const mesh::Mesh &mesh, const double radius)
 	{
 		std::vector<Eigen::Triplet<double>> tt_adjacency_list;
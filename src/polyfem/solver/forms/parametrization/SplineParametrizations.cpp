@@ -371,6 +371,23 @@ namespace polyfem::solver
 		return grad;
 	}
 
+	StiffnessMatrix BoundedBiharmonicWeights2Dto3D::affine_jacobian(const int x_size) const
+	{
+		assert(is_affine());
+		assert(x_size == bbw_weights_.cols() * 3);
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int j = 0; j < bbw_weights_.cols(); ++j)
+			for (int i = 0; i < bbw_weights_.rows(); ++i)
+				if (bbw_weights_(i, j) != 0)
+					for (int k = 0; k < 3; ++k)
+						entries.emplace_back(i * 3 + k, j * 3 + k, bbw_weights_(i, j));
+
+		StiffnessMatrix jacobian(y_start.size(), x_size);
+		jacobian.setFromTriplets(entries.begin(), entries.end());
+		return jacobian;
+	}
+
 	void BoundedBiharmonicWeights2Dto3D::compute_faces_for_partial_vertices(const Eigen::MatrixXd &V, Eigen::MatrixXi &F) const
 	{
 		// The following implementation is maybe a bit wasteful, but is independent of state or surface selections
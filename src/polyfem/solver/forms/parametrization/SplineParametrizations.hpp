@@ -28,6 +28,9 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const override;
 
+		// the vertices are a fixed combination of the control points
+		bool is_affine() const override { return invoked_inverse_eval_; }
+
 	private:
 		const Eigen::MatrixXd initial_control_points_;
 		const Eigen::VectorXd knots_;
@@ -79,6 +82,9 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const override;
 
+		bool is_affine() const override { return invoked_inverse_eval_ && !allow_rotations_; }
+		StiffnessMatrix affine_jacobian(const int x_size) const override;
+
 		Eigen::MatrixXd get_bbw_weights() { return bbw_weights_; }
 
 	private:
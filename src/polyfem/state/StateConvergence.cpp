@@ -0,0 +1,324 @@
+#include <polyfem/State.hpp>
+
+#include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Timer.hpp>
+
+#include <SimpleBVH/BVH.hpp>
+
+#include <ipc/distance/point_edge.hpp>
+#include <ipc/distance/point_triangle.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace polyfem
+{
+	using namespace basis;
+	using namespace utils;
+
+	namespace
+	{
+		/// copies the boundary ids of coarse to its uniform refinement fine, each fine boundary facet
+		/// lies on the coarse boundary facet closest to its barycenter
+		void inherit_boundary_ids(const mesh::Mesh &coarse, mesh::Mesh &fine)
+		{
+			if (!coarse.has_boundary_ids())
+				return;
+
+			const bool is_volume = coarse.is_volume();
+			const int dim = coarse.dimension();
+
+			RowVectorNd min, max;
+			coarse.bounding_box(min, max);
+			const double eps = 1e-8 * (max - min).norm();
+
+			std::vector<int> coarse_facets;
+			std::vector<std::array<Eigen::Vector3d, 2>> boxes;
+			for (int p = 0; p < coarse.n_boundary_elements(); ++p)
+			{
+				if (!(is_volume ? coarse.is_boundary_face(p) : coarse.is_boundary_edge(p)))
+					continue;
+
+				const int n_vertices = is_volume ? coarse.n_face_vertices(p) : 2;
+				std::array<Eigen::Vector3d, 2> box{{Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero()}};
+				box[0].head(dim).setConstant(std::numeric_limits<double>::max());
+				box[1].head(dim).setConstant(-std::numeric_limits<double>::max());
+				for (int lv = 0; lv < n_vertices; ++lv)
+				{
+					const RowVectorNd v = coarse.point(coarse.boundary_element_vertex(p, lv));
+					box[0].head(dim) = box[0].head(dim).cwiseMin(v.transpose());
+					box[1].head(dim) = box[1].head(dim).cwiseMax(v.transpose());
+				}
+				box[0].head(dim).array() -= eps;
+				box[1].head(dim).array() += eps;
+
+				coarse_facets.push_back(p);
+				boxes.push_back(box);
+			}
+
+			SimpleBVH::BVH bvh;
+			bvh.init(boxes);
+
+			std::vector<int> boundary_ids(fine.n_boundary_elements(), -1);
+			maybe_parallel_for(fine.n_boundary_elements(), [&](int start, int end, int thread_id) {
+				std::vector<unsigned int> candidates;
+				for (int p = start; p < end; ++p)
+				{
+					if (!(is_volume ? fine.is_boundary_face(p) : fine.is_boundary_edge(p)))
+						continue;
+
+					Eigen::Vector3d bary = Eigen::Vector3d::Zero();
+					bary.head(dim) = (is_volume ? fine.face_barycenter(p) : fine.edge_barycenter(p)).transpose();
+
+					candidates.clear();
+					bvh.intersect_box(bary, bary, candidates);
+
+					double min_dist = std::numeric_limits<double>::max();
+					int closest = -1;
+					for (const unsigned int c : candidates)
+					{
+						const int q = coarse_facets[c];
+						double dist;
+						if (is_volume)
+						{
+							// polygonal faces are split in a fan of triangles
+							const Eigen::Vector3d v0 = coarse.point(coarse.face_vertex(q, 0)).transpose();
+							dist = std::numeric_limits<double>::max();
+							for (int lv = 1; lv + 1 < coarse.n_face_vertices(q); ++lv)
+							{
+								const Eigen::Vector3d v1 = coarse.point(coarse.face_vertex(q, lv)).transpose();
+								const Eigen::Vector3d v2 = coarse.point(coarse.face_vertex(q, lv + 1)).transpose();
+								dist = std::min(dist, ipc::point_triangle_distance(bary, v0, v1, v2));
+							}
+						}
+						else
+						{
+							const Eigen::Vector2d v0 = coarse.point(coarse.edge_vertex(q, 0)).transpose();
+							const Eigen::Vector2d v1 = coarse.point(coarse.edge_vertex(q, 1)).transpose();
+							dist = ipc::point_edge_distance(Eigen::Vector2d(bary.head<2>()), v0, v1);
+						}
+
+						if (dist < min_dist)
+						{
+							min_dist = dist;
+							closest = q;
+						}
+					}
+
+					boundary_ids[p] = closest >= 0 ? coarse.get_boundary_id(closest) : std::numeric_limits<int>::max();
+				}
+			});
+
+			fine.set_boundary_ids(boundary_ids);
+		}
+
+		/// interpolates the coarse solution at the nodes of the fine bases, the coarse geometric
+		/// mapping must be affine (P1 simplices)
+		/// @return false if the bases are not supported
+		bool prolongate(const int dim,
+						const int actual_dim,
+						const std::vector<ElementBases> &coarse_bases,
+						const std::vector<ElementBases> &coarse_gbases,
+						const Eigen::MatrixXd &coarse_sol,
+						const std::vector<ElementBases> &fine_bases,
+						const int n_fine_bases,
+						Eigen::MatrixXd &fine_sol)
+		{
+			for (const ElementBases &gbs : coarse_gbases)
+			{
+				if (int(gbs.bases.size()) != dim + 1)
+					return false;
+				for (const Basis &b : gbs.bases)
+					if (b.order() != 1)
+						return false;
+			}
+
+			Eigen::MatrixXd nodes(n_fine_bases, dim);
+			for (const ElementBases &bs : fine_bases)
+			{
+				for (const Basis &b : bs.bases)
+				{
+					if (b.global().size() != 1)
+						return false;
+					if (b.global()[0].index < n_fine_bases)
+						nodes.row(b.global()[0].index) = b.global()[0].node;
+				}
+			}
+
+			std::vector<Eigen::MatrixXd> coarse_nodes(coarse_gbases.size());
+			std::vector<std::array<Eigen::Vector3d, 2>> boxes(coarse_gbases.size());
+			for (int e = 0; e < coarse_gbases.size(); ++e)
+			{
+				coarse_nodes[e] = coarse_gbases[e].nodes();
+				boxes[e][0].setZero();
+				boxes[e][0].head(dim) = coarse_nodes[e].colwise().minCoeff();
+				boxes[e][1].setZero();
+				boxes[e][1].head(dim) = coarse_nodes[e].colwise().maxCoeff();
+			}
+
+			SimpleBVH::BVH bvh;
+			bvh.init(boxes);
+
+			fine_sol.setZero(n_fine_bases * actual_dim, 1);
+			maybe_parallel_for(n_fine_bases, [&](int start, int end, int thread_id) {
+				std::vector<unsigned int> candidates;
+				std::vector<assembler::AssemblyValues> vals;
+
+				for (int i = start; i < end; ++i)
+				{
+					Eigen::Vector3d p = Eigen::Vector3d::Zero();
+					p.head(dim) = nodes.row(i).transpose();
+					candidates.clear();
+					bvh.intersect_box(p, p, candidates);
+
+					// element whose reference coordinates are the least outside the reference simplex
+					int best = -1;
+					double best_violation = std::numeric_limits<double>::max();
+					Eigen::MatrixXd best_local;
+					for (const unsigned int e : candidates)
+					{
+						const Eigen::MatrixXd &vs = coarse_nodes[e];
+						Eigen::MatrixXd jac(dim, dim);
+						for (int d = 0; d < dim; ++d)
+							jac.col(d) = (vs.row(d + 1) - vs.row(0)).transpose();
+						const Eigen::VectorXd local = jac.partialPivLu().solve((nodes.row(i) - vs.row(0)).transpose());
+
+						const double violation = std::max({0.0, -local.minCoeff(), local.sum() - 1});
+						if (violation < best_violation)
+						{
+							best_violation = violation;
+							best = e;
+							best_local = local.transpose();
+						}
+					}
+
+					if (best < 0)
+						continue;
+
+					coarse_bases[best].evaluate_bases(best_local, vals);
+					for (int j = 0; j < vals.size(); ++j)
+					{
+						for (const Local2Global &g : coarse_bases[best].bases[j].global())
+						{
+							for (int d = 0; d < actual_dim; ++d)
+								fine_sol(i * actual_dim + d) += vals[j].val(0) * g.val * coarse_sol(g.index * actual_dim + d);
+						}
+					}
+				}
+			});
+
+			return true;
+		}
+	} // namespace
+
+	void State::convergence_study(Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure)
+	{
+		if (!mesh)
+		{
+			logger().error("Load the mesh first!");
+			return;
+		}
+		if (problem->is_time_dependent())
+			log_and_throw_error("Convergence studies are only supported for static problems!");
+		if (!mesh->is_conforming() || mesh->has_node_ids())
+			log_and_throw_error("Convergence studies need a conforming mesh without point selections!");
+
+		const int body_id = mesh->get_body_id(0);
+		for (int e = 1; e < mesh->n_elements(); ++e)
+			if (mesh->get_body_id(e) != body_id)
+				log_and_throw_error("Convergence studies need a uniform volume selection!");
+
+		const json &study_args = args["output"]["advanced"]["convergence_study"];
+		const int n_levels = study_args["levels"];
+		const double refinement_location = json_as_array(args["geometry"])[0]["advanced"]["refinement_location"];
+		const int actual_dim = problem->is_scalar() ? 1 : mesh->dimension();
+
+		json levels = json::array();
+		for (int level = 0; level <= n_levels; ++level)
+		{
+			std::vector<ElementBases> coarse_bases, coarse_gbases;
+			Eigen::MatrixXd coarse_sol;
+			int n_coarse_bases = 0;
+
+			if (level > 0)
+			{
+				const bool iso = iso_parametric();
+				n_coarse_bases = n_bases - obstacle.n_vertices();
+				coarse_sol = sol.topRows(n_coarse_bases * actual_dim);
+				coarse_bases = std::move(bases);
+				coarse_gbases = iso ? coarse_bases : std::move(geom_bases_);
+
+				POLYFEM_SCOPED_TIMER("Refining the mesh", timings.loading_mesh_time);
+				const std::unique_ptr<mesh::Mesh> coarse_mesh = mesh->copy();
+				mesh->refine(1, refinement_location);
+				inherit_boundary_ids(*coarse_mesh, *mesh);
+				mesh->set_body_ids(std::vector<int>(mesh->n_elements(), body_id));
+				out_geom.init_sampler(*mesh, args["output"]["paraview"]["vismesh_rel_area"]);
+			}
+
+			logger().info("Convergence study level {}/{}, {} elements", level, n_levels, mesh->n_elements());
+
+			stats.compute_mesh_stats(*mesh);
+			build_basis();
+
+			prolongated_solution.resize(0, 0);
+			if (level > 0 && mixed_assembler == nullptr)
+			{
+				if (!prolongate(mesh->dimension(), actual_dim, coarse_bases, coarse_gbases, coarse_sol,
+								bases, n_bases - obstacle.n_vertices(), prolongated_solution))
+				{
+					prolongated_solution.resize(0, 0);
+					logger().debug("Prolongation needs P1 simplicial geometry, level {} starts from zero", level);
+				}
+			}
+
+			assemble_rhs();
+			assemble_mass_mat();
+
+			solution_frames.clear();
+			solve_problem(sol, pressure);
+
+			compute_errors(sol);
+
+			json j;
+			stats.save_json(args, n_bases, n_pressure_bases,
+							sol, *mesh, disc_orders, *problem, timings,
+							assembler->name(), iso_parametric(), args["output"]["advanced"]["sol_at_node"],
+							j);
+			j["level"] = level;
+			levels.push_back(j);
+		}
+		prolongated_solution.resize(0, 0);
+
+		// observed orders of convergence between consecutive levels
+		json rates = json::object();
+		for (const std::string key : {"err_l2", "err_h1", "err_h1_semi", "err_linf", "err_lp"})
+		{
+			rates[key] = json::array();
+			for (int level = 1; level <= n_levels; ++level)
+			{
+				const double h0 = levels[level - 1]["mesh_size"], h1 = levels[level]["mesh_size"];
+				const double e0 = levels[level - 1][key], e1 = levels[level][key];
+				rates[key].push_back(std::log(e0 / e1) / std::log(h0 / h1));
+			}
+			logger().info("Convergence rates {}: {}", key, rates[key].dump());
+		}
+
+		const std::string out_path = resolve_output_path(study_args["file"]);
+		if (out_path.empty())
+			return;
+
+		std::ofstream out(out_path);
+		if (!out.is_open())
+		{
+			logger().error("Unable to save convergence study to {}", out_path);
+			return;
+		}
+		json j_study;
+		j_study["levels"] = levels;
+		j_study["rates"] = rates;
+		out << j_study.dump(4) << std::endl;
+	}
+} // namespace polyfem
@@ -8,6 +8,7 @@
 #include <polysolve/linear/FEMSolver.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/StringUtils.hpp>
+#include <polyfem/utils/Timer.hpp>
 #include <polyfem/io/Evaluator.hpp>
 
 #include <polyfem/solver/NLProblem.hpp>
@@ -28,7 +29,11 @@
 
 #include <Eigen/Dense>
 #include <unsupported/Eigen/SparseExtra>
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <filesystem>
+#include <functional>
 #include <map>
 #include <algorithm>
 
@@ -68,21 +73,32 @@ namespace polyfem
 
 	void State::get_vertices(Eigen::MatrixXd &vertices) const
 	{
-		vertices.setZero(mesh->n_vertices(), mesh->dimension());
+		vertices.resize(mesh->n_vertices(), mesh->dimension());
+		get_vertices(MatrixXdView(vertices));
+	}
+
+	void State::get_vertices(MatrixXdView vertices) const
+	{
+		assert(vertices.rows() == mesh->n_vertices() && vertices.cols() == mesh->dimension());
 
 		for (int v = 0; v < mesh->n_vertices(); v++)
 			vertices.row(v) = mesh->point(v);
 	}
 
 	void State::get_elements(Eigen::MatrixXi &elements) const
+	{
+		elements.setZero(geom_bases().size(), mesh->dimension() + 1);
+		get_elements(MatrixXiView(elements));
+	}
+
+	void State::get_elements(MatrixXiView elements) const
 	{
 		assert(mesh->is_simplicial());
 
 		auto node_to_primitive_map = node_to_primitive();
 
 		const auto &gbases = geom_bases();
-		int dim = mesh->dimension();
-		elements.setZero(gbases.size(), dim + 1);
+		assert(elements.rows() == gbases.size() && elements.cols() == mesh->dimension() + 1);
 		for (int e = 0; e < gbases.size(); e++)
 		{
 			int i = 0;
@@ -101,12 +117,32 @@ namespace polyfem
 	{
 		StiffnessMatrix gradu_h(sol.size(), sol.size());
 		if (current_step == 0)
+		{
 			diff_cached.init(mesh->dimension(), ndof(), problem->is_time_dependent() ? args["time"]["time_steps"].get<int>() : 0);
 
+			const std::string spill_dir = args["solver"]["advanced"]["adjoint_spill_dir"];
+			if (problem->is_time_dependent() && (optimization_enabled == solver::CacheLevel::Checkpoints || !spill_dir.empty()))
+			{
+				// the adjoint and the shape derivative access at most max_steps + 1 consecutive steps at once
+				const int max_steps = solve_data.time_integrator ? solve_data.time_integrator->max_steps() : 1;
+				const int budget = std::max(args["solver"]["advanced"]["adjoint_checkpoints"].get<int>(), max_steps + 1);
+				diff_cached.set_checkpoints(budget, [this](const int step, StiffnessMatrix &gradu_h, ipc::Collisions &collision_set, ipc::FrictionCollisions &friction_collision_set) {
+					recompute_transient_adjoint_quantities(step, gradu_h, collision_set, friction_collision_set);
+				});
+
+				if (!spill_dir.empty())
+				{
+					static std::atomic<int> spill_count(0);
+					const std::string path = resolve_output_path((std::filesystem::path(spill_dir) / fmt::format("diff_cache_{}_{}.bin", reinterpret_cast<std::uintptr_t>(this), spill_count++)).string());
+					diff_cached.set_spill(std::make_shared<utils::SparseMatrixSpill>(path));
+				}
+			}
+		}
+
 		ipc::Collisions cur_collision_set;
 		ipc::FrictionCollisions cur_friction_set;
 
-		if (optimization_enabled == solver::CacheLevel::Derivatives)
+		if (solver::caches_derivatives(optimization_enabled))
 		{
 			if (!problem->is_time_dependent() || current_step > 0)
 				compute_force_jacobian(sol, disp_grad, gradu_h);
@@ -161,6 +197,72 @@ namespace polyfem
 		}
 	}
 
+	void State::recompute_transient_adjoint_quantities(const int step, StiffnessMatrix &gradu_h, ipc::Collisions &collision_set, ipc::FrictionCollisions &friction_collision_set)
+	{
+		assert(problem->is_time_dependent() && step > 0);
+		POLYFEM_SCOPED_TIMER("Recompute adjoint quantities");
+		logger().trace("Recomputing the adjoint quantities of step {}", step);
+
+		const double t0 = args["time"]["t0"];
+		const double dt = args["time"]["dt"];
+		const bool quasistatic = args["time"]["quasistatic"];
+		const int last_step = diff_cached.size() - 1;
+		time_integrator::ImplicitTimeIntegrator &time_integrator = *solve_data.time_integrator;
+
+		// previous solutions of a step, most recent first
+		const auto restore_time_integrator = [&](const int n_prevs, const std::function<Eigen::VectorXd(int)> &x, const std::function<Eigen::VectorXd(int)> &v, const std::function<Eigen::VectorXd(int)> &a) {
+			Eigen::MatrixXd x_prevs(ndof(), n_prevs), v_prevs(ndof(), n_prevs), a_prevs(ndof(), n_prevs);
+			for (int j = 0; j < n_prevs; ++j)
+			{
+				x_prevs.col(j) = x(j);
+				v_prevs.col(j) = v(j);
+				a_prevs.col(j) = a(j);
+			}
+			time_integrator.init(x_prevs, v_prevs, a_prevs, dt);
+		};
+
+		const std::deque<Eigen::VectorXd> x_prevs = time_integrator.x_prevs();
+		const std::deque<Eigen::VectorXd> v_prevs = time_integrator.v_prevs();
+		const std::deque<Eigen::VectorXd> a_prevs = time_integrator.a_prevs();
+
+		// state of the forms before solving the step, see solve_transient_tensor_nonlinear
+		const Eigen::VectorXd u_prev = diff_cached.u(step - 1);
+		if (!quasistatic)
+		{
+			restore_time_integrator(
+				std::min(step, time_integrator.max_steps()),
+				[&](int j) { return diff_cached.u(step - 1 - j); },
+				[&](int j) { return diff_cached.v(step - 1 - j); },
+				[&](int j) { return diff_cached.acc(step - 1 - j); });
+		}
+		solve_data.nl_problem->update_quantities(t0 + step * dt, u_prev);
+		if (solve_data.nl_problem->uses_lagging())
+			solve_data.nl_problem->init_lagging(u_prev);
+
+		const Eigen::MatrixXd disp_grad = quasistatic ? diff_cached.disp_grad(step) : Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension());
+		const Eigen::VectorXd u = diff_cached.u(step);
+		gradu_h.resize(u.size(), u.size());
+		compute_force_jacobian(u, disp_grad, gradu_h);
+
+		collision_set = solve_data.contact_form ? solve_data.contact_form->collision_set() : ipc::Collisions();
+		friction_collision_set = solve_data.friction_form && !quasistatic ? solve_data.friction_form->friction_collision_set() : ipc::FrictionCollisions();
+
+		// back to the state at the end of the forward solve
+		if (!quasistatic)
+		{
+			restore_time_integrator(
+				x_prevs.size(),
+				[&](int j) { return x_prevs[j]; },
+				[&](int j) { return v_prevs[j]; },
+				[&](int j) { return a_prevs[j]; });
+		}
+		const Eigen::VectorXd u_last = diff_cached.u(last_step);
+		if (solve_data.nl_problem->uses_lagging())
+			solve_data.nl_problem->init_lagging(diff_cached.u(std::max(last_step - 1, 0)));
+		solve_data.nl_problem->update_quantities(t0 + (last_step + 1) * dt, u_last);
+		solve_data.nl_problem->FullNLProblem::solution_changed(u_last);
+	}
+
 	void State::compute_force_jacobian(const Eigen::MatrixXd &sol, const Eigen::MatrixXd &disp_grad, StiffnessMatrix &hessian)
 	{
 		if (problem->is_time_dependent())
@@ -330,6 +432,37 @@ namespace polyfem
 			return solve_static_adjoint(rhs);
 	}
 
+	std::vector<Eigen::MatrixXd> State::solve_adjoint(const std::vector<Eigen::MatrixXd> &rhs) const
+	{
+		if (problem->is_time_dependent())
+			return solve_transient_adjoint(rhs);
+
+		// the columns of all the right-hand sides share the factorization
+		int n_cols = 0;
+		for (const Eigen::MatrixXd &r : rhs)
+			n_cols += r.cols();
+
+		Eigen::MatrixXd stacked(ndof(), n_cols);
+		n_cols = 0;
+		for (const Eigen::MatrixXd &r : rhs)
+		{
+			assert(r.rows() == ndof());
+			stacked.middleCols(n_cols, r.cols()) = r;
+			n_cols += r.cols();
+		}
+
+		const Eigen::MatrixXd adjoint = solve_static_adjoint(stacked);
+
+		std::vector<Eigen::MatrixXd> adjoints(rhs.size());
+		n_cols = 0;
+		for (int k = 0; k < rhs.size(); k++)
+		{
+			adjoints[k] = adjoint.middleCols(n_cols, rhs[k].cols());
+			n_cols += rhs[k].cols();
+		}
+		return adjoints;
+	}
+
 	Eigen::MatrixXd State::solve_static_adjoint(const Eigen::MatrixXd &adjoint_rhs) const
 	{
 		Eigen::MatrixXd b = adjoint_rhs;
@@ -401,6 +534,11 @@ namespace polyfem
 	}
 
 	Eigen::MatrixXd State::solve_transient_adjoint(const Eigen::MatrixXd &adjoint_rhs) const
+	{
+		return solve_transient_adjoint(std::vector<Eigen::MatrixXd>{adjoint_rhs})[0];
+	}
+
+	std::vector<Eigen::MatrixXd> State::solve_transient_adjoint(const std::vector<Eigen::MatrixXd> &adjoint_rhs) const
 	{
 		const double dt = args["time"]["dt"];
 		const int time_steps = args["time"]["time_steps"];
@@ -415,34 +553,40 @@ namespace polyfem
 		else
 			log_and_throw_adjoint_error("Integrator type not supported for differentiability.");
 
-		assert(adjoint_rhs.cols() == time_steps + 1);
-
+		const int n_rhs = adjoint_rhs.size();
 		const int cols_per_adjoint = time_steps + 1;
-		Eigen::MatrixXd adjoints;
-		adjoints.setZero(ndof(), cols_per_adjoint * 2);
+		std::vector<Eigen::MatrixXd> adjoints(n_rhs);
+		for (int k = 0; k < n_rhs; k++)
+		{
+			assert(adjoint_rhs[k].cols() == time_steps + 1);
+			adjoints[k].setZero(ndof(), cols_per_adjoint * 2);
+		}
 
 		// set dirichlet rows of mass to identity
 		StiffnessMatrix reduced_mass;
 		replace_rows_by_identity(reduced_mass, mass, boundary_nodes);
 
-		Eigen::MatrixXd sum_alpha_p, sum_alpha_nu;
+		// one column per right-hand side
+		Eigen::MatrixXd sum_alpha_p(ndof(), n_rhs), sum_alpha_nu(ndof(), n_rhs), rhs_(ndof(), n_rhs);
 		for (int i = time_steps; i >= 0; --i)
 		{
 			{
-				sum_alpha_p.setZero(ndof(), 1);
-				sum_alpha_nu.setZero(ndof(), 1);
-
 				const int num = std::min(bdf_order, time_steps - i);
 
 				Eigen::VectorXd bdf_coeffs = Eigen::VectorXd::Zero(num);
 				for (int j = 0; j < bdf_order && i + j < time_steps; ++j)
 					bdf_coeffs(j) = -time_integrator::BDF::alphas(std::min(bdf_order - 1, i + j))[j];
 
-				sum_alpha_p = adjoints.middleCols(i + 1, num) * bdf_coeffs;
-				sum_alpha_nu = adjoints.middleCols(cols_per_adjoint + i + 1, num) * bdf_coeffs;
+				for (int k = 0; k < n_rhs; k++)
+				{
+					sum_alpha_p.col(k) = adjoints[k].middleCols(i + 1, num) * bdf_coeffs;
+					sum_alpha_nu.col(k) = adjoints[k].middleCols(cols_per_adjoint + i + 1, num) * bdf_coeffs;
+				}
 			}
 
-			Eigen::VectorXd rhs_ = -reduced_mass.transpose() * sum_alpha_nu - adjoint_rhs.col(i);
+			rhs_ = -reduced_mass.transpose() * sum_alpha_nu;
+			for (int k = 0; k < n_rhs; k++)
+				rhs_.col(k) -= adjoint_rhs[k].col(i);
 			for (int j = 1; j <= bdf_order; j++)
 			{
 				if (i + j > time_steps)
@@ -450,8 +594,10 @@ namespace polyfem
 
 				StiffnessMatrix gradu_h_prev;
 				compute_force_jacobian_prev(i + j, i, gradu_h_prev);
-				Eigen::VectorXd tmp = adjoints.col(i + j) * (time_integrator::BDF::betas(diff_cached.bdf_order(i + j) - 1) * dt);
-				tmp(boundary_nodes).setZero();
+				Eigen::MatrixXd tmp(ndof(), n_rhs);
+				for (int k = 0; k < n_rhs; k++)
+					tmp.col(k) = adjoints[k].col(i + j) * (time_integrator::BDF::betas(diff_cached.bdf_order(i + j) - 1) * dt);
+				tmp(boundary_nodes, Eigen::all).setZero();
 				rhs_ += -gradu_h_prev.transpose() * tmp;
 			}
 
@@ -463,31 +609,46 @@ namespace polyfem
 
 				{
 					StiffnessMatrix A = diff_cached.gradu_h(i).transpose();
-					Eigen::VectorXd b_ = rhs_;
-					b_(boundary_nodes).setZero();
 
+					// factorized once for all the right-hand sides
 					auto solver = polysolve::linear::Solver::create(args["solver"]["adjoint_linear"], adjoint_logger());
+					StiffnessMatrix A_tmp = A;
+					prefactorize(*solver, A_tmp, boundary_nodes, A.rows(), "");
 
-					Eigen::VectorXd x;
-					dirichlet_solve(*solver, A, b_, boundary_nodes, x, A.rows(), "", false, false, false);
-					adjoints.col(i + cols_per_adjoint) = x;
-				}
+					for (int k = 0; k < n_rhs; k++)
+					{
+						Eigen::VectorXd b_ = rhs_.col(k);
+						b_(boundary_nodes).setZero();
 
-				// TODO: generalize to BDFn
-				Eigen::VectorXd tmp = rhs_(boundary_nodes);
-				if (i + 1 < cols_per_adjoint)
-					tmp += (-2. / beta_dt) * adjoints(boundary_nodes, i + 1);
-				if (i + 2 < cols_per_adjoint)
-					tmp += (1. / beta_dt) * adjoints(boundary_nodes, i + 2);
+						Eigen::VectorXd x;
+						dirichlet_solve_prefactorized(*solver, A, b_, boundary_nodes, x);
+						adjoints[k].col(i + cols_per_adjoint) = x;
+					}
+				}
 
-				tmp -= (diff_cached.gradu_h(i).transpose() * adjoints.col(i + cols_per_adjoint))(boundary_nodes);
-				adjoints(boundary_nodes, i + cols_per_adjoint) = tmp;
-				adjoints.col(i) = beta_dt * adjoints.col(i + cols_per_adjoint) - sum_alpha_p;
+				for (int k = 0; k < n_rhs; k++)
+				{
+					Eigen::MatrixXd &adjoint = adjoints[k];
+
+					// TODO: generalize to BDFn
+					Eigen::VectorXd tmp = rhs_.col(k)(boundary_nodes);
+					if (i + 1 < cols_per_adjoint)
+						tmp += (-2. / beta_dt) * adjoint(boundary_nodes, i + 1);
+					if (i + 2 < cols_per_adjoint)
+						tmp += (1. / beta_dt) * adjoint(boundary_nodes, i + 2);
+
+					tmp -= (diff_cached.gradu_h(i).transpose() * adjoint.col(i + cols_per_adjoint))(boundary_nodes);
+					adjoint(boundary_nodes, i + cols_per_adjoint) = tmp;
+					adjoint.col(i) = beta_dt * adjoint.col(i + cols_per_adjoint) - sum_alpha_p.col(k);
+				}
 			}
 			else
 			{
-				adjoints.col(i) = -reduced_mass.transpose() * sum_alpha_p;
-				adjoints.col(i + cols_per_adjoint) = rhs_; // adjoint_nu[0] actually stores adjoint_mu[0]
+				for (int k = 0; k < n_rhs; k++)
+				{
+					adjoints[k].col(i) = -reduced_mass.transpose() * sum_alpha_p.col(k);
+					adjoints[k].col(i + cols_per_adjoint) = rhs_.col(k); // adjoint_nu[0] actually stores adjoint_mu[0]
+				}
 			}
 		}
 		return adjoints;
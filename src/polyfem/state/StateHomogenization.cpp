@@ -33,6 +33,8 @@ namespace polyfem
 		const int dim = mesh->dimension();
 		const int ndof = n_bases * dim;
 
+		assemble_hourglass_stiffness();
+
 		const std::vector<std::shared_ptr<Form>> forms = solve_data.init_forms(
 			// General
 			units,
@@ -59,7 +61,7 @@ namespace polyfem
 			args["solver"]["contact"]["CCD"]["broad_phase"],
 			args["solver"]["contact"]["CCD"]["tolerance"],
 			args["solver"]["contact"]["CCD"]["max_iterations"],
-			optimization_enabled == solver::CacheLevel::Derivatives,
+			solver::caches_derivatives(optimization_enabled),
 			// Homogenization
 			macro_strain_constraint,
 			// Periodic contact
@@ -69,7 +71,11 @@ namespace polyfem
 			args["contact"]["epsv"],
 			args["solver"]["contact"]["friction_iterations"],
 			// Rayleigh damping form
-			args["solver"]["rayleigh_damping"]);
+			args["solver"]["rayleigh_damping"],
+			// Implicit obstacles
+			{},
+			// Hourglass form
+			hourglass_stiffness);
 
 		for (const auto &[name, form] : solve_data.named_forms())
 		{
@@ -270,6 +276,25 @@ namespace polyfem
 			cache_transient_adjoint_quantities(t, sol, utils::unflatten(extended_sol.tail(dim * dim), dim));
 	}
 
+	void State::compute_homogenized_stiffness(const double t, Eigen::MatrixXd &stiffness)
+	{
+		if (!assembler->is_linear())
+			logger().warn("Homogenized stiffness of a nonlinear cell is only the tangent at zero fluctuation");
+
+		init_homogenization_solve(t);
+		auto homo_problem = std::dynamic_pointer_cast<NLHomoProblem>(solve_data.nl_problem);
+
+		const Eigen::VectorXi fixed_entry = macro_strain_constraint.get_fixed_entry();
+		homo_problem->set_fixed_entry({});
+
+		std::unique_ptr<polysolve::linear::Solver> solver =
+			polysolve::linear::Solver::create(args["solver"]["linear"], logger());
+		const Eigen::VectorXd x = Eigen::VectorXd::Zero(homo_problem->reduced_size() + homo_problem->macro_reduced_size());
+		stiffness = homo_problem->effective_stiffness(x, *solver);
+
+		homo_problem->set_fixed_entry(fixed_entry);
+	}
+
 	void State::solve_homogenization(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol)
 	{
 		bool is_static = !is_param_valid(args, "time");
@@ -13,12 +13,14 @@
 #include <polyfem/utils/par_for.hpp>
 
 #include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/Profiler.hpp>
 
 #include <jse/jse.h>
 
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/ostream_sink.h>
+#include <spdlog/async.h>
 
 #include <ipc/utils/logger.hpp>
 #include <wmtk/utils/Logger.hpp>
@@ -26,7 +28,10 @@
 #include <polyfem/mesh/mesh2D/Mesh2D.hpp>
 #include <polyfem/mesh/mesh3D/Mesh3D.hpp>
 
+#include <algorithm>
+#include <mutex>
 #include <sstream>
+#include <unordered_set>
 
 namespace spdlog::level
 {
@@ -53,6 +58,75 @@ namespace polyfem
 	using namespace problem;
 	using namespace utils;
 
+	namespace
+	{
+		/// input spec with the includes and default solvers resolved, loaded once per process
+		const json &input_rules()
+		{
+			static const json rules = [] {
+				const std::string polyfem_input_spec = POLYFEM_INPUT_SPEC;
+				std::ifstream file(polyfem_input_spec);
+
+				json rules;
+				if (file.is_open())
+					file >> rules;
+				else
+				{
+					logger().error("unable to open {} rules", polyfem_input_spec);
+					throw std::runtime_error("Invald spec file");
+				}
+
+				jse::JSE jse;
+				jse.include_directories.push_back(POLYFEM_JSON_SPEC_DIR);
+				jse.include_directories.push_back(POLYSOLVE_JSON_SPEC_DIR);
+				rules = jse.inject_include(rules);
+
+				polysolve::linear::Solver::apply_default_solver(rules, "/solver/linear");
+				polysolve::linear::Solver::apply_default_solver(rules, "/solver/adjoint_linear");
+				return rules;
+			}();
+			return rules;
+		}
+
+		/// Messages waiting for the logging thread, the oldest ones are dropped when it is full so the solver never blocks
+		constexpr size_t ASYNC_LOG_QUEUE_SIZE = 8192;
+
+		std::shared_ptr<spdlog::logger> make_logger(
+			const std::string &name, const std::vector<spdlog::sink_ptr> &sinks, const bool async)
+		{
+			if (!async)
+				return std::make_shared<spdlog::logger>(name, sinks.begin(), sinks.end());
+
+			// shared by all the loggers, replacing it would invalidate the existing async loggers
+			if (!spdlog::thread_pool())
+				spdlog::init_thread_pool(ASYNC_LOG_QUEUE_SIZE, 1);
+			return std::make_shared<spdlog::async_logger>(
+				name, sinks.begin(), sinks.end(), spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+		}
+
+		/// Serializes the installation of the process-wide loggers by concurrent States
+		std::mutex loggers_mutex;
+
+		/// The ipc and wmtk loggers are replaced without synchronization of their readers, the previous
+		/// ones are kept alive for the solves still holding a reference to them
+		std::vector<std::shared_ptr<spdlog::logger>> retired_loggers;
+
+		std::mutex validated_inputs_mutex;
+		std::unordered_set<size_t> validated_inputs;
+
+		bool is_validated_input(const size_t hash)
+		{
+			std::lock_guard<std::mutex> lock(validated_inputs_mutex);
+			return validated_inputs.count(hash) > 0;
+		}
+
+		void add_validated_input(const size_t hash)
+		{
+			std::lock_guard<std::mutex> lock(validated_inputs_mutex);
+			validated_inputs.insert(hash);
+		}
+	} // namespace
+
 	State::State()
 	{
 		using namespace polysolve;
@@ -66,7 +140,8 @@ namespace polyfem
 		const std::string &log_file,
 		const spdlog::level::level_enum log_level,
 		const spdlog::level::level_enum file_log_level,
-		const bool is_quiet)
+		const bool is_quiet,
+		const bool async)
 	{
 		std::vector<spdlog::sink_ptr> sinks;
 
@@ -84,7 +159,7 @@ namespace polyfem
 			sinks.push_back(file_sink_);
 		}
 
-		init_logger(sinks, log_level);
+		init_logger(sinks, log_level, async);
 		spdlog::flush_every(std::chrono::seconds(3));
 	}
 
@@ -97,14 +172,21 @@ namespace polyfem
 
 	void State::init_logger(
 		const std::vector<spdlog::sink_ptr> &sinks,
-		const spdlog::level::level_enum log_level)
+		const spdlog::level::level_enum log_level,
+		const bool async)
 	{
-		set_logger(std::make_shared<spdlog::logger>("polyfem", sinks.begin(), sinks.end()));
+		std::lock_guard<std::mutex> lock(loggers_mutex);
+
+		set_logger(make_logger("polyfem", sinks, async));
 		GeogramUtils::instance().set_logger(logger());
 
-		ipc::set_logger(std::make_shared<spdlog::logger>("ipctk", sinks.begin(), sinks.end()));
+		const std::shared_ptr<spdlog::logger> ipc_logger = make_logger("ipctk", sinks, async);
+		retired_loggers.push_back(ipc_logger);
+		ipc::set_logger(ipc_logger);
 
-		wmtk::set_logger(std::make_shared<spdlog::logger>("wmtk", sinks.begin(), sinks.end()));
+		const std::shared_ptr<spdlog::logger> wmtk_logger = make_logger("wmtk", sinks, async);
+		retired_loggers.push_back(wmtk_logger);
+		wmtk::set_logger(wmtk_logger);
 
 		// Set the logger at the lowest level, so all messages are passed to the sinks
 		logger().set_level(spdlog::level::trace);
@@ -121,6 +203,12 @@ namespace polyfem
 		{
 			// Set only the level of the console
 			console_sink_->set_level(log_level); // Shared by all loggers
+
+			// The loggers drop the messages no sink prints before formatting them
+			const spdlog::level::level_enum min_level = file_sink_ ? std::min(log_level, file_sink_->level()) : log_level;
+			logger().set_level(min_level);
+			ipc::logger().set_level(min_level);
+			wmtk::logger().set_level(min_level);
 		}
 		else
 		{
@@ -137,28 +225,9 @@ namespace polyfem
 		apply_common_params(args_in);
 
 		// CHECK validity json
-		json rules;
+		const json &rules = input_rules();
 		jse::JSE jse;
-		{
-			jse.strict = strict_validation;
-			const std::string polyfem_input_spec = POLYFEM_INPUT_SPEC;
-			std::ifstream file(polyfem_input_spec);
-
-			if (file.is_open())
-				file >> rules;
-			else
-			{
-				logger().error("unable to open {} rules", polyfem_input_spec);
-				throw std::runtime_error("Invald spec file");
-			}
-
-			jse.include_directories.push_back(POLYFEM_JSON_SPEC_DIR);
-			jse.include_directories.push_back(POLYSOLVE_JSON_SPEC_DIR);
-			rules = jse.inject_include(rules);
-
-			polysolve::linear::Solver::apply_default_solver(rules, "/solver/linear");
-			polysolve::linear::Solver::apply_default_solver(rules, "/solver/adjoint_linear");
-		}
+		jse.strict = strict_validation;
 
 		polysolve::linear::Solver::select_valid_solver(args_in["solver"]["linear"], logger());
 		if (args_in["solver"]["adjoint_linear"].is_null())
@@ -185,12 +254,18 @@ namespace polyfem
 			}
 		}
 
-		const bool valid_input = jse.verify_json(args_in, rules);
-
-		if (!valid_input)
+		// inputs that already passed validation in this process are trusted
+		const size_t input_hash = std::hash<std::string>()(args_in.dump()) ^ size_t(strict_validation);
+		if (!is_validated_input(input_hash))
 		{
-			logger().error("invalid input json:\n{}", jse.log2str());
-			throw std::runtime_error("Invald input json file");
+			const bool valid_input = jse.verify_json(args_in, rules);
+
+			if (!valid_input)
+			{
+				logger().error("invalid input json:\n{}", jse.log2str());
+				throw std::runtime_error("Invald input json file");
+			}
+			add_validated_input(input_hash);
 		}
 		// end of check
 
@@ -222,6 +297,9 @@ namespace polyfem
 		const unsigned int thread_in = this->args["solver"]["max_threads"];
 		set_max_threads(thread_in);
 
+		if (!this->args["output"]["advanced"]["profile"].get<std::string>().empty())
+			utils::Profiler::instance().set_enabled(true);
+
 		has_dhat = args_in["contact"].contains("dhat");
 
 		init_time();
@@ -302,7 +380,10 @@ namespace polyfem
 
 		problem->set_units(*assembler, units);
 
-		if (optimization_enabled == solver::CacheLevel::Derivatives)
+		if (optimization_enabled == solver::CacheLevel::Derivatives && args["solver"]["advanced"]["adjoint_checkpoints"].get<int>() > 0)
+			optimization_enabled = solver::CacheLevel::Checkpoints;
+
+		if (solver::caches_derivatives(optimization_enabled))
 		{
 			if (is_contact_enabled())
 			{
@@ -30,9 +30,11 @@ namespace polyfem
 		polys.clear();
 		poly_edge_to_data.clear();
 		obstacle.clear();
+		a_posteriori_disc_orders.resize(0);
 
 		mass.resize(0, 0);
 		rhs.resize(0, 0);
+		prolongated_solution.resize(0, 0);
 
 		n_bases = 0;
 		n_pressure_bases = 0;
@@ -88,6 +90,16 @@ namespace polyfem
 		out_geom.init_sampler(*mesh, args["output"]["paraview"]["vismesh_rel_area"]);
 	}
 
+	void State::load_mesh(const double *V, const int n_vertices, const int dim, const int *F, const int n_elements, const int size, bool non_conforming)
+	{
+		// the interleaved buffers are seen as column major matrices with swapped strides
+		typedef Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> Stride;
+		const Eigen::Map<const Eigen::MatrixXd, 0, Stride> vertices(V, n_vertices, dim, Stride(1, dim));
+		const Eigen::Map<const Eigen::MatrixXi, 0, Stride> elements(F, n_elements, size, Stride(1, size));
+
+		load_mesh(vertices, elements, non_conforming);
+	}
+
 	void State::load_mesh(bool non_conforming,
 						  const std::vector<std::string> &names,
 						  const std::vector<Eigen::MatrixXi> &cells,
@@ -0,0 +1,180 @@
+#include <polyfem/State.hpp>
+
+#include <polyfem/solver/forms/ContactForm.hpp>
+#include <polyfem/solver/forms/ElasticForm.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace polyfem
+{
+	using namespace basis;
+	using namespace utils;
+
+	namespace
+	{
+		size_t bases_memory_usage(const std::vector<ElementBases> &bases)
+		{
+			size_t bytes = memory_usage(bases);
+			for (const ElementBases &b : bases)
+			{
+				bytes += memory_usage(b.bases);
+				for (const Basis &basis : b.bases)
+					bytes += memory_usage(basis.global());
+			}
+			return bytes;
+		}
+
+		/// bytes of the values of the bases of an element evaluated at n_quad points
+		size_t values_memory_usage(const ElementBases &bases, const int n_quad, const int dim)
+		{
+			size_t bytes = bases.bases.size() * (sizeof(assembler::AssemblyValues) + (2 * dim + 1) * n_quad * sizeof(double));
+			for (const Basis &basis : bases.bases)
+				bytes += basis.global().size() * sizeof(Local2Global);
+			return bytes;
+		}
+
+		/// bytes of the assembly values of an element, see ElementAssemblyValues::memory_usage
+		size_t element_values_memory_usage(const ElementBases &bases, const ElementBases &gbases, const bool iso_parametric, const int n_quad, const int dim)
+		{
+			size_t bytes = sizeof(assembler::ElementAssemblyValues) + values_memory_usage(bases, n_quad, dim);
+			if (!iso_parametric)
+				bytes += values_memory_usage(gbases, n_quad, dim);
+			// jacobians, quadrature points and weights, mapped points and determinants
+			bytes += n_quad * (dim * dim + 2 * dim + 2) * sizeof(double);
+			return bytes;
+		}
+
+		double to_mb(const size_t bytes)
+		{
+			return bytes / double(1 << 20);
+		}
+	} // namespace
+
+	void State::record_memory_usage()
+	{
+		stats.memory.record("bases", bases_memory_usage(bases) + bases_memory_usage(pressure_bases) + bases_memory_usage(geom_bases_));
+		stats.memory.record("assembly_values_cache", ass_vals_cache.memory_usage() + mass_ass_vals_cache.memory_usage() + pressure_ass_vals_cache.memory_usage());
+		stats.memory.record("mass_matrix", memory_usage(mass));
+
+		if (solve_data.elastic_form)
+			stats.memory.record("stiffness_and_hessian_cache", solve_data.elastic_form->memory_usage());
+		if (solve_data.contact_form)
+			stats.memory.record("collision_set", memory_usage(solve_data.contact_form->collision_set()));
+
+		size_t frames_bytes = memory_usage(solution_frames);
+		for (const io::SolutionFrame &frame : solution_frames)
+		{
+			frames_bytes += memory_usage(frame.points) + memory_usage(frame.connectivity) + memory_usage(frame.solution)
+							+ memory_usage(frame.pressure) + memory_usage(frame.exact) + memory_usage(frame.error)
+							+ memory_usage(frame.scalar_value) + memory_usage(frame.scalar_value_avg);
+		}
+		if (solution_frame_buffer)
+			frames_bytes += solution_frame_buffer->memory_usage();
+		stats.memory.record("solution_frames", frames_bytes);
+
+		stats.memory.record("diff_cache", diff_cached.memory_usage());
+	}
+
+	json State::estimate_memory() const
+	{
+		if (!mesh || n_bases <= 0)
+			log_and_throw_error("Build the bases first!");
+
+		const int dim = mesh->dimension();
+		const int problem_dim = problem->is_scalar() ? 1 : dim;
+		const bool iso = iso_parametric();
+		const std::vector<ElementBases> &gbases = geom_bases();
+
+		size_t cache_bytes = 0;
+		size_t hessian_slots = 0;
+		std::vector<std::vector<int>> adjacency(n_bases);
+		quadrature::Quadrature quad;
+		for (int e = 0; e < bases.size(); ++e)
+		{
+			const ElementBases &b = bases[e];
+
+			b.compute_quadrature(quad);
+			cache_bytes += element_values_memory_usage(b, gbases[e], iso, quad.size(), dim);
+			b.compute_mass_quadrature(quad);
+			cache_bytes += element_values_memory_usage(b, gbases[e], iso, quad.size(), dim);
+
+			std::vector<int> nodes;
+			for (const Basis &basis : b.bases)
+				for (const Local2Global &l2g : basis.global())
+					nodes.push_back(l2g.index);
+			std::sort(nodes.begin(), nodes.end());
+			nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+			for (const int i : nodes)
+				adjacency[i].insert(adjacency[i].end(), nodes.begin(), nodes.end());
+
+			const size_t n_local = b.bases.size() * problem_dim;
+			hessian_slots += n_local * n_local;
+		}
+
+		size_t node_nnz = 0;
+		for (std::vector<int> &row : adjacency)
+		{
+			std::sort(row.begin(), row.end());
+			row.erase(std::unique(row.begin(), row.end()), row.end());
+			node_nnz += row.size();
+			std::vector<int>().swap(row);
+		}
+
+		const size_t ndof = size_t(n_bases) * problem_dim;
+		const size_t nnz = node_nnz * problem_dim * problem_dim;
+		const size_t matrix_bytes = nnz * (sizeof(double) + sizeof(StorageIndex)) + (ndof + 1) * sizeof(StorageIndex);
+		// the mass matrix only couples the same component of the nodes
+		const size_t mass_nnz = node_nnz * problem_dim;
+		const size_t mass_bytes = mass_nnz * (sizeof(double) + sizeof(StorageIndex)) + (ndof + 1) * sizeof(StorageIndex);
+		// pattern, mapping and element-to-slot map, plus the triplets of the first assembly
+		const size_t hessian_cache_bytes = matrix_bytes + nnz * (sizeof(double) + sizeof(int) + sizeof(std::pair<int, size_t>)) + hessian_slots * sizeof(int)
+										   + hessian_slots * (sizeof(Eigen::Triplet<double>) + sizeof(std::pair<int, int>));
+		// nested dissection fill-in grows as n log n in 2D and n^{4/3} in 3D
+		const double fill = dim == 2 ? std::max(1.0, std::log2(double(n_bases))) : std::max(1.0, std::cbrt(double(n_bases)));
+		const size_t factorization_bytes = size_t(nnz / 2 * fill) * (sizeof(double) + sizeof(StorageIndex));
+
+		json j;
+		j["n_bases"] = n_bases;
+		j["n_dofs"] = ndof;
+		j["nnz"] = nnz;
+		j["subsystems"] = {
+			{"bases", to_mb(bases_memory_usage(bases) + bases_memory_usage(pressure_bases) + bases_memory_usage(geom_bases_))},
+			{"assembly_values_cache", n_bases <= args["solver"]["advanced"]["cache_size"] ? to_mb(cache_bytes) : 0.},
+			{"mass_matrix", to_mb(mass_bytes)},
+			{"stiffness_and_hessian_cache", to_mb(problem->is_time_dependent() || !assembler->is_linear() ? hessian_cache_bytes : matrix_bytes)},
+			{"linear_solver_factorization", to_mb(factorization_bytes)},
+		};
+		double total = 0;
+		for (const auto &mb : j["subsystems"])
+			total += mb.get<double>();
+		j["total"] = total;
+
+		return j;
+	}
+
+	void State::save_memory_estimate() const
+	{
+		const json estimate = estimate_memory();
+		for (const auto &el : estimate["subsystems"].items())
+			logger().info("estimated memory {}: {:.2f}MB", el.key(), el.value().get<double>());
+		logger().info("estimated memory total: {:.2f}MB", estimate["total"].get<double>());
+
+		const std::string out_path = resolve_output_path(args["output"]["json"]);
+		if (out_path.empty())
+			return;
+
+		std::ofstream out(out_path);
+		if (!out.is_open())
+		{
+			logger().error("Unable to save memory estimate to {}", out_path);
+			return;
+		}
+		json j;
+		j["memory_estimate"] = estimate;
+		out << j.dump(4) << std::endl;
+	}
+} // namespace polyfem
@@ -0,0 +1,116 @@
+#include <polyfem/State.hpp>
+
+#include <polyfem/StateObserver.hpp>
+#include <polyfem/assembler/AssemblerData.hpp>
+#include <polyfem/solver/forms/ContactForm.hpp>
+#include <polyfem/time_integrator/ImplicitTimeIntegrator.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace polyfem
+{
+	using namespace utils;
+
+	namespace
+	{
+		/// values of the scalar fields of the formulation at the element centers, NaN on polygonal elements
+		std::vector<std::pair<std::string, Eigen::VectorXd>> element_center_fields(
+			const mesh::Mesh &mesh,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const assembler::Assembler &assembler,
+			const std::vector<std::string> &names,
+			const Eigen::MatrixXd &sol,
+			const double t)
+		{
+			const int n_elements = bases.size();
+			const int dim = mesh.dimension();
+
+			std::vector<std::pair<std::string, Eigen::VectorXd>> fields;
+			for (const std::string &name : names)
+				fields.emplace_back(name, Eigen::VectorXd::Constant(n_elements, std::numeric_limits<double>::quiet_NaN()));
+
+			maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+				std::vector<assembler::Assembler::NamedMatrix> values;
+				Eigen::MatrixXd center(1, dim);
+				for (int e = start; e < end; ++e)
+				{
+					if (mesh.is_simplex(e))
+						center.setConstant(1.0 / (dim + 1));
+					else if (mesh.is_cube(e))
+						center.setConstant(0.5);
+					else
+						continue;
+
+					values.clear();
+					assembler.compute_scalar_value(assembler::OutputData(t, e, bases[e], gbases[e], center, sol), values);
+					for (const auto &[name, value] : values)
+					{
+						const auto it = std::find(names.begin(), names.end(), name);
+						if (it != names.end() && value.size() > 0)
+							fields[it - names.begin()].second(e) = value(0);
+					}
+				}
+			});
+
+			return fields;
+		}
+	} // namespace
+
+	void State::add_observer(const std::shared_ptr<StateObserver> &observer)
+	{
+		assert(observer != nullptr);
+		if (std::find(observers_.begin(), observers_.end(), observer) == observers_.end())
+			observers_.push_back(observer);
+	}
+
+	void State::remove_observer(const std::shared_ptr<StateObserver> &observer)
+	{
+		wait_for_async_export();
+		observers_.erase(std::remove(observers_.begin(), observers_.end(), observer), observers_.end());
+	}
+
+	void State::notify_observers(StateEvent &event)
+	{
+		if (observers_.empty())
+			return;
+
+		if (solve_data.time_integrator != nullptr)
+			event.velocity = &solve_data.time_integrator->v_prev();
+		if (solve_data.contact_form != nullptr)
+			event.collisions = &solve_data.contact_form->collision_set();
+
+		for (const std::shared_ptr<StateObserver> &observer : observers_)
+			observer->on_event(*this, event);
+
+		if (event.type != StateEvent::Type::TIME_STEP || problem->is_scalar())
+			return;
+
+		// the element fields of the formulation are only defined for tensor problems
+		std::vector<std::shared_ptr<StateObserver>> async_observers;
+		for (const std::shared_ptr<StateObserver> &observer : observers_)
+		{
+			const std::vector<std::string> names = observer->element_fields();
+			if (names.empty())
+				continue;
+			if (observer->async_element_fields())
+			{
+				async_observers.push_back(observer);
+				continue;
+			}
+			observer->on_element_fields(event.step, event.t, element_center_fields(*mesh, bases, geom_bases(), *assembler, names, event.solution, event.t));
+		}
+
+		if (async_observers.empty())
+			return;
+
+		// one evaluation runs at a time, it reads the bases that the next remesh replaces
+		wait_for_async_export();
+		async_observer_fields_ = std::async(std::launch::async, [this, async_observers, sol = Eigen::MatrixXd(event.solution), step = event.step, t = event.t]() {
+			for (const std::shared_ptr<StateObserver> &observer : async_observers)
+				observer->on_element_fields(step, t, element_center_fields(*mesh, bases, geom_bases(), *assembler, observer->element_fields(), sol, t));
+		});
+	}
+} // namespace polyfem
@@ -1,6 +1,7 @@
 #include <polyfem/State.hpp>
 
 #include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/Profiler.hpp>
 #include <polyfem/utils/Timer.hpp>
 
 #include <filesystem>
@@ -19,7 +20,7 @@ namespace polyfem
 			tend = args["time"]["tend"];
 		}
 
-		stats.compute_errors(n_bases, bases, geom_bases(), *mesh, *problem, tend, sol);
+		stats.compute_errors(n_bases, bases, geom_bases(), ass_vals_cache, *mesh, *problem, tend, sol);
 	}
 
 	std::string State::root_path() const
@@ -45,28 +46,134 @@ namespace polyfem
 
 	void State::save_timestep(const double time, const int t, const double t0, const double dt, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure)
 	{
+		record_memory_usage();
+
+		StateEvent event(StateEvent::Type::TIME_STEP, t, time, sol);
+		notify_observers(event);
+
+		if (!args["output"]["probes"]["points"].empty())
+		{
+			POLYFEM_SCOPED_TIMER("Saving probes");
+			if (!probe_writer_)
+			{
+				const auto probes = args["output"]["probes"]["points"].get<std::vector<std::vector<double>>>();
+				Eigen::MatrixXd points(probes.size(), mesh->dimension());
+				for (int i = 0; i < probes.size(); ++i)
+				{
+					if (probes[i].size() != mesh->dimension())
+						log_and_throw_error("Probe {} has {} coordinates in a {}D mesh.", i, probes[i].size(), mesh->dimension());
+					for (int d = 0; d < mesh->dimension(); ++d)
+						points(i, d) = probes[i][d];
+				}
+				probe_writer_ = std::make_unique<io::ProbeWriter>(
+					resolve_output_path(args["output"]["probes"]["file_name"].get<std::string>()), points,
+					args["output"]["probes"]["scalar_values"].get<bool>());
+			}
+			const int actual_dim = problem->is_scalar() ? 1 : mesh->dimension();
+			probe_writer_->write_step(t, time, *mesh, bases, geom_bases(), *assembler, n_bases, actual_dim, sol);
+		}
+
 		if (args["output"]["advanced"]["save_time_sequence"] && !(t % args["output"]["paraview"]["skip_frame"].get<int>()))
 		{
 			logger().trace("Saving VTU...");
 			POLYFEM_SCOPED_TIMER("Saving VTU");
 			const std::string step_name = args["output"]["advanced"]["timestep_prefix"];
+			const std::string vtu_path = resolve_output_path(fmt::format(step_name + "{:d}.vtu", t));
+			const std::string pvd_path = resolve_output_path(args["output"]["paraview"]["file_name"]);
+			const int skip_frame = args["output"]["paraview"]["skip_frame"];
+			const io::OutGeometryData::ExportOptions opts(args, mesh->is_linear(), problem->is_scalar(), solve_export_to_file);
+
+			// Only one step is exported at a time so the pvd is written in order
+			wait_for_async_export();
+
+			if (opts.transient_hdf5 && !transient_writer_)
+			{
+				const std::string transient_path = std::filesystem::path(pvd_path.empty() ? resolve_output_path(step_name) : pvd_path).replace_extension(".hdf5").string();
+				transient_writer_ = std::make_unique<io::TransientHDF5Writer>(
+					transient_path,
+					args["output"]["paraview"]["transient"]["compression"],
+					args["output"]["paraview"]["transient"]["fields"].get<std::vector<std::string>>());
+			}
+			io::TransientHDF5Writer *transient_writer = opts.transient_hdf5 ? transient_writer_.get() : nullptr;
+			// Without other outputs the time steps are only indexed by the xdmf of the transient writer
+			const bool save_pvd = !opts.transient_hdf5 || opts.surface || opts.wire || opts.points || (is_contact_enabled() && (opts.contact_forces || opts.friction_forces));
+
+			if (args["output"]["advanced"]["async_export"] && can_export_async(opts))
+			{
+				// The solution is copied, the next time step overwrites it
+				async_export_ = std::async(std::launch::async, [this, vtu_path, pvd_path, step_name, skip_frame, opts, sol, pressure, time, t, t0, dt, transient_writer, save_pvd, times = time_sequence]() {
+					std::vector<io::SolutionFrame> frames;
+					out_geom.save_vtu(vtu_path, *this, sol, pressure, time, dt, opts, is_contact_enabled(), frames, transient_writer);
+					if (save_pvd && !times.empty())
+						out_geom.save_pvd(
+							pvd_path, [step_name](int i) { return fmt::format(step_name + "{:d}.vtm", i); },
+							times, skip_frame);
+					else if (save_pvd)
+						out_geom.save_pvd(
+							pvd_path, [step_name](int i) { return fmt::format(step_name + "{:d}.vtm", i); },
+							t, t0, dt, skip_frame);
+				});
+				return;
+			}
+
+			if (!solve_export_to_file && solution_frame_buffer)
+			{
+				io::SolutionFrame frame;
+				if (solution_frame_buffer->storage() == io::SolutionFrameBuffer::Storage::FIELDS)
+				{
+					std::vector<io::SolutionFrame> frames(1);
+					out_geom.save_vtu(vtu_path, *this, sol, pressure, time, dt, opts, is_contact_enabled(), frames);
+					frame = std::move(frames.front());
+				}
+				solution_frame_buffer->push(t, time, sol, pressure, std::move(frame));
+				return;
+			}
 
 			if (!solve_export_to_file)
 				solution_frames.emplace_back();
 
 			out_geom.save_vtu(
-				resolve_output_path(fmt::format(step_name + "{:d}.vtu", t)),
-				*this, sol, pressure, time, dt,
-				io::OutGeometryData::ExportOptions(args, mesh->is_linear(), problem->is_scalar(), solve_export_to_file),
-				is_contact_enabled(), solution_frames);
-
-			out_geom.save_pvd(
-				resolve_output_path(args["output"]["paraview"]["file_name"]),
-				[step_name](int i) { return fmt::format(step_name + "{:d}.vtm", i); },
-				t, t0, dt, args["output"]["paraview"]["skip_frame"].get<int>());
+				vtu_path, *this, sol, pressure, time, dt, opts,
+				is_contact_enabled(), solution_frames, transient_writer);
+
+			if (save_pvd && !time_sequence.empty())
+				out_geom.save_pvd(
+					pvd_path,
+					[step_name](int i) { return fmt::format(step_name + "{:d}.vtm", i); },
+					time_sequence, skip_frame);
+			else if (save_pvd)
+				out_geom.save_pvd(
+					pvd_path,
+					[step_name](int i) { return fmt::format(step_name + "{:d}.vtm", i); },
+					t, t0, dt, skip_frame);
 		}
 	}
 
+	void State::wait_for_async_export()
+	{
+		if (async_observer_fields_.valid())
+		{
+			POLYFEM_SCOPED_TIMER("Waiting for observer fields");
+			async_observer_fields_.get();
+		}
+
+		if (!async_export_.valid())
+			return;
+
+		POLYFEM_SCOPED_TIMER("Waiting for VTU export");
+		async_export_.get();
+	}
+
+	bool State::can_export_async(const io::OutGeometryData::ExportOptions &opts) const
+	{
+		// Velocities, accelerations, forces and contacts are read from the solver, which
+		// moves on to the next time step, and remeshing changes the mesh being exported
+		return opts.solve_export_to_file
+			   && !opts.velocity && !opts.acceleration && !opts.forces
+			   && !(is_contact_enabled() && (opts.contact_forces || opts.friction_forces))
+			   && !args["space"]["remesh"]["enabled"].get<bool>();
+	}
+
 	void State::save_json(const Eigen::MatrixXd &sol)
 	{
 		const std::string out_path = resolve_output_path(args["output"]["json"]);
@@ -98,6 +205,9 @@ namespace polyfem
 
 		logger().info("Saving json...");
 
+		record_memory_usage();
+		stats.memory.log();
+
 		using json = nlohmann::json;
 		json j;
 		stats.save_json(args, n_bases, n_pressure_bases,
@@ -126,8 +236,31 @@ namespace polyfem
 			is_contact_enabled(), solution_frames);
 	}
 
+	void State::evaluate_frame(const int i, io::SolutionFrame &frame)
+	{
+		assert(solution_frame_buffer != nullptr);
+
+		Eigen::MatrixXd sol, pressure;
+		solution_frame_buffer->dofs(i, sol, pressure);
+
+		double dt = 1;
+		if (!args["time"].is_null())
+			dt = args["time"]["dt"];
+
+		const std::string step_name = args["output"]["advanced"]["timestep_prefix"];
+		std::vector<io::SolutionFrame> frames(1);
+		out_geom.save_vtu(
+			resolve_output_path(fmt::format(step_name + "{:d}.vtu", solution_frame_buffer->step(i))),
+			*this, sol, pressure, solution_frame_buffer->time(i), dt,
+			io::OutGeometryData::ExportOptions(args, mesh->is_linear(), problem->is_scalar(), /*solve_export_to_file=*/false),
+			is_contact_enabled(), frames);
+		frame = std::move(frames.front());
+	}
+
 	void State::export_data(const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure)
 	{
+		wait_for_async_export();
+
 		if (!mesh)
 		{
 			logger().error("Load the mesh first!");
@@ -173,6 +306,10 @@ namespace polyfem
 			stress_path,
 			mises_path,
 			is_contact_enabled(), solution_frames);
+
+		const std::string profile_path = resolve_output_path(args["output"]["advanced"]["profile"]);
+		if (!profile_path.empty())
+			utils::Profiler::instance().save_chrome_trace(profile_path);
 	}
 
 	void State::save_restart_json(const double t0, const double dt, const int t) const
@@ -246,8 +246,24 @@ namespace polyfem
 		}
 		mesh->set_boundary_ids(boundary_ids);
 
-		// load mesh (and set materials) (will also reload obstacles from disk)
-		load_mesh();
+		// Set materials on the new mesh. The obstacles are not remeshed, so keep
+		// them instead of reloading them from disk as load_mesh() would.
+		{
+			mesh::Obstacle old_obstacle = std::move(obstacle);
+			reset_mesh();
+			obstacle = std::move(old_obstacle);
+
+			std::vector<std::shared_ptr<assembler::Assembler>> assemblers;
+			assemblers.push_back(assembler);
+			assemblers.push_back(mass_matrix_assembler);
+			if (mixed_assembler != nullptr)
+				mixed_assembler->set_size(mesh->dimension());
+			if (pressure_assembler != nullptr)
+				assemblers.push_back(pressure_assembler);
+			set_materials(assemblers);
+
+			out_geom.init_sampler(*mesh, args["output"]["paraview"]["vismesh_rel_area"]);
+		}
 
 		// --------------------------------------------------------------------
 
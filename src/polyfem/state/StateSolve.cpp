@@ -3,6 +3,8 @@
 #include <polyfem/io/MatrixIO.hpp>
 #include <polyfem/utils/Timer.hpp>
 
+#include <algorithm>
+
 namespace polyfem
 {
 	using namespace assembler;
@@ -64,8 +66,65 @@ namespace polyfem
 
 			return true;
 		}
+
+		/// evaluates the warm start solution at the points, zero at the points outside of its mesh
+		void interpolate_warm_start(const State::WarmStart &warm_start, const int actual_dim, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val)
+		{
+			const int dim = pts.cols();
+
+			Eigen::VectorXi element_ids;
+			Eigen::MatrixXd coords;
+			warm_start.mesh->locate_points(pts, element_ids, coords);
+
+			val.setZero(pts.rows(), actual_dim);
+			std::vector<assembler::AssemblyValues> vals;
+			for (int i = 0; i < pts.rows(); ++i)
+			{
+				const int e = element_ids(i);
+				if (e < 0)
+					continue;
+
+				// reference coordinates of the affine geometric mapping
+				const Eigen::MatrixXd nodes = warm_start.geom_bases[e].nodes();
+				Eigen::MatrixXd jac(dim, dim);
+				for (int d = 0; d < dim; ++d)
+					jac.col(d) = (nodes.row(d + 1) - nodes.row(0)).transpose();
+				const Eigen::RowVectorXd local = jac.partialPivLu().solve((pts.row(i) - nodes.row(0)).transpose()).transpose();
+
+				warm_start.bases[e].evaluate_bases(local, vals);
+				for (int j = 0; j < vals.size(); ++j)
+				{
+					for (const auto &g : warm_start.bases[e].bases[j].global())
+					{
+						for (int d = 0; d < actual_dim; ++d)
+							val(i, d) += vals[j].val(0) * g.val * warm_start.sol(g.index * actual_dim + d);
+					}
+				}
+			}
+		}
 	} // namespace
 
+	void State::set_warm_start(const State &source, const Eigen::MatrixXd &source_sol)
+	{
+		assert(source.mesh != nullptr && source.mesh->dimension() == mesh->dimension());
+
+		auto ws = std::make_shared<WarmStart>();
+		ws->mesh = source.mesh->copy();
+		ws->bases = source.bases;
+		ws->geom_bases = source.geom_bases();
+		ws->sol = source_sol;
+		// built before the parallel point location
+		ws->mesh->element_bvh();
+
+		for (const auto &gbs : ws->geom_bases)
+		{
+			if (int(gbs.bases.size()) != mesh->dimension() + 1)
+				log_and_throw_error("Warm start needs a simplicial source mesh with an affine geometric mapping");
+		}
+
+		warm_start = ws;
+	}
+
 	void State::initial_solution(Eigen::MatrixXd &solution) const
 	{
 		assert(solve_data.rhs_assembler != nullptr);
@@ -77,12 +136,32 @@ namespace polyfem
 
 		if (!was_solution_loaded)
 		{
-			if (problem->is_time_dependent())
+			if (warm_start)
+			{
+				const int actual_dim = problem->is_scalar() ? 1 : mesh->dimension();
+				Eigen::MatrixXd field;
+				solve_data.rhs_assembler->initial_field([&](const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) {
+					interpolate_warm_start(*warm_start, actual_dim, pts, val);
+				},
+														field);
+
+				if (problem->is_time_dependent())
+					solution = field;
+				else
+				{
+					solution.setZero(rhs.size(), 1);
+					const int n_rows = std::min(field.rows(), solution.rows());
+					solution.topRows(n_rows) = field.topRows(n_rows);
+				}
+			}
+			else if (problem->is_time_dependent())
 				solve_data.rhs_assembler->initial_solution(solution);
 			else
 			{
 				solution.resize(rhs.size(), 1);
 				solution.setZero();
+				if (prolongated_solution.size() > 0 && prolongated_solution.rows() <= solution.rows())
+					solution.topRows(prolongated_solution.rows()) = prolongated_solution;
 			}
 		}
 	}
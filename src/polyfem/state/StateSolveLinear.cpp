@@ -2,6 +2,7 @@
 
 #include <polyfem/assembler/Mass.hpp>
 #include <polyfem/assembler/AssemblerUtils.hpp>
+#include <polyfem/assembler/GenericProblem.hpp>
 
 #include <polyfem/time_integrator/ImplicitTimeIntegrator.hpp>
 #include <polyfem/time_integrator/BDF.hpp>
@@ -9,12 +10,23 @@
 #include <polyfem/solver/forms/BodyForm.hpp>
 #include <polyfem/solver/forms/ElasticForm.hpp>
 #include <polyfem/solver/forms/InertiaForm.hpp>
+#include <polyfem/solver/ShiftInvertLanczos.hpp>
 #include <polysolve/linear/FEMSolver.hpp>
 
+#include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/Timer.hpp>
+#include <polyfem/utils/getRSS.h>
 
 #include <unsupported/Eigen/SparseExtra>
 #include <polyfem/io/Evaluator.hpp>
+#include <polyfem/io/MatrixIO.hpp>
+
+#include <igl/PI.h>
+
+#include <filesystem>
+#include <fstream>
 
 namespace polyfem
 {
@@ -24,6 +36,75 @@ namespace polyfem
 	using namespace solver;
 	using namespace io;
 
+	namespace
+	{
+		/// Sets the rows of the Dirichlet nodes to the identity, keeping the sparsity pattern
+		void set_dirichlet_rows_to_identity(StiffnessMatrix &A, const std::vector<int> &boundary_nodes)
+		{
+			std::vector<bool> is_boundary(A.rows(), false);
+			for (const int i : boundary_nodes)
+				is_boundary[i] = true;
+
+			for (int k = 0; k < A.outerSize(); ++k)
+			{
+				for (StiffnessMatrix::InnerIterator it(A, k); it; ++it)
+				{
+					if (is_boundary[it.row()])
+						it.valueRef() = it.row() == it.col() ? 1 : 0;
+				}
+			}
+		}
+
+		/// Hash of the pattern and values of a system and of its Dirichlet nodes, to detect an unchanged factorization
+		size_t system_hash(const StiffnessMatrix &A, const std::vector<int> &boundary_nodes)
+		{
+			size_t hash = 0;
+			const auto combine = [&hash](const size_t h) { hash ^= h + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+
+			combine(A.rows());
+			combine(A.cols());
+			for (int k = 0; k < A.outerSize(); ++k)
+			{
+				for (StiffnessMatrix::InnerIterator it(A, k); it; ++it)
+				{
+					combine(it.index());
+					combine(std::hash<double>{}(it.value()));
+				}
+				combine(k);
+			}
+			for (const int i : boundary_nodes)
+				combine(i);
+			return hash;
+		}
+
+		/// True if the sparse matrix at path is written by io::write_sparse_matrix instead of polysolve
+		bool is_native_sparse_path(const std::string &path)
+		{
+			const std::string extension = std::filesystem::path(path).extension().string();
+			return extension == ".bin" || extension == ".hdf5" || extension == ".h5" || extension == ".csv";
+		}
+
+		/// path with _suffix inserted before its extension, empty paths stay empty
+		std::string append_to_stem(const std::string &path, const std::string &suffix)
+		{
+			if (path.empty())
+				return path;
+			const std::filesystem::path p(path);
+			return (p.parent_path() / (p.stem().string() + "_" + suffix + p.extension().string())).string();
+		}
+
+		/// ids of the surfaces of a list of boundary conditions
+		json boundary_ids(const json &conditions)
+		{
+			json ids = json::array();
+			if (conditions.is_null())
+				return ids;
+			for (const json &condition : json_as_array(conditions))
+				ids.push_back(condition.is_object() && condition.contains("id") ? condition["id"] : json());
+			return ids;
+		}
+	} // namespace
+
 	void State::build_stiffness_mat(StiffnessMatrix &stiffness)
 	{
 		igl::Timer timer;
@@ -48,6 +129,10 @@ namespace polyfem
 		else
 		{
 			assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), ass_vals_cache, 0, stiffness);
+
+			assemble_hourglass_stiffness();
+			if (hourglass_stiffness.size() > 0)
+				stiffness += hourglass_stiffness;
 		}
 
 		timer.stop();
@@ -62,7 +147,7 @@ namespace polyfem
 		const std::string full_mat_path = args["output"]["data"]["full_mat"];
 		if (!full_mat_path.empty())
 		{
-			Eigen::saveMarket(stiffness, full_mat_path);
+			io::write_sparse_matrix(full_mat_path, stiffness, args["output"]["data"]["advanced"]["compression"]);
 		}
 	}
 
@@ -71,7 +156,8 @@ namespace polyfem
 		StiffnessMatrix &A,
 		Eigen::VectorXd &b,
 		const bool compute_spectrum,
-		Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure)
+		Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure,
+		const bool prefactorized)
 	{
 		assert(assembler->is_linear() && !is_contact_enabled());
 		assert(solve_data.rhs_assembler != nullptr);
@@ -91,19 +177,35 @@ namespace polyfem
 		else
 			boundary_nodes_tmp = boundary_nodes;
 
+		// the dofs of a node are interleaved (the periodic map keeps them so), the multigrid solvers coarsen them together
+		if (problem_dim > 1 && mixed_assembler == nullptr)
+			solver->set_block_size(problem_dim);
+
+		// polysolve writes Matrix Market files, the native sparse formats are written here once the boundary conditions are applied
+		const std::string stiffness_mat_path = args["output"]["data"]["stiffness_mat"];
+		const bool native_stiffness_mat = is_native_sparse_path(stiffness_mat_path);
+		const std::string solver_stiffness_mat_path = native_stiffness_mat ? "" : stiffness_mat_path;
+
+		// the factorization is owned by the solver, its memory is measured as the growth of the RSS
+		const size_t rss_before_solve = getCurrentRSS();
 		Eigen::VectorXd x;
-		if (optimization_enabled == solver::CacheLevel::Derivatives)
+		if (solver::caches_derivatives(optimization_enabled))
 		{
 			auto A_tmp = A;
-			prefactorize(*solver, A, boundary_nodes_tmp, precond_num, args["output"]["data"]["stiffness_mat"]);
+			if (!prefactorized)
+				prefactorize(*solver, A, boundary_nodes_tmp, precond_num, solver_stiffness_mat_path);
 			dirichlet_solve_prefactorized(*solver, A_tmp, b, boundary_nodes_tmp, x);
 		}
 		else
 		{
 			stats.spectrum = dirichlet_solve(
-				*solver, A, b, boundary_nodes_tmp, x, precond_num, args["output"]["data"]["stiffness_mat"], compute_spectrum,
+				*solver, A, b, boundary_nodes_tmp, x, precond_num, solver_stiffness_mat_path, compute_spectrum,
 				assembler->is_fluid(), use_avg_pressure);
 		}
+		if (native_stiffness_mat && !prefactorized)
+			io::write_sparse_matrix(stiffness_mat_path, A, args["output"]["data"]["advanced"]["compression"]);
+		const size_t rss_after_solve = getCurrentRSS();
+		stats.memory.record("linear_solver_factorization", rss_after_solve > rss_before_solve ? rss_after_solve - rss_before_solve : 0);
  		if (has_periodic_bc())
  		{
 			sol = periodic_bc->periodic_to_full(full_size, x);
@@ -136,28 +238,254 @@ namespace polyfem
 		assert(!problem->is_time_dependent());
 		assert(assembler->is_linear() && !is_contact_enabled());
 
+		solve_data.rhs_assembler->set_bc(
+			local_boundary, boundary_nodes, n_boundary_samples(),
+			(assembler->name() != "Bilaplacian") ? local_neumann_boundary : std::vector<LocalBoundary>(), rhs);
+
+		StiffnessMatrix A;
+		build_stiffness_mat(A);
+
+		Eigen::VectorXd b = rhs;
+
 		// --------------------------------------------------------------------
-		if (lin_solver_cached)
-			lin_solver_cached.reset();
+		// the optimization often changes only the right-hand side, keep the factorization of an unchanged system
 
-		lin_solver_cached =
-			polysolve::linear::Solver::create(args["solver"]["linear"], logger());
-		logger().info("{}...", lin_solver_cached->name());
+		const size_t hash = solver::caches_derivatives(optimization_enabled) ? system_hash(A, boundary_nodes) : 0;
+		const bool prefactorized = lin_solver_cached && hash != 0 && hash == lin_solver_cached_hash;
+		if (prefactorized)
+		{
+			logger().info("Reusing the factorization of {}...", lin_solver_cached->name());
+		}
+		else
+		{
+			if (lin_solver_cached)
+				lin_solver_cached.reset();
+
+			lin_solver_cached =
+				polysolve::linear::Solver::create(args["solver"]["linear"], logger());
+			logger().info("{}...", lin_solver_cached->name());
+		}
+		lin_solver_cached_hash = 0;
 
 		// --------------------------------------------------------------------
 
-		solve_data.rhs_assembler->set_bc(
-			local_boundary, boundary_nodes, n_boundary_samples(),
-			(assembler->name() != "Bilaplacian") ? local_neumann_boundary : std::vector<LocalBoundary>(), rhs);
+		solve_linear(lin_solver_cached, A, b, args["output"]["advanced"]["spectrum"], sol, pressure, prefactorized);
+		lin_solver_cached_hash = hash;
+	}
+
+	void State::solve_load_cases(Eigen::MatrixXd &sols)
+	{
+		if (args.contains("preset_problem") || problem->is_time_dependent() || !is_problem_linear()
+			|| mixed_assembler != nullptr || has_periodic_bc())
+			log_and_throw_error("Load cases need a static linear problem without preset problem, mixed formulation or periodic boundary conditions!");
+
+		const json &load_cases = args["load_cases"];
+		const int n_cases = load_cases.size();
+		const int problem_dim = problem->is_scalar() ? 1 : mesh->dimension();
+
+		// --------------------------------------------------------------------
+		// the cases keep the boundary surfaces, so that the boundary nodes and the system are shared
+
+		std::vector<std::shared_ptr<assembler::Problem>> problems(n_cases);
+		for (int i = 0; i < n_cases; ++i)
+		{
+			const json &load_case = load_cases[i];
+			json bc = args["boundary_conditions"];
+			bc.merge_patch(load_case["boundary_conditions"]);
+			for (const std::string key : {"dirichlet_boundary", "neumann_boundary", "normal_aligned_neumann_boundary", "pressure_boundary"})
+			{
+				if (boundary_ids(bc[key]) != boundary_ids(args["boundary_conditions"][key]))
+					log_and_throw_error("Load case {} changes the surfaces of {}, only their values can change!", load_case["name"].get<std::string>(), key);
+			}
+			bc["root_path"] = root_path();
+
+			if (problem->is_scalar())
+				problems[i] = std::make_shared<assembler::GenericScalarProblem>("GenericScalar");
+			else
+				problems[i] = std::make_shared<assembler::GenericTensorProblem>("GenericTensor");
+			problems[i]->clear();
+			problems[i]->set_parameters(bc);
+			problems[i]->set_parameters(args["output"]);
+			problems[i]->set_units(*assembler, units);
+			problems[i]->init(*mesh);
+			problems[i]->update_nodes(in_node_to_node);
+			problems[i]->set_parameters(problem_parameters());
+		}
+
+		// --------------------------------------------------------------------
+
+		const std::vector<LocalBoundary> neumann_boundary = assembler->name() != "Bilaplacian" ? local_neumann_boundary : std::vector<LocalBoundary>();
+		std::vector<Eigen::MatrixXd> case_rhs(n_cases);
+		{
+			POLYFEM_SCOPED_TIMER(fmt::format("Assembling the right-hand sides of {} load cases", n_cases), timings.assigning_rhs_time);
+			maybe_parallel_for(n_cases, [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+				{
+					const std::shared_ptr<assembler::RhsAssembler> rhs_assembler = build_rhs_assembler(n_bases, bases, mass_ass_vals_cache, problems[i].get());
+					rhs_assembler->assemble(mass_matrix_assembler->density(), case_rhs[i]);
+					case_rhs[i] *= -1;
+					rhs_assembler->set_bc(local_boundary, boundary_nodes, n_boundary_samples(), neumann_boundary, case_rhs[i]);
+				}
+			});
+		}
 
 		StiffnessMatrix A;
 		build_stiffness_mat(A);
 
-		Eigen::VectorXd b = rhs;
+		lin_solver_cached = polysolve::linear::Solver::create(args["solver"]["linear"], logger());
+		lin_solver_cached_hash = 0;
+		logger().info("{}...", lin_solver_cached->name());
+		if (problem_dim > 1)
+			lin_solver_cached->set_block_size(problem_dim);
+
+		// one factorization, every case is a back-substitution
+		sols.resize(A.rows(), n_cases);
+		{
+			POLYFEM_SCOPED_TIMER(fmt::format("Solving {} load cases", n_cases), timings.solving_time);
+
+			StiffnessMatrix A_factorized = A;
+			const size_t rss_before_solve = getCurrentRSS();
+			prefactorize(*lin_solver_cached, A_factorized, boundary_nodes, problem_dim * n_bases, "");
+			const size_t rss_after_solve = getCurrentRSS();
+			stats.memory.record("linear_solver_factorization", rss_after_solve > rss_before_solve ? rss_after_solve - rss_before_solve : 0);
+
+			for (int i = 0; i < n_cases; ++i)
+			{
+				Eigen::VectorXd x;
+				dirichlet_solve_prefactorized(*lin_solver_cached, A, case_rhs[i], boundary_nodes, x);
+				sols.col(i) = x;
+
+				const double error = (A * x - case_rhs[i]).norm();
+				if (error > 1e-4)
+					logger().error("Solver error of load case {}: {}", load_cases[i]["name"].get<std::string>(), error);
+				else
+					logger().debug("Solver error of load case {}: {}", load_cases[i]["name"].get<std::string>(), error);
+			}
+			lin_solver_cached->get_info(stats.solver_info);
+		}
 
 		// --------------------------------------------------------------------
+		// every case is exported as a separate simulation, named after the case
 
-		solve_linear(lin_solver_cached, A, b, args["output"]["advanced"]["spectrum"], sol, pressure);
+		const json output = args["output"];
+		for (int i = 0; i < n_cases; ++i)
+		{
+			const std::string name = load_cases[i]["name"];
+			args["output"]["json"] = append_to_stem(output["json"], name);
+			args["output"]["paraview"]["file_name"] = append_to_stem(output["paraview"]["file_name"], name);
+			args["output"]["data"]["solution"] = append_to_stem(output["data"]["solution"], name);
+
+			const Eigen::MatrixXd sol = sols.col(i);
+			save_json(sol);
+			export_data(sol, Eigen::MatrixXd());
+		}
+		wait_for_async_export();
+		args["output"] = output;
+	}
+
+	void State::modal_analysis(Eigen::VectorXd &eigenvalues, Eigen::MatrixXd &modes)
+	{
+		if (!is_problem_linear() || mixed_assembler != nullptr || has_periodic_bc() || is_contact_enabled())
+			log_and_throw_error("Modal analysis needs a linear problem without mixed formulation, periodic boundary conditions or contact!");
+
+		const json &params = args["modal_analysis"];
+		const int n_modes = params["n_modes"];
+		const double shift = params["shift"];
+		const int problem_dim = problem->is_scalar() ? 1 : mesh->dimension();
+
+		StiffnessMatrix K;
+		build_stiffness_mat(K);
+
+		// the mass is only assembled by assemble_mass_mat for time dependent problems
+		StiffnessMatrix M = mass;
+		if (M.size() == 0)
+		{
+			mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), mass_ass_vals_cache, 0, M, true);
+			if (args["solver"]["advanced"]["lump_mass_matrix"])
+				M = lump_matrix(M);
+		}
+
+		// --------------------------------------------------------------------
+		// the modes vanish on the Dirichlet nodes, whatever their values
+
+		const StiffnessMatrix A = K - shift * M;
+
+		lin_solver_cached = polysolve::linear::Solver::create(args["solver"]["linear"], logger());
+		lin_solver_cached_hash = 0;
+		logger().info("{}...", lin_solver_cached->name());
+		if (problem_dim > 1)
+			lin_solver_cached->set_block_size(problem_dim);
+
+		int n_converged = 0;
+		int n_solves = 0;
+		{
+			POLYFEM_SCOPED_TIMER(fmt::format("Computing {} modes", n_modes), timings.solving_time);
+
+			StiffnessMatrix A_factorized = A;
+			const size_t rss_before_solve = getCurrentRSS();
+			prefactorize(*lin_solver_cached, A_factorized, boundary_nodes, problem_dim * n_bases, "");
+			const size_t rss_after_solve = getCurrentRSS();
+			stats.memory.record("linear_solver_factorization", rss_after_solve > rss_before_solve ? rss_after_solve - rss_before_solve : 0);
+
+			// every Lanczos block is a sequence of back-substitutions with the same factorization
+			const auto shifted_solve = [&](const Eigen::MatrixXd &b, Eigen::MatrixXd &x) {
+				x.resize(b.rows(), b.cols());
+				for (int j = 0; j < b.cols(); ++j)
+				{
+					Eigen::VectorXd xj;
+					dirichlet_solve_prefactorized(*lin_solver_cached, A, b.col(j), boundary_nodes, xj);
+					x.col(j) = xj;
+				}
+			};
+
+			ShiftInvertLanczos lanczos(M, boundary_nodes, shift, shifted_solve);
+			n_converged = lanczos.compute(
+				n_modes, params["block_size"], params["tolerance"], params["max_restarts"],
+				eigenvalues, modes);
+			n_solves = lanczos.n_solves();
+			lin_solver_cached->get_info(stats.solver_info);
+		}
+
+		// for elasticity the eigenvalues are the squares of the angular frequencies
+		Eigen::VectorXd frequencies = eigenvalues.cwiseMax(0).cwiseSqrt() / (2 * igl::PI);
+		for (int i = 0; i < eigenvalues.size(); ++i)
+			logger().info("Mode {}: eigenvalue {}, frequency {}{}", i, eigenvalues(i), frequencies(i), i < n_converged ? "" : " (not converged)");
+
+		// --------------------------------------------------------------------
+		// every mode is exported as a separate solution, the eigenvalues are saved in the JSON
+
+		const json output = args["output"];
+		for (int i = 0; i < modes.cols(); ++i)
+		{
+			const std::string name = fmt::format("mode{:d}", i);
+			args["output"]["paraview"]["file_name"] = append_to_stem(output["paraview"]["file_name"], name);
+			args["output"]["data"]["solution"] = append_to_stem(output["data"]["solution"], name);
+
+			export_data(modes.col(i), Eigen::MatrixXd());
+		}
+		wait_for_async_export();
+		args["output"] = output;
+
+		const std::string out_path = resolve_output_path(args["output"]["json"]);
+		if (!out_path.empty())
+		{
+			std::ofstream out(out_path);
+			if (!out.is_open())
+			{
+				logger().error("Unable to save modal analysis JSON to {}", out_path);
+				return;
+			}
+
+			json j;
+			j["shift"] = shift;
+			j["eigenvalues"] = std::vector<double>(eigenvalues.data(), eigenvalues.data() + eigenvalues.size());
+			j["frequencies"] = std::vector<double>(frequencies.data(), frequencies.data() + frequencies.size());
+			j["converged"] = n_converged;
+			j["solves"] = n_solves;
+			j["time_solving"] = timings.solving_time;
+			j["time_assembling_stiffness_mat"] = timings.assembling_stiffness_mat_time;
+			out << j.dump(4) << std::endl;
+		}
 	}
 
 	void State::init_linear_solve(Eigen::MatrixXd &sol, const double t)
@@ -230,6 +558,8 @@ namespace polyfem
 		auto solver =
 			polysolve::linear::Solver::create(args["solver"]["linear"], logger());
 		logger().info("{}...", solver->name());
+		if (!is_scalar_or_mixed)
+			solver->set_block_size(mesh->dimension());
 
 		// --------------------------------------------------------------------
 
@@ -270,6 +600,15 @@ namespace polyfem
 		StiffnessMatrix stiffness;
 		build_stiffness_mat(stiffness);
 
+		// The system matrix only changes with the time integrator scaling, so it is factorized once
+		// (and again when the scaling changes, e.g., during the BDF startup) and every step is a back-substitution.
+		// Mixed and periodic problems, which need a special treatment of the system, go through solve_linear.
+		const bool prefactorize = mixed_assembler == nullptr && !has_periodic_bc() && args["output"]["data"]["stiffness_mat"].get<std::string>().empty();
+		const int precond_num = (problem->is_scalar() ? 1 : mesh->dimension()) * n_bases;
+		StiffnessMatrix A_factorized;
+		double factorized_scaling = std::numeric_limits<double>::quiet_NaN();
+		bool is_pattern_analyzed = false;
+
 		// --------------------------------------------------------------------
 		// TODO rebuild stiffnes if material are time dept
 		for (int t = 1; t <= time_steps; ++t)
@@ -279,6 +618,12 @@ namespace polyfem
 			StiffnessMatrix A;
 			Eigen::VectorXd b;
 			bool compute_spectrum = args["output"]["advanced"]["spectrum"];
+			compute_spectrum &= is_scalar_or_mixed ? t == time_steps : t == 1;
+
+			const double scaling = is_scalar_or_mixed ? std::dynamic_pointer_cast<BDF>(time_integrator)->beta_dt() : time_integrator->acceleration_scaling();
+			const bool use_factorization = prefactorize && !compute_spectrum;
+			// The system matrix is only needed to (re)factorize
+			const bool build_A = !use_factorization || scaling != factorized_scaling;
 
 			if (is_scalar_or_mixed)
 			{
@@ -301,13 +646,12 @@ namespace polyfem
 				}
 
 				std::shared_ptr<BDF> bdf = std::dynamic_pointer_cast<BDF>(time_integrator);
-				A = mass / bdf->beta_dt() + stiffness;
+				if (build_A)
+					A = mass / bdf->beta_dt() + stiffness;
 				b = (mass * bdf->weighted_sum_x_prevs()) / bdf->beta_dt();
 				for (int i : boundary_nodes)
 					b[i] = 0;
 				b += current_rhs;
-
-				compute_spectrum &= t == time_steps;
 			}
 			else
 			{
@@ -324,13 +668,51 @@ namespace polyfem
 				solve_data.rhs_assembler->set_bc(
 					local_boundary, boundary_nodes, n_b_samples, std::vector<LocalBoundary>(), current_rhs, sol, time);
 
-				A = stiffness * time_integrator->acceleration_scaling() + mass;
+				if (build_A)
+					A = stiffness * time_integrator->acceleration_scaling() + mass;
 				b = current_rhs;
-
-				compute_spectrum &= t == 1;
 			}
 
-			solve_linear(solver, A, b, compute_spectrum, sol, pressure);
+			if (use_factorization)
+			{
+				if (build_A)
+				{
+					POLYFEM_SCOPED_TIMER("Factorizing the transient system");
+					A_factorized = A;
+					set_dirichlet_rows_to_identity(A_factorized, boundary_nodes);
+					// The sparsity pattern does not depend on the scaling
+					if (!is_pattern_analyzed)
+					{
+						solver->analyze_pattern(A_factorized, precond_num);
+						is_pattern_analyzed = true;
+					}
+					const size_t rss_before_factorize = getCurrentRSS();
+					solver->factorize(A_factorized);
+					const size_t rss_after_factorize = getCurrentRSS();
+					if (rss_after_factorize > rss_before_factorize)
+						stats.memory.record("linear_solver_factorization", rss_after_factorize - rss_before_factorize);
+					factorized_scaling = scaling;
+				}
+
+				// The Dirichlet rows are the identity, so b already holds the boundary values
+				Eigen::VectorXd x = Eigen::VectorXd::Zero(b.size());
+				solver->solve(b, x);
+				sol = x;
+
+				solver->get_info(stats.solver_info);
+				const double error = (A_factorized * x - b).norm();
+				if (error > 1e-4)
+					logger().error("Solver error: {}", error);
+				else
+					logger().debug("Solver error: {}", error);
+			}
+			else
+			{
+				solve_linear(solver, A, b, compute_spectrum, sol, pressure);
+				// The solver now holds the factorization of this system
+				factorized_scaling = std::numeric_limits<double>::quiet_NaN();
+				is_pattern_analyzed = false;
+			}
 
 			if (optimization_enabled != solver::CacheLevel::None)
 			{
@@ -11,6 +11,7 @@
 #include <polyfem/time_integrator/BDF.hpp>
 #include <polyfem/autogen/auto_p_bases.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
 
 namespace polyfem
 {
@@ -110,6 +111,8 @@ namespace polyfem
 								  pressure_ass_vals_cache, ass_vals_cache, 0, mixed_stiffness);
 		mass_matrix_assembler->set_size(mesh->dimension());
 		mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases, gbases, mass_ass_vals_cache, 0, velocity_mass, true);
+		if (args["solver"]["advanced"]["lump_mass_matrix"])
+			velocity_mass = utils::lump_matrix(velocity_mass);
 		mixed_stiffness = mixed_stiffness.transpose();
 		logger().info("Matrices assembly ends!");
 
@@ -1,6 +1,7 @@
 #include <polyfem/State.hpp>
 
 #include <polyfem/assembler/Mass.hpp>
+#include <polyfem/assembler/MassMatrixAssembler.hpp>
 #include <polyfem/assembler/ViscousDamping.hpp>
 
 #include <polyfem/solver/forms/BodyForm.hpp>
@@ -9,21 +10,32 @@
 #include <polyfem/solver/forms/FrictionForm.hpp>
 #include <polyfem/solver/forms/InertiaForm.hpp>
 #include <polyfem/solver/forms/LaggedRegForm.hpp>
+#include <polyfem/solver/forms/PressureForm.hpp>
 #include <polyfem/solver/forms/RayleighDampingForm.hpp>
 #include <polyfem/solver/forms/BCLagrangianForm.hpp>
 
 #include <polyfem/solver/NLProblem.hpp>
 #include <polyfem/solver/ALSolver.hpp>
 #include <polyfem/solver/SolveData.hpp>
+#include <polyfem/time_integrator/ImplicitEuler.hpp>
+#include <polyfem/time_integrator/ExplicitTimeIntegrator.hpp>
+#include <polyfem/time_integrator/TimeStepController.hpp>
+#include <polyfem/time_integrator/Parareal.hpp>
 #include <polyfem/io/MshWriter.hpp>
 #include <polyfem/io/OBJWriter.hpp>
 #include <polyfem/io/OutData.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
 #include <polyfem/utils/Timer.hpp>
 #include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/MatrixCache.hpp>
+#include <polyfem/utils/par_for.hpp>
 
 #include <ipc/ipc.hpp>
 
+#include <array>
+#include <cmath>
+#include <limits>
+
 namespace polyfem
 {
 	using namespace mesh;
@@ -39,6 +51,8 @@ namespace polyfem
 
 	void State::solve_transient_tensor_nonlinear(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol)
 	{
+		solve_data.explicit_time_integrator = nullptr;
+		time_sequence.clear();
 		init_nonlinear_tensor_solve(sol, t0 + dt);
 
 		// Write the total energy to a CSV file
@@ -62,6 +76,8 @@ namespace polyfem
 
 			{
 				POLYFEM_SCOPED_TIMER(forward_solve_time);
+				POLYFEM_PROFILE_ZONE("nonlinear solve");
+				predict_time_step(sol);
 				solve_tensor_nonlinear(sol, t);
 			}
 
@@ -71,12 +87,18 @@ namespace polyfem
 				// save_timestep(t0 + dt * t, save_i, t0, save_dt, sol, Eigen::MatrixXd()); // no pressure
 				save_i++;
 
+				// the observer fields evaluated in the background read the mesh being replaced
+				wait_for_async_export();
+
 				bool remesh_success;
 				{
 					POLYFEM_SCOPED_TIMER(remeshing_time);
 					remesh_success = this->remesh(t0 + dt * t, dt, sol);
 				}
 
+				StateEvent remesh_event(StateEvent::Type::REMESH, t, t0 + dt * t, sol);
+				notify_observers(remesh_event);
+
 				// Save the solution after remeshing
 				energy_csv.write(save_i, sol);
 				// save_timestep(t0 + dt * t, save_i, t0, save_dt, sol, Eigen::MatrixXd()); // no pressure
@@ -135,10 +157,375 @@ namespace polyfem
 		}
 	}
 
+	void State::solve_transient_tensor_adaptive(const double t0, const double tend, const double dt, Eigen::MatrixXd &sol)
+	{
+		if (optimization_enabled != solver::CacheLevel::None)
+			log_and_throw_adjoint_error("Adaptive time stepping does not support the adjoint!");
+		if (args["space"]["remesh"]["enabled"])
+			log_and_throw_error("Adaptive time stepping does not support remeshing!");
+
+		const TimeStepController controller(args["time"]["adaptive"], units.characteristic_length());
+
+		solve_data.explicit_time_integrator = nullptr;
+		init_nonlinear_tensor_solve(sol, t0 + dt);
+
+		ImplicitTimeIntegrator &time_integrator = *(solve_data.time_integrator);
+		NLProblem &nl_problem = *(solve_data.nl_problem);
+
+		EnergyCSVWriter energy_csv(resolve_output_path("energy.csv"), solve_data);
+
+		time_sequence = {t0};
+		energy_csv.write(0, sol);
+		save_timestep(t0, 0, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+
+		double time = t0;
+		double step_dt = std::min(dt, controller.max_dt());
+		for (int t = 1; time < tend - 1e-12 * std::max(1.0, std::abs(tend)); ++t)
+		{
+			const Eigen::MatrixXd prev_sol = sol;
+			double error = 0;
+			int n_rejected = 0;
+
+			for (bool accepted = false; !accepted;)
+			{
+				step_dt = std::min(step_dt, tend - time);
+
+				time_integrator.set_dt(step_dt);
+				solve_data.update_dt();
+				nl_problem.update_quantities(time + step_dt, prev_sol);
+
+				const Eigen::VectorXd x_pred = time_integrator.predict();
+
+				const auto reject = [&](const std::string &reason, const double new_dt) {
+					if (step_dt <= controller.min_dt() || n_rejected >= controller.max_retries())
+						log_and_throw_error("Time step at t={} rejected ({}) with dt={:g} after {} retries!", time, reason, step_dt, n_rejected);
+					logger().debug("Time step at t={} rejected ({}), dt {:g} -> {:g}", time, reason, step_dt, new_dt);
+					step_dt = new_dt;
+					sol = prev_sol;
+					++n_rejected;
+				};
+
+				// a contact stops the predicted trajectory early, shrink the step before solving it
+				if (solve_data.contact_form != nullptr && controller.min_ccd_step() > 0)
+				{
+					const double ccd_step = solve_data.contact_form->max_step_size(prev_sol, x_pred);
+					if (ccd_step < controller.min_ccd_step() && step_dt > controller.min_dt())
+					{
+						reject(fmt::format("CCD step {:g}", ccd_step), controller.shrink(step_dt, std::max(ccd_step, controller.min_ccd_step())));
+						continue;
+					}
+				}
+
+				try
+				{
+					POLYFEM_PROFILE_ZONE("nonlinear solve");
+					predict_time_step(sol);
+					solve_tensor_nonlinear(sol, t);
+				}
+				catch (const std::exception &e)
+				{
+					reject(fmt::format("nonlinear solve failed: {}", e.what()), controller.shrink(step_dt));
+					continue;
+				}
+
+				error = controller.error(sol, x_pred);
+				if (error <= 1)
+					accepted = true;
+				else
+					reject(fmt::format("error {:g}", error), controller.next_dt(step_dt, error, time_integrator.order()));
+			}
+
+			time += step_dt;
+			time_sequence.push_back(time);
+
+			energy_csv.write(t, sol);
+			save_timestep(time, t, t0, step_dt, sol, Eigen::MatrixXd()); // no pressure
+
+			logger().info("{}  t={} dt={:g} error={:g} ({} rejected)", t, time, step_dt, error, n_rejected);
+
+			{
+				POLYFEM_SCOPED_TIMER("Update quantities");
+
+				time_integrator.update_quantities(sol);
+				step_dt = controller.next_dt(step_dt, error, time_integrator.order());
+				solve_data.update_barrier_stiffness(sol);
+			}
+
+			const std::string &state_path = resolve_output_path(fmt::format(args["output"]["data"]["state"], t));
+			if (!state_path.empty())
+				time_integrator.save_state(state_path);
+
+			// restart at the current time
+			save_restart_json(time, 0, t);
+		}
+
+		time_sequence.clear();
+	}
+
+	void State::solve_transient_tensor_parareal(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol)
+	{
+		if (optimization_enabled != solver::CacheLevel::None)
+			log_and_throw_adjoint_error("Parareal does not support the adjoint!");
+		if (args["space"]["remesh"]["enabled"])
+			log_and_throw_error("Parareal does not support remeshing!");
+		if (args["time"]["adaptive"]["enabled"])
+			log_and_throw_error("Parareal does not support adaptive time stepping!");
+
+		Parareal parareal(args["time"]["parareal"], units.characteristic_length());
+
+		int n_slices = parareal.slices();
+		if (n_slices == 0)
+		{
+			// largest divisor of the number of time steps up to the number of threads
+			n_slices = std::min<int>(utils::NThread::get().num_threads(), time_steps);
+			while (n_slices > 1 && time_steps % n_slices != 0)
+				--n_slices;
+		}
+		if (n_slices <= 0 || time_steps % n_slices != 0)
+			log_and_throw_error("Parareal needs the number of time steps ({}) to be a multiple of the number of slices ({})", time_steps, n_slices);
+		const int fine_steps = time_steps / n_slices;
+		const double slice_dt = fine_steps * dt;
+		const int coarse_steps = parareal.coarse_steps();
+		logger().info("Parareal with {} slices of {} step(s), {} coarse step(s) per slice", n_slices, fine_steps, coarse_steps);
+
+		solve_data.explicit_time_integrator = nullptr;
+		time_sequence.clear();
+		init_nonlinear_tensor_solve(sol, t0 + dt);
+
+		// --------------------------------------------------------------------
+		// One state per slice for the fine propagators, the solve data, the assemblers, and their caches are not shared
+
+		std::vector<std::unique_ptr<State>> workers(n_slices);
+		{
+			POLYFEM_SCOPED_TIMER("Setup parareal slices");
+
+			const std::vector<spdlog::sink_ptr> sinks = logger().sinks();
+
+			json worker_args = args;
+			worker_args["output"]["log"]["path"] = "";
+			worker_args["output"]["advanced"]["save_solve_sequence_debug"] = false;
+
+			for (std::unique_ptr<State> &worker : workers)
+			{
+				worker = std::make_unique<State>();
+				worker->init(worker_args, /*strict_validation=*/false);
+				worker->mesh = mesh->copy();
+				worker->load_mesh();
+				worker->build_basis();
+				worker->assemble_rhs();
+				worker->assemble_mass_mat();
+				worker->solve_data.rhs_assembler = worker->build_rhs_assembler();
+
+				Eigen::MatrixXd worker_sol = sol;
+				worker->init_nonlinear_tensor_solve(worker_sol, t0 + dt);
+			}
+
+			// the workers replaced the global loggers
+			init_logger(sinks, args["output"]["log"]["level"]);
+		}
+
+		// --------------------------------------------------------------------
+		// Propagators of the state [x; v; a]
+
+		const int ndof = sol.size();
+		const auto propagate = [&](State &state, const Eigen::VectorXd &u, const double t_start, const int n_steps, const double step_dt, std::vector<Eigen::VectorXd> *trajectory) -> Eigen::VectorXd {
+			SolveData &data = state.solve_data;
+			ImplicitTimeIntegrator &time_integrator = *(data.time_integrator);
+
+			time_integrator.init(u.segment(0, ndof), u.segment(ndof, ndof), u.segment(2 * ndof, ndof), step_dt);
+			data.update_dt();
+
+			Eigen::MatrixXd x = u.segment(0, ndof);
+			data.nl_problem->update_quantities(t_start + step_dt, x);
+			data.update_barrier_stiffness(x);
+
+			for (int s = 1; s <= n_steps; ++s)
+			{
+				state.predict_time_step(x);
+				state.solve_tensor_nonlinear(x, s);
+				if (trajectory)
+					trajectory->push_back(x);
+
+				time_integrator.update_quantities(x);
+				data.nl_problem->update_quantities(t_start + (s + 1) * step_dt, x);
+				data.update_barrier_stiffness(x);
+			}
+
+			Eigen::VectorXd u_end(3 * ndof);
+			u_end << time_integrator.x_prev(), time_integrator.v_prev(), time_integrator.a_prev();
+			return u_end;
+		};
+
+		// fine solutions of every slice, from its last fine propagation
+		std::vector<std::vector<Eigen::VectorXd>> trajectories(n_slices);
+
+		const Parareal::Propagator coarse = [&](const int slice, const Eigen::VectorXd &u) {
+			POLYFEM_PROFILE_ZONE("parareal coarse");
+			return propagate(*this, u, t0 + slice * slice_dt, coarse_steps, slice_dt / coarse_steps, nullptr);
+		};
+
+		const Parareal::Propagator fine = [&](const int slice, const Eigen::VectorXd &u) {
+			trajectories[slice].clear();
+			return propagate(*workers[slice], u, t0 + slice * slice_dt, fine_steps, dt, &trajectories[slice]);
+		};
+
+		Eigen::VectorXd u0(3 * ndof);
+		{
+			const ImplicitTimeIntegrator &time_integrator = *(solve_data.time_integrator);
+			u0 << time_integrator.x_prev(), time_integrator.v_prev(), time_integrator.a_prev();
+		}
+
+		{
+			POLYFEM_SCOPED_TIMER("Parareal");
+			parareal.solve(u0, n_slices, ndof, coarse, fine);
+		}
+		logger().info("Parareal converged in {} iteration(s)", parareal.iterations());
+
+		// --------------------------------------------------------------------
+		// Save the fine solutions
+
+		save_timestep(t0, 0, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+
+		for (int slice = 0; slice < n_slices; ++slice)
+		{
+			assert(trajectories[slice].size() == fine_steps);
+			for (int s = 1; s <= fine_steps; ++s)
+			{
+				const int t = slice * fine_steps + s;
+				sol = trajectories[slice][s - 1];
+				save_timestep(t0 + dt * t, t, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+			}
+		}
+	}
+
+	void State::solve_transient_tensor_explicit(const int time_steps, const double t0, const double dt, Eigen::MatrixXd &sol)
+	{
+		if (optimization_enabled != solver::CacheLevel::None)
+			log_and_throw_adjoint_error("Explicit time integrators do not support the adjoint!");
+		if (args["space"]["remesh"]["enabled"])
+			log_and_throw_error("Explicit time integrators do not support remeshing!");
+		if (has_periodic_bc() || args["contact"]["periodic"].get<bool>())
+			log_and_throw_error("Explicit time integrators do not support periodic boundary conditions!");
+		if (is_contact_enabled() && args["contact"]["friction_coefficient"].get<double>() > 0)
+			log_and_throw_error("Explicit time integrators do not support friction!");
+		if (!utils::json_as_array(args["solver"]["rayleigh_damping"]).empty())
+			log_and_throw_error("Explicit time integrators do not support Rayleigh damping!");
+
+		const std::shared_ptr<ExplicitTimeIntegrator> integrator = ExplicitTimeIntegrator::construct_time_integrator(args["time"]["integrator"]);
+
+		// --------------------------------------------------------------------
+		// Lumped mass and critical time step
+
+		Eigen::VectorXd lumped_mass;
+		{
+			POLYFEM_SCOPED_TIMER("Assemble lumped mass");
+			assembler::MassMatrixAssembler().assemble_lumped(
+				mesh->is_volume(), mesh->dimension(), n_bases, mass_matrix_assembler->density(), bases, geom_bases(),
+				integrator->lumping() == "HRZ" ? assembler::MassMatrixAssembler::Lumping::HRZ : assembler::MassMatrixAssembler::Lumping::RowSum,
+				lumped_mass);
+		}
+		assert(lumped_mass.size() == sol.size());
+		if (lumped_mass.minCoeff() <= 0)
+			log_and_throw_error("The lumped mass has non-positive entries, use the HRZ lumping!");
+
+		double critical_dt;
+		{
+			POLYFEM_SCOPED_TIMER("Estimate critical time step");
+			StiffnessMatrix stiffness;
+			SparseMatrixCache mat_cache;
+			assembler->assemble_hessian(
+				mesh->is_volume(), n_bases, /*project_to_psd=*/false, bases, geom_bases(), ass_vals_cache,
+				t0, dt, sol, sol, mat_cache, stiffness);
+			critical_dt = ExplicitTimeIntegrator::critical_time_step(stiffness, lumped_mass, boundary_nodes);
+		}
+
+		// the stiffness grows with the deformation, the CFL factor keeps a margin
+		const int substeps = std::isfinite(critical_dt) ? std::max(1, int(std::ceil(dt / (integrator->cfl() * critical_dt)))) : 1;
+		const double sub_dt = dt / substeps;
+		logger().info("Critical time step {:g}, {} explicit step(s) of {:g} per time step", critical_dt, substeps, sub_dt);
+
+		// --------------------------------------------------------------------
+		// Forms evaluated with the backward difference velocity of the explicit steps
+
+		integrator->init(sol, Eigen::VectorXd::Zero(sol.size()), Eigen::VectorXd::Zero(sol.size()), sub_dt);
+		solve_data.explicit_time_integrator = integrator;
+		init_nonlinear_tensor_solve(sol, t0 + sub_dt);
+
+		NLProblem &nl_problem = *(solve_data.nl_problem);
+		const std::array<std::shared_ptr<Form>, 5> force_forms{
+			{solve_data.elastic_form, solve_data.body_form, solve_data.pressure_form, solve_data.damping_form, solve_data.contact_form}};
+
+		const auto constrain = [&](Eigen::VectorXd &x) {
+			x = nl_problem.reduced_to_full(nl_problem.full_to_reduced(x));
+		};
+
+		const auto acceleration = [&](const Eigen::VectorXd &x) -> Eigen::VectorXd {
+			nl_problem.solution_changed(nl_problem.full_to_reduced(x));
+
+			Eigen::VectorXd force = Eigen::VectorXd::Zero(x.size());
+			Eigen::VectorXd grad;
+			for (const std::shared_ptr<Form> &form : force_forms)
+			{
+				if (form == nullptr || !form->enabled())
+					continue;
+				form->first_derivative(x, grad);
+				force -= grad;
+			}
+
+			// the forms are weighted by the acceleration scaling of the implicit integrator
+			Eigen::VectorXd a = force.cwiseQuotient(lumped_mass) / solve_data.time_integrator->acceleration_scaling();
+			for (const int i : boundary_nodes)
+				a(i) = 0;
+			return a;
+		};
+
+		integrator->init(sol, solve_data.time_integrator->v_prev(), acceleration(sol), sub_dt);
+
+		// --------------------------------------------------------------------
+		// Time stepping
+
+		EnergyCSVWriter energy_csv(resolve_output_path("energy.csv"), solve_data);
+
+		energy_csv.write(0, sol);
+		save_timestep(t0, 0, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+
+		for (int t = 1; t <= time_steps; ++t)
+		{
+			{
+				POLYFEM_SCOPED_TIMER("Explicit steps");
+				POLYFEM_PROFILE_ZONE("explicit steps");
+				for (int s = 1; s <= substeps; ++s)
+				{
+					const Eigen::VectorXd x_prev = integrator->x();
+					integrator->step(constrain, acceleration);
+
+					if (solve_data.contact_form != nullptr && solve_data.contact_form->max_step_size(x_prev, integrator->x()) < 1)
+						log_and_throw_error("Explicit step at t={} goes through a contact, reduce the time step!", t0 + ((t - 1) * substeps + s) * sub_dt);
+
+					solve_data.time_integrator->update_quantities(integrator->x());
+					nl_problem.update_quantities(t0 + ((t - 1) * substeps + s + 1) * sub_dt, nl_problem.full_to_reduced(integrator->x()));
+				}
+				sol = integrator->x();
+				solve_data.update_barrier_stiffness(sol);
+			}
+
+			energy_csv.write(t, sol);
+			save_timestep(t0 + dt * t, t, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+
+			logger().info("{}/{}  t={}", t, time_steps, t0 + dt * t);
+
+			const std::string &state_path = resolve_output_path(fmt::format(args["output"]["data"]["state"], t));
+			if (!state_path.empty())
+				integrator->save_state(state_path);
+
+			save_restart_json(t0, dt, t);
+		}
+	}
+
 	void State::init_nonlinear_tensor_solve(Eigen::MatrixXd &sol, const double t, const bool init_time_integrator)
 	{
 		assert(sol.cols() == 1);
-		assert(!assembler->is_linear() || is_contact_enabled()); // non-linear
+		assert(!assembler->is_linear() || is_contact_enabled() || solve_data.explicit_time_integrator != nullptr); // non-linear
 		assert(!problem->is_scalar());                           // tensor
 		assert(mixed_assembler == nullptr);
 
@@ -148,6 +535,18 @@ namespace polyfem
 				sol = initial_sol_update;
 			else
 				initial_sol_update = sol;
+
+			if (!problem->is_time_dependent() && warm_start_sol.size() == sol.size())
+			{
+				const bool valid = !is_contact_enabled()
+								   || !ipc::has_intersections(
+									   collision_mesh, collision_mesh.displace_vertices(utils::unflatten(warm_start_sol, mesh->dimension())),
+									   args["solver"]["contact"]["CCD"]["broad_phase"]);
+				if (valid)
+					sol = warm_start_sol;
+				else
+					logger().debug("Warm start has intersections, using the default initial solution");
+			}
 		}
 
 		// --------------------------------------------------------------------
@@ -175,7 +574,10 @@ namespace polyfem
 			if (init_time_integrator)
 			{
 				POLYFEM_SCOPED_TIMER("Initialize time integrator");
-				solve_data.time_integrator = ImplicitTimeIntegrator::construct_time_integrator(args["time"]["integrator"]);
+				if (solve_data.explicit_time_integrator != nullptr)
+					solve_data.time_integrator = std::make_shared<ImplicitEuler>();
+				else
+					solve_data.time_integrator = ImplicitTimeIntegrator::construct_time_integrator(args["time"]["integrator"]);
 
 				Eigen::MatrixXd solution, velocity, acceleration;
 				initial_solution(solution); // Reload this because we need all previous solutions
@@ -194,7 +596,7 @@ namespace polyfem
 						initial_vel_update = velocity;
 				}
 
-				const double dt = args["time"]["dt"];
+				const double dt = solve_data.explicit_time_integrator != nullptr ? solve_data.explicit_time_integrator->dt() : args["time"]["dt"].get<double>();
 				solve_data.time_integrator->init(solution, velocity, acceleration, dt);
 			}
 			assert(solve_data.time_integrator != nullptr);
@@ -216,6 +618,8 @@ namespace polyfem
 		damping_prev_assembler = std::make_shared<assembler::ViscousDampingPrev>();
 		set_materials(*damping_prev_assembler);
 
+		assemble_hourglass_stiffness();
+
 		const std::vector<std::shared_ptr<Form>> forms = solve_data.init_forms(
 			// General
 			units,
@@ -243,7 +647,7 @@ namespace polyfem
 			args["solver"]["contact"]["CCD"]["broad_phase"],
 			args["solver"]["contact"]["CCD"]["tolerance"],
 			args["solver"]["contact"]["CCD"]["max_iterations"],
-			optimization_enabled == solver::CacheLevel::Derivatives,
+			solver::caches_derivatives(optimization_enabled),
 			// Homogenization
 			macro_strain_constraint,
 			// Periodic contact
@@ -253,13 +657,31 @@ namespace polyfem
 			args["contact"]["epsv"],
 			args["solver"]["contact"]["friction_iterations"],
 			// Rayleigh damping form
-			args["solver"]["rayleigh_damping"]);
+			args["solver"]["rayleigh_damping"],
+			// Implicit obstacles
+			obstacle.implicit_obstacles(),
+			// Hourglass form
+			hourglass_stiffness);
 
 		for (const auto &form : forms)
 			form->set_output_dir(output_dir);
 
+		if (const auto nl_assembler = std::dynamic_pointer_cast<assembler::NLAssembler>(assembler))
+			nl_assembler->set_hessian_reuse_tolerance(args["solver"]["advanced"]["hessian_reuse_tolerance"]);
+
 		if (solve_data.contact_form != nullptr)
+		{
 			solve_data.contact_form->save_ccd_debug_meshes = args["output"]["advanced"]["save_ccd_debug_meshes"];
+			solve_data.contact_form->set_broad_phase_skin(args["solver"]["contact"]["broad_phase_skin"]);
+			if (args["solver"]["contact"]["CCD"]["broad_phase"] == "auto")
+				solve_data.contact_form->set_broad_phase_autotuning(
+					args["solver"]["contact"]["CCD"]["autotuning"]["trial_calls"],
+					args["solver"]["contact"]["CCD"]["autotuning"]["period"]);
+			// the contact Hessians are assembled from their local blocks directly wrt the FE dofs
+			solve_data.contact_form->set_displacement_map(collision_mesh_topology.displacement_map);
+		}
+		if (solve_data.friction_form != nullptr)
+			solve_data.friction_form->set_displacement_map(collision_mesh_topology.displacement_map);
 
 		// --------------------------------------------------------------------
 		// Initialize nonlinear problems
@@ -268,6 +690,10 @@ namespace polyfem
 		solve_data.nl_problem = std::make_shared<NLProblem>(
 			ndof, boundary_nodes, local_boundary, n_boundary_samples(),
 			*solve_data.rhs_assembler, periodic_bc, t, forms);
+		solve_data.nl_problem->set_hessian_export(
+			resolve_output_path(args["output"]["data"]["hessian"]), args["output"]["data"]["advanced"]["compression"]);
+		solve_data.nl_problem->set_hessian_lagging(
+			args["solver"]["advanced"]["hessian_lag_iterations"], args["solver"]["advanced"]["hessian_lag_ratio"]);
 		solve_data.nl_problem->init(sol);
 		solve_data.nl_problem->update_quantities(t, sol);
 		// --------------------------------------------------------------------
@@ -275,6 +701,37 @@ namespace polyfem
 		stats.solver_info = json::array();
 	}
 
+	void State::predict_time_step(Eigen::MatrixXd &sol) const
+	{
+		const Predictor predictor = args["time"]["predictor"];
+		if (predictor == Predictor::NONE || solve_data.time_integrator == nullptr)
+			return;
+
+		POLYFEM_SCOPED_TIMER("Predict time step");
+		const Eigen::VectorXd x0 = sol;
+		const Eigen::VectorXd x1 = solve_data.time_integrator->predict(predictor);
+		assert(x1.size() == x0.size());
+
+		double step = 1;
+		if (solve_data.contact_form != nullptr)
+		{
+			const double max_step = solve_data.contact_form->max_step_size(x0, x1);
+			// keep a margin from the contact, as the line search does
+			if (max_step < 1)
+				step = 0.8 * max_step;
+		}
+
+		const Eigen::VectorXd x = x0 + step * (x1 - x0);
+		if (step <= 0 || !solve_data.elastic_form->is_step_valid(x0, x))
+		{
+			logger().debug("Time step predictor is not valid, using the previous solution");
+			return;
+		}
+
+		logger().trace("Time step predictor with step {}", step);
+		sol = x;
+	}
+
 	void State::solve_tensor_nonlinear(Eigen::MatrixXd &sol, const int t, const bool init_lagging)
 	{
 		assert(solve_data.nl_problem != nullptr);
@@ -300,6 +757,15 @@ namespace polyfem
 
 		// ---------------------------------------------------------------------
 
+		if (observers_.empty())
+			nl_problem.post_step_callback = nullptr;
+		else
+			nl_problem.post_step_callback = [this, t, &nl_problem](const int iter, const Eigen::VectorXd &full_x) {
+				StateEvent event(StateEvent::Type::NEWTON_ITERATION, t, nl_problem.time(), full_x);
+				event.iteration = iter;
+				notify_observers(event);
+			};
+
 		std::shared_ptr<polysolve::nonlinear::Solver> nl_solver = make_nl_solver(true);
 
 		ALSolver al_solver(
@@ -308,6 +774,7 @@ namespace polyfem
 			args["solver"]["augmented_lagrangian"]["scaling"],
 			args["solver"]["augmented_lagrangian"]["max_weight"],
 			args["solver"]["augmented_lagrangian"]["eta"],
+			solve_data.al_weight,
 			[&](const Eigen::VectorXd &x) {
 				this->solve_data.update_barrier_stiffness(sol);
 			});
@@ -333,7 +800,7 @@ namespace polyfem
 		// TODO: Make this more general
 		const double lagging_tol = args["solver"]["contact"].value("friction_convergence_tol", 1e-2) * units.characteristic_length();
 
-		if (optimization_enabled != solver::CacheLevel::Derivatives)
+		if (!solver::caches_derivatives(optimization_enabled))
 		{
 			// Lagging loop (start at 1 because we already did an iteration above)
 			bool lagging_converged = !nl_problem.uses_lagging();
@@ -2,6 +2,10 @@
 
 #include <polyfem/utils/Logger.hpp>
 
+#include <Eigen/Dense>
+
+#include <cmath>
+
 namespace polyfem::time_integrator
 {
 	BDF::BDF(const int order)
@@ -122,6 +126,23 @@ namespace polyfem::time_integrator
 		return -alphas(steps() - 1)[i] / beta_dt();
 	}
 
+	Eigen::VectorXd BDF::predict() const
+	{
+		// p(s) = sum_j c_j s^j in units of dt, p(-i) = x^{t-i} and p'(0) = dt v^t, evaluated at s = 1
+		const int n = steps();
+		Eigen::MatrixXd A = Eigen::MatrixXd::Zero(n + 1, n + 1);
+		for (int i = 0; i < n; ++i)
+			for (int j = 0; j <= n; ++j)
+				A(i, j) = std::pow(-double(i), j);
+		A(n, 1) = 1;
+		const Eigen::VectorXd weights = A.transpose().partialPivLu().solve(Eigen::VectorXd::Ones(n + 1));
+
+		Eigen::VectorXd prediction = weights(n) * dt() * v_prev();
+		for (int i = 0; i < n; ++i)
+			prediction += weights(i) * x_prevs_[i];
+		return prediction;
+	}
+
 	double BDF::beta_dt() const
 	{
 		return betas(steps() - 1) * dt();
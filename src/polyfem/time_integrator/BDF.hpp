@@ -65,6 +65,14 @@ namespace polyfem::time_integrator
 		/// @param prev_ti index of the previous solution to use (0 -> current; 1 -> previous; 2 -> second previous; etc.)
 		double dv_dx(const unsigned prev_ti = 0) const override;
 
+		/// @brief Predict the next solution with the polynomial of degree n interpolating the n previous solutions and the last velocity.
+		/// @return predicted solution at the next time step, with an error of the same order as BDFn
+		Eigen::VectorXd predict() const override;
+		using ImplicitTimeIntegrator::predict;
+
+		/// @brief Order of accuracy, the number of previous solutions used.
+		int order() const override { return steps(); }
+
 		/// @brief Compute \f$\beta\Delta t\f$
 		double beta_dt() const;
 
@@ -0,0 +1,17 @@
+#include "CentralDifference.hpp"
+
+namespace polyfem::time_integrator
+{
+	void CentralDifference::step(const ConstraintFunction &constrain, const AccelerationFunction &acceleration)
+	{
+		Eigen::VectorXd x = x_ + dt() * (v_ + 0.5 * dt() * a_);
+		constrain(x);
+
+		// the constrained dofs move with the velocity of their prescribed values
+		const Eigen::VectorXd v_half = (x - x_) / dt();
+
+		a_ = acceleration(x);
+		v_ = v_half + 0.5 * dt() * a_;
+		x_ = x;
+	}
+} // namespace polyfem::time_integrator
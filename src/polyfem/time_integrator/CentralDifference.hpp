@@ -0,0 +1,25 @@
+#pragma once
+
+#include <polyfem/time_integrator/ExplicitTimeIntegrator.hpp>
+
+namespace polyfem::time_integrator
+{
+	/// Explicit central difference time integrator, in its velocity Verlet form.
+	/// \f[
+	/// 	v^{t+1/2} = v^t + \frac{\Delta t}{2} a^t\newline
+	/// 	x^{t+1} = x^t + \Delta t v^{t+1/2}\newline
+	/// 	v^{t+1} = v^{t+1/2} + \frac{\Delta t}{2} a^{t+1}
+	/// \f]
+	/// Second order accurate and stable for \f$\Delta t \leq 2/\omega_{max}\f$.
+	/// @see https://en.wikipedia.org/wiki/Verlet_integration#Velocity_Verlet
+	class CentralDifference : public ExplicitTimeIntegrator
+	{
+	public:
+		CentralDifference() {}
+
+		/// @brief Advance the solution by one time step, the acceleration is evaluated once at \f$x^{t+1}\f$.
+		/// @param constrain projects the new solution onto the constraints of the next time
+		/// @param acceleration evaluates the acceleration at the new solution
+		void step(const ConstraintFunction &constrain, const AccelerationFunction &acceleration) override;
+	};
+} // namespace polyfem::time_integrator
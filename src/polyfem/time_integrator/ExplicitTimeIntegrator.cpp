@@ -0,0 +1,137 @@
+#include "ExplicitTimeIntegrator.hpp"
+
+#include <polyfem/time_integrator/CentralDifference.hpp>
+#include <polyfem/time_integrator/SymplecticEuler.hpp>
+
+#include <polyfem/io/MatrixIO.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace polyfem
+{
+	using namespace io;
+	namespace time_integrator
+	{
+		void ExplicitTimeIntegrator::set_parameters(const json &params)
+		{
+			lumping_ = params.value("lumping", lumping_);
+			cfl_ = params.value("cfl", cfl_);
+
+			if (lumping_ != "row_sum" && lumping_ != "HRZ")
+				log_and_throw_error("Unknown mass lumping ({})", lumping_);
+			if (cfl_ <= 0)
+				log_and_throw_error("The CFL safety factor must be positive ({})", cfl_);
+		}
+
+		void ExplicitTimeIntegrator::init(
+			const Eigen::VectorXd &x,
+			const Eigen::VectorXd &v,
+			const Eigen::VectorXd &a,
+			const double dt)
+		{
+			assert(x.size() == v.size() && x.size() == a.size());
+			x_ = x;
+			v_ = v;
+			a_ = a;
+
+			assert(dt > 0);
+			dt_ = dt;
+		}
+
+		void ExplicitTimeIntegrator::save_state(const std::string &state_path) const
+		{
+			assert(!state_path.empty());
+
+			write_matrix(state_path, "u", Eigen::MatrixXd(x_), /*replace=*/true);
+			write_matrix(state_path, "v", Eigen::MatrixXd(v_), /*replace=*/false);
+			write_matrix(state_path, "a", Eigen::MatrixXd(a_), /*replace=*/false);
+		}
+
+		double ExplicitTimeIntegrator::critical_time_step(
+			const StiffnessMatrix &stiffness,
+			const Eigen::VectorXd &lumped_mass,
+			const std::vector<int> &fixed_dofs,
+			const int max_iterations)
+		{
+			assert(stiffness.rows() == lumped_mass.size() && stiffness.cols() == lumped_mass.size());
+
+			Eigen::VectorXd free = Eigen::VectorXd::Ones(lumped_mass.size());
+			for (const int i : fixed_dofs)
+				free(i) = 0;
+			const Eigen::VectorXd inv_sqrt_mass = free.cwiseQuotient(lumped_mass.cwiseSqrt());
+
+			// power iteration on the symmetric M^{-1/2} K M^{-1/2} restricted to the free dofs
+			Eigen::VectorXd y = free.cwiseProduct(Eigen::VectorXd::LinSpaced(free.size(), 1, 2));
+			if (y.norm() == 0)
+				return std::numeric_limits<double>::infinity();
+			y.normalize();
+
+			double omega2 = 0;
+			for (int i = 0; i < max_iterations; ++i)
+			{
+				const Eigen::VectorXd ky = inv_sqrt_mass.cwiseProduct(stiffness * inv_sqrt_mass.cwiseProduct(y));
+				const double prev_omega2 = omega2;
+				omega2 = y.dot(ky);
+
+				const double norm = ky.norm();
+				if (norm == 0)
+					break;
+				y = ky / norm;
+
+				if (std::abs(omega2 - prev_omega2) <= 1e-3 * std::abs(omega2))
+					break;
+			}
+
+			if (omega2 <= 0)
+				return std::numeric_limits<double>::infinity();
+			return 2 / std::sqrt(omega2);
+		}
+
+		std::shared_ptr<ExplicitTimeIntegrator> ExplicitTimeIntegrator::construct_time_integrator(const json &params)
+		{
+			const std::string type = params.is_object() ? params["type"] : params;
+
+			std::shared_ptr<ExplicitTimeIntegrator> integrator;
+			if (type == "CentralDifference")
+			{
+				integrator = std::make_shared<CentralDifference>();
+			}
+			else if (type == "SymplecticEuler")
+			{
+				integrator = std::make_shared<SymplecticEuler>();
+			}
+			else
+			{
+				logger().error("Unknown time integrator ({})", type);
+				throw std::runtime_error(fmt::format("Unknown time integrator ({})", type));
+			}
+
+			if (params.is_object())
+				integrator->set_parameters(params);
+
+			return integrator;
+		}
+
+		bool ExplicitTimeIntegrator::is_explicit(const json &params)
+		{
+			if (!params.is_object() && !params.is_string())
+				return false;
+			const std::string type = params.is_object() ? params.value("type", "") : params.get<std::string>();
+
+			const std::vector<std::string> &names = get_time_integrator_names();
+			return std::find(names.begin(), names.end(), type) != names.end();
+		}
+
+		const std::vector<std::string> &ExplicitTimeIntegrator::get_time_integrator_names()
+		{
+			static const std::vector<std::string> names = {
+				std::string("CentralDifference"),
+				std::string("SymplecticEuler"),
+			};
+			return names;
+		}
+	} // namespace time_integrator
+} // namespace polyfem
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+#include <polyfem/utils/Types.hpp>
+
+#include <Eigen/Core>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace polyfem::time_integrator
+{
+	/// Explicit time integrator of a second order ODE with a diagonal (lumped) mass matrix.
+	/// Every step evaluates the acceleration once and does not solve any system.
+	class ExplicitTimeIntegrator
+	{
+	public:
+		/// Evaluates the acceleration \f$M^{-1}f(x)\f$ at a solution.
+		using AccelerationFunction = std::function<Eigen::VectorXd(const Eigen::VectorXd &x)>;
+		/// Projects a solution onto the (Dirichlet) constraints.
+		using ConstraintFunction = std::function<void(Eigen::VectorXd &x)>;
+
+		ExplicitTimeIntegrator() {}
+		virtual ~ExplicitTimeIntegrator() = default;
+
+		/// @brief Set the time integrator parameters from a json object.
+		/// @param params json containing the lumping scheme and the CFL safety factor
+		virtual void set_parameters(const json &params);
+
+		/// @brief Initialize the time integrator.
+		/// @param x initial solution
+		/// @param v initial velocity
+		/// @param a initial acceleration, consistent with x
+		/// @param dt time step size
+		virtual void init(const Eigen::VectorXd &x, const Eigen::VectorXd &v, const Eigen::VectorXd &a, const double dt);
+
+		/// @brief Advance the solution by one time step.
+		/// @param constrain projects the new solution onto the constraints of the next time
+		/// @param acceleration evaluates the acceleration at the new solution
+		virtual void step(const ConstraintFunction &constrain, const AccelerationFunction &acceleration) = 0;
+
+		/// @brief Access the time step size.
+		double dt() const { return dt_; }
+		/// @brief Current solution.
+		const Eigen::VectorXd &x() const { return x_; }
+		/// @brief Current velocity.
+		const Eigen::VectorXd &v() const { return v_; }
+		/// @brief Current acceleration.
+		const Eigen::VectorXd &a() const { return a_; }
+
+		/// @brief Name of the mass lumping scheme, either "row_sum" or "HRZ".
+		const std::string &lumping() const { return lumping_; }
+		/// @brief Fraction of the critical time step used by a step.
+		double cfl() const { return cfl_; }
+
+		/// @brief Save the values of \f$x\f$, \f$v\f$, and \f$a\f$.
+		/// @param state_path path for the output file containing \f$x, v, a\f$ as hdf5
+		void save_state(const std::string &state_path) const;
+
+		/// @brief Estimate the critical time step \f$2/\omega_{max}\f$ of the explicit integrators.
+		/// The highest frequency \f$\omega_{max}^2\f$, the largest eigenvalue of \f$M^{-1}K\f$, is computed by power iteration.
+		/// It is bounded by the largest element frequency, so it accounts for the smallest element and the stiffest material.
+		/// @param stiffness stiffness matrix \f$K\f$, i.e., Hessian of the elastic energy
+		/// @param lumped_mass diagonal of the lumped mass matrix \f$M\f$
+		/// @param fixed_dofs constrained dofs, excluded from the estimate
+		/// @param max_iterations maximum number of power iterations
+		/// @return critical time step, infinity if the problem has no stiffness
+		static double critical_time_step(
+			const StiffnessMatrix &stiffness,
+			const Eigen::VectorXd &lumped_mass,
+			const std::vector<int> &fixed_dofs,
+			const int max_iterations = 100);
+
+		/// @brief Factory method for constructing explicit time integrators from the name of the integrator.
+		/// @param params name of the integrator or json with its type and parameters
+		/// @return new explicit time integrator of type specfied by name
+		static std::shared_ptr<ExplicitTimeIntegrator> construct_time_integrator(const json &params);
+
+		/// @brief Check if the integrator described by params is explicit.
+		static bool is_explicit(const json &params);
+
+		/// @brief Get a vector of the names of possible ExplicitTimeIntegrators
+		/// @return names in no particular order
+		static const std::vector<std::string> &get_time_integrator_names();
+
+	protected:
+		double dt_ = 1;
+
+		Eigen::VectorXd x_;
+		Eigen::VectorXd v_;
+		Eigen::VectorXd a_;
+
+		std::string lumping_ = "row_sum";
+		double cfl_ = 0.9;
+	};
+} // namespace polyfem::time_integrator
@@ -69,6 +69,9 @@ namespace polyfem::time_integrator
 
 		double da_dx(const unsigned prev_ti = 0) const;
 
+		/// @brief Order of accuracy, second order for the trapezoidal rule.
+		int order() const override { return gamma() == 0.5 ? 2 : 1; }
+
 		/// @brief \f$\beta\f$ parameter for blending accelerations in the solution update.
 		double beta() const { return beta_; }
 		/// @brief \f$\gamma\f$ parameter for blending accelerations in the velocity update.
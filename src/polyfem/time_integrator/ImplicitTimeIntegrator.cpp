@@ -41,6 +41,63 @@ namespace polyfem
 			dt_ = dt;
 		}
 
+		void ImplicitTimeIntegrator::set_dt(const double dt)
+		{
+			assert(dt > 0);
+
+			// Lagrange interpolation of the previous values at the times -i * dt
+			const int n = steps();
+			const double ratio = dt / dt_;
+			if (n > 1 && ratio != 1)
+			{
+				const auto resample = [&](std::deque<Eigen::VectorXd> &prevs) {
+					std::deque<Eigen::VectorXd> resampled(prevs.size(), Eigen::VectorXd::Zero(prevs.front().size()));
+					resampled.front() = prevs.front();
+					for (int j = 1; j < n; ++j)
+					{
+						// in units of the previous time step
+						const double s = -j * ratio;
+						for (int i = 0; i < n; ++i)
+						{
+							double weight = 1;
+							for (int m = 0; m < n; ++m)
+								if (m != i)
+									weight *= (s + m) / double(m - i);
+							resampled[j] += weight * prevs[i];
+						}
+					}
+					prevs = std::move(resampled);
+				};
+
+				resample(x_prevs_);
+				resample(v_prevs_);
+				resample(a_prevs_);
+			}
+
+			dt_ = dt;
+		}
+
+		Eigen::VectorXd ImplicitTimeIntegrator::predict() const
+		{
+			return x_prev() + dt() * (v_prev() + 0.5 * dt() * a_prev());
+		}
+
+		Eigen::VectorXd ImplicitTimeIntegrator::predict(const Predictor predictor) const
+		{
+			switch (predictor)
+			{
+			case Predictor::NONE:
+				return x_prev();
+			case Predictor::CONSTANT_VELOCITY:
+				return x_prev() + dt() * v_prev();
+			case Predictor::CONSTANT_ACCELERATION:
+				return ImplicitTimeIntegrator::predict();
+			case Predictor::EXTRAPOLATION:
+				return predict();
+			}
+			return x_prev();
+		}
+
 		void ImplicitTimeIntegrator::save_state(const std::string &state_path) const
 		{
 			assert(!state_path.empty());
@@ -10,6 +10,22 @@
 
 namespace polyfem::time_integrator
 {
+	/// Extrapolation of the previous steps used as initial guess of the next one
+	enum class Predictor
+	{
+		NONE,                  ///< previous solution
+		CONSTANT_VELOCITY,     ///< \f$x^t + \Delta t v^t\f$
+		CONSTANT_ACCELERATION, ///< \f$x^t + \Delta t v^t + \frac{\Delta t^2}{2} a^t\f$
+		EXTRAPOLATION          ///< predict() of the integrator, from the whole history for BDF
+	};
+
+	NLOHMANN_JSON_SERIALIZE_ENUM(
+		Predictor,
+		{{Predictor::NONE, "none"},
+		 {Predictor::CONSTANT_VELOCITY, "constant_velocity"},
+		 {Predictor::CONSTANT_ACCELERATION, "constant_acceleration"},
+		 {Predictor::EXTRAPOLATION, "extrapolation"}});
+
 	/// Implicit time integrator of a second order ODE (equivently a system of coupled first order ODEs).
 	class ImplicitTimeIntegrator
 	{
@@ -58,6 +74,25 @@ namespace polyfem::time_integrator
 		/// @brief Access the time step size.
 		const double &dt() const { return dt_; }
 
+		/// @brief Change the time step size, the history of a multi-step integrator is resampled at the new spacing.
+		/// @param dt new time step size
+		virtual void set_dt(const double dt);
+
+		/// @brief Predict the next solution by extrapolating the history, used to estimate the error of a step.
+		/// \f[
+		/// 	x^{t+1}_p = x^t + \Delta t v^t + \frac{\Delta t^2}{2} a^t
+		/// \f]
+		/// @return predicted solution at the next time step
+		virtual Eigen::VectorXd predict() const;
+
+		/// @brief Predict the next solution.
+		/// @param predictor type of extrapolation
+		/// @return predicted solution at the next time step
+		Eigen::VectorXd predict(const Predictor predictor) const;
+
+		/// @brief Order of accuracy of the integrator, the local error is \f$O(\Delta t^{q+1})\f$.
+		virtual int order() const { return 1; }
+
 		/// @brief Save the values of \f$x\f$, \f$v\f$, and \f$a\f$.
 		/// @param state_path path for the output file containing \f$x, v, a\f$ as hdf5
 		virtual void save_state(const std::string &state_path) const;
@@ -88,10 +123,11 @@ namespace polyfem::time_integrator
 		/// @brief Get the current number of steps to use for integration.
 		int steps() const { return x_prevs_.size(); }
 
-	protected:
 		/// @brief Get the maximum number of steps to use for integration.
 		virtual int max_steps() const { return 1; }
 
+	protected:
+
 		/// @brief Time step size.
 		/// Default of one for static sims, this should be set using init().
 		double dt_ = 1;
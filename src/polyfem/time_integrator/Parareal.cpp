@@ -0,0 +1,69 @@
+#include "Parareal.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <algorithm>
+
+namespace polyfem::time_integrator
+{
+	Parareal::Parareal(const json &params, const double characteristic_length)
+	{
+		slices_ = params["slices"];
+		coarse_steps_ = params["coarse_steps"];
+		max_iterations_ = params["max_iterations"];
+		tolerance_ = params["tolerance"].get<double>() * characteristic_length;
+
+		if (slices_ < 0 || coarse_steps_ < 1 || max_iterations_ < 1)
+			log_and_throw_error("Parareal needs a non-negative number of slices, at least one coarse step and one iteration");
+	}
+
+	std::vector<Eigen::VectorXd> Parareal::solve(
+		const Eigen::VectorXd &u0,
+		const int n_slices,
+		const Eigen::Index error_size,
+		const Propagator &coarse,
+		const Propagator &fine)
+	{
+		assert(n_slices > 0);
+		assert(error_size <= u0.size());
+
+		// initial guess from the coarse propagator alone
+		std::vector<Eigen::VectorXd> u(n_slices + 1), g(n_slices + 1), f(n_slices + 1);
+		u[0] = u0;
+		for (int n = 0; n < n_slices; ++n)
+		{
+			g[n + 1] = coarse(n, u[n]);
+			u[n + 1] = g[n + 1];
+		}
+
+		iterations_ = 0;
+		for (int k = 0; k < std::min(max_iterations_, n_slices); ++k)
+		{
+			// slices before k are converged
+			utils::maybe_parallel_for(n_slices - k, [&](int start, int end, int thread_id) {
+				for (int n = k + start; n < k + end; ++n)
+					f[n + 1] = fine(n, u[n]);
+			});
+			++iterations_;
+
+			double change = 0;
+			for (int n = k; n < n_slices; ++n)
+			{
+				// the start of slice k did not change since its coarse propagation
+				const Eigen::VectorXd g_new = n == k ? g[n + 1] : coarse(n, u[n]);
+				const Eigen::VectorXd u_new = g_new + f[n + 1] - g[n + 1];
+				change = std::max(change, (u_new - u[n + 1]).head(error_size).lpNorm<Eigen::Infinity>());
+
+				u[n + 1] = u_new;
+				g[n + 1] = g_new;
+			}
+
+			logger().info("Parareal iteration {}: correction {:g} (tolerance {:g})", iterations_, change, tolerance_);
+			if (change <= tolerance_)
+				break;
+		}
+
+		return u;
+	}
+} // namespace polyfem::time_integrator
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <Eigen/Core>
+
+#include <functional>
+#include <vector>
+
+namespace polyfem::time_integrator
+{
+	/// Parareal iteration over time slices: a cheap coarse propagator \f$G\f$ run serially corrects
+	/// accurate fine propagators \f$F\f$ run in parallel over the slices,
+	/// \f[
+	/// 	U_{n+1}^{k+1} = G(U_n^{k+1}) + F(U_n^k) - G(U_n^k)
+	/// \f]
+	/// After k iterations the first k slices are exact, the iteration stops earlier once the correction is below the tolerance.
+	class Parareal
+	{
+	public:
+		/// @brief Propagate the state at the start of a slice to its end.
+		/// The fine propagator is called concurrently for different slices.
+		using Propagator = std::function<Eigen::VectorXd(const int slice, const Eigen::VectorXd &u)>;
+
+		/// @param params json of /time/parareal
+		/// @param characteristic_length length scaling the tolerance
+		Parareal(const json &params, const double characteristic_length);
+
+		/// @brief Run the parareal iteration.
+		/// @param u0 initial state
+		/// @param n_slices number of time slices
+		/// @param error_size only the first error_size entries of the states (e.g., the solution) are checked for convergence
+		/// @param coarse coarse propagator
+		/// @param fine fine propagator
+		/// @return states at the start of every slice and at the end of the last one
+		std::vector<Eigen::VectorXd> solve(
+			const Eigen::VectorXd &u0,
+			const int n_slices,
+			const Eigen::Index error_size,
+			const Propagator &coarse,
+			const Propagator &fine);
+
+		/// number of slices, 0 for one per thread
+		int slices() const { return slices_; }
+		/// number of coarse steps per slice
+		int coarse_steps() const { return coarse_steps_; }
+		/// number of iterations of the last solve
+		int iterations() const { return iterations_; }
+
+	private:
+		int slices_;
+		int coarse_steps_;
+		int max_iterations_;
+		double tolerance_;
+
+		int iterations_ = 0;
+	};
+} // namespace polyfem::time_integrator
@@ -0,0 +1,15 @@
+#include "SymplecticEuler.hpp"
+
+namespace polyfem::time_integrator
+{
+	void SymplecticEuler::step(const ConstraintFunction &constrain, const AccelerationFunction &acceleration)
+	{
+		Eigen::VectorXd x = x_ + dt() * (v_ + dt() * a_);
+		constrain(x);
+
+		// the constrained dofs move with the velocity of their prescribed values
+		v_ = (x - x_) / dt();
+		x_ = x;
+		a_ = acceleration(x_);
+	}
+} // namespace polyfem::time_integrator
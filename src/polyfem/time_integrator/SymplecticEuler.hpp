@@ -0,0 +1,24 @@
+#pragma once
+
+#include <polyfem/time_integrator/ExplicitTimeIntegrator.hpp>
+
+namespace polyfem::time_integrator
+{
+	/// Explicit symplectic (semi-implicit) Euler time integrator.
+	/// \f[
+	/// 	v^{t+1} = v^t + \Delta t a^t\newline
+	/// 	x^{t+1} = x^t + \Delta t v^{t+1}
+	/// \f]
+	/// First order accurate and stable for \f$\Delta t \leq 2/\omega_{max}\f$.
+	/// @see https://en.wikipedia.org/wiki/Semi-implicit_Euler_method
+	class SymplecticEuler : public ExplicitTimeIntegrator
+	{
+	public:
+		SymplecticEuler() {}
+
+		/// @brief Advance the solution by one time step, the acceleration is evaluated once at \f$x^{t+1}\f$ for the next step.
+		/// @param constrain projects the new solution onto the constraints of the next time
+		/// @param acceleration evaluates the acceleration at the new solution
+		void step(const ConstraintFunction &constrain, const AccelerationFunction &acceleration) override;
+	};
+} // namespace polyfem::time_integrator
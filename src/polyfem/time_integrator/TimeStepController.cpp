@@ -0,0 +1,44 @@
+#include "TimeStepController.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace polyfem::time_integrator
+{
+	TimeStepController::TimeStepController(const json &params, const double characteristic_length)
+	{
+		tolerance_ = params["tolerance"].get<double>() * characteristic_length;
+		safety_ = params["safety"];
+		min_factor_ = params["min_factor"];
+		max_factor_ = params["max_factor"];
+		min_dt_ = params["min_dt"];
+		max_dt_ = params["max_dt"].get<double>() > 0 ? params["max_dt"].get<double>() : std::numeric_limits<double>::infinity();
+		max_retries_ = params["max_retries"];
+		min_ccd_step_ = params["min_ccd_step"];
+
+		if (tolerance_ <= 0)
+			log_and_throw_error("Adaptive time stepping tolerance must be positive");
+		if (min_factor_ <= 0 || min_factor_ >= 1 || max_factor_ < 1)
+			log_and_throw_error("Adaptive time stepping factors must satisfy 0 < min_factor < 1 <= max_factor");
+	}
+
+	double TimeStepController::error(const Eigen::VectorXd &x, const Eigen::VectorXd &x_pred) const
+	{
+		assert(x.size() == x_pred.size());
+		return (x - x_pred).lpNorm<Eigen::Infinity>() / tolerance_;
+	}
+
+	double TimeStepController::next_dt(const double dt, const double error, const int order) const
+	{
+		const double factor = error > 0 ? (safety_ * std::pow(error, -1.0 / (order + 1))) : max_factor_;
+		return std::clamp(dt * std::clamp(factor, min_factor_, max_factor_), min_dt_, max_dt_);
+	}
+
+	double TimeStepController::shrink(const double dt, const double factor) const
+	{
+		return std::max(dt * std::clamp(factor, min_factor_, 1 - 1e-3), min_dt_);
+	}
+} // namespace polyfem::time_integrator
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <Eigen/Core>
+
+namespace polyfem::time_integrator
+{
+	/// Controller of adaptive time steps, from the local error estimated as the difference between the predicted and the solved solution.
+	class TimeStepController
+	{
+	public:
+		/// @param params json of /time/adaptive
+		/// @param characteristic_length length scaling the error tolerance
+		TimeStepController(const json &params, const double characteristic_length);
+
+		/// @brief Error of a step relative to the tolerance, the step is accepted if it is at most one.
+		/// @param x solution of the step
+		/// @param x_pred predicted solution of the step
+		double error(const Eigen::VectorXd &x, const Eigen::VectorXd &x_pred) const;
+
+		/// @brief Next time step size from the error of the last step.
+		/// \f[
+		/// 	\Delta t' = \Delta t\, \text{clamp}(s\, e^{-1/(q+1)}, f_{min}, f_{max})
+		/// \f]
+		/// @param dt last time step size
+		/// @param error relative error of the last step
+		/// @param order order of accuracy \f$q\f$ of the integrator
+		double next_dt(const double dt, const double error, const int order) const;
+
+		/// @brief Time step size after a failed step (nonlinear solve or collapsed CCD step).
+		/// @param dt failed time step size
+		/// @param factor suggested reduction, e.g., the fraction of the step free of collisions
+		double shrink(const double dt, const double factor = 0.5) const;
+
+		double min_dt() const { return min_dt_; }
+		/// infinite if unbounded
+		double max_dt() const { return max_dt_; }
+		int max_retries() const { return max_retries_; }
+		/// minimal fraction of the predicted step free of collisions before the step is solved
+		double min_ccd_step() const { return min_ccd_step_; }
+
+	private:
+		double tolerance_;
+		double safety_;
+		double min_factor_;
+		double max_factor_;
+		double min_dt_;
+		double max_dt_;
+		int max_retries_;
+		double min_ccd_step_;
+	};
+} // namespace polyfem::time_integrator
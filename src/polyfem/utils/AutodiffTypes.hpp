@@ -15,6 +15,13 @@ namespace polyfem
 
 	// typedef DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1>> 					AutodiffPt;
 
+	// derivatives wrt a number of variables known at compile time (e.g., the dim² entries of F), stored in
+	// fixed-size Eigen objects; they do not use DiffScalarBase::setVariableCount
+	template <int n_vars>
+	using AutodiffScalarGradFixed = DScalar1<double, Eigen::Matrix<double, n_vars, 1>>;
+	template <int n_vars>
+	using AutodiffScalarHessianFixed = DScalar2<double, Eigen::Matrix<double, n_vars, 1>, Eigen::Matrix<double, n_vars, n_vars>>;
+
 	template <class T>
 	class AutoDiffAllocator
 	{
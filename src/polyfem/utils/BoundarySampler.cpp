@@ -11,6 +11,12 @@
 #include <polyfem/mesh/mesh2D/NCMesh2D.hpp>
 
 #include <cassert>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
 
 namespace polyfem
 {
@@ -49,6 +55,204 @@ namespace polyfem
 				return Eigen::RowVector3d(p(local_index, 0), p(local_index, 1), p(local_index, 2));
 			}
 
+			void reference_quadrature_for_quad_edge(int index, int order, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::VectorXd &weights)
+			{
+				auto endpoints = BoundarySampler::quad_local_node_coordinates_from_edge(index);
+
+				Quadrature quad;
+				LineQuadrature quad_rule;
+				quad_rule.get_quadrature(order, quad);
+
+				points.resize(quad.points.rows(), endpoints.cols());
+				uv.resize(quad.points.rows(), 2);
+
+				uv.col(0) = (1.0 - quad.points.array());
+				uv.col(1) = quad.points.array();
+
+				for (int c = 0; c < 2; ++c)
+				{
+					points.col(c) = (1.0 - quad.points.array()) * endpoints(0, c) + quad.points.array() * endpoints(1, c);
+				}
+
+				weights = quad.weights;
+			}
+
+			void reference_quadrature_for_tri_edge(int index, int order, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::VectorXd &weights)
+			{
+				auto endpoints = BoundarySampler::tri_local_node_coordinates_from_edge(index);
+
+				Quadrature quad;
+				LineQuadrature quad_rule;
+				quad_rule.get_quadrature(order, quad);
+
+				points.resize(quad.points.rows(), endpoints.cols());
+				uv.resize(quad.points.rows(), 2);
+
+				uv.col(0) = (1.0 - quad.points.array());
+				uv.col(1) = quad.points.array();
+
+				for (int c = 0; c < 2; ++c)
+				{
+					points.col(c) = (1.0 - quad.points.array()) * endpoints(0, c) + quad.points.array() * endpoints(1, c);
+				}
+
+				weights = quad.weights;
+			}
+
+			void reference_quadrature_for_quad_face(int index, int order, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::VectorXd &weights)
+			{
+				auto endpoints = BoundarySampler::hex_local_node_coordinates_from_face(index);
+
+				Quadrature quad;
+				QuadQuadrature quad_rule;
+				quad_rule.get_quadrature(order, quad);
+
+				const int n_pts = quad.points.rows();
+				points.resize(n_pts, endpoints.cols());
+
+				uv.resize(quad.points.rows(), 4);
+				uv.col(0) = quad.points.col(0);
+				uv.col(1) = 1 - uv.col(0).array();
+				uv.col(2) = quad.points.col(1);
+				uv.col(3) = 1 - uv.col(2).array();
+
+				for (int i = 0; i < n_pts; ++i)
+				{
+					const double b1 = quad.points(i, 0);
+					const double b2 = 1 - b1;
+
+					const double b3 = quad.points(i, 1);
+					const double b4 = 1 - b3;
+
+					for (int c = 0; c < 3; ++c)
+					{
+						points(i, c) = b3 * (b1 * endpoints(0, c) + b2 * endpoints(1, c)) + b4 * (b1 * endpoints(3, c) + b2 * endpoints(2, c));
+					}
+				}
+
+				weights = quad.weights;
+			}
+
+			void reference_quadrature_for_tri_face(int index, int order, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::VectorXd &weights)
+			{
+				auto endpoints = BoundarySampler::tet_local_node_coordinates_from_face(index);
+				Quadrature quad;
+				TriQuadrature quad_rule;
+				quad_rule.get_quadrature(order, quad);
+
+				const int n_pts = quad.points.rows();
+				points.resize(n_pts, endpoints.cols());
+
+				uv.resize(quad.points.rows(), 3);
+				uv.col(0) = quad.points.col(0);
+				uv.col(1) = quad.points.col(1);
+				uv.col(2) = 1 - uv.col(0).array() - uv.col(1).array();
+
+				for (int i = 0; i < n_pts; ++i)
+				{
+					const double b1 = quad.points(i, 0);
+					const double b3 = quad.points(i, 1);
+					const double b2 = 1 - b1 - b3;
+
+					for (int c = 0; c < 3; ++c)
+					{
+						points(i, c) = b1 * endpoints(0, c) + b2 * endpoints(1, c) + b3 * endpoints(2, c);
+					}
+				}
+
+				weights = quad.weights;
+			}
+
+			/// quadrature or samples of a facet of the reference element, with unit facet measure
+			struct ReferenceFacet
+			{
+				Eigen::MatrixXd uv;
+				Eigen::MatrixXd points;
+				Eigen::MatrixXd normal;
+				Eigen::VectorXd weights;
+			};
+
+			/// The reference quadrature and samples only depend on the facet and the order (or number of samples),
+			/// they are built once and shared by all the elements, the mesh geometry only enters through facet_measure.
+			const ReferenceFacet &reference_facet(const BoundaryType type, const int index, const int n, const bool is_quadrature)
+			{
+				static std::shared_mutex mutex;
+				static std::map<std::tuple<BoundaryType, int, int, bool>, std::unique_ptr<const ReferenceFacet>> cache;
+
+				const auto key = std::make_tuple(type, index, n, is_quadrature);
+				{
+					std::shared_lock lock(mutex);
+					const auto it = cache.find(key);
+					if (it != cache.end())
+						return *it->second;
+				}
+
+				auto facet = std::make_unique<ReferenceFacet>();
+				switch (type)
+				{
+				case BoundaryType::TRI_LINE:
+					if (is_quadrature)
+					{
+						reference_quadrature_for_tri_edge(index, n, facet->uv, facet->points, facet->weights);
+						BoundarySampler::normal_for_tri_edge(index, facet->normal);
+					}
+					else
+						BoundarySampler::sample_parametric_tri_edge(index, n, facet->uv, facet->points);
+					break;
+				case BoundaryType::QUAD_LINE:
+					if (is_quadrature)
+					{
+						reference_quadrature_for_quad_edge(index, n, facet->uv, facet->points, facet->weights);
+						BoundarySampler::normal_for_quad_edge(index, facet->normal);
+					}
+					else
+						BoundarySampler::sample_parametric_quad_edge(index, n, facet->uv, facet->points);
+					break;
+				case BoundaryType::QUAD:
+					if (is_quadrature)
+					{
+						reference_quadrature_for_quad_face(index, n, facet->uv, facet->points, facet->weights);
+						BoundarySampler::normal_for_quad_face(index, facet->normal);
+					}
+					else
+						BoundarySampler::sample_parametric_quad_face(index, n, facet->uv, facet->points);
+					break;
+				case BoundaryType::TRI:
+					if (is_quadrature)
+					{
+						reference_quadrature_for_tri_face(index, n, facet->uv, facet->points, facet->weights);
+						BoundarySampler::normal_for_tri_face(index, facet->normal);
+					}
+					else
+						BoundarySampler::sample_parametric_tri_face(index, n, facet->uv, facet->points);
+					break;
+				default:
+					assert(false);
+				}
+
+				std::unique_lock lock(mutex);
+				// another thread may have built it in the meantime, keep the first one
+				return *cache.emplace(key, std::move(facet)).first->second;
+			}
+
+			/// scaling of the reference quadrature weights of a facet
+			double facet_measure(const BoundaryType type, const int gid, const Mesh &mesh)
+			{
+				switch (type)
+				{
+				case BoundaryType::TRI_LINE:
+				case BoundaryType::QUAD_LINE:
+					return mesh.edge_length(gid);
+				case BoundaryType::QUAD:
+					return mesh.quad_area(gid);
+				case BoundaryType::TRI:
+					// 2 * because weights sum to 1/2 already
+					return 2 * mesh.tri_area(gid);
+				default:
+					assert(false);
+					return 0;
+				}
+			}
 		} // namespace
 
 		Eigen::Matrix2d utils::BoundarySampler::quad_local_node_coordinates_from_edge(int le)
@@ -103,115 +307,34 @@ namespace polyfem
 
 		void utils::BoundarySampler::quadrature_for_quad_edge(int index, int order, int gid, const Mesh &mesh, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::VectorXd &weights)
 		{
-			auto endpoints = quad_local_node_coordinates_from_edge(index);
-
-			Quadrature quad;
-			LineQuadrature quad_rule;
-			quad_rule.get_quadrature(order, quad);
-
-			points.resize(quad.points.rows(), endpoints.cols());
-			uv.resize(quad.points.rows(), 2);
-
-			uv.col(0) = (1.0 - quad.points.array());
-			uv.col(1) = quad.points.array();
-
-			for (int c = 0; c < 2; ++c)
-			{
-				points.col(c) = (1.0 - quad.points.array()) * endpoints(0, c) + quad.points.array() * endpoints(1, c);
-			}
-
-			weights = quad.weights;
-			weights *= mesh.edge_length(gid);
+			const ReferenceFacet &facet = reference_facet(BoundaryType::QUAD_LINE, index, order, true);
+			uv = facet.uv;
+			points = facet.points;
+			weights = facet.weights * facet_measure(BoundaryType::QUAD_LINE, gid, mesh);
 		}
 
 		void utils::BoundarySampler::quadrature_for_tri_edge(int index, int order, int gid, const Mesh &mesh, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::VectorXd &weights)
 		{
-			auto endpoints = tri_local_node_coordinates_from_edge(index);
-
-			Quadrature quad;
-			LineQuadrature quad_rule;
-			quad_rule.get_quadrature(order, quad);
-
-			points.resize(quad.points.rows(), endpoints.cols());
-			uv.resize(quad.points.rows(), 2);
-
-			uv.col(0) = (1.0 - quad.points.array());
-			uv.col(1) = quad.points.array();
-
-			for (int c = 0; c < 2; ++c)
-			{
-				points.col(c) = (1.0 - quad.points.array()) * endpoints(0, c) + quad.points.array() * endpoints(1, c);
-			}
-
-			weights = quad.weights;
-			weights *= mesh.edge_length(gid);
+			const ReferenceFacet &facet = reference_facet(BoundaryType::TRI_LINE, index, order, true);
+			uv = facet.uv;
+			points = facet.points;
+			weights = facet.weights * facet_measure(BoundaryType::TRI_LINE, gid, mesh);
 		}
 
 		void utils::BoundarySampler::quadrature_for_quad_face(int index, int order, int gid, const Mesh &mesh, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::VectorXd &weights)
 		{
-			auto endpoints = hex_local_node_coordinates_from_face(index);
-
-			Quadrature quad;
-			QuadQuadrature quad_rule;
-			quad_rule.get_quadrature(order, quad);
-
-			const int n_pts = quad.points.rows();
-			points.resize(n_pts, endpoints.cols());
-
-			uv.resize(quad.points.rows(), 4);
-			uv.col(0) = quad.points.col(0);
-			uv.col(1) = 1 - uv.col(0).array();
-			uv.col(2) = quad.points.col(1);
-			uv.col(3) = 1 - uv.col(2).array();
-
-			for (int i = 0; i < n_pts; ++i)
-			{
-				const double b1 = quad.points(i, 0);
-				const double b2 = 1 - b1;
-
-				const double b3 = quad.points(i, 1);
-				const double b4 = 1 - b3;
-
-				for (int c = 0; c < 3; ++c)
-				{
-					points(i, c) = b3 * (b1 * endpoints(0, c) + b2 * endpoints(1, c)) + b4 * (b1 * endpoints(3, c) + b2 * endpoints(2, c));
-				}
-			}
-
-			weights = quad.weights;
-			weights *= mesh.quad_area(gid);
+			const ReferenceFacet &facet = reference_facet(BoundaryType::QUAD, index, order, true);
+			uv = facet.uv;
+			points = facet.points;
+			weights = facet.weights * facet_measure(BoundaryType::QUAD, gid, mesh);
 		}
 
 		void utils::BoundarySampler::quadrature_for_tri_face(int index, int order, int gid, const Mesh &mesh, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::VectorXd &weights)
 		{
-			auto endpoints = tet_local_node_coordinates_from_face(index);
-			Quadrature quad;
-			TriQuadrature quad_rule;
-			quad_rule.get_quadrature(order, quad);
-
-			const int n_pts = quad.points.rows();
-			points.resize(n_pts, endpoints.cols());
-
-			uv.resize(quad.points.rows(), 3);
-			uv.col(0) = quad.points.col(0);
-			uv.col(1) = quad.points.col(1);
-			uv.col(2) = 1 - uv.col(0).array() - uv.col(1).array();
-
-			for (int i = 0; i < n_pts; ++i)
-			{
-				const double b1 = quad.points(i, 0);
-				const double b3 = quad.points(i, 1);
-				const double b2 = 1 - b1 - b3;
-
-				for (int c = 0; c < 3; ++c)
-				{
-					points(i, c) = b1 * endpoints(0, c) + b2 * endpoints(1, c) + b3 * endpoints(2, c);
-				}
-			}
-
-			weights = quad.weights;
-			// 2 * because weights sum to 1/2 already
-			weights *= 2 * mesh.tri_area(gid);
+			const ReferenceFacet &facet = reference_facet(BoundaryType::TRI, index, order, true);
+			uv = facet.uv;
+			points = facet.points;
+			weights = facet.weights * facet_measure(BoundaryType::TRI, gid, mesh);
 		}
 
 		void utils::BoundarySampler::sample_parametric_quad_edge(int index, int n_samples, Eigen::MatrixXd &uv, Eigen::MatrixXd &samples)
@@ -462,61 +585,31 @@ namespace polyfem
 
 		bool utils::BoundarySampler::boundary_quadrature(const LocalBoundary &local_boundary, const int order, const Mesh &mesh, const bool skip_computation, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::MatrixXd &normals, Eigen::VectorXd &weights, Eigen::VectorXi &global_primitive_ids)
 		{
-			uv.resize(0, 0);
-			points.resize(0, 0);
-			normals.resize(0, 0);
-			weights.resize(0);
-			global_primitive_ids.resize(0);
-
+			std::vector<Eigen::MatrixXd> facet_uv(local_boundary.size()), facet_points(local_boundary.size()), facet_normals(local_boundary.size());
+			std::vector<Eigen::VectorXd> facet_weights(local_boundary.size());
+			long n_points = 0;
 			for (int i = 0; i < local_boundary.size(); ++i)
 			{
-				const int gid = local_boundary.global_primitive_id(i);
-				Eigen::MatrixXd tmp_p, tmp_uv, tmp_n;
-				Eigen::VectorXd tmp_w;
-				switch (local_boundary.type())
-				{
-				case BoundaryType::TRI_LINE:
-					quadrature_for_tri_edge(local_boundary[i], order, gid, mesh, tmp_uv, tmp_p, tmp_w);
-					normal_for_tri_edge(local_boundary[i], tmp_n);
-					break;
-				case BoundaryType::QUAD_LINE:
-					quadrature_for_quad_edge(local_boundary[i], order, gid, mesh, tmp_uv, tmp_p, tmp_w);
-					normal_for_quad_edge(local_boundary[i], tmp_n);
-					break;
-				case BoundaryType::QUAD:
-					quadrature_for_quad_face(local_boundary[i], order, gid, mesh, tmp_uv, tmp_p, tmp_w);
-					normal_for_quad_face(local_boundary[i], tmp_n);
-					break;
-				case BoundaryType::TRI:
-					quadrature_for_tri_face(local_boundary[i], order, gid, mesh, tmp_uv, tmp_p, tmp_w);
-					normal_for_tri_face(local_boundary[i], tmp_n);
-					break;
-				case BoundaryType::POLYGON:
-					quadrature_for_polygon_edge(local_boundary.element_id(), local_boundary.global_primitive_id(i), order, mesh, tmp_uv, tmp_p, tmp_w);
-					normal_for_polygon_edge(local_boundary.element_id(), local_boundary.global_primitive_id(i), mesh, tmp_n);
-					break;
-				case BoundaryType::INVALID:
-					assert(false);
-					break;
-				default:
-					assert(false);
-				}
-
-				uv.conservativeResize(uv.rows() + tmp_uv.rows(), tmp_uv.cols());
-				uv.bottomRows(tmp_uv.rows()) = tmp_uv;
-
-				points.conservativeResize(points.rows() + tmp_p.rows(), tmp_p.cols());
-				points.bottomRows(tmp_p.rows()) = tmp_p;
-
-				normals.conservativeResize(normals.rows() + tmp_p.rows(), tmp_p.cols());
-				for (int k = normals.rows() - tmp_p.rows(); k < normals.rows(); ++k)
-					normals.row(k) = tmp_n;
+				boundary_quadrature(local_boundary, order, mesh, i, skip_computation, facet_uv[i], facet_points[i], facet_normals[i], facet_weights[i]);
+				n_points += facet_points[i].rows();
+			}
 
-				weights.conservativeResize(weights.rows() + tmp_w.rows(), tmp_w.cols());
-				weights.bottomRows(tmp_w.rows()) = tmp_w;
+			uv.resize(n_points, local_boundary.size() > 0 ? facet_uv[0].cols() : 0);
+			points.resize(n_points, local_boundary.size() > 0 ? facet_points[0].cols() : 0);
+			normals.resize(n_points, points.cols());
+			weights.resize(n_points);
+			global_primitive_ids.resize(n_points);
 
-				global_primitive_ids.conservativeResize(global_primitive_ids.rows() + tmp_p.rows());
-				global_primitive_ids.bottomRows(tmp_p.rows()).setConstant(gid);
+			long offset = 0;
+			for (int i = 0; i < local_boundary.size(); ++i)
+			{
+				const long n = facet_points[i].rows();
+				uv.middleRows(offset, n) = facet_uv[i];
+				points.middleRows(offset, n) = facet_points[i];
+				normals.middleRows(offset, n) = facet_normals[i];
+				weights.segment(offset, n) = facet_weights[i];
+				global_primitive_ids.segment(offset, n).setConstant(local_boundary.global_primitive_id(i));
+				offset += n;
 			}
 
 			assert(uv.rows() == global_primitive_ids.size());
@@ -529,29 +622,24 @@ namespace polyfem
 
 		bool utils::BoundarySampler::sample_boundary(const LocalBoundary &local_boundary, const int n_samples, const Mesh &mesh, const bool skip_computation, Eigen::MatrixXd &uv, Eigen::MatrixXd &samples, Eigen::VectorXi &global_primitive_ids)
 		{
-			uv.resize(0, 0);
-			samples.resize(0, 0);
-			global_primitive_ids.resize(0);
-
+			std::vector<Eigen::MatrixXd> facet_uv(local_boundary.size()), facet_samples(local_boundary.size());
+			long n_points = 0;
 			for (int i = 0; i < local_boundary.size(); ++i)
 			{
-				Eigen::MatrixXd tmp, tmp_uv;
 				switch (local_boundary.type())
 				{
 				case BoundaryType::TRI_LINE:
-					sample_parametric_tri_edge(local_boundary[i], n_samples, tmp_uv, tmp);
-					break;
 				case BoundaryType::QUAD_LINE:
-					sample_parametric_quad_edge(local_boundary[i], n_samples, tmp_uv, tmp);
-					break;
 				case BoundaryType::QUAD:
-					sample_parametric_quad_face(local_boundary[i], n_samples, tmp_uv, tmp);
-					break;
 				case BoundaryType::TRI:
-					sample_parametric_tri_face(local_boundary[i], n_samples, tmp_uv, tmp);
+				{
+					const ReferenceFacet &facet = reference_facet(local_boundary.type(), local_boundary[i], n_samples, false);
+					facet_uv[i] = facet.uv;
+					facet_samples[i] = facet.points;
 					break;
+				}
 				case BoundaryType::POLYGON:
-					sample_polygon_edge(local_boundary.element_id(), local_boundary.global_primitive_id(i), n_samples, mesh, tmp_uv, tmp);
+					sample_polygon_edge(local_boundary.element_id(), local_boundary.global_primitive_id(i), n_samples, mesh, facet_uv[i], facet_samples[i]);
 					break;
 				case BoundaryType::INVALID:
 					assert(false);
@@ -559,15 +647,21 @@ namespace polyfem
 				default:
 					assert(false);
 				}
+				n_points += facet_samples[i].rows();
+			}
 
-				uv.conservativeResize(uv.rows() + tmp_uv.rows(), tmp_uv.cols());
-				uv.bottomRows(tmp_uv.rows()) = tmp_uv;
-
-				samples.conservativeResize(samples.rows() + tmp.rows(), tmp.cols());
-				samples.bottomRows(tmp.rows()) = tmp;
+			uv.resize(n_points, local_boundary.size() > 0 ? facet_uv[0].cols() : 0);
+			samples.resize(n_points, local_boundary.size() > 0 ? facet_samples[0].cols() : 0);
+			global_primitive_ids.resize(n_points);
 
-				global_primitive_ids.conservativeResize(global_primitive_ids.rows() + tmp.rows());
-				global_primitive_ids.bottomRows(tmp.rows()).setConstant(local_boundary.global_primitive_id(i));
+			long offset = 0;
+			for (int i = 0; i < local_boundary.size(); ++i)
+			{
+				const long n = facet_samples[i].rows();
+				uv.middleRows(offset, n) = facet_uv[i];
+				samples.middleRows(offset, n) = facet_samples[i];
+				global_primitive_ids.segment(offset, n).setConstant(local_boundary.global_primitive_id(i));
+				offset += n;
 			}
 
 			assert(uv.rows() == global_primitive_ids.size());
@@ -580,30 +674,23 @@ namespace polyfem
 		{
 			assert(local_boundary.size() > i);
 
-			uv.resize(0, 0);
-			points.resize(0, 0);
-			weights.resize(0);
 			const int gid = local_boundary.global_primitive_id(i);
 
 			Eigen::MatrixXd normal;
 			switch (local_boundary.type())
 			{
 			case BoundaryType::TRI_LINE:
-				quadrature_for_tri_edge(local_boundary[i], order, gid, mesh, uv, points, weights);
-				normal_for_tri_edge(local_boundary[i], normal);
-				break;
 			case BoundaryType::QUAD_LINE:
-				quadrature_for_quad_edge(local_boundary[i], order, gid, mesh, uv, points, weights);
-				normal_for_quad_edge(local_boundary[i], normal);
-				break;
 			case BoundaryType::QUAD:
-				quadrature_for_quad_face(local_boundary[i], order, gid, mesh, uv, points, weights);
-				normal_for_quad_face(local_boundary[i], normal);
-				break;
 			case BoundaryType::TRI:
-				quadrature_for_tri_face(local_boundary[i], order, gid, mesh, uv, points, weights);
-				normal_for_tri_face(local_boundary[i], normal);
-				break;
+			{
+				const ReferenceFacet &facet = reference_facet(local_boundary.type(), local_boundary[i], order, true);
+				uv = facet.uv;
+				points = facet.points;
+				weights = facet.weights * facet_measure(local_boundary.type(), gid, mesh);
+				normals = facet.normal.replicate(points.rows(), 1);
+				return true;
+			}
 			case BoundaryType::POLYGON:
 				quadrature_for_polygon_edge(local_boundary.element_id(), gid, order, mesh, uv, points, weights);
 				normal_for_polygon_edge(local_boundary.element_id(), gid, mesh, normal);
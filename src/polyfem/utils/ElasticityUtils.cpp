@@ -3,6 +3,9 @@
 
 #include <tinyexpr.h>
 
+#include <atomic>
+#include <limits>
+
 namespace polyfem
 {
 	using namespace assembler;
@@ -161,12 +164,11 @@ namespace polyfem
 			}
 			else
 			{
-				static bool show_message = true;
+				static std::atomic<bool> show_message = true;
 
-				if (show_message)
+				if (show_message.exchange(false))
 				{
 					logger().debug("[Warning] grad {}^{} not using static sizes", n_bases, size);
-					show_message = false;
 				}
 
 				auto auto_diff_energy = funn(data);
@@ -254,12 +256,11 @@ namespace polyfem
 			}
 			else
 			{
-				static bool show_message = true;
+				static std::atomic<bool> show_message = true;
 
-				if (show_message)
+				if (show_message.exchange(false))
 				{
 					logger().debug("[Warning] hessian {}*{} not using static sizes", n_bases, size);
-					show_message = false;
 				}
 
 				auto auto_diff_energy = funn(data);
@@ -346,6 +347,164 @@ namespace polyfem
 		return von_mises_stress;
 	}
 
+	void batch_determinant_inverse_transpose(const int dim, const Eigen::ArrayXXd &F, Eigen::ArrayXd &J, Eigen::ArrayXXd &FmT)
+	{
+		assert(F.cols() == dim * dim);
+		FmT.resize(F.rows(), F.cols());
+
+		if (dim == 2)
+		{
+			J = F.col(0) * F.col(3) - F.col(1) * F.col(2);
+			FmT.col(0) = F.col(3) / J;
+			FmT.col(1) = -F.col(2) / J;
+			FmT.col(2) = -F.col(1) / J;
+			FmT.col(3) = F.col(0) / J;
+		}
+		else
+		{
+			assert(dim == 3);
+			// cofactor matrix, F⁻ᵀ = cof(F) / J
+			for (int i = 0; i < 3; ++i)
+			{
+				const int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+				for (int j = 0; j < 3; ++j)
+				{
+					const int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+					FmT.col(i * 3 + j) = F.col(i1 * 3 + j1) * F.col(i2 * 3 + j2) - F.col(i1 * 3 + j2) * F.col(i2 * 3 + j1);
+				}
+			}
+
+			J = F.col(0) * FmT.col(0) + F.col(1) * FmT.col(1) + F.col(2) * FmT.col(2);
+			for (int k = 0; k < 9; ++k)
+				FmT.col(k) /= J;
+		}
+	}
+
+	void batch_svd(const int dim, const Eigen::ArrayXXd &F, Eigen::ArrayXXd &U, Eigen::ArrayXXd &sigma, Eigen::ArrayXXd &V)
+	{
+		assert(F.cols() == dim * dim);
+		const Eigen::Index n = F.rows();
+		const auto id = [dim](const int i, const int j) { return i * dim + j; };
+		// upper triangle of a symmetric matrix
+		const auto sym = [dim](const int i, const int j) { return i <= j ? i * dim + j : j * dim + i; };
+
+		constexpr int max_jacobi_sweeps = 10;
+		const double eps = std::numeric_limits<double>::epsilon();
+
+		// S = FᵀF
+		Eigen::ArrayXXd S = Eigen::ArrayXXd::Zero(n, dim * dim);
+		for (int i = 0; i < dim; ++i)
+			for (int j = i; j < dim; ++j)
+				for (int k = 0; k < dim; ++k)
+					S.col(id(i, j)) += F.col(id(k, i)) * F.col(id(k, j));
+
+		V.setZero(n, dim * dim);
+		for (int i = 0; i < dim; ++i)
+			V.col(id(i, i)).setOnes();
+
+		// cyclic Jacobi, S ← Jᵀ S J and V ← V J with the rotations J of all the points at once
+		Eigen::ArrayXd t, c, s;
+		for (int sweep = 0; sweep < max_jacobi_sweeps; ++sweep)
+		{
+			Eigen::ArrayXd off = Eigen::ArrayXd::Zero(n), diag = Eigen::ArrayXd::Zero(n);
+			for (int i = 0; i < dim; ++i)
+			{
+				diag += S.col(id(i, i)).square();
+				for (int j = i + 1; j < dim; ++j)
+					off += S.col(id(i, j)).square();
+			}
+			if ((off <= eps * eps * diag).all())
+				break;
+
+			for (int p = 0; p < dim; ++p)
+			{
+				for (int q = p + 1; q < dim; ++q)
+				{
+					const Eigen::ArrayXd apq = S.col(id(p, q));
+					const Eigen::ArrayXd theta = (apq != 0).select((S.col(id(q, q)) - S.col(id(p, p))) / (2 * apq), 0);
+					t = (apq != 0).select((2 * (theta >= 0).cast<double>() - 1) / (theta.abs() + (theta.square() + 1).sqrt()), 0);
+					c = 1 / (t.square() + 1).sqrt();
+					s = t * c;
+
+					S.col(id(p, p)) -= t * apq;
+					S.col(id(q, q)) += t * apq;
+					S.col(id(p, q)).setZero();
+					for (int r = 0; r < dim; ++r)
+					{
+						if (r == p || r == q)
+							continue;
+						const Eigen::ArrayXd srp = S.col(sym(r, p)), srq = S.col(sym(r, q));
+						S.col(sym(r, p)) = c * srp - s * srq;
+						S.col(sym(r, q)) = s * srp + c * srq;
+					}
+					for (int k = 0; k < dim; ++k)
+					{
+						const Eigen::ArrayXd vkp = V.col(id(k, p)), vkq = V.col(id(k, q));
+						V.col(id(k, p)) = c * vkp - s * vkq;
+						V.col(id(k, q)) = s * vkp + c * vkq;
+					}
+				}
+			}
+		}
+
+		// sort the eigenvalues of FᵀF in decreasing order, negating the swapped column to keep V a rotation
+		const auto sort_pair = [&](const int a, const int b) {
+			const Eigen::Array<bool, Eigen::Dynamic, 1> swap = S.col(id(a, a)) < S.col(id(b, b));
+			const Eigen::ArrayXd la = S.col(id(a, a));
+			S.col(id(a, a)) = swap.select(S.col(id(b, b)), la);
+			S.col(id(b, b)) = swap.select(la, S.col(id(b, b)));
+			for (int k = 0; k < dim; ++k)
+			{
+				const Eigen::ArrayXd vka = V.col(id(k, a));
+				V.col(id(k, a)) = swap.select(V.col(id(k, b)), vka);
+				V.col(id(k, b)) = swap.select(-vka, V.col(id(k, b)));
+			}
+		};
+		sort_pair(0, 1);
+		if (dim == 3)
+		{
+			sort_pair(1, 2);
+			sort_pair(0, 1);
+		}
+
+		// B = F V, the columns of B are orthogonal
+		Eigen::ArrayXXd B = Eigen::ArrayXXd::Zero(n, dim * dim);
+		for (int i = 0; i < dim; ++i)
+			for (int j = 0; j < dim; ++j)
+				for (int k = 0; k < dim; ++k)
+					B.col(id(i, j)) += F.col(id(i, k)) * V.col(id(k, j));
+
+		// Givens QR of B, U accumulates the rotations and R is diagonal
+		U.setZero(n, dim * dim);
+		for (int i = 0; i < dim; ++i)
+			U.col(id(i, i)).setOnes();
+
+		for (int i = 0; i < dim; ++i)
+		{
+			for (int j = i + 1; j < dim; ++j)
+			{
+				const Eigen::ArrayXd r = (B.col(id(i, i)).square() + B.col(id(j, i)).square()).sqrt();
+				c = (r > 0).select(B.col(id(i, i)) / r, 1);
+				s = (r > 0).select(B.col(id(j, i)) / r, 0);
+
+				for (int k = 0; k < dim; ++k)
+				{
+					const Eigen::ArrayXd bik = B.col(id(i, k)), bjk = B.col(id(j, k));
+					B.col(id(i, k)) = c * bik + s * bjk;
+					B.col(id(j, k)) = c * bjk - s * bik;
+
+					const Eigen::ArrayXd uki = U.col(id(k, i)), ukj = U.col(id(k, j));
+					U.col(id(k, i)) = c * uki + s * ukj;
+					U.col(id(k, j)) = c * ukj - s * uki;
+				}
+			}
+		}
+
+		sigma.resize(n, dim);
+		for (int i = 0; i < dim; ++i)
+			sigma.col(i) = B.col(id(i, i));
+	}
+
 	Eigen::MatrixXd pk1_from_cauchy(const Eigen::MatrixXd &stress, const Eigen::MatrixXd &F)
 	{
 		return F.determinant() * stress * F.inverse().transpose();
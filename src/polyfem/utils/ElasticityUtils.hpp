@@ -12,6 +12,7 @@
 #include <vector>
 #include <array>
 #include <functional>
+#include <type_traits>
 
 namespace polyfem
 {
@@ -58,6 +59,16 @@ namespace polyfem
 	void compute_diplacement_grad(const int size, const assembler::ElementAssemblyValues &vals, const Eigen::MatrixXd &local_pts, const int p, const Eigen::MatrixXd &displacement, Eigen::MatrixXd &displacement_grad);
 	void compute_diplacement_grad(const int size, const basis::ElementBases &bs, const assembler::ElementAssemblyValues &vals, const Eigen::MatrixXd &local_pts, const int p, const Eigen::MatrixXd &displacement, Eigen::MatrixXd &displacement_grad);
 
+	/// determinant and inverse transpose of a batch of deformation gradients in structure-of-arrays layout
+	/// (one point per row, column i * dim + j stores F(i, j)), FmT uses the same layout
+	void batch_determinant_inverse_transpose(const int dim, const Eigen::ArrayXXd &F, Eigen::ArrayXd &J, Eigen::ArrayXXd &FmT);
+
+	/// rotation variant SVD F = U diag(sigma) Vᵀ of a batch of deformation gradients in the same layout, U and V are
+	/// rotations and only the last singular value can be negative (as utils::AutoFlipSVD). Cyclic Jacobi on FᵀF and
+	/// Givens QR of F V, without per-point branches so that it vectorizes across the points of the batch
+	/// @param[out] sigma #points x dim, sorted in decreasing order
+	void batch_svd(const int dim, const Eigen::ArrayXXd &F, Eigen::ArrayXXd &U, Eigen::ArrayXXd &sigma, Eigen::ArrayXXd &V);
+
 	double convert_to_lambda(const bool is_volume, const double E, const double nu);
 	double convert_to_mu(const double E, const double nu);
 	Eigen::Matrix2d d_lambda_mu_d_E_nu(const bool is_volume, const double E, const double nu);
@@ -135,6 +146,55 @@ namespace polyfem
 		def_grad = def_grad * jac_it;
 	}
 
+	/// Calls fun(n_basis, dim), both std::integral_constant, so that element kernels are instantiated with
+	/// fixed-size stack-allocated matrices for the common Lagrange elements (P1-P3 simplices, Q1-Q2 cubes).
+	/// Other elements (e.g., polygonal or spline) get n_basis = Eigen::Dynamic.
+	template <typename Fun>
+	void dispatch_element_kernel(const int dim, const int n_basis, Fun &&fun)
+	{
+		using D2 = std::integral_constant<int, 2>;
+		using D3 = std::integral_constant<int, 3>;
+		using Dynamic = std::integral_constant<int, Eigen::Dynamic>;
+
+		if (dim == 2)
+		{
+			switch (n_basis)
+			{
+			case 3: // P1
+				return fun(std::integral_constant<int, 3>(), D2());
+			case 4: // Q1
+				return fun(std::integral_constant<int, 4>(), D2());
+			case 6: // P2
+				return fun(std::integral_constant<int, 6>(), D2());
+			case 9: // Q2
+				return fun(std::integral_constant<int, 9>(), D2());
+			case 10: // P3
+				return fun(std::integral_constant<int, 10>(), D2());
+			default:
+				return fun(Dynamic(), D2());
+			}
+		}
+		else
+		{
+			assert(dim == 3);
+			switch (n_basis)
+			{
+			case 4: // P1
+				return fun(std::integral_constant<int, 4>(), D3());
+			case 8: // Q1
+				return fun(std::integral_constant<int, 8>(), D3());
+			case 10: // P2
+				return fun(std::integral_constant<int, 10>(), D3());
+			case 20: // P3
+				return fun(std::integral_constant<int, 20>(), D3());
+			case 27: // Q2
+				return fun(std::integral_constant<int, 27>(), D3());
+			default:
+				return fun(Dynamic(), D3());
+			}
+		}
+	}
+
 	// https://en.wikipedia.org/wiki/Invariants_of_tensors
 	template <typename AutoDiffGradMat>
 	typename AutoDiffGradMat::Scalar first_invariant(const AutoDiffGradMat &B)
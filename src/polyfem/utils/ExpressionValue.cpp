@@ -10,6 +10,8 @@
 #include <tinyexpr.h>
 #include <filesystem>
 
+#include <algorithm>
+#include <array>
 #include <iostream>
 
 namespace polyfem
@@ -60,6 +62,239 @@ namespace polyfem
 			return a < b ? 1.0 : 0.0;
 		}
 
+		namespace
+		{
+			std::vector<te_variable> expression_variables(double &x, double &y, double &z, double &t)
+			{
+				return {
+					{"x", &x, TE_VARIABLE},
+					{"y", &y, TE_VARIABLE},
+					{"z", &z, TE_VARIABLE},
+					{"t", &t, TE_VARIABLE},
+					{"min", (const void *)min, TE_FUNCTION2},
+					{"max", (const void *)max, TE_FUNCTION2},
+					{"smoothstep", (const void *)smoothstep, TE_FUNCTION1},
+					{"half_smoothstep", (const void *)half_smoothstep, TE_FUNCTION1},
+					{"deg2rad", (const void *)deg2rad, TE_FUNCTION1},
+					{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3},
+					{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3},
+					{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3},
+					{"compare", (const void *)compare, TE_FUNCTION2},
+					{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2},
+					{"sign", (const void *)sign, TE_FUNCTION1},
+				};
+			}
+		} // namespace
+
+		class ExpressionValue::Program
+		{
+		public:
+			/// @param expr tree compiled by tinyexpr, constant subtrees are already folded
+			/// @param variables addresses x, y, z, t were bound to
+			Program(const te_expr *expr, const std::array<const double *, 4> &variables)
+			{
+				int depth = 0;
+				append(expr, variables, depth);
+				assert(depth == 1);
+			}
+
+			/// true if the expression reads x, y, or z
+			bool depends_on_space() const { return depends_on_space_; }
+			/// true if the expression reads t
+			bool depends_on_time() const { return depends_on_time_; }
+
+			double eval(const double x, const double y, const double z, const double t) const
+			{
+				const std::array<double, 4> vars = {{x, y, z, t}};
+
+				std::array<double, 16> local;
+				std::vector<double> heap;
+				double *stack = local.data();
+				if (stack_size_ > int(local.size()))
+				{
+					heap.resize(stack_size_);
+					stack = heap.data();
+				}
+
+				int top = 0;
+				for (const Instruction &ins : code_)
+				{
+					if (ins.arity == CONSTANT)
+						stack[top++] = ins.value;
+					else if (ins.arity == VARIABLE)
+						stack[top++] = vars[ins.variable];
+					else
+					{
+						top -= ins.arity;
+						stack[top] = call(ins, stack + top);
+						++top;
+					}
+				}
+				assert(top == 1);
+
+				return stack[0];
+			}
+
+			void eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &result) const
+			{
+				const Eigen::Index n = pts.rows();
+				std::vector<Eigen::ArrayXd> stack(stack_size_);
+				std::array<double, 7> args;
+
+				int top = 0;
+				for (const Instruction &ins : code_)
+				{
+					if (ins.arity == CONSTANT)
+						stack[top++].setConstant(n, ins.value);
+					else if (ins.arity == VARIABLE)
+					{
+						if (ins.variable == 3)
+							stack[top].setConstant(n, t);
+						else if (ins.variable < pts.cols())
+							stack[top] = pts.col(ins.variable).array();
+						else
+							stack[top].setZero(n);
+						++top;
+					}
+					else
+					{
+						top -= ins.arity;
+						// the result overwrites the first argument, which is read before being written
+						Eigen::ArrayXd &out = stack[top];
+						out.resize(n);
+						for (Eigen::Index i = 0; i < n; ++i)
+						{
+							for (int a = 0; a < ins.arity; ++a)
+								args[a] = stack[top + a](i);
+							out(i) = call(ins, args.data());
+						}
+						++top;
+					}
+				}
+				assert(top == 1);
+
+				result = stack[0].matrix();
+			}
+
+		private:
+			static constexpr int CONSTANT = -1;
+			static constexpr int VARIABLE = -2;
+			// type of a constant node, private to tinyexpr.c
+			static constexpr int TE_CONSTANT_TYPE = 1;
+
+			struct Instruction
+			{
+				/// number of arguments of the function, or CONSTANT, or VARIABLE
+				int arity;
+				double value = 0;
+				/// index of x, y, z, t
+				int variable = -1;
+				const void *function = nullptr;
+				/// non null for closures
+				void *context = nullptr;
+			};
+
+			static double call(const Instruction &ins, const double *a)
+			{
+				using f0 = double (*)();
+				using f1 = double (*)(double);
+				using f2 = double (*)(double, double);
+				using f3 = double (*)(double, double, double);
+				using f4 = double (*)(double, double, double, double);
+				using f5 = double (*)(double, double, double, double, double);
+				using f6 = double (*)(double, double, double, double, double, double);
+				using f7 = double (*)(double, double, double, double, double, double, double);
+
+				using c0 = double (*)(void *);
+				using c1 = double (*)(void *, double);
+				using c2 = double (*)(void *, double, double);
+				using c3 = double (*)(void *, double, double, double);
+				using c4 = double (*)(void *, double, double, double, double);
+				using c5 = double (*)(void *, double, double, double, double, double);
+				using c6 = double (*)(void *, double, double, double, double, double, double);
+				using c7 = double (*)(void *, double, double, double, double, double, double, double);
+
+				if (ins.context)
+				{
+					void *c = ins.context;
+					switch (ins.arity)
+					{
+					case 0: return ((c0)ins.function)(c);
+					case 1: return ((c1)ins.function)(c, a[0]);
+					case 2: return ((c2)ins.function)(c, a[0], a[1]);
+					case 3: return ((c3)ins.function)(c, a[0], a[1], a[2]);
+					case 4: return ((c4)ins.function)(c, a[0], a[1], a[2], a[3]);
+					case 5: return ((c5)ins.function)(c, a[0], a[1], a[2], a[3], a[4]);
+					case 6: return ((c6)ins.function)(c, a[0], a[1], a[2], a[3], a[4], a[5]);
+					case 7: return ((c7)ins.function)(c, a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+					}
+				}
+				else
+				{
+					switch (ins.arity)
+					{
+					case 0: return ((f0)ins.function)();
+					case 1: return ((f1)ins.function)(a[0]);
+					case 2: return ((f2)ins.function)(a[0], a[1]);
+					case 3: return ((f3)ins.function)(a[0], a[1], a[2]);
+					case 4: return ((f4)ins.function)(a[0], a[1], a[2], a[3]);
+					case 5: return ((f5)ins.function)(a[0], a[1], a[2], a[3], a[4]);
+					case 6: return ((f6)ins.function)(a[0], a[1], a[2], a[3], a[4], a[5]);
+					case 7: return ((f7)ins.function)(a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+					}
+				}
+
+				assert(false);
+				return std::nan("");
+			}
+
+			void append(const te_expr *expr, const std::array<const double *, 4> &variables, int &depth)
+			{
+				const int type = expr->type & 0x1F;
+				Instruction ins;
+
+				if (type == TE_VARIABLE)
+				{
+					const auto it = std::find(variables.begin(), variables.end(), expr->bound);
+					if (it == variables.end())
+						log_and_throw_error("Unknown variable in expression");
+
+					ins.arity = VARIABLE;
+					ins.variable = it - variables.begin();
+					depends_on_space_ |= ins.variable < 3;
+					depends_on_time_ |= ins.variable == 3;
+					++depth;
+				}
+				else if (type == TE_CONSTANT_TYPE)
+				{
+					ins.arity = CONSTANT;
+					ins.value = expr->value;
+					++depth;
+				}
+				else if ((type >= TE_FUNCTION0 && type <= TE_FUNCTION7) || (type >= TE_CLOSURE0 && type <= TE_CLOSURE7))
+				{
+					ins.arity = type & 7;
+					ins.function = expr->function;
+					if (type >= TE_CLOSURE0)
+						ins.context = expr->parameters[ins.arity];
+
+					for (int i = 0; i < ins.arity; ++i)
+						append((const te_expr *)expr->parameters[i], variables, depth);
+					depth -= ins.arity - 1;
+				}
+				else
+					log_and_throw_error("Unsupported expression node {}", type);
+
+				stack_size_ = std::max(stack_size_, depth);
+				code_.push_back(ins);
+			}
+
+			std::vector<Instruction> code_;
+			int stack_size_ = 0;
+			bool depends_on_space_ = false;
+			bool depends_on_time_ = false;
+		};
+
 		ExpressionValue::ExpressionValue()
 		{
 			clear();
@@ -68,6 +303,7 @@ namespace polyfem
 		void ExpressionValue::clear()
 		{
 			expr_ = "";
+			program_ = nullptr;
 			mat_.resize(0, 0);
 			mat_expr_ = {};
 			sfunc_ = nullptr;
@@ -116,24 +352,7 @@ namespace polyfem
 			expr_ = expr;
 
 			double x = 0, y = 0, z = 0, t = 0;
-
-			std::vector<te_variable> vars = {
-				{"x", &x, TE_VARIABLE},
-				{"y", &y, TE_VARIABLE},
-				{"z", &z, TE_VARIABLE},
-				{"t", &t, TE_VARIABLE},
-				{"min", (const void *)min, TE_FUNCTION2},
-				{"max", (const void *)max, TE_FUNCTION2},
-				{"smoothstep", (const void *)smoothstep, TE_FUNCTION1},
-				{"half_smoothstep", (const void *)half_smoothstep, TE_FUNCTION1},
-				{"deg2rad", (const void *)deg2rad, TE_FUNCTION1},
-				{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3},
-				{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3},
-				{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3},
-				{"compare", (const void *)compare, TE_FUNCTION2},
-				{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2},
-				{"sign", (const void *)sign, TE_FUNCTION1},
-			};
+			const std::vector<te_variable> vars = expression_variables(x, y, z, t);
 
 			int err;
 			te_expr *tmp = te_compile(expr.c_str(), vars.data(), vars.size(), &err);
@@ -142,7 +361,9 @@ namespace polyfem
 				logger().error("Unable to parse: {}", expr);
 				logger().error("Error near here: {0: >{1}}", "^", err - 1);
 				assert(false);
+				return;
 			}
+			program_ = std::make_shared<const Program>(tmp, std::array<const double *, 4>{{&x, &y, &z, &t}});
 			te_free(tmp);
 		}
 
@@ -241,6 +462,31 @@ namespace polyfem
 			}
 		}
 
+		bool ExpressionValue::is_constant() const
+		{
+			if (!t_index_.empty() || mat_.size() > 0 || !mat_expr_.empty() || sfunc_ || tfunc_)
+				return false;
+
+			if (expr_.empty())
+				return true;
+
+			return program_ && !program_->depends_on_space() && !program_->depends_on_time();
+		}
+
+		bool ExpressionValue::depends_on_time() const
+		{
+			if (!t_index_.empty() || sfunc_ || tfunc_)
+				return true;
+
+			for (const ExpressionValue &e : mat_expr_)
+			{
+				if (e.depends_on_time())
+					return true;
+			}
+
+			return program_ && program_->depends_on_time();
+		}
+
 		double ExpressionValue::operator()(double x, double y, double z, double t, int index) const
 		{
 			assert(unit_type_set_);
@@ -276,32 +522,40 @@ namespace polyfem
 			}
 			else
 			{
+				assert(program_ != nullptr);
+				result = program_->eval(x, y, z, t);
+			}
 
-				std::vector<te_variable> vars = {
-					{"x", &x, TE_VARIABLE},
-					{"y", &y, TE_VARIABLE},
-					{"z", &z, TE_VARIABLE},
-					{"t", &t, TE_VARIABLE},
-					{"min", (const void *)min, TE_FUNCTION2},
-					{"max", (const void *)max, TE_FUNCTION2},
-					{"smoothstep", (const void *)smoothstep, TE_FUNCTION1},
-					{"half_smoothstep", (const void *)half_smoothstep, TE_FUNCTION1},
-					{"deg2rad", (const void *)deg2rad, TE_FUNCTION1},
-					{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3},
-					{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3},
-					{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3},
-					{"compare", (const void *)compare, TE_FUNCTION2},
-					{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2},
-					{"sign", (const void *)sign, TE_FUNCTION1},
-				};
+			return convert_unit(result);
+		}
+
+		void ExpressionValue::operator()(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &result) const
+		{
+			assert(unit_type_set_);
+
+			if (expr_.empty() || !program_)
+			{
+				result.resize(pts.rows());
+				for (Eigen::Index i = 0; i < pts.rows(); ++i)
+					result(i) = (*this)(pts(i, 0), pts(i, 1), pts.cols() > 2 ? pts(i, 2) : 0, t);
+				return;
+			}
+
+			if (program_->depends_on_space())
+				program_->eval(pts, t, result);
+			else
+				result.setConstant(pts.rows(), program_->eval(0, 0, 0, t));
 
-				int err;
-				te_expr *tmp = te_compile(expr_.c_str(), vars.data(), vars.size(), &err);
-				assert(tmp != nullptr);
-				result = te_eval(tmp);
-				te_free(tmp);
+			if (!unit_.base_units().empty())
+			{
+				for (Eigen::Index i = 0; i < result.size(); ++i)
+					result(i) = convert_unit(result(i));
 			}
+		}
 
+		double ExpressionValue::convert_unit(const double value) const
+		{
+			double result = value;
 			if (!unit_.base_units().empty())
 			{
 				if (!unit_.is_convertible(unit_type_))
@@ -2,6 +2,7 @@
 
 #include <polyfem/Common.hpp>
 #include <map>
+#include <memory>
 
 #include <units/units.hpp>
 
@@ -36,9 +37,23 @@ namespace polyfem
 
 			double operator()(double x, double y, double z = 0, double t = 0, int index = -1) const;
 
+			/// @brief Evaluate at a batch of points, the expression is only evaluated once if it does not depend on x, y, z.
+			/// @param[in] pts points, one per row, z is zero if there are two columns
+			/// @param[in] t time
+			/// @param[out] result value at every point
+			void operator()(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &result) const;
+
 			void clear();
 
 			bool is_zero() const { return expr_.empty() && fabs(value_) < 1e-10; }
+			/// true if the value does not depend on space, time, or the index
+			bool is_constant() const;
+			/// true if the value might change in time, user functions are assumed to
+			bool depends_on_time() const;
+			/// true if the value is a parsed expression, which can be evaluated at a batch of points
+			bool is_expression() const { return !expr_.empty(); }
+			/// true if the value is a user function, which might not be safe to call concurrently
+			bool is_function() const { return sfunc_ || tfunc_; }
 			bool is_mat() const
 			{
 				if (expr_.empty() && mat_.size() > 0)
@@ -66,11 +81,17 @@ namespace polyfem
 			}
 
 		private:
+			/// expression compiled once into a postfix program over x, y, z, t
+			class Program;
+
+			double convert_unit(const double value) const;
+
 			std::function<double(double x, double y, double z, double t, int index)> sfunc_;
 			std::function<Eigen::MatrixXd(double x, double y, double z, double t)> tfunc_;
 			int tfunc_coo_;
 
 			std::string expr_;
+			std::shared_ptr<const Program> program_;
 			double value_;
 			Eigen::MatrixXd mat_;
 			std::vector<ExpressionValue> mat_expr_;
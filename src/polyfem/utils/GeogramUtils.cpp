@@ -56,25 +56,23 @@ namespace polyfem::utils
 
 	void GeogramUtils::initialize()
 	{
-		if (initialized)
-			return;
-
-		initialized = true;
-
+		std::call_once(initialized, [] {
 #ifndef WIN32
-		setenv("GEO_NO_SIGNAL_HANDLER", "1", 1);
+			setenv("GEO_NO_SIGNAL_HANDLER", "1", 1);
 #endif
 
-		GEO::initialize();
+			GEO::initialize();
 
-		// Import standard command line arguments, and custom ones
-		GEO::CmdLine::import_arg_group("standard");
-		GEO::CmdLine::import_arg_group("pre");
-		GEO::CmdLine::import_arg_group("algo");
+			// Import standard command line arguments, and custom ones
+			GEO::CmdLine::import_arg_group("standard");
+			GEO::CmdLine::import_arg_group("pre");
+			GEO::CmdLine::import_arg_group("algo");
+		});
 	}
 
 	void GeogramUtils::set_logger(spdlog::logger &logger)
 	{
+		std::lock_guard<std::mutex> lock(logger_mutex);
 		GEO::Logger *geo_logger = GEO::Logger::instance();
 		geo_logger->unregister_all_clients();
 		geo_logger->register_client(new GeoLoggerForward(logger.clone("geogram")));
@@ -2,6 +2,8 @@
 
 #include "Logger.hpp"
 
+#include <mutex>
+
 namespace polyfem::utils
 {
 	class GeogramUtils
@@ -15,13 +17,16 @@ namespace polyfem::utils
 			return singleton;
 		}
 
+		/// @brief Initialize geogram, only the first call does anything. Safe to call from several threads.
 		void initialize();
 
+		/// @brief Forward the geogram messages to the logger. Safe to call from several threads.
 		void set_logger(spdlog::logger &logger);
 
 	private:
 		GeogramUtils() {}
 
-		bool initialized = false;
+		std::once_flag initialized;
+		std::mutex logger_mutex;
 	};
 } // namespace polyfem::utils
\ No newline at end of file
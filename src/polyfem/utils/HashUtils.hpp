@@ -56,6 +56,20 @@ namespace polyfem::utils
 		}
 	};
 
+	/// @brief Hash function for an array where the order matters.
+	struct HashArray
+	{
+		template <typename T, size_t N>
+		size_t operator()(const std::array<T, N> &v) const noexcept
+		{
+			std::hash<T> hasher;
+			size_t hash = 0;
+			for (const T &i : v)
+				hash ^= hasher(i) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+			return hash;
+		}
+	};
+
 	struct HashVector
 	{
 		template <typename T>
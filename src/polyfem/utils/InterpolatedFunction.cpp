@@ -1,5 +1,7 @@
 #include "InterpolatedFunction.hpp"
 
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
 #include <igl/in_element.h>
 #include <igl/barycentric_coordinates.h>
 
@@ -37,27 +39,29 @@ namespace polyfem
 			Eigen::MatrixXd res(pts.rows(), fun_.cols());
 			res.setZero();
 
-			Eigen::MatrixXd bc;
-
-			for (long i = 0; i < pts.rows(); ++i)
-			{
-				const int index = I(i);
+			maybe_parallel_for(pts.rows(), [&](int start, int end, int thread_id) {
+				Eigen::MatrixXd bc;
 
-				if (index < 0)
+				for (long i = start; i < end; ++i)
 				{
-					continue;
-				}
+					const int index = I(i);
 
-				const Eigen::MatrixXd pt = pts.row(i);
-				const Eigen::MatrixXd A = pts_.row(tris_(index, 0));
-				const Eigen::MatrixXd B = pts_.row(tris_(index, 1));
-				const Eigen::MatrixXd C = pts_.row(tris_(index, 2));
-				igl::barycentric_coordinates(pt, A, B, C, bc);
-				// std::cout<<pt<<"\tii:"<<index<<"\tr:"<<bc<<std::endl;
+					if (index < 0)
+					{
+						continue;
+					}
 
-				for (int j = 0; j < 3; ++j)
-					res.row(i) += fun_.row(tris_(index, j)) * bc(j);
-			}
+					const Eigen::MatrixXd pt = pts.row(i);
+					const Eigen::MatrixXd A = pts_.row(tris_(index, 0));
+					const Eigen::MatrixXd B = pts_.row(tris_(index, 1));
+					const Eigen::MatrixXd C = pts_.row(tris_(index, 2));
+					igl::barycentric_coordinates(pt, A, B, C, bc);
+					// std::cout<<pt<<"\tii:"<<index<<"\tr:"<<bc<<std::endl;
+
+					for (int j = 0; j < 3; ++j)
+						res.row(i) += fun_.row(tris_(index, j)) * bc(j);
+				}
+			});
 
 			return res;
 		}
@@ -1,9 +1,14 @@
 #include "LazyCubicInterpolator.hpp"
+
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <limits>
 #include <mutex>
+#include <unordered_set>
 
 namespace polyfem
 {
-	void LazyCubicInterpolator::bicubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
+	void LazyCubicInterpolator::bicubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<uint64_t> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
 	{
 		Eigen::MatrixXd corner_val(4, 1);
 		Eigen::MatrixXd corner_grad(4, 2);
@@ -50,7 +55,7 @@ namespace polyfem
 		assert(!std::isnan(grad(0)) && !std::isnan(grad(1)));
 	}
 
-	void LazyCubicInterpolator::tricubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
+	void LazyCubicInterpolator::tricubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<uint64_t> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
 	{
 		Eigen::MatrixXd corner_val(8, 1);
 		Eigen::MatrixXd corner_grad(8, 3);
@@ -109,100 +114,144 @@ namespace polyfem
 		assert(!std::isnan(grad(0)) && !std::isnan(grad(1)) && !std::isnan(grad(2)));
 	}
 
-	void LazyCubicInterpolator::cache_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point)
+	Eigen::VectorXd LazyCubicInterpolator::finite_difference_grads(const Eigen::VectorXi &key, const std::unordered_map<uint64_t, double, KeyHash> &distances) const
 	{
-		Eigen::MatrixXi keys;
-		build_corner_keys(point, keys);
-		std::vector<std::string> keys_string;
-
-		auto safe_compute_distance = [this, compute_distance](const Eigen::MatrixXd &clamped_point, const std::string &key_string) {
-			std::unique_lock lock(distance_mutex_);
-			if (implicit_function_distance.count(key_string) == 0)
-				compute_distance(clamped_point, implicit_function_distance[key_string]);
-		};
-		auto safe_distance = [this, safe_compute_distance](const Eigen::VectorXi &key) {
+		auto distance = [this, &distances](const Eigen::VectorXi &key) {
+			uint64_t packed_key;
 			Eigen::MatrixXd point;
-			std::string key_string;
-			double distance;
-			setup_key(key, key_string, point);
-			safe_compute_distance(point, key_string);
-			{
-				std::shared_lock lock(distance_mutex_);
-				distance = implicit_function_distance[key_string];
-			}
-			return distance;
+			setup_key(key, packed_key, point);
+			return distances.at(packed_key);
 		};
-		auto centered_fd = [this, safe_distance](const Eigen::VectorXi &key, const int k) {
-			Eigen::MatrixXi key_plus, key_minus;
-			double distance_plus, distance_minus;
-			key_plus = key;
+		auto centered_fd = [this, &distance](const Eigen::VectorXi &key, const int k) {
+			Eigen::VectorXi key_plus = key, key_minus = key;
 			key_plus(k) += 1;
-			distance_plus = safe_distance(key_plus);
-			key_minus = key;
 			key_minus(k) -= 1;
-			distance_minus = safe_distance(key_minus);
-			return (1. / 2. / delta_) * (distance_plus - distance_minus);
+			return (1. / 2. / delta_) * (distance(key_plus) - distance(key_minus));
 		};
-		auto centered_mixed_fd = [this, centered_fd](const Eigen::VectorXi &key, const int k1, const int k2) {
-			Eigen::VectorXi key_plus, key_minus;
-			key_plus = key;
+		auto centered_mixed_fd = [this, &centered_fd](const Eigen::VectorXi &key, const int k1, const int k2) {
+			Eigen::VectorXi key_plus = key, key_minus = key;
 			key_plus(k1) += 1;
-			key_minus = key;
 			key_minus(k1) -= 1;
 			return (1. / 2. / delta_) * (centered_fd(key_plus, k2) - centered_fd(key_minus, k2));
 		};
-		auto centered_mixed_fd_3d = [this, centered_mixed_fd](const Eigen::VectorXi &key) {
-			Eigen::VectorXi key_plus, key_minus;
-			key_plus = key;
+
+		Eigen::VectorXd mixed_grads(dim_ == 2 ? 3 : 7);
+		if (dim_ == 2)
+		{
+			mixed_grads(0) = centered_fd(key, 0);
+			mixed_grads(1) = centered_fd(key, 1);
+			mixed_grads(2) = centered_mixed_fd(key, 0, 1);
+		}
+		else if (dim_ == 3)
+		{
+			Eigen::VectorXi key_plus = key, key_minus = key;
 			key_plus(0) += 1;
-			key_minus = key;
 			key_minus(0) -= 1;
-			return (1. / 2. / delta_) * (centered_mixed_fd(key_plus, 1, 2) - centered_mixed_fd(key_minus, 1, 2));
-		};
-		auto compute_grad = [this, centered_fd, centered_mixed_fd, centered_mixed_fd_3d](const Eigen::VectorXi &key) {
-			Eigen::VectorXd mixed_grads(dim_ == 2 ? 3 : 7);
-			if (dim_ == 2)
-			{
-				mixed_grads(0) = centered_fd(key, 0);
-				mixed_grads(1) = centered_fd(key, 1);
-				mixed_grads(2) = centered_mixed_fd(key, 0, 1);
-			}
-			else if (dim_ == 3)
+
+			mixed_grads(0) = centered_fd(key, 0);
+			mixed_grads(1) = centered_fd(key, 1);
+			mixed_grads(2) = centered_fd(key, 2);
+			mixed_grads(3) = centered_mixed_fd(key, 0, 1);
+			mixed_grads(4) = centered_mixed_fd(key, 0, 2);
+			mixed_grads(5) = centered_mixed_fd(key, 1, 2);
+			mixed_grads(6) = (1. / 2. / delta_) * (centered_mixed_fd(key_plus, 1, 2) - centered_mixed_fd(key_minus, 1, 2));
+		}
+		return mixed_grads;
+	}
+
+	void LazyCubicInterpolator::cache_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &points)
+	{
+		// corners of the cells of the points whose gradients are missing, without duplicates
+		std::vector<Eigen::VectorXi> grad_keys;
+		std::vector<uint64_t> packed_grad_keys;
+		{
+			std::unordered_set<uint64_t, KeyHash> visited;
+			std::shared_lock lock(grad_mutex_);
+			Eigen::MatrixXi keys;
+			for (int p = 0; p < points.rows(); ++p)
 			{
-				mixed_grads(0) = centered_fd(key, 0);
-				mixed_grads(1) = centered_fd(key, 1);
-				mixed_grads(2) = centered_fd(key, 2);
-				mixed_grads(3) = centered_mixed_fd(key, 0, 1);
-				mixed_grads(4) = centered_mixed_fd(key, 0, 2);
-				mixed_grads(5) = centered_mixed_fd(key, 1, 2);
-				mixed_grads(6) = centered_mixed_fd_3d(key);
+				build_corner_keys(points.row(p), keys);
+				for (int i = 0; i < keys.rows(); ++i)
+				{
+					uint64_t packed_key;
+					Eigen::MatrixXd clamped_point;
+					setup_key(keys.row(i), packed_key, clamped_point);
+					if (implicit_function_grads.count(packed_key) == 0 && visited.insert(packed_key).second)
+					{
+						grad_keys.push_back(keys.row(i).transpose());
+						packed_grad_keys.push_back(packed_key);
+					}
+				}
 			}
-			return mixed_grads;
-		};
-		auto safe_compute_grad = [this, compute_grad](const Eigen::VectorXi &key) {
-			std::string key_string;
-			Eigen::MatrixXd point;
-			setup_key(key, key_string, point);
+		}
+
+		if (grad_keys.empty())
+			return;
+
+		// the finite differences of a corner use the distances of its 3^dim neighbours, copied
+		// in stencil_distances so that the gradients are computed without holding the locks
+		std::unordered_map<uint64_t, double, KeyHash> stencil_distances;
+		std::vector<Eigen::VectorXi> distance_keys;
+		std::vector<uint64_t> packed_distance_keys;
+		{
+			std::shared_lock lock(distance_mutex_);
+			const int n_neighbours = dim_ == 2 ? 9 : 27;
+			for (const Eigen::VectorXi &key : grad_keys)
 			{
-				std::unique_lock lock(grad_mutex_);
-				if (implicit_function_grads.count(key_string) == 0)
+				for (int n = 0; n < n_neighbours; ++n)
 				{
-					Eigen::MatrixXd grad = compute_grad(key);
-					implicit_function_grads[key_string] = grad;
+					Eigen::VectorXi neighbour = key;
+					for (int k = 0, code = n; k < dim_; ++k, code /= 3)
+						neighbour(k) += code % 3 - 1;
+
+					uint64_t packed_key;
+					Eigen::MatrixXd clamped_point;
+					setup_key(neighbour, packed_key, clamped_point);
+					if (stencil_distances.count(packed_key) > 0)
+						continue;
+
+					const auto it = implicit_function_distance.find(packed_key);
+					if (it != implicit_function_distance.end())
+						stencil_distances[packed_key] = it->second;
+					else
+					{
+						stencil_distances[packed_key] = std::numeric_limits<double>::quiet_NaN();
+						distance_keys.push_back(neighbour);
+						packed_distance_keys.push_back(packed_key);
+					}
 				}
 			}
-		};
-		Eigen::MatrixXd corner_point(keys.rows(), dim_);
-		for (int i = 0; i < keys.rows(); ++i)
-		{
-			std::string key_string;
+		}
+
+		// the distance queries are the expensive part, they run in parallel outside of the locks
+		std::vector<double> distances(distance_keys.size());
+		utils::maybe_parallel_for(distance_keys.size(), [&](int start, int end, int thread_id) {
+			uint64_t packed_key;
 			Eigen::MatrixXd clamped_point;
-			setup_key(keys.row(i), key_string, clamped_point);
-			safe_compute_distance(clamped_point, key_string);
-			keys_string.push_back(key_string);
-			corner_point.row(i) = clamped_point.transpose();
-			safe_compute_grad(keys.row(i));
+			for (int i = start; i < end; ++i)
+			{
+				setup_key(distance_keys[i], packed_key, clamped_point);
+				compute_distance(clamped_point, distances[i]);
+			}
+		});
+
+		for (int i = 0; i < distances.size(); ++i)
+			stencil_distances[packed_distance_keys[i]] = distances[i];
+		{
+			std::unique_lock lock(distance_mutex_);
+			for (int i = 0; i < distances.size(); ++i)
+				implicit_function_distance.emplace(packed_distance_keys[i], distances[i]);
 		}
+
+		std::vector<Eigen::VectorXd> grads(grad_keys.size());
+		utils::maybe_parallel_for(grad_keys.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				grads[i] = finite_difference_grads(grad_keys[i], stencil_distances);
+		});
+
+		std::unique_lock lock(grad_mutex_);
+		for (int i = 0; i < grads.size(); ++i)
+			implicit_function_grads.emplace(packed_grad_keys[i], grads[i]);
 	}
 
 	void LazyCubicInterpolator::evaluate(const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
@@ -210,28 +259,43 @@ namespace polyfem
 		Eigen::MatrixXi keys;
 		build_corner_keys(point, keys);
 
-		std::vector<std::string> keys_string;
+		std::vector<uint64_t> packed_keys;
 		Eigen::MatrixXd corner_point(keys.rows(), dim_);
 		for (int i = 0; i < keys.rows(); ++i)
 		{
-			std::string key_string;
+			uint64_t packed_key;
 			Eigen::MatrixXd clamped_point;
-			setup_key(keys.row(i), key_string, clamped_point);
-			keys_string.push_back(key_string);
+			setup_key(keys.row(i), packed_key, clamped_point);
+			packed_keys.push_back(packed_key);
 			corner_point.row(i) = clamped_point.transpose();
 		}
 
 		grad.setZero(dim_, 1);
 		if (dim_ == 2)
-			bicubic_interpolation(corner_point, keys_string, point, val, grad);
+			bicubic_interpolation(corner_point, packed_keys, point, val, grad);
 		else if (dim_ == 3)
-			tricubic_interpolation(corner_point, keys_string, point, val, grad);
+			tricubic_interpolation(corner_point, packed_keys, point, val, grad);
 
 		for (int i = 0; i < dim_; ++i)
 			if (std::isnan(grad(i)))
 				throw std::runtime_error("Nan found in gradient computation.");
 	}
 
+	void LazyCubicInterpolator::evaluate(const Eigen::MatrixXd &points, Eigen::VectorXd &vals, Eigen::MatrixXd &grads) const
+	{
+		vals.resize(points.rows());
+		grads.resize(points.rows(), dim_);
+
+		utils::maybe_parallel_for(points.rows(), [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd grad;
+			for (int i = start; i < end; ++i)
+			{
+				evaluate(points.row(i), vals(i), grad);
+				grads.row(i) = grad.transpose();
+			}
+		});
+	}
+
 	void LazyCubicInterpolator::lazy_evaluate(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad)
 	{
 		cache_grid(compute_distance, point);
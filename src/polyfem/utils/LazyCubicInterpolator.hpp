@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <unordered_map>
 #include <shared_mutex>
@@ -105,11 +106,20 @@ namespace polyfem
 			}
 		}
 
-		void bicubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
-		void tricubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
+		void bicubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<uint64_t> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
+		void tricubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<uint64_t> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
 		void lazy_evaluate(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad);
-		void cache_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point);
+		/// @brief Caches the grid values needed to interpolate at a batch of points. The missing grid nodes of all
+		/// the points are gathered without duplicates and their distances are computed in parallel.
+		/// @param[in] compute_distance distance at a grid node (dim x 1), must be thread safe
+		/// @param[in] points one point per row
+		void cache_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &points);
 		void evaluate(const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
+		/// @brief Evaluate at a batch of cached points.
+		/// @param[in] points one point per row
+		/// @param[out] vals interpolated value at every point
+		/// @param[out] grads interpolated gradient at every point, one per row
+		void evaluate(const Eigen::MatrixXd &points, Eigen::VectorXd &vals, Eigen::MatrixXd &grads) const;
 
 	private:
 		inline void build_corner_keys(const Eigen::MatrixXd &point, Eigen::MatrixXi &keys) const
@@ -117,7 +127,6 @@ namespace polyfem
 			int num_corner_points = dim_ == 2 ? 4 : 8;
 			Eigen::MatrixXi bin(dim_, 1);
 			keys.resize(num_corner_points, dim_);
-			std::vector<std::string> keys_string;
 			for (int k = 0; k < dim_; ++k)
 				bin(k) = (int)std::floor(point(k) / delta_);
 			if (dim_ == 2)
@@ -139,22 +148,40 @@ namespace polyfem
 					bin(0) + 1, bin(1) + 1, bin(2) + 1;
 			}
 		}
-		inline void setup_key(const Eigen::VectorXi &key, std::string &key_string, Eigen::MatrixXd &clamped_point) const
+		inline void setup_key(const Eigen::VectorXi &key, uint64_t &packed_key, Eigen::MatrixXd &clamped_point) const
 		{
-			key_string = "";
+			packed_key = 0;
 			clamped_point.setZero(dim_, 1);
 			for (int k = 0; k < dim_; ++k)
 			{
-				// key_string += fmt::format("{:d},", key(k));
-				key_string += std::to_string(key(k)) + ",";
+				// 21 bits per coordinate, shifted to be non-negative
+				assert(std::abs(key(k)) < (1 << 20));
+				packed_key |= (uint64_t(key(k) + (1 << 20)) & 0x1FFFFF) << (21 * k);
 				clamped_point(k) = (double)key(k) * delta_;
 			}
 		};
 
+		/// mixes the bits of the packed grid coordinates, neighbouring keys only differ in a few low bits
+		struct KeyHash
+		{
+			size_t operator()(uint64_t key) const
+			{
+				key ^= key >> 33;
+				key *= 0xff51afd7ed558ccdULL;
+				key ^= key >> 33;
+				return key;
+			}
+		};
+
+		/// @brief Finite differences of the distance at a grid node
+		/// @param[in] key grid coordinates of the node
+		/// @param[in] distances distances of the 3^dim neighbours of the node, by packed key
+		Eigen::VectorXd finite_difference_grads(const Eigen::VectorXi &key, const std::unordered_map<uint64_t, double, KeyHash> &distances) const;
+
 		int dim_;
 		double delta_;
-		std::unordered_map<std::string, double> implicit_function_distance;
-		std::unordered_map<std::string, Eigen::VectorXd> implicit_function_grads;
+		std::unordered_map<uint64_t, double, KeyHash> implicit_function_distance;
+		std::unordered_map<uint64_t, Eigen::VectorXd, KeyHash> implicit_function_grads;
 
 		Eigen::MatrixXd cubic_mat;
 
@@ -3,22 +3,47 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <polyfem/utils/EnableWarnings.hpp>
 
+#include <chrono>
+#include <mutex>
+#include <vector>
+
 namespace polyfem
 {
 	namespace
 	{
+		/// Logger set by the user, if any. Read concurrently by the solves running in parallel, so the
+		/// current logger is an atomic pointer and every logger ever set is kept alive: a reference
+		/// returned by logger() stays valid even if another thread replaces the logger.
+		class LoggerSlot
+		{
+		public:
+			spdlog::logger *get() const { return current_.load(std::memory_order_acquire); }
+
+			void set(std::shared_ptr<spdlog::logger> logger)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				current_.store(logger.get(), std::memory_order_release);
+				if (logger)
+					owned_.push_back(std::move(logger));
+			}
+
+		private:
+			std::atomic<spdlog::logger *> current_ = nullptr;
+			std::mutex mutex_;
+			std::vector<std::shared_ptr<spdlog::logger>> owned_;
+		};
 
 		// Custom logger instance defined by the user, if any
-		std::shared_ptr<spdlog::logger> &get_shared_logger()
+		LoggerSlot &get_shared_logger()
 		{
-			static std::shared_ptr<spdlog::logger> logger;
+			static LoggerSlot logger;
 			return logger;
 		}
 
 		// Custom logger instance defined by the user, if any
-		std::shared_ptr<spdlog::logger> &get_shared_adjoint_logger()
+		LoggerSlot &get_shared_adjoint_logger()
 		{
-			static std::shared_ptr<spdlog::logger> logger;
+			static LoggerSlot logger;
 			return logger;
 		}
 
@@ -27,9 +52,9 @@ namespace polyfem
 	// Retrieve current logger
 	spdlog::logger &adjoint_logger()
 	{
-		if (get_shared_adjoint_logger())
+		if (spdlog::logger *logger = get_shared_adjoint_logger().get())
 		{
-			return *get_shared_adjoint_logger();
+			return *logger;
 		}
 		else
 		{
@@ -41,9 +66,9 @@ namespace polyfem
 	// Retrieve current logger
 	spdlog::logger &logger()
 	{
-		if (get_shared_logger())
+		if (spdlog::logger *logger = get_shared_logger().get())
 		{
-			return *get_shared_logger();
+			return *logger;
 		}
 		else
 		{
@@ -59,13 +84,22 @@ namespace polyfem
 	// Use a custom logger
 	void set_logger(std::shared_ptr<spdlog::logger> p_logger)
 	{
-		get_shared_logger() = std::move(p_logger);
+		get_shared_logger().set(std::move(p_logger));
 	}
 
 	// Use a custom logger
 	void set_adjoint_logger(std::shared_ptr<spdlog::logger> p_logger)
 	{
-		get_shared_adjoint_logger() = std::move(p_logger);
+		get_shared_adjoint_logger().set(std::move(p_logger));
+	}
+
+	bool is_log_due(std::atomic<double> &last_time, const double seconds)
+	{
+		const double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		double last = last_time.load(std::memory_order_relaxed);
+		// only one of the threads reaching the call site at the same time logs
+		return (last < 0 || now - last >= seconds)
+			   && last_time.compare_exchange_strong(last, now, std::memory_order_relaxed);
 	}
 
 	void log_and_throw_error(const std::string &msg)
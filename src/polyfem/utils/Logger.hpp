@@ -6,6 +6,30 @@
 #include <spdlog/spdlog.h>
 #include <polyfem/utils/EnableWarnings.hpp>
 
+#include <atomic>
+
+/// Trace messages of the hot loops, compiled out of the release builds (see POLYFEM_WITH_TRACE_LOGGING).
+/// The disabled version still type checks its arguments, so the variables only logged are not reported as unused.
+#ifdef POLYFEM_WITH_TRACE_LOGGING
+#define POLYFEM_LOG_TRACE(...) ::polyfem::logger().trace(__VA_ARGS__)
+#else
+#define POLYFEM_LOG_TRACE(...)                         \
+	do                                                 \
+	{                                                  \
+		if (false)                                     \
+			::polyfem::logger().trace(__VA_ARGS__);    \
+	} while (0)
+#endif
+
+/// Logs at the given level at most once every `seconds` seconds from this call site, the dropped messages are not formatted
+#define POLYFEM_LOG_EVERY_N_SEC(level, seconds, ...)                                                           \
+	do                                                                                                         \
+	{                                                                                                          \
+		static std::atomic<double> polyfem_log_last_time_(-1);                                                \
+		if (::polyfem::logger().should_log(level) && ::polyfem::is_log_due(polyfem_log_last_time_, seconds)) \
+			::polyfem::logger().log(level, __VA_ARGS__);                                                       \
+	} while (0)
+
 namespace polyfem
 {
 	///
@@ -37,6 +61,16 @@ namespace polyfem
 	///
 	void set_adjoint_logger(std::shared_ptr<spdlog::logger> logger);
 
+	///
+	/// Rate limiting of a log call site.
+	///
+	/// @param[in,out] last_time  Time of the last message of the call site, in seconds since an arbitrary epoch, negative if none.
+	/// @param[in]     seconds    Minimum time between two messages.
+	///
+	/// @return     True if the message should be logged, last_time is then updated.
+	///
+	bool is_log_due(std::atomic<double> &last_time, const double seconds);
+
 	[[noreturn]] void log_and_throw_error(const std::string &msg);
 	[[noreturn]] void log_and_throw_adjoint_error(const std::string &msg);
 
@@ -2,6 +2,7 @@
 
 #include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
 
 namespace polyfem::utils
 {
@@ -68,6 +69,7 @@ namespace polyfem::utils
 			assert(main_cache_ != this && main_cache_ != nullptr && main_cache_->main_cache_ == nullptr);
 		}
 		size_ = other.size_;
+		symmetric_ = other.symmetric_;
 
 		values_.resize(other.values_.size());
 
@@ -77,6 +79,12 @@ namespace polyfem::utils
 		std::fill(values_.begin(), values_.end(), 0);
 	}
 
+	void SparseMatrixCache::set_symmetric(const bool symmetric)
+	{
+		assert(mapping().empty() && entries_.empty() && mat_.nonZeros() == 0);
+		symmetric_ = symmetric;
+	}
+
 	void SparseMatrixCache::set_zero()
 	{
 		tmp_.setZero();
@@ -85,8 +93,28 @@ namespace polyfem::utils
 		std::fill(values_.begin(), values_.end(), 0);
 	}
 
+	size_t SparseMatrixCache::memory_usage() const
+	{
+		size_t bytes = utils::memory_usage(tmp_) + utils::memory_usage(mat_)
+					   + utils::memory_usage(entries_) + utils::memory_usage(inner_index_)
+					   + utils::memory_usage(outer_index_) + utils::memory_usage(values_)
+					   + utils::memory_usage(mapping_) + utils::memory_usage(second_cache_)
+					   + utils::memory_usage(second_cache_entries_);
+		for (const auto &row : mapping_)
+			bytes += utils::memory_usage(row);
+		for (const auto &slots : second_cache_)
+			bytes += utils::memory_usage(slots);
+		for (const auto &entries : second_cache_entries_)
+			bytes += utils::memory_usage(entries);
+		return bytes;
+	}
+
 	void SparseMatrixCache::add_value(const int e, const int i, const int j, const double value)
 	{
+		// the lower triangle is the transpose of the upper one, it is neither stored nor given a slot
+		if (symmetric_ && i > j)
+			return;
+
 		// caches have yet to be constructed (likely because the matrix has yet to be fully assembled)
 		if (mapping().empty())
 		{
@@ -153,15 +181,15 @@ namespace polyfem::utils
 				inner_index_.assign(inn_ptr, inn_ptr + inner_index_.size());
 				outer_index_.assign(out_ptr, out_ptr + outer_index_.size());
 
-				size_t index = 0;
+				StorageIndex index = 0;
 				// loop over columns of the matrix
-				for (size_t i = 0; i < mat_.cols(); ++i)
+				for (int i = 0; i < mat_.cols(); ++i)
 				{
-					const auto start = outer_index_[i];
-					const auto end = outer_index_[i + 1];
+					const StorageIndex start = outer_index_[i];
+					const StorageIndex end = outer_index_[i + 1];
 
 					// loop over the nonzero elements of the given column
-					for (size_t ii = start; ii < end; ++ii)
+					for (StorageIndex ii = start; ii < end; ++ii)
 					{
 						// pick out current row
 						const auto j = inner_index_[ii];
@@ -171,7 +199,7 @@ namespace polyfem::utils
 					}
 				}
 
-				logger().trace("Cache computed");
+				POLYFEM_LOG_TRACE("Cache computed");
 
 				second_cache_.clear();
 				second_cache_.resize(second_cache_entries_.size());
@@ -186,7 +214,7 @@ namespace polyfem::utils
 
 						// pick out column/sparse matrix index pairs for the given column
 						const auto &map = mapping()[i];
-						int index = -1;
+						StorageIndex index = -1;
 
 						// loop over column/sparse matrix index pairs
 						for (const auto &p : map)
@@ -208,7 +236,7 @@ namespace polyfem::utils
 
 				second_cache_entries_.resize(0);
 
-				logger().trace("Second cache computed");
+				POLYFEM_LOG_TRACE("Second cache computed");
 			}
 		}
 		else
@@ -225,6 +253,9 @@ namespace polyfem::utils
 
 		}
 		std::fill(values_.begin(), values_.end(), 0);
+
+		if (symmetric_)
+			return mat_.selfadjointView<Eigen::Upper>();
 		return mat_;
 	}
 
@@ -322,6 +353,27 @@ namespace polyfem::utils
 		}
 	}
 
+	void SparseMatrixCache::accumulate(const std::vector<const SparseMatrixCache *> &others)
+	{
+		assert(has_pattern());
+
+		// parallelize over the non-zeros so that each entry is reduced by a single thread
+		maybe_parallel_for(values_.size(), [&](int start, int end, int thread_id) {
+			for (const SparseMatrixCache *o : others)
+			{
+				assert(o != this);
+				assert(o->main_cache() == main_cache());
+				assert(o->values_.size() == values_.size());
+
+				const double *o_values = o->values_.data();
+				for (int i = start; i < end; ++i)
+				{
+					values_[i] += o_values[i];
+				}
+			}
+		});
+	}
+
 	// ========================================================================
 
 	DenseMatrixCache::DenseMatrixCache(const size_t size)
@@ -6,6 +6,8 @@
 #include <Eigen/Sparse>
 
 #include <memory>
+#include <vector>
+#include <cassert>
 
 namespace polyfem::utils
 {
@@ -31,6 +33,10 @@ namespace polyfem::utils
 		virtual size_t triplet_count() const = 0;
 		virtual bool is_sparse() const = 0;
 		bool is_dense() const { return !is_sparse(); }
+		/// only the upper triangle is stored, see SparseMatrixCache::set_symmetric
+		virtual bool is_symmetric() const { return false; }
+		/// bytes allocated by the cache, the mapping shared with a main cache is counted by the main cache
+		virtual size_t memory_usage() const = 0;
 
 		virtual void add_value(const int e, const int i, const int j, const double value) = 0;
 		virtual StiffnessMatrix get_matrix(const bool compute_mapping = true) = 0;
@@ -75,8 +81,15 @@ namespace polyfem::utils
 		inline size_t non_zeros() const override { return mapping_.empty() ? mat_.nonZeros() : values_.size(); }
 		inline size_t triplet_count() const override { return entries_.size() + mat_.nonZeros(); }
 		inline bool is_sparse() const override { return true; }
+		inline bool is_symmetric() const override { return symmetric_; }
 		inline size_t mapping_size() const { return mapping_.size(); }
 
+		/// store only the upper triangle (row ≤ column) of a symmetric matrix, the values added below the diagonal are ignored
+		/// halves the entries, the pattern and the value buffer; get_matrix still returns the full matrix
+		/// must be set before the first assembly, the copies of the cache inherit it
+		void set_symmetric(const bool symmetric);
+		size_t memory_usage() const override;
+
 		/// e = element_index, i = global row_index, j = global column_index, value = value to add to matrix
 		/// if the cache is yet to be constructed, save the row, column, and value to be added to the second cache
 		///     in this case, modifies_ entries_ and second_cache_entries_
@@ -100,19 +113,40 @@ namespace polyfem::utils
 		void operator+=(const MatrixCache &o) override;
 		void operator+=(const SparseMatrixCache &o);
 
+		/// stored matrix, only its upper triangle if the cache is symmetric
 		const StiffnessMatrix &mat() const { return mat_; }
 		const std::vector<Eigen::Triplet<double>> &entries() const { return entries_; }
 
+		/// true once the symbolic phase is done, i.e., the sparsity pattern has been frozen by a first get_matrix
+		/// from then on values are scattered directly in the value buffer and no triplets are stored
+		inline bool has_pattern() const { return !mapping().empty(); }
+
+		/// numeric phase: indices in the value buffer touched by element e, in the same order as its add_value calls
+		inline const std::vector<StorageIndex> &element_slots(const int e) const
+		{
+			assert(has_pattern());
+			assert(e < second_cache().size());
+			return second_cache()[e];
+		}
+
+		/// numeric phase: value buffer, laid out as the frozen CSC pattern
+		inline double *values_data() { return values_.data(); }
+
+		/// numeric phase: sum the value buffers of caches sharing this pattern in one pass over the non-zeros
+		/// replaces a chain of operator+= when reducing thread-local caches
+		void accumulate(const std::vector<const SparseMatrixCache *> &others);
+
 	private:
 		size_t size_;
+		bool symmetric_ = false;
 		StiffnessMatrix tmp_, mat_;
 		std::vector<Eigen::Triplet<double>> entries_; ///< contains global matrix indices and corresponding value
-		std::vector<std::vector<std::pair<int, size_t>>> mapping_; ///< maps row indices to column index/local index pairs
-		std::vector<int> inner_index_, outer_index_; ///< saves inner/outer indices for sparse matrix
+		std::vector<std::vector<std::pair<int, StorageIndex>>> mapping_; ///< maps row indices to column index/local index pairs
+		std::vector<StorageIndex> inner_index_, outer_index_; ///< saves inner/outer indices for sparse matrix
 		std::vector<double> values_; ///< buffer for values (corresponds to inner/outer_index_ structure for sparse matrix)
 		const SparseMatrixCache *main_cache_ = nullptr;
 
-		std::vector<std::vector<int>> second_cache_; ///< maps element index to local index
+		std::vector<std::vector<StorageIndex>> second_cache_; ///< maps element index to local index
 		std::vector<std::vector<std::pair<int, int>>> second_cache_entries_; ///< maps element indices to global matrix indices
 		int current_e_ = -1;
 		int current_e_index_ = -1;
@@ -122,12 +156,12 @@ namespace polyfem::utils
 			return main_cache_ == nullptr ? this : main_cache_;
 		}
 
-		inline const std::vector<std::vector<std::pair<int, size_t>>> &mapping() const
+		inline const std::vector<std::vector<std::pair<int, StorageIndex>>> &mapping() const
 		{
 			return main_cache()->mapping_;
 		}
 
-		inline const std::vector<std::vector<int>> &second_cache() const
+		inline const std::vector<std::vector<StorageIndex>> &second_cache() const
 		{
 			return main_cache()->second_cache_;
 		}
@@ -159,6 +193,7 @@ namespace polyfem::utils
 		inline size_t capacity() const override { return mat_.size(); }
 		inline size_t non_zeros() const override { return mat_.size(); }
 		inline size_t triplet_count() const override { return non_zeros(); }
+		inline size_t memory_usage() const override { return mat_.size() * sizeof(double); }
 		inline bool is_sparse() const override { return false; }
 
 		void add_value(const int e, const int i, const int j, const double value) override;
@@ -159,6 +159,63 @@ void polyfem::utils::full_to_reduced_matrix(
 	reduced.makeCompressed();
 }
 
+void polyfem::utils::full_to_reduced_matrix_in_place(
+	const std::vector<int> &removed_vars,
+	StiffnessMatrix &mat)
+{
+	POLYFEM_SCOPED_TIMER("full to reduced matrix in place");
+
+	if (removed_vars.empty())
+		return;
+
+	assert(mat.rows() == mat.cols());
+	const int full_size = mat.rows();
+	mat.makeCompressed();
+
+	std::vector<int> indices(full_size, 0);
+	for (const int i : removed_vars)
+		indices[i] = -1;
+	int reduced_size = 0;
+	for (int i = 0; i < full_size; ++i)
+	{
+		if (indices[i] >= 0)
+			indices[i] = reduced_size++;
+	}
+
+	// The kept entries keep their order, so they are moved towards the front of the arrays
+	StiffnessMatrix::StorageIndex *outer = mat.outerIndexPtr();
+	StiffnessMatrix::StorageIndex *inner = mat.innerIndexPtr();
+	double *values = mat.valuePtr();
+
+	int nnz = 0;
+	int reduced_col = 0;
+	int next_begin = outer[0];
+	for (int k = 0; k < mat.outerSize(); ++k)
+	{
+		const int begin = next_begin;
+		const int end = outer[k + 1];
+		next_begin = end;
+
+		if (indices[k] < 0)
+			continue;
+
+		for (int j = begin; j < end; ++j)
+		{
+			const int row = indices[inner[j]];
+			if (row < 0)
+				continue;
+			inner[nnz] = row;
+			values[nnz] = values[j];
+			++nnz;
+		}
+		outer[++reduced_col] = nnz;
+	}
+	assert(reduced_col == reduced_size);
+
+	mat.conservativeResize(reduced_size, reduced_size);
+	mat.makeCompressed();
+}
+
 Eigen::MatrixXd polyfem::utils::reorder_matrix(
 	const Eigen::MatrixXd &in,
 	const Eigen::VectorXi &in_to_out,
@@ -107,6 +107,13 @@ namespace polyfem
 			const StiffnessMatrix &full,
 			StiffnessMatrix &reduced);
 
+		/// @brief Drop rows and columns of a matrix in place, without materializing a second matrix.
+		/// @param[in] removed_vars Indices of the variables (rows and columns) to remove.
+		/// @param[in,out] mat Full size matrix, reduced on output.
+		void full_to_reduced_matrix_in_place(
+			const std::vector<int> &removed_vars,
+			StiffnessMatrix &mat);
+
 		/// @brief Reorder row blocks in a matrix.
 		/// @param in Input matrix.
 		/// @param in_to_out Mapping from input blocks to output blocks.
@@ -4,6 +4,8 @@
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_reduce.h>
 #include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/partitioner.h>
 #elif defined(POLYFEM_WITH_CPP_THREADS)
 #include <polyfem/utils/par_for.hpp>
 #else
@@ -14,17 +16,46 @@ namespace polyfem
 {
 	namespace utils
 	{
+#if defined(POLYFEM_DETERMINISTIC)
+		// Number of chunks of the deterministic `maybe_parallel_for()`, independent of the number of threads.
+		// Every chunk has its own thread storage, which are reduced in chunk order.
+		inline constexpr int deterministic_chunks = 16;
+#endif
+
 		// Perform a parallel (maybe) for loop.
 		// The parallel for used depends on the compile definitions.
 		// The overall for loop is from 0 up to `size` with an increment of 1.
 		inline void maybe_parallel_for(int size, const std::function<void(int, int, int)> &partial_for);
 		inline void maybe_parallel_for(int size, const std::function<void(int)> &body);
 
+		// Remembers which thread ran which part of a loop: a loop repeated over the same range (e.g., the element
+		// loops of every Newton iteration) replays the same split, so each thread finds its data in its own caches.
+		// Only TBB schedules by affinity, a copy starts without history. Not to be shared by concurrent loops.
+		class ParallelForAffinity
+		{
+		public:
+			ParallelForAffinity() = default;
+			ParallelForAffinity(const ParallelForAffinity &) {}
+			ParallelForAffinity &operator=(const ParallelForAffinity &) { return *this; }
+
+#if defined(POLYFEM_WITH_TBB)
+			tbb::affinity_partitioner partitioner;
+#endif
+		};
+
+		// Same as the first `maybe_parallel_for()`, splitting the range as the previous loops run with `affinity`.
+		inline void maybe_parallel_for(int size, const std::function<void(int, int, int)> &partial_for, ParallelForAffinity &affinity);
+
+		// Sorts [begin, end) in parallel when built with TBB, with std::sort otherwise.
+		template <typename RandomIt>
+		inline void maybe_parallel_sort(RandomIt begin, RandomIt end);
+
 		// Returns thread specific storage for further use in `maybe_parallel_for()`.
 		// The return type depends on the threading library used.
-		//     TBB         ⟹ `std::vector<LocalStorage>`
-		//     C++ Threads ⟹ `tbb::enumerable_thread_specific<LocalStorage>`
-		//     none        ⟹ `std::array<LocalStorage, 1>`
+		//     TBB           ⟹ `std::vector<LocalStorage>`
+		//     C++ Threads   ⟹ `tbb::enumerable_thread_specific<LocalStorage>`
+		//     none          ⟹ `std::array<LocalStorage, 1>`
+		//     deterministic ⟹ `std::vector<LocalStorage>`, one per chunk
 		template <typename LocalStorage>
 		inline auto create_thread_storage(const LocalStorage &initial_local_storage);
 
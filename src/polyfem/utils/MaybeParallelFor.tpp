@@ -4,6 +4,8 @@
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_reduce.h>
 #include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/partitioner.h>
 #elif defined(POLYFEM_WITH_CPP_THREADS)
 #include <polyfem/utils/par_for.hpp>
 #include <execution>
@@ -11,13 +13,34 @@
 // Not using parallel for
 #endif
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 namespace polyfem
 {
 	namespace utils
 	{
 		inline void maybe_parallel_for(int size, const std::function<void(int, int, int)> &partial_for)
 		{
+#if defined(POLYFEM_DETERMINISTIC)
+			// fixed chunks, each with its own storage: the reductions do not depend on the scheduling nor on the number of threads
+			const int n_chunks = std::min(size, deterministic_chunks);
+			const auto chunk = [&](int c) {
+				partial_for(int(long(c) * size / n_chunks), int(long(c + 1) * size / n_chunks), /*thread_id=*/c);
+			};
 #if defined(POLYFEM_WITH_CPP_THREADS)
+			par_for(n_chunks, [&](int start, int end, int thread_id) {
+				for (int c = start; c < end; ++c)
+					chunk(c);
+			});
+#elif defined(POLYFEM_WITH_TBB)
+			tbb::parallel_for(0, n_chunks, chunk);
+#else
+			for (int c = 0; c < n_chunks; ++c)
+				chunk(c);
+#endif
+#elif defined(POLYFEM_WITH_CPP_THREADS)
 			par_for(size, partial_for);
 #elif defined(POLYFEM_WITH_TBB)
 			tbb::parallel_for(tbb::blocked_range<int>(0, size), [&](const tbb::blocked_range<int> &r) {
@@ -28,6 +51,24 @@ namespace polyfem
 #endif
 		}
 
+		inline void maybe_parallel_for(int size, const std::function<void(int, int, int)> &partial_for, ParallelForAffinity &affinity)
+		{
+#if defined(POLYFEM_DETERMINISTIC)
+			maybe_parallel_for(size, partial_for);
+#elif defined(POLYFEM_WITH_CPP_THREADS)
+			// par_for splits a range the same way on every call
+			par_for(size, partial_for);
+#elif defined(POLYFEM_WITH_TBB)
+			tbb::parallel_for(
+				tbb::blocked_range<int>(0, size), [&](const tbb::blocked_range<int> &r) {
+					partial_for(r.begin(), r.end(), tbb::this_task_arena::current_thread_index());
+				},
+				affinity.partitioner);
+#else
+			partial_for(0, size, /*thread_id=*/0); // actually the full for loop
+#endif
+		}
+
 		inline void maybe_parallel_for(int size, const std::function<void(int)> &body)
 		{
 #if defined(POLYFEM_WITH_CPP_THREADS)
@@ -41,10 +82,22 @@ namespace polyfem
 #endif
 		}
 
+		template <typename RandomIt>
+		inline void maybe_parallel_sort(RandomIt begin, RandomIt end)
+		{
+#if defined(POLYFEM_WITH_TBB)
+			tbb::parallel_sort(begin, end);
+#else
+			std::sort(begin, end);
+#endif
+		}
+
 		template <typename LocalStorage>
 		inline auto create_thread_storage(const LocalStorage &initial_local_storage)
 		{
-#if defined(POLYFEM_WITH_CPP_THREADS)
+#if defined(POLYFEM_DETERMINISTIC)
+			return std::vector<LocalStorage>(deterministic_chunks, initial_local_storage);
+#elif defined(POLYFEM_WITH_CPP_THREADS)
 			return std::vector<LocalStorage>(get_n_threads(), initial_local_storage);
 #elif defined(POLYFEM_WITH_TBB)
 			return tbb::enumerable_thread_specific<LocalStorage>(initial_local_storage);
@@ -56,7 +109,7 @@ namespace polyfem
 		template <typename Storages>
 		inline auto &get_local_thread_storage(Storages &storage, int thread_id)
 		{
-#if defined(POLYFEM_WITH_CPP_THREADS)
+#if defined(POLYFEM_DETERMINISTIC) || defined(POLYFEM_WITH_CPP_THREADS)
 			return storage[thread_id];
 #elif defined(POLYFEM_WITH_TBB)
 			return storage.local();
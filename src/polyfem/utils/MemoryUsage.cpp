@@ -0,0 +1,72 @@
+#include "MemoryUsage.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/getRSS.h>
+
+#include <ipc/collisions/collisions.hpp>
+#include <ipc/friction/friction_collisions.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+
+namespace polyfem::utils
+{
+	namespace
+	{
+		double to_mb(const size_t bytes)
+		{
+			return bytes / double(1 << 20);
+		}
+	} // namespace
+
+	size_t memory_usage(const ipc::Collisions &collisions)
+	{
+		return memory_usage(collisions.vv_collisions) + memory_usage(collisions.ev_collisions)
+			   + memory_usage(collisions.ee_collisions) + memory_usage(collisions.fv_collisions)
+			   + memory_usage(collisions.pv_collisions);
+	}
+
+	size_t memory_usage(const ipc::FrictionCollisions &collisions)
+	{
+		return memory_usage(collisions.vv_collisions) + memory_usage(collisions.ev_collisions)
+			   + memory_usage(collisions.ee_collisions) + memory_usage(collisions.fv_collisions);
+	}
+
+	void MemoryStats::record(const std::string &name, const size_t bytes)
+	{
+		auto &[current, peak] = usage_[name];
+		current = bytes;
+		peak = std::max(peak, bytes);
+	}
+
+	size_t MemoryStats::current(const std::string &name) const
+	{
+		const auto it = usage_.find(name);
+		return it == usage_.end() ? 0 : it->second.first;
+	}
+
+	size_t MemoryStats::peak(const std::string &name) const
+	{
+		const auto it = usage_.find(name);
+		return it == usage_.end() ? 0 : it->second.second;
+	}
+
+	nlohmann::json MemoryStats::to_json() const
+	{
+		nlohmann::json j;
+		j["subsystems"] = nlohmann::json::object();
+		for (const auto &[name, usage] : usage_)
+			j["subsystems"][name] = {{"current", to_mb(usage.first)}, {"peak", to_mb(usage.second)}};
+		j["current_rss"] = to_mb(getCurrentRSS());
+		j["peak_rss"] = to_mb(getPeakRSS());
+		return j;
+	}
+
+	void MemoryStats::log() const
+	{
+		for (const auto &[name, usage] : usage_)
+			logger().info("memory {}: {:.2f}MB (peak {:.2f}MB)", name, to_mb(usage.first), to_mb(usage.second));
+		logger().info("memory RSS: {:.2f}MB (peak {:.2f}MB)", to_mb(getCurrentRSS()), to_mb(getPeakRSS()));
+	}
+} // namespace polyfem::utils
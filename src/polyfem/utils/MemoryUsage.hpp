@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ipc
+{
+	class Collisions;
+	class FrictionCollisions;
+} // namespace ipc
+
+namespace polyfem::utils
+{
+	/// bytes allocated by a dense Eigen matrix
+	template <typename Derived>
+	size_t memory_usage(const Eigen::PlainObjectBase<Derived> &mat)
+	{
+		return mat.size() * sizeof(typename Derived::Scalar);
+	}
+
+	/// bytes allocated by a sparse Eigen matrix
+	template <typename Scalar, int Options, typename StorageIndex>
+	size_t memory_usage(const Eigen::SparseMatrix<Scalar, Options, StorageIndex> &mat)
+	{
+		size_t bytes = mat.data().allocatedSize() * (sizeof(Scalar) + sizeof(StorageIndex));
+		if (mat.outerSize() > 0)
+			bytes += (mat.outerSize() + 1) * sizeof(StorageIndex);
+		if (!mat.isCompressed())
+			bytes += mat.outerSize() * sizeof(StorageIndex);
+		return bytes;
+	}
+
+	/// bytes allocated by a vector of trivial values, the allocations of the values are not included
+	template <typename T>
+	size_t memory_usage(const std::vector<T> &vec)
+	{
+		return vec.capacity() * sizeof(T);
+	}
+
+	/// bytes allocated by the collisions of a collision set
+	size_t memory_usage(const ipc::Collisions &collisions);
+	size_t memory_usage(const ipc::FrictionCollisions &collisions);
+
+	/// Memory used by every subsystem, and its peak over the recorded values
+	class MemoryStats
+	{
+	public:
+		/// @brief records the current memory of a subsystem
+		/// @param[in] name name of the subsystem
+		/// @param[in] bytes memory used in bytes
+		void record(const std::string &name, const size_t bytes);
+
+		/// @brief current and peak memory of a subsystem
+		/// @param[in] name name of the subsystem
+		size_t current(const std::string &name) const;
+		size_t peak(const std::string &name) const;
+
+		/// removes all the records
+		void clear() { usage_.clear(); }
+		bool empty() const { return usage_.empty(); }
+
+		/// @brief MB used by every subsystem, and the current and peak RSS of the process
+		/// @return {"subsystems": {name: {"current", "peak"}}, "current_rss", "peak_rss"}
+		nlohmann::json to_json() const;
+
+		/// logs the current and peak memory of every subsystem
+		void log() const;
+
+	private:
+		/// current and peak bytes of every subsystem
+		std::map<std::string, std::pair<size_t, size_t>> usage_;
+	};
+} // namespace polyfem::utils
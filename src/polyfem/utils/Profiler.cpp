@@ -0,0 +1,250 @@
+#include "Profiler.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <fstream>
+#include <map>
+#include <unordered_map>
+
+namespace polyfem::utils
+{
+	namespace
+	{
+		/// maximum number of trace events kept per thread, the call trees are always complete
+		constexpr size_t MAX_TRACE_EVENTS = 1 << 20;
+
+		struct MergedNode
+		{
+			double time = 0;
+			size_t count = 0;
+			std::map<std::string, MergedNode> children;
+		};
+
+		nlohmann::json merged_to_json(const MergedNode &node)
+		{
+			nlohmann::json children = nlohmann::json::array();
+			for (const auto &[name, child] : node.children)
+			{
+				children.push_back({
+					{"name", name},
+					{"time", child.time},
+					{"count", child.count},
+					{"children", merged_to_json(child)},
+				});
+			}
+			return children;
+		}
+	} // namespace
+
+	struct Profiler::ThreadData
+	{
+		struct Node
+		{
+			std::string name;
+			int parent;
+			std::vector<int> children;
+			double time = 0;
+			size_t count = 0;
+		};
+
+		struct Event
+		{
+			int node;
+			int64_t start;
+			int64_t end;
+		};
+
+		explicit ThreadData(const int id)
+			: id(id)
+		{
+			reset();
+		}
+
+		void reset()
+		{
+			nodes.assign(1, Node{"", -1});
+			stack.clear();
+			events.clear();
+			counters.clear();
+			dropped_events = 0;
+		}
+
+		int child(const int parent, const std::string &name)
+		{
+			for (const int c : nodes[parent].children)
+			{
+				if (nodes[c].name == name)
+					return c;
+			}
+
+			nodes.push_back(Node{name, parent});
+			const int c = int(nodes.size()) - 1;
+			nodes[parent].children.push_back(c);
+			return c;
+		}
+
+		void merge(const int node, MergedNode &out) const
+		{
+			for (const int c : nodes[node].children)
+			{
+				MergedNode &merged = out.children[nodes[c].name];
+				merged.time += nodes[c].time;
+				merged.count += nodes[c].count;
+				merge(c, merged);
+			}
+		}
+
+		const int id;
+		/// call tree, the first node is the root
+		std::vector<Node> nodes;
+		/// open zones and their start times in ns
+		std::vector<std::pair<int, int64_t>> stack;
+		std::vector<Event> events;
+		size_t dropped_events;
+		std::unordered_map<std::string, int64_t> counters;
+	};
+
+	Profiler &Profiler::instance()
+	{
+		static Profiler profiler;
+		return profiler;
+	}
+
+	Profiler::Profiler()
+		: origin_(std::chrono::steady_clock::now())
+	{
+	}
+
+	Profiler::~Profiler() = default;
+
+	void Profiler::set_enabled(const bool enabled)
+	{
+		enabled_.store(enabled, std::memory_order_relaxed);
+	}
+
+	void Profiler::clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (auto &data : threads_)
+			data->reset();
+		origin_ = std::chrono::steady_clock::now();
+	}
+
+	Profiler::ThreadData &Profiler::thread_data()
+	{
+		// the thread data is owned by the profiler and never freed before it, so the cached pointer stays valid
+		thread_local ThreadData *data = nullptr;
+		if (data == nullptr)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			threads_.push_back(std::make_unique<ThreadData>(int(threads_.size())));
+			data = threads_.back().get();
+		}
+		return *data;
+	}
+
+	void Profiler::begin_zone(const std::string &name)
+	{
+		ThreadData &data = thread_data();
+		const int parent = data.stack.empty() ? 0 : data.stack.back().first;
+		const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin_).count();
+		data.stack.emplace_back(data.child(parent, name), now);
+	}
+
+	void Profiler::end_zone()
+	{
+		ThreadData &data = thread_data();
+		// the zone was opened before the last clear
+		if (data.stack.empty())
+			return;
+
+		const auto [node, start] = data.stack.back();
+		data.stack.pop_back();
+
+		const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin_).count();
+		data.nodes[node].time += (now - start) * 1e-9;
+		++data.nodes[node].count;
+
+		if (data.events.size() < MAX_TRACE_EVENTS)
+			data.events.push_back({node, start, now});
+		else
+			++data.dropped_events;
+	}
+
+	void Profiler::add_counter(const std::string &name, const int64_t value)
+	{
+		thread_data().counters[name] += value;
+	}
+
+	nlohmann::json Profiler::to_json() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		MergedNode root;
+		std::map<std::string, int64_t> counters;
+		for (const auto &data : threads_)
+		{
+			data->merge(0, root);
+			for (const auto &[name, value] : data->counters)
+				counters[name] += value;
+		}
+
+		nlohmann::json j;
+		j["zones"] = merged_to_json(root);
+		j["counters"] = counters;
+		return j;
+	}
+
+	void Profiler::save_chrome_trace(const std::string &path) const
+	{
+		std::ofstream out(path);
+		if (!out.is_open())
+		{
+			logger().error("Unable to save the profiler trace to {}", path);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		nlohmann::json events = nlohmann::json::array();
+		std::map<std::string, int64_t> counters;
+		size_t dropped_events = 0;
+		for (const auto &data : threads_)
+		{
+			events.push_back({
+				{"name", "thread_name"},
+				{"ph", "M"},
+				{"pid", 0},
+				{"tid", data->id},
+				{"args", {{"name", fmt::format("thread {}", data->id)}}},
+			});
+
+			for (const auto &e : data->events)
+			{
+				events.push_back({
+					{"name", data->nodes[e.node].name},
+					{"ph", "X"},
+					{"pid", 0},
+					{"tid", data->id},
+					{"ts", e.start * 1e-3},
+					{"dur", (e.end - e.start) * 1e-3},
+				});
+			}
+
+			for (const auto &[name, value] : data->counters)
+				counters[name] += value;
+			dropped_events += data->dropped_events;
+		}
+
+		if (dropped_events > 0)
+			logger().warn("The profiler trace is missing {} zones, the maximum is {} per thread", dropped_events, MAX_TRACE_EVENTS);
+
+		nlohmann::json trace;
+		trace["traceEvents"] = events;
+		trace["displayTimeUnit"] = "ms";
+		trace["otherData"] = {{"counters", counters}};
+		out << trace.dump() << std::endl;
+	}
+} // namespace polyfem::utils
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define POLYFEM_PROFILE_ZONE(name) polyfem::utils::ProfileZone __polyfem_profile_zone(name)
+
+#define POLYFEM_PROFILE_COUNTER(name, value)                               \
+	do                                                                     \
+	{                                                                      \
+		if (polyfem::utils::Profiler::instance().enabled())                \
+			polyfem::utils::Profiler::instance().add_counter(name, value); \
+	} while (0)
+
+namespace polyfem::utils
+{
+	/// Hierarchical profiler recording named zones and counters for every thread.
+	/// Every thread keeps its own call tree and trace, so recording does not lock;
+	/// when disabled, a zone costs one relaxed atomic load.
+	class Profiler
+	{
+	public:
+		static Profiler &instance();
+
+		/// enables or disables the recording, the recorded data is kept
+		void set_enabled(const bool enabled);
+		bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+		/// discards the recorded data, must not be called while zones are open
+		void clear();
+
+		/// opens a zone nested in the current zone of the calling thread
+		void begin_zone(const std::string &name);
+		/// closes the current zone of the calling thread
+		void end_zone();
+
+		/// adds value to the counter of the calling thread
+		void add_counter(const std::string &name, const int64_t value);
+
+		/// @brief call trees of all threads merged by zone path, and the total of the counters
+		/// @return {"zones": [{"name", "time", "count", "children"}], "counters": {name: value}}
+		nlohmann::json to_json() const;
+
+		/// @brief saves the recorded zones in the Chrome trace event format (readable by Perfetto)
+		/// @param[in] path output path
+		void save_chrome_trace(const std::string &path) const;
+
+	private:
+		struct ThreadData;
+
+		Profiler();
+		~Profiler();
+
+		ThreadData &thread_data();
+
+		std::atomic<bool> enabled_ = false;
+		std::chrono::steady_clock::time_point origin_;
+
+		mutable std::mutex mutex_;
+		std::vector<std::unique_ptr<ThreadData>> threads_;
+	};
+
+	/// Scoped profiler zone, does nothing if the profiler is disabled when it is created
+	class ProfileZone
+	{
+	public:
+		ProfileZone(const char *name)
+			: active_(Profiler::instance().enabled())
+		{
+			if (active_)
+				Profiler::instance().begin_zone(name);
+		}
+
+		ProfileZone(const std::string &name)
+			: active_(Profiler::instance().enabled())
+		{
+			if (active_)
+				Profiler::instance().begin_zone(name);
+		}
+
+		~ProfileZone()
+		{
+			if (active_)
+				Profiler::instance().end_zone();
+		}
+
+		ProfileZone(const ProfileZone &) = delete;
+		ProfileZone &operator=(const ProfileZone &) = delete;
+
+	private:
+		bool active_;
+	};
+} // namespace polyfem::utils
@@ -1,6 +1,12 @@
 #include "RBFInterpolation.hpp"
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -40,6 +46,12 @@ namespace polyfem
 				rbf_pum::init(pointscl, functioncl, data_[i], verbose_, rbfcl_, opt_, unit_cube_, num_threads_);
 			}
 #else
+			if (rbf == "wendland")
+			{
+				init_compact(fun, pts, eps);
+				return;
+			}
+
 			std::function<double(double)> tmp;
 
 			if (rbf == "multiquadric")
@@ -79,6 +91,16 @@ namespace polyfem
 			}
 
 			init(fun, pts, tmp);
+
+			if (rbf == "gaussian" && weights_.size() > 0)
+			{
+				// drop the centers whose contribution is below a relative 1e-14 even if all of them are dropped
+				const double max_fun = std::max(fun.cwiseAbs().maxCoeff(), 1e-300);
+				const double sum_weights = weights_.cwiseAbs().colwise().sum().maxCoeff();
+				const double phi_tol = 1e-14 * max_fun / std::max(sum_weights, 1e-300);
+				if (phi_tol < 1)
+					build_grid(eps * std::sqrt(-std::log(phi_tol)));
+			}
 #endif
 		}
 
@@ -101,6 +123,8 @@ namespace polyfem
 
 			rbf_ = rbf;
 			centers_ = pts;
+			cutoff_ = -1;
+			grid_cells_.clear();
 
 			const int n = centers_.rows();
 
@@ -152,18 +176,162 @@ namespace polyfem
 			const int n = centers_.rows();
 			const int m = pts.rows();
 
-			Eigen::MatrixXd mat(m, n);
-			for (int i = 0; i < m; ++i)
-			{
-				for (int j = 0; j < n; ++j)
+			// every point is independent, the m x n kernel matrix is never formed
+			Eigen::MatrixXd res = Eigen::MatrixXd::Zero(m, weights_.cols());
+			maybe_parallel_for(m, [&](int start, int end, int thread_id) {
+				std::vector<int> candidates;
+				for (int i = start; i < end; ++i)
 				{
-					mat(i, j) = rbf_((centers_.row(j) - pts.row(i)).norm());
-				}
-			}
+					if (cutoff_ < 0)
+					{
+						for (int j = 0; j < n; ++j)
+							res.row(i) += rbf_((centers_.row(j) - pts.row(i)).norm()) * weights_.row(j);
+						continue;
+					}
 
-			const Eigen::MatrixXd res = mat * weights_;
+					grid_candidates(pts.row(i), candidates);
+					for (const int j : candidates)
+					{
+						const double r = (centers_.row(j) - pts.row(i)).norm();
+						if (r < cutoff_)
+							res.row(i) += rbf_(r) * weights_.row(j);
+					}
+				}
+			});
 #endif
 			return res;
 		}
+
+#ifndef POLYFEM_OPENCL
+		void RBFInterpolation::init_compact(const Eigen::MatrixXd &fun, const Eigen::MatrixXd &pts, const double support)
+		{
+			assert(pts.rows() == fun.rows());
+			assert(support > 0);
+
+			rbf_ = [support](const double r) {
+				const double s = r / support;
+				return s >= 1 ? 0. : std::pow(1 - s, 4) * (4 * s + 1);
+			};
+			centers_ = pts;
+			cutoff_ = -1;
+			grid_cells_.clear();
+			build_grid(support);
+
+			const int n = centers_.rows();
+			std::vector<std::vector<std::pair<int, double>>> rows(n);
+			maybe_parallel_for(n, [&](int start, int end, int thread_id) {
+				std::vector<int> candidates;
+				for (int i = start; i < end; ++i)
+				{
+					grid_candidates(centers_.row(i), candidates);
+					for (const int j : candidates)
+					{
+						const double r = (centers_.row(j) - centers_.row(i)).norm();
+						if (r < support)
+							rows[i].emplace_back(j, rbf_(r));
+					}
+				}
+			});
+
+			std::vector<Eigen::Triplet<double>> entries;
+			for (int i = 0; i < n; ++i)
+				for (const auto &[j, val] : rows[i])
+					entries.emplace_back(i, j, val);
+
+			Eigen::SparseMatrix<double> A(n, n);
+			A.setFromTriplets(entries.begin(), entries.end());
+
+			Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(A);
+			if (solver.info() != Eigen::Success)
+				log_and_throw_error("Unable to factorize the compactly supported RBF system");
+			weights_ = solver.solve(fun);
+		}
+
+		void RBFInterpolation::build_grid(const double cutoff)
+		{
+			const int dim = centers_.cols();
+			if (dim == 0 || centers_.rows() == 0 || !std::isfinite(cutoff))
+				return;
+
+			grid_min_ = centers_.colwise().minCoeff();
+			const Eigen::RowVectorXd extent = centers_.colwise().maxCoeff() - grid_min_;
+
+			// cells narrower than the cutoff would miss centers, wider ones only cost more distance checks
+			cell_size_ = cutoff;
+			const double max_cells = 4.0 * centers_.rows();
+			while (true)
+			{
+				double n_cells = 1;
+				for (int d = 0; d < dim; ++d)
+					n_cells *= std::floor(extent(d) / cell_size_) + 1;
+				if (n_cells <= max_cells)
+					break;
+				cell_size_ *= 2;
+			}
+
+			grid_dims_.resize(dim);
+			long n_cells = 1;
+			for (int d = 0; d < dim; ++d)
+			{
+				grid_dims_(d) = int(std::floor(extent(d) / cell_size_)) + 1;
+				n_cells *= grid_dims_(d);
+			}
+
+			grid_cells_.assign(n_cells, {});
+			for (int j = 0; j < centers_.rows(); ++j)
+				grid_cells_[grid_cell(centers_.row(j))].push_back(j);
+
+			cutoff_ = cutoff;
+		}
+
+		long RBFInterpolation::grid_cell(const Eigen::RowVectorXd &pt) const
+		{
+			long idx = 0, stride = 1;
+			for (int d = 0; d < grid_dims_.size(); ++d)
+			{
+				const int c = std::clamp(int(std::floor((pt(d) - grid_min_(d)) / cell_size_)), 0, grid_dims_(d) - 1);
+				idx += c * stride;
+				stride *= grid_dims_(d);
+			}
+			return idx;
+		}
+
+		void RBFInterpolation::grid_candidates(const Eigen::RowVectorXd &pt, std::vector<int> &candidates) const
+		{
+			candidates.clear();
+			const int dim = grid_dims_.size();
+			if (dim == 0)
+				return;
+
+			Eigen::RowVectorXi cell(dim);
+			for (int d = 0; d < dim; ++d)
+				cell(d) = int(std::floor((pt(d) - grid_min_(d)) / cell_size_));
+
+			int n_neighbors = 1;
+			for (int d = 0; d < dim; ++d)
+				n_neighbors *= 3;
+
+			for (int k = 0; k < n_neighbors; ++k)
+			{
+				long idx = 0, stride = 1;
+				int code = k;
+				bool inside = true;
+				for (int d = 0; d < dim; ++d)
+				{
+					const int c = cell(d) + code % 3 - 1;
+					code /= 3;
+					if (c < 0 || c >= grid_dims_(d))
+					{
+						inside = false;
+						break;
+					}
+					idx += c * stride;
+					stride *= grid_dims_(d);
+				}
+				if (inside)
+					candidates.insert(candidates.end(), grid_cells_[idx].begin(), grid_cells_[idx].end());
+			}
+		}
+#endif
 	} // namespace utils
 } // namespace polyfem
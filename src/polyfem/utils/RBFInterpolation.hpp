@@ -4,6 +4,7 @@
 
 #include <functional>
 #include <string>
+#include <vector>
 
 #ifdef POLYFEM_OPENCL
 #include <rbf_interpolate.hpp>
@@ -39,6 +40,22 @@ namespace polyfem
 			Eigen::MatrixXd weights_;
 
 			std::function<double(double)> rbf_;
+
+			/// compactly supported Wendland C2 kernel, the interpolation matrix is sparse and positive definite
+			void init_compact(const Eigen::MatrixXd &fun, const Eigen::MatrixXd &pts, const double support);
+
+			/// fast decaying kernels (gaussian) are truncated at cutoff_, the centers are bucketed in a
+			/// uniform grid of cells at least cutoff_ wide so that only the neighboring cells are summed
+			void build_grid(const double cutoff);
+			long grid_cell(const Eigen::RowVectorXd &pt) const;
+			/// centers in the cells around pt, a superset of the ones closer than cutoff_
+			void grid_candidates(const Eigen::RowVectorXd &pt, std::vector<int> &candidates) const;
+
+			double cutoff_ = -1; ///< negative if every center is summed
+			double cell_size_ = 0;
+			Eigen::RowVectorXd grid_min_;
+			Eigen::RowVectorXi grid_dims_;
+			std::vector<std::vector<int>> grid_cells_;
 #endif
 		};
 	} // namespace utils
@@ -207,6 +207,7 @@ namespace polyfem
 #ifndef NDEBUG
 			area_param_ *= 10.0;
 #endif
+			element_sampling_.clear();
 
 			build();
 		}
@@ -282,27 +283,6 @@ namespace polyfem
 						0, 1, 1;
 				}
 				{
-					MatrixXd pts(4, 3);
-					pts << 0, 0, 0,
-						1, 0, 0,
-						0, 1, 0,
-						0, 0, 1;
-
-					Eigen::MatrixXi faces(4, 3);
-					faces << 0, 1, 2,
-
-						3, 1, 0,
-						2, 1, 3,
-						0, 2, 3;
-
-					regular_3d_grid(std::max(2., round(1. / pow(area_param_, 1. / 3.) + 1)), true, simplex_points_, simplex_faces_, simplex_tets_);
-
-					// Extract sampled edges matching the base element edges
-					Eigen::MatrixXi edges;
-					igl::edges(faces, edges);
-					igl::edges(simplex_faces_, simplex_edges_);
-					extract_parent_edges(simplex_points_, simplex_edges_, pts, edges, simplex_edges_);
-
 					// Same local order as in FEMBasis3d
 					simplex_corners_.resize(4, 3);
 					simplex_corners_ << 0, 0, 0,
@@ -340,22 +320,6 @@ namespace polyfem
 						0, 1;
 				}
 				{
-					MatrixXd pts(3, 2);
-					pts << 0, 0,
-						0, 1,
-						1, 0;
-
-					MatrixXi E(3, 2);
-					E << 0, 1,
-						1, 2,
-						2, 0;
-
-					regular_2d_grid(std::max(2., round(1. / sqrt(area_param_) + 1)), true, simplex_points_, simplex_faces_);
-
-					// Extract sampled edges matching the base element edges
-					igl::edges(simplex_faces_, simplex_edges_);
-					extract_parent_edges(simplex_points_, simplex_edges_, pts, E, simplex_edges_);
-
 					// Same local order as in FEMBasis2d
 					simplex_corners_.resize(3, 2);
 					simplex_corners_ << 0, 0,
@@ -363,6 +327,74 @@ namespace polyfem
 						0, 1;
 				}
 			}
+
+			const int n = num_samples();
+			build_simplex(n, uniform_simplex_);
+			build_simplex(2, linear_simplex_);
+			build_simplex(2 * n - 1, curved_simplex_);
+		}
+
+		void RefElementSampler::build_simplex(const int n, SimplexSamples &samples) const
+		{
+			using namespace Eigen;
+
+			if (is_volume_)
+			{
+				MatrixXd pts(4, 3);
+				pts << 0, 0, 0,
+					1, 0, 0,
+					0, 1, 0,
+					0, 0, 1;
+
+				Eigen::MatrixXi faces(4, 3);
+				faces << 0, 1, 2,
+
+					3, 1, 0,
+					2, 1, 3,
+					0, 2, 3;
+
+				regular_3d_grid(n, true, samples.points, samples.faces, samples.tets);
+
+				// Extract sampled edges matching the base element edges
+				Eigen::MatrixXi edges;
+				igl::edges(faces, edges);
+				igl::edges(samples.faces, samples.edges);
+				extract_parent_edges(samples.points, samples.edges, pts, edges, samples.edges);
+			}
+			else
+			{
+				MatrixXd pts(3, 2);
+				pts << 0, 0,
+					0, 1,
+					1, 0;
+
+				MatrixXi E(3, 2);
+				E << 0, 1,
+					1, 2,
+					2, 0;
+
+				regular_2d_grid(n, true, samples.points, samples.faces);
+
+				// Extract sampled edges matching the base element edges
+				igl::edges(samples.faces, samples.edges);
+				extract_parent_edges(samples.points, samples.edges, pts, E, samples.edges);
+			}
+		}
+
+		const RefElementSampler::SimplexSamples &RefElementSampler::simplex_samples(const int element) const
+		{
+			if (element < 0 || element >= int(element_sampling_.size()))
+				return uniform_simplex_;
+
+			switch (element_sampling_[element])
+			{
+			case Sampling::LINEAR:
+				return linear_simplex_;
+			case Sampling::CURVED:
+				return curved_simplex_;
+			default:
+				return uniform_simplex_;
+			}
 		}
 
 		void RefElementSampler::sample_polygon(const Eigen::MatrixXd &poly, Eigen::MatrixXd &pts, Eigen::MatrixXi &faces, Eigen::MatrixXi &edges) const
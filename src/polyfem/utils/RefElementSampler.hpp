@@ -2,6 +2,8 @@
 
 #include <Eigen/Dense>
 
+#include <vector>
+
 namespace polyfem
 {
 	namespace utils
@@ -30,9 +32,21 @@ namespace polyfem
 		class RefElementSampler
 		{
 		public:
+			/// Sampling of a simplex: its corners only, the uniform sampling, or twice as fine along each direction
+			enum class Sampling
+			{
+				LINEAR,
+				UNIFORM,
+				CURVED
+			};
+
 			RefElementSampler() {}
 			void init(const bool is_volume, const int n_elements, const double target_rel_area);
 
+			/// per element sampling of the simplices, elements not listed use the uniform one
+			void set_element_sampling(const std::vector<Sampling> &element_sampling) { element_sampling_ = element_sampling; }
+			void clear_element_sampling() { element_sampling_.clear(); }
+
 			const Eigen::MatrixXd &cube_corners() const { return cube_corners_; }
 			const Eigen::MatrixXd &cube_points() const { return cube_points_; }
 			const Eigen::MatrixXi &cube_faces() const { return cube_faces_; }
@@ -40,10 +54,15 @@ namespace polyfem
 			const Eigen::MatrixXi &cube_edges() const { return cube_edges_; }
 
 			const Eigen::MatrixXd &simplex_corners() const { return simplex_corners_; }
-			const Eigen::MatrixXd &simplex_points() const { return simplex_points_; }
-			const Eigen::MatrixXi &simplex_faces() const { return simplex_faces_; }
-			const Eigen::MatrixXi &simplex_volume() const { return is_volume_ ? simplex_tets_ : simplex_faces_; }
-			const Eigen::MatrixXi &simplex_edges() const { return simplex_edges_; }
+			const Eigen::MatrixXd &simplex_points() const { return uniform_simplex_.points; }
+			const Eigen::MatrixXi &simplex_faces() const { return uniform_simplex_.faces; }
+			const Eigen::MatrixXi &simplex_volume() const { return is_volume_ ? uniform_simplex_.tets : uniform_simplex_.faces; }
+			const Eigen::MatrixXi &simplex_edges() const { return uniform_simplex_.edges; }
+
+			const Eigen::MatrixXd &simplex_points(const int element) const { return simplex_samples(element).points; }
+			const Eigen::MatrixXi &simplex_faces(const int element) const { return simplex_samples(element).faces; }
+			const Eigen::MatrixXi &simplex_volume(const int element) const { return is_volume_ ? simplex_samples(element).tets : simplex_samples(element).faces; }
+			const Eigen::MatrixXi &simplex_edges(const int element) const { return simplex_samples(element).edges; }
 
 			void sample_polygon(const Eigen::MatrixXd &poly, Eigen::MatrixXd &pts, Eigen::MatrixXi &faces, Eigen::MatrixXi &edges) const;
 			void sample_polyhedron(const Eigen::MatrixXd &vertices, const Eigen::MatrixXi &f, Eigen::MatrixXd &pts, Eigen::MatrixXi &faces, Eigen::MatrixXi &edges) const;
@@ -54,10 +73,20 @@ namespace polyfem
 			}
 
 		private:
+			struct SimplexSamples
+			{
+				Eigen::MatrixXd points;
+				Eigen::MatrixXi faces;
+				Eigen::MatrixXi tets;
+				Eigen::MatrixXi edges;
+			};
+
 			void build();
+			/// samples the reference simplex with an n x n (x n) grid
+			void build_simplex(const int n, SimplexSamples &samples) const;
+			const SimplexSamples &simplex_samples(const int element) const;
 
 			Eigen::MatrixXi cube_tets_;
-			Eigen::MatrixXi simplex_tets_;
 
 			Eigen::MatrixXd cube_corners_;
 			Eigen::MatrixXd cube_points_;
@@ -65,9 +94,10 @@ namespace polyfem
 			Eigen::MatrixXi cube_edges_;
 
 			Eigen::MatrixXd simplex_corners_;
-			Eigen::MatrixXd simplex_points_;
-			Eigen::MatrixXi simplex_faces_;
-			Eigen::MatrixXi simplex_edges_;
+			SimplexSamples uniform_simplex_;
+			SimplexSamples linear_simplex_;
+			SimplexSamples curved_simplex_;
+			std::vector<Sampling> element_sampling_;
 
 			double area_param_;
 			double is_volume_;
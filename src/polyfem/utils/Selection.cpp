@@ -4,6 +4,7 @@
 #include <polyfem/utils/Types.hpp>
 #include <polyfem/utils/JSONUtils.hpp>
 #include <polyfem/utils/StringUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <polyfem/io/MatrixIO.hpp>
 
@@ -74,6 +75,75 @@ namespace polyfem::utils
 		return selections;
 	}
 
+	void Selection::inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const
+	{
+		for (int i = start; i < end; ++i)
+			result[i] = inside(i, vs[i], ps.row(i));
+	}
+
+	std::vector<int> Selection::compute_ids(
+		const std::vector<std::shared_ptr<Selection>> &selections,
+		const std::vector<std::vector<int>> &vs,
+		const Eigen::MatrixXd &ps,
+		const std::vector<char> &active,
+		const int default_id)
+	{
+		const int n = ps.rows();
+		assert(vs.size() == n && active.size() == n);
+
+		std::vector<BBox> boxes(selections.size());
+		std::vector<bool> bounded(selections.size());
+		for (int s = 0; s < selections.size(); ++s)
+			bounded[s] = selections[s]->bbox(boxes[s]);
+
+		// blocks of nearby primitives skip the selections whose box they miss
+		constexpr int block_size = 256;
+
+		std::vector<int> ids(n, -1);
+		std::vector<char> result(n, 0), assigned(n, 0);
+		maybe_parallel_for(n, [&](int start, int end, int thread_id) {
+			for (int block_start = start; block_start < end; block_start += block_size)
+			{
+				const int block_end = std::min(block_start + block_size, end);
+
+				int n_left = 0;
+				for (int i = block_start; i < block_end; ++i)
+					n_left += active[i];
+				if (n_left == 0)
+					continue;
+
+				const RowVectorNd block_min = ps.middleRows(block_start, block_end - block_start).colwise().minCoeff();
+				const RowVectorNd block_max = ps.middleRows(block_start, block_end - block_start).colwise().maxCoeff();
+
+				for (int s = 0; s < selections.size() && n_left > 0; ++s)
+				{
+					if (bounded[s]
+						&& ((block_max.array() < boxes[s][0].array()).any() || (block_min.array() > boxes[s][1].array()).any()))
+						continue;
+
+					selections[s]->inside_range(vs, ps, block_start, block_end, result);
+					for (int i = block_start; i < block_end; ++i)
+					{
+						if (active[i] && !assigned[i] && result[i])
+						{
+							ids[i] = selections[s]->id(i, vs[i], ps.row(i));
+							assigned[i] = 1;
+							--n_left;
+						}
+					}
+				}
+
+				for (int i = block_start; i < block_end; ++i)
+				{
+					if (active[i] && !assigned[i])
+						ids[i] = default_id;
+				}
+			}
+		});
+
+		return ids;
+	}
+
 	// ------------------------------------------------------------------------
 
 	BoxSelection::BoxSelection(
@@ -115,6 +185,21 @@ namespace polyfem::utils
 		return inside;
 	}
 
+	void BoxSelection::inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const
+	{
+		const auto block = ps.middleRows(start, end - start).array();
+		const Eigen::Array<bool, Eigen::Dynamic, 1> in = (block.rowwise() - bbox_[0].array()).rowwise().minCoeff() >= 0
+														 && (block.rowwise() - bbox_[1].array()).rowwise().maxCoeff() <= 0;
+		for (int i = start; i < end; ++i)
+			result[i] = in(i - start);
+	}
+
+	bool BoxSelection::bbox(BBox &box) const
+	{
+		box = bbox_;
+		return true;
+	}
+
 	// ------------------------------------------------------------------------
 
 	BoxSideSelection::BoxSideSelection(
@@ -180,6 +265,21 @@ namespace polyfem::utils
 		return (p - center_).squaredNorm() <= radius2_;
 	}
 
+	void SphereSelection::inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const
+	{
+		const Eigen::ArrayXd dist2 = (ps.middleRows(start, end - start).rowwise() - center_).rowwise().squaredNorm();
+		for (int i = start; i < end; ++i)
+			result[i] = dist2(i - start) <= radius2_;
+	}
+
+	bool SphereSelection::bbox(BBox &box) const
+	{
+		const double radius = std::sqrt(radius2_);
+		box[0] = center_.array() - radius;
+		box[1] = center_.array() + radius;
+		return true;
+	}
+
 	// ------------------------------------------------------------------------
 
 	CylinderSelection::CylinderSelection(
@@ -221,6 +321,24 @@ namespace polyfem::utils
 		return (v - axis_ * proj).squaredNorm() <= radius2_;
 	}
 
+	void CylinderSelection::inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const
+	{
+		const Eigen::MatrixXd v = ps.middleRows(start, end - start).rowwise() - point_;
+		const Eigen::VectorXd proj = v * axis_.transpose();
+		const Eigen::ArrayXd dist2 = (v - proj * axis_).rowwise().squaredNorm();
+		for (int i = start; i < end; ++i)
+			result[i] = proj(i - start) >= 0 && proj(i - start) <= height_ && dist2(i - start) <= radius2_;
+	}
+
+	bool CylinderSelection::bbox(BBox &box) const
+	{
+		const double radius = std::sqrt(radius2_);
+		const RowVectorNd p2 = point_ + height_ * axis_;
+		box[0] = point_.cwiseMin(p2).array() - radius;
+		box[1] = point_.cwiseMax(p2).array() + radius;
+		return true;
+	}
+
 	// ------------------------------------------------------------------------
 
 	AxisPlaneSelection::AxisPlaneSelection(
@@ -262,6 +380,14 @@ namespace polyfem::utils
 			return v <= position_;
 	}
 
+	void AxisPlaneSelection::inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const
+	{
+		const auto v = ps.col(std::abs(axis_) - 1).segment(start, end - start).array();
+		const Eigen::Array<bool, Eigen::Dynamic, 1> in = axis_ > 0 ? (v >= position_).eval() : (v <= position_).eval();
+		for (int i = start; i < end; ++i)
+			result[i] = in(i - start);
+	}
+
 	// ------------------------------------------------------------------------
 
 	PlaneSelection::PlaneSelection(
@@ -288,6 +414,13 @@ namespace polyfem::utils
 		return pp.dot(normal_) >= 0;
 	}
 
+	void PlaneSelection::inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const
+	{
+		const Eigen::VectorXd dist = (ps.middleRows(start, end - start).rowwise() - point_) * normal_.transpose();
+		for (int i = start; i < end; ++i)
+			result[i] = dist(i - start) >= 0;
+	}
+
 	// ------------------------------------------------------------------------
 
 	SpecifiedSelection::SpecifiedSelection(
@@ -323,18 +456,15 @@ namespace polyfem::utils
 		}
 		else
 		{
-			data_.resize(mat.rows());
-
 			for (int i = 0; i < mat.rows(); ++i)
 			{
-				data_[i].first = mat(i, 0) + id_offset;
-
+				std::vector<int> vs(mat.cols() - 1);
 				for (int j = 1; j < mat.cols(); ++j)
-				{
-					data_[i].second.push_back(mat(i, j));
-				}
+					vs[j - 1] = mat(i, j);
+				std::sort(vs.begin(), vs.end());
 
-				std::sort(data_[i].second.begin(), data_[i].second.end());
+				// the first row of repeated vertices wins
+				data_.emplace(std::move(vs), mat(i, 0) + id_offset);
 			}
 		}
 	}
@@ -344,13 +474,19 @@ namespace polyfem::utils
 		if (data_.empty())
 			return SpecifiedSelection::inside(p_id, vs, p);
 
-		std::vector<int> tmp;
-		for (const auto &t : data_)
+		return data_.find(vs) != data_.end();
+	}
+
+	void FileSelection::inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const
+	{
+		if (data_.empty())
 		{
-			if (t.second == vs)
-				return true;
+			SpecifiedSelection::inside_range(vs, ps, start, end, result);
+			return;
 		}
-		return false;
+
+		for (int i = start; i < end; ++i)
+			result[i] = data_.find(vs[i]) != data_.end();
 	}
 
 	int FileSelection::id(const size_t element_id, const std::vector<int> &vs, const RowVectorNd &p) const
@@ -358,12 +494,7 @@ namespace polyfem::utils
 		if (data_.empty())
 			return SpecifiedSelection::id(element_id, vs, p);
 
-		std::vector<int> tmp;
-		for (const auto &t : data_)
-		{
-			if (t.second == vs)
-				return t.first;
-		}
-		return -1;
+		const auto it = data_.find(vs);
+		return it != data_.end() ? it->second : -1;
 	}
 } // namespace polyfem::utils
@@ -3,6 +3,9 @@
 #include <polyfem/mesh/Mesh.hpp>
 #include <polyfem/Common.hpp>
 
+#include <algorithm>
+#include <map>
+
 namespace polyfem
 {
 	namespace utils
@@ -18,11 +21,38 @@ namespace polyfem
 
 			virtual bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const = 0;
 
+			/// @brief Tests the primitives start to end - 1 at once, the default calls inside on each of them.
+			/// @param vs     Sorted vertices of every primitive (primitive ids are the indices).
+			/// @param ps     Barycenter of every primitive, one per row.
+			/// @param start  First primitive to test.
+			/// @param end    One past the last primitive to test.
+			/// @param result 1 if the primitive is inside, only the entries in [start, end) are written.
+			virtual void inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const;
+
+			/// @brief Bounding box of the selected region.
+			/// @param box Bounding box.
+			/// @return False if the region is unbounded.
+			virtual bool bbox(BBox &box) const { return false; }
+
 			virtual int id(const size_t element_id, const std::vector<int> &vs, const RowVectorNd &p) const
 			{
 				return id_;
 			}
 
+			/// @brief Id of the first selection containing every primitive, computed in parallel over blocks of primitives.
+			/// @param selections Selections by decreasing priority.
+			/// @param vs         Sorted vertices of every primitive.
+			/// @param ps         Barycenter of every primitive, one per row.
+			/// @param active     Primitives to label, the others get -1.
+			/// @param default_id Id of the active primitives outside all selections.
+			/// @return One id per primitive.
+			static std::vector<int> compute_ids(
+				const std::vector<std::shared_ptr<Selection>> &selections,
+				const std::vector<std::vector<int>> &vs,
+				const Eigen::MatrixXd &ps,
+				const std::vector<char> &active,
+				const int default_id);
+
 			/// @brief Build a selection objects from a JSON selection.
 			/// @param j_selections JSON object of selection(s).
 			/// @param mesh_bbox    Bounding box of the mesh.
@@ -59,6 +89,8 @@ namespace polyfem
 				const BBox &mesh_bbox);
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
+			void inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const override;
+			bool bbox(BBox &box) const override;
 
 		protected:
 			BBox bbox_;
@@ -77,6 +109,10 @@ namespace polyfem
 			{
 				return true;
 			}
+			void inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const override
+			{
+				std::fill(result.begin() + start, result.begin() + end, 1);
+			}
 
 			int id(const size_t element_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
 
@@ -96,6 +132,8 @@ namespace polyfem
 				const BBox &mesh_bbox);
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
+			void inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const override;
+			bool bbox(BBox &box) const override;
 
 		protected:
 			RowVectorNd center_;
@@ -112,6 +150,8 @@ namespace polyfem
 				const BBox &mesh_bbox);
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
+			void inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const override;
+			bool bbox(BBox &box) const override;
 
 		protected:
 			RowVectorNd axis_;
@@ -130,6 +170,7 @@ namespace polyfem
 				const BBox &mesh_bbox);
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
+			void inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const override;
 
 		protected:
 			int axis_;
@@ -146,6 +187,7 @@ namespace polyfem
 				const BBox &mesh_bbox);
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
+			void inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const override;
 
 		protected:
 			RowVectorNd normal_;
@@ -161,6 +203,10 @@ namespace polyfem
 				: Selection(id) {}
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override { return true; }
+			void inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const override
+			{
+				std::fill(result.begin() + start, result.begin() + end, 1);
+			}
 		};
 
 		// --------------------------------------------------------------------
@@ -172,6 +218,10 @@ namespace polyfem
 				const std::vector<int> &ids);
 
 			virtual bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override { return true; }
+			virtual void inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const override
+			{
+				std::fill(result.begin() + start, result.begin() + end, 1);
+			}
 
 			virtual int id(const size_t element_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
 
@@ -191,10 +241,12 @@ namespace polyfem
 				const int id_offset = 0);
 
 			bool inside(const size_t p_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
+			void inside_range(const std::vector<std::vector<int>> &vs, const Eigen::MatrixXd &ps, const int start, const int end, std::vector<char> &result) const override;
 			int id(const size_t element_id, const std::vector<int> &vs, const RowVectorNd &p) const override;
 
 		private:
-			std::vector<std::pair<int, std::vector<int>>> data_;
+			/// id of each sorted list of vertices
+			std::map<std::vector<int>, int> data_;
 		};
 	} // namespace utils
 } // namespace polyfem
@@ -0,0 +1,180 @@
+#include "SparseMatrixSpill.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace polyfem::utils
+{
+	namespace
+	{
+		/// rows, cols and nnz, followed by the outer indices, inner indices and values
+		struct Header
+		{
+			int64_t rows;
+			int64_t cols;
+			int64_t nnz;
+		};
+
+		size_t align(const size_t bytes)
+		{
+			return (bytes + 7) & ~size_t(7);
+		}
+
+		size_t serialized_size(const int64_t cols, const int64_t nnz)
+		{
+			return sizeof(Header) + align((cols + 1) * sizeof(StorageIndex)) + align(nnz * sizeof(StorageIndex)) + nnz * sizeof(double);
+		}
+	} // namespace
+
+	SparseMatrixSpill::SparseMatrixSpill(const std::string &path)
+		: path_(path)
+	{
+#ifndef WIN32
+		fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+		if (fd_ < 0)
+			log_and_throw_error("Unable to create the scratch file {}", path);
+#else
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			log_and_throw_error("Unable to create the scratch file {}", path);
+#endif
+	}
+
+	SparseMatrixSpill::~SparseMatrixSpill()
+	{
+#ifndef WIN32
+		if (mapped_)
+			::munmap(const_cast<char *>(mapped_), mapped_size_);
+		if (fd_ >= 0)
+			::close(fd_);
+		::unlink(path_.c_str());
+#else
+		std::remove(path_.c_str());
+#endif
+	}
+
+	void SparseMatrixSpill::write(const int id, const StiffnessMatrix &mat)
+	{
+		assert(id >= 0);
+		StiffnessMatrix compressed;
+		const StiffnessMatrix *m = &mat;
+		if (!mat.isCompressed())
+		{
+			compressed = mat;
+			compressed.makeCompressed();
+			m = &compressed;
+		}
+
+		const Header header{m->rows(), m->cols(), m->nonZeros()};
+		std::vector<char> buffer(serialized_size(header.cols, header.nnz), 0);
+		char *ptr = buffer.data();
+		std::memcpy(ptr, &header, sizeof(Header));
+		ptr += sizeof(Header);
+		std::memcpy(ptr, m->outerIndexPtr(), (header.cols + 1) * sizeof(StorageIndex));
+		ptr += align((header.cols + 1) * sizeof(StorageIndex));
+		std::memcpy(ptr, m->innerIndexPtr(), header.nnz * sizeof(StorageIndex));
+		ptr += align(header.nnz * sizeof(StorageIndex));
+		std::memcpy(ptr, m->valuePtr(), header.nnz * sizeof(double));
+
+		std::lock_guard<std::mutex> lock(mutex_);
+#ifndef WIN32
+		size_t written = 0;
+		while (written < buffer.size())
+		{
+			const ssize_t n = ::pwrite(fd_, buffer.data() + written, buffer.size() - written, file_size_ + written);
+			if (n <= 0)
+				log_and_throw_error("Unable to write to the scratch file {}", path_);
+			written += n;
+		}
+#else
+		std::ofstream file(path_, std::ios::binary | std::ios::app);
+		file.write(buffer.data(), buffer.size());
+		if (!file)
+			log_and_throw_error("Unable to write to the scratch file {}", path_);
+#endif
+
+		if (size_t(id) >= offsets_.size())
+		{
+			offsets_.resize(id + 1, size_t(-1));
+			sizes_.resize(id + 1, 0);
+		}
+		offsets_[id] = file_size_;
+		sizes_[id] = buffer.size();
+		file_size_ += buffer.size();
+	}
+
+	void SparseMatrixSpill::map() const
+	{
+#ifndef WIN32
+		if (mapped_size_ == file_size_)
+			return;
+
+		if (mapped_)
+			::munmap(const_cast<char *>(mapped_), mapped_size_);
+		mapped_ = nullptr;
+		mapped_size_ = 0;
+
+		void *addr = ::mmap(nullptr, file_size_, PROT_READ, MAP_SHARED, fd_, 0);
+		if (addr == MAP_FAILED)
+			log_and_throw_error("Unable to map the scratch file {}", path_);
+		mapped_ = static_cast<const char *>(addr);
+		mapped_size_ = file_size_;
+#endif
+	}
+
+	void SparseMatrixSpill::read(const int id, StiffnessMatrix &mat) const
+	{
+		if (!contains(id))
+			log_and_throw_error("Matrix {} is not in the scratch file {}", id, path_);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+#ifndef WIN32
+		map();
+		const char *ptr = mapped_ + offsets_[id];
+#else
+		std::vector<char> buffer(sizes_[id]);
+		std::ifstream file(path_, std::ios::binary);
+		file.seekg(offsets_[id]);
+		file.read(buffer.data(), buffer.size());
+		if (!file)
+			log_and_throw_error("Unable to read the scratch file {}", path_);
+		const char *ptr = buffer.data();
+#endif
+
+		Header header;
+		std::memcpy(&header, ptr, sizeof(Header));
+		ptr += sizeof(Header);
+		const StorageIndex *outer = reinterpret_cast<const StorageIndex *>(ptr);
+		ptr += align((header.cols + 1) * sizeof(StorageIndex));
+		const StorageIndex *inner = reinterpret_cast<const StorageIndex *>(ptr);
+		ptr += align(header.nnz * sizeof(StorageIndex));
+		const double *values = reinterpret_cast<const double *>(ptr);
+
+		mat = Eigen::Map<const StiffnessMatrix>(header.rows, header.cols, header.nnz, outer, inner, values);
+	}
+
+	void SparseMatrixSpill::prefetch(const int id) const
+	{
+#ifndef WIN32
+		if (!contains(id))
+			return;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		map();
+
+		const size_t page = ::sysconf(_SC_PAGESIZE);
+		const size_t begin = offsets_[id] / page * page;
+		::madvise(const_cast<char *>(mapped_) + begin, offsets_[id] + sizes_[id] - begin, MADV_WILLNEED);
+#endif
+	}
+} // namespace polyfem::utils
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <polyfem/utils/Types.hpp>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace polyfem::utils
+{
+	/// Scratch file of sparse matrices written once and read back through a memory map
+	/// The file is removed when the object is destroyed
+	class SparseMatrixSpill
+	{
+	public:
+		/// @param[in] path scratch file, truncated if it exists
+		SparseMatrixSpill(const std::string &path);
+		~SparseMatrixSpill();
+
+		SparseMatrixSpill(const SparseMatrixSpill &) = delete;
+		SparseMatrixSpill &operator=(const SparseMatrixSpill &) = delete;
+
+		/// @brief appends a matrix to the file
+		/// @param[in] id index of the matrix, overwrites the previous matrix with the same id
+		/// @param[in] mat matrix to write
+		void write(const int id, const StiffnessMatrix &mat);
+
+		/// @brief reads a matrix from the file
+		/// @param[in] id index of the matrix
+		/// @param[out] mat matrix read
+		void read(const int id, StiffnessMatrix &mat) const;
+
+		/// @brief asks the OS to start loading a matrix that will be read soon
+		void prefetch(const int id) const;
+
+		bool contains(const int id) const { return id >= 0 && size_t(id) < offsets_.size() && offsets_[id] != size_t(-1); }
+
+		/// bytes written to the file
+		size_t file_size() const { return file_size_; }
+
+		const std::string &path() const { return path_; }
+
+	private:
+		/// maps the part of the file written so far
+		void map() const;
+
+		std::string path_;
+		std::vector<size_t> offsets_; ///< position of every matrix in the file
+		std::vector<size_t> sizes_;   ///< bytes of every matrix in the file
+		size_t file_size_ = 0;
+
+		int fd_ = -1;
+		mutable std::mutex mutex_;
+		mutable const char *mapped_ = nullptr;
+		mutable size_t mapped_size_ = 0;
+	};
+} // namespace polyfem::utils
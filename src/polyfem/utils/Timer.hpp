@@ -4,6 +4,7 @@
 #include <spdlog/fmt/bundled/color.h>
 #include <polyfem/utils/Logger.hpp>
 // clang-format on
+#include <polyfem/utils/Profiler.hpp>
 
 #include <igl/Timer.h>
 
@@ -72,6 +73,12 @@ namespace polyfem
 
 			inline void start()
 			{
+				// named timers are also zones of the profiler
+				if (!m_name.empty() && !m_in_zone && Profiler::instance().enabled())
+				{
+					Profiler::instance().begin_zone(m_name);
+					m_in_zone = true;
+				}
 				is_running = true;
 				m_timer.start();
 			}
@@ -82,6 +89,11 @@ namespace polyfem
 					return;
 				m_timer.stop();
 				is_running = false;
+				if (m_in_zone)
+				{
+					Profiler::instance().end_zone();
+					m_in_zone = false;
+				}
 				log_msg();
 				if (m_total_time)
 					*m_total_time += getElapsedTimeInSec();
@@ -101,7 +113,7 @@ namespace polyfem
 
 				if (!m_name.empty())
 				{
-					logger().trace(log_fmt_text, m_name, getElapsedTimeInSec());
+					POLYFEM_LOG_TRACE(log_fmt_text, m_name, getElapsedTimeInSec());
 				}
 			}
 
@@ -116,6 +128,7 @@ namespace polyfem
 			double *m_total_time = nullptr;
 			size_t *m_count = nullptr;
 			bool is_running = false;
+			bool m_in_zone = false;
 		};
 	} // namespace utils
 } // namespace polyfem
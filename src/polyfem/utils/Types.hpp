@@ -13,12 +13,24 @@ namespace polyfem
 	typedef Eigen::Matrix<double, 1, Eigen::Dynamic, Eigen::RowMajor, 1, 3> RowVectorNd;
 	typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, 3, 3> MatrixNd;
 
+	// Views of matrices owned by the caller, with arbitrary strides so that interleaved row-major
+	// buffers can be mapped with Eigen::Map and Eigen::Stride without being copied
+	typedef Eigen::Ref<const Eigen::MatrixXd, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>> ConstMatrixXdView;
+	typedef Eigen::Ref<const Eigen::MatrixXi, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>> ConstMatrixXiView;
+	typedef Eigen::Ref<Eigen::MatrixXd, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>> MatrixXdView;
+	typedef Eigen::Ref<Eigen::MatrixXi, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>> MatrixXiView;
+
 	static constexpr int MAX_QUAD_POINTS = -1;
 	typedef Eigen::Matrix<double, Eigen::Dynamic, 1, 0, MAX_QUAD_POINTS, 1> QuadratureVector;
 
+	// Index policy: the nodes, DOFs, elements and local bases are numbered with int. The positions in the
+	// non-zeros of the sparse matrices (their outer and inner indices and the slots of the value buffers
+	// of the assembly caches) are StorageIndex: 32-bit by default, to halve the index traffic, and 64-bit
+	// when built with POLYFEM_LARGE_INDEX (which turns on POLYSOLVE_LARGE_INDEX) for more than 2^31 non-zeros.
 #ifdef POLYSOLVE_LARGE_INDEX
-	typedef Eigen::SparseMatrix<double, Eigen::ColMajor, std::ptrdiff_t> StiffnessMatrix;
+	typedef std::ptrdiff_t StorageIndex;
 #else
-	typedef Eigen::SparseMatrix<double, Eigen::ColMajor> StiffnessMatrix;
+	typedef int StorageIndex;
 #endif
+	typedef Eigen::SparseMatrix<double, Eigen::ColMajor, StorageIndex> StiffnessMatrix;
 } // namespace polyfem
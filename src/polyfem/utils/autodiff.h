@@ -123,8 +123,9 @@ public:
 	/// Create a new constant automatic differentiation scalar
 	explicit DScalar1(Scalar value_ = (Scalar)0) : value(value_)
 	{
-		size_t variableCount = getVariableCount();
-		grad.resize(variableCount);
+		// fixed-size derivatives are sized at compile time
+		if constexpr (Gradient::SizeAtCompileTime == Eigen::Dynamic)
+			grad.resize(getVariableCount());
 		grad.setZero();
 	}
 
@@ -132,8 +133,8 @@ public:
 	DScalar1(size_t index, const Scalar &value_)
 		: value(value_)
 	{
-		size_t variableCount = getVariableCount();
-		grad.resize(variableCount);
+		if constexpr (Gradient::SizeAtCompileTime == Eigen::Dynamic)
+			grad.resize(getVariableCount());
 		grad.setZero();
 		grad(index) = 1;
 	}
@@ -505,11 +506,12 @@ public:
 	/// Create a new constant automatic differentiation scalar
 	explicit DScalar2(Scalar value_ = (Scalar)0) : value(value_)
 	{
-		size_t variableCount = getVariableCount();
-
-		grad.resize(variableCount);
+		// fixed-size derivatives are sized at compile time
+		if constexpr (Gradient::SizeAtCompileTime == Eigen::Dynamic)
+			grad.resize(getVariableCount());
+		if constexpr (Hessian::SizeAtCompileTime == Eigen::Dynamic)
+			hess.resize(getVariableCount(), getVariableCount());
 		grad.setZero();
-		hess.resize(variableCount, variableCount);
 		hess.setZero();
 	}
 
@@ -517,12 +519,12 @@ public:
 	DScalar2(size_t index, const Scalar &value_)
 		: value(value_)
 	{
-		size_t variableCount = getVariableCount();
-
-		grad.resize(variableCount);
+		if constexpr (Gradient::SizeAtCompileTime == Eigen::Dynamic)
+			grad.resize(getVariableCount());
+		if constexpr (Hessian::SizeAtCompileTime == Eigen::Dynamic)
+			hess.resize(getVariableCount(), getVariableCount());
 		grad.setZero();
 		grad(index) = 1;
-		hess.resize(variableCount, variableCount);
 		hess.setZero();
 	}
 
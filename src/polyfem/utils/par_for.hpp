@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <mutex>
 #include <thread>
 
 #include <Eigen/Core>
@@ -13,6 +15,8 @@ namespace polyfem
 {
 	namespace utils
 	{
+		/// @brief Number of threads used by the parallel loops of all the States of the process.
+		/// The limit is process-wide (TBB global control and Eigen), the last State setting it wins.
 		class NThread
 		{
 		public:
@@ -29,6 +33,11 @@ namespace polyfem
 				const unsigned int tmp = max_threads <= 0 ? std::numeric_limits<int>::max() : max_threads;
 				const unsigned int num_threads = std::min(tmp, std::thread::hardware_concurrency());
 
+				std::lock_guard<std::mutex> lock(mutex_);
+				// States running concurrently with the same settings leave the limit untouched
+				if (num_threads_ == num_threads)
+					return;
+
 				num_threads_ = num_threads;
 #ifdef POLYFEM_WITH_TBB
 				thread_limiter = std::make_shared<tbb::global_control>(tbb::global_control::max_allowed_parallelism, num_threads);
@@ -39,7 +48,8 @@ namespace polyfem
 		private:
 			NThread() {}
 
-			size_t num_threads_;
+			std::atomic<size_t> num_threads_ = 0;
+			std::mutex mutex_;
 
 #ifdef POLYFEM_WITH_TBB
 			/// limits the number of used threads
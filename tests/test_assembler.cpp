@@ -1,17 +1,31 @@
 #include <polyfem/State.hpp>
 
+#include <polyfem/assembler/AssemblerUtils.hpp>
+#include <polyfem/assembler/Helmholtz.hpp>
+#include <polyfem/assembler/Laplacian.hpp>
+#include <polyfem/assembler/LinearElasticity.hpp>
+#include <polyfem/assembler/Mass.hpp>
+#include <polyfem/assembler/MassMatrixAssembler.hpp>
+#include <polyfem/assembler/MeshTransfer.hpp>
 #include <polyfem/assembler/NeoHookeanElasticity.hpp>
 #include <polyfem/assembler/NeoHookeanElasticityAutodiff.hpp>
+#include <polyfem/assembler/SumFactorization.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/autogen/auto_q_bases.hpp>
+#include <polyfem/quadrature/HexQuadrature.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <catch2/generators/catch_generators.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace polyfem;
 using namespace polyfem::assembler;
 using namespace polyfem::basis;
 using namespace polyfem::mesh;
+using namespace polyfem::quadrature;
 using namespace polyfem::utils;
 
 TEST_CASE("hessian_lin", "[assembler]")
@@ -124,6 +138,243 @@ TEST_CASE("hessian_hooke", "[assembler]")
 	}
 }
 
+TEST_CASE("hessian_reuse", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "NeoHookean";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	const auto assembler = std::dynamic_pointer_cast<NLAssembler>(state.assembler);
+	REQUIRE(assembler != nullptr);
+
+	const auto hessian_at = [&](const Eigen::MatrixXd &disp) {
+		SparseMatrixCache mat_cache;
+		StiffnessMatrix hessian;
+		assembler->assemble_hessian(false, state.n_bases, false,
+									state.bases, state.bases, state.ass_vals_cache, 0, 0, disp, Eigen::MatrixXd(), mat_cache, hessian);
+		return hessian;
+	};
+
+	Eigen::MatrixXd disp = Eigen::MatrixXd::Random(state.n_bases * 2, 1) * 1e-2;
+	const StiffnessMatrix exact = hessian_at(disp);
+
+	assembler->set_hessian_reuse_tolerance(1e-3);
+	REQUIRE((hessian_at(disp) - exact).norm() == Catch::Approx(0).margin(1e-10));
+
+	// small changes reuse the hessians computed at disp
+	const Eigen::MatrixXd close = disp + Eigen::MatrixXd::Random(disp.rows(), 1) * 1e-5;
+	REQUIRE((hessian_at(close) - exact).norm() == Catch::Approx(0).margin(1e-10));
+
+	// large changes recompute them
+	const Eigen::MatrixXd far = disp + Eigen::MatrixXd::Constant(disp.rows(), 1, 1e-1);
+	assembler->set_hessian_reuse_tolerance(0);
+	const StiffnessMatrix exact_far = hessian_at(far);
+	assembler->set_hessian_reuse_tolerance(1e-3);
+	hessian_at(disp);
+	REQUIRE((hessian_at(far) - exact_far).norm() == Catch::Approx(0).margin(1e-10));
+}
+
+TEST_CASE("symmetric_hessian_cache", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "NeoHookean";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	const auto assembler = std::dynamic_pointer_cast<NLAssembler>(state.assembler);
+	REQUIRE(assembler != nullptr);
+
+	SparseMatrixCache full_cache, upper_cache;
+	upper_cache.set_symmetric(true);
+
+	// the first assembly builds the pattern, the second one scatters in it
+	for (int rand = 0; rand < 2; ++rand)
+	{
+		const Eigen::MatrixXd disp = Eigen::MatrixXd::Random(state.n_bases * 2, 1) * 1e-2;
+
+		StiffnessMatrix full, upper;
+		assembler->assemble_hessian(false, state.n_bases, false,
+									state.bases, state.bases, state.ass_vals_cache, 0, 0, disp, Eigen::MatrixXd(), full_cache, full);
+		assembler->assemble_hessian(false, state.n_bases, false,
+									state.bases, state.bases, state.ass_vals_cache, 0, 0, disp, Eigen::MatrixXd(), upper_cache, upper);
+
+		CHECK((full - upper).norm() == Catch::Approx(0).margin(1e-8 * full.norm()));
+		CHECK(upper_cache.mat().nonZeros() < full_cache.mat().nonZeros());
+	}
+}
+
+TEST_CASE("assembly_values_cache_strategies", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	const int discr_order = GENERATE(1, 2);
+	const bool is_mass = GENERATE(false, true);
+
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+	in_args["space"]["discr_order"] = discr_order;
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "NeoHookean";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	const auto &gbases = state.geom_bases();
+	AssemblyValsCache full;
+	full.init(false, state.bases, gbases, is_mass);
+
+	const auto strategy = GENERATE(AssemblyValsCache::Strategy::Compact, AssemblyValsCache::Strategy::Reference, AssemblyValsCache::Strategy::OnTheFly);
+	AssemblyValsCache cache;
+	cache.set_strategy(strategy, 16);
+	cache.init(false, state.bases, gbases, is_mass);
+	if (strategy != AssemblyValsCache::Strategy::OnTheFly)
+		CHECK(cache.memory_usage() < full.memory_usage());
+
+	// the full cache is built from the bases tabulated once per reference element
+	ElementAssemblyValues direct, expected;
+	for (int e = 0; e < state.bases.size(); ++e)
+	{
+		if (is_mass)
+		{
+			state.bases[e].compute_mass_quadrature(direct.quadrature);
+			direct.compute(e, false, direct.quadrature.points, state.bases[e], gbases[e]);
+		}
+		else
+			direct.compute(e, false, state.bases[e], gbases[e]);
+		full.compute(e, false, state.bases[e], gbases[e], expected);
+
+		REQUIRE(expected.quadrature.points == direct.quadrature.points);
+		REQUIRE(expected.det.isApprox(direct.det));
+		for (int j = 0; j < direct.basis_values.size(); ++j)
+		{
+			REQUIRE(expected.basis_values[j].val == direct.basis_values[j].val);
+			REQUIRE(expected.basis_values[j].grad_t_m.isApprox(direct.basis_values[j].grad_t_m));
+		}
+	}
+
+	ElementAssemblyValues vals;
+	// twice to hit the on-the-fly cache
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (int e = 0; e < state.bases.size(); ++e)
+		{
+			full.compute(e, false, state.bases[e], gbases[e], expected);
+			cache.compute(e, false, state.bases[e], gbases[e], vals);
+
+			REQUIRE(vals.element_id == e);
+			REQUIRE(vals.quadrature.points == expected.quadrature.points);
+			REQUIRE(vals.quadrature.weights == expected.quadrature.weights);
+			REQUIRE(vals.val == expected.val);
+			REQUIRE(vals.det == expected.det);
+			REQUIRE(vals.jac_it == expected.jac_it);
+			REQUIRE(vals.basis_values.size() == expected.basis_values.size());
+			for (int j = 0; j < vals.basis_values.size(); ++j)
+			{
+				REQUIRE(vals.basis_values[j].global.size() == expected.basis_values[j].global.size());
+				REQUIRE(vals.basis_values[j].val == expected.basis_values[j].val);
+				REQUIRE(vals.basis_values[j].grad == expected.basis_values[j].grad);
+				REQUIRE(vals.basis_values[j].grad_t_m == expected.basis_values[j].grad_t_m);
+			}
+		}
+	}
+}
+
+TEST_CASE("shared_assembly_values_cache", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "NeoHookean";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	const auto create_state = [&](const json &args, const std::shared_ptr<const State> &source) {
+		auto state = std::make_shared<State>();
+		state->init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state->assembly_caches_source = source;
+		state->init(args, true);
+		state->load_mesh();
+		state->build_basis();
+		return state;
+	};
+
+	const std::shared_ptr<State> source = create_state(in_args, nullptr);
+
+	// only the material differs, the caches are shared
+	json other_args = in_args;
+	other_args["materials"]["E"] = 2e5;
+	const std::shared_ptr<State> state = create_state(other_args, source);
+	REQUIRE(state->has_same_discretization(*source));
+	CHECK(state->ass_vals_cache.shares_values_with(source->ass_vals_cache));
+	CHECK(state->mass_ass_vals_cache.shares_values_with(source->mass_ass_vals_cache));
+
+	// different bases, the caches are computed
+	json p2_args = in_args;
+	p2_args["space"]["discr_order"] = 2;
+	const std::shared_ptr<State> p2_state = create_state(p2_args, source);
+	CHECK(!p2_state->has_same_discretization(*source));
+	CHECK(!p2_state->ass_vals_cache.shares_values_with(source->ass_vals_cache));
+
+	// copy-on-write, rebuilding one of the caches leaves the other one untouched
+	AssemblyValsCache copy = source->ass_vals_cache;
+	CHECK(copy.shares_values_with(source->ass_vals_cache));
+	copy.init(false, source->bases, source->geom_bases());
+	CHECK(!copy.shares_values_with(source->ass_vals_cache));
+
+	ElementAssemblyValues vals, expected;
+	for (int e = 0; e < source->bases.size(); ++e)
+	{
+		source->ass_vals_cache.compute(e, false, source->bases[e], source->geom_bases()[e], expected);
+		copy.compute(e, false, source->bases[e], source->geom_bases()[e], vals);
+		REQUIRE(vals.det == expected.det);
+		REQUIRE(vals.val == expected.val);
+	}
+}
+
 TEST_CASE("generic_elastic_assembler", "[assembler]")
 {
 
@@ -284,3 +535,543 @@ TEST_CASE("generic_elastic_assembler", "[assembler]")
 		}
 	}
 }
+
+TEST_CASE("batched_elastic_kernels", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+
+	const std::string material = GENERATE(std::string("NeoHookean"), std::string("SaintVenant"), std::string("LinearElasticity"));
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = material;
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	Eigen::MatrixXd disp(state.n_bases * 2, 1);
+
+	for (int rand = 0; rand < 5; ++rand)
+	{
+		disp.setRandom();
+		disp *= 1e-3;
+
+		// batched energy vs per element kernels
+		const double energy = state.assembler->assemble_energy(
+			false, state.bases, state.bases, state.ass_vals_cache, 0, 0, disp, disp);
+		const Eigen::VectorXd energy_per_element = state.assembler->assemble_energy_per_element(
+			false, state.bases, state.bases, state.ass_vals_cache, 0, 0, disp, disp);
+		REQUIRE(energy == Catch::Approx(energy_per_element.sum()).epsilon(1e-10));
+
+		// batched gradient vs finite differences of the energy
+		Eigen::MatrixXd grad;
+		state.assembler->assemble_gradient(
+			false, state.n_bases, state.bases, state.bases, state.ass_vals_cache, 0, 0, disp, disp, grad);
+
+		const double h = 1e-7;
+		for (int i = 0; i < disp.size(); i += disp.size() / 10)
+		{
+			Eigen::MatrixXd disp_p = disp, disp_m = disp;
+			disp_p(i) += h;
+			disp_m(i) -= h;
+			const double fd = (state.assembler->assemble_energy(false, state.bases, state.bases, state.ass_vals_cache, 0, 0, disp_p, disp_p)
+							   - state.assembler->assemble_energy(false, state.bases, state.bases, state.ass_vals_cache, 0, 0, disp_m, disp_m))
+							  / (2 * h);
+			REQUIRE(grad(i) == Catch::Approx(fd).epsilon(1e-4).margin(1e-4));
+		}
+	}
+}
+
+TEST_CASE("p1_element_kernels", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	Units units;
+	json params = {{"k", 2.0}, {"rho", 3.0}, {"E", 1e5}, {"nu", 0.3}};
+
+	std::vector<std::shared_ptr<LinearAssembler>> assemblers = {
+		std::make_shared<Laplacian>(), std::make_shared<Helmholtz>(), std::make_shared<Mass>(), std::make_shared<LinearElasticity>()};
+	for (const auto &assembler : assemblers)
+	{
+		assembler->set_size(assembler->name() == "LinearElasticity" ? 2 : 1);
+		assembler->add_multimaterial(0, params, units);
+
+		// the kernel gives the same local matrices as the pairs of bases
+		ElementAssemblyValues vals;
+		Eigen::MatrixXd local;
+		for (int e = 0; e < state.bases.size(); ++e)
+		{
+			state.ass_vals_cache.compute(e, false, state.bases[e], state.geom_bases()[e], vals);
+			REQUIRE(assembler->has_element_kernel(vals));
+
+			const QuadratureVector da = vals.det.array() * vals.quadrature.weights.array();
+			assembler->assemble_element(vals, 0, da, local);
+
+			const int size = assembler->size();
+			for (int i = 0; i < vals.basis_values.size(); ++i)
+			{
+				for (int j = 0; j < vals.basis_values.size(); ++j)
+				{
+					const auto expected = assembler->assemble(LinearAssemblerData(vals, 0, i, j, da));
+					for (int n = 0; n < size; ++n)
+						for (int m = 0; m < size; ++m)
+							CHECK(local(i * size + m, j * size + n) == Catch::Approx(expected(n * size + m)).margin(1e-8));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("reduced_integration_hex", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/hex.HYBRID";
+	in_args["space"]["advanced"]["reduced_integration"]["enabled"] = true;
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "NeoHookean";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.49;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+	REQUIRE(!state.reduced_integration_elements.empty());
+
+	for (const int e : state.reduced_integration_elements)
+	{
+		Quadrature quad;
+		state.bases[e].compute_quadrature(quad);
+		CHECK(quad.size() == 1);
+	}
+
+	state.assemble_hourglass_stiffness();
+	const StiffnessMatrix &K = state.hourglass_stiffness;
+	REQUIRE(K.rows() == state.n_bases * 3);
+	CHECK((K - StiffnessMatrix(K.transpose())).norm() < 1e-10 * K.norm());
+
+	// the linear displacements have no hourglass energy
+	Eigen::MatrixXd nodes(state.n_bases, 3);
+	for (const ElementBases &b : state.bases)
+		for (const Basis &basis : b.bases)
+			for (const Local2Global &g : basis.global())
+				nodes.row(g.index) = g.node;
+
+	const Eigen::Matrix3d A = Eigen::Matrix3d::Random();
+	const Eigen::MatrixXd linear = (nodes * A.transpose()).rowwise() + Eigen::RowVector3d::Random();
+	const Eigen::VectorXd linear_disp = utils::flatten(linear);
+	CHECK((K * linear_disp).norm() < 1e-8 * K.norm() * linear_disp.norm());
+
+	const Eigen::VectorXd disp = Eigen::VectorXd::Random(K.rows());
+	CHECK(disp.dot(K * disp) > 0);
+}
+
+TEST_CASE("sum_factorization_hex", "[assembler]")
+{
+	const int discr_order = GENERATE(2, 3);
+
+	// against the Q bases at the tensor quadrature of the elements
+	{
+		Quadrature quad;
+		HexQuadrature().get_quadrature(2 * discr_order, quad);
+
+		SumFactorization sf;
+		REQUIRE(sf.init(discr_order, quad));
+
+		const int n_bases = sf.n_bases();
+		const Eigen::MatrixXd u = Eigen::MatrixXd::Random(n_bases, 3);
+		const Eigen::MatrixXd flux = Eigen::MatrixXd::Random(quad.size(), 9);
+
+		Eigen::MatrixXd grad, r;
+		sf.gradient(u, grad);
+		sf.integrate_gradient(flux, r);
+
+		Eigen::MatrixXd expected_grad = Eigen::MatrixXd::Zero(quad.size(), 9), expected_r(n_bases, 3), basis_grad;
+		for (int j = 0; j < n_bases; ++j)
+		{
+			autogen::q_grad_basis_value_3d(discr_order, j, quad.points, basis_grad);
+			for (int c = 0; c < 3; ++c)
+			{
+				expected_grad.middleCols<3>(3 * c) += u(j, c) * basis_grad;
+				expected_r(j, c) = (basis_grad.array() * flux.middleCols<3>(3 * c).array()).sum();
+			}
+		}
+
+		CHECK((grad - expected_grad).norm() < 1e-10);
+		CHECK((r - expected_r).norm() < 1e-10);
+	}
+
+	// the batched kernels use it for Q2 and Q3 hexahedra
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/hex.HYBRID";
+	in_args["space"]["discr_order"] = discr_order;
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "NeoHookean";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	Eigen::MatrixXd disp(state.n_bases * 3, 1);
+	disp.setRandom();
+	disp *= 1e-3;
+
+	const double energy = state.assembler->assemble_energy(
+		true, state.bases, state.bases, state.ass_vals_cache, 0, 0, disp, disp);
+	const Eigen::VectorXd energy_per_element = state.assembler->assemble_energy_per_element(
+		true, state.bases, state.bases, state.ass_vals_cache, 0, 0, disp, disp);
+	REQUIRE(energy == Catch::Approx(energy_per_element.sum()).epsilon(1e-10));
+
+	Eigen::MatrixXd grad;
+	state.assembler->assemble_gradient(
+		true, state.n_bases, state.bases, state.bases, state.ass_vals_cache, 0, 0, disp, disp, grad);
+
+	const double h = 1e-7;
+	for (int i = 0; i < disp.size(); i += disp.size() / 10)
+	{
+		Eigen::MatrixXd disp_p = disp, disp_m = disp;
+		disp_p(i) += h;
+		disp_m(i) -= h;
+		const double fd = (state.assembler->assemble_energy(true, state.bases, state.bases, state.ass_vals_cache, 0, 0, disp_p, disp_p)
+						   - state.assembler->assemble_energy(true, state.bases, state.bases, state.ass_vals_cache, 0, 0, disp_m, disp_m))
+						  / (2 * h);
+		REQUIRE(grad(i) == Catch::Approx(fd).epsilon(1e-4).margin(1e-4));
+	}
+}
+
+TEST_CASE("lagged_newton", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+
+	in_args["preset_problem"] = {};
+	in_args["preset_problem"]["type"] = "ElasticExact";
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "NeoHookean";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	const auto solve = [&](const int lag_iterations) {
+		json args = in_args;
+		args["solver"]["advanced"]["hessian_lag_iterations"] = lag_iterations;
+
+		State state;
+		state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state.init(args, true);
+		state.load_mesh();
+		state.build_basis();
+		state.assemble_rhs();
+		state.assemble_mass_mat();
+
+		Eigen::MatrixXd sol, pressure;
+		state.solve_problem(sol, pressure);
+		return sol;
+	};
+
+	// reusing the Hessian changes the path of the solver, not the solution it converges to
+	const Eigen::MatrixXd exact = solve(1);
+	const Eigen::MatrixXd lagged = solve(3);
+	REQUIRE((lagged - exact).norm() == Catch::Approx(0).margin(1e-6 * std::max(1.0, exact.norm())));
+}
+
+TEST_CASE("parallel_rhs", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"(
+		{
+			"materials": {"type": "LinearElasticity", "E": 1e5, "nu": 0.3},
+			"boundary_conditions": {
+				"rhs": ["x", "x*y"],
+				"dirichlet_boundary": [{"id": 1, "value": [0, 0]}],
+				"neumann_boundary": [{"id": 7, "value": ["y", "1"]}]
+			}
+		})"_json;
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["geometry"]["surface_selection"] = 7;
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	const auto assemble = [&](Eigen::MatrixXd &rhs, double &energy) {
+		state.assemble_rhs();
+		const auto &rhs_assembler = state.solve_data.rhs_assembler;
+		rhs = state.rhs;
+		rhs_assembler->set_bc(state.local_boundary, state.boundary_nodes, state.n_boundary_samples(), state.local_neumann_boundary, rhs);
+
+		const Eigen::MatrixXd displacement = Eigen::VectorXd::LinSpaced(rhs.size(), 0, 1);
+		energy = rhs_assembler->compute_energy(
+			displacement, displacement, state.local_neumann_boundary, state.mass_matrix_assembler->density(),
+			state.n_boundary_samples(), 1);
+	};
+
+	Eigen::MatrixXd serial_rhs, parallel_rhs;
+	double serial_energy, parallel_energy;
+	state.set_max_threads(1);
+	assemble(serial_rhs, serial_energy);
+	state.set_max_threads(4);
+	assemble(parallel_rhs, parallel_energy);
+	state.set_max_threads();
+
+	// the thread-local contributions only change the order of the sums
+	CHECK((parallel_rhs - serial_rhs).norm() <= 1e-12 * serial_rhs.norm());
+	CHECK(parallel_energy == Catch::Approx(serial_energy).epsilon(1e-12));
+
+	// the elements of a color share no basis and every element has a color
+	const std::vector<std::vector<int>> colors = AssemblerUtils::color_elements(state.bases, state.n_bases);
+	int n_colored = 0;
+	for (const std::vector<int> &color : colors)
+	{
+		std::vector<bool> used(state.n_bases, false);
+		for (const int e : color)
+		{
+			std::vector<int> element_bases;
+			for (const Basis &b : state.bases[e].bases)
+				for (const Local2Global &g : b.global())
+					element_bases.push_back(g.index);
+			std::sort(element_bases.begin(), element_bases.end());
+			element_bases.erase(std::unique(element_bases.begin(), element_bases.end()), element_bases.end());
+			for (const int i : element_bases)
+			{
+				CHECK(!used[i]);
+				used[i] = true;
+			}
+		}
+		n_colored += color.size();
+	}
+	CHECK(n_colored == state.bases.size());
+}
+
+TEST_CASE("neumann_time_parts", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"(
+		{
+			"materials": {"type": "LinearElasticity", "E": 1e5, "nu": 0.3},
+			"time": {"dt": 0.1, "time_steps": 10},
+			"boundary_conditions": {
+				"rhs": ["x", "x*y"],
+				"dirichlet_boundary": [{"id": 1, "value": [0, 0]}],
+				"neumann_boundary": [
+					{"id": 3, "value": ["y", "1"], "interpolation": [{"type": "linear"}, {"type": "linear_ramp", "to": 0.5}]},
+					{"id": 4, "value": ["1", "x"], "interpolation": [{"type": "linear"}]}
+				]
+			}
+		})"_json;
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+	state.assemble_rhs();
+
+	const Problem &problem = *state.problem;
+	REQUIRE(!problem.is_constant_in_time());
+	CHECK(problem.is_rhs_time_independent());
+	// one part per component of the first boundary, one for the second
+	REQUIRE(problem.n_neumann_time_parts() == 3);
+
+	const auto &rhs_assembler = state.solve_data.rhs_assembler;
+	std::vector<Eigen::MatrixXd> parts(problem.n_neumann_time_parts());
+	for (int k = 0; k < parts.size(); ++k)
+	{
+		parts[k].setZero(state.rhs.rows(), state.rhs.cols());
+		rhs_assembler->assemble_neumann_part(k, state.n_boundary_samples(), state.local_neumann_boundary, parts[k]);
+	}
+
+	for (const double t : {0.1, 0.3, 0.7})
+	{
+		Eigen::MatrixXd expected = state.rhs;
+		rhs_assembler->set_bc(std::vector<LocalBoundary>(), std::vector<int>(), state.n_boundary_samples(), state.local_neumann_boundary, expected, Eigen::MatrixXd(), t);
+
+		Eigen::MatrixXd split = state.rhs;
+		for (int k = 0; k < parts.size(); ++k)
+			split += problem.neumann_time_factor(k, t) * parts[k];
+
+		CHECK((split - expected).norm() <= 1e-12 * expected.norm());
+	}
+
+	// loads following the deformed normals are assembled at every step
+	in_args["boundary_conditions"]["normal_aligned_neumann_boundary"] = R"([{"id": 2, "value": 1}])"_json;
+	State other_state;
+	other_state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+	other_state.init(in_args, true);
+	CHECK(other_state.problem->n_neumann_time_parts() == -1);
+}
+
+TEST_CASE("initial_projection", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"(
+		{
+			"materials": {"type": "LinearElasticity", "E": 1e5, "nu": 0.3},
+			"time": {"dt": 0.1, "time_steps": 1},
+			"space": {"discr_order": 2},
+			"boundary_conditions": {"dirichlet_boundary": [{"id": "all", "value": [0, 0]}]},
+			"initial_conditions": {"solution": [{"id": 0, "value": ["x^2+y", "x*y"]}]}
+		})"_json;
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/contact/meshes/2D/simple/circle/circle36.obj";
+
+	const auto init_state = [&](State &state, const std::string &bc_method, const std::string &projection, const int n_refs) {
+		json args = in_args;
+		args["space"]["advanced"]["bc_method"] = bc_method;
+		args["space"]["advanced"]["initial_projection"] = projection;
+		args["geometry"]["n_refs"] = n_refs;
+
+		state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state.init(args, true);
+		state.load_mesh();
+		state.build_basis();
+		state.assemble_rhs();
+	};
+
+	// the field is in the P2 space, both projections reproduce it
+	State sampled;
+	init_state(sampled, "sample", "global", 0);
+	Eigen::MatrixXd expected;
+	sampled.initial_solution(expected);
+	REQUIRE(expected.norm() > 0);
+
+	for (const std::string projection : {"global", "local"})
+	{
+		State state;
+		init_state(state, "lsq", projection, 0);
+		Eigen::MatrixXd sol;
+		state.initial_solution(sol);
+		CHECK((sol - expected).norm() <= 1e-8 * expected.norm());
+	}
+
+	// warm start of a refined mesh from the coarse field
+	State fine_sampled;
+	init_state(fine_sampled, "sample", "global", 1);
+	Eigen::MatrixXd fine_expected;
+	fine_sampled.initial_solution(fine_expected);
+
+	in_args["initial_conditions"] = json::object();
+	for (const std::string projection : {"global", "local"})
+	{
+		State fine;
+		init_state(fine, "lsq", projection, 1);
+		fine.set_warm_start(sampled, expected);
+
+		Eigen::MatrixXd sol;
+		fine.initial_solution(sol);
+		REQUIRE(sol.rows() == fine_expected.rows());
+		CHECK((sol - fine_expected).norm() <= 1e-8 * fine_expected.norm());
+	}
+}
+
+TEST_CASE("mesh_transfer", "[assembler]")
+{
+	json in_args = R"(
+		{
+			"materials": {"type": "Laplacian"},
+			"space": {"discr_order": 2},
+			"boundary_conditions": {"dirichlet_boundary": [{"id": "all", "value": 0}]}
+		})"_json;
+
+	// two unrelated triangulations of the unit square
+	Eigen::MatrixXd V_from(4, 2), V_to(5, 2);
+	V_from << 0, 0, 1, 0, 1, 1, 0, 1;
+	V_to << 0, 0, 1, 0, 1, 1, 0, 1, 0.3, 0.6;
+	Eigen::MatrixXi F_from(2, 3), F_to(4, 3);
+	F_from << 0, 1, 2, 0, 2, 3;
+	F_to << 0, 1, 4, 1, 2, 4, 2, 3, 4, 3, 0, 4;
+
+	State from, to;
+	for (auto [state, V, F] : {std::make_tuple(&from, &V_from, &F_from), std::make_tuple(&to, &V_to, &F_to)})
+	{
+		state->init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state->init(in_args, true);
+		state->load_mesh(*V, *F);
+		state->build_basis();
+	}
+
+	// quadratic field, in both spaces
+	const auto sample = [](const State &state) {
+		Eigen::MatrixXd values(state.n_bases, 1);
+		for (const auto &bs : state.bases)
+			for (const auto &b : bs.bases)
+			{
+				const RowVectorNd &p = b.global()[0].node;
+				values(b.global()[0].index) = p(0) * p(0) + p(0) * p(1) - p(1);
+			}
+		return values;
+	};
+
+	const MeshTransfer transfer(
+		false, 1,
+		from.n_bases, from.bases, from.geom_bases(),
+		to.n_bases, to.bases, to.geom_bases());
+
+	const Eigen::MatrixXd from_values = sample(from);
+	const Eigen::MatrixXd expected = sample(to);
+
+	Eigen::MatrixXd to_values;
+	transfer.transfer(from_values, to_values);
+	REQUIRE(to_values.rows() == to.n_bases);
+	CHECK((to_values - expected).norm() <= 1e-10 * expected.norm());
+
+	// conservative: same integral on both meshes
+	StiffnessMatrix from_mass;
+	MassMatrixAssembler().assemble(false, 1, from.n_bases, NoDensity(), from.bases, from.geom_bases(), AssemblyValsCache(), from_mass);
+	const double from_integral = Eigen::VectorXd::Ones(from.n_bases).dot(from_mass * from_values);
+	const double to_integral = Eigen::VectorXd::Ones(to.n_bases).dot(transfer.mass() * to_values);
+	CHECK(to_integral == Catch::Approx(from_integral).epsilon(1e-12));
+
+	// the operator is reused
+	Eigen::MatrixXd twice;
+	transfer.transfer(2 * from_values, twice);
+	CHECK((twice - 2 * to_values).norm() <= 1e-10 * to_values.norm());
+}
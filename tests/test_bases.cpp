@@ -7,6 +7,8 @@
 #include <polyfem/quadrature/HexQuadrature.hpp>
 
 #include <polyfem/basis/LagrangeBasis3d.hpp>
+#include <polyfem/basis/NodeOrdering.hpp>
+#include <polyfem/State.hpp>
 #include <polyfem/autogen/auto_p_bases.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
 
@@ -17,6 +19,7 @@
 #include <catch2/catch_approx.hpp>
 
 #include <iostream>
+#include <set>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -1178,3 +1181,106 @@ TEST_CASE("WS_2d", "[bases]")
 		}
 	}
 }
+
+TEST_CASE("lagrange_reference_key", "[bases]")
+{
+	std::set<int> keys;
+	int n_keys = 0;
+	for (int dim = 2; dim <= 3; ++dim)
+	{
+		for (const bool is_simplex : {true, false})
+		{
+			for (int order = -2; order <= polyfem::autogen::MAX_P_BASES; ++order)
+			{
+				const int key = ElementBases::lagrange_reference_key(dim, is_simplex, order);
+				REQUIRE(key >= 0);
+				keys.insert(key);
+				++n_keys;
+			}
+		}
+	}
+	REQUIRE(keys.size() == n_keys);
+}
+
+namespace
+{
+	int node_bandwidth(const std::vector<ElementBases> &bases)
+	{
+		int bandwidth = 0;
+		for (const ElementBases &b : bases)
+			for (const Basis &bi : b.bases)
+				for (const Basis &bj : b.bases)
+					bandwidth = std::max(bandwidth, std::abs(bi.global()[0].index - bj.global()[0].index));
+		return bandwidth;
+	}
+} // namespace
+
+TEST_CASE("node_ordering", "[bases]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"(
+		{
+			"materials": {"type": "Laplacian"},
+			"geometry": [{
+				"mesh": "",
+				"surface_selection": 7
+			}],
+			"space": {
+				"discr_order": 2
+			},
+			"boundary_conditions": {
+				"dirichlet_boundary": [{
+					"id": "all",
+					"value": "x^2+y^2"
+				}],
+				"rhs": 4
+			}
+		})"_json;
+	in_args["geometry"][0]["mesh"] = path + "/plane_hole.obj";
+
+	const auto solve = [&](const std::string &ordering, int &bandwidth, Eigen::MatrixXd &sol) {
+		json args = in_args;
+		args["space"]["advanced"]["node_ordering"] = ordering;
+
+		State state;
+		state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state.init(args, true);
+		state.load_mesh();
+		state.build_basis();
+
+		std::vector<bool> used(state.n_bases, false);
+		for (const ElementBases &b : state.bases)
+			for (const Basis &basis : b.bases)
+				used[basis.global()[0].index] = true;
+		REQUIRE(std::all_of(used.begin(), used.end(), [](bool u) { return u; }));
+		REQUIRE(state.in_node_to_node.size() == state.n_bases);
+
+		bandwidth = node_bandwidth(state.bases);
+
+		state.assemble_rhs();
+		state.assemble_mass_mat();
+		Eigen::MatrixXd pressure, tmp;
+		state.solve_problem(tmp, pressure);
+
+		// input node order
+		sol.resize(tmp.rows(), 1);
+		for (int i = 0; i < state.in_node_to_node.size(); ++i)
+			sol(i) = tmp(state.in_node_to_node[i]);
+	};
+
+	int bandwidth;
+	Eigen::MatrixXd expected;
+	solve("none", bandwidth, expected);
+
+	for (const std::string ordering : {"rcm", "morton"})
+	{
+		int reordered_bandwidth;
+		Eigen::MatrixXd sol;
+		solve(ordering, reordered_bandwidth, sol);
+
+		REQUIRE(sol.size() == expected.size());
+		CHECK((sol - expected).norm() < 1e-8 * std::max(1.0, expected.norm()));
+		if (ordering == "rcm")
+			CHECK(reordered_bandwidth <= bandwidth);
+	}
+}
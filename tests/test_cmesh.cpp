@@ -1,5 +1,6 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <polyfem/mesh/mesh2D/CMesh2D.hpp>
+#include <polyfem/mesh/mesh3D/Mesh3D.hpp>
 #include <polyfem/State.hpp>
 
 #include <catch2/catch_test_macros.hpp>
@@ -21,3 +22,125 @@ TEST_CASE("append_2d", "[mesh_test]")
 
 	m1->append(m2);
 }
+
+TEST_CASE("locate_points_2d", "[mesh_test]")
+{
+	// Used to init geogram
+	State state;
+
+	Eigen::MatrixXd V(4, 2);
+	V << 0, 0,
+		1, 0,
+		1, 1,
+		0, 1;
+	Eigen::MatrixXi F(2, 3);
+	F << 0, 1, 2,
+		0, 2, 3;
+	auto mesh = Mesh::create(V, F);
+
+	Eigen::MatrixXd points(4, 2);
+	points << 0.75, 0.25,
+		0.25, 0.75,
+		0.5, 0.5,
+		1.5, 0.5;
+
+	Eigen::VectorXi element_ids;
+	Eigen::MatrixXd coords;
+	mesh->locate_points(points, element_ids, coords);
+
+	CHECK(element_ids(0) == 0);
+	CHECK(element_ids(1) == 1);
+	CHECK(element_ids(2) >= 0);
+	CHECK(element_ids(3) == -1);
+	for (int i = 0; i < 3; ++i)
+	{
+		CHECK(coords.row(i).minCoeff() >= 0);
+		CHECK(std::abs(coords.row(i).sum() - 1) < 1e-12);
+	}
+
+	// the BVH is rebuilt after moving the vertices
+	mesh->apply_affine_transformation(2 * Eigen::Matrix2d::Identity(), Eigen::Vector2d::Zero());
+	mesh->locate_points(points, element_ids, coords);
+	CHECK(element_ids(3) == 0);
+}
+
+TEST_CASE("create_from_buffer_view", "[mesh_test]")
+{
+	// Used to init geogram
+	State state;
+
+	// vertices and triangles interleaved as in a buffer owned by the caller
+	const std::vector<double> V = {0, 0, 1, 0, 1, 1, 0, 1};
+	const std::vector<int> F = {0, 1, 2, 0, 2, 3};
+
+	typedef Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> Stride;
+	const Eigen::Map<const Eigen::MatrixXd, 0, Stride> vertices(V.data(), 4, 2, Stride(1, 2));
+	const Eigen::Map<const Eigen::MatrixXi, 0, Stride> cells(F.data(), 2, 3, Stride(1, 3));
+
+	const auto mesh = Mesh::create(vertices, cells);
+	REQUIRE(mesh->n_vertices() == 4);
+	REQUIRE(mesh->n_elements() == 2);
+	for (int v = 0; v < 4; ++v)
+	{
+		CHECK(mesh->point(v)(0) == V[2 * v]);
+		CHECK(mesh->point(v)(1) == V[2 * v + 1]);
+	}
+}
+
+TEST_CASE("navigation_3d", "[mesh_test]")
+{
+	// Used to init geogram
+	State state;
+
+	// 2x1x1 hexes
+	Eigen::MatrixXd V(12, 3);
+	for (int k = 0; k < 2; ++k)
+		for (int j = 0; j < 2; ++j)
+			for (int i = 0; i < 3; ++i)
+				V.row(6 * k + 3 * j + i) << i, j, k;
+	Eigen::MatrixXi F(2, 8);
+	for (int c = 0; c < 2; ++c)
+		F.row(c) << c, c + 1, c + 4, c + 3, c + 6, c + 7, c + 10, c + 9;
+
+	const auto mesh = Mesh::create(V, F);
+	REQUIRE(mesh->n_elements() == 2);
+	const auto &mesh3d = dynamic_cast<const Mesh3D &>(*mesh);
+
+	int n_boundary = 0;
+	for (int c = 0; c < 2; ++c)
+	{
+		for (int lf = 0; lf < mesh3d.n_cell_faces(c); ++lf)
+		{
+			for (int lv = 0; lv < 4; ++lv)
+			{
+				const auto idx = mesh3d.get_index_from_element(c, lf, lv);
+
+				const auto f = mesh3d.switch_face(idx);
+				CHECK(f.element == c);
+				CHECK(f.vertex == idx.vertex);
+				CHECK(f.edge == idx.edge);
+				CHECK(f.face != idx.face);
+				CHECK(mesh3d.cell_face(c, f.element_patch) == f.face);
+				CHECK(mesh3d.face_vertex(f.face, f.face_corner) == f.vertex);
+
+				const auto ff = mesh3d.switch_face(f);
+				CHECK(ff.face == idx.face);
+				CHECK(ff.element_patch == idx.element_patch);
+				CHECK(ff.face_corner == idx.face_corner);
+
+				const auto e = mesh3d.switch_element(idx);
+				if (e.element < 0)
+				{
+					CHECK(mesh3d.is_boundary_face(idx.face));
+					++n_boundary;
+					continue;
+				}
+				CHECK(e.element == 1 - c);
+				CHECK(e.face == idx.face);
+				CHECK(mesh3d.cell_face(e.element, e.element_patch) == idx.face);
+				CHECK(mesh3d.switch_element(e).element_patch == idx.element_patch);
+			}
+		}
+	}
+	CHECK(n_boundary == 4 * 10);
+}
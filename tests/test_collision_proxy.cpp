@@ -11,6 +11,8 @@
 #include <igl/writePLY.h>
 #include <igl/boundary_facets.h>
 
+#include <filesystem>
+
 namespace
 {
 	std::shared_ptr<polyfem::State> get_state(const std::string mesh_path = "", const int discr_order = 4)
@@ -134,6 +136,46 @@ TEST_CASE("build collision proxy", "[build_collision_proxy]")
 	// REQUIRE(igl::writePLY("deformed_proxy.ply", proxy_vertices + U_proxy, proxy_faces));
 }
 
+TEST_CASE("cache collision proxy", "[build_collision_proxy]")
+{
+	using namespace polyfem::mesh;
+
+	const auto state = get_state();
+
+	Eigen::MatrixXd proxy_vertices;
+	Eigen::MatrixXi proxy_faces;
+	std::vector<Eigen::Triplet<double>> displacement_map_entries;
+	build_collision_proxy(
+		state->bases, state->geom_bases(), state->total_local_boundary, state->n_bases, state->mesh->dimension(),
+		/*max_edge_length=*/0.1, proxy_vertices, proxy_faces, displacement_map_entries);
+
+	const std::string hash = collision_proxy_hash(
+		state->bases, state->geom_bases(), state->total_local_boundary,
+		/*max_edge_length=*/0.1, CollisionProxyTessellation::REGULAR);
+	CHECK(hash != collision_proxy_hash(
+			  state->bases, state->geom_bases(), state->total_local_boundary,
+			  /*max_edge_length=*/0.2, CollisionProxyTessellation::REGULAR));
+
+	const std::string path = (std::filesystem::temp_directory_path() / "polyfem_collision_proxy.hdf5").string();
+	save_collision_proxy(path, hash, state->n_bases, proxy_vertices, proxy_faces, displacement_map_entries);
+
+	Eigen::MatrixXd cached_vertices;
+	Eigen::MatrixXi cached_faces;
+	std::vector<Eigen::Triplet<double>> cached_entries;
+	CHECK(!load_cached_collision_proxy(path, "0000000000000000", state->n_bases, cached_vertices, cached_faces, cached_entries));
+	REQUIRE(load_cached_collision_proxy(path, hash, state->n_bases, cached_vertices, cached_faces, cached_entries));
+
+	CHECK(cached_vertices == proxy_vertices);
+	CHECK(cached_faces == proxy_faces);
+
+	Eigen::SparseMatrix<double> W(proxy_vertices.rows(), state->n_bases), cached_W(proxy_vertices.rows(), state->n_bases);
+	W.setFromTriplets(displacement_map_entries.begin(), displacement_map_entries.end());
+	cached_W.setFromTriplets(cached_entries.begin(), cached_entries.end());
+	CHECK((W - cached_W).norm() == 0);
+
+	std::filesystem::remove(path);
+}
+
 TEST_CASE("build collision proxy displacement map", "[build_collision_proxy]")
 {
 	const int discr_order = GENERATE(1, 2, 3, 4);
@@ -281,6 +281,143 @@ TEST_CASE("neohookean-stress-3d", tagsdiff)
 	verify_adjoint(*nl_problem, x, velocity_discrete, 1e-7, 1e-5);
 }
 
+TEST_CASE("warm-start", tagsdiff)
+{
+	json opt_args;
+	load_json(append_root_path("neohookean-stress-3d-opt.json"), opt_args);
+	json warm_args = opt_args;
+	warm_args["solver"]["advanced"]["warm_start"] = "extrapolate";
+
+	auto [obj, var2sim, states] = prepare_test(opt_args);
+	auto [warm_obj, warm_var2sim, warm_states] = prepare_test(warm_args);
+
+	AdjointNLProblem problem(obj, var2sim, states, opt_args);
+	AdjointNLProblem warm_problem(warm_obj, warm_var2sim, warm_states, warm_args);
+
+	Eigen::MatrixXd V;
+	states[0]->get_vertices(V);
+	const Eigen::VectorXd x = utils::flatten(V);
+	const Eigen::VectorXd dx = 1e-4 * Eigen::VectorXd::Random(x.size());
+
+	for (int i = 0; i < 3; i++)
+	{
+		problem.solution_changed(x + i * dx);
+		warm_problem.solution_changed(x + i * dx);
+		CHECK(warm_states[0]->warm_start_sol.size() == (i == 0 ? 0 : warm_states[0]->ndof()));
+
+		const Eigen::VectorXd u = states[0]->diff_cached.u(0);
+		const Eigen::VectorXd warm_u = warm_states[0]->diff_cached.u(0);
+		CHECK((warm_u - u).norm() <= 1e-6 * std::max(1., u.norm()));
+		CHECK(warm_problem.value(x + i * dx) == Catch::Approx(problem.value(x + i * dx)).epsilon(1e-6));
+	}
+}
+
+TEST_CASE("geometry-update", tagsdiff)
+{
+	json opt_args;
+	load_json(append_root_path("neohookean-stress-3d-opt.json"), opt_args);
+
+	auto [obj, var2sim, states] = prepare_test(opt_args);
+	auto [ref_obj, ref_var2sim, ref_states] = prepare_test(opt_args);
+	State &state = *states[0];
+	State &ref_state = *ref_states[0];
+
+	Eigen::MatrixXd V;
+	state.get_vertices(V);
+	V += 1e-3 * Eigen::MatrixXd::Random(V.rows(), V.cols());
+	for (int i = 0; i < V.rows(); i++)
+	{
+		state.set_mesh_vertex(i, V.row(i));
+		ref_state.set_mesh_vertex(i, V.row(i));
+	}
+
+	state.update_geometry();
+	ref_state.build_basis();
+
+	REQUIRE(state.n_bases == ref_state.n_bases);
+	for (int e = 0; e < state.bases.size(); e++)
+		for (int i = 0; i < state.bases[e].bases.size(); i++)
+			CHECK((state.bases[e].bases[i].global()[0].node - ref_state.bases[e].bases[i].global()[0].node).norm() < 1e-12);
+	CHECK(state.collision_mesh.num_vertices() == ref_state.collision_mesh.num_vertices());
+	CHECK((state.collision_mesh.rest_positions() - ref_state.collision_mesh.rest_positions()).norm() < 1e-12);
+
+	Eigen::MatrixXd sol, ref_sol, pressure;
+	for (State *s : {&state, &ref_state})
+	{
+		s->assemble_rhs();
+		s->assemble_mass_mat();
+	}
+	state.solve_problem(sol, pressure);
+	ref_state.solve_problem(ref_sol, pressure);
+	CHECK((sol - ref_sol).norm() <= 1e-8 * std::max(1., ref_sol.norm()));
+}
+
+TEST_CASE("parallel-derivative-check", tagsdiff)
+{
+	json opt_args;
+	load_json(append_root_path("neohookean-stress-3d-opt.json"), opt_args);
+	auto [obj, var2sim, states] = prepare_test(opt_args);
+
+	AdjointNLProblem problem(obj, var2sim, states, opt_args);
+
+	Eigen::MatrixXd V;
+	states[0]->get_vertices(V);
+	const Eigen::VectorXd x = utils::flatten(V);
+
+	problem.solution_changed(x);
+	Eigen::VectorXd grad;
+	problem.gradient(x, grad);
+
+	const Eigen::VectorXd errors = problem.check_derivatives(x, grad, 3, 1e-6, 2);
+	REQUIRE(errors.size() == 3);
+	CHECK(errors.maxCoeff() < 1e-4);
+}
+
+TEST_CASE("reduced-basis", "[test_adjoint]")
+{
+	const Eigen::MatrixXd modes = Eigen::MatrixXd::Random(50, 2);
+
+	ReducedBasis rom(3);
+	for (int i = 0; i < 5; i++)
+		rom.add_snapshot(modes * Eigen::Vector2d::Random());
+	CHECK(rom.n_snapshots() == 3);
+	REQUIRE(rom.size() == 2);
+
+	const Eigen::MatrixXd &basis = rom.basis();
+	CHECK((basis.transpose() * basis - Eigen::Matrix2d::Identity()).norm() < 1e-10);
+	CHECK((modes - basis * (basis.transpose() * modes)).norm() < 1e-10 * modes.norm());
+
+	rom.add_snapshot(Eigen::VectorXd::Random(20));
+	CHECK(rom.n_snapshots() == 1);
+	CHECK(rom.size() == 1);
+}
+
+TEST_CASE("reduced-model", tagsdiff)
+{
+	json opt_args;
+	load_json(append_root_path("neohookean-stress-3d-opt.json"), opt_args);
+	json reduced_args = opt_args;
+	reduced_args["solver"]["advanced"]["reduced_model"]["enabled"] = true;
+
+	auto [obj, var2sim, states] = prepare_test(opt_args);
+	auto [reduced_obj, reduced_var2sim, reduced_states] = prepare_test(reduced_args);
+
+	AdjointNLProblem problem(obj, var2sim, states, opt_args);
+	AdjointNLProblem reduced_problem(reduced_obj, reduced_var2sim, reduced_states, reduced_args);
+
+	Eigen::MatrixXd V;
+	states[0]->get_vertices(V);
+	const Eigen::VectorXd x = utils::flatten(V);
+	const Eigen::VectorXd dx = 1e-5 * Eigen::VectorXd::Random(x.size());
+
+	for (int i = 0; i < 4; i++)
+	{
+		problem.solution_changed(x + i * dx);
+		reduced_problem.solution_changed(x + i * dx);
+		CHECK(reduced_problem.value(x + i * dx) == Catch::Approx(problem.value(x + i * dx)).epsilon(1e-4));
+	}
+}
+
 TEST_CASE("shape-neumann-nodes", "[test_adjoint]")
 {
 	const std::string path = POLYFEM_DATA_DIR + std::string("/differentiable/input/");
@@ -1002,6 +1139,64 @@ TEST_CASE("shape-transient-friction", "[test_adjoint]")
 	verify_adjoint(*nl_problem, x, velocity_discrete, 1e-6, 1e-5);
 }
 
+TEST_CASE("transient-adjoint-checkpoints", "[test_adjoint]")
+{
+	json opt_args;
+	load_json(append_root_path("shape-transient-friction-opt.json"), opt_args);
+	auto [obj, var2sim, states] = prepare_test(opt_args);
+
+	json state_args;
+	load_json(opt_args["states"][0]["path"], state_args);
+	state_args["solver"]["advanced"]["adjoint_checkpoints"] = 2;
+	std::shared_ptr<State> checkpointed = AdjointOptUtils::create_state(state_args, solver::CacheLevel::Derivatives, 16);
+	REQUIRE(checkpointed->optimization_enabled == solver::CacheLevel::Checkpoints);
+
+	State &state = *states[0];
+	AdjointOptUtils::solve_pde(state);
+	AdjointOptUtils::solve_pde(*checkpointed);
+	CHECK(checkpointed->diff_cached.memory_usage() <= state.diff_cached.memory_usage());
+
+	// backward in time, as in the adjoint solve
+	const int time_steps = state.args["time"]["time_steps"];
+	for (int i = time_steps; i > 0; --i)
+	{
+		const StiffnessMatrix &expected = state.diff_cached.gradu_h(i);
+		const StiffnessMatrix diff = checkpointed->diff_cached.gradu_h(i) - expected;
+		CHECK(diff.norm() <= 1e-8 * std::max(1., expected.norm()));
+		CHECK(checkpointed->diff_cached.collision_set(i).size() == state.diff_cached.collision_set(i).size());
+		CHECK(checkpointed->diff_cached.friction_collision_set(i).size() == state.diff_cached.friction_collision_set(i).size());
+	}
+
+	const Eigen::MatrixXd rhs = Eigen::MatrixXd::Random(state.ndof(), time_steps + 1);
+	const Eigen::MatrixXd expected = state.solve_adjoint(rhs);
+	const Eigen::MatrixXd adjoint = checkpointed->solve_adjoint(rhs);
+	CHECK((adjoint - expected).norm() <= 1e-6 * std::max(1., expected.norm()));
+}
+
+TEST_CASE("batched-adjoint", "[test_adjoint]")
+{
+	json opt_args;
+	load_json(append_root_path("shape-transient-friction-opt.json"), opt_args);
+	auto [obj, var2sim, states] = prepare_test(opt_args);
+
+	State &state = *states[0];
+	AdjointOptUtils::solve_pde(state);
+
+	const int time_steps = state.args["time"]["time_steps"];
+	const std::vector<Eigen::MatrixXd> rhs = {
+		Eigen::MatrixXd::Random(state.ndof(), time_steps + 1),
+		Eigen::MatrixXd::Random(state.ndof(), time_steps + 1),
+		Eigen::MatrixXd::Random(state.ndof(), time_steps + 1)};
+
+	const std::vector<Eigen::MatrixXd> adjoints = state.solve_adjoint(rhs);
+	REQUIRE(adjoints.size() == rhs.size());
+	for (int k = 0; k < rhs.size(); k++)
+	{
+		const Eigen::MatrixXd expected = state.solve_adjoint(rhs[k]);
+		CHECK((adjoints[k] - expected).norm() <= 1e-8 * std::max(1., expected.norm()));
+	}
+}
+
 TEST_CASE("shape-transient-friction-sdf", "[test_adjoint]")
 {
 	json opt_args;
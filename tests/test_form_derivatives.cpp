@@ -18,12 +18,14 @@
 #include <polyfem/solver/forms/RayleighDampingForm.hpp>
 
 #include <polyfem/time_integrator/ImplicitEuler.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
 
 #include <finitediff.hpp>
 
 #include <polyfem/State.hpp>
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 #include <catch2/generators/catch_generators.hpp>
 
 #include <iostream>
@@ -222,6 +224,33 @@ void test_form(Form &form, const State &state, double step = 1e-8, double tol =
 			CHECK(fd::compare_hessian(Eigen::MatrixXd(hess), fhess, tol));
 		}
 
+		// Test matrix-free hessian-vector product against the assembled hessian
+		{
+			StiffnessMatrix hess;
+			form.second_derivative(x, hess);
+
+			const Eigen::VectorXd v = Eigen::VectorXd::Random(x.size());
+			Eigen::VectorXd hv;
+			form.hessian_vector_product(x, v, hv);
+
+			const Eigen::VectorXd expected = hess * v;
+			CHECK((hv - expected).norm() <= 1e-10 * std::max(1.0, expected.norm()));
+		}
+
+		// Test fused evaluation against the separate value and gradient
+		{
+			double value;
+			Eigen::VectorXd grad;
+			form.evaluate(x, &value, &grad, nullptr);
+
+			const double expected_value = form.value(x);
+			Eigen::VectorXd expected_grad;
+			form.first_derivative(x, expected_grad);
+
+			CHECK(std::abs(value - expected_value) <= 1e-10 * std::max(1.0, std::abs(expected_value)));
+			CHECK((grad - expected_grad).norm() <= 1e-10 * std::max(1.0, expected_grad.norm()));
+		}
+
 		x.setRandom();
 		x /= 100;
 	}
@@ -300,10 +329,44 @@ TEST_CASE("contact form derivatives", "[form][form_derivatives][contact_form]")
 		use_convergent_formulation, use_adaptive_barrier_stiffness,
 		is_time_dependent, false, broad_phase_method, ccd_tolerance,
 		ccd_max_iterations);
+	form.set_broad_phase_skin(GENERATE(0.0, 1e-2));
+	if (GENERATE(false, true))
+		REQUIRE(form.set_displacement_map(state_ptr->collision_mesh_topology.displacement_map));
 
 	test_form(form, *state_ptr);
 }
 
+TEST_CASE("contact form broad phase autotuning", "[form][contact_form]")
+{
+	const int dim = GENERATE(2, 3);
+	const auto state_ptr = get_state(dim);
+
+	const double dhat = 1e-3;
+	const auto make_form = [&]() {
+		return ContactForm(
+			state_ptr->collision_mesh, dhat, state_ptr->avg_mass,
+			/*use_convergent_formulation=*/false, /*use_adaptive_barrier_stiffness=*/true,
+			/*is_time_dependent=*/false, false, ipc::BroadPhaseMethod::HASH_GRID,
+			/*ccd_tolerance=*/1e-6, /*ccd_max_iterations=*/static_cast<int>(1e6));
+	};
+	ContactForm reference = make_form();
+	ContactForm form = make_form();
+	// two benchmarked calls, then benchmarked again after three calls
+	form.set_broad_phase_autotuning(2, 3);
+
+	const Eigen::VectorXd x0 = Eigen::VectorXd::Zero(state_ptr->n_bases * dim);
+	for (int i = 0; i < 8; ++i)
+	{
+		const Eigen::VectorXd x1 = Eigen::VectorXd::Random(x0.size()) / 100;
+		// every method builds valid candidates, the step does not depend on the selection
+		CHECK(form.max_step_size(x0, x1) == Catch::Approx(reference.max_step_size(x0, x1)));
+		CHECK(form.broad_phase_selections() == (i < 1 ? 0 : (i < 6 ? 1 : 2)));
+	}
+	CHECK(form.broad_phase_method() != ipc::BroadPhaseMethod::SWEEP_AND_TINIEST_QUEUE);
+	CHECK(reference.broad_phase_selections() == 0);
+	CHECK(reference.broad_phase_method() == ipc::BroadPhaseMethod::HASH_GRID);
+}
+
 TEST_CASE("elastic form derivatives", "[form][form_derivatives][elastic_form]")
 {
 	const int dim = GENERATE(2, 3);
@@ -335,6 +398,23 @@ TEST_CASE("pressure form derivatives", "[form][form_derivatives][pressure_form]"
 		*state_ptr->elasticity_pressure_assembler,
 		is_time_dependent);
 	test_form(form, *state_ptr);
+
+	// the assembler of the form scatters in its cached pattern, a new one builds it
+	const std::shared_ptr<PressureAssembler> other_assembler = state_ptr->build_pressure_assembler();
+	PressureForm other_form(
+		state_ptr->n_bases,
+		state_ptr->local_pressure_boundary,
+		state_ptr->local_pressure_cavity,
+		state_ptr->boundary_nodes,
+		state_ptr->n_boundary_samples(),
+		*other_assembler,
+		is_time_dependent);
+
+	const Eigen::VectorXd x = 1e-3 * Eigen::VectorXd::Random(state_ptr->n_bases * dim);
+	StiffnessMatrix cached, fresh;
+	form.second_derivative(x, cached);
+	other_form.second_derivative(x, fresh);
+	CHECK((cached - fresh).norm() <= 1e-12 * fresh.norm());
 }
 
 TEST_CASE("friction form derivatives", "[form][form_derivatives][friction_form]")
@@ -362,6 +442,8 @@ TEST_CASE("friction form derivatives", "[form][form_derivatives][friction_form]"
 	FrictionForm form(
 		state_ptr->collision_mesh, nullptr, epsv, mu, broad_phase_method, contact_form,
 		/*n_lagging_iters=*/-1);
+	if (GENERATE(false, true))
+		REQUIRE(form.set_displacement_map(state_ptr->collision_mesh_topology.displacement_map));
 
 	test_form(form, *state_ptr);
 }
@@ -405,6 +487,26 @@ TEST_CASE("inertia form derivatives", "[form][form_derivatives][inertia_form]")
 	test_form(form, *state_ptr);
 }
 
+TEST_CASE("lumped inertia form derivatives", "[form][form_derivatives][inertia_form]")
+{
+	const int dim = GENERATE(2, 3);
+	const auto state_ptr = get_state(dim);
+
+	const double dt = 1e-3;
+	ImplicitEuler time_integrator;
+	time_integrator.init(
+		Eigen::VectorXd::Zero(state_ptr->n_bases * dim),
+		Eigen::VectorXd::Zero(state_ptr->n_bases * dim),
+		Eigen::VectorXd::Zero(state_ptr->n_bases * dim),
+		dt);
+
+	const StiffnessMatrix lumped_mass = utils::lump_matrix(state_ptr->mass);
+	InertiaForm form(lumped_mass, time_integrator);
+	CHECK(form.is_lumped());
+
+	test_form(form, *state_ptr);
+}
+
 TEST_CASE("lagged regularization form derivatives", "[form][form_derivatives][lagged_reg_form]")
 {
 	const int dim = GENERATE(2, 3);
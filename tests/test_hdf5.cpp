@@ -4,6 +4,10 @@
 
 #include <h5pp/h5pp.h>
 
+#include <polyfem/io/TransientHDF5Writer.hpp>
+
+#include <filesystem>
+
 TEST_CASE("HDF5", "[hdf5]")
 {
 	using MatrixXl = Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic>;
@@ -28,4 +32,41 @@ TEST_CASE("HDF5", "[hdf5]")
 		cells[i] = file.readDataset<MatrixXl>("/meshes/" + name + "/c").cast<int>();
 		vertices[i] = file.readDataset<Eigen::MatrixXd>("/meshes/" + name + "/v");
 	}
-}
\ No newline at end of file
+}
+TEST_CASE("transient_hdf5", "[hdf5]")
+{
+	using RowMatrixXd = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+	const std::string path = (std::filesystem::temp_directory_path() / "polyfem_transient.hdf5").string();
+
+	Eigen::MatrixXd points(4, 2);
+	points << 0, 0, 1, 0, 1, 1, 0, 1;
+	Eigen::MatrixXi cells(2, 3);
+	cells << 0, 1, 2, 0, 2, 3;
+
+	Eigen::MatrixXd solution = Eigen::MatrixXd::Random(points.rows(), 2);
+	{
+		polyfem::io::TransientHDF5Writer writer(path, 4, {"solution"});
+		for (int i = 0; i < 3; ++i)
+		{
+			writer.add_field("solution", (i + 1) * solution);
+			writer.add_field("discr", Eigen::MatrixXd::Ones(points.rows(), 1));
+			writer.write_step(i * 0.1, points, cells);
+		}
+		CHECK(writer.n_steps() == 3);
+		CHECK(std::filesystem::exists(writer.xdmf_path()));
+	}
+
+	h5pp::File file(path, h5pp::FileAccess::READONLY);
+	// The mesh does not change so it is written once
+	CHECK(file.linkExists("/meshes/0/points"));
+	CHECK(!file.linkExists("/meshes/1"));
+	// Only the selected fields are exported
+	CHECK(!file.linkExists("/steps/0/discr"));
+
+	for (int i = 0; i < 3; ++i)
+	{
+		const RowMatrixXd sol = file.readDataset<RowMatrixXd>("/steps/" + std::to_string(i) + "/solution");
+		CHECK(sol.isApprox((i + 1) * solution));
+	}
+}
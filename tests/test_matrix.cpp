@@ -3,9 +3,12 @@
 #include <polyfem/utils/MatrixUtils.hpp>
 #include <polyfem/autogen/auto_eigs.hpp>
 #include <polyfem/utils/AutodiffTypes.hpp>
+#include <polyfem/io/HDF5Dataset.hpp>
+#include <polyfem/io/MatrixIO.hpp>
 
 #include <iostream>
 #include <cmath>
+#include <filesystem>
 
 #include <Eigen/Dense>
 
@@ -247,3 +250,94 @@ TEST_CASE("cache", "[matrix]")
 	REQUIRE(tmp2.coeff(9, 4) == 6);
 	REQUIRE(tmp2.coeff(9, 9) == 4);
 }
+
+TEST_CASE("cache_numeric_phase", "[matrix]")
+{
+	SparseMatrixCache cache(10);
+	cache.add_value(0, 0, 0, 1);
+	cache.add_value(0, 0, 1, 2);
+	cache.add_value(1, 9, 4, 3);
+	cache.add_value(1, 9, 9, 4);
+	REQUIRE(!cache.has_pattern());
+
+	// symbolic phase
+	cache.get_matrix();
+	REQUIRE(cache.has_pattern());
+	REQUIRE(cache.element_slots(0).size() == 2);
+	REQUIRE(cache.element_slots(1).size() == 2);
+
+	// numeric phase on two caches sharing the pattern
+	SparseMatrixCache local0(cache), local1(cache);
+	const std::vector<StorageIndex> &slots0 = local0.element_slots(0);
+	local0.values_data()[slots0[0]] += 1;
+	local0.values_data()[slots0[1]] += 2;
+
+	local1.add_value(1, 9, 4, 3);
+	local1.add_value(1, 9, 9, 4);
+
+	cache.set_zero();
+	cache.accumulate({&local0, &local1});
+	const auto tmp = cache.get_matrix();
+
+	REQUIRE(tmp.coeff(0, 0) == 1);
+	REQUIRE(tmp.coeff(0, 1) == 2);
+	REQUIRE(tmp.coeff(9, 4) == 3);
+	REQUIRE(tmp.coeff(9, 9) == 4);
+
+	// the slots index the non-zeros of the matrices, they follow their index type
+	STATIC_REQUIRE(std::is_same_v<std::decay_t<decltype(slots0)>::value_type, StiffnessMatrix::StorageIndex>);
+}
+
+TEST_CASE("full_to_reduced_matrix_in_place", "[matrix]")
+{
+	const int n = 30;
+	Eigen::MatrixXd dense = Eigen::MatrixXd::Random(n, n);
+	dense = (dense.array().abs() < 0.6).select(0, dense);
+	const StiffnessMatrix full = dense.sparseView();
+
+	std::vector<int> removed_vars;
+	for (int i = 0; i < n; i += 3)
+		removed_vars.push_back(i);
+	const int reduced_size = n - removed_vars.size();
+
+	StiffnessMatrix expected;
+	full_to_reduced_matrix(n, reduced_size, removed_vars, full, expected);
+
+	StiffnessMatrix reduced = full;
+	full_to_reduced_matrix_in_place(removed_vars, reduced);
+
+	REQUIRE(reduced.rows() == reduced_size);
+	REQUIRE(reduced.cols() == reduced_size);
+	REQUIRE(reduced.isCompressed());
+	CHECK((Eigen::MatrixXd(reduced) - Eigen::MatrixXd(expected)).norm() == 0);
+}
+
+TEST_CASE("hdf5_dataset", "[matrix]")
+{
+	const std::string path = (std::filesystem::temp_directory_path() / "polyfem_test_dataset.hdf5").string();
+	const Eigen::MatrixXd mat = Eigen::MatrixXd::Random(1000, 3);
+	REQUIRE(io::write_matrix(path, "mat", mat));
+
+	io::HDF5Dataset dataset(path, "mat");
+	REQUIRE(dataset.exists());
+	CHECK(dataset.rows() == mat.rows());
+	CHECK(dataset.cols() == mat.cols());
+	CHECK(!io::HDF5Dataset(path, "missing").exists());
+
+	Eigen::MatrixXd read;
+	REQUIRE(dataset.read(read));
+	CHECK(read == mat);
+
+	REQUIRE(dataset.read_rows(10, 5, read));
+	CHECK(read == mat.middleRows(10, 5));
+	CHECK(!dataset.read_rows(999, 2, read));
+
+	// mapped or not, the data is row major
+	if (const double *data = dataset.mapped_data())
+		CHECK(Eigen::Map<const io::HDF5Dataset::RowMatrixXd>(data, mat.rows(), mat.cols()) == mat);
+
+	REQUIRE(io::read_matrix(path, "mat", read));
+	CHECK(read == mat);
+
+	std::filesystem::remove(path);
+}
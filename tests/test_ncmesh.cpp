@@ -188,3 +188,29 @@ TEST_CASE("ncmesh3d", "[ncmesh]")
 	REQUIRE(fabs(state.stats.h1_semi_err) < 1e-7);
 	REQUIRE(fabs(state.stats.l2_err) < 1e-8);
 }
+
+TEST_CASE("ncmesh3d_coarsen", "[ncmesh]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	std::unique_ptr<Mesh> mesh = Mesh::create(path + "/contact/meshes/3D/simple/bar/bar-186.msh", /*non_conforming=*/true);
+	REQUIRE(mesh != nullptr);
+	NCMesh3D &ncmesh = *dynamic_cast<NCMesh3D *>(mesh.get());
+
+	const int n_cells = ncmesh.n_cells();
+	std::vector<int> ids(n_cells);
+	for (int i = 0; i < n_cells; i++)
+		ids[i] = i;
+
+	ncmesh.refine_elements(ids);
+	ncmesh.prepare_mesh();
+	REQUIRE(ncmesh.n_cells() == 8 * n_cells);
+
+	// every child is listed, each parent is coarsened once
+	ids.resize(ncmesh.n_cells());
+	for (int i = 0; i < ids.size(); i++)
+		ids[i] = i;
+
+	ncmesh.coarsen_elements(ids);
+	ncmesh.prepare_mesh();
+	REQUIRE(ncmesh.n_cells() == n_cells);
+}
@@ -1,10 +1,14 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 #include <catch2/generators/catch_generators.hpp>
 
 #include <polyfem/State.hpp>
 #include <polyfem/Common.hpp>
 #include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/RefElementSampler.hpp>
+
+#include <Eigen/Eigenvalues>
 
 #include <filesystem>
 #include <iostream>
@@ -82,3 +86,264 @@ TEST_CASE("full sim", "[.][full_sim]")
 
 	std::filesystem::remove_all(outdir);
 }
+
+TEST_CASE("convergence_study", "[output]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"(
+		{
+			"materials": {"type": "Laplacian"},
+
+			"geometry": [{
+				"mesh": "",
+				"enabled": true,
+				"type": "mesh",
+				"surface_selection": 7
+			}],
+
+			"space": {
+				"discr_order": 1
+			},
+
+			"boundary_conditions": {
+				"dirichlet_boundary": [{
+					"id": "all",
+					"value": "x^3+y^3"
+				}],
+				"rhs": "6*x+6*y"
+			},
+
+			"output": {
+				"reference": {
+					"solution": "x^3+y^3",
+					"gradient": ["3*x^2","3*y^2"]
+				},
+				"advanced": {
+					"convergence_study": {
+						"levels": 2,
+						"file": ""
+					}
+				}
+			}
+		})"_json;
+	in_args["geometry"][0]["mesh"] = path + "/contact/meshes/2D/simple/circle/circle36.obj";
+
+	State state;
+	state.init_logger("", spdlog::level::off, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	const int n_coarse_elements = state.mesh->n_elements();
+
+	Eigen::MatrixXd sol, pressure;
+	state.convergence_study(sol, pressure);
+
+	CHECK(state.mesh->n_elements() == 16 * n_coarse_elements);
+	CHECK(sol.rows() == state.n_bases);
+	CHECK(state.prolongated_solution.size() == 0);
+	CHECK(std::isfinite(state.stats.l2_err));
+}
+
+TEST_CASE("load_cases", "[output]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"(
+		{
+			"materials": {"type": "Laplacian"},
+
+			"geometry": [{
+				"mesh": "",
+				"enabled": true,
+				"type": "mesh",
+				"surface_selection": 7
+			}],
+
+			"boundary_conditions": {
+				"dirichlet_boundary": [{
+					"id": "all",
+					"value": "x^3+y^3"
+				}],
+				"rhs": "6*x+6*y"
+			},
+
+			"load_cases": [
+				{"name": "base"},
+				{
+					"name": "double",
+					"boundary_conditions": {
+						"dirichlet_boundary": [{
+							"id": "all",
+							"value": "2*x^3+2*y^3"
+						}],
+						"rhs": "12*x+12*y"
+					}
+				}
+			],
+
+			"output": {
+				"json": "",
+				"paraview": {"file_name": ""}
+			}
+		})"_json;
+	in_args["geometry"][0]["mesh"] = path + "/contact/meshes/2D/simple/circle/circle36.obj";
+
+	State state;
+	state.init_logger("", spdlog::level::off, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+	state.assemble_rhs();
+	state.assemble_mass_mat();
+
+	Eigen::MatrixXd sols;
+	state.solve_load_cases(sols);
+
+	REQUIRE(sols.cols() == 2);
+	CHECK(sols.rows() == state.n_bases);
+	// the problem is linear in the loads and boundary values
+	CHECK((sols.col(1) - 2 * sols.col(0)).norm() <= 1e-8 * sols.col(1).norm());
+
+	// the surfaces of the boundary conditions are shared by all the cases
+	in_args["load_cases"][1]["boundary_conditions"]["dirichlet_boundary"][0]["id"] = 1;
+	State other_state;
+	other_state.init_logger("", spdlog::level::off, spdlog::level::off, false);
+	other_state.init(in_args, true);
+	other_state.load_mesh();
+	other_state.build_basis();
+	CHECK_THROWS(other_state.solve_load_cases(sols));
+}
+
+TEST_CASE("modal_analysis", "[output]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"(
+		{
+			"materials": {"type": "Laplacian"},
+
+			"geometry": [{
+				"mesh": "",
+				"enabled": true,
+				"type": "mesh",
+				"surface_selection": 7
+			}],
+
+			"space": {"discr_order": 2},
+
+			"boundary_conditions": {
+				"dirichlet_boundary": [{
+					"id": "all",
+					"value": 0
+				}]
+			},
+
+			"modal_analysis": {
+				"n_modes": 5,
+				"block_size": 2
+			},
+
+			"output": {
+				"json": "",
+				"paraview": {"file_name": ""}
+			}
+		})"_json;
+	in_args["geometry"][0]["mesh"] = path + "/contact/meshes/2D/simple/circle/circle36.obj";
+
+	State state;
+	state.init_logger("", spdlog::level::off, spdlog::level::off, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	Eigen::VectorXd eigenvalues;
+	Eigen::MatrixXd modes;
+	state.modal_analysis(eigenvalues, modes);
+
+	REQUIRE(eigenvalues.size() == 5);
+	REQUIRE(modes.rows() == state.n_bases);
+
+	// reference: dense generalized eigenproblem on the free dofs
+	StiffnessMatrix K, M;
+	state.build_stiffness_mat(K);
+	state.mass_matrix_assembler->assemble(false, state.n_bases, state.bases, state.geom_bases(), state.mass_ass_vals_cache, 0, M, true);
+
+	std::vector<bool> is_fixed(state.n_bases, false);
+	for (const int i : state.boundary_nodes)
+		is_fixed[i] = true;
+	std::vector<int> free_dofs;
+	for (int i = 0; i < state.n_bases; ++i)
+	{
+		if (!is_fixed[i])
+			free_dofs.push_back(i);
+	}
+	const Eigen::MatrixXd K_free = Eigen::MatrixXd(K)(free_dofs, free_dofs);
+	const Eigen::MatrixXd M_free = Eigen::MatrixXd(M)(free_dofs, free_dofs);
+	const Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixXd> reference(K_free, M_free);
+
+	for (int i = 0; i < 5; ++i)
+		CHECK(eigenvalues(i) == Catch::Approx(reference.eigenvalues()(i)).epsilon(1e-6));
+
+	// the modes vanish on the Dirichlet nodes and are M-orthonormal
+	for (const int i : state.boundary_nodes)
+		CHECK(modes.row(i).norm() == 0);
+	CHECK((modes.transpose() * M * modes - Eigen::MatrixXd::Identity(5, 5)).norm() < 1e-6);
+}
+
+TEST_CASE("solution_frame_buffer", "[output]")
+{
+	using io::SolutionFrameBuffer;
+	const auto compression = GENERATE(SolutionFrameBuffer::Compression::NONE, SolutionFrameBuffer::Compression::FLOAT32, SolutionFrameBuffer::Compression::INT16);
+
+	SolutionFrameBuffer buffer(3, SolutionFrameBuffer::Storage::DOFS, compression);
+	int n_callbacks = 0;
+	buffer.set_callback([&](const int, const double, const Eigen::MatrixXd &, const Eigen::MatrixXd &, const io::SolutionFrame &) { ++n_callbacks; });
+
+	std::vector<Eigen::MatrixXd> sols;
+	for (int step = 0; step < 5; ++step)
+	{
+		sols.push_back(Eigen::MatrixXd::Random(100, 1));
+		buffer.push(step, 0.1 * step, sols.back(), Eigen::MatrixXd(), io::SolutionFrame());
+	}
+
+	CHECK(n_callbacks == 5);
+	REQUIRE(buffer.size() == 3);
+	CHECK(buffer.n_dropped() == 2);
+
+	const double tol = compression == SolutionFrameBuffer::Compression::NONE ? 0 : (compression == SolutionFrameBuffer::Compression::FLOAT32 ? 1e-6 : 1e-4);
+	for (int i = 0; i < buffer.size(); ++i)
+	{
+		CHECK(buffer.step(i) == i + 2);
+		Eigen::MatrixXd sol, pressure;
+		buffer.dofs(i, sol, pressure);
+		REQUIRE(sol.rows() == 100);
+		CHECK(pressure.size() == 0);
+		CHECK((sol - sols[i + 2]).cwiseAbs().maxCoeff() <= tol);
+	}
+}
+
+TEST_CASE("ref_element_sampler_per_element", "[output]")
+{
+	using Sampling = RefElementSampler::Sampling;
+
+	for (const bool is_volume : {false, true})
+	{
+		RefElementSampler sampler;
+		sampler.init(is_volume, 100, 1e-3);
+		const int n_corners = is_volume ? 4 : 3;
+
+		// without per element sampling, every element uses the uniform one
+		CHECK(sampler.simplex_points(0) == sampler.simplex_points());
+		CHECK(sampler.simplex_volume(5) == sampler.simplex_volume());
+
+		sampler.set_element_sampling({Sampling::LINEAR, Sampling::UNIFORM, Sampling::CURVED});
+
+		CHECK(sampler.simplex_points(0).rows() == n_corners);
+		CHECK(sampler.simplex_volume(0).rows() == 1);
+		CHECK(sampler.simplex_points(1) == sampler.simplex_points());
+		CHECK(sampler.simplex_points(2).rows() >= sampler.simplex_points().rows());
+		CHECK(sampler.simplex_edges(2).rows() >= sampler.simplex_edges().rows());
+		// elements past the list are uniform
+		CHECK(sampler.simplex_points(3) == sampler.simplex_points());
+
+		sampler.clear_element_sampling();
+		CHECK(sampler.simplex_points(0) == sampler.simplex_points());
+	}
+}
@@ -66,4 +66,29 @@ TEST_CASE("bbw-test", "[parametrization]")
 	verify_apply_jacobian(lbs_with_bbw, y);
 }
 
+TEST_CASE("composite-parametrization-cache", "[parametrization]")
+{
+	const int n = 10;
+	Eigen::VectorXd x = Eigen::VectorXd::Random(n);
+
+	CompositeParametrization affine({std::make_shared<SliceMap>(2, 8, n), std::make_shared<Scaling>(3., 1, 4), std::make_shared<InsertConstantMap>(3, 0.5, 2)});
+	REQUIRE(affine.is_affine());
+
+	Eigen::VectorXd y_ref = SliceMap(2, 8, n).eval(x);
+	y_ref = Scaling(3., 1, 4).eval(y_ref);
+	y_ref = InsertConstantMap(3, 0.5, 2).eval(y_ref);
+
+	const Eigen::VectorXd y = affine.eval(x);
+	REQUIRE((y - y_ref).norm() < 1e-14);
+	REQUIRE((affine.eval(x) - y).norm() == 0);
+
+	const Eigen::MatrixXd jacobian = affine.affine_jacobian(n);
+	REQUIRE((jacobian * x + affine.eval(Eigen::VectorXd::Zero(n)) - y).norm() < 1e-14);
+	verify_apply_jacobian(affine, y);
+
+	CompositeParametrization mixed({std::make_shared<SliceMap>(2, 8, n), std::make_shared<ExponentialMap>(), std::make_shared<Scaling>(3., 1, 4), std::make_shared<InsertConstantMap>(3, 0.5, 2)});
+	REQUIRE(!mixed.is_affine());
+	verify_apply_jacobian(mixed, mixed.eval(x));
+}
+
 #endif
@@ -1,6 +1,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 #ifdef POLYFEM_WITH_TBB
 
+#include <polyfem/State.hpp>
+#include <polyfem/utils/JSONUtils.hpp>
+
 #include <catch2/catch_test_macros.hpp>
 #include <iostream>
 #include <tbb/blocked_range.h>
@@ -8,6 +11,49 @@
 #include <tbb/enumerable_thread_specific.h>
 ////////////////////////////////////////////////////////////////////////////////
 
+using namespace polyfem;
+
+namespace
+{
+	Eigen::MatrixXd solve_laplacian(const std::string &rhs)
+	{
+		json in_args = R"(
+		{
+			"materials": {"type": "Laplacian"},
+
+			"geometry": [{
+				"mesh": "",
+				"enabled": true,
+				"type": "mesh",
+				"surface_selection": 7
+			}],
+
+			"space": {
+				"discr_order": 1
+			},
+
+			"boundary_conditions": {
+				"dirichlet_boundary": [{
+					"id": "all",
+					"value": 0
+				}],
+				"rhs": ""
+			}
+		})"_json;
+		in_args["geometry"][0]["mesh"] = std::string(POLYFEM_DATA_DIR) + "/contact/meshes/2D/simple/circle/circle36.obj";
+		in_args["boundary_conditions"]["rhs"] = rhs;
+
+		State state;
+		state.init_logger("", spdlog::level::off, spdlog::level::off, false);
+		state.init(in_args, true);
+		state.load_mesh();
+
+		Eigen::MatrixXd sol, pressure;
+		state.solve(sol, pressure);
+		return sol;
+	}
+} // namespace
+
 TEST_CASE("parallel_for", "[tbb_test]")
 {
 	std::vector<int> data(100000);
@@ -35,4 +81,22 @@ TEST_CASE("parallel_for_memory", "[tbb_test]")
 	}
 }
 
+TEST_CASE("concurrent_states", "[tbb_test]")
+{
+	const std::vector<std::string> rhs = {"1", "x", "y", "x*y", "x^2+y^2", "2", "x-y", "1+x*y"};
+
+	std::vector<Eigen::MatrixXd> serial(rhs.size());
+	for (int i = 0; i < rhs.size(); ++i)
+		serial[i] = solve_laplacian(rhs[i]);
+
+	std::vector<Eigen::MatrixXd> concurrent(rhs.size());
+	tbb::parallel_for(size_t(0), rhs.size(), [&](size_t i) { concurrent[i] = solve_laplacian(rhs[i]); });
+
+	for (int i = 0; i < rhs.size(); ++i)
+	{
+		REQUIRE(concurrent[i].rows() == serial[i].rows());
+		CHECK((concurrent[i] - serial[i]).norm() <= 1e-10 * std::max(1.0, serial[i].norm()));
+	}
+}
+
 #endif
@@ -1,12 +1,21 @@
 #include <polyfem/time_integrator/ImplicitEuler.hpp>
 #include <polyfem/time_integrator/ImplicitNewmark.hpp>
 #include <polyfem/time_integrator/BDF.hpp>
+#include <polyfem/time_integrator/ExplicitTimeIntegrator.hpp>
+#include <polyfem/time_integrator/TimeStepController.hpp>
+#include <polyfem/time_integrator/Parareal.hpp>
+#include <polyfem/io/MatrixIO.hpp>
 
 #include <finitediff.hpp>
 
+#include <Eigen/Eigenvalues>
+
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 #include <catch2/generators/catch_generators.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
 
+#include <filesystem>
 #include <iostream>
 #include <memory>
 
@@ -100,4 +109,196 @@ TEST_CASE("time integrator", "[time_integrator]")
 		x.setRandom();
 		x /= 100;
 	}
-}
\ No newline at end of file
+}
+TEST_CASE("explicit time integrator", "[time_integrator]")
+{
+	// chain of n unit masses and springs, fixed at the first node
+	const int n = 20;
+	std::vector<Eigen::Triplet<double>> triplets;
+	for (int i = 0; i + 1 < n; ++i)
+	{
+		triplets.emplace_back(i, i, 1);
+		triplets.emplace_back(i + 1, i + 1, 1);
+		triplets.emplace_back(i, i + 1, -1);
+		triplets.emplace_back(i + 1, i, -1);
+	}
+	StiffnessMatrix K(n, n);
+	K.setFromTriplets(triplets.begin(), triplets.end());
+	const Eigen::VectorXd mass = Eigen::VectorXd::Ones(n);
+	const std::vector<int> fixed_dofs = {0};
+
+	const double critical_dt = ExplicitTimeIntegrator::critical_time_step(K, mass, fixed_dofs, 1000);
+	const double omega_max = std::sqrt(Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd>(Eigen::MatrixXd(K).bottomRightCorner(n - 1, n - 1)).eigenvalues().maxCoeff());
+	CHECK(critical_dt >= 2 / omega_max);
+	CHECK(critical_dt <= 1.02 * 2 / omega_max);
+
+	const std::string type = GENERATE(std::string("CentralDifference"), std::string("SymplecticEuler"));
+	json params;
+	params["type"] = type;
+	CHECK(ExplicitTimeIntegrator::is_explicit(params));
+	CHECK(!ExplicitTimeIntegrator::is_explicit("ImplicitEuler"));
+	const std::shared_ptr<ExplicitTimeIntegrator> integrator = ExplicitTimeIntegrator::construct_time_integrator(params);
+
+	const auto constrain = [](Eigen::VectorXd &x) { x(0) = 0; };
+	int n_evaluations = 0;
+	const auto acceleration = [&](const Eigen::VectorXd &x) -> Eigen::VectorXd {
+		++n_evaluations;
+		Eigen::VectorXd a = -(K * x).cwiseQuotient(mass);
+		a(0) = 0;
+		return a;
+	};
+	const auto energy = [&](const Eigen::VectorXd &x, const Eigen::VectorXd &v) {
+		return 0.5 * v.dot(mass.asDiagonal() * v) + 0.5 * x.dot(K * x);
+	};
+
+	// uniform stretch of the chain
+	const Eigen::VectorXd x0 = Eigen::VectorXd::LinSpaced(n, 0, 0.1);
+	const Eigen::VectorXd v0 = Eigen::VectorXd::Zero(n);
+	const double dt = 0.5 * critical_dt;
+	integrator->init(x0, v0, acceleration(x0), dt);
+	n_evaluations = 0;
+
+	const double e0 = energy(x0, v0);
+	const int n_steps = 1000;
+	for (int i = 0; i < n_steps; ++i)
+	{
+		integrator->step(constrain, acceleration);
+
+		CHECK(integrator->x()(0) == 0);
+		// symplectic, the energy oscillates without drifting
+		CHECK_THAT(energy(integrator->x(), integrator->v()), Catch::Matchers::WithinRel(e0, 0.05));
+	}
+	CHECK(n_evaluations == n_steps);
+}
+
+TEST_CASE("adaptive time step", "[time_integrator]")
+{
+	// cubic trajectory, reproduced exactly by the BDF3 predictor and the resampling of the history
+	const int n = 5;
+	const Eigen::VectorXd c0 = Eigen::VectorXd::Random(n), c1 = Eigen::VectorXd::Random(n);
+	const Eigen::VectorXd c2 = Eigen::VectorXd::Random(n), c3 = Eigen::VectorXd::Random(n);
+	const auto x = [&](const double t) -> Eigen::VectorXd { return c0 + t * (c1 + t * (c2 + t * c3)); };
+	const auto v = [&](const double t) -> Eigen::VectorXd { return c1 + t * (2 * c2 + 3 * t * c3); };
+	const auto a = [&](const double t) -> Eigen::VectorXd { return 2 * c2 + 6 * t * c3; };
+
+	const double dt = 0.1;
+	Eigen::MatrixXd x_prevs(n, 3), v_prevs(n, 3), a_prevs(n, 3);
+	for (int i = 0; i < 3; ++i)
+	{
+		x_prevs.col(i) = x(-i * dt);
+		v_prevs.col(i) = v(-i * dt);
+		a_prevs.col(i) = a(-i * dt);
+	}
+
+	BDF bdf(3);
+	bdf.init(x_prevs, v_prevs, a_prevs, dt);
+	CHECK(bdf.order() == 3);
+	CHECK((bdf.predict() - x(dt)).norm() < 1e-12);
+
+	const double new_dt = GENERATE(0.05, 0.15);
+	bdf.set_dt(new_dt);
+	CHECK(bdf.dt() == new_dt);
+	for (int i = 0; i < 3; ++i)
+	{
+		// quadratic interpolation of the three previous values
+		const double s = -i * new_dt;
+		const Eigen::VectorXd expected = x(s) - s * (s + dt) * (s + 2 * dt) * c3;
+		CHECK((bdf.x_prevs()[i] - expected).norm() < 1e-12);
+	}
+
+	const json params = R"({
+		"tolerance": 1e-3,
+		"safety": 0.9,
+		"min_factor": 0.2,
+		"max_factor": 2,
+		"min_dt": 1e-8,
+		"max_dt": 0,
+		"max_retries": 20,
+		"min_ccd_step": 0.1
+	})"_json;
+	const TimeStepController controller(params, 1);
+
+	CHECK(controller.error(Eigen::VectorXd::Constant(n, 1e-3), Eigen::VectorXd::Zero(n)) == Catch::Approx(1));
+	CHECK(controller.next_dt(dt, 1, 1) == Catch::Approx(0.9 * dt));
+	CHECK(controller.next_dt(dt, 0, 1) == Catch::Approx(2 * dt));
+	CHECK(controller.next_dt(dt, 1e6, 1) == Catch::Approx(0.2 * dt));
+	CHECK(controller.next_dt(dt, 8, 2) == Catch::Approx(0.45 * dt));
+	CHECK(controller.shrink(dt) == Catch::Approx(0.5 * dt));
+	CHECK(controller.shrink(1e-8) == 1e-8);
+}
+
+TEST_CASE("time step predictor", "[time_integrator]")
+{
+	const int n = 4;
+	const double dt = 0.1;
+	const Eigen::VectorXd x = Eigen::VectorXd::Random(n), v = Eigen::VectorXd::Random(n), a = Eigen::VectorXd::Random(n);
+
+	ImplicitEuler euler;
+	euler.init(x, v, a, dt);
+
+	CHECK(euler.predict(json("none").get<Predictor>()) == x);
+	CHECK((euler.predict(json("constant_velocity").get<Predictor>()) - (x + dt * v)).norm() < 1e-14);
+	CHECK((euler.predict(json("constant_acceleration").get<Predictor>()) - (x + dt * v + 0.5 * dt * dt * a)).norm() < 1e-14);
+	CHECK(euler.predict(Predictor::EXTRAPOLATION) == euler.predict(Predictor::CONSTANT_ACCELERATION));
+
+	// BDF1 extrapolates the solution with the last velocity
+	BDF bdf(1);
+	bdf.init(x, v, a, dt);
+	CHECK((bdf.predict(Predictor::EXTRAPOLATION) - (x + dt * v)).norm() < 1e-14);
+}
+
+TEST_CASE("parareal", "[time_integrator]")
+{
+	// x' = -x on slices of length h, exact fine propagator and one implicit Euler step as coarse propagator
+	const int n_slices = 8;
+	const double h = 0.25;
+	const Eigen::VectorXd u0 = Eigen::VectorXd::Ones(2);
+
+	const Parareal::Propagator fine = [&](const int slice, const Eigen::VectorXd &u) -> Eigen::VectorXd { return u * std::exp(-h); };
+	const Parareal::Propagator coarse = [&](const int slice, const Eigen::VectorXd &u) -> Eigen::VectorXd { return u / (1 + h); };
+
+	const int max_iterations = GENERATE(1, 3, 8);
+	Parareal parareal(json{{"slices", n_slices}, {"coarse_steps", 1}, {"max_iterations", max_iterations}, {"tolerance", 0}}, 1);
+	const std::vector<Eigen::VectorXd> u = parareal.solve(u0, n_slices, 1, coarse, fine);
+
+	REQUIRE(u.size() == n_slices + 1);
+	CHECK(parareal.iterations() == max_iterations);
+	// after k iterations the first k slices are exact
+	for (int n = 0; n <= max_iterations; ++n)
+		CHECK(u[n](0) == Catch::Approx(std::exp(-h * n)));
+	if (max_iterations == n_slices)
+		CHECK(u.back()(1) == Catch::Approx(std::exp(-h * n_slices)));
+
+	// converged corrections stop the iteration
+	Parareal converged(json{{"slices", n_slices}, {"coarse_steps", 1}, {"max_iterations", n_slices}, {"tolerance", 1e-2}}, 1);
+	converged.solve(u0, n_slices, 2, coarse, fine);
+	CHECK(converged.iterations() < n_slices);
+}
+
+TEST_CASE("binary time integrator state", "[time_integrator]")
+{
+	const int n = 6;
+	BDF bdf(2);
+	bdf.init(Eigen::MatrixXd::Random(n, 2), Eigen::MatrixXd::Random(n, 2), Eigen::MatrixXd::Random(n, 2), 0.1);
+
+	const std::string path = (std::filesystem::temp_directory_path() / "polyfem_test_state.bin").string();
+	bdf.save_state(path);
+	// a second save replaces the first one
+	bdf.save_state(path);
+
+	Eigen::MatrixXd u, v, a;
+	REQUIRE(io::read_matrix(path, "u", u));
+	REQUIRE(io::read_matrix(path, "v", v));
+	REQUIRE(io::read_matrix(path, "a", a));
+	CHECK(!io::read_matrix(path, "p", u));
+
+	REQUIRE(u.cols() == 2);
+	for (int i = 0; i < 2; ++i)
+	{
+		CHECK(u.col(i) == bdf.x_prevs()[i]);
+		CHECK(v.col(i) == bdf.v_prevs()[i]);
+		CHECK(a.col(i) == bdf.a_prevs()[i]);
+	}
+
+	std::filesystem::remove(path);
+}
@@ -6,13 +6,24 @@
 #include <polyfem/io/MshReader.hpp>
 #include <polyfem/mesh/Mesh.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/ElasticityUtils.hpp>
+#include <polyfem/utils/svd.hpp>
+#include <polyfem/utils/AutodiffTypes.hpp>
+#include <polyfem/utils/Profiler.hpp>
+#include <polyfem/utils/MemoryUsage.hpp>
+#include <polyfem/utils/SparseMatrixSpill.hpp>
+
+#include <nlohmann/json.hpp>
 
 #include <wmtk/TriMesh.h>
 
 #include <Eigen/Dense>
 
+#include <filesystem>
+
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <catch2/generators/catch_generators.hpp>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -72,6 +83,28 @@ TEST_CASE("rbf_interpolate", "[utils]")
 #endif
 }
 
+TEST_CASE("rbf_interpolate_compact", "[utils]")
+{
+#ifndef POLYFEM_OPENCL
+	const int n = 200;
+	Eigen::MatrixXd in_pts(n, 3);
+	Eigen::MatrixXd fun(n, 2);
+	for (int i = 0; i < n; ++i)
+	{
+		in_pts.row(i) << (i % 7) / 6.0, ((i / 7) % 6) / 5.0, (i / 42) / 4.0;
+		fun.row(i) << in_pts(i, 0) * in_pts(i, 1), in_pts(i, 2);
+	}
+
+	// compact (sparse solve) and truncated gaussian reproduce the data at the centers
+	for (const std::string rbf : {"wendland", "gaussian"})
+	{
+		RBFInterpolation rbf_fun(fun, in_pts, rbf, rbf == "wendland" ? 0.5 : 0.2);
+		const Eigen::MatrixXd actual = rbf_fun.interpolate(in_pts);
+		REQUIRE((actual - fun).cwiseAbs().maxCoeff() == Catch::Approx(0).margin(1e-8));
+	}
+#endif
+}
+
 TEST_CASE("bessel", "[utils]")
 {
 	REQUIRE(bessy0(0.1) == Catch::Approx(-1.534238651350367).margin(1e-8));
@@ -107,6 +140,39 @@ TEST_CASE("expression", "[utils]")
 	REQUIRE(val(2, 3, 4) == Catch::Approx(1).margin(1e-16));
 }
 
+TEST_CASE("expression_batch", "[utils]")
+{
+	utils::ExpressionValue expr;
+	expr.init(json("min(x, y) + if(z, t^2, 1) * sin(2 * pi)"));
+	utils::ExpressionValue time_only;
+	time_only.init(json("2*t + 1"));
+	utils::ExpressionValue val;
+	val.init(json(3));
+
+	expr.set_unit_type("");
+	time_only.set_unit_type("");
+	val.set_unit_type("");
+
+	const Eigen::MatrixXd pts = Eigen::MatrixXd::Random(20, 3);
+	const double t = 0.3;
+
+	Eigen::VectorXd res;
+	expr(pts, t, res);
+	REQUIRE(res.size() == pts.rows());
+	for (int i = 0; i < pts.rows(); ++i)
+		REQUIRE(res(i) == Catch::Approx(expr(pts(i, 0), pts(i, 1), pts(i, 2), t)).margin(1e-14));
+
+	expr(pts.leftCols(2), t, res);
+	for (int i = 0; i < pts.rows(); ++i)
+		REQUIRE(res(i) == Catch::Approx(expr(pts(i, 0), pts(i, 1), 0, t)).margin(1e-14));
+
+	time_only(pts, t, res);
+	REQUIRE((res.array() - 1.6).abs().maxCoeff() < 1e-14);
+
+	val(pts, t, res);
+	REQUIRE((res.array() - 3).abs().maxCoeff() < 1e-16);
+}
+
 TEST_CASE("mshreader", "[utils]")
 {
 	const std::string path = POLYFEM_DATA_DIR;
@@ -130,7 +196,177 @@ TEST_CASE("inverse", "[utils]")
 	REQUIRE(((utils::inverse(mat3) - mat3_inv)).norm() == Catch::Approx(0).margin(1e-12));
 }
 
+TEST_CASE("batch_svd", "[utils]")
+{
+	const int dim = GENERATE(2, 3);
+	const int n = 100;
+
+	Eigen::ArrayXXd F = Eigen::ArrayXXd::Random(n, dim * dim);
+	// degenerate deformations: zero, identity, and reflection
+	F.row(0).setZero();
+	F.row(1).setZero();
+	F.row(2).setZero();
+	for (int d = 0; d < dim; ++d)
+	{
+		F(1, d * dim + d) = 1;
+		F(2, d * dim + d) = d == 0 ? -1 : 1;
+	}
+
+	Eigen::ArrayXXd U, sigma, V;
+	batch_svd(dim, F, U, sigma, V);
+
+	for (int p = 0; p < n; ++p)
+	{
+		const Eigen::MatrixXd Fp = F.row(p).matrix().reshaped(dim, dim).transpose();
+		const Eigen::MatrixXd Up = U.row(p).matrix().reshaped(dim, dim).transpose();
+		const Eigen::MatrixXd Vp = V.row(p).matrix().reshaped(dim, dim).transpose();
+		const Eigen::VectorXd sp = sigma.row(p).matrix().transpose();
+
+		REQUIRE((Up * sp.asDiagonal() * Vp.transpose() - Fp).norm() == Catch::Approx(0).margin(1e-12));
+		REQUIRE(Up.determinant() == Catch::Approx(1).margin(1e-12));
+		REQUIRE(Vp.determinant() == Catch::Approx(1).margin(1e-12));
+
+		Eigen::VectorXd expected;
+		if (dim == 2)
+			expected = singular_values<2>(Fp);
+		else
+			expected = singular_values<3>(Fp);
+		REQUIRE((sp - expected).norm() == Catch::Approx(0).margin(1e-12));
+	}
+}
+
+TEST_CASE("autodiff_fixed_size", "[utils]")
+{
+	const auto energy = [](const auto &x) {
+		const auto r2 = x(0) * x(0) + x(1) * x(1) + x(2) * x(2);
+		return sin(x(0)) * exp(x(1)) + log(r2) + sqrt(r2) * x(2) / x(1);
+	};
+
+	const Eigen::Vector3d x0(0.3, 0.7, -1.2);
+
+	DiffScalarBase::setVariableCount(3);
+	AutodiffHessianPt x(3);
+	for (int d = 0; d < 3; ++d)
+		x(d) = AutodiffScalarHessian(d, x0(d));
+	const AutodiffScalarHessian expected = energy(x);
+
+	// fixed-size derivatives do not depend on the variable count
+	DiffScalarBase::setVariableCount(0);
+	Eigen::Matrix<AutodiffScalarHessianFixed<3>, 3, 1> y;
+	for (int d = 0; d < 3; ++d)
+		y(d) = AutodiffScalarHessianFixed<3>(d, x0(d));
+	const AutodiffScalarHessianFixed<3> val = energy(y);
+
+	REQUIRE(val.getValue() == Catch::Approx(expected.getValue()).margin(1e-14));
+	REQUIRE((val.getGradient() - expected.getGradient()).norm() == Catch::Approx(0).margin(1e-13));
+	REQUIRE((val.getHessian() - expected.getHessian()).norm() == Catch::Approx(0).margin(1e-13));
+}
+
 TEST_CASE("wmtk_instatiation", "[utils]")
 {
 	wmtk::TriMesh mesh;
-}
\ No newline at end of file
+}
+
+TEST_CASE("profiler", "[utils]")
+{
+	Profiler &profiler = Profiler::instance();
+	const bool was_enabled = profiler.enabled();
+
+	profiler.set_enabled(false);
+	profiler.clear();
+	{
+		POLYFEM_PROFILE_ZONE("ignored");
+		POLYFEM_PROFILE_COUNTER("ignored", 1);
+	}
+	CHECK(profiler.to_json()["zones"].empty());
+
+	profiler.set_enabled(true);
+	for (int i = 0; i < 3; ++i)
+	{
+		POLYFEM_PROFILE_ZONE("outer");
+		{
+			POLYFEM_PROFILE_ZONE("inner");
+			POLYFEM_PROFILE_COUNTER("items", 2);
+		}
+	}
+
+	const nlohmann::json j = profiler.to_json();
+	REQUIRE(j["zones"].size() == 1);
+	CHECK(j["zones"][0]["name"] == "outer");
+	CHECK(j["zones"][0]["count"] == 3);
+	REQUIRE(j["zones"][0]["children"].size() == 1);
+	CHECK(j["zones"][0]["children"][0]["name"] == "inner");
+	CHECK(j["zones"][0]["children"][0]["count"] == 3);
+	CHECK(j["zones"][0]["children"][0]["time"].get<double>() <= j["zones"][0]["time"].get<double>());
+	CHECK(j["counters"]["items"] == 6);
+
+	profiler.clear();
+	profiler.set_enabled(was_enabled);
+}
+
+TEST_CASE("memory_usage", "[utils]")
+{
+	const Eigen::MatrixXd dense(10, 3);
+	CHECK(memory_usage(dense) == 30 * sizeof(double));
+
+	Eigen::SparseMatrix<double> sparse(10, 10);
+	sparse.setIdentity();
+	sparse.makeCompressed();
+	CHECK(memory_usage(sparse) >= 10 * (sizeof(double) + sizeof(int)) + 11 * sizeof(int));
+
+	MemoryStats stats;
+	CHECK(stats.empty());
+	stats.record("matrix", 100);
+	stats.record("matrix", 300);
+	stats.record("matrix", 200);
+	CHECK(stats.current("matrix") == 200);
+	CHECK(stats.peak("matrix") == 300);
+	CHECK(stats.peak("unknown") == 0);
+
+	const nlohmann::json j = stats.to_json();
+	REQUIRE(j["subsystems"].contains("matrix"));
+	CHECK(j["subsystems"]["matrix"]["peak"].get<double>() == Catch::Approx(300 / double(1 << 20)));
+	CHECK(j["peak_rss"].get<double>() >= j["current_rss"].get<double>());
+}
+
+TEST_CASE("sparse_matrix_spill", "[utils]")
+{
+	const std::string path = (std::filesystem::temp_directory_path() / "polyfem_sparse_matrix_spill.bin").string();
+
+	std::vector<StiffnessMatrix> matrices;
+	{
+		SparseMatrixSpill spill(path);
+		for (int i = 0; i < 5; ++i)
+		{
+			StiffnessMatrix mat(20 + i, 20 + i);
+			for (int j = 0; j < mat.rows(); ++j)
+			{
+				mat.insert(j, j) = j + i;
+				mat.insert(j, (j + i) % mat.cols()) += 0.5;
+			}
+			// the last matrices are not compressed
+			if (i < 3)
+				mat.makeCompressed();
+			spill.write(i, mat);
+			matrices.push_back(mat);
+		}
+		CHECK(spill.file_size() > 0);
+		CHECK(!spill.contains(5));
+
+		StiffnessMatrix read;
+		for (int i = 4; i >= 0; --i)
+		{
+			spill.prefetch(i - 1);
+			spill.read(i, read);
+			REQUIRE(read.rows() == matrices[i].rows());
+			REQUIRE(read.cols() == matrices[i].cols());
+			CHECK((read - matrices[i]).norm() == 0);
+		}
+
+		// overwriting appends a new copy
+		spill.write(1, matrices[4]);
+		spill.read(1, read);
+		CHECK((read - matrices[4]).norm() == 0);
+	}
+	CHECK(!std::filesystem::exists(path));
+}